@@ -0,0 +1,294 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* glfs-io-bm: fio-style read/write load through gfapi, run once for each
+ * IO engine of the bricks (synchronous, linux-aio and io_uring).
+ *
+ * usage: glfs-io-bm <host> <volume> <file> <rw> <bs> <size> [threads]
+ *                   [engines]
+ *
+ * <rw> is one of read, write, randread or randwrite. Every thread works on
+ * its own <file>.<n> of <size> bytes with <bs> sized requests. <engines> is
+ * a comma separated list of sync, aio, uring and uring-fixed (default
+ * "sync,aio,uring"); the engine is switched with the gluster CLI, so run
+ * this from a node of the trusted storage pool.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <glusterfs/api/glfs.h>
+
+struct bm_job {
+    glfs_t *fs;
+    char path[4096];
+    int write;
+    int random;
+    size_t bs;
+    long long size;
+    long long ios;
+    double latency; /* sum of the request latencies, in seconds */
+    int error;
+};
+
+static double
+elapsed(struct timeval *start, struct timeval *stop)
+{
+    return (stop->tv_sec - start->tv_sec) +
+           (stop->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int
+set_engine(const char *volume, const char *engine)
+{
+    char cmd[1024];
+    const char *aio = "off";
+    const char *uring = "off";
+    const char *fixed = "off";
+
+    if (strcmp(engine, "aio") == 0) {
+        aio = "on";
+    } else if (strcmp(engine, "uring") == 0) {
+        uring = "on";
+    } else if (strcmp(engine, "uring-fixed") == 0) {
+        uring = "on";
+        fixed = "on";
+    } else if (strcmp(engine, "sync") != 0) {
+        fprintf(stderr, "unknown engine %s\n", engine);
+        return -1;
+    }
+
+    /* io_uring options only take effect when it is switched on */
+    snprintf(cmd, sizeof(cmd),
+             "gluster --mode=script volume set %s storage.linux-io_uring off "
+             "&& gluster --mode=script volume set %s storage.linux-aio %s "
+             "&& gluster --mode=script volume set %s "
+             "storage.linux-io_uring-fixed %s "
+             "&& gluster --mode=script volume set %s storage.linux-io_uring %s "
+             ">/dev/null",
+             volume, volume, aio, volume, fixed, volume, uring);
+
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+static glfs_t *
+mount_volume(const char *host, const char *volume)
+{
+    glfs_t *fs = NULL;
+
+    fs = glfs_new(volume);
+    if (!fs)
+        return NULL;
+
+    glfs_set_volfile_server(fs, "tcp", host, 24007);
+    glfs_set_logging(fs, "/dev/null", 0);
+    /* files are opened with O_DIRECT, keep write-behind out of the way */
+    glfs_set_xlator_option(fs, "*-write-behind", "strict-O_DIRECT", "on");
+
+    if (glfs_init(fs) != 0) {
+        glfs_fini(fs);
+        return NULL;
+    }
+
+    return fs;
+}
+
+static int
+prepare(glfs_t *fs, const char *path, size_t bs, long long size)
+{
+    struct stat st;
+    glfs_fd_t *fd = NULL;
+    char *buf = NULL;
+    long long off = 0;
+    int ret = -1;
+
+    if (glfs_stat(fs, path, &st) == 0 && st.st_size >= size)
+        return 0;
+
+    fd = glfs_creat(fs, path, O_WRONLY | O_TRUNC, 0644);
+    buf = malloc(bs);
+    if (!fd || !buf)
+        goto out;
+
+    memset(buf, 0xa5, bs);
+    for (off = 0; off < size; off += bs) {
+        if (glfs_pwrite(fd, buf, bs, off, 0, NULL, NULL) != (ssize_t)bs)
+            goto out;
+    }
+    ret = 0;
+out:
+    if (ret)
+        fprintf(stderr, "prepare %s: %s\n", path, strerror(errno));
+    if (fd)
+        glfs_close(fd);
+    free(buf);
+    return ret;
+}
+
+static void *
+run_job(void *data)
+{
+    struct bm_job *job = data;
+    struct timeval start, stop;
+    glfs_fd_t *fd = NULL;
+    unsigned int seed = (unsigned int)(uintptr_t)job;
+    long long nblocks = job->size / job->bs;
+    long long i = 0;
+    off_t off = 0;
+    char *buf = NULL;
+    ssize_t ret = 0;
+
+    fd = glfs_open(job->fs, job->path, (job->write ? O_WRONLY : O_RDONLY) |
+                                           O_DIRECT);
+    if (posix_memalign((void **)&buf, 4096, job->bs) != 0)
+        buf = NULL;
+    if (!fd || !buf) {
+        job->error = errno;
+        goto out;
+    }
+    memset(buf, 0x5a, job->bs);
+
+    for (i = 0; i < nblocks; i++) {
+        off = (job->random ? rand_r(&seed) % nblocks : i) * job->bs;
+
+        gettimeofday(&start, NULL);
+        if (job->write)
+            ret = glfs_pwrite(fd, buf, job->bs, off, 0, NULL, NULL);
+        else
+            ret = glfs_pread(fd, buf, job->bs, off, 0, NULL);
+        gettimeofday(&stop, NULL);
+
+        if (ret < 0) {
+            job->error = errno;
+            break;
+        }
+        job->latency += elapsed(&start, &stop);
+        job->ios++;
+    }
+
+out:
+    if (fd)
+        glfs_close(fd);
+    free(buf);
+    return NULL;
+}
+
+static int
+run(const char *host, const char *volume, const char *file, const char *rw,
+    size_t bs, long long size, int threads, const char *engine)
+{
+    struct bm_job *jobs = NULL;
+    pthread_t *tids = NULL;
+    struct timeval start, stop;
+    glfs_t *fs = NULL;
+    long long ios = 0;
+    double latency = 0;
+    double secs = 0;
+    int ret = -1;
+    int i = 0;
+
+    if (set_engine(volume, engine) != 0)
+        return -1;
+
+    fs = mount_volume(host, volume);
+    jobs = calloc(threads, sizeof(*jobs));
+    tids = calloc(threads, sizeof(*tids));
+    if (!fs || !jobs || !tids) {
+        fprintf(stderr, "cannot mount %s:%s\n", host, volume);
+        goto out;
+    }
+
+    for (i = 0; i < threads; i++) {
+        jobs[i].fs = fs;
+        snprintf(jobs[i].path, sizeof(jobs[i].path), "%s.%d", file, i);
+        jobs[i].write = (strstr(rw, "write") != NULL);
+        jobs[i].random = (strncmp(rw, "rand", 4) == 0);
+        jobs[i].bs = bs;
+        jobs[i].size = size;
+        if (prepare(fs, jobs[i].path, bs, size) != 0)
+            goto out;
+    }
+
+    gettimeofday(&start, NULL);
+    for (i = 0; i < threads; i++)
+        pthread_create(&tids[i], NULL, run_job, &jobs[i]);
+    for (i = 0; i < threads; i++)
+        pthread_join(tids[i], NULL);
+    gettimeofday(&stop, NULL);
+
+    for (i = 0; i < threads; i++) {
+        if (jobs[i].error)
+            fprintf(stderr, "%s: %s\n", jobs[i].path,
+                    strerror(jobs[i].error));
+        ios += jobs[i].ios;
+        latency += jobs[i].latency;
+    }
+    secs = elapsed(&start, &stop);
+
+    fprintf(stdout,
+            "engine=%-11s rw=%s bs=%zu threads=%d iops=%.0f bw=%.1fMB/s "
+            "lat=%.1fus\n",
+            engine, rw, bs, threads, ios / secs, ios * bs / secs / 1048576,
+            ios ? latency / ios * 1000000 : 0.0);
+    ret = 0;
+out:
+    if (fs)
+        glfs_fini(fs);
+    free(jobs);
+    free(tids);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    char engines[256] = "sync,aio,uring";
+    char *engine = NULL;
+    char *saveptr = NULL;
+    long long size = 0;
+    size_t bs = 0;
+    int threads = 1;
+    int ret = 0;
+
+    if (argc < 7) {
+        fprintf(stderr,
+                "usage: %s <host> <volume> <file> "
+                "<read|write|randread|randwrite> <bs> <size> [threads] "
+                "[engines]\n",
+                argv[0]);
+        return 1;
+    }
+
+    bs = strtoul(argv[5], NULL, 0);
+    size = strtoll(argv[6], NULL, 0);
+    if (argc > 7)
+        threads = atoi(argv[7]);
+    if (argc > 8)
+        snprintf(engines, sizeof(engines), "%s", argv[8]);
+
+    if (!bs || size < (long long)bs || threads < 1) {
+        fprintf(stderr, "invalid block size, size or thread count\n");
+        return 1;
+    }
+
+    for (engine = strtok_r(engines, ",", &saveptr); engine;
+         engine = strtok_r(NULL, ",", &saveptr)) {
+        if (run(argv[1], argv[2], argv[3], argv[4], bs, size, threads,
+                engine) != 0)
+            ret = 1;
+    }
+
+    return ret;
+}
@@ -0,0 +1,188 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* glfs-mdstore-bm: small file create and stat rates through gfapi, with
+ * the time attributes of the files kept in xattrs and in the metadata
+ * store of the bricks (storage.metadata-store off and on).
+ *
+ * usage: glfs-mdstore-bm <host> <volume> <dir> <files> [size]
+ *
+ * <files> files of [size] bytes (default 4096) are created in <dir>.off
+ * and <dir>.on, then stated from a fresh mount. The option only takes
+ * effect when the bricks restart, so the volume is restarted with the
+ * gluster CLI: run this from a node of the trusted storage pool, on a
+ * volume nobody else uses.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <glusterfs/api/glfs.h>
+
+static double
+elapsed(struct timeval *start, struct timeval *stop)
+{
+    return (stop->tv_sec - start->tv_sec) +
+           (stop->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int
+set_store(const char *volume, const char *state)
+{
+    char cmd[1024];
+
+    snprintf(cmd, sizeof(cmd),
+             "gluster --mode=script volume stop %s >/dev/null && "
+             "gluster --mode=script volume set %s storage.metadata-store %s "
+             ">/dev/null && "
+             "gluster --mode=script volume start %s >/dev/null",
+             volume, volume, state, volume);
+
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+static glfs_t *
+mount_volume(const char *host, const char *volume)
+{
+    glfs_t *fs = NULL;
+    int i = 0;
+
+    fs = glfs_new(volume);
+    if (!fs)
+        return NULL;
+
+    glfs_set_volfile_server(fs, "tcp", host, 24007);
+    glfs_set_logging(fs, "/dev/null", 0);
+    /* measure the bricks, not the client side caches */
+    glfs_set_xlator_option(fs, "*-md-cache", "md-cache-timeout", "0");
+
+    /* bricks were just restarted, give them time to come up */
+    for (i = 0; i < 10; i++) {
+        if (glfs_init(fs) == 0)
+            return fs;
+        sleep(1);
+    }
+
+    glfs_fini(fs);
+    return NULL;
+}
+
+static int
+run(const char *host, const char *volume, const char *dir, long files,
+    size_t size, const char *state)
+{
+    struct timeval start, stop;
+    char path[4096];
+    struct stat st;
+    glfs_fd_t *fd = NULL;
+    glfs_t *fs = NULL;
+    char *buf = NULL;
+    double create_secs = 0;
+    double stat_secs = 0;
+    long i = 0;
+    int ret = -1;
+
+    if (set_store(volume, state) != 0) {
+        fprintf(stderr, "cannot set storage.metadata-store %s\n", state);
+        return -1;
+    }
+
+    buf = calloc(1, size ? size : 1);
+    fs = mount_volume(host, volume);
+    if (!fs || !buf) {
+        fprintf(stderr, "cannot mount %s:%s\n", host, volume);
+        goto out;
+    }
+
+    snprintf(path, sizeof(path), "%s.%s", dir, state);
+    if (glfs_mkdir(fs, path, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "mkdir %s: %s\n", path, strerror(errno));
+        goto out;
+    }
+
+    gettimeofday(&start, NULL);
+    for (i = 0; i < files; i++) {
+        snprintf(path, sizeof(path), "%s.%s/f%ld", dir, state, i);
+        fd = glfs_creat(fs, path, O_WRONLY | O_TRUNC, 0644);
+        if (!fd || (size && glfs_write(fd, buf, size, 0) != (ssize_t)size)) {
+            fprintf(stderr, "create %s: %s\n", path, strerror(errno));
+            if (fd)
+                glfs_close(fd);
+            goto out;
+        }
+        glfs_close(fd);
+    }
+    gettimeofday(&stop, NULL);
+    create_secs = elapsed(&start, &stop);
+
+    /* stat from a new mount so that every lookup reaches the bricks */
+    glfs_fini(fs);
+    fs = mount_volume(host, volume);
+    if (!fs)
+        goto out;
+
+    gettimeofday(&start, NULL);
+    for (i = 0; i < files; i++) {
+        snprintf(path, sizeof(path), "%s.%s/f%ld", dir, state, i);
+        if (glfs_stat(fs, path, &st) != 0) {
+            fprintf(stderr, "stat %s: %s\n", path, strerror(errno));
+            goto out;
+        }
+    }
+    gettimeofday(&stop, NULL);
+    stat_secs = elapsed(&start, &stop);
+
+    fprintf(stdout,
+            "metadata-store=%-3s files=%ld size=%zu creates/s=%.0f "
+            "stats/s=%.0f\n",
+            state, files, size, files / create_secs, files / stat_secs);
+    ret = 0;
+out:
+    if (fs)
+        glfs_fini(fs);
+    free(buf);
+    return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    long files = 0;
+    size_t size = 4096;
+    int ret = 0;
+
+    if (argc < 5) {
+        fprintf(stderr,
+                "usage: %s <host> <volume> <dir> <files> [size]\n",
+                argv[0]);
+        return 1;
+    }
+
+    files = strtol(argv[4], NULL, 0);
+    if (argc > 5)
+        size = strtoul(argv[5], NULL, 0);
+
+    if (files < 1) {
+        fprintf(stderr, "invalid number of files\n");
+        return 1;
+    }
+
+    if (run(argv[1], argv[2], argv[3], files, size, "off") != 0)
+        ret = 1;
+    if (run(argv[1], argv[2], argv[3], files, size, "on") != 0)
+        ret = 1;
+
+    return ret;
+}
@@ -0,0 +1,169 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* glfs-readdir-bm: time the listing of a large directory through gfapi,
+ * with the DHT readdir fan-out disabled and enabled.
+ *
+ * usage: glfs-readdir-bm <host> <volume> <dir> <count> [passes]
+ *
+ * <dir> is created on the volume and populated with <count> empty files
+ * unless it already holds them. Every pass lists the directory with
+ * readdirplus on a fresh mount and reports entries and elapsed time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <glusterfs/api/glfs.h>
+
+static double
+elapsed(struct timeval *start, struct timeval *stop)
+{
+    return (stop->tv_sec - start->tv_sec) +
+           (stop->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static glfs_t *
+mount_volume(const char *host, const char *volume, const char *fanout)
+{
+    glfs_t *fs = NULL;
+
+    fs = glfs_new(volume);
+    if (!fs)
+        return NULL;
+
+    glfs_set_volfile_server(fs, "tcp", host, 24007);
+    glfs_set_logging(fs, "/dev/null", 0);
+    if (fanout)
+        glfs_set_xlator_option(fs, "*-dht", "readdir-fanout", fanout);
+
+    if (glfs_init(fs) != 0) {
+        glfs_fini(fs);
+        return NULL;
+    }
+
+    return fs;
+}
+
+static int
+populate(glfs_t *fs, const char *dir, long count)
+{
+    char path[4096];
+    glfs_fd_t *fd = NULL;
+    long i = 0;
+
+    if (glfs_mkdir(fs, dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "mkdir %s: %s\n", dir, strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/file-%08ld", dir, i);
+        fd = glfs_creat(fs, path, O_CREAT | O_EXCL | O_WRONLY, 0644);
+        if (!fd) {
+            if (errno == EEXIST)
+                continue;
+            fprintf(stderr, "create %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+        glfs_close(fd);
+    }
+
+    return 0;
+}
+
+static long
+list(glfs_t *fs, const char *dir)
+{
+    struct dirent *entry = NULL;
+    struct stat st;
+    glfs_fd_t *fd = NULL;
+    long count = 0;
+
+    fd = glfs_opendir(fs, dir);
+    if (!fd)
+        return -1;
+
+    while ((entry = glfs_readdirplus(fd, &st)) != NULL)
+        count++;
+
+    glfs_closedir(fd);
+
+    return count;
+}
+
+static int
+run(const char *host, const char *volume, const char *dir, const char *fanout,
+    int passes)
+{
+    struct timeval start, stop;
+    glfs_t *fs = NULL;
+    long count = 0;
+    int i = 0;
+
+    for (i = 0; i < passes; i++) {
+        fs = mount_volume(host, volume, fanout);
+        if (!fs) {
+            fprintf(stderr, "cannot mount %s:%s\n", host, volume);
+            return -1;
+        }
+
+        gettimeofday(&start, NULL);
+        count = list(fs, dir);
+        gettimeofday(&stop, NULL);
+
+        fprintf(stdout, "readdir-fanout=%s pass=%d entries=%ld time=%.3fs\n",
+                fanout, i, count, elapsed(&start, &stop));
+
+        glfs_fini(fs);
+    }
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    glfs_t *fs = NULL;
+    long count = 0;
+    int passes = 3;
+
+    if (argc < 5) {
+        fprintf(stderr, "usage: %s <host> <volume> <dir> <count> [passes]\n",
+                argv[0]);
+        return 1;
+    }
+
+    count = strtol(argv[4], NULL, 0);
+    if (argc > 5)
+        passes = atoi(argv[5]);
+
+    fs = mount_volume(argv[1], argv[2], NULL);
+    if (!fs) {
+        fprintf(stderr, "cannot mount %s:%s\n", argv[1], argv[2]);
+        return 1;
+    }
+
+    if (populate(fs, argv[3], count) != 0) {
+        glfs_fini(fs);
+        return 1;
+    }
+    glfs_fini(fs);
+
+    if (run(argv[1], argv[2], argv[3], "off", passes) ||
+        run(argv[1], argv[2], argv[3], "on", passes))
+        return 1;
+
+    return 0;
+}
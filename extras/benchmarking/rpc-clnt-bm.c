@@ -0,0 +1,385 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* rpc-clnt-bm: replies per second handled by an rpc-clnt with a given
+ * number of calls outstanding, against an rpcsvc answering a null
+ * procedure in the same process over a unix socket.
+ *
+ * usage: rpc-clnt-bm <socket> <calls> <depth>[,<depth>...] [order]
+ *
+ * For each depth, <calls> calls are sent in rounds of <depth> calls, the
+ * next round starting once every reply of the previous one came back. The
+ * server answers in [order]: fifo (default) answers each call right away,
+ * lifo and random hold the calls of a round and answer them all once the
+ * last one arrived, newest first or shuffled, the way replies come back
+ * from a brick whose io-threads finish the calls out of order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/gf-event.h>
+#include <glusterfs/rpc/rpcsvc.h>
+#include <glusterfs/rpc/rpc-clnt.h>
+
+#define BM_PROGNUM 1298437
+#define BM_PROGVER 1
+#define BM_NULL 0
+#define BM_PROC_MAX 1
+
+enum { BM_FIFO, BM_LIFO, BM_RANDOM };
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int connected;
+    int order;
+    int depth;
+    int replies;
+    int errors;
+    int nheld;
+    rpcsvc_request_t **held;
+} bm = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static double
+elapsed(struct timeval *start, struct timeval *stop)
+{
+    return (stop->tv_sec - start->tv_sec) +
+           (stop->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int
+bm_null(rpcsvc_request_t *req)
+{
+    rpcsvc_request_t *tmp = NULL;
+    int count = 0;
+    int i = 0;
+    int j = 0;
+
+    if (bm.order == BM_FIFO)
+        return rpcsvc_submit_generic(req, NULL, 0, NULL, 0, NULL);
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        bm.held[bm.nheld++] = req;
+        if (bm.nheld == bm.depth) {
+            count = bm.nheld;
+            bm.nheld = 0;
+        }
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    if (bm.order == BM_RANDOM) {
+        for (i = count - 1; i > 0; i--) {
+            j = random() % (i + 1);
+            tmp = bm.held[i];
+            bm.held[i] = bm.held[j];
+            bm.held[j] = tmp;
+        }
+    }
+
+    /* the client sends nothing more before these are answered */
+    for (i = count - 1; i >= 0; i--)
+        rpcsvc_submit_generic(bm.held[i], NULL, 0, NULL, 0, NULL);
+
+    return 0;
+}
+
+static rpcsvc_actor_t bm_actors[BM_PROC_MAX] = {
+    [BM_NULL] = {"NULL", bm_null, NULL, BM_NULL, DRC_NA, 0},
+};
+
+static struct rpcsvc_program bm_svc_prog = {
+    .progname = "RPC-BENCH",
+    .prognum = BM_PROGNUM,
+    .progver = BM_PROGVER,
+    .numactors = BM_PROC_MAX,
+    .actors = bm_actors,
+};
+
+static char *bm_procnames[BM_PROC_MAX] = {
+    [BM_NULL] = "NULL",
+};
+
+static rpc_clnt_prog_t bm_clnt_prog = {
+    .progname = "RPC-BENCH",
+    .prognum = BM_PROGNUM,
+    .progver = BM_PROGVER,
+    .procnames = bm_procnames,
+    .numproc = BM_PROC_MAX,
+};
+
+static int
+bm_null_cbk(struct rpc_req *req, struct iovec *iov, int count, void *myframe)
+{
+    call_frame_t *frame = myframe;
+
+    STACK_DESTROY(frame->root);
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        if (req->rpc_status == -1)
+            bm.errors++;
+        if (++bm.replies == bm.depth)
+            pthread_cond_signal(&bm.cond);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    return 0;
+}
+
+static int
+bm_notify(struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
+          void *data)
+{
+    pthread_mutex_lock(&bm.lock);
+    {
+        if (event == RPC_CLNT_CONNECT)
+            bm.connected = 1;
+        else if (event == RPC_CLNT_DISCONNECT)
+            bm.connected = 0;
+        pthread_cond_signal(&bm.cond);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    return 0;
+}
+
+static void *
+bm_poller(void *arg)
+{
+    glusterfs_ctx_t *ctx = arg;
+
+    (void)gf_event_dispatch(ctx->event_pool);
+    return NULL;
+}
+
+static glusterfs_ctx_t *
+bm_ctx_init(void)
+{
+    glusterfs_ctx_t *ctx = NULL;
+    call_pool_t *pool = NULL;
+
+    ctx = glusterfs_ctx_new();
+    if (!ctx || glusterfs_globals_init(ctx))
+        return NULL;
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    ctx->process_uuid = generate_glusterfs_ctx_id();
+    ctx->page_size = 128 * GF_UNIT_KB;
+    ctx->iobuf_pool = iobuf_pool_new();
+    ctx->event_pool = gf_event_pool_new(16384, 1);
+    ctx->dict_pool = mem_pool_new(dict_t, 32);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 512);
+    ctx->dict_data_pool = mem_pool_new(data_t, 512);
+    ctx->logbuf_pool = mem_pool_new(log_buf_t, 256);
+    pool = calloc(1, sizeof(*pool));
+    if (!ctx->process_uuid || !ctx->iobuf_pool || !ctx->event_pool ||
+        !ctx->dict_pool || !ctx->dict_pair_pool || !ctx->dict_data_pool ||
+        !ctx->logbuf_pool || !pool)
+        return NULL;
+
+    pool->frame_mem_pool = mem_pool_new(call_frame_t, 4096);
+    pool->stack_mem_pool = mem_pool_new(call_stack_t, 4096);
+    if (!pool->frame_mem_pool || !pool->stack_mem_pool)
+        return NULL;
+    INIT_LIST_HEAD(&pool->all_frames);
+    LOCK_INIT(&pool->lock);
+    ctx->pool = pool;
+    LOCK_INIT(&ctx->lock);
+    INIT_LIST_HEAD(&ctx->cmd_args.xlator_options);
+
+    if (gf_log_init(ctx, "/dev/null", NULL))
+        return NULL;
+
+    return ctx;
+}
+
+static rpcsvc_t *
+bm_server(glusterfs_ctx_t *ctx, char *path)
+{
+    rpcsvc_t *svc = NULL;
+    dict_t *options = NULL;
+
+    options = dict_new();
+    if (!options || rpcsvc_transport_unix_options_build(options, path))
+        return NULL;
+
+    svc = rpcsvc_init(THIS, ctx, options, 0);
+    if (!svc)
+        return NULL;
+    if (rpcsvc_create_listeners(svc, options, "rpc-bench") != 1)
+        return NULL;
+    if (rpcsvc_program_register(svc, &bm_svc_prog, _gf_false))
+        return NULL;
+
+    return svc;
+}
+
+static struct rpc_clnt *
+bm_client(char *path, int reqpool_size)
+{
+    struct rpc_clnt *rpc = NULL;
+    dict_t *options = NULL;
+
+    options = dict_new();
+    if (!options || rpc_transport_unix_options_build(options, path, 0))
+        return NULL;
+
+    rpc = rpc_clnt_new(options, THIS, "rpc-bench", reqpool_size);
+    if (!rpc)
+        return NULL;
+    if (rpc_clnt_register_notify(rpc, bm_notify, NULL))
+        return NULL;
+    if (rpc_clnt_start(rpc))
+        return NULL;
+
+    return rpc;
+}
+
+static int
+bm_run(glusterfs_ctx_t *ctx, struct rpc_clnt *rpc, int depth, int calls)
+{
+    call_frame_t *frame = NULL;
+    int sent = 0;
+    int i = 0;
+
+    while (sent < calls) {
+        pthread_mutex_lock(&bm.lock);
+        {
+            bm.depth = depth;
+            bm.replies = 0;
+        }
+        pthread_mutex_unlock(&bm.lock);
+
+        for (i = 0; i < depth; i++) {
+            frame = create_frame(THIS, ctx->pool);
+            if (!frame)
+                return -1;
+            if (rpc_clnt_submit(rpc, &bm_clnt_prog, BM_NULL, bm_null_cbk,
+                                NULL, 0, NULL, 0, NULL, frame, NULL, 0, NULL,
+                                0, NULL))
+                return -1;
+        }
+        sent += depth;
+
+        pthread_mutex_lock(&bm.lock);
+        {
+            while (bm.replies < depth)
+                pthread_cond_wait(&bm.cond, &bm.lock);
+        }
+        pthread_mutex_unlock(&bm.lock);
+    }
+
+    return bm.errors ? -1 : 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    glusterfs_ctx_t *ctx = NULL;
+    struct rpc_clnt *rpc = NULL;
+    struct timeval start, stop;
+    pthread_t poller;
+    char *path = NULL;
+    char *depths = NULL;
+    char *depth = NULL;
+    char *saveptr = NULL;
+    int calls = 0;
+    int max_depth = 0;
+    int rounds = 0;
+    double secs = 0;
+
+    if (argc < 4) {
+        fprintf(stderr,
+                "usage: %s <socket> <calls> <depth>[,<depth>...] "
+                "[fifo|lifo|random]\n",
+                argv[0]);
+        return 1;
+    }
+    path = argv[1];
+    calls = atoi(argv[2]);
+    depths = argv[3];
+    if (argc > 4 && strcmp(argv[4], "lifo") == 0)
+        bm.order = BM_LIFO;
+    else if (argc > 4 && strcmp(argv[4], "random") == 0)
+        bm.order = BM_RANDOM;
+    else if (argc > 4 && strcmp(argv[4], "fifo") != 0) {
+        fprintf(stderr, "unknown order %s\n", argv[4]);
+        return 1;
+    }
+
+    for (depth = depths; depth; depth = strchr(depth, ',')) {
+        if (*depth == ',')
+            depth++;
+        if (atoi(depth) > max_depth)
+            max_depth = atoi(depth);
+    }
+    if (calls <= 0 || max_depth <= 0) {
+        fprintf(stderr, "calls and depths have to be positive\n");
+        return 1;
+    }
+
+    bm.held = calloc(max_depth, sizeof(*bm.held));
+    ctx = bm_ctx_init();
+    if (!bm.held || !ctx) {
+        fprintf(stderr, "initialization failed\n");
+        return 1;
+    }
+
+    unlink(path);
+    if (!bm_server(ctx, path)) {
+        fprintf(stderr, "failed to listen on %s\n", path);
+        return 1;
+    }
+    rpc = bm_client(path, max_depth);
+    if (!rpc) {
+        fprintf(stderr, "failed to start the client\n");
+        return 1;
+    }
+    pthread_create(&poller, NULL, bm_poller, ctx);
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        while (!bm.connected)
+            pthread_cond_wait(&bm.cond, &bm.lock);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    printf("%8s %10s %10s %12s\n", "depth", "calls", "secs", "replies/s");
+    for (depth = strtok_r(depths, ",", &saveptr); depth;
+         depth = strtok_r(NULL, ",", &saveptr)) {
+        rounds = (calls + atoi(depth) - 1) / atoi(depth);
+
+        gettimeofday(&start, NULL);
+        if (bm_run(ctx, rpc, atoi(depth), calls)) {
+            fprintf(stderr, "calls failed at depth %s\n", depth);
+            return 1;
+        }
+        gettimeofday(&stop, NULL);
+
+        secs = elapsed(&start, &stop);
+        printf("%8d %10d %10.3f %12.0f\n", atoi(depth),
+               rounds * atoi(depth), secs, rounds * atoi(depth) / secs);
+    }
+
+    unlink(path);
+    return 0;
+}
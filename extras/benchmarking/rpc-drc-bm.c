@@ -0,0 +1,447 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* rpc-drc-bm: non-idempotent calls per second handled by an rpcsvc with
+ * the duplicate request cache off and on, from many clients at once.
+ *
+ * usage: rpc-drc-bm <port> <clients> <depth> <calls> [event-threads]
+ *
+ * An rpcsvc in the same process listens on 127.0.0.1:<port> and answers a
+ * WRITE-like procedure, which the cache keeps the replies of, with 128
+ * bytes. Each of the <clients> rpc-clnts connects from an address of its
+ * own in 127.1.0.0/16, the cache telling clients apart by address, and
+ * keeps <depth> calls outstanding till <calls> calls were answered in
+ * all. The cache has the default nfs.drc-size and nfs.drc-max-memory, so
+ * with more calls than that it is also evicting at full speed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/gf-event.h>
+#include <glusterfs/rpc/rpcsvc.h>
+#include <glusterfs/rpc/rpc-clnt.h>
+#include <glusterfs/rpc/rpc-drc.h>
+
+#define BM_PROGNUM 1298438
+#define BM_PROGVER 1
+#define BM_WRITE 0
+#define BM_PROC_MAX 1
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int connected;
+    int calls;
+    gf_atomic_t sent;
+    gf_atomic_t replies;
+    gf_atomic_t errors;
+} bm = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+/* the arguments and the reply of every call; the cache checksums the
+ * former, and the xid alone tells the calls apart */
+static char bm_args[64];
+static char bm_reply[128];
+
+static double
+elapsed(struct timeval *start, struct timeval *stop)
+{
+    return (stop->tv_sec - start->tv_sec) +
+           (stop->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int
+bm_write(rpcsvc_request_t *req)
+{
+    struct iovec iov = {
+        .iov_base = bm_reply,
+        .iov_len = sizeof(bm_reply),
+    };
+
+    return rpcsvc_submit_generic(req, &iov, 1, NULL, 0, NULL);
+}
+
+static rpcsvc_actor_t bm_actors[BM_PROC_MAX] = {
+    [BM_WRITE] = {"WRITE", bm_write, NULL, BM_WRITE, DRC_NON_IDEMPOTENT, 1},
+};
+
+static struct rpcsvc_program bm_svc_prog = {
+    .progname = "DRC-BENCH",
+    .prognum = BM_PROGNUM,
+    .progver = BM_PROGVER,
+    .numactors = BM_PROC_MAX,
+    .actors = bm_actors,
+};
+
+static char *bm_procnames[BM_PROC_MAX] = {
+    [BM_WRITE] = "WRITE",
+};
+
+static rpc_clnt_prog_t bm_clnt_prog = {
+    .progname = "DRC-BENCH",
+    .prognum = BM_PROGNUM,
+    .progver = BM_PROGVER,
+    .procnames = bm_procnames,
+    .numproc = BM_PROC_MAX,
+};
+
+static int
+bm_send(struct rpc_clnt *rpc);
+
+static int
+bm_write_cbk(struct rpc_req *req, struct iovec *iov, int count, void *myframe)
+{
+    call_frame_t *frame = myframe;
+    struct rpc_clnt *rpc = frame->local;
+
+    frame->local = NULL;
+    STACK_DESTROY(frame->root);
+
+    if (req->rpc_status == -1)
+        GF_ATOMIC_INC(bm.errors);
+
+    /* keep the depth of this client till all the calls are sent */
+    if (GF_ATOMIC_INC(bm.replies) == bm.calls) {
+        pthread_mutex_lock(&bm.lock);
+        pthread_cond_signal(&bm.cond);
+        pthread_mutex_unlock(&bm.lock);
+    } else if (bm_send(rpc)) {
+        GF_ATOMIC_INC(bm.errors);
+    }
+
+    return 0;
+}
+
+static int
+bm_send(struct rpc_clnt *rpc)
+{
+    call_frame_t *frame = NULL;
+    struct iovec iov = {
+        .iov_base = bm_args,
+        .iov_len = sizeof(bm_args),
+    };
+
+    if (GF_ATOMIC_INC(bm.sent) > bm.calls)
+        return 0;
+
+    frame = create_frame(THIS, THIS->ctx->pool);
+    if (!frame)
+        return -1;
+    frame->local = rpc;
+
+    return rpc_clnt_submit(rpc, &bm_clnt_prog, BM_WRITE, bm_write_cbk, &iov,
+                           1, NULL, 0, NULL, frame, NULL, 0, NULL, 0, NULL);
+}
+
+static int
+bm_notify(struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
+          void *data)
+{
+    pthread_mutex_lock(&bm.lock);
+    {
+        if (event == RPC_CLNT_CONNECT)
+            bm.connected++;
+        else if (event == RPC_CLNT_DISCONNECT)
+            bm.connected--;
+        pthread_cond_signal(&bm.cond);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    return 0;
+}
+
+static void *
+bm_poller(void *arg)
+{
+    glusterfs_ctx_t *ctx = arg;
+
+    (void)gf_event_dispatch(ctx->event_pool);
+    return NULL;
+}
+
+static glusterfs_ctx_t *
+bm_ctx_init(int threads)
+{
+    glusterfs_ctx_t *ctx = NULL;
+    call_pool_t *pool = NULL;
+
+    ctx = glusterfs_ctx_new();
+    if (!ctx || glusterfs_globals_init(ctx))
+        return NULL;
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    ctx->process_uuid = generate_glusterfs_ctx_id();
+    ctx->page_size = 128 * GF_UNIT_KB;
+    ctx->iobuf_pool = iobuf_pool_new();
+    ctx->event_pool = gf_event_pool_new(16384, threads);
+    ctx->dict_pool = mem_pool_new(dict_t, 32);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 512);
+    ctx->dict_data_pool = mem_pool_new(data_t, 512);
+    ctx->logbuf_pool = mem_pool_new(log_buf_t, 256);
+    pool = calloc(1, sizeof(*pool));
+    if (!ctx->process_uuid || !ctx->iobuf_pool || !ctx->event_pool ||
+        !ctx->dict_pool || !ctx->dict_pair_pool || !ctx->dict_data_pool ||
+        !ctx->logbuf_pool || !pool)
+        return NULL;
+
+    pool->frame_mem_pool = mem_pool_new(call_frame_t, 16384);
+    pool->stack_mem_pool = mem_pool_new(call_stack_t, 16384);
+    if (!pool->frame_mem_pool || !pool->stack_mem_pool)
+        return NULL;
+    INIT_LIST_HEAD(&pool->all_frames);
+    LOCK_INIT(&pool->lock);
+    ctx->pool = pool;
+    LOCK_INIT(&ctx->lock);
+    INIT_LIST_HEAD(&ctx->cmd_args.xlator_options);
+
+    if (gf_log_init(ctx, "/dev/null", NULL))
+        return NULL;
+
+    return ctx;
+}
+
+static rpcsvc_t *
+bm_server(glusterfs_ctx_t *ctx, char *port)
+{
+    rpcsvc_t *svc = NULL;
+    dict_t *options = NULL;
+
+    options = dict_new();
+    if (!options || dict_set_str(options, "transport-type", "socket") ||
+        dict_set_str(options, "transport.address-family", "inet") ||
+        dict_set_str(options, "transport.socket.bind-address", "127.0.0.1") ||
+        dict_set_str(options, "transport.socket.listen-port", port) ||
+        dict_set_str(options, "transport.listen-backlog", "4096") ||
+        dict_set_str(options, "nfs.drc", "off"))
+        return NULL;
+
+    svc = rpcsvc_init(THIS, ctx, options, 0);
+    if (!svc)
+        return NULL;
+    if (rpcsvc_create_listeners(svc, options, "drc-bench") != 1)
+        return NULL;
+    if (rpcsvc_program_register(svc, &bm_svc_prog, _gf_false))
+        return NULL;
+
+    return svc;
+}
+
+static struct rpc_clnt *
+bm_client(int port, int i, int depth)
+{
+    struct rpc_clnt *rpc = NULL;
+    dict_t *options = NULL;
+    char addr[32];
+
+    snprintf(addr, sizeof(addr), "127.1.%d.%d", i / 250, i % 250 + 1);
+
+    options = dict_new();
+    if (!options ||
+        rpc_transport_inet_options_build(options, "127.0.0.1", port,
+                                         "inet") ||
+        dict_set_dynstr_with_alloc(options, "transport.socket.source-addr",
+                                   addr))
+        return NULL;
+
+    rpc = rpc_clnt_new(options, THIS, "drc-bench", depth);
+    if (!rpc)
+        return NULL;
+    if (rpc_clnt_register_notify(rpc, bm_notify, NULL))
+        return NULL;
+    if (rpc_clnt_start(rpc))
+        return NULL;
+
+    return rpc;
+}
+
+static int
+bm_drc(rpcsvc_t *svc, char *state)
+{
+    dict_t *options = NULL;
+    int ret = -1;
+
+    options = dict_new();
+    if (options && !dict_set_str(options, "nfs.drc", state))
+        ret = rpcsvc_drc_reconfigure(svc, options);
+    if (options)
+        dict_unref(options);
+
+    return ret;
+}
+
+static void
+bm_drc_usage(rpcsvc_t *svc, uint64_t *ops, uint64_t *bytes)
+{
+    struct drc_shard *shard = NULL;
+    int i = 0;
+
+    *ops = 0;
+    *bytes = 0;
+    if (!svc->drc || svc->drc->status != DRC_INITIATED)
+        return;
+
+    for (i = 0; i < DRC_SHARDS; i++) {
+        shard = &svc->drc->shards[i];
+        LOCK(&shard->lock);
+        {
+            *ops += shard->op_count;
+            *bytes += shard->bytes;
+        }
+        UNLOCK(&shard->lock);
+    }
+}
+
+static int
+bm_run(struct rpc_clnt **rpcs, int clients, int depth, int calls)
+{
+    int i = 0;
+    int j = 0;
+
+    bm.calls = calls;
+    GF_ATOMIC_INIT(bm.sent, 0);
+    GF_ATOMIC_INIT(bm.replies, 0);
+
+    for (i = 0; i < clients; i++) {
+        for (j = 0; j < depth; j++) {
+            if (bm_send(rpcs[i]))
+                return -1;
+        }
+    }
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        while (GF_ATOMIC_GET(bm.replies) < calls &&
+               bm.connected == clients)
+            pthread_cond_wait(&bm.cond, &bm.lock);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    if (GF_ATOMIC_GET(bm.replies) < calls || GF_ATOMIC_GET(bm.errors))
+        return -1;
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    static char *states[] = {"off", "on"};
+    glusterfs_ctx_t *ctx = NULL;
+    rpcsvc_t *svc = NULL;
+    struct rpc_clnt **rpcs = NULL;
+    struct timeval start, stop;
+    struct rlimit rlim;
+    pthread_t poller;
+    uint64_t ops = 0;
+    uint64_t bytes = 0;
+    int port = 0;
+    int clients = 0;
+    int depth = 0;
+    int calls = 0;
+    int threads = 1;
+    int i = 0;
+    double secs = 0;
+
+    if (argc < 5) {
+        fprintf(stderr,
+                "usage: %s <port> <clients> <depth> <calls> "
+                "[event-threads]\n",
+                argv[0]);
+        return 1;
+    }
+    port = atoi(argv[1]);
+    clients = atoi(argv[2]);
+    depth = atoi(argv[3]);
+    calls = atoi(argv[4]);
+    if (argc > 5)
+        threads = atoi(argv[5]);
+    if (port < 1024 || clients <= 0 || clients > 250 * 250 || depth <= 0 ||
+        calls < clients * depth || threads <= 0) {
+        fprintf(stderr,
+                "the port has to be unprivileged, clients at most 62500, "
+                "and calls at least clients * depth\n");
+        return 1;
+    }
+
+    /* a socket on either end of each client */
+    if (getrlimit(RLIMIT_NOFILE, &rlim) == 0 &&
+        rlim.rlim_cur < 2 * clients + 64) {
+        rlim.rlim_cur = rlim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rlim);
+    }
+
+    memset(bm_args, 'a', sizeof(bm_args));
+    memset(bm_reply, 'r', sizeof(bm_reply));
+    GF_ATOMIC_INIT(bm.errors, 0);
+
+    rpcs = calloc(clients, sizeof(*rpcs));
+    ctx = bm_ctx_init(threads);
+    if (!rpcs || !ctx) {
+        fprintf(stderr, "initialization failed\n");
+        return 1;
+    }
+
+    svc = bm_server(ctx, argv[1]);
+    if (!svc) {
+        fprintf(stderr, "failed to listen on port %d\n", port);
+        return 1;
+    }
+    pthread_create(&poller, NULL, bm_poller, ctx);
+
+    for (i = 0; i < clients; i++) {
+        rpcs[i] = bm_client(port, i, depth);
+        if (!rpcs[i]) {
+            fprintf(stderr, "failed to start client %d\n", i);
+            return 1;
+        }
+    }
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        while (bm.connected < clients)
+            pthread_cond_wait(&bm.cond, &bm.lock);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    printf("%4s %8s %6s %10s %8s %10s %10s %10s\n", "drc", "clients",
+           "depth", "calls", "secs", "calls/s", "cached", "cached-MB");
+    for (i = 0; i < 2; i++) {
+        if (bm_drc(svc, states[i])) {
+            fprintf(stderr, "failed to turn the cache %s\n", states[i]);
+            return 1;
+        }
+
+        gettimeofday(&start, NULL);
+        if (bm_run(rpcs, clients, depth, calls)) {
+            fprintf(stderr, "calls failed with the cache %s\n", states[i]);
+            return 1;
+        }
+        gettimeofday(&stop, NULL);
+
+        secs = elapsed(&start, &stop);
+        bm_drc_usage(svc, &ops, &bytes);
+        printf("%4s %8d %6d %10d %8.3f %10.0f %10" PRIu64 " %10.1f\n",
+               states[i], clients, depth, calls, secs, calls / secs, ops,
+               (double)bytes / GF_UNIT_MB);
+    }
+
+    return 0;
+}
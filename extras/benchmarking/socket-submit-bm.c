@@ -0,0 +1,364 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* socket-submit-bm: small calls per second that many threads get through
+ * one rpc-clnt, i.e. through the submission queue of a single socket.
+ *
+ * usage: socket-submit-bm <socket> <submitters> <calls> [size] [window]
+ *                         [event-threads]
+ *
+ * An rpcsvc in the same process listens on the unix socket <socket> and
+ * answers a null procedure. Each of the <submitters> threads sends its
+ * share of <calls> calls carrying [size] bytes (64 by default), with at
+ * most [window] (16 by default) of its calls outstanding at a time.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/time.h>
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/stack.h>
+#include <glusterfs/gf-event.h>
+#include <glusterfs/rpc/rpcsvc.h>
+#include <glusterfs/rpc/rpc-clnt.h>
+
+#define BM_PROGNUM 1298439
+#define BM_PROGVER 1
+#define BM_NULL 0
+#define BM_PROC_MAX 1
+
+struct bm_submitter {
+    pthread_t thread;
+    sem_t window;
+    int calls;
+};
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int connected;
+    struct rpc_clnt *rpc;
+    char *args;
+    int size;
+    int window;
+    int calls;
+    gf_atomic_t replies;
+    gf_atomic_t errors;
+} bm = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static double
+elapsed(struct timeval *start, struct timeval *stop)
+{
+    return (stop->tv_sec - start->tv_sec) +
+           (stop->tv_usec - start->tv_usec) / 1000000.0;
+}
+
+static int
+bm_null(rpcsvc_request_t *req)
+{
+    return rpcsvc_submit_generic(req, NULL, 0, NULL, 0, NULL);
+}
+
+static rpcsvc_actor_t bm_actors[BM_PROC_MAX] = {
+    [BM_NULL] = {"NULL", bm_null, NULL, BM_NULL, DRC_NA, 0},
+};
+
+static struct rpcsvc_program bm_svc_prog = {
+    .progname = "SUBMIT-BENCH",
+    .prognum = BM_PROGNUM,
+    .progver = BM_PROGVER,
+    .numactors = BM_PROC_MAX,
+    .actors = bm_actors,
+};
+
+static char *bm_procnames[BM_PROC_MAX] = {
+    [BM_NULL] = "NULL",
+};
+
+static rpc_clnt_prog_t bm_clnt_prog = {
+    .progname = "SUBMIT-BENCH",
+    .prognum = BM_PROGNUM,
+    .progver = BM_PROGVER,
+    .procnames = bm_procnames,
+    .numproc = BM_PROC_MAX,
+};
+
+static int
+bm_null_cbk(struct rpc_req *req, struct iovec *iov, int count, void *myframe)
+{
+    call_frame_t *frame = myframe;
+    struct bm_submitter *submitter = frame->local;
+
+    frame->local = NULL;
+    STACK_DESTROY(frame->root);
+
+    if (req->rpc_status == -1)
+        GF_ATOMIC_INC(bm.errors);
+
+    sem_post(&submitter->window);
+
+    if (GF_ATOMIC_INC(bm.replies) == bm.calls) {
+        pthread_mutex_lock(&bm.lock);
+        pthread_cond_signal(&bm.cond);
+        pthread_mutex_unlock(&bm.lock);
+    }
+
+    return 0;
+}
+
+static void *
+bm_submitter(void *arg)
+{
+    struct bm_submitter *submitter = arg;
+    call_frame_t *frame = NULL;
+    struct iovec iov = {
+        .iov_base = bm.args,
+        .iov_len = bm.size,
+    };
+    int i = 0;
+
+    for (i = 0; i < submitter->calls; i++) {
+        sem_wait(&submitter->window);
+
+        frame = create_frame(THIS, THIS->ctx->pool);
+        if (!frame) {
+            GF_ATOMIC_INC(bm.errors);
+            break;
+        }
+        frame->local = submitter;
+
+        /* the callback runs on failure too */
+        rpc_clnt_submit(bm.rpc, &bm_clnt_prog, BM_NULL, bm_null_cbk, &iov,
+                        bm.size ? 1 : 0, NULL, 0, NULL, frame, NULL, 0, NULL,
+                        0, NULL);
+    }
+
+    return NULL;
+}
+
+static int
+bm_notify(struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
+          void *data)
+{
+    pthread_mutex_lock(&bm.lock);
+    {
+        if (event == RPC_CLNT_CONNECT)
+            bm.connected = 1;
+        else if (event == RPC_CLNT_DISCONNECT)
+            bm.connected = 0;
+        pthread_cond_signal(&bm.cond);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    return 0;
+}
+
+static void *
+bm_poller(void *arg)
+{
+    glusterfs_ctx_t *ctx = arg;
+
+    (void)gf_event_dispatch(ctx->event_pool);
+    return NULL;
+}
+
+static glusterfs_ctx_t *
+bm_ctx_init(int threads)
+{
+    glusterfs_ctx_t *ctx = NULL;
+    call_pool_t *pool = NULL;
+
+    ctx = glusterfs_ctx_new();
+    if (!ctx || glusterfs_globals_init(ctx))
+        return NULL;
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    ctx->process_uuid = generate_glusterfs_ctx_id();
+    ctx->page_size = 128 * GF_UNIT_KB;
+    ctx->iobuf_pool = iobuf_pool_new();
+    ctx->event_pool = gf_event_pool_new(16384, threads);
+    ctx->dict_pool = mem_pool_new(dict_t, 32);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 512);
+    ctx->dict_data_pool = mem_pool_new(data_t, 512);
+    ctx->logbuf_pool = mem_pool_new(log_buf_t, 256);
+    pool = calloc(1, sizeof(*pool));
+    if (!ctx->process_uuid || !ctx->iobuf_pool || !ctx->event_pool ||
+        !ctx->dict_pool || !ctx->dict_pair_pool || !ctx->dict_data_pool ||
+        !ctx->logbuf_pool || !pool)
+        return NULL;
+
+    pool->frame_mem_pool = mem_pool_new(call_frame_t, 16384);
+    pool->stack_mem_pool = mem_pool_new(call_stack_t, 16384);
+    if (!pool->frame_mem_pool || !pool->stack_mem_pool)
+        return NULL;
+    INIT_LIST_HEAD(&pool->all_frames);
+    LOCK_INIT(&pool->lock);
+    ctx->pool = pool;
+    LOCK_INIT(&ctx->lock);
+    INIT_LIST_HEAD(&ctx->cmd_args.xlator_options);
+
+    if (gf_log_init(ctx, "/dev/null", NULL))
+        return NULL;
+
+    return ctx;
+}
+
+static rpcsvc_t *
+bm_server(glusterfs_ctx_t *ctx, char *path)
+{
+    rpcsvc_t *svc = NULL;
+    dict_t *options = NULL;
+
+    options = dict_new();
+    if (!options || rpcsvc_transport_unix_options_build(options, path))
+        return NULL;
+
+    svc = rpcsvc_init(THIS, ctx, options, 0);
+    if (!svc)
+        return NULL;
+    if (rpcsvc_create_listeners(svc, options, "submit-bench") != 1)
+        return NULL;
+    if (rpcsvc_program_register(svc, &bm_svc_prog, _gf_false))
+        return NULL;
+
+    return svc;
+}
+
+static struct rpc_clnt *
+bm_client(char *path, int reqpool_size)
+{
+    struct rpc_clnt *rpc = NULL;
+    dict_t *options = NULL;
+
+    options = dict_new();
+    if (!options || rpc_transport_unix_options_build(options, path, 0))
+        return NULL;
+
+    rpc = rpc_clnt_new(options, THIS, "submit-bench", reqpool_size);
+    if (!rpc)
+        return NULL;
+    if (rpc_clnt_register_notify(rpc, bm_notify, NULL))
+        return NULL;
+    if (rpc_clnt_start(rpc))
+        return NULL;
+
+    return rpc;
+}
+
+int
+main(int argc, char *argv[])
+{
+    glusterfs_ctx_t *ctx = NULL;
+    struct bm_submitter *submitters = NULL;
+    struct timeval start, stop;
+    pthread_t poller;
+    char *path = NULL;
+    int nsubmitters = 0;
+    int threads = 1;
+    int i = 0;
+    double secs = 0;
+
+    if (argc < 4) {
+        fprintf(stderr,
+                "usage: %s <socket> <submitters> <calls> [size] [window] "
+                "[event-threads]\n",
+                argv[0]);
+        return 1;
+    }
+    path = argv[1];
+    nsubmitters = atoi(argv[2]);
+    bm.calls = atoi(argv[3]);
+    bm.size = (argc > 4) ? atoi(argv[4]) : 64;
+    bm.window = (argc > 5) ? atoi(argv[5]) : 16;
+    if (argc > 6)
+        threads = atoi(argv[6]);
+    if (nsubmitters <= 0 || bm.calls < nsubmitters || bm.size < 0 ||
+        bm.window <= 0 || threads <= 0) {
+        fprintf(stderr, "calls have to be at least as many as submitters\n");
+        return 1;
+    }
+    /* what the submitters did not get to send is not waited for */
+    bm.calls -= bm.calls % nsubmitters;
+
+    bm.args = calloc(1, bm.size + 1);
+    submitters = calloc(nsubmitters, sizeof(*submitters));
+    ctx = bm_ctx_init(threads);
+    if (!bm.args || !submitters || !ctx) {
+        fprintf(stderr, "initialization failed\n");
+        return 1;
+    }
+    GF_ATOMIC_INIT(bm.replies, 0);
+    GF_ATOMIC_INIT(bm.errors, 0);
+
+    unlink(path);
+    if (!bm_server(ctx, path)) {
+        fprintf(stderr, "failed to listen on %s\n", path);
+        return 1;
+    }
+    pthread_create(&poller, NULL, bm_poller, ctx);
+
+    bm.rpc = bm_client(path, nsubmitters * bm.window);
+    if (!bm.rpc) {
+        fprintf(stderr, "failed to start the client\n");
+        return 1;
+    }
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        while (!bm.connected)
+            pthread_cond_wait(&bm.cond, &bm.lock);
+    }
+    pthread_mutex_unlock(&bm.lock);
+
+    gettimeofday(&start, NULL);
+    for (i = 0; i < nsubmitters; i++) {
+        submitters[i].calls = bm.calls / nsubmitters;
+        sem_init(&submitters[i].window, 0, bm.window);
+        pthread_create(&submitters[i].thread, NULL, bm_submitter,
+                       &submitters[i]);
+    }
+
+    pthread_mutex_lock(&bm.lock);
+    {
+        while (GF_ATOMIC_GET(bm.replies) < bm.calls && bm.connected)
+            pthread_cond_wait(&bm.cond, &bm.lock);
+    }
+    pthread_mutex_unlock(&bm.lock);
+    gettimeofday(&stop, NULL);
+
+    for (i = 0; i < nsubmitters; i++)
+        pthread_join(submitters[i].thread, NULL);
+
+    if (GF_ATOMIC_GET(bm.replies) < bm.calls || GF_ATOMIC_GET(bm.errors)) {
+        fprintf(stderr, "%" PRIu64 " of %d calls failed\n",
+                bm.calls - GF_ATOMIC_GET(bm.replies) +
+                    GF_ATOMIC_GET(bm.errors),
+                bm.calls);
+        return 1;
+    }
+
+    secs = elapsed(&start, &stop);
+    printf("%10s %6s %6s %10s %8s %10s %8s\n", "submitters", "size",
+           "window", "calls", "secs", "calls/s", "MB/s");
+    printf("%10d %6d %6d %10d %8.3f %10.0f %8.1f\n", nsubmitters, bm.size,
+           bm.window, bm.calls, secs, bm.calls / secs,
+           (double)bm.calls * bm.size / secs / GF_UNIT_MB);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+#!/usr/bin/python3
+"""
+
+Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+This file is part of GlusterFS.
+
+This file is licensed to you under your choice of the GNU Lesser
+General Public License, version 3 or any later version (LGPLv3 or
+later), or the GNU General Public License, version 2 (GPLv2), in all
+cases as published by the Free Software Foundation.
+
+Moves the time attributes of the files of a brick (the trusted.glusterfs.mdata
+xattr) into the metadata store used with storage.metadata-store on, or back
+into xattrs before the option is turned off. Run it with the brick stopped.
+
+"""
+
+import argparse
+import errno
+import os
+import struct
+import sys
+import uuid
+import zlib
+
+MDATA_KEY = b"trusted.glusterfs.mdata"
+LOG_NAME = "mdstore.log"
+LOG_MAGIC = b"GFMDS001"
+REC_MAGIC = 0x4d445352
+REC_HDR = struct.Struct(">II16sHH")
+
+
+def checksum(data):
+    # gf_rsync_weak_checksum(): adler32 seeded with 0
+    return zlib.adler32(data, 0) & 0xffffffff
+
+
+def build_record(gfid, key, value):
+    rec = REC_HDR.pack(REC_MAGIC, 0, gfid, len(key), len(value)) + key + value
+    return REC_HDR.pack(REC_MAGIC, checksum(rec), gfid, len(key),
+                        len(value)) + key + value
+
+
+def read_records(logpath):
+    """Yields (gfid, key, value, end) of the valid records of the log, end
+    being the offset following the record. A record without key removes
+    the keys of its gfid"""
+    with open(logpath, "rb") as log:
+        if log.read(len(LOG_MAGIC)) != LOG_MAGIC:
+            raise ValueError("%s is not a metadata store log" % logpath)
+        while True:
+            hdr = log.read(REC_HDR.size)
+            if len(hdr) < REC_HDR.size:
+                return
+            magic, csum, gfid, klen, vlen = REC_HDR.unpack(hdr)
+            payload = log.read(klen + vlen)
+            if magic != REC_MAGIC or len(payload) < klen + vlen:
+                return
+            zeroed = REC_HDR.pack(magic, 0, gfid, klen, vlen) + payload
+            if checksum(zeroed) != csum:
+                return
+            yield gfid, payload[:klen], payload[klen:], log.tell()
+
+
+def load(logpath):
+    """Returns the keys of the log and the end of its last valid record"""
+    store = {}
+    end = len(LOG_MAGIC)
+    for gfid, key, value, end in read_records(logpath):
+        if not key:
+            for k in [k for k in store if k[0] == gfid]:
+                del store[k]
+        else:
+            store[(gfid, key)] = value
+    return store, end
+
+
+def handles(brick):
+    hidden = os.path.join(brick, ".glusterfs")
+    for d1 in sorted(os.listdir(hidden)):
+        if len(d1) != 2:
+            continue
+        for d2 in sorted(os.listdir(os.path.join(hidden, d1))):
+            top = os.path.join(hidden, d1, d2)
+            if len(d2) != 2 or not os.path.isdir(top):
+                continue
+            for name in os.listdir(top):
+                try:
+                    gfid = uuid.UUID(name).bytes
+                except ValueError:
+                    continue
+                yield gfid, os.path.join(top, name)
+
+
+def handle_path(brick, gfid):
+    name = str(uuid.UUID(bytes=gfid))
+    return os.path.join(brick, ".glusterfs", name[0:2], name[2:4], name)
+
+
+def sync_dir(path):
+    fd = os.open(path, os.O_RDONLY | os.O_DIRECTORY)
+    try:
+        os.fsync(fd)
+    finally:
+        os.close(fd)
+
+
+def do_import(brick, remove):
+    logpath = os.path.join(brick, ".glusterfs", LOG_NAME)
+    exists = os.path.exists(logpath)
+    store, end = load(logpath) if exists else ({}, 0)
+    removed = []
+    moved = 0
+
+    with open(logpath, "r+b" if exists else "wb") as log:
+        # records appended after a torn one would never be replayed
+        log.truncate(end)
+        log.seek(end)
+        if end == 0:
+            log.write(LOG_MAGIC)
+        for gfid, path in handles(brick):
+            # directory handles are symlinks to the directory
+            follow = os.path.islink(path)
+            try:
+                value = os.getxattr(path, MDATA_KEY, follow_symlinks=follow)
+            except OSError as e:
+                if e.errno in (errno.ENODATA, errno.ENOENT):
+                    continue
+                raise
+            # the store already has a newer record of this file
+            if (gfid, MDATA_KEY) not in store:
+                log.write(build_record(gfid, MDATA_KEY, value))
+                moved += 1
+            if remove:
+                removed.append((path, follow))
+        log.flush()
+        os.fsync(log.fileno())
+    if not exists:
+        sync_dir(os.path.dirname(logpath))
+
+    # only once the store holds them on disk
+    for path, follow in removed:
+        try:
+            os.removexattr(path, MDATA_KEY, follow_symlinks=follow)
+        except FileNotFoundError:
+            pass
+
+    print("%d files moved to %s" % (moved, logpath))
+
+
+def do_export(brick):
+    logpath = os.path.join(brick, ".glusterfs", LOG_NAME)
+    moved = 0
+
+    for (gfid, key), value in load(logpath)[0].items():
+        path = handle_path(brick, gfid)
+        try:
+            os.setxattr(path, key, value,
+                        follow_symlinks=os.path.islink(path))
+            moved += 1
+        except FileNotFoundError:
+            pass
+
+    os.rename(logpath, logpath + ".exported")
+    print("%d files moved back to xattrs, log kept as %s.exported" %
+          (moved, logpath))
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Move the time attributes of the files of a stopped "
+        "brick between xattrs and the metadata store.")
+    parser.add_argument("direction", choices=["import", "export"],
+                        help="import xattrs into the store or export the "
+                        "store back into xattrs")
+    parser.add_argument("brick", help="path of the stopped brick")
+    parser.add_argument("--remove-xattrs", action="store_true",
+                        help="on import, remove the xattrs moved")
+    args = parser.parse_args()
+
+    if not os.path.isdir(os.path.join(args.brick, ".glusterfs")):
+        sys.exit("%s is not a brick" % args.brick)
+
+    if args.direction == "import":
+        do_import(args.brick, args.remove_xattrs)
+    else:
+        do_export(args.brick)
+
+
+if __name__ == "__main__":
+    main()
@@ -110,6 +110,17 @@
 #define GF_XATTR_IOSTATS_DUMP_KEY "trusted.io-stats-dump"
 
 #define GF_READDIR_SKIP_DIRS "readdir-filter-directories"
+/* entries filled by the brick for a readdirp and the time it took */
+#define GF_READDIRP_FILL_COUNT_KEY "glusterfs.readdirp-fill-count"
+#define GF_READDIRP_FILL_USEC_KEY "glusterfs.readdirp-fill-usec"
+/* a readv asking the brick to leave the holes of the range out of the
+ * reply. The reply then carries the data extents back to back, and the map
+ * of where they go in the range: pairs of network order uint32 offset
+ * (from the start of the read) and length. The rest of the op_ret bytes
+ * read are zeroes. */
+#define GF_READ_SPARSE_KEY "glusterfs.read-sparse"
+#define GF_READ_DATA_MAP_KEY "glusterfs.read-data-map"
+#define GF_READ_DATA_SIZE_KEY "glusterfs.read-data-size"
 #define GF_MDC_LOADED_KEY_NAMES "glusterfs.mdc.loaded.key.names"
 
 #define BD_XATTR_KEY "user.glusterfs"
@@ -453,6 +464,14 @@ fop_enum_to_pri_string(glusterfs_fop_t fop);
 /* key value which quick read uses to get small files in lookup cbk */
 #define GF_CONTENT_KEY "glusterfs.content"
 
+/* keys open-behind uses to read a range of a file along with its open. The
+ * request carries the range, the reply the offset, the data read and the
+ * stat of the file */
+#define GF_OPEN_READ_OFFSET_KEY "glusterfs.open-read-offset"
+#define GF_OPEN_READ_SIZE_KEY "glusterfs.open-read-size"
+#define GF_OPEN_READ_KEY "glusterfs.open-read"
+#define GF_OPEN_READ_STAT_KEY "glusterfs.open-read-stat"
+
 struct _xlator_cmdline_option {
     struct list_head cmd_args;
     char *volume;
@@ -35,6 +35,8 @@
     ((void *)((unsigned long)(ptr + bound - 1) & (unsigned long)(~(bound - 1))))
 
 #define GF_IOBUF_ALIGN_SIZE 512
+/* alignment of the buffers meant for O_DIRECT I/O on any block size */
+#define GF_IOBUF_DIRECT_ALIGN_SIZE 4096
 #define USE_IOBUF_POOL_IF_SIZE_GREATER_THAN 131072
 
 /* one allocatable unit for the consumers of the IOBUF API */
@@ -184,4 +186,9 @@ iobuf_copy(struct iobuf_pool *iobuf_pool, const struct iovec *iovec_src,
            int iovcnt, struct iobref **iobref, struct iobuf **iobuf,
            struct iovec *iov_dst);
 
+typedef void (*iobuf_release_t)(void *data, void *ptr);
+
+struct iobuf *
+iobuf_wrap(void *ptr, size_t size, iobuf_release_t release, void *data);
+
 #endif /* !_IOBUF_H_ */
@@ -69,8 +69,8 @@ enum gf_common_mem_types_ {
     gf_common_mt_eh_t,
     gf_common_mt_store_handle_t, /* used only in one location */
     gf_common_mt_store_iter_t,   /* used only in one location */
-    gf_common_mt_drc_client_t,   /* used only in one location */
-    gf_common_mt_drc_globals_t,  /* used only in one location */
+    gf_common_mt_drc_op_t,       /* used only in one location */
+    gf_common_mt_drc_globals_t,
     gf_common_mt_groups_t,
     gf_common_mt_cliententry_t, /* used only in one location */
     gf_common_mt_clienttable_t, /* used only in one location */
@@ -119,6 +119,7 @@ enum gf_common_mem_types_ {
     gf_common_mt_mgmt_v3_lock_timer_t, /* used only in one location */
     gf_common_mt_server_cmdline_t,     /* used only in one location */
     gf_common_mt_latency_t,
+    gf_common_mt_rpcsvc_admit_t,
     gf_common_mt_end,
 };
 #endif
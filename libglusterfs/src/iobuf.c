@@ -617,8 +617,21 @@ iobuf_get_page_aligned(struct iobuf_pool *iobuf_pool, size_t page_size,
         req_size = iobuf_pool->default_page_size;
     }
 
-    req_size = req_size + align_size;
-    iobuf = iobuf_get2(iobuf_pool, req_size);
+    if (req_size <= USE_IOBUF_POOL_IF_SIZE_GREATER_THAN) {
+        /* small buffers stay out of the arenas even with the room to
+         * align them */
+        iobuf = iobuf_get_from_small(req_size + align_size);
+    } else if (gf_iobuf_get_pagesize(req_size, NULL) != -1) {
+        /* pages of the arenas start at multiples of their size in the
+         * mmap'd block and often need no room to be aligned */
+        iobuf = iobuf_get2(iobuf_pool, req_size);
+        if (iobuf && iobuf->ptr != GF_ALIGN_BUF(iobuf->ptr, align_size)) {
+            iobuf_unref(iobuf);
+            iobuf = iobuf_get2(iobuf_pool, req_size + align_size);
+        }
+    } else {
+        iobuf = iobuf_get2(iobuf_pool, req_size + align_size);
+    }
     if (!iobuf)
         return NULL;
     /* If std allocation was used, then free_ptr will be non-NULL. In this
@@ -700,6 +713,50 @@ out:
     return;
 }
 
+/* memory of someone else, handed out as an iobuf */
+struct iobuf_wrapped {
+    struct iobuf iobuf;
+    iobuf_release_t release;
+    void *data;
+};
+
+/* Makes an iobuf of @size bytes at @ptr, which the caller keeps owning.
+ * Once the last reference to the iobuf is dropped, @release is called
+ * with @data and @ptr, from whichever thread dropped it. */
+struct iobuf *
+iobuf_wrap(void *ptr, size_t size, iobuf_release_t release, void *data)
+{
+    struct iobuf_wrapped *wrapped = NULL;
+
+    wrapped = GF_MALLOC(sizeof(*wrapped), gf_common_mt_iobuf);
+    if (!wrapped)
+        return NULL;
+
+    wrapped->iobuf.ptr = ptr;
+    wrapped->iobuf.free_ptr = NULL; /* tells it apart in iobuf_put() */
+    wrapped->iobuf.page_size = size;
+    INIT_LIST_HEAD(&wrapped->iobuf.list);
+    wrapped->iobuf.iobuf_arena = NULL;
+    LOCK_INIT(&wrapped->iobuf.lock);
+    GF_ATOMIC_INIT(wrapped->iobuf.ref, 1);
+    wrapped->release = release;
+    wrapped->data = data;
+
+    return &wrapped->iobuf;
+}
+
+static void
+iobuf_wrapped_put(struct iobuf *iobuf)
+{
+    struct iobuf_wrapped *wrapped = NULL;
+
+    wrapped = caa_container_of(iobuf, struct iobuf_wrapped, iobuf);
+
+    LOCK_DESTROY(&iobuf->lock);
+    wrapped->release(wrapped->data, iobuf->ptr);
+    GF_FREE(wrapped);
+}
+
 void
 iobuf_put(struct iobuf *iobuf)
 {
@@ -709,6 +766,11 @@ iobuf_put(struct iobuf *iobuf)
     GF_VALIDATE_OR_GOTO("iobuf", iobuf, out);
 
     iobuf_arena = iobuf->iobuf_arena;
+    if (!iobuf_arena && !iobuf->free_ptr) {
+        iobuf_wrapped_put(iobuf);
+        return;
+    }
+
     if (!iobuf_arena) {
         LOCK_DESTROY(&iobuf->lock);
         GF_FREE(iobuf->free_ptr);
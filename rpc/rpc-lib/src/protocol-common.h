@@ -69,6 +69,7 @@ enum gf_fop_procnum {
     GFS3_OP_NAMELINK,
     GFS3_OP_PUT,
     GFS3_OP_COPY_FILE_RANGE,
+    GFS3_OP_BATCH,
     GFS3_OP_MAXVALUE,
 };
 
@@ -344,6 +345,17 @@ typedef enum gf_getspec_flags_type gf_getspec_flags_type;
 
 #define GLUSTER_FOP_VERSION_v2 400 /* 4.0.0 */
 
+/* Procedures of the 4.x fops program a GFS3_OP_BATCH call may carry: those
+ * without a payload on either side, which do not change anything. */
+#define GFS3_OP_BATCHABLE(procnum)                                             \
+    ((procnum) == GFS3_OP_LOOKUP || (procnum) == GFS3_OP_STAT ||               \
+     (procnum) == GFS3_OP_FSTAT || (procnum) == GFS3_OP_ACCESS ||              \
+     (procnum) == GFS3_OP_READLINK || (procnum) == GFS3_OP_GETXATTR ||         \
+     (procnum) == GFS3_OP_FGETXATTR || (procnum) == GFS3_OP_STATFS)
+
+/* Most requests a GFS3_OP_BATCH call may carry. */
+#define GFS3_BATCH_MAX_OPS 64
+
 /* Aggregator */
 #define GLUSTER_AGGREGATOR_PROGRAM 29852134 /* Completely random */
 #define GLUSTER_AGGREGATOR_VERSION 1
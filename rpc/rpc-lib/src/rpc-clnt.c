@@ -22,6 +22,72 @@
 void
 rpc_clnt_reply_deinit(struct rpc_req *req, struct mem_pool *pool);
 
+static struct saved_frame **
+__saved_frames_bucket(struct saved_frames *frames, uint32_t xid)
+{
+    return &frames->xid_table[xid & frames->xid_mask];
+}
+
+/* Doubles the xid table. The frames stay in the smaller one if it can't
+ * be allocated, in longer chains. */
+static void
+__saved_frames_grow(struct saved_frames *frames)
+{
+    struct saved_frame **old_table = frames->xid_table;
+    struct saved_frame **bucket = NULL;
+    struct saved_frame *trav = NULL;
+    struct saved_frame *next = NULL;
+    uint32_t old_size = frames->xid_mask + 1;
+    uint32_t i = 0;
+
+    frames->xid_table = GF_CALLOC(old_size * 2, sizeof(*frames->xid_table),
+                                  gf_common_mt_rpcclnt_savedframe_t);
+    if (!frames->xid_table) {
+        frames->xid_table = old_table;
+        return;
+    }
+    frames->xid_mask = old_size * 2 - 1;
+
+    for (i = 0; i < old_size; i++) {
+        for (trav = old_table[i]; trav; trav = next) {
+            next = trav->xid_next;
+            bucket = __saved_frames_bucket(frames, trav->rpcreq->xid);
+            trav->xid_next = *bucket;
+            *bucket = trav;
+        }
+    }
+
+    GF_FREE(old_table);
+}
+
+static void
+__saved_frames_unhash(struct saved_frames *frames,
+                      struct saved_frame *saved_frame)
+{
+    struct saved_frame **pos = NULL;
+
+    pos = __saved_frames_bucket(frames, saved_frame->rpcreq->xid);
+    while (*pos && *pos != saved_frame)
+        pos = &(*pos)->xid_next;
+    if (*pos)
+        *pos = saved_frame->xid_next;
+    saved_frame->xid_next = NULL;
+}
+
+static struct saved_frame *
+__saved_frames_lookup(struct saved_frames *frames, uint32_t xid)
+{
+    struct saved_frame *trav = NULL;
+
+    for (trav = *__saved_frames_bucket(frames, xid); trav;
+         trav = trav->xid_next) {
+        if (trav->rpcreq->xid == xid)
+            break;
+    }
+
+    return trav;
+}
+
 static struct saved_frame *
 __saved_frames_get_timedout(struct saved_frames *frames, time_t latest)
 {
@@ -32,6 +98,7 @@ __saved_frames_get_timedout(struct saved_frames *frames, time_t latest)
         if (tmp->saved_at <= latest) {
             bailout_frame = tmp;
             list_del_init(&bailout_frame->list);
+            __saved_frames_unhash(frames, bailout_frame);
             frames->count--;
         }
     }
@@ -57,6 +124,7 @@ static struct saved_frame *
 __saved_frames_put(struct saved_frames *frames, void *frame,
                    struct rpc_req *rpcreq)
 {
+    struct saved_frame **bucket = NULL;
     struct saved_frame *saved_frame = mem_get(
         rpcreq->conn->rpc_clnt->saved_frames_pool);
 
@@ -79,6 +147,12 @@ __saved_frames_put(struct saved_frames *frames, void *frame,
         list_add_tail(&saved_frame->list, &frames->sf.list);
 
     frames->count++;
+    if (frames->count > frames->xid_mask)
+        __saved_frames_grow(frames);
+
+    bucket = __saved_frames_bucket(frames, rpcreq->xid);
+    saved_frame->xid_next = *bucket;
+    *bucket = saved_frame;
 
 out:
     return saved_frame;
@@ -237,6 +311,15 @@ saved_frames_new(void)
     INIT_LIST_HEAD(&saved_frames->sf.list);
     INIT_LIST_HEAD(&saved_frames->lk_sf.list);
 
+    saved_frames->xid_table = GF_CALLOC(SAVED_FRAMES_XID_TABLE_MIN,
+                                        sizeof(*saved_frames->xid_table),
+                                        gf_common_mt_rpcclnt_savedframe_t);
+    if (!saved_frames->xid_table) {
+        GF_FREE(saved_frames);
+        return NULL;
+    }
+    saved_frames->xid_mask = SAVED_FRAMES_XID_TABLE_MIN - 1;
+
     return saved_frames;
 }
 
@@ -252,22 +335,10 @@ __saved_frame_copy(struct saved_frames *frames, int64_t callid,
         goto out;
     }
 
-    list_for_each_entry(tmp, &frames->sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            *saved_frame = *tmp;
-            ret = 0;
-            goto out;
-        }
-    }
-
-    list_for_each_entry(tmp, &frames->lk_sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            *saved_frame = *tmp;
-            ret = 0;
-            goto out;
-        }
+    tmp = __saved_frames_lookup(frames, callid);
+    if (tmp) {
+        *saved_frame = *tmp;
+        ret = 0;
     }
 
 out:
@@ -278,30 +349,12 @@ struct saved_frame *
 __saved_frame_get(struct saved_frames *frames, int64_t callid)
 {
     struct saved_frame *saved_frame = NULL;
-    struct saved_frame *tmp = NULL;
-
-    list_for_each_entry(tmp, &frames->sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            list_del_init(&tmp->list);
-            frames->count--;
-            saved_frame = tmp;
-            goto out;
-        }
-    }
 
-    list_for_each_entry(tmp, &frames->lk_sf.list, list)
-    {
-        if (tmp->rpcreq->xid == callid) {
-            list_del_init(&tmp->list);
-            frames->count--;
-            saved_frame = tmp;
-            goto out;
-        }
-    }
-
-out:
+    saved_frame = __saved_frames_lookup(frames, callid);
     if (saved_frame) {
+        list_del_init(&saved_frame->list);
+        __saved_frames_unhash(frames, saved_frame);
+        frames->count--;
         THIS = saved_frame->capital_this;
     }
 
@@ -318,6 +371,8 @@ saved_frames_unwind(struct saved_frames *saved_frames)
     };
 
     list_splice_init(&saved_frames->lk_sf.list, &saved_frames->sf.list);
+    memset(saved_frames->xid_table, 0,
+           (saved_frames->xid_mask + 1) * sizeof(*saved_frames->xid_table));
 
     list_for_each_entry_safe(trav, tmp, &saved_frames->sf.list, list)
     {
@@ -356,6 +411,7 @@ saved_frames_destroy(struct saved_frames *frames)
 
     saved_frames_unwind(frames);
 
+    GF_FREE(frames->xid_table);
     GF_FREE(frames);
 }
 
@@ -61,12 +61,22 @@ struct saved_frame {
     struct rpc_req *rpcreq;
     time_t saved_at;
     rpc_transport_rsp_t rsp;
+    struct saved_frame *xid_next; /* in its bucket of the xid table */
 };
 
+/* Frames waiting for their reply. The lists keep them in the order they
+ * were sent, which is the order they time out in, and the xid table finds
+ * the frame of a reply. xids are handed out in sequence, so indexing the
+ * table by the low bits of the xid puts few frames in each bucket; it
+ * doubles when it holds more frames than buckets. */
+#define SAVED_FRAMES_XID_TABLE_MIN 256
+
 struct saved_frames {
     int64_t count;
     struct saved_frame sf;
     struct saved_frame lk_sf;
+    struct saved_frame **xid_table;
+    uint32_t xid_mask; /* buckets - 1 */
 };
 
 /* Initialized by procnum */
@@ -14,199 +14,160 @@
 #endif
 #include <glusterfs/locking.h>
 #include <glusterfs/statedump.h>
-#include <glusterfs/mem-pool.h>
+#include <glusterfs/hashfn.h>
 
 #include <netinet/in.h>
 #include <unistd.h>
 
 /**
- * rpcsvc_drc_op_destroy - Destroys the cached reply
+ * rpcsvc_drc_op_destroy - Destroys the cached op and its reply
  *
- * @param drc - the main drc structure
- * @param reply - the cached reply to destroy
- * @return NULL if reply is destroyed, reply otherwise
+ * @param op - the cached op to destroy
+ * @return void
  */
-static drc_cached_op_t *
-rpcsvc_drc_op_destroy(rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply)
+static void
+rpcsvc_drc_op_destroy(drc_cached_op_t *op)
 {
-    GF_ASSERT(drc);
-    GF_ASSERT(reply);
-
-    if (reply->state == DRC_OP_IN_TRANSIT)
-        return reply;
-
-    iobref_unref(reply->msg.iobref);
-    if (reply->msg.rpchdr)
-        GF_FREE(reply->msg.rpchdr);
-    if (reply->msg.proghdr)
-        GF_FREE(reply->msg.proghdr);
-    if (reply->msg.progpayload)
-        GF_FREE(reply->msg.progpayload);
-
-    list_del(&reply->global_list);
-    reply->client->op_count--;
-    drc->op_count--;
-    mem_put(reply);
-    reply = NULL;
-
-    return reply;
+    if (op->iobref)
+        iobref_unref(op->iobref);
+    GF_FREE(op);
 }
 
 /**
- * rpcsvc_drc_op_rb_unref - This function is used in rb tree cleanup only
+ * __rpcsvc_drc_op_unref - unref the cached op, and destroy it on last unref.
+ *                         To be called with the lock of its shard held.
  *
- * @param reply - the cached reply to unref
- * @param drc - the main drc structure
+ * @param op - the cached op to unref
  * @return void
  */
 static void
-rpcsvc_drc_rb_op_destroy(void *reply, void *drc)
+__rpcsvc_drc_op_unref(drc_cached_op_t *op)
 {
-    rpcsvc_drc_op_destroy(drc, (drc_cached_op_t *)reply);
+    if (--op->ref == 0)
+        rpcsvc_drc_op_destroy(op);
 }
 
 /**
- * rpcsvc_remove_drc_client - Cleanup the drc client
+ * rpcsvc_drc_op_unref - unref a cached op got from rpcsvc_drc_lookup
  *
- * @param client - the drc client to be removed
+ * @param op - the cached op to unref
  * @return void
  */
-static void
-rpcsvc_remove_drc_client(drc_client_t *client)
+void
+rpcsvc_drc_op_unref(drc_cached_op_t *op)
 {
-    rb_destroy(client->rbtree, rpcsvc_drc_rb_op_destroy);
-    list_del(&client->client_list);
-    GF_FREE(client);
+    struct drc_shard *shard = op->shard;
+
+    LOCK(&shard->lock);
+    __rpcsvc_drc_op_unref(op);
+    UNLOCK(&shard->lock);
 }
 
 /**
- * rpcsvc_client_lookup - Given a sockaddr_storage, find the client if it exists
+ * __rpcsvc_drc_op_unhash - remove an op from the cache, with the lock of its
+ *                          shard held
  *
- * @param drc - the main drc structure
- * @param sockaddr - the network address of the client to be looked up
- * @return drc client if it exists, NULL otherwise
+ * @param shard - the shard holding op
+ * @param op - the cached op to remove
+ * @return void
  */
-static drc_client_t *
-rpcsvc_client_lookup(rpcsvc_drc_globals_t *drc,
-                     struct sockaddr_storage *sockaddr)
+static void
+__rpcsvc_drc_op_unhash(struct drc_shard *shard, drc_cached_op_t *op)
 {
-    drc_client_t *client = NULL;
-
-    GF_ASSERT(drc);
-    GF_ASSERT(sockaddr);
-
-    if (list_empty(&drc->clients_head))
-        return NULL;
-
-    list_for_each_entry(client, &drc->clients_head, client_list)
-    {
-        if (gf_sock_union_equal_addr(&client->sock_union,
-                                     (union gf_sock_union *)sockaddr))
-            return client;
-    }
-
-    return NULL;
+    list_del_init(&op->hash_list);
+    list_del_init(&op->lru_list);
+    op->hashed = _gf_false;
+    shard->op_count--;
+    shard->bytes -= op->size;
+    __rpcsvc_drc_op_unref(op);
 }
 
 /**
- * drc_compare_reqs - Used by rbtree to determine if incoming req matches with
- *                    an existing node(cached reply) in rbtree
+ * __rpcsvc_vacate_drc_entries - evict the oldest completed ops of a shard
  *
- * @param item - pointer to the incoming req
- * @param rb_node_data - pointer to an rbtree node (cached reply)
- * @param param - drc pointer - unused here, but used in *op_destroy
- * @return 0 if req matches reply, else (req->xid - reply->xid)
+ * @param shard - the shard to free up
+ * @param count - no. of ops to evict at least
+ * @param max_bytes - evict further until the shard uses no more than this
+ * @return void
  */
-int
-drc_compare_reqs(const void *item, const void *rb_node_data, void *param)
+static void
+__rpcsvc_vacate_drc_entries(struct drc_shard *shard, uint32_t count,
+                            uint64_t max_bytes)
 {
-    int ret = -1;
-    drc_cached_op_t *req = NULL;
-    drc_cached_op_t *reply = NULL;
-
-    GF_ASSERT(item);
-    GF_ASSERT(rb_node_data);
-    GF_ASSERT(param);
-
-    req = (drc_cached_op_t *)item;
-    reply = (drc_cached_op_t *)rb_node_data;
+    drc_cached_op_t *op = NULL;
+    drc_cached_op_t *tmp = NULL;
 
-    ret = req->xid - reply->xid;
-    if (ret != 0)
-        return ret;
+    list_for_each_entry_safe(op, tmp, &shard->lru, lru_list)
+    {
+        if (!count && shard->bytes <= max_bytes)
+            break;
 
-    if (req->prognum == reply->prognum && req->procnum == reply->procnum &&
-        req->progversion == reply->progversion)
-        return 0;
+        /* Don't delete ops that are in transit */
+        if (op->state == DRC_OP_IN_TRANSIT)
+            continue;
 
-    return 1;
+        __rpcsvc_drc_op_unhash(shard, op);
+        shard->evictions++;
+        if (count)
+            count--;
+    }
 }
 
 /**
- * drc_init_client_cache - initialize a drc client and its rb tree
+ * rpcsvc_drc_op_hash - hash the key of an op: the client address, the xid
+ *                      and the checksum of the arguments
  *
- * @param drc - the main drc structure
- * @param client - the drc client to be initialized
- * @return 0 on success, -1 on failure
+ * @param op - the op to hash
+ * @return the hash
  */
-static int
-drc_init_client_cache(rpcsvc_drc_globals_t *drc, drc_client_t *client)
+static uint32_t
+rpcsvc_drc_op_hash(drc_cached_op_t *op)
 {
-    GF_ASSERT(drc);
-    GF_ASSERT(client);
+    uint32_t hash = 0;
 
-    client->rbtree = rb_create(drc_compare_reqs, drc, NULL);
-    if (!client->rbtree) {
-        gf_log(GF_RPCSVC, GF_LOG_DEBUG, "rb tree creation failed");
-        return -1;
+    switch (op->sock_union.storage.ss_family) {
+        case AF_INET:
+            hash = op->sock_union.sin.sin_addr.s_addr;
+            break;
+        case AF_INET6:
+            hash = SuperFastHash((char *)&op->sock_union.sin6.sin6_addr,
+                                 sizeof(op->sock_union.sin6.sin6_addr));
+            break;
+        default:
+            break;
     }
 
-    return 0;
+    hash ^= op->xid * 0x9e3779b1;
+    hash ^= op->csum;
+
+    /* spread the xid, which mostly differs in its low bits, over all of
+     * the bits picking the shard and the bucket */
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6b;
+    hash ^= hash >> 13;
+
+    return hash;
 }
 
 /**
- * rpcsvc_get_drc_client - find the drc client with given sockaddr, else
- *                         allocate and initialize a new drc client
+ * rpcsvc_drc_op_match - check if a cached op is the one looked up
  *
- * @param drc - the main drc structure
- * @param sockaddr - network address of client
- * @return drc client on success, NULL on failure
+ * @param op - the cached op
+ * @param key - the op looked up
+ * @return _gf_true if they match, _gf_false otherwise
  */
-static drc_client_t *
-rpcsvc_get_drc_client(rpcsvc_drc_globals_t *drc,
-                      struct sockaddr_storage *sockaddr)
+static gf_boolean_t
+rpcsvc_drc_op_match(drc_cached_op_t *op, drc_cached_op_t *key)
 {
-    drc_client_t *client = NULL;
-
-    GF_ASSERT(drc);
-    GF_ASSERT(sockaddr);
-
-    client = rpcsvc_client_lookup(drc, sockaddr);
-    if (client)
-        goto out;
+    if (op->hash != key->hash || op->xid != key->xid ||
+        op->csum != key->csum)
+        return _gf_false;
 
-    /* if lookup fails, allocate cache for the new client */
-    client = GF_CALLOC(1, sizeof(drc_client_t), gf_common_mt_drc_client_t);
-    if (!client)
-        goto out;
-
-    GF_ATOMIC_INIT(client->ref, 0);
-    client->sock_union = (union gf_sock_union) * sockaddr;
-    client->op_count = 0;
-    INIT_LIST_HEAD(&client->client_list);
+    if (op->prognum != key->prognum || op->procnum != key->procnum ||
+        op->progversion != key->progversion)
+        return _gf_false;
 
-    if (drc_init_client_cache(drc, client)) {
-        gf_log(GF_RPCSVC, GF_LOG_DEBUG, "initialization of drc client failed");
-        GF_FREE(client);
-        client = NULL;
-        goto out;
-    }
-    drc->client_count++;
-
-    list_add(&client->client_list, &drc->clients_head);
-
-out:
-    return client;
+    return gf_sock_union_equal_addr(&op->sock_union, &key->sock_union);
 }
 
 /**
@@ -237,81 +198,96 @@ rpcsvc_need_drc(rpcsvc_request_t *req)
 }
 
 /**
- * rpcsvc_drc_client_ref - ref the drc client
- *
- * @param client - the drc client to ref
- * @return client
- */
-static drc_client_t *
-rpcsvc_drc_client_ref(drc_client_t *client)
-{
-    GF_ASSERT(client);
-    GF_ATOMIC_INC(client->ref);
-    return client;
-}
-
-/**
- * rpcsvc_drc_client_unref - unref the drc client, and destroy
- *                           the client on last unref
- *
- * @param drc - the main drc structure
- * @param client - the drc client to unref
- * @return NULL if it is the last unref, client otherwise
- */
-static drc_client_t *
-rpcsvc_drc_client_unref(rpcsvc_drc_globals_t *drc, drc_client_t *client)
-{
-    uint32_t refcount;
-
-    GF_ASSERT(drc);
-
-    refcount = GF_ATOMIC_DEC(client->ref);
-    if (!refcount) {
-        drc->client_count--;
-        rpcsvc_remove_drc_client(client);
-        client = NULL;
-    }
-
-    return client;
-}
-
-/**
- * rpcsvc_drc_lookup - lookup a request to see if it is already cached
+ * rpcsvc_drc_lookup - lookup a request to see if it is already cached, and
+ *                     cache it as in transit if it is not
  *
  * @param req - incoming request
- * @return cached reply of req if found, NULL otherwise
+ * @param state - set to the state of the cached op found
+ * @return the cached op req duplicates, with a ref the caller drops with
+ *         rpcsvc_drc_op_unref(), NULL otherwise
  */
 drc_cached_op_t *
-rpcsvc_drc_lookup(rpcsvc_request_t *req)
+rpcsvc_drc_lookup(rpcsvc_request_t *req, drc_op_state_t *state)
 {
-    drc_client_t *client = NULL;
+    drc_cached_op_t *new = NULL;
+    drc_cached_op_t *op = NULL;
     drc_cached_op_t *reply = NULL;
-    drc_cached_op_t new = {
-        .xid = req->xid,
-        .prognum = req->prognum,
-        .progversion = req->progver,
-        .procnum = req->procnum,
-    };
+    struct drc_shard *shard = NULL;
+    struct list_head *bucket = NULL;
+    size_t len = 0;
 
     GF_ASSERT(req);
 
-    if (!req->trans->drc_client) {
-        client = rpcsvc_get_drc_client(req->svc->drc,
-                                       &req->trans->peerinfo.sockaddr);
-        if (!client)
-            goto out;
+    /* allocated ahead, so that the shard is not locked across it */
+    new = GF_CALLOC(1, sizeof(*new), gf_common_mt_drc_op_t);
+    if (!new)
+        return NULL;
 
-        req->trans->drc_client = rpcsvc_drc_client_ref(client);
+    INIT_LIST_HEAD(&new->hash_list);
+    INIT_LIST_HEAD(&new->lru_list);
+    new->sock_union.storage = req->trans->peerinfo.sockaddr;
+    new->xid = req->xid;
+    new->prognum = req->prognum;
+    new->progversion = req->progver;
+    new->procnum = req->procnum;
+    if (req->count) {
+        len = min(req->msg[0].iov_len, DRC_CSUM_LEN);
+        new->csum = SuperFastHash(req->msg[0].iov_base, len);
     }
+    new->hash = rpcsvc_drc_op_hash(new);
+    new->state = DRC_OP_IN_TRANSIT;
+    new->size = sizeof(*new);
+    /* one for the cache, one for req */
+    new->ref = 2;
 
-    client = req->trans->drc_client;
+    shard = &req->svc->drc->shards[new->hash % DRC_SHARDS];
+    new->shard = shard;
 
-    if (client->op_count == 0)
-        goto out;
+    LOCK(&shard->lock);
+    {
+        /* the cache got turned off meanwhile */
+        if (!shard->buckets)
+            goto unlock;
 
-    reply = rb_find(client->rbtree, &new);
+        bucket = &shard->buckets[(new->hash / DRC_SHARDS) &
+                                 (shard->nbuckets - 1)];
+
+        list_for_each_entry(op, bucket, hash_list)
+        {
+            if (!rpcsvc_drc_op_match(op, new))
+                continue;
+
+            *state = op->state;
+            if (op->state == DRC_OP_CACHED) {
+                shard->cache_hits++;
+                list_move_tail(&op->lru_list, &shard->lru);
+            } else {
+                shard->intransit_hits++;
+            }
+            op->ref++;
+            reply = op;
+            goto unlock;
+        }
+
+        /* shard is full, free up some space */
+        if (shard->op_count >= shard->max_ops)
+            __rpcsvc_vacate_drc_entries(shard, shard->vacate,
+                                        shard->max_bytes);
+
+        list_add(&new->hash_list, bucket);
+        list_add_tail(&new->lru_list, &shard->lru);
+        new->hashed = _gf_true;
+        shard->op_count++;
+        shard->bytes += new->size;
+
+        req->reply = new;
+        new = NULL;
+    }
+unlock:
+    UNLOCK(&shard->lock);
+
+    GF_FREE(new);
 
-out:
     return reply;
 }
 
@@ -326,8 +302,6 @@ out:
 int
 rpcsvc_send_cached_reply(rpcsvc_request_t *req, drc_cached_op_t *reply)
 {
-    int ret = 0;
-
     GF_ASSERT(req);
     GF_ASSERT(reply);
 
@@ -336,14 +310,10 @@ rpcsvc_send_cached_reply(rpcsvc_request_t *req, drc_cached_op_t *reply)
            "client: %s",
            req->xid, req->trans->peerinfo.identifier);
 
-    rpcsvc_drc_client_ref(reply->client);
-    ret = rpcsvc_transport_submit(
-        req->trans, reply->msg.rpchdr, reply->msg.rpchdrcount,
-        reply->msg.proghdr, reply->msg.proghdrcount, reply->msg.progpayload,
-        reply->msg.progpayloadcount, reply->msg.iobref, req->trans_private);
-    rpcsvc_drc_client_unref(req->svc->drc, reply->client);
-
-    return ret;
+    /* the reply does not change once cached, and the transport refs its
+     * iobref for as long as it needs it */
+    return rpcsvc_transport_submit(req->trans, &reply->reply, 1, NULL, 0, NULL,
+                                   0, reply->iobref, req->trans_private);
 }
 
 /**
@@ -366,158 +336,95 @@ rpcsvc_cache_reply(rpcsvc_request_t *req, struct iobref *iobref,
 {
     int ret = -1;
     drc_cached_op_t *reply = NULL;
+    struct drc_shard *shard = NULL;
+    struct iobuf *iob = NULL;
+    struct iobref *copy = NULL;
+    char *ptr = NULL;
+    size_t len = 0;
 
     GF_ASSERT(req);
     GF_ASSERT(req->reply);
 
     reply = req->reply;
+    shard = reply->shard;
 
-    reply->state = DRC_OP_CACHED;
-
-    reply->msg.iobref = iobref_ref(iobref);
-
-    reply->msg.rpchdrcount = rpchdrcount;
-    reply->msg.rpchdr = iov_dup(rpchdr, rpchdrcount);
-
-    reply->msg.proghdrcount = proghdrcount;
-    reply->msg.proghdr = iov_dup(proghdr, proghdrcount);
-
-    reply->msg.progpayloadcount = payloadcount;
-    if (payloadcount)
-        reply->msg.progpayload = iov_dup(payload, payloadcount);
-
-    //        rpcsvc_drc_client_unref (req->svc->drc, req->trans->drc_client);
-    //        rpcsvc_drc_op_unref (req->svc->drc, reply);
-    ret = 0;
-
-    return ret;
-}
+    /* Replies to non-idempotent calls are a few hundred bytes, built in
+     * buffers of the default size, so they are copied rather than kept
+     * in those. */
+    len = iov_length(rpchdr, rpchdrcount) + iov_length(proghdr, proghdrcount) +
+          iov_length(payload, payloadcount);
 
-/**
- * rpcsvc_vacate_drc_entries - free up some percentage of drc cache
- *                             based on the lru factor
- *
- * @param drc - the main drc structure
- * @return void
- */
-static void
-rpcsvc_vacate_drc_entries(rpcsvc_drc_globals_t *drc)
-{
-    uint32_t i = 0;
-    uint32_t n = 0;
-    drc_cached_op_t *reply = NULL;
-    drc_cached_op_t *tmp = NULL;
-    drc_client_t *client = NULL;
+    iob = iobuf_get2(req->svc->ctx->iobuf_pool, len);
+    if (!iob)
+        goto out;
 
-    GF_ASSERT(drc);
+    copy = iobref_new();
+    if (!copy || iobref_add(copy, iob))
+        goto out;
 
-    n = drc->global_cache_size / drc->lru_factor;
+    ptr = iob->ptr;
+    iov_unload(ptr, rpchdr, rpchdrcount);
+    ptr += iov_length(rpchdr, rpchdrcount);
+    iov_unload(ptr, proghdr, proghdrcount);
+    ptr += iov_length(proghdr, proghdrcount);
+    iov_unload(ptr, payload, payloadcount);
 
-    list_for_each_entry_safe_reverse(reply, tmp, &drc->cache_head, global_list)
+    LOCK(&shard->lock);
     {
-        /* Don't delete ops that are in transit */
-        if (reply->state == DRC_OP_IN_TRANSIT)
-            continue;
-
-        client = reply->client;
-
-        rb_delete(client->rbtree, reply);
-
-        rpcsvc_drc_op_destroy(drc, reply);
-        rpcsvc_drc_client_unref(drc, client);
-        i++;
-        if (i >= n)
-            break;
-    }
-}
-
-/**
- * rpcsvc_add_op_to_cache - insert the cached op into the client rbtree and drc
- * list
- *
- * @param drc - the main drc structure
- * @param reply - the op to be inserted
- * @return 0 on success, -1 on failure
- */
-static int
-rpcsvc_add_op_to_cache(rpcsvc_drc_globals_t *drc, drc_cached_op_t *reply)
-{
-    drc_client_t *client = NULL;
-    drc_cached_op_t **tmp_reply = NULL;
-
-    GF_ASSERT(drc);
-    GF_ASSERT(reply);
+        /* evicted by the cache getting turned off, req cleans it up */
+        if (!reply->hashed) {
+            ret = 0;
+            goto unlock;
+        }
 
-    client = reply->client;
+        reply->reply.iov_base = iob->ptr;
+        reply->reply.iov_len = len;
+        reply->iobref = copy;
+        copy = NULL;
+        reply->state = DRC_OP_CACHED;
 
-    /* cache is full, free up some space */
-    if (drc->op_count >= drc->global_cache_size)
-        rpcsvc_vacate_drc_entries(drc);
+        reply->size += iobuf_size(iob);
+        shard->bytes += iobuf_size(iob);
+        if (shard->bytes > shard->max_bytes)
+            __rpcsvc_vacate_drc_entries(shard, 0, shard->max_bytes);
 
-    tmp_reply = (drc_cached_op_t **)rb_probe(client->rbtree, reply);
-    if (!tmp_reply) {
-        /* mem alloc failed */
-        return -1;
-    } else if (*tmp_reply != reply) {
-        /* should never happen */
-        gf_log(GF_RPCSVC, GF_LOG_ERROR, "DRC failed to detect duplicates");
-        return -1;
+        ret = 0;
     }
+unlock:
+    UNLOCK(&shard->lock);
+out:
+    if (copy)
+        iobref_unref(copy);
+    if (iob)
+        iobuf_unref(iob);
 
-    client->op_count++;
-    list_add(&reply->global_list, &drc->cache_head);
-    drc->op_count++;
-
-    return 0;
+    return ret;
 }
 
 /**
- * rpcsvc_cache_request - cache the in-transition incoming request
+ * rpcsvc_drc_request_done - drop the ref of a request on its cached op, once
+ *                           it is done with
  *
- * @param req - incoming request
- * @return 0 on success, -1 on failure
+ * @param req - request being destroyed
+ * @return void
  */
-int
-rpcsvc_cache_request(rpcsvc_request_t *req)
+void
+rpcsvc_drc_request_done(rpcsvc_request_t *req)
 {
-    int ret = -1;
-    drc_client_t *client = NULL;
-    drc_cached_op_t *reply = NULL;
-    rpcsvc_drc_globals_t *drc = NULL;
-
-    GF_ASSERT(req);
-
-    drc = req->svc->drc;
-
-    client = req->trans->drc_client;
-    if (!client) {
-        gf_log(GF_RPCSVC, GF_LOG_DEBUG, "drc client is NULL");
-        goto out;
-    }
-
-    reply = mem_get0(drc->mempool);
-    if (!reply)
-        goto out;
+    drc_cached_op_t *op = req->reply;
+    struct drc_shard *shard = op->shard;
 
-    reply->client = rpcsvc_drc_client_ref(client);
-    reply->xid = req->xid;
-    reply->prognum = req->prognum;
-    reply->progversion = req->progver;
-    reply->procnum = req->procnum;
-    reply->state = DRC_OP_IN_TRANSIT;
-    req->reply = reply;
-    INIT_LIST_HEAD(&reply->global_list);
+    LOCK(&shard->lock);
+    {
+        /* no reply got cached, a retransmission has to be served afresh */
+        if (op->hashed && op->state == DRC_OP_IN_TRANSIT)
+            __rpcsvc_drc_op_unhash(shard, op);
 
-    ret = rpcsvc_add_op_to_cache(drc, reply);
-    if (ret) {
-        req->reply = NULL;
-        rpcsvc_drc_op_destroy(drc, reply);
-        rpcsvc_drc_client_unref(drc, client);
-        gf_log(GF_RPCSVC, GF_LOG_DEBUG, "Failed to add op to drc cache");
+        __rpcsvc_drc_op_unref(op);
     }
+    UNLOCK(&shard->lock);
 
-out:
-    return ret;
+    req->reply = NULL;
 }
 
 /**
@@ -532,8 +439,12 @@ rpcsvc_drc_priv(rpcsvc_drc_globals_t *drc)
 {
     int i = 0;
     char key[GF_DUMP_MAX_BUF_LEN] = {0};
-    drc_client_t *client = NULL;
-    char ip[INET6_ADDRSTRLEN] = {0};
+    struct drc_shard *shard = NULL;
+    uint64_t op_count = 0;
+    uint64_t bytes = 0;
+    uint64_t cache_hits = 0;
+    uint64_t intransit_hits = 0;
+    uint64_t evictions = 0;
 
     if (!drc || drc->status == DRC_UNINITIATED) {
         gf_log(GF_RPCSVC, GF_LOG_DEBUG,
@@ -547,114 +458,89 @@ rpcsvc_drc_priv(rpcsvc_drc_globals_t *drc)
     if (TRY_LOCK(&drc->lock))
         return -1;
 
+    for (i = 0; i < DRC_SHARDS; i++) {
+        shard = &drc->shards[i];
+
+        LOCK(&shard->lock);
+        {
+            op_count += shard->op_count;
+            bytes += shard->bytes;
+            cache_hits += shard->cache_hits;
+            intransit_hits += shard->intransit_hits;
+            evictions += shard->evictions;
+        }
+        UNLOCK(&shard->lock);
+    }
+
     gf_proc_dump_build_key(key, "drc", "type");
     gf_proc_dump_write(key, "%d", drc->type);
 
-    gf_proc_dump_build_key(key, "drc", "client_count");
-    gf_proc_dump_write(key, "%d", drc->client_count);
+    gf_proc_dump_build_key(key, "drc", "shards");
+    gf_proc_dump_write(key, "%d", DRC_SHARDS);
 
     gf_proc_dump_build_key(key, "drc", "current_cache_size");
-    gf_proc_dump_write(key, "%d", drc->op_count);
+    gf_proc_dump_write(key, "%" PRIu64, op_count);
 
     gf_proc_dump_build_key(key, "drc", "max_cache_size");
     gf_proc_dump_write(key, "%d", drc->global_cache_size);
 
+    gf_proc_dump_build_key(key, "drc", "current_cache_bytes");
+    gf_proc_dump_write(key, "%" PRIu64, bytes);
+
+    gf_proc_dump_build_key(key, "drc", "max_cache_bytes");
+    gf_proc_dump_write(key, "%" PRIu64, drc->max_bytes);
+
     gf_proc_dump_build_key(key, "drc", "lru_factor");
     gf_proc_dump_write(key, "%d", drc->lru_factor);
 
     gf_proc_dump_build_key(key, "drc", "duplicate_request_count");
-    gf_proc_dump_write(key, "%" PRIu64, drc->cache_hits);
+    gf_proc_dump_write(key, "%" PRIu64, cache_hits);
 
     gf_proc_dump_build_key(key, "drc", "in_transit_duplicate_requests");
-    gf_proc_dump_write(key, "%" PRIu64, drc->intransit_hits);
+    gf_proc_dump_write(key, "%" PRIu64, intransit_hits);
 
-    list_for_each_entry(client, &drc->clients_head, client_list)
-    {
-        gf_proc_dump_build_key(key, "client", "%d.ip-address", i);
-        memset(ip, 0, INET6_ADDRSTRLEN);
-        switch (client->sock_union.storage.ss_family) {
-            case AF_INET:
-                gf_proc_dump_write(
-                    key, "%s",
-                    inet_ntop(AF_INET, &client->sock_union.sin.sin_addr.s_addr,
-                              ip, INET_ADDRSTRLEN));
-                break;
-            case AF_INET6:
-                gf_proc_dump_write(
-                    key, "%s",
-                    inet_ntop(AF_INET6, &client->sock_union.sin6.sin6_addr, ip,
-                              INET6_ADDRSTRLEN));
-                break;
-            default:
-                gf_proc_dump_write(key, "%s", "N/A");
-        }
-
-        gf_proc_dump_build_key(key, "client", "%d.ref_count", i);
-        gf_proc_dump_write(key, "%" PRIu32, GF_ATOMIC_GET(client->ref));
-        gf_proc_dump_build_key(key, "client", "%d.op_count", i);
-        gf_proc_dump_write(key, "%d", client->op_count);
-        i++;
-    }
+    gf_proc_dump_build_key(key, "drc", "evictions");
+    gf_proc_dump_write(key, "%" PRIu64, evictions);
 
     UNLOCK(&drc->lock);
     return 0;
 }
 
 /**
- * rpcsvc_drc_notify - function which is notified of RPC transport events
+ * rpcsvc_drc_flush - empty the cache and release its hash tables
  *
- * @param svc - pointer to rpcsvc_t structure of the rpc
- * @param xl - pointer to the xlator
- * @param event - the event which triggered this notify
- * @param data - the transport structure
- * @return 0 on success, -1 on failure
+ * @param drc - the main drc structure
+ * @return void
  */
-int
-rpcsvc_drc_notify(rpcsvc_t *svc, void *xl, rpcsvc_event_t event, void *data)
+static void
+rpcsvc_drc_flush(rpcsvc_drc_globals_t *drc)
 {
-    int ret = -1;
-    rpc_transport_t *trans = NULL;
-    drc_client_t *client = NULL;
-    rpcsvc_drc_globals_t *drc = NULL;
-
-    GF_ASSERT(svc);
-    GF_ASSERT(svc->drc);
-    GF_ASSERT(data);
-
-    drc = svc->drc;
-
-    if (drc->status == DRC_UNINITIATED || drc->type == DRC_TYPE_NONE)
-        return 0;
-
-    LOCK(&drc->lock);
-    {
-        trans = (rpc_transport_t *)data;
-        client = rpcsvc_get_drc_client(drc, &trans->peerinfo.sockaddr);
-        if (!client)
-            goto unlock;
+    int i = 0;
+    struct drc_shard *shard = NULL;
+    struct list_head *buckets = NULL;
+    drc_cached_op_t *op = NULL;
+    drc_cached_op_t *tmp = NULL;
 
-        switch (event) {
-            case RPCSVC_EVENT_ACCEPT:
-                trans->drc_client = rpcsvc_drc_client_ref(client);
-                ret = 0;
-                break;
-
-            case RPCSVC_EVENT_DISCONNECT:
-                ret = 0;
-                if (list_empty(&drc->clients_head))
-                    break;
-                /* should be the last unref */
-                trans->drc_client = NULL;
-                rpcsvc_drc_client_unref(drc, client);
-                break;
-
-            default:
-                break;
+    for (i = 0; i < DRC_SHARDS; i++) {
+        shard = &drc->shards[i];
+
+        LOCK(&shard->lock);
+        {
+            /* ops in transit only stay around till their request is
+             * destroyed */
+            list_for_each_entry_safe(op, tmp, &shard->lru, lru_list)
+            {
+                __rpcsvc_drc_op_unhash(shard, op);
+            }
+
+            buckets = shard->buckets;
+            shard->buckets = NULL;
+            shard->nbuckets = 0;
         }
+        UNLOCK(&shard->lock);
+
+        GF_FREE(buckets);
     }
-unlock:
-    UNLOCK(&drc->lock);
-    return ret;
 }
 
 /**
@@ -668,9 +554,16 @@ int
 rpcsvc_drc_init(rpcsvc_t *svc, dict_t *options)
 {
     int ret = 0;
+    int i = 0;
+    uint32_t j = 0;
     uint32_t drc_type = 0;
     uint32_t drc_size = 0;
     uint32_t drc_factor = 0;
+    uint64_t drc_memory = 0;
+    uint32_t nbuckets = 0;
+    char *str = NULL;
+    struct list_head *buckets = NULL;
+    struct drc_shard *shard = NULL;
     rpcsvc_drc_globals_t *drc = NULL;
 
     GF_ASSERT(svc);
@@ -690,13 +583,22 @@ rpcsvc_drc_init(rpcsvc_t *svc, dict_t *options)
     if (ret == _gf_false)
         return (0);
 
-    drc = GF_CALLOC(1, sizeof(rpcsvc_drc_globals_t),
-                    gf_common_mt_drc_globals_t);
-    if (!drc)
-        return (-1);
-
-    LOCK_INIT(&drc->lock);
-    svc->drc = drc;
+    /* Requests in flight may still hold ops pointing into the shards, so
+     * the structure stays allocated once the cache has been turned on. */
+    drc = svc->drc;
+    if (!drc) {
+        drc = GF_CALLOC(1, sizeof(rpcsvc_drc_globals_t),
+                        gf_common_mt_drc_globals_t);
+        if (!drc)
+            return (-1);
+
+        LOCK_INIT(&drc->lock);
+        for (i = 0; i < DRC_SHARDS; i++) {
+            LOCK_INIT(&drc->shards[i].lock);
+            INIT_LIST_HEAD(&drc->shards[i].lru);
+        }
+        svc->drc = drc;
+    }
 
     /* Specify type of DRC to be used */
     ret = dict_get_uint32(options, "nfs.drc-type", &drc_type);
@@ -708,61 +610,72 @@ rpcsvc_drc_init(rpcsvc_t *svc, dict_t *options)
 
     /* Set the global cache size (no. of ops to cache) */
     ret = dict_get_uint32(options, "nfs.drc-size", &drc_size);
-    if (ret) {
+    if (ret || !drc_size) {
         gf_log(GF_RPCSVC, GF_LOG_DEBUG,
                "drc size not set. Continuing with default size");
         drc_size = DRC_DEFAULT_CACHE_SIZE;
     }
 
-    LOCK(&drc->lock);
-
-    drc->type = drc_type;
-    drc->global_cache_size = drc_size;
-
-    /* Mempool for cached ops */
-    drc->mempool = mem_pool_new(drc_cached_op_t, drc->global_cache_size);
-    if (!drc->mempool) {
-        UNLOCK(&drc->lock);
-        gf_log(GF_RPCSVC, GF_LOG_ERROR,
-               "Failed to get mempool for DRC, drc-size: %d", drc_size);
-        ret = -1;
-        goto post_unlock;
+    /* Set the memory the cached ops and their replies may take */
+    ret = dict_get_str(options, "nfs.drc-max-memory", &str);
+    if (ret || gf_string2bytesize_uint64(str, &drc_memory) || !drc_memory) {
+        gf_log(GF_RPCSVC, GF_LOG_DEBUG,
+               "drc max memory not set. Continuing with default");
+        drc_memory = DRC_DEFAULT_MAX_MEMORY;
     }
 
     /* What percent of cache to be evicted whenever it fills up */
     ret = dict_get_uint32(options, "nfs.drc-lru-factor", &drc_factor);
-    if (ret) {
+    if (ret || !drc_factor) {
         gf_log(GF_RPCSVC, GF_LOG_DEBUG,
                "drc lru factor not set. Continuing with policy default");
         drc_factor = DRC_DEFAULT_LRU_FACTOR;
     }
 
-    drc->lru_factor = (drc_lru_factor_t)drc_factor;
+    /* as many buckets as ops, rounded up to a power of two */
+    nbuckets = DRC_MIN_BUCKETS;
+    while (nbuckets < drc_size / DRC_SHARDS)
+        nbuckets <<= 1;
 
-    INIT_LIST_HEAD(&drc->clients_head);
-    INIT_LIST_HEAD(&drc->cache_head);
+    LOCK(&drc->lock);
 
-    ret = rpcsvc_register_notify(svc, rpcsvc_drc_notify, THIS);
-    if (ret) {
-        UNLOCK(&drc->lock);
-        gf_log(GF_RPCSVC, GF_LOG_ERROR,
-               "registration of drc_notify function failed");
-        goto post_unlock;
+    drc->type = drc_type;
+    drc->global_cache_size = drc_size;
+    drc->max_bytes = drc_memory;
+    drc->lru_factor = (drc_lru_factor_t)drc_factor;
+
+    for (i = 0; i < DRC_SHARDS; i++) {
+        shard = &drc->shards[i];
+
+        buckets = GF_MALLOC(nbuckets * sizeof(*buckets),
+                            gf_common_mt_drc_globals_t);
+        if (!buckets) {
+            UNLOCK(&drc->lock);
+            gf_log(GF_RPCSVC, GF_LOG_ERROR,
+                   "Failed to allocate DRC hash table, drc-size: %d",
+                   drc_size);
+            rpcsvc_drc_flush(drc);
+            return (-1);
+        }
+        for (j = 0; j < nbuckets; j++)
+            INIT_LIST_HEAD(&buckets[j]);
+
+        LOCK(&shard->lock);
+        {
+            shard->buckets = buckets;
+            shard->nbuckets = nbuckets;
+            shard->max_ops = max(drc_size / DRC_SHARDS, 1);
+            shard->max_bytes = drc_memory / DRC_SHARDS;
+            shard->vacate = max(shard->max_ops / drc->lru_factor, 1);
+        }
+        UNLOCK(&shard->lock);
     }
 
     drc->status = DRC_INITIATED;
     UNLOCK(&drc->lock);
     gf_log(GF_RPCSVC, GF_LOG_DEBUG, "drc init successful");
-post_unlock:
-    if (ret == -1) {
-        if (drc->mempool) {
-            mem_pool_destroy(drc->mempool);
-            drc->mempool = NULL;
-        }
-        GF_FREE(drc);
-        svc->drc = NULL;
-    }
-    return ret;
+
+    return (0);
 }
 
 int
@@ -778,15 +691,10 @@ rpcsvc_drc_deinit(rpcsvc_t *svc)
         return (0);
 
     LOCK(&drc->lock);
-    (void)rpcsvc_unregister_notify(svc, rpcsvc_drc_notify, THIS);
-    if (drc->mempool) {
-        mem_pool_destroy(drc->mempool);
-        drc->mempool = NULL;
-    }
+    drc->status = DRC_UNINITIATED;
     UNLOCK(&drc->lock);
 
-    GF_FREE(drc);
-    svc->drc = NULL;
+    rpcsvc_drc_flush(drc);
 
     return (0);
 }
@@ -798,6 +706,8 @@ rpcsvc_drc_reconfigure(rpcsvc_t *svc, dict_t *options)
     gf_boolean_t enable_drc = _gf_false;
     rpcsvc_drc_globals_t *drc = NULL;
     uint32_t drc_size = 0;
+    uint64_t drc_memory = 0;
+    char *str = NULL;
 
     /* Input sanitization */
     if ((!svc) || (!options))
@@ -807,21 +717,22 @@ rpcsvc_drc_reconfigure(rpcsvc_t *svc, dict_t *options)
      * take care of DRC initialization part.
      */
     drc = svc->drc;
-    if (!drc) {
+    if (!drc || drc->status == DRC_UNINITIATED) {
         return rpcsvc_drc_init(svc, options);
     }
 
     /* DRC was already enabled before. Going to be reconfigured. Check
-     * if reconfigured options contain "nfs.drc" and "nfs.drc-size".
+     * if reconfigured options contain "nfs.drc", "nfs.drc-size" and
+     * "nfs.drc-max-memory".
      *
      * NB: If DRC is "OFF", "drc-size" has no role to play.
      *     So, "drc-size" gets evaluated IFF DRC is "ON".
      *
      * If DRC is reconfigured,
      *     case 1: DRC is "ON"
-     *         sub-case 1: drc-size remains same
+     *         sub-case 1: drc-size and drc-max-memory remain same
      *              ACTION: Nothing to do.
-     *         sub-case 2: drc-size just changed
+     *         sub-case 2: either of them just changed
      *              ACTION: rpcsvc_drc_deinit() followed by
      *                      rpcsvc_drc_init().
      *
@@ -837,12 +748,16 @@ rpcsvc_drc_reconfigure(rpcsvc_t *svc, dict_t *options)
 
     /* case 1: DRC is "ON"*/
     if (enable_drc) {
-        /* Fetch drc-size if reconfigured */
-        if (dict_get_uint32(options, "nfs.drc-size", &drc_size))
+        /* Fetch drc-size and drc-max-memory if reconfigured */
+        if (dict_get_uint32(options, "nfs.drc-size", &drc_size) || !drc_size)
             drc_size = DRC_DEFAULT_CACHE_SIZE;
 
+        if (dict_get_str(options, "nfs.drc-max-memory", &str) ||
+            gf_string2bytesize_uint64(str, &drc_memory) || !drc_memory)
+            drc_memory = DRC_DEFAULT_MAX_MEMORY;
+
         /* case 1: sub-case 1*/
-        if (drc->global_cache_size == drc_size)
+        if (drc->global_cache_size == drc_size && drc->max_bytes == drc_memory)
             return (0);
 
         /* case 1: sub-case 2*/
@@ -15,30 +15,57 @@
 #include "rpcsvc.h"
 #include <glusterfs/locking.h>
 #include <glusterfs/dict.h>
-#include "rb.h"
-
-/* per-client cache structure */
-struct drc_client {
-    union gf_sock_union sock_union;
-    /* pointers to the cache */
-    struct rb_table *rbtree;
-    /* no. of ops currently cached */
-    uint32_t op_count;
-    gf_atomic_uint32_t ref;
-    struct list_head client_list;
-};
+/* The cache is a hash table split in DRC_SHARDS shards, each with its own
+ * lock, LRU list and share of the size and memory limits, so that requests
+ * from different clients seldom contend. An op is found by the address of
+ * the client, its XID, program, version and procedure, and a checksum of
+ * the first DRC_CSUM_LEN bytes of its arguments, which tells a genuine
+ * retransmission from another call reusing the XID.
+ */
+#define DRC_SHARDS 64
+#define DRC_CSUM_LEN 256
+#define DRC_MIN_BUCKETS 16
+#define DRC_DEFAULT_MAX_MEMORY (64 * GF_UNIT_MB)
 
 struct drc_cached_op {
-    drc_op_state_t state;
+    struct list_head hash_list;
+    struct list_head lru_list;
+    struct drc_shard *shard;
+    union gf_sock_union sock_union;
+    uint32_t xid;
+    uint32_t csum;
+    uint32_t hash;
     int prognum;
     int progversion;
     int procnum;
-    rpc_transport_msg_t msg;
-    drc_client_t *client;
-    struct list_head client_list;
-    struct list_head global_list;
+    drc_op_state_t state;
+    /* in the hash table, which then holds a ref */
+    gf_boolean_t hashed;
+    /* bytes accounted to the shard for this op and its reply */
+    size_t size;
+    /* a copy of the reply, not to pin the buffers it was built in */
+    struct iovec reply;
+    struct iobref *iobref;
+    /* taken under the lock of the shard */
     int32_t ref;
-    uint32_t xid;
+};
+
+struct drc_shard {
+    gf_lock_t lock;
+    struct list_head *buckets;
+    uint32_t nbuckets;
+    /* oldest op first */
+    struct list_head lru;
+    uint32_t op_count;
+    uint64_t bytes;
+    /* this shard's share of drc-size and drc-max-memory */
+    uint32_t max_ops;
+    uint64_t max_bytes;
+    /* ops evicted at once when max_ops is reached */
+    uint32_t vacate;
+    uint64_t cache_hits;
+    uint64_t intransit_hits;
+    uint64_t evictions;
 };
 
 /* global drc definitions */
@@ -46,20 +73,11 @@ enum drc_status { DRC_UNINITIATED, DRC_INITIATED };
 typedef enum drc_status drc_status_t;
 
 struct drc_globals {
-    /* allocator must be the first member since
-     * it is used so in gf_libavl_allocator
-     */
-    struct libavl_allocator allocator;
-    /* configurable size parameter */
+    /* serializes init, deinit and reconfigure */
     gf_lock_t lock;
-    uint64_t cache_hits;
-    uint64_t intransit_hits;
-    struct mem_pool *mempool;
-    struct list_head cache_head;
-    struct list_head clients_head;
-    uint32_t op_count;
-    uint32_t client_count;
+    struct drc_shard shards[DRC_SHARDS];
     uint32_t global_cache_size;
+    uint64_t max_bytes;
     drc_type_t type;
     drc_lru_factor_t lru_factor;
     drc_status_t status;
@@ -69,19 +87,22 @@ int
 rpcsvc_need_drc(rpcsvc_request_t *req);
 
 drc_cached_op_t *
-rpcsvc_drc_lookup(rpcsvc_request_t *req);
+rpcsvc_drc_lookup(rpcsvc_request_t *req, drc_op_state_t *state);
 
 int
 rpcsvc_send_cached_reply(rpcsvc_request_t *req, drc_cached_op_t *reply);
 
+void
+rpcsvc_drc_op_unref(drc_cached_op_t *op);
+
+void
+rpcsvc_drc_request_done(rpcsvc_request_t *req);
+
 int
 rpcsvc_cache_reply(rpcsvc_request_t *req, struct iobref *iobref,
                    struct iovec *rpchdr, int rpchdrcount, struct iovec *proghdr,
                    int proghdrcount, struct iovec *payload, int payloadcount);
 
-int
-rpcsvc_cache_request(rpcsvc_request_t *req);
-
 int32_t
 rpcsvc_drc_priv(rpcsvc_drc_globals_t *drc);
 
@@ -79,6 +79,18 @@ rpc_transport_throttle(rpc_transport_t *this, gf_boolean_t onoff)
     return this->ops->throttle(this, onoff);
 }
 
+/* Start compressing what goes out on @this with @algo, as agreed with
+ * the peer. The peer must already be able to inflate, which is why this
+ * is only called once the handshake has settled on an algorithm. */
+int32_t
+rpc_transport_set_compression(rpc_transport_t *this, const char *algo)
+{
+    if (!this->ops->set_compression)
+        return -ENOSYS;
+
+    return this->ops->set_compression(this, algo);
+}
+
 int32_t
 rpc_transport_get_peeraddr(rpc_transport_t *this, char *peeraddr, int addrlen,
                            struct sockaddr_storage *sa, size_t salen)
@@ -173,7 +173,6 @@ struct rpc_transport {
     dict_t *options;
     char *name;
     void *dnscache;
-    void *drc_client;
     data_t *buf;
     int32_t (*init)(rpc_transport_t *this);
     void (*fini)(rpc_transport_t *this);
@@ -185,8 +184,31 @@ struct rpc_transport {
 
     uint64_t total_bytes_read;
     uint64_t total_bytes_write;
+    /* wire compression, kept up to date by transports that support it */
+    const char *compress_offer;       /* what this end can inflate */
+    gf_atomic_t compress_saved_write; /* bytes not sent */
+    gf_atomic_t compress_saved_read;  /* bytes not received */
+    gf_atomic_t compress_records;     /* records sent compressed */
+    gf_atomic_t compress_skipped;     /* records sent raw during backoff */
+    /* shared memory with a peer on the same host, same */
+    gf_atomic_t shm_records_sent;
+    gf_atomic_t shm_records_received;
+    gf_atomic_t shm_ring_full; /* records sent on the socket instead */
+    /* TLS, same: who handles the records, and the traffic since the
+     * handshake */
+    const char *crypto_mode; /* NULL in the clear */
+    time_t crypto_since;
+    uint64_t crypto_bytes_read;
+    uint64_t crypto_bytes_write;
     uint32_t xid; /* RPC/XID used for callbacks */
     int32_t outstanding_rpc_count;
+    /* in the throttled connections of its client of the admission
+     * control of rpcsvc, while admit_throttled is set */
+    struct list_head admit_list;
+    gf_boolean_t admit_throttled;
+    /* requests exempt from the admission control in the service, a
+     * connection is not throttled while it has some */
+    int32_t admit_exempt;
 
     struct list_head list;
     void *dl_handle; /* handle of dlopen() */
@@ -233,6 +255,7 @@ struct rpc_transport_ops {
     int32_t (*get_myaddr)(rpc_transport_t *this, char *peeraddr, int addrlen,
                           struct sockaddr_storage *sa, socklen_t sasize);
     int32_t (*throttle)(rpc_transport_t *this, gf_boolean_t onoff);
+    int32_t (*set_compression)(rpc_transport_t *this, const char *algo);
 };
 
 int32_t
@@ -284,6 +307,9 @@ rpc_transport_get_myaddr(rpc_transport_t *this, char *peeraddr, int addrlen,
 int
 rpc_transport_throttle(rpc_transport_t *this, gf_boolean_t onoff);
 
+int32_t
+rpc_transport_set_compression(rpc_transport_t *this, const char *algo);
+
 rpc_transport_pollin_t *
 rpc_transport_pollin_alloc(rpc_transport_t *this, struct iovec *vector,
                            int count, struct iobuf *hdr_iobuf,
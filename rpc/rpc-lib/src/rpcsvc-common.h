@@ -73,6 +73,8 @@ typedef struct rpcsvc_state {
     gf_boolean_t addr_namelookup;
     /* determine whether throttling is needed, by default OFF */
     gf_boolean_t throttle;
+    /* adaptive per-client limits, allocated when first turned on */
+    struct rpcsvc_admit *admit;
     /* Allow insecure ports. */
     gf_boolean_t allow_insecure;
     gf_boolean_t register_portmap;
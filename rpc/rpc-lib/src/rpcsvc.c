@@ -257,6 +257,285 @@ out:
     return ret;
 }
 
+/* Pings, handshakes, locks and leases are not counted by the admission
+ * control: the other requests of a client may be waiting for the release
+ * of a lock it holds. As throttling stops reading the whole connection,
+ * one is not throttled while such requests of it are in the brick, and
+ * a throttled one is read again at the end of every period, so that an
+ * unlock or a ping it sends meanwhile waits one period at most.
+ */
+static gf_boolean_t
+rpcsvc_admit_exempt(rpcsvc_request_t *req)
+{
+    if ((req->prognum == GLUSTER_DUMP_PROGRAM) ||
+        (req->prognum == GLUSTER_HNDSK_PROGRAM))
+        return _gf_true;
+
+    if (req->prognum != GLUSTER_FOP_PROGRAM)
+        return _gf_false;
+
+    switch (req->procnum) {
+        case GFS3_OP_INODELK:
+        case GFS3_OP_FINODELK:
+        case GFS3_OP_ENTRYLK:
+        case GFS3_OP_FENTRYLK:
+        case GFS3_OP_LK:
+        case GFS3_OP_LEASE:
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
+static int
+rpcsvc_admit_ceiling(rpcsvc_t *svc)
+{
+    if (svc->outstanding_rpc_limit)
+        return svc->outstanding_rpc_limit;
+
+    return RPCSVC_MAX_OUTSTANDING_RPC_LIMIT;
+}
+
+static uint32_t
+rpcsvc_admit_sqrt(uint32_t n)
+{
+    uint32_t root = 1;
+
+    while ((root + 1) * (root + 1) <= n)
+        root++;
+
+    return root;
+}
+
+/* The connections of a client share the client_t the service attached
+ * to them, those without one are clients of their own. */
+static rpcsvc_admit_client_t *
+__rpcsvc_admit_client_get(rpcsvc_t *svc, rpcsvc_admit_t *admit,
+                          rpc_transport_t *trans)
+{
+    rpcsvc_admit_client_t *client = NULL;
+    struct list_head *bucket = NULL;
+    void *key = NULL;
+
+    key = trans->xl_private ? (void *)trans->xl_private : (void *)trans;
+    bucket = &admit->buckets[((uintptr_t)key >> 6) % RPCSVC_ADMIT_BUCKETS];
+
+    list_for_each_entry(client, bucket, hash)
+    {
+        if (client->key == key)
+            return client;
+    }
+
+    client = GF_CALLOC(1, sizeof(*client), gf_common_mt_rpcsvc_admit_t);
+    if (!client)
+        return NULL;
+
+    client->key = key;
+    client->limit = rpcsvc_admit_ceiling(svc);
+    INIT_LIST_HEAD(&client->throttled);
+    snprintf(client->identifier, sizeof(client->identifier), "%s",
+             trans->peerinfo.identifier);
+    list_add(&client->hash, bucket);
+    list_add_tail(&client->list, &admit->clients);
+
+    return client;
+}
+
+static void
+__rpcsvc_admit_release(rpcsvc_admit_client_t *client)
+{
+    rpc_transport_t *trans = NULL;
+    rpc_transport_t *tmp = NULL;
+
+    list_for_each_entry_safe(trans, tmp, &client->throttled, admit_list)
+    {
+        list_del_init(&trans->admit_list);
+        trans->admit_throttled = _gf_false;
+        rpc_transport_throttle(trans, _gf_false);
+    }
+}
+
+/* Runs once a period. If even the quickest request done during it stayed
+ * in the brick longer than the target, there is a standing queue: the
+ * clients with at least their share of the requests get a lower limit,
+ * and the next period is shorter the longer this lasts. Otherwise all the
+ * limits grow back towards rpc.outstanding-rpc-limit.
+ */
+static void
+__rpcsvc_admit_control(rpcsvc_t *svc, rpcsvc_admit_t *admit,
+                       struct timespec *now)
+{
+    rpcsvc_admit_client_t *client = NULL;
+    rpcsvc_admit_client_t *tmp = NULL;
+    gf_boolean_t congested = _gf_false;
+    uint64_t load = 0;
+    int ceiling = 0;
+    int active = 0;
+    int share = 0;
+
+    ceiling = rpcsvc_admit_ceiling(svc);
+    congested = (admit->min_delay != UINT64_MAX) &&
+                (admit->min_delay > admit->target);
+
+    list_for_each_entry(client, &admit->clients, list)
+    {
+        if (client->peak) {
+            load += client->peak;
+            active++;
+        }
+    }
+    if (active)
+        share = load / active;
+
+    if (congested) {
+        admit->congested++;
+        if (admit->drop_count < 1024)
+            admit->drop_count++;
+    } else {
+        admit->drop_count = 0;
+    }
+
+    list_for_each_entry_safe(client, tmp, &admit->clients, list)
+    {
+        if (congested) {
+            if (client->peak >= share &&
+                client->limit > RPCSVC_ADMIT_MIN_LIMIT) {
+                client->limit = min(client->limit, client->peak) * 3 / 4;
+                client->limit = max(client->limit, RPCSVC_ADMIT_MIN_LIMIT);
+                admit->lowered++;
+            }
+        } else if (client->limit < ceiling) {
+            client->limit += client->limit / 8 + 1;
+            admit->raised++;
+        }
+        client->limit = min(client->limit, ceiling);
+
+        /* read whatever the throttled connections have meanwhile, they
+         * are throttled again on their next request over the limit */
+        __rpcsvc_admit_release(client);
+
+        if (!client->outstanding && !client->peak) {
+            list_del(&client->hash);
+            list_del(&client->list);
+            GF_FREE(client);
+            continue;
+        }
+        client->peak = client->outstanding;
+    }
+
+    admit->interval_start = *now;
+    admit->min_delay = UINT64_MAX;
+    admit->period = admit->interval;
+    if (admit->drop_count)
+        admit->period /= rpcsvc_admit_sqrt(admit->drop_count);
+}
+
+static void
+rpcsvc_admit_request(rpcsvc_request_t *req)
+{
+    rpcsvc_admit_t *admit = req->svc->admit;
+    rpcsvc_admit_client_t *client = NULL;
+    rpc_transport_t *trans = req->trans;
+
+    if (!admit || !admit->enabled)
+        return;
+
+    if (rpcsvc_admit_exempt(req)) {
+        pthread_mutex_lock(&admit->lock);
+        {
+            trans->admit_exempt++;
+        }
+        pthread_mutex_unlock(&admit->lock);
+        req->admit_exempt = _gf_true;
+        return;
+    }
+
+    timespec_now(&req->arrival);
+
+    pthread_mutex_lock(&admit->lock);
+    {
+        client = __rpcsvc_admit_client_get(req->svc, admit, trans);
+        if (!client)
+            goto unlock;
+
+        req->admit = client;
+        client->admitted++;
+        client->outstanding++;
+        client->peak = max(client->peak, client->outstanding);
+
+        /* the other connections of the client are held back too once
+         * they bring one request too many */
+        if (client->outstanding > client->limit && !trans->admit_throttled &&
+            !trans->admit_exempt) {
+            list_add_tail(&trans->admit_list, &client->throttled);
+            trans->admit_throttled = _gf_true;
+            rpc_transport_throttle(trans, _gf_true);
+            client->throttles++;
+        }
+    }
+unlock:
+    pthread_mutex_unlock(&admit->lock);
+}
+
+static void
+rpcsvc_admit_done(rpcsvc_request_t *req)
+{
+    rpcsvc_admit_t *admit = req->svc->admit;
+    rpcsvc_admit_client_t *client = req->admit;
+    struct timespec now;
+    uint64_t delay = 0;
+    int slot = 0;
+
+    if (req->admit_exempt) {
+        pthread_mutex_lock(&admit->lock);
+        {
+            req->trans->admit_exempt--;
+        }
+        pthread_mutex_unlock(&admit->lock);
+        req->admit_exempt = _gf_false;
+        return;
+    }
+
+    timespec_now(&now);
+    delay = gf_tsdiff(&req->arrival, &now) / 1000;
+    if (delay)
+        slot = min(64 - __builtin_clzll(delay), RPCSVC_ADMIT_DELAY_SLOTS - 1);
+
+    pthread_mutex_lock(&admit->lock);
+    {
+        client->outstanding--;
+        admit->delays[slot]++;
+        admit->min_delay = min(admit->min_delay, delay);
+
+        if (gf_tsdiff(&admit->interval_start, &now) / 1000 >= admit->period)
+            __rpcsvc_admit_control(req->svc, admit, &now);
+        else if (client->outstanding <= client->limit)
+            __rpcsvc_admit_release(client);
+    }
+    pthread_mutex_unlock(&admit->lock);
+
+    req->admit = NULL;
+}
+
+/* a connection gone is no longer read from anyway */
+static void
+rpcsvc_admit_disconnect(rpcsvc_t *svc, rpc_transport_t *trans)
+{
+    rpcsvc_admit_t *admit = svc->admit;
+
+    if (!admit)
+        return;
+
+    pthread_mutex_lock(&admit->lock);
+    {
+        if (trans->admit_throttled) {
+            list_del_init(&trans->admit_list);
+            trans->admit_throttled = _gf_false;
+        }
+    }
+    pthread_mutex_unlock(&admit->lock);
+}
+
 /* This needs to change to returning errors, since
  * we need to return RPC specific error messages when some
  * of the pointers below are NULL.
@@ -422,6 +701,12 @@ rpcsvc_request_destroy(rpcsvc_request_t *req)
     if (req->prognum)  // Only for initialized requests
         rpcsvc_request_outstanding(req, -1);
 
+    if (req->admit || req->admit_exempt)
+        rpcsvc_admit_done(req);
+
+    if (req->reply)
+        rpcsvc_drc_request_done(req);
+
     rpc_transport_unref(req->trans);
 
     GF_FREE(req->auxgidlarge);
@@ -532,8 +817,10 @@ rpcsvc_request_create(rpcsvc_t *svc, rpc_transport_t *trans,
        it in the outsanding request counter to make sure we don't
        ingest too many concurrent requests from the same client.
     */
-    if (req->prognum)  // Only for initialized requests
+    if (req->prognum) {  // Only for initialized requests
         ret = rpcsvc_request_outstanding(req, +1);
+        rpcsvc_admit_request(req);
+    }
 
     if (rpc_call_rpcvers(&rpcmsg) != 2) {
         /* LOG- TODO: print rpc version, also print the peerinfo
@@ -692,7 +979,7 @@ rpcsvc_handle_rpc_call(rpcsvc_t *svc, rpc_transport_t *trans,
     gf_boolean_t is_unix = _gf_false, empty = _gf_false;
     gf_boolean_t unprivileged = _gf_false, spawn_request_handler = 0;
     drc_cached_op_t *reply = NULL;
-    rpcsvc_drc_globals_t *drc = NULL;
+    drc_op_state_t state = DRC_OP_IN_TRANSIT;
     rpcsvc_request_queue_t *queue = NULL;
     long num = 0;
     void *value = NULL;
@@ -752,41 +1039,31 @@ rpcsvc_handle_rpc_call(rpcsvc_t *svc, rpc_transport_t *trans,
 
     /* DRC */
     if (rpcsvc_need_drc(req)) {
-        drc = req->svc->drc;
-
-        LOCK(&drc->lock);
-        {
-            reply = rpcsvc_drc_lookup(req);
-
-            /* retransmission of completed request, send cached reply */
-            if (reply && reply->state == DRC_OP_CACHED) {
-                gf_log(GF_RPCSVC, GF_LOG_INFO,
-                       "duplicate request:"
-                       " XID: 0x%x",
-                       req->xid);
-                ret = rpcsvc_send_cached_reply(req, reply);
-                drc->cache_hits++;
-                UNLOCK(&drc->lock);
-                goto out;
-
-            } /* retransmitted request, original op in transit, drop it */
-            else if (reply && reply->state == DRC_OP_IN_TRANSIT) {
-                gf_log(GF_RPCSVC, GF_LOG_INFO,
-                       "op in transit,"
-                       " discarding. XID: 0x%x",
-                       req->xid);
-                ret = 0;
-                drc->intransit_hits++;
-                rpcsvc_request_destroy(req);
-                UNLOCK(&drc->lock);
-                goto out;
+        reply = rpcsvc_drc_lookup(req, &state);
+
+        /* retransmission of completed request, send cached reply */
+        if (reply && state == DRC_OP_CACHED) {
+            gf_log(GF_RPCSVC, GF_LOG_INFO,
+                   "duplicate request:"
+                   " XID: 0x%x",
+                   req->xid);
+            ret = rpcsvc_send_cached_reply(req, reply);
+            rpcsvc_drc_op_unref(reply);
+            rpcsvc_request_destroy(req);
+            goto out;
 
-            } /* fresh request, cache it as in-transit and proceed */
-            else {
-                ret = rpcsvc_cache_request(req);
-            }
+        } /* retransmitted request, original op in transit, drop it */
+        else if (reply) {
+            gf_log(GF_RPCSVC, GF_LOG_INFO,
+                   "op in transit,"
+                   " discarding. XID: 0x%x",
+                   req->xid);
+            ret = 0;
+            rpcsvc_drc_op_unref(reply);
+            rpcsvc_request_destroy(req);
+            goto out;
         }
-        UNLOCK(&drc->lock);
+        /* fresh request, cached as in-transit by the lookup, proceed */
     }
 
     if (req->rpc_err == SUCCESS) {
@@ -909,6 +1186,8 @@ rpcsvc_handle_disconnect(rpcsvc_t *svc, rpc_transport_t *trans)
     event = (trans->listener == NULL) ? RPCSVC_EVENT_LISTENER_DEAD
                                       : RPCSVC_EVENT_DISCONNECT;
 
+    rpcsvc_admit_disconnect(svc, trans);
+
     pthread_rwlock_rdlock(&svc->rpclock);
     {
         if (!svc->notify_count)
@@ -1495,7 +1774,6 @@ rpcsvc_submit_generic(rpcsvc_request_t *req, struct iovec *proghdr,
     size_t msglen = 0;
     size_t hdrlen = 0;
     char new_iobref = 0;
-    rpcsvc_drc_globals_t *drc = NULL;
     gf_latency_t *lat = NULL;
     struct timespec end;
 
@@ -1541,12 +1819,8 @@ rpcsvc_submit_generic(rpcsvc_request_t *req, struct iovec *proghdr,
 
     /* cache the request in the duplicate request cache for appropriate ops */
     if ((req->reply) && (rpcsvc_need_drc(req))) {
-        drc = req->svc->drc;
-
-        LOCK(&drc->lock);
         ret = rpcsvc_cache_reply(req, iobref, &recordhdr, 1, proghdr, hdrcount,
                                  payload, payloadcount);
-        UNLOCK(&drc->lock);
         if (ret < 0) {
             gf_log(GF_RPCSVC, GF_LOG_ERROR, "failed to cache reply");
         }
@@ -2700,6 +2974,79 @@ rpcsvc_set_outstanding_rpc_limit(rpcsvc_t *svc, dict_t *options, int defvalue)
     return (0);
 }
 
+/*
+ * Configure() the rpc.admission-control params. The ones not in options
+ * get their default values.
+ */
+int
+rpcsvc_set_admission_control(rpcsvc_t *svc, dict_t *options)
+{
+    rpcsvc_admit_t *admit = NULL;
+    rpcsvc_admit_client_t *client = NULL;
+    int32_t target = RPCSVC_DEFAULT_ADMIT_TARGET;
+    int32_t interval = RPCSVC_DEFAULT_ADMIT_INTERVAL;
+    int enabled = 0;
+    int i = 0;
+
+    if ((!svc) || (!options))
+        return (-1);
+
+    enabled = dict_get_str_boolean(options, "rpc.admission-control",
+                                   _gf_false);
+    if (enabled < 0)
+        return (-1);
+
+    if (dict_get_int32(options, "rpc.admission-target-delay", &target) < 0)
+        target = RPCSVC_DEFAULT_ADMIT_TARGET;
+    if (dict_get_int32(options, "rpc.admission-interval", &interval) < 0)
+        interval = RPCSVC_DEFAULT_ADMIT_INTERVAL;
+    if ((target <= 0) || (interval <= 0))
+        return (-1);
+
+    if (!svc->admit) {
+        if (!enabled)
+            return (0);
+
+        admit = GF_CALLOC(1, sizeof(*admit), gf_common_mt_rpcsvc_admit_t);
+        if (!admit)
+            return (-1);
+
+        pthread_mutex_init(&admit->lock, NULL);
+        INIT_LIST_HEAD(&admit->clients);
+        for (i = 0; i < RPCSVC_ADMIT_BUCKETS; i++)
+            INIT_LIST_HEAD(&admit->buckets[i]);
+        admit->min_delay = UINT64_MAX;
+        timespec_now(&admit->interval_start);
+        svc->admit = admit;
+    }
+    admit = svc->admit;
+
+    pthread_mutex_lock(&admit->lock);
+    {
+        admit->target = (uint64_t)target * 1000;
+        admit->interval = (uint64_t)interval * 1000;
+        admit->period = admit->interval;
+        admit->drop_count = 0;
+
+        if (admit->enabled != enabled)
+            gf_log(GF_RPCSVC, GF_LOG_INFO,
+                   "Admission control turned %s (target delay %dms, "
+                   "interval %dms)",
+                   enabled ? "on" : "off", target, interval);
+        admit->enabled = enabled;
+
+        if (!enabled) {
+            list_for_each_entry(client, &admit->clients, list)
+            {
+                __rpcsvc_admit_release(client);
+            }
+        }
+    }
+    pthread_mutex_unlock(&admit->lock);
+
+    return (0);
+}
+
 /*
  * Enable throttling for rpcsvc_t svc.
  * Returns 0 on success, -1 otherwise.
@@ -2752,6 +3099,8 @@ rpcsvc_destroy(rpcsvc_t *svc)
     struct rpcsvc_auth_list *tmp = NULL;
     rpcsvc_listener_t *listener = NULL;
     rpcsvc_listener_t *next = NULL;
+    rpcsvc_admit_client_t *client = NULL;
+    rpcsvc_admit_client_t *tmp_client = NULL;
     int ret = 0;
 
     if (!svc)
@@ -2774,6 +3123,16 @@ rpcsvc_destroy(rpcsvc_t *svc)
         svc->rxpool = NULL;
     }
 
+    if (svc->admit) {
+        list_for_each_entry_safe(client, tmp_client, &svc->admit->clients,
+                                 list)
+        {
+            GF_FREE(client);
+        }
+        pthread_mutex_destroy(&svc->admit->lock);
+        GF_FREE(svc->admit);
+    }
+
     pthread_rwlock_destroy(&svc->rpclock);
     GF_FREE(svc);
 
@@ -3262,6 +3621,84 @@ rpcsvc_program_dump(rpcsvc_program_t *prog)
     }
 }
 
+/* upper bound of the delays of the given percent of the requests */
+static uint64_t
+rpcsvc_admit_percentile(uint64_t *delays, uint64_t total, int percent)
+{
+    uint64_t seen = 0;
+    int i;
+
+    for (i = 0; i < RPCSVC_ADMIT_DELAY_SLOTS - 1; i++) {
+        seen += delays[i];
+        if (seen * 100 >= total * percent)
+            break;
+    }
+
+    return 1ULL << i;
+}
+
+static void
+rpcsvc_admit_dump(rpcsvc_t *svc)
+{
+    rpcsvc_admit_t *admit = svc->admit;
+    rpcsvc_admit_client_t *client = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+    char key[GF_DUMP_MAX_BUF_LEN];
+    uint64_t total = 0;
+    int i = 0;
+
+    if (!admit || pthread_mutex_trylock(&admit->lock))
+        return;
+
+    snprintf(key_prefix, sizeof(key_prefix), "rpcsvc.admission-control");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_build_key(key, key_prefix, "enabled");
+    gf_proc_dump_write(key, "%s", admit->enabled ? "yes" : "no");
+    gf_proc_dump_build_key(key, key_prefix, "congested-periods");
+    gf_proc_dump_write(key, "%" PRIu64, admit->congested);
+    gf_proc_dump_build_key(key, key_prefix, "limits-lowered");
+    gf_proc_dump_write(key, "%" PRIu64, admit->lowered);
+    gf_proc_dump_build_key(key, key_prefix, "limits-raised");
+    gf_proc_dump_write(key, "%" PRIu64, admit->raised);
+
+    /* how long the requests done since the last statedump stayed */
+    for (i = 0; i < RPCSVC_ADMIT_DELAY_SLOTS; i++)
+        total += admit->delays[i];
+    gf_proc_dump_build_key(key, key_prefix, "requests");
+    gf_proc_dump_write(key, "%" PRIu64, total);
+    if (total) {
+        gf_proc_dump_build_key(key, key_prefix, "delay-p50-us");
+        gf_proc_dump_write(key, "%" PRIu64,
+                           rpcsvc_admit_percentile(admit->delays, total, 50));
+        gf_proc_dump_build_key(key, key_prefix, "delay-p90-us");
+        gf_proc_dump_write(key, "%" PRIu64,
+                           rpcsvc_admit_percentile(admit->delays, total, 90));
+        gf_proc_dump_build_key(key, key_prefix, "delay-p99-us");
+        gf_proc_dump_write(key, "%" PRIu64,
+                           rpcsvc_admit_percentile(admit->delays, total, 99));
+    }
+    memset(admit->delays, 0, sizeof(admit->delays));
+
+    i = 0;
+    list_for_each_entry(client, &admit->clients, list)
+    {
+        gf_proc_dump_build_key(key, key_prefix, "client[%d].identifier", i);
+        gf_proc_dump_write(key, "%s", client->identifier);
+        gf_proc_dump_build_key(key, key_prefix, "client[%d].outstanding", i);
+        gf_proc_dump_write(key, "%d", client->outstanding);
+        gf_proc_dump_build_key(key, key_prefix, "client[%d].limit", i);
+        gf_proc_dump_write(key, "%d", client->limit);
+        gf_proc_dump_build_key(key, key_prefix, "client[%d].admitted", i);
+        gf_proc_dump_write(key, "%" PRIu64, client->admitted);
+        gf_proc_dump_build_key(key, key_prefix, "client[%d].throttled", i);
+        gf_proc_dump_write(key, "%" PRIu64, client->throttles);
+        i++;
+    }
+
+    pthread_mutex_unlock(&admit->lock);
+}
+
 void
 rpcsvc_statedump(rpcsvc_t *svc)
 {
@@ -3277,6 +3714,8 @@ rpcsvc_statedump(rpcsvc_t *svc)
         }
     }
     pthread_rwlock_unlock(&svc->rpclock);
+
+    rpcsvc_admit_dump(svc);
 }
 
 static rpcsvc_actor_t gluster_dump_actors[GF_DUMP_MAXVALUE] = {
@@ -40,6 +40,47 @@ typedef enum {
 #define RPCSVC_MAX_OUTSTANDING_RPC_LIMIT 65536
 #define RPCSVC_MIN_OUTSTANDING_RPC_LIMIT 0 /* No limit i.e. Unlimited */
 
+/* Admission control: the requests outstanding from each client are kept
+ * under a limit of its own, which is lowered for the clients with the most
+ * requests in the brick while requests stay there longer than the target
+ * delay, as CoDel does with the packets of a queue, and raised again once
+ * they no longer do. */
+#define RPCSVC_DEFAULT_ADMIT_TARGET 20    /* ms */
+#define RPCSVC_DEFAULT_ADMIT_INTERVAL 100 /* ms */
+#define RPCSVC_ADMIT_MIN_LIMIT 4
+#define RPCSVC_ADMIT_BUCKETS 64
+#define RPCSVC_ADMIT_DELAY_SLOTS 32 /* powers of two of microseconds */
+
+typedef struct rpcsvc_admit_client {
+    struct list_head hash; /* in its bucket of rpcsvc_admit_t */
+    struct list_head list; /* in the clients of rpcsvc_admit_t */
+    void *key; /* client_t of its connections, or its only connection */
+    struct list_head throttled; /* connections not read from meanwhile */
+    char identifier[UNIX_PATH_MAX];
+    int outstanding;
+    int peak; /* most outstanding during the interval */
+    int limit;
+    uint64_t admitted;
+    uint64_t throttles;
+} rpcsvc_admit_client_t;
+
+typedef struct rpcsvc_admit {
+    pthread_mutex_t lock;
+    struct list_head clients;
+    struct list_head buckets[RPCSVC_ADMIT_BUCKETS];
+    gf_boolean_t enabled;
+    uint64_t target;   /* us */
+    uint64_t interval; /* us */
+    struct timespec interval_start;
+    uint64_t period;     /* us from interval_start to the next check */
+    uint64_t min_delay;  /* smallest delay of the requests done since */
+    uint32_t drop_count; /* checks in a row which found a standing queue */
+    uint64_t delays[RPCSVC_ADMIT_DELAY_SLOTS];
+    uint64_t congested;
+    uint64_t lowered;
+    uint64_t raised;
+} rpcsvc_admit_t;
+
 #define GF_RPCSVC "rpc-service"
 #define RPCSVC_THREAD_STACK_SIZE ((size_t)(1024 * GF_UNIT_KB))
 
@@ -137,7 +178,6 @@ typedef struct {
 
 #define rpcsvc_auth_flavour(au) ((au).flavour)
 
-typedef struct drc_client drc_client_t;
 typedef struct drc_cached_op drc_cached_op_t;
 
 /* The container for the RPC call handed up to an actor.
@@ -210,6 +250,11 @@ struct rpcsvc_request {
     /* Container for transport to store request-specific item */
     void *trans_private;
 
+    /* Set by a program on the requests it unpacks from a batch of them,
+     * whose replies it collects instead of submitting them.
+     */
+    void *batch;
+
     /* pointer to cached reply for use in DRC */
     drc_cached_op_t *reply;
 
@@ -253,6 +298,13 @@ struct rpcsvc_request {
      * start time.
      */
     struct timespec begin;
+
+    /* client of the admission control this request is counted against,
+     * and when it was received */
+    rpcsvc_admit_client_t *admit;
+    struct timespec arrival;
+    /* counted in the exempt requests of its connection instead */
+    gf_boolean_t admit_exempt;
 };
 
 #define rpcsvc_request_program(req) ((rpcsvc_program_t *)((req)->prog))
@@ -475,6 +527,10 @@ rpcsvc_program_unregister(rpcsvc_t *svc, rpcsvc_program_t *program);
 extern int32_t
 rpcsvc_create_listeners(rpcsvc_t *svc, dict_t *options, char *name);
 
+/* one listener, on the transport @options describe */
+int32_t
+rpcsvc_create_listener(rpcsvc_t *svc, dict_t *options, char *name);
+
 void
 rpcsvc_listener_destroy(rpcsvc_listener_t *listener);
 
@@ -656,6 +712,9 @@ rpcsvc_set_all_squash(rpcsvc_t *svc, dict_t *options);
 int
 rpcsvc_set_outstanding_rpc_limit(rpcsvc_t *svc, dict_t *options, int defvalue);
 
+int
+rpcsvc_set_admission_control(rpcsvc_t *svc, dict_t *options);
+
 int
 rpcsvc_set_throttle_on(rpcsvc_t *svc);
 
@@ -0,0 +1,187 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <zlib.h>
+#ifdef HAVE_LIB_LZ4
+#include <lz4.h>
+#endif
+#ifdef HAVE_LIB_ZSTD
+#include <zstd.h>
+#endif
+
+#include "socket-compress.h"
+
+/* favour speed: the point is to save time on slow links, not space */
+#define SOCKET_ZLIB_LEVEL 1
+#define SOCKET_ZSTD_LEVEL 1
+
+static const char *socket_compress_names[SOCKET_COMPRESS_MAX] = {
+    [SOCKET_COMPRESS_NONE] = "off",
+    [SOCKET_COMPRESS_ZLIB] = "zlib",
+    [SOCKET_COMPRESS_LZ4] = "lz4",
+    [SOCKET_COMPRESS_ZSTD] = "zstd",
+};
+
+gf_boolean_t
+socket_compress_supported(socket_compress_t algo)
+{
+    switch (algo) {
+        case SOCKET_COMPRESS_NONE:
+        case SOCKET_COMPRESS_ZLIB:
+            return _gf_true;
+#ifdef HAVE_LIB_LZ4
+        case SOCKET_COMPRESS_LZ4:
+            return _gf_true;
+#endif
+#ifdef HAVE_LIB_ZSTD
+        case SOCKET_COMPRESS_ZSTD:
+            return _gf_true;
+#endif
+        default:
+            return _gf_false;
+    }
+}
+
+int
+socket_compress_parse(const char *name, socket_compress_t *algo)
+{
+    int i;
+
+    for (i = 0; i < SOCKET_COMPRESS_MAX; i++) {
+        if (strcmp(name, socket_compress_names[i]) != 0)
+            continue;
+        if (!socket_compress_supported(i))
+            return -1;
+        *algo = i;
+        return 0;
+    }
+
+    return -1;
+}
+
+const char *
+socket_compress_name(socket_compress_t algo)
+{
+    if (algo >= SOCKET_COMPRESS_MAX)
+        return "unknown";
+
+    return socket_compress_names[algo];
+}
+
+size_t
+socket_compress_bound(socket_compress_t algo, size_t len)
+{
+    switch (algo) {
+#ifdef HAVE_LIB_LZ4
+        case SOCKET_COMPRESS_LZ4:
+            return LZ4_compressBound(len);
+#endif
+#ifdef HAVE_LIB_ZSTD
+        case SOCKET_COMPRESS_ZSTD:
+            return ZSTD_compressBound(len);
+#endif
+        default:
+            return compressBound(len);
+    }
+}
+
+/* Returns the compressed size of @src in @dst, -1 if it does not fit */
+ssize_t
+socket_compress(socket_compress_t algo, void **ctx, const char *src,
+                size_t len, char *dst, size_t size)
+{
+    uLongf dlen = size;
+
+    switch (algo) {
+        case SOCKET_COMPRESS_ZLIB:
+            if (compress2((Bytef *)dst, &dlen, (const Bytef *)src, len,
+                          SOCKET_ZLIB_LEVEL) != Z_OK)
+                return -1;
+            return dlen;
+#ifdef HAVE_LIB_LZ4
+        case SOCKET_COMPRESS_LZ4: {
+            int ret = LZ4_compress_default(src, dst, len, size);
+            return (ret > 0) ? ret : -1;
+        }
+#endif
+#ifdef HAVE_LIB_ZSTD
+        case SOCKET_COMPRESS_ZSTD: {
+            size_t ret;
+
+            if (!*ctx) {
+                *ctx = ZSTD_createCCtx();
+                if (!*ctx)
+                    return -1;
+            }
+            ret = ZSTD_compressCCtx(*ctx, dst, size, src, len,
+                                    SOCKET_ZSTD_LEVEL);
+            return ZSTD_isError(ret) ? -1 : (ssize_t)ret;
+        }
+#endif
+        default:
+            return -1;
+    }
+}
+
+/* Inflates @src into @dst, 0 if that gave exactly @raw_len bytes */
+int
+socket_decompress(socket_compress_t algo, void **ctx, const char *src,
+                  size_t len, char *dst, size_t raw_len)
+{
+    uLongf dlen = raw_len;
+
+    switch (algo) {
+        case SOCKET_COMPRESS_ZLIB:
+            if (uncompress((Bytef *)dst, &dlen, (const Bytef *)src, len) !=
+                Z_OK)
+                return -1;
+            return (dlen == raw_len) ? 0 : -1;
+#ifdef HAVE_LIB_LZ4
+        case SOCKET_COMPRESS_LZ4:
+            return (LZ4_decompress_safe(src, dst, len, raw_len) ==
+                    (int)raw_len)
+                       ? 0
+                       : -1;
+#endif
+#ifdef HAVE_LIB_ZSTD
+        case SOCKET_COMPRESS_ZSTD: {
+            size_t ret;
+
+            if (!*ctx) {
+                *ctx = ZSTD_createDCtx();
+                if (!*ctx)
+                    return -1;
+            }
+            ret = ZSTD_decompressDCtx(*ctx, dst, raw_len, src, len);
+            return (!ZSTD_isError(ret) && ret == raw_len) ? 0 : -1;
+        }
+#endif
+        default:
+            return -1;
+    }
+}
+
+void
+socket_compress_ctx_free(void *ctx)
+{
+#ifdef HAVE_LIB_ZSTD
+    if (ctx)
+        ZSTD_freeCCtx(ctx);
+#endif
+}
+
+void
+socket_decompress_ctx_free(void *ctx)
+{
+#ifdef HAVE_LIB_ZSTD
+    if (ctx)
+        ZSTD_freeDCtx(ctx);
+#endif
+}
@@ -0,0 +1,120 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _SOCKET_COMPRESS_H
+#define _SOCKET_COMPRESS_H
+
+#include <pthread.h>
+#include <glusterfs/common-utils.h>
+
+/* Wire compression of whole RPC records. A compressed record goes out as
+ * a 12 byte header followed by the compressed bytes of the record, its
+ * fragment header included:
+ *
+ *     uint32 magic | algorithm, uint32 compressed size, uint32 record size
+ *
+ * all in network order. The top byte of the magic stands for a fragment
+ * of nearly 2GB which is not the last one of its record, something no
+ * receiver accepts, so a peer inflating the stream tells both kinds of
+ * record apart from their first four bytes. Nothing is compressed until
+ * both ends agreed on an algorithm in the SETVOLUME handshake.
+ */
+#define SOCKET_COMPRESS_MAGIC 0x7F475A00U
+#define SOCKET_COMPRESS_MAGIC_MASK 0xFFFFFF00U
+#define SOCKET_COMPRESS_HDR_SIZE 12
+
+/* bigger records, which are rare, are sent as they are */
+#define SOCKET_COMPRESS_MAX_RECORD (4 * GF_UNIT_MB)
+#define SOCKET_COMPRESS_THRESHOLD 512
+
+/* after this many records in a row which did not shrink by 1/16th, the
+ * next ones are sent raw for a while, for 16 records the first time and
+ * twice as many each time it happens again, up to 1024 */
+#define SOCKET_COMPRESS_MAX_MISSES 4
+#define SOCKET_COMPRESS_MIN_BACKOFF 16
+#define SOCKET_COMPRESS_MAX_BACKOFF 1024
+
+typedef enum {
+    SOCKET_COMPRESS_NONE = 0,
+    SOCKET_COMPRESS_ZLIB,
+    SOCKET_COMPRESS_LZ4,
+    SOCKET_COMPRESS_ZSTD,
+    SOCKET_COMPRESS_MAX,
+} socket_compress_t;
+
+/* what goes out, under its own lock as records are compressed before the
+ * entry is queued, outside of out_lock */
+struct gf_sock_deflate {
+    pthread_mutex_t lock;
+    socket_compress_t algo; /* agreed with the peer */
+    uint32_t threshold;     /* smaller records are sent raw */
+    uint32_t misses;        /* records in a row which did not shrink */
+    uint32_t backoff;       /* length of the last backoff */
+    uint32_t skip;          /* records left to send raw */
+    void *ctx;
+    char *scratch; /* the record made contiguous */
+    size_t scratch_size;
+};
+
+typedef enum {
+    SP_INFLATE_HDR = 0, /* reading the 4 bytes opening a fragment */
+    SP_INFLATE_CHDR,    /* reading the rest of a compressed header */
+    SP_INFLATE_WIRE,    /* reading the compressed bytes */
+    SP_INFLATE_SERVE,   /* handing out an inflated record */
+    SP_INFLATE_RAW,     /* passing a plain fragment through */
+} sp_inflate_state_t;
+
+/* what comes in, only touched by the reader of the socket */
+struct gf_sock_inflate {
+    sp_inflate_state_t state;
+    gf_boolean_t enabled;
+    socket_compress_t algo;
+    char hdr[SOCKET_COMPRESS_HDR_SIZE];
+    uint32_t hdr_read;
+    uint32_t hdr_served; /* of a plain fragment header */
+    uint32_t raw_left;   /* of a plain fragment */
+    uint32_t wire_len;
+    uint32_t wire_read;
+    uint32_t out_len;
+    uint32_t out_served;
+    void *ctx;
+    char *wire;
+    size_t wire_size;
+    char *out;
+    size_t out_size;
+};
+
+/* 0 if @name is "off" or an algorithm built in, -1 otherwise */
+int
+socket_compress_parse(const char *name, socket_compress_t *algo);
+
+const char *
+socket_compress_name(socket_compress_t algo);
+
+gf_boolean_t
+socket_compress_supported(socket_compress_t algo);
+
+size_t
+socket_compress_bound(socket_compress_t algo, size_t len);
+
+ssize_t
+socket_compress(socket_compress_t algo, void **ctx, const char *src,
+                size_t len, char *dst, size_t size);
+
+int
+socket_decompress(socket_compress_t algo, void **ctx, const char *src,
+                  size_t len, char *dst, size_t raw_len);
+
+void
+socket_compress_ctx_free(void *ctx);
+
+void
+socket_decompress_ctx_free(void *ctx);
+
+#endif /* _SOCKET_COMPRESS_H */
@@ -0,0 +1,461 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#ifdef HAVE_SOCKET_SHM
+#include <sys/eventfd.h>
+#endif
+#include <urcu/uatomic.h>
+#include <glusterfs/syscall.h>
+
+#include "socket-shm.h"
+#include "socket-mem-types.h"
+
+#define SOCKET_SHM_HDR_SIZE 4096
+#define SOCKET_SHM_ALIGN 64
+
+/* record slot values other than a slot number */
+#define SOCKET_SHM_INLINE (-1) /* the payload follows the message */
+#define SOCKET_SHM_SKIP (-2)   /* nothing up to the end of the ring */
+
+/* The indexes only grow, their offset in the ring is taken modulo its
+ * size. Each side writes to its own cache line. */
+struct socket_shm_ring {
+    uint64_t tail; /* what the sender put in */
+    char _pad0[56];
+    uint64_t head;     /* what the receiver is done with */
+    uint32_t waiting;  /* the receiver may be asleep on its eventfd */
+    char _pad1[52];
+    uint32_t slot[SOCKET_SHM_SLOTS]; /* set while the receiver has it */
+};
+
+struct socket_shm_hdr {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t ring_size;
+    uint32_t slot_size;
+    uint32_t slots;
+    char _pad[44];
+    struct socket_shm_ring ring[2];
+};
+
+struct socket_shm_rec {
+    uint32_t len;    /* of the whole record, a multiple of 64 */
+    uint32_t hdrlen; /* of the message without its payload */
+    uint32_t paylen;
+    int32_t slot;
+};
+
+static size_t
+socket_shm_size(void)
+{
+    return SOCKET_SHM_HDR_SIZE + 2 * SOCKET_SHM_RING_SIZE +
+           2 * SOCKET_SHM_SLOTS * SOCKET_SHM_SLOT_SIZE;
+}
+
+static char *
+socket_shm_ring_base(socket_shm_t *shm, int ring)
+{
+    return shm->base + SOCKET_SHM_HDR_SIZE + ring * SOCKET_SHM_RING_SIZE;
+}
+
+static char *
+socket_shm_slot_base(socket_shm_t *shm, int ring, int slot)
+{
+    return shm->base + SOCKET_SHM_HDR_SIZE + 2 * SOCKET_SHM_RING_SIZE +
+           (size_t)(ring * SOCKET_SHM_SLOTS + slot) * SOCKET_SHM_SLOT_SIZE;
+}
+
+static socket_shm_t *
+socket_shm_map(int fd, size_t size)
+{
+    socket_shm_t *shm = NULL;
+
+    shm = GF_CALLOC(1, sizeof(*shm), gf_sock_mt_shm);
+    if (!shm)
+        return NULL;
+
+    shm->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm->base == MAP_FAILED) {
+        GF_FREE(shm);
+        return NULL;
+    }
+    shm->size = size;
+    shm->hdr = (struct socket_shm_hdr *)shm->base;
+    shm->efd[0] = -1;
+    shm->efd[1] = -1;
+    GF_ATOMIC_INIT(shm->ref, 1);
+
+    return shm;
+}
+
+void
+socket_shm_ref(socket_shm_t *shm)
+{
+    GF_ATOMIC_INC(shm->ref);
+}
+
+void
+socket_shm_unref(socket_shm_t *shm)
+{
+    if (GF_ATOMIC_DEC(shm->ref) != 0)
+        return;
+
+    munmap(shm->base, shm->size);
+    if (shm->efd[0] >= 0)
+        sys_close(shm->efd[0]);
+    if (shm->efd[1] >= 0)
+        sys_close(shm->efd[1]);
+    GF_FREE(shm);
+}
+
+/* The client end: the memfd it returns in @memfd is to be sent to the
+ * brick and closed. */
+socket_shm_t *
+socket_shm_create(int *memfd)
+{
+#ifdef HAVE_SOCKET_SHM
+    socket_shm_t *shm = NULL;
+    struct socket_shm_hdr *hdr = NULL;
+    size_t size = socket_shm_size();
+    int fd = -1;
+
+    fd = memfd_create("glusterfs-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        goto err;
+
+    /* the brick only maps it once it can no longer shrink under it */
+    if (ftruncate(fd, size) != 0 ||
+        fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+        goto err;
+
+    shm = socket_shm_map(fd, size);
+    if (!shm)
+        goto err;
+
+    shm->efd[SOCKET_SHM_TO_SERVER] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    shm->efd[SOCKET_SHM_TO_CLIENT] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (shm->efd[0] < 0 || shm->efd[1] < 0)
+        goto err;
+    shm->tx = SOCKET_SHM_TO_SERVER;
+    shm->rx = SOCKET_SHM_TO_CLIENT;
+
+    hdr = shm->hdr;
+    hdr->magic = SOCKET_SHM_MAGIC;
+    hdr->version = SOCKET_SHM_VERSION;
+    hdr->ring_size = SOCKET_SHM_RING_SIZE;
+    hdr->slot_size = SOCKET_SHM_SLOT_SIZE;
+    hdr->slots = SOCKET_SHM_SLOTS;
+    /* nobody is reading yet, the first record wakes the reader up */
+    hdr->ring[0].waiting = 1;
+    hdr->ring[1].waiting = 1;
+
+    *memfd = fd;
+    return shm;
+
+err:
+    if (shm)
+        socket_shm_unref(shm);
+    if (fd >= 0)
+        sys_close(fd);
+    return NULL;
+#else
+    errno = ENOSYS;
+    return NULL;
+#endif
+}
+
+/* The brick end, from what came with the hello of the client. The
+ * eventfds belong to the result, unless it is NULL. */
+socket_shm_t *
+socket_shm_attach(int memfd, int efd_server, int efd_client, size_t size)
+{
+#ifdef HAVE_SOCKET_SHM
+    socket_shm_t *shm = NULL;
+    struct socket_shm_hdr *hdr = NULL;
+    struct stat stbuf = {
+        0,
+    };
+    int seals = 0;
+
+    seals = fcntl(memfd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK) || size != socket_shm_size() ||
+        fstat(memfd, &stbuf) != 0 || stbuf.st_size != size) {
+        errno = EPROTO;
+        return NULL;
+    }
+
+    shm = socket_shm_map(memfd, size);
+    if (!shm)
+        return NULL;
+
+    hdr = shm->hdr;
+    if (CMM_LOAD_SHARED(hdr->magic) != SOCKET_SHM_MAGIC ||
+        CMM_LOAD_SHARED(hdr->version) != SOCKET_SHM_VERSION ||
+        CMM_LOAD_SHARED(hdr->ring_size) != SOCKET_SHM_RING_SIZE ||
+        CMM_LOAD_SHARED(hdr->slot_size) != SOCKET_SHM_SLOT_SIZE ||
+        CMM_LOAD_SHARED(hdr->slots) != SOCKET_SHM_SLOTS) {
+        socket_shm_unref(shm);
+        errno = EPROTO;
+        return NULL;
+    }
+
+    shm->efd[SOCKET_SHM_TO_SERVER] = efd_server;
+    shm->efd[SOCKET_SHM_TO_CLIENT] = efd_client;
+    shm->tx = SOCKET_SHM_TO_CLIENT;
+    shm->rx = SOCKET_SHM_TO_SERVER;
+
+    return shm;
+#else
+    errno = ENOSYS;
+    return NULL;
+#endif
+}
+
+static int
+socket_shm_slot_get(struct socket_shm_ring *ring)
+{
+    int i = 0;
+
+    /* the lowest free one, so that only as many slots as are needed at
+     * the same time ever get pages */
+    for (i = 0; i < SOCKET_SHM_SLOTS; i++) {
+        if (!CMM_LOAD_SHARED(ring->slot[i])) {
+            /* the receiver was done reading it before letting it go */
+            cmm_smp_mb();
+            return i;
+        }
+    }
+
+    return SOCKET_SHM_INLINE;
+}
+
+int
+socket_shm_put(socket_shm_t *shm, const struct iovec *hdr, int hdrcount,
+               const struct iovec *payload, int paycount)
+{
+    struct socket_shm_ring *ring = &shm->hdr->ring[shm->tx];
+    char *base = socket_shm_ring_base(shm, shm->tx);
+    struct socket_shm_rec rec = {
+        0,
+    };
+    size_t hdrlen = iov_length(hdr, hdrcount);
+    size_t paylen = iov_length(payload, paycount);
+    size_t need = 0;
+    size_t skip = 0;
+    size_t off = 0;
+    uint64_t used = 0;
+    int slot = SOCKET_SHM_INLINE;
+
+    if (paylen >= SOCKET_SHM_MIN_SLOTTED && paylen <= SOCKET_SHM_SLOT_SIZE)
+        slot = socket_shm_slot_get(ring);
+
+    need = sizeof(rec) + hdrlen + ((slot == SOCKET_SHM_INLINE) ? paylen : 0);
+    need = (need + SOCKET_SHM_ALIGN - 1) & ~(size_t)(SOCKET_SHM_ALIGN - 1);
+    if (need > SOCKET_SHM_RING_SIZE / 2)
+        return -1;
+
+    used = shm->tx_tail - CMM_LOAD_SHARED(ring->head);
+    /* the receiver read what it released before releasing it */
+    cmm_smp_mb();
+    if (used > SOCKET_SHM_RING_SIZE)
+        return -1;
+
+    off = shm->tx_tail & (SOCKET_SHM_RING_SIZE - 1);
+    if (off + need > SOCKET_SHM_RING_SIZE)
+        skip = SOCKET_SHM_RING_SIZE - off;
+    if (used + skip + need > SOCKET_SHM_RING_SIZE)
+        return -1;
+
+    if (skip) {
+        rec.len = skip;
+        rec.slot = SOCKET_SHM_SKIP;
+        memcpy(base + off, &rec, sizeof(rec));
+        shm->tx_tail += skip;
+        off = 0;
+    }
+
+    if (slot != SOCKET_SHM_INLINE) {
+        iov_unload(socket_shm_slot_base(shm, shm->tx, slot), payload,
+                   paycount);
+        CMM_STORE_SHARED(ring->slot[slot], 1);
+    }
+
+    rec.len = need;
+    rec.hdrlen = hdrlen;
+    rec.paylen = paylen;
+    rec.slot = slot;
+    memcpy(base + off, &rec, sizeof(rec));
+    iov_unload(base + off + sizeof(rec), hdr, hdrcount);
+    if (slot == SOCKET_SHM_INLINE)
+        iov_unload(base + off + sizeof(rec) + hdrlen, payload, paycount);
+    shm->tx_tail += need;
+
+    return 0;
+}
+
+/* Lets the receiver see what was put in the ring since the last call */
+void
+socket_shm_publish(socket_shm_t *shm)
+{
+    struct socket_shm_ring *ring = &shm->hdr->ring[shm->tx];
+    uint64_t one = 1;
+
+    cmm_smp_wmb();
+    CMM_STORE_SHARED(ring->tail, shm->tx_tail);
+
+    /* pairs with the barrier in socket_shm_idle(): either the receiver
+     * sees the new tail, or this sees it waiting */
+    cmm_smp_mb();
+    if (CMM_LOAD_SHARED(ring->waiting))
+        (void)sys_write(shm->efd[shm->tx], &one, sizeof(one));
+}
+
+static void
+socket_shm_slot_put(void *data, void *ptr)
+{
+    socket_shm_t *shm = data;
+    struct socket_shm_ring *ring = &shm->hdr->ring[shm->rx];
+    int slot = 0;
+
+    slot = ((char *)ptr - socket_shm_slot_base(shm, shm->rx, 0)) /
+           SOCKET_SHM_SLOT_SIZE;
+
+    /* done with the data before the sender may overwrite it */
+    cmm_smp_mb();
+    CMM_STORE_SHARED(ring->slot[slot], 0);
+
+    socket_shm_unref(shm);
+}
+
+static void
+socket_shm_consume(socket_shm_t *shm, size_t len)
+{
+    shm->rx_head += len;
+    /* the record was read before the sender may reuse its space */
+    cmm_smp_mb();
+    CMM_STORE_SHARED(shm->hdr->ring[shm->rx].head, shm->rx_head);
+}
+
+int
+socket_shm_get(socket_shm_t *shm, struct iobuf_pool *pool,
+               struct iobref **iobref, struct iovec *vector, int *count)
+{
+    struct socket_shm_ring *ring = &shm->hdr->ring[shm->rx];
+    char *base = socket_shm_ring_base(shm, shm->rx);
+    struct socket_shm_rec rec;
+    struct iobuf *iobuf = NULL;
+    struct iobuf *payload = NULL;
+    uint64_t avail = 0;
+    size_t copylen = 0;
+    size_t off = 0;
+
+    for (;;) {
+        avail = CMM_LOAD_SHARED(ring->tail) - shm->rx_head;
+        cmm_smp_rmb();
+        if (!avail)
+            return 0;
+
+        off = shm->rx_head & (SOCKET_SHM_RING_SIZE - 1);
+        if (avail > SOCKET_SHM_RING_SIZE || avail < sizeof(rec))
+            return -1;
+
+        memcpy(&rec, base + off, sizeof(rec));
+        if (rec.len < sizeof(rec) || rec.len % SOCKET_SHM_ALIGN ||
+            rec.len > avail || off + rec.len > SOCKET_SHM_RING_SIZE)
+            return -1;
+
+        if (rec.slot != SOCKET_SHM_SKIP)
+            break;
+        socket_shm_consume(shm, rec.len);
+    }
+
+    /* enough for an xid and a message type */
+    if (rec.hdrlen < 8)
+        return -1;
+    copylen = rec.hdrlen;
+    if (rec.slot == SOCKET_SHM_INLINE)
+        copylen += rec.paylen;
+    else if (rec.slot < 0 || rec.slot >= SOCKET_SHM_SLOTS || !rec.paylen ||
+             rec.paylen > SOCKET_SHM_SLOT_SIZE)
+        return -1;
+    if (sizeof(rec) + copylen > rec.len)
+        return -1;
+
+    *iobref = iobref_new();
+    if (!*iobref)
+        return -1;
+
+    iobuf = iobuf_get2(pool, copylen);
+    if (!iobuf)
+        goto err;
+    memcpy(iobuf_ptr(iobuf), base + off + sizeof(rec), copylen);
+    iobref_add(*iobref, iobuf);
+    iobuf_unref(iobuf);
+
+    vector[0].iov_base = iobuf_ptr(iobuf);
+    vector[0].iov_len = rec.hdrlen;
+    *count = 1;
+
+    if (rec.slot != SOCKET_SHM_INLINE) {
+        socket_shm_ref(shm);
+        payload = iobuf_wrap(socket_shm_slot_base(shm, shm->rx, rec.slot),
+                             rec.paylen, socket_shm_slot_put, shm);
+        if (!payload) {
+            socket_shm_unref(shm);
+            goto err;
+        }
+        iobref_add(*iobref, payload);
+        iobuf_unref(payload);
+
+        vector[1].iov_base = iobuf_ptr(payload);
+        vector[1].iov_len = rec.paylen;
+        *count = 2;
+    } else if (rec.paylen) {
+        vector[1].iov_base = (char *)iobuf_ptr(iobuf) + rec.hdrlen;
+        vector[1].iov_len = rec.paylen;
+        *count = 2;
+    }
+
+    socket_shm_consume(shm, rec.len);
+    return 1;
+
+err:
+    iobref_unref(*iobref);
+    *iobref = NULL;
+    return -1;
+}
+
+/* Called by the receiver before it looks at the ring */
+void
+socket_shm_wake(socket_shm_t *shm)
+{
+    uint64_t value = 0;
+
+    (void)sys_read(shm->efd[shm->rx], &value, sizeof(value));
+    CMM_STORE_SHARED(shm->hdr->ring[shm->rx].waiting, 0);
+}
+
+/* True if the receiver may go to sleep until its eventfd is written */
+gf_boolean_t
+socket_shm_idle(socket_shm_t *shm)
+{
+    struct socket_shm_ring *ring = &shm->hdr->ring[shm->rx];
+
+    CMM_STORE_SHARED(ring->waiting, 1);
+    cmm_smp_mb();
+    if (CMM_LOAD_SHARED(ring->tail) == shm->rx_head)
+        return _gf_true;
+
+    CMM_STORE_SHARED(ring->waiting, 0);
+    return _gf_false;
+}
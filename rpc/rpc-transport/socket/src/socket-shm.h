@@ -0,0 +1,102 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _SOCKET_SHM_H
+#define _SOCKET_SHM_H
+
+#include <sys/uio.h>
+#include <glusterfs/common-utils.h>
+#include <glusterfs/iobuf.h>
+
+/* Shared memory between a client and a brick running on the same host.
+ * The client creates a sealed memfd and passes it, along with an eventfd
+ * for each end, in the first message on a unix socket the brick listens
+ * on for that purpose. The memfd is laid out as
+ *
+ *     the header page     geometry and the indexes of both rings
+ *     ring 0, ring 1      records to the brick, records to the client
+ *     slots 0, slots 1    payloads to the brick, payloads to the client
+ *
+ * A record is an RPC message without its fragment header. Its payload, the
+ * data of a WRITE or of a READ reply, is copied into a free slot when it is
+ * large enough and handed to the receiver in place: the slot goes back to
+ * the sender once the last reference to that iobuf is dropped. Smaller
+ * payloads follow the rest of the message in the record. What does not fit,
+ * because the ring is full or the message too big, is sent over the unix
+ * socket as usual, which is also how each end learns that the other one is
+ * gone.
+ *
+ * The receiver copies everything but slotted payloads out of the ring
+ * before looking at it, and checks every index and length it reads from
+ * the shared pages, so a peer scribbling over them can only hurt itself.
+ */
+#define SOCKET_SHM_MAGIC 0x47534852U /* GSHR */
+#define SOCKET_SHM_VERSION 1
+
+#define SOCKET_SHM_RING_SIZE (1 * GF_UNIT_MB)
+#define SOCKET_SHM_SLOT_SIZE (128 * GF_UNIT_KB)
+#define SOCKET_SHM_SLOTS 32
+/* smaller payloads are not worth a slot */
+#define SOCKET_SHM_MIN_SLOTTED (4 * GF_UNIT_KB)
+
+#define SOCKET_SHM_TO_SERVER 0
+#define SOCKET_SHM_TO_CLIENT 1
+
+/* the first message of the client, with the memfd and the eventfds of the
+ * rings to the server and to the client, in that order */
+struct socket_shm_hello {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t size; /* of the memfd */
+};
+
+typedef struct socket_shm {
+    gf_atomic_t ref; /* the transport, and each payload handed out */
+    char *base;
+    size_t size;
+    struct socket_shm_hdr *hdr;
+    int efd[2]; /* written when records are put in the ring of that index */
+    int tx;     /* the ring this end writes to */
+    int rx;
+    uint64_t tx_tail; /* not published yet */
+    uint64_t rx_head; /* only touched by the reader */
+} socket_shm_t;
+
+socket_shm_t *
+socket_shm_create(int *memfd);
+
+socket_shm_t *
+socket_shm_attach(int memfd, int efd_server, int efd_client, size_t size);
+
+void
+socket_shm_ref(socket_shm_t *shm);
+
+void
+socket_shm_unref(socket_shm_t *shm);
+
+/* 0 when the message is in the ring, -1 when it has to go elsewhere */
+int
+socket_shm_put(socket_shm_t *shm, const struct iovec *hdr, int hdrcount,
+               const struct iovec *payload, int paycount);
+
+void
+socket_shm_publish(socket_shm_t *shm);
+
+/* 1 with a message in @vector, 0 with none left, -1 on garbage */
+int
+socket_shm_get(socket_shm_t *shm, struct iobuf_pool *pool,
+               struct iobref **iobref, struct iovec *vector, int *count);
+
+void
+socket_shm_wake(socket_shm_t *shm);
+
+gf_boolean_t
+socket_shm_idle(socket_shm_t *shm);
+
+#endif /* _SOCKET_SHM_H */
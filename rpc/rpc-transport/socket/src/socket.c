@@ -42,6 +42,7 @@
 #define SSL_DH_PARAM_OPT "transport.socket.ssl-dh-param"
 #define SSL_EC_CURVE_OPT "transport.socket.ssl-ec-curve"
 #define SSL_CRL_PATH_OPT "transport.socket.ssl-crl-path"
+#define SSL_KTLS_OPT "transport.socket.ssl-ktls"
 #define OWN_THREAD_OPT "transport.socket.own-thread"
 
 #if !defined(DEFAULT_CERT_PATH)
@@ -281,6 +282,83 @@ out:
 #define ssl_write_one(p, b, l)                                                 \
     ssl_do((p), (b), (l), (SSL_trinary_func *)SSL_write)
 
+/* Whether OpenSSL holds data read off the socket, decrypted or not, which
+ * the poller would not wake us up for */
+static gf_boolean_t
+ssl_has_pending(socket_private_t *priv)
+{
+    if (!priv->ssl_ssl)
+        return _gf_false;
+#if OPENSSL_VERSION_NUMBER >= 0x1010000f
+    return SSL_has_pending(priv->ssl_ssl) ? _gf_true : _gf_false;
+#else
+    return (SSL_pending(priv->ssl_ssl) > 0) ? _gf_true : _gf_false;
+#endif
+}
+
+/* Fills the vector with as many records as OpenSSL has at hand, going
+ * back to the socket only for the first one, so that what it read ahead
+ * is decrypted in this pass rather than a record at a time */
+static ssize_t
+ssl_readv(socket_private_t *priv, struct iovec *opvector, int opcount)
+{
+    ssize_t total = 0;
+    size_t done = 0;
+    int ret = 0;
+
+    while (opcount > 0) {
+        if (done == opvector->iov_len) {
+            opvector++;
+            opcount--;
+            done = 0;
+            continue;
+        }
+        if (total && !ssl_has_pending(priv))
+            break;
+
+        ret = ssl_read_one(priv, (char *)opvector->iov_base + done,
+                           opvector->iov_len - done);
+        if (ret <= 0)
+            return total ? total : ret;
+
+        total += ret;
+        done += ret;
+    }
+
+    return total;
+}
+
+/* Small vectors are gathered into a record of their own rather than each
+ * costing one, along with the write that goes with it. Until a record is
+ * written, the same vectors are gathered again for each attempt, hence
+ * SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER. */
+static ssize_t
+ssl_writev(socket_private_t *priv, struct iovec *opvector, int opcount)
+{
+    size_t len = 0;
+    size_t n = 0;
+    int i = 0;
+
+    if (opcount == 1 || opvector[0].iov_len >= SSL3_RT_MAX_PLAIN_LENGTH)
+        return ssl_write_one(priv, opvector->iov_base, opvector->iov_len);
+
+    if (!priv->ssl_wbuf) {
+        priv->ssl_wbuf = GF_MALLOC(SSL3_RT_MAX_PLAIN_LENGTH,
+                                   gf_sock_mt_ssl_buf);
+        if (!priv->ssl_wbuf)
+            return ssl_write_one(priv, opvector->iov_base,
+                                 opvector->iov_len);
+    }
+
+    for (i = 0; i < opcount && len < SSL3_RT_MAX_PLAIN_LENGTH; i++) {
+        n = min(opvector[i].iov_len, SSL3_RT_MAX_PLAIN_LENGTH - len);
+        memcpy(priv->ssl_wbuf + len, opvector[i].iov_base, n);
+        len += n;
+    }
+
+    return ssl_write_one(priv, priv->ssl_wbuf, len);
+}
+
 /* set crl verify flags only for server */
 /* see man X509_VERIFY_PARAM_SET_FLAGS(3)
  * X509_V_FLAG_CRL_CHECK enables CRL checking for the certificate chain
@@ -406,7 +484,8 @@ ssl_setup_connection_postfix(rpc_transport_t *this)
         goto ssl_error;
     }
 
-    SSL_set_mode(priv->ssl_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE);
+    SSL_set_mode(priv->ssl_ssl, SSL_MODE_ENABLE_PARTIAL_WRITE |
+                                    SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
 
     /* Finally, everything seems OK. */
     X509_NAME_get_text_by_NID(X509_get_subject_name(peer), NID_commonName,
@@ -431,6 +510,45 @@ ssl_error:
     return NULL;
 }
 
+/* With the handshake over, OpenSSL has handed the keys to the kernel for
+ * either direction it could (transport.socket.ssl-ktls). What the kernel
+ * encrypts is written to the socket as it is; records OpenSSL decrypts
+ * itself are read ahead, several at a time. */
+static void
+ssl_setup_offload(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+
+    priv->ssl_ktls_tx = _gf_false;
+    priv->ssl_ktls_rx = _gf_false;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (BIO_get_ktls_send(SSL_get_wbio(priv->ssl_ssl)))
+        priv->ssl_ktls_tx = _gf_true;
+    if (BIO_get_ktls_recv(SSL_get_rbio(priv->ssl_ssl)))
+        priv->ssl_ktls_rx = _gf_true;
+#endif
+#if OPENSSL_VERSION_NUMBER >= 0x1010000f
+    if (!priv->ssl_ktls_rx)
+        SSL_set_read_ahead(priv->ssl_ssl, 1);
+#endif
+
+    if (priv->ssl_ktls_tx && priv->ssl_ktls_rx)
+        this->crypto_mode = "ktls";
+    else if (priv->ssl_ktls_tx)
+        this->crypto_mode = "ktls-tx";
+    else if (priv->ssl_ktls_rx)
+        this->crypto_mode = "ktls-rx";
+    else
+        this->crypto_mode = "openssl";
+    this->crypto_since = gf_time();
+    this->crypto_bytes_read = 0;
+    this->crypto_bytes_write = 0;
+
+    gf_log(this->name, GF_LOG_DEBUG, "%s uses %s (%s)",
+           this->peerinfo.identifier, SSL_get_version(priv->ssl_ssl),
+           this->crypto_mode);
+}
+
 static int
 ssl_complete_connection(rpc_transport_t *this)
 {
@@ -473,6 +591,7 @@ ssl_complete_connection(rpc_transport_t *this)
                 ret = -1;
             } else {
                 this->ssl_name = cname;
+                ssl_setup_offload(this);
                 if (priv->is_server) {
                     priv->ssl_accepted = _gf_true;
                     gf_log(this->name, GF_LOG_TRACE, "ssl_accepted!");
@@ -538,7 +657,7 @@ ssl_teardown_connection(socket_private_t *priv)
 }
 
 static ssize_t
-__socket_ssl_readv(rpc_transport_t *this, struct iovec *opvector, int opcount)
+__socket_wire_readv(rpc_transport_t *this, struct iovec *opvector, int opcount)
 {
     socket_private_t *priv = NULL;
     int sock = -1;
@@ -549,7 +668,7 @@ __socket_ssl_readv(rpc_transport_t *this, struct iovec *opvector, int opcount)
 
     if (priv->use_ssl) {
         gf_log(this->name, GF_LOG_TRACE, "***** reading over SSL");
-        ret = ssl_read_one(priv, opvector->iov_base, opvector->iov_len);
+        ret = ssl_readv(priv, opvector, opcount);
     } else {
         gf_log(this->name, GF_LOG_TRACE, "***** reading over non-SSL");
         ret = sys_readv(sock, opvector, IOV_MIN(opcount));
@@ -558,6 +677,183 @@ __socket_ssl_readv(rpc_transport_t *this, struct iovec *opvector, int opcount)
     return ret;
 }
 
+static int
+__socket_inflate_grow(char **buf, size_t *size, size_t len)
+{
+    char *tmp = NULL;
+
+    if (*size >= len)
+        return 0;
+
+    tmp = GF_REALLOC(*buf, len);
+    if (!tmp)
+        return -1;
+
+    *buf = tmp;
+    *size = len;
+
+    return 0;
+}
+
+/* The header of a compressed record is in, check it and get room for the
+ * record both compressed and inflated */
+static int
+__socket_inflate_start(rpc_transport_t *this, struct gf_sock_inflate *in)
+{
+    uint32_t word = 0;
+
+    memcpy(&word, &in->hdr[4], sizeof(word));
+    in->wire_len = ntohl(word);
+    memcpy(&word, &in->hdr[8], sizeof(word));
+    in->out_len = ntohl(word);
+
+    if (!socket_compress_supported(in->algo) ||
+        in->algo == SOCKET_COMPRESS_NONE ||
+        in->out_len > SOCKET_COMPRESS_MAX_RECORD ||
+        in->wire_len > socket_compress_bound(in->algo, in->out_len)) {
+        gf_log(this->name, GF_LOG_ERROR,
+               "bad compressed record from %s (algorithm %d, %u bytes "
+               "for %u)",
+               this->peerinfo.identifier, in->algo, in->wire_len, in->out_len);
+        return -1;
+    }
+
+    if (__socket_inflate_grow(&in->wire, &in->wire_size, in->wire_len) ||
+        __socket_inflate_grow(&in->out, &in->out_size, in->out_len))
+        return -1;
+
+    in->wire_read = 0;
+
+    return 0;
+}
+
+/* Inflates the stream read from the socket. Records the peer compressed
+ * are read in whole, inflated, and served from memory; the others are
+ * passed through, the four bytes of each fragment header being all that
+ * is held back to tell them apart. Reading never goes beyond the record
+ * being served, so nothing is left here when a record is complete and the
+ * socket has no more to give. */
+static ssize_t
+__socket_inflate_readv(rpc_transport_t *this, struct iovec *opvector,
+                       int opcount)
+{
+    socket_private_t *priv = this->private;
+    struct gf_sock_inflate *in = &priv->inflate;
+    struct iovec iov;
+    uint32_t word = 0;
+    ssize_t ret = -1;
+
+    for (;;) {
+        switch (in->state) {
+            case SP_INFLATE_HDR:
+                iov.iov_base = &in->hdr[in->hdr_read];
+                iov.iov_len = sizeof(word) - in->hdr_read;
+                ret = __socket_wire_readv(this, &iov, 1);
+                if (ret <= 0)
+                    return ret;
+                in->hdr_read += ret;
+                if (in->hdr_read < sizeof(word))
+                    break;
+
+                memcpy(&word, in->hdr, sizeof(word));
+                word = ntohl(word);
+                if ((word & SOCKET_COMPRESS_MAGIC_MASK) ==
+                    SOCKET_COMPRESS_MAGIC) {
+                    in->algo = word & ~SOCKET_COMPRESS_MAGIC_MASK;
+                    in->state = SP_INFLATE_CHDR;
+                } else {
+                    in->raw_left = RPC_FRAGSIZE(word);
+                    in->hdr_served = 0;
+                    in->state = SP_INFLATE_RAW;
+                }
+                break;
+
+            case SP_INFLATE_CHDR:
+                iov.iov_base = &in->hdr[in->hdr_read];
+                iov.iov_len = SOCKET_COMPRESS_HDR_SIZE - in->hdr_read;
+                ret = __socket_wire_readv(this, &iov, 1);
+                if (ret <= 0)
+                    return ret;
+                in->hdr_read += ret;
+                if (in->hdr_read < SOCKET_COMPRESS_HDR_SIZE)
+                    break;
+
+                if (__socket_inflate_start(this, in)) {
+                    errno = EPROTO;
+                    return -1;
+                }
+                in->state = SP_INFLATE_WIRE;
+                break;
+
+            case SP_INFLATE_WIRE:
+                iov.iov_base = &in->wire[in->wire_read];
+                iov.iov_len = in->wire_len - in->wire_read;
+                ret = __socket_wire_readv(this, &iov, 1);
+                if (ret <= 0)
+                    return ret;
+                in->wire_read += ret;
+                if (in->wire_read < in->wire_len)
+                    break;
+
+                if (socket_decompress(in->algo, &in->ctx, in->wire,
+                                      in->wire_len, in->out, in->out_len)) {
+                    gf_log(this->name, GF_LOG_ERROR,
+                           "failed to inflate a record of %u bytes from %s",
+                           in->out_len, this->peerinfo.identifier);
+                    errno = EPROTO;
+                    return -1;
+                }
+                GF_ATOMIC_ADD(this->compress_saved_read,
+                              in->out_len - in->wire_len -
+                                  SOCKET_COMPRESS_HDR_SIZE);
+                in->out_served = 0;
+                in->state = SP_INFLATE_SERVE;
+                break;
+
+            case SP_INFLATE_SERVE:
+                ret = iov_load(opvector, opcount, &in->out[in->out_served],
+                               in->out_len - in->out_served);
+                in->out_served += ret;
+                if (in->out_served == in->out_len) {
+                    in->hdr_read = 0;
+                    in->state = SP_INFLATE_HDR;
+                }
+                return ret;
+
+            case SP_INFLATE_RAW:
+                if (in->hdr_served < sizeof(word)) {
+                    ret = iov_load(opvector, opcount,
+                                   &in->hdr[in->hdr_served],
+                                   sizeof(word) - in->hdr_served);
+                    in->hdr_served += ret;
+                } else {
+                    iov = opvector[0];
+                    iov.iov_len = min(iov.iov_len, in->raw_left);
+                    ret = __socket_wire_readv(this, &iov, 1);
+                    if (ret <= 0)
+                        return ret;
+                    in->raw_left -= ret;
+                }
+                if (in->hdr_served == sizeof(word) && !in->raw_left) {
+                    in->hdr_read = 0;
+                    in->state = SP_INFLATE_HDR;
+                }
+                return ret;
+        }
+    }
+}
+
+static ssize_t
+__socket_ssl_readv(rpc_transport_t *this, struct iovec *opvector, int opcount)
+{
+    socket_private_t *priv = this->private;
+
+    if (priv->inflate.enabled)
+        return __socket_inflate_readv(this, opvector, opcount);
+
+    return __socket_wire_readv(this, opvector, opcount);
+}
+
 static ssize_t
 __socket_ssl_read(rpc_transport_t *this, void *buf, size_t count)
 {
@@ -705,18 +1001,22 @@ __socket_rwv(rpc_transport_t *this, struct iovec *vector, int count,
             gf_log(this->name, GF_LOG_TRACE,
                    "### no priv->ssl_ssl yet; ret = -1;");
         } else if (write) {
-            if (priv->use_ssl) {
-                ret = ssl_write_one(priv, opvector->iov_base,
-                                    opvector->iov_len);
+            if (priv->use_ssl && !priv->ssl_ktls_tx) {
+                ret = ssl_writev(priv, opvector, opcount);
             } else {
+                /* the kernel makes records of what is written to a
+                 * socket it has the keys of */
                 ret = sys_writev(sock, opvector, IOV_MIN(opcount));
             }
 
             if ((ret == 0) || ((ret < 0) && (errno == EAGAIN))) {
                 /* done for now */
                 break;
-            } else if (ret > 0)
+            } else if (ret > 0) {
                 this->total_bytes_write += ret;
+                if (priv->use_ssl)
+                    this->crypto_bytes_write += ret;
+            }
         } else {
             ret = __socket_cached_read(this, opvector, opcount);
             if (ret == 0) {
@@ -730,8 +1030,11 @@ __socket_rwv(rpc_transport_t *this, struct iovec *vector, int count,
             if ((ret < 0) && (errno == EAGAIN)) {
                 /* done for now */
                 break;
-            } else if (ret > 0)
+            } else if (ret > 0) {
                 this->total_bytes_read += ret;
+                if (priv->use_ssl)
+                    this->crypto_bytes_read += ret;
+            }
         }
 
         if (ret == 0) {
@@ -1132,6 +1435,96 @@ __socket_connect_finish(int fd)
     return ret;
 }
 
+/* Reads the compression options; they apply from the next connection */
+static int
+socket_compress_configure(rpc_transport_t *this, dict_t *options)
+{
+    socket_private_t *priv = this->private;
+    socket_compress_t algo = SOCKET_COMPRESS_NONE;
+    char *optstr = NULL;
+
+    if (dict_get_str_sizen(options, "transport.socket.compression",
+                           &optstr) == 0 &&
+        socket_compress_parse(optstr, &algo) != 0) {
+        gf_log(this->name, GF_LOG_WARNING,
+               "compression algorithm %s is not supported, not compressing",
+               optstr);
+        algo = SOCKET_COMPRESS_NONE;
+    }
+    priv->compress_conf = algo;
+
+    if (dict_get_uint32(options, "transport.socket.compression-threshold",
+                        &priv->compress_threshold) != 0)
+        priv->compress_threshold = SOCKET_COMPRESS_THRESHOLD;
+
+    return 0;
+}
+
+/* Nothing is compressed on a new connection until the peer agrees to it,
+ * but anything it sends may be, once it is told this end can inflate. */
+static void
+__socket_compress_reset(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    struct gf_sock_inflate *in = &priv->inflate;
+    struct gf_sock_deflate *out = &priv->deflate;
+
+    in->state = SP_INFLATE_HDR;
+    in->hdr_read = 0;
+    in->enabled = (priv->compress_conf != SOCKET_COMPRESS_NONE);
+    this->compress_offer = in->enabled
+                               ? socket_compress_name(priv->compress_conf)
+                               : NULL;
+
+    pthread_mutex_lock(&out->lock);
+    {
+        out->algo = SOCKET_COMPRESS_NONE;
+        out->threshold = priv->compress_threshold;
+        out->misses = 0;
+        out->backoff = 0;
+        out->skip = 0;
+    }
+    pthread_mutex_unlock(&out->lock);
+}
+
+static int32_t
+socket_set_compression(rpc_transport_t *this, const char *algo)
+{
+    socket_private_t *priv = this->private;
+    socket_compress_t value = SOCKET_COMPRESS_NONE;
+
+    /* the peer may only compress what this end could inflate, and the
+     * other way around */
+    if (!priv->inflate.enabled || socket_compress_parse(algo, &value) ||
+        value == SOCKET_COMPRESS_NONE)
+        return -1;
+
+    pthread_mutex_lock(&priv->deflate.lock);
+    {
+        priv->deflate.algo = value;
+    }
+    pthread_mutex_unlock(&priv->deflate.lock);
+
+    gf_log(this->name, GF_LOG_INFO, "compressing what is sent to %s with %s",
+           this->peerinfo.identifier, algo);
+
+    return 0;
+}
+
+static void
+__socket_shm_drop(socket_private_t *priv)
+{
+    if (priv->shm) {
+        socket_shm_unref(priv->shm);
+        priv->shm = NULL;
+    }
+    if (priv->shm_memfd >= 0) {
+        sys_close(priv->shm_memfd);
+        priv->shm_memfd = -1;
+    }
+    priv->shm_state = SOCKET_SHM_NONE;
+}
+
 static void
 __socket_reset(rpc_transport_t *this)
 {
@@ -1156,6 +1549,13 @@ __socket_reset(rpc_transport_t *this)
     memset(&priv->incoming, 0, sizeof(priv->incoming));
 
     gf_event_unregister_close(this->ctx->event_pool, priv->sock, priv->idx);
+    if (priv->shm_idx != -1) {
+        /* the eventfd is closed along with the mapping */
+        gf_event_unregister(this->ctx->event_pool,
+                            priv->shm->efd[priv->shm->rx], priv->shm_idx);
+        priv->shm_idx = -1;
+    }
+    __socket_shm_drop(priv);
     if (priv->use_ssl && priv->ssl_ssl) {
         SSL_clear(priv->ssl_ssl);
         SSL_free(priv->ssl_ssl);
@@ -1165,9 +1565,14 @@ __socket_reset(rpc_transport_t *this)
         SSL_CTX_free(priv->ssl_ctx);
         priv->ssl_ctx = NULL;
     }
+    priv->ssl_ktls_tx = _gf_false;
+    priv->ssl_ktls_rx = _gf_false;
+    this->crypto_mode = NULL;
     priv->sock = -1;
     priv->idx = -1;
     priv->connected = -1;
+    /* submissions still in flight for this connection notice it */
+    GF_ATOMIC_INC(priv->outq.gen);
     priv->ssl_connected = _gf_false;
     priv->ssl_accepted = _gf_false;
     priv->ssl_context_created = _gf_false;
@@ -1184,6 +1589,8 @@ __socket_reset(rpc_transport_t *this)
         GF_FREE(priv->ssl_ca_list);
         priv->ssl_ca_list = NULL;
     }
+
+    __socket_compress_reset(this);
 }
 
 static void
@@ -1257,6 +1664,7 @@ __socket_ioq_new(rpc_transport_msg_t *msg)
         memcpy(&entry->vector[entry->count], msg->progpayload,
                sizeof(struct iovec) * msg->progpayloadcount);
         entry->count += msg->progpayloadcount;
+        entry->payload_count = msg->progpayloadcount;
     }
 
     entry->pending_vector = entry->vector;
@@ -1278,11 +1686,36 @@ __socket_ioq_entry_free(struct ioq *entry)
     GF_FREE(entry);
 }
 
+/* Moves what was submitted since the last call to the tail of ioq.
+ * Messages submitted for a connection that has been reset since are
+ * dropped; their submitters have been told so. */
+static void
+__socket_ioq_splice(socket_private_t *priv)
+{
+    struct cds_wfcq_node *node = NULL;
+    struct ioq *entry = NULL;
+    uint32_t gen = 0;
+
+    gen = GF_ATOMIC_GET(priv->outq.gen);
+
+    while ((node = __cds_wfcq_dequeue_blocking(&priv->outq.head,
+                                               &priv->outq.tail)) != NULL) {
+        entry = caa_container_of(node, struct ioq, node);
+        if (entry->gen != gen) {
+            __socket_ioq_entry_free(entry);
+            continue;
+        }
+        list_add_tail(&entry->list, &priv->ioq);
+    }
+}
+
 static void
 __socket_ioq_flush(socket_private_t *priv)
 {
     struct ioq *entry = NULL;
 
+    __socket_ioq_splice(priv);
+
     while (!list_empty(&priv->ioq)) {
         entry = priv->ioq_next;
         if (entry)
@@ -1290,20 +1723,93 @@ __socket_ioq_flush(socket_private_t *priv)
     }
 }
 
+/* Puts the head of ioq in the shared memory ring, up to the first message
+ * that does not fit there or that has been partially written already.
+ * Returns the number of messages put. */
 static int
-__socket_ioq_churn_entry(rpc_transport_t *this, struct ioq *entry,
-                         gf_boolean_t free_entry)
+__socket_shm_churn(rpc_transport_t *this)
 {
-    int ret;
+    socket_private_t *priv = this->private;
+    struct ioq *entry = NULL;
+    struct ioq *tmp = NULL;
+    int hdrcount = 0;
+    int sent = 0;
 
-    ret = __socket_writev(this, entry->pending_vector, entry->pending_count,
-                          &entry->pending_vector, &entry->pending_count);
+    list_for_each_entry_safe(entry, tmp, &priv->ioq, list)
+    {
+        if (entry->pending_count != entry->count ||
+            entry->vector[0].iov_base != &entry->fraghdr)
+            break;
 
-    if (ret == 0) {
-        /* current entry was completely written */
-        GF_ASSERT(entry->pending_count == 0);
-        if (free_entry)
-            __socket_ioq_entry_free(entry);
+        hdrcount = entry->count - 1 - entry->payload_count;
+        if (socket_shm_put(priv->shm, &entry->vector[1], hdrcount,
+                           &entry->vector[1 + hdrcount],
+                           entry->payload_count) != 0) {
+            GF_ATOMIC_INC(this->shm_ring_full);
+            break;
+        }
+        __socket_ioq_entry_free(entry);
+        sent++;
+    }
+
+    if (sent) {
+        GF_ATOMIC_ADD(this->shm_records_sent, sent);
+        socket_shm_publish(priv->shm);
+    }
+
+    return sent;
+}
+
+/* Writes the head of ioq, gathering the pending vectors of as many
+ * messages as one writev() takes. Returns like __socket_writev(). */
+static int
+__socket_ioq_churn_gather(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    struct iovec vector[IOV_MAX];
+    struct iovec *pending_vector = NULL;
+    struct ioq *entry = NULL;
+    struct ioq *tmp = NULL;
+    int pending_count = 0;
+    int count = 0;
+    int done = 0;
+    int ret = -1;
+
+    if (priv->shm_state == SOCKET_SHM_UP) {
+        __socket_shm_churn(this);
+        if (list_empty(&priv->ioq))
+            return 0;
+    }
+
+    list_for_each_entry(entry, &priv->ioq, list)
+    {
+        if (count + entry->pending_count > IOV_MAX)
+            break;
+        memcpy(&vector[count], entry->pending_vector,
+               entry->pending_count * sizeof(*vector));
+        count += entry->pending_count;
+    }
+
+    ret = __socket_writev(this, vector, count, &pending_vector,
+                          &pending_count);
+    if (ret < 0)
+        return ret;
+
+    /* hand what is left back to the messages it came from */
+    done = count - pending_count;
+    list_for_each_entry_safe(entry, tmp, &priv->ioq, list)
+    {
+        if (done < entry->pending_count) {
+            /* the first vector left may have been written partially */
+            entry->pending_vector += done;
+            entry->pending_count -= done;
+            entry->pending_vector[0] = *pending_vector;
+            break;
+        }
+        done -= entry->pending_count;
+        __socket_ioq_entry_free(entry);
+        if (!done && !pending_count)
+            break;
     }
 
     return ret;
@@ -1314,15 +1820,13 @@ __socket_ioq_churn(rpc_transport_t *this)
 {
     socket_private_t *priv = NULL;
     int ret = 0;
-    struct ioq *entry = NULL;
 
     priv = this->private;
 
-    while (!list_empty(&priv->ioq)) {
-        /* pick next entry */
-        entry = priv->ioq_next;
+    __socket_ioq_splice(priv);
 
-        ret = __socket_ioq_churn_entry(this, entry, _gf_true);
+    while (!list_empty(&priv->ioq)) {
+        ret = __socket_ioq_churn_gather(this);
 
         if (ret != 0)
             break;
@@ -1593,7 +2097,14 @@ __socket_read_vectored_request(rpc_transport_t *this,
         sp_state_read_proghdr_xdata:
             if (in->payload_vector.iov_base == NULL) {
                 size = RPC_FRAGSIZE(in->fraghdr) - frag->bytes_read;
-                iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+                /* payloads of whole sectors (the data of writes) are
+                 * placed so that the brick can write them with O_DIRECT
+                 * without copying them */
+                if (size && !(size & (GF_IOBUF_ALIGN_SIZE - 1)))
+                    iobuf = iobuf_get_page_aligned(this->ctx->iobuf_pool, size,
+                                                   GF_IOBUF_DIRECT_ALIGN_SIZE);
+                else
+                    iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
                 if (!iobuf) {
                     ret = -1;
                     break;
@@ -2392,27 +2903,299 @@ socket_event_poll_in(rpc_transport_t *this, gf_boolean_t notify_handled)
     rpc_transport_pollin_t *pollin = NULL;
     socket_private_t *priv = this->private;
     glusterfs_ctx_t *ctx = NULL;
+    gf_boolean_t more = _gf_false;
 
     ctx = this->ctx;
 
-    ret = socket_proto_state_machine(this, &pollin);
+    do {
+        pollin = NULL;
+        ret = socket_proto_state_machine(this, &pollin);
 
-    if (pollin) {
-        pthread_mutex_lock(&priv->notify.lock);
+        if (pollin) {
+            pthread_mutex_lock(&priv->notify.lock);
+            {
+                priv->notify.in_progress++;
+            }
+            pthread_mutex_unlock(&priv->notify.lock);
+        }
+
+        /* a record can carry the start of the next message, which is
+         * then read off the socket already */
+        more = (ret >= 0) && pollin && priv->use_ssl &&
+               ssl_has_pending(priv);
+
+        if (notify_handled && (ret >= 0) && !more)
+            gf_event_handled(ctx->event_pool, priv->sock, priv->idx,
+                             priv->gen);
+
+        if (pollin) {
+            rpc_transport_ref(this);
+            gf_async(&pollin->async, socket_event_poll_in_async);
+        }
+    } while (more);
+
+    return ret;
+}
+
+/* Receives from the shared memory ring, on a write to its eventfd */
+static void
+socket_shm_event_handler(int fd, int idx, int gen, void *data, int poll_in,
+                         int poll_out, int poll_err, char event_thread_died)
+{
+    rpc_transport_t *this = data;
+    socket_private_t *priv = this->private;
+    rpc_transport_pollin_t *pollin = NULL;
+    socket_shm_t *shm = NULL;
+    struct iobref *iobref = NULL;
+    struct iovec vector[2];
+    uint32_t msg_type = 0;
+    int count = 0;
+    int ret = 0;
+
+    if (event_thread_died)
+        return;
+
+    rpc_transport_ref(this);
+    THIS = this->xl;
+
+    /* a reset waits for what is in progress before notifying the
+     * disconnection, and drops the ring */
+    pthread_mutex_lock(&priv->out_lock);
+    {
+        if (priv->shm && priv->shm_idx == idx) {
+            shm = priv->shm;
+            socket_shm_ref(shm);
+            pthread_mutex_lock(&priv->notify.lock);
+            {
+                priv->notify.in_progress++;
+            }
+            pthread_mutex_unlock(&priv->notify.lock);
+        }
+    }
+    pthread_mutex_unlock(&priv->out_lock);
+
+    if (!shm)
+        goto out;
+
+    socket_shm_wake(shm);
+    do {
+        while ((ret = socket_shm_get(shm, this->ctx->iobuf_pool, &iobref,
+                                     vector, &count)) > 0) {
+            pollin = rpc_transport_pollin_alloc(this, vector, count, NULL,
+                                                iobref, NULL);
+            iobref_unref(iobref);
+            if (!pollin) {
+                ret = -1;
+                break;
+            }
+            memcpy(&msg_type, (char *)vector[0].iov_base + 4,
+                   sizeof(msg_type));
+            if (ntohl(msg_type) == REPLY)
+                pollin->is_reply = 1;
+
+            GF_ATOMIC_INC(this->shm_records_received);
+
+            pthread_mutex_lock(&priv->notify.lock);
+            {
+                priv->notify.in_progress++;
+            }
+            pthread_mutex_unlock(&priv->notify.lock);
+            rpc_transport_ref(this);
+            gf_async(&pollin->async, socket_event_poll_in_async);
+        }
+    } while (ret == 0 && !socket_shm_idle(shm));
+
+    if (ret < 0) {
+        gf_log(this->name, GF_LOG_ERROR,
+               "bad record in the shared memory ring of %s, disconnecting",
+               this->peerinfo.identifier);
+        pthread_mutex_lock(&priv->out_lock);
         {
-            priv->notify.in_progress++;
+            if (priv->shm == shm)
+                __socket_disconnect(this);
         }
-        pthread_mutex_unlock(&priv->notify.lock);
+        pthread_mutex_unlock(&priv->out_lock);
     }
 
-    if (notify_handled && (ret >= 0))
-        gf_event_handled(ctx->event_pool, priv->sock, priv->idx, priv->gen);
+    gf_event_handled(this->ctx->event_pool, fd, idx, gen);
+    socket_shm_unref(shm);
 
-    if (pollin) {
-        rpc_transport_ref(this);
-        gf_async(&pollin->async, socket_event_poll_in_async);
+    pthread_mutex_lock(&priv->notify.lock);
+    {
+        if (!--priv->notify.in_progress)
+            pthread_cond_signal(&priv->notify.cond);
     }
+    pthread_mutex_unlock(&priv->notify.lock);
+out:
+    rpc_transport_unref(this);
+}
+
+static int
+__socket_shm_register(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+
+    priv->shm_idx = gf_event_register(this->ctx->event_pool,
+                                      priv->shm->efd[priv->shm->rx],
+                                      socket_shm_event_handler, this, 1, 0,
+                                      this->notify_poller_death);
+    if (priv->shm_idx == -1)
+        return -1;
+
+    priv->shm_state = SOCKET_SHM_UP;
+    /* there is nothing to gain in compressing what is not copied */
+    priv->inflate.enabled = _gf_false;
+    this->compress_offer = NULL;
+
+    return 0;
+}
+
+/* Client: passes the memfd and the eventfds to the brick */
+static int
+__socket_shm_send_hello(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    struct socket_shm_hello hello = {
+        .magic = SOCKET_SHM_MAGIC,
+        .version = SOCKET_SHM_VERSION,
+        .size = priv->shm->size,
+    };
+    int fds[3] = {priv->shm_memfd, priv->shm->efd[SOCKET_SHM_TO_SERVER],
+                  priv->shm->efd[SOCKET_SHM_TO_CLIENT]};
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = {
+        .iov_base = &hello,
+        .iov_len = sizeof(hello),
+    };
+    struct msghdr msg = {
+        0,
+    };
+    struct cmsghdr *cmsg = NULL;
+
+    memset(control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+
+    /* the first thing on a fresh connection, it goes in one piece */
+    if (sendmsg(priv->sock, &msg, MSG_NOSIGNAL) != sizeof(hello))
+        return -1;
 
+    sys_close(priv->shm_memfd);
+    priv->shm_memfd = -1;
+    priv->shm_state = SOCKET_SHM_HELLO;
+
+    return 0;
+}
+
+/* Client: 1 while the brick has not answered the hello yet */
+static int
+__socket_shm_recv_ack(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    uint32_t ack = 0;
+    ssize_t ret = -1;
+
+    ret = recv(priv->sock, &ack, sizeof(ack), 0);
+    if (ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 1;
+    if (ret != sizeof(ack) || ack != SOCKET_SHM_MAGIC) {
+        if (ret >= 0)
+            errno = ECONNRESET;
+        return -1;
+    }
+
+    return __socket_shm_register(this);
+}
+
+/* Server: maps what the client sent on a connection to a shm listener.
+ * Returns 1 while nothing came yet, 0 once the rings are up. */
+static int
+socket_shm_server_hello(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    struct socket_shm_hello hello = {
+        0,
+    };
+    int fds[3] = {-1, -1, -1};
+    char control[CMSG_SPACE(sizeof(fds))];
+    struct iovec iov = {
+        .iov_base = &hello,
+        .iov_len = sizeof(hello),
+    };
+    struct msghdr msg = {
+        0,
+    };
+    struct cmsghdr *cmsg = NULL;
+    socket_shm_t *shm = NULL;
+    uint32_t ack = SOCKET_SHM_MAGIC;
+    ssize_t size = -1;
+    int ret = -1;
+    int i = 0;
+
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    size = recvmsg(priv->sock, &msg, MSG_CMSG_CLOEXEC);
+    if (size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return 1;
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(fds)))
+        memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+
+    if (size != sizeof(hello) || (msg.msg_flags & MSG_CTRUNC) ||
+        fds[0] < 0 || hello.magic != SOCKET_SHM_MAGIC ||
+        hello.version != SOCKET_SHM_VERSION) {
+        gf_log(this->name, GF_LOG_WARNING,
+               "no shared memory hello from %s, disconnecting",
+               this->peerinfo.identifier);
+        goto out;
+    }
+
+    shm = socket_shm_attach(fds[0], fds[1], fds[2], hello.size);
+    if (!shm) {
+        gf_log(this->name, GF_LOG_WARNING,
+               "cannot map the shared memory of %s (%s), disconnecting",
+               this->peerinfo.identifier, strerror(errno));
+        goto out;
+    }
+    /* the eventfds belong to the mapping now */
+    fds[1] = -1;
+    fds[2] = -1;
+
+    if (send(priv->sock, &ack, sizeof(ack), MSG_NOSIGNAL) != sizeof(ack)) {
+        socket_shm_unref(shm);
+        goto out;
+    }
+
+    pthread_mutex_lock(&priv->out_lock);
+    {
+        priv->shm = shm;
+        ret = __socket_shm_register(this);
+        if (ret)
+            __socket_shm_drop(priv);
+    }
+    pthread_mutex_unlock(&priv->out_lock);
+
+    if (!ret)
+        gf_log(this->name, GF_LOG_DEBUG, "sharing memory with %s",
+               this->peerinfo.identifier);
+out:
+    for (i = 0; i < 3; i++) {
+        if (fds[i] >= 0)
+            sys_close(fds[i]);
+    }
     return ret;
 }
 
@@ -2433,7 +3216,24 @@ socket_connect_finish(rpc_transport_t *this)
 
         get_transport_identifiers(this);
 
-        ret = __socket_connect_finish(priv->sock);
+        if (priv->shm_state == SOCKET_SHM_HELLO) {
+            ret = __socket_shm_recv_ack(this);
+            if (ret < 0)
+                priv->shm_failed = _gf_true;
+        } else {
+            ret = __socket_connect_finish(priv->sock);
+            if (ret == 0 && priv->shm_state == SOCKET_SHM_CONNECTING) {
+                ret = __socket_shm_send_hello(this);
+                if (ret == 0) {
+                    /* the answer is waited for like the connection was */
+                    gf_event_select_on(this->ctx->event_pool, priv->sock,
+                                       priv->idx, 1, 0);
+                    ret = 1;
+                } else {
+                    priv->shm_failed = _gf_true;
+                }
+            }
+        }
 
         if ((ret < 0) && (errno == EINPROGRESS))
             ret = 1;
@@ -2604,8 +3404,10 @@ ssl_handle_client_connection_attempt(rpc_transport_t *this)
         }
         ret = ssl_complete_connection(this);
         if (ret == 0) {
-            ret = socket_connect_finish(this);
+            /* before the connection is notified, the first messages
+             * may already have to wait for POLLOUT */
             gf_event_select_on(ctx->event_pool, fd, idx, 1, 0);
+            ret = socket_connect_finish(this);
             gf_log(this->name, GF_LOG_TRACE, ">>> completed client connect");
         } else {
             if (errno == EAGAIN) {
@@ -2709,9 +3511,15 @@ socket_complete_connection(rpc_transport_t *this)
              * connection has already been accepted in
              * socket_server_event_handler()
              */
-            priv->accepted = _gf_true;
-            gf_event_handled(ctx->event_pool, fd, idx, gen);
-            ret = 1;
+            ret = 0;
+            if (priv->shm_state == SOCKET_SHM_ACCEPTED)
+                ret = socket_shm_server_hello(this);
+            if (ret >= 0) {
+                if (ret == 0)
+                    priv->accepted = _gf_true;
+                gf_event_handled(ctx->event_pool, fd, idx, gen);
+                ret = 1;
+            }
         } else {
             ret = socket_handle_client_connection_attempt(this);
         }
@@ -3019,8 +3827,18 @@ socket_server_event_handler(int fd, int idx, int gen, void *data, int poll_in,
         new_trans->notify_poller_death = this->poller_death_accept;
         new_priv = new_trans->private;
 
+        /* as last reconfigured, rather than as the listener started */
+        if (new_sockaddr.ss_family != AF_UNIX) {
+            new_priv->compress_conf = priv->compress_conf;
+            new_priv->compress_threshold = priv->compress_threshold;
+            __socket_compress_reset(new_trans);
+        }
+
         if (new_sockaddr.ss_family == AF_UNIX) {
             new_priv->use_ssl = _gf_false;
+            /* the hello comes first, see socket_complete_connection() */
+            if (priv->shm_listen)
+                new_priv->shm_state = SOCKET_SHM_ACCEPTED;
         } else {
             switch (priv->srvr_ssl) {
                 case MGMT_SSL_ALWAYS:
@@ -3209,6 +4027,7 @@ socket_connect(rpc_transport_t *this, int port)
     char *local_addr = NULL;
     union gf_sock_union sock_union;
     struct sockaddr_in *addr = NULL;
+    struct sockaddr_un *sun = NULL;
     gf_boolean_t refd = _gf_false;
     socket_connect_error_state_t *arg = NULL;
     pthread_t th_id = {
@@ -3243,21 +4062,39 @@ socket_connect(rpc_transport_t *this, int port)
         gf_log(this->name, GF_LOG_TRACE, "connecting %p, sock=%d", this,
                priv->sock);
 
-        ret = socket_client_get_remote_sockaddr(this, &sock_union.sa,
-                                                &sockaddr_len, &sa_family);
-        if (ret < 0) {
-            /* logged inside client_get_remote_sockaddr */
-            goto unlock;
+    again:
+        /* a brick on this host may take the connection on the side,
+         * unless that did not work out the last time */
+        if (priv->shm_path && !priv->ssl_enabled && !priv->shm_failed)
+            priv->shm = socket_shm_create(&priv->shm_memfd);
+        priv->shm_failed = _gf_false;
+
+        if (priv->shm) {
+            memset(&sock_union, 0, sizeof(sock_union));
+            sun = (struct sockaddr_un *)&sock_union.storage;
+            sun->sun_family = AF_UNIX;
+            snprintf(sun->sun_path, sizeof(sun->sun_path), "%s",
+                     priv->shm_path);
+            sockaddr_len = sizeof(*sun);
+            sa_family = AF_UNIX;
+            priv->shm_state = SOCKET_SHM_CONNECTING;
+        } else {
+            ret = socket_client_get_remote_sockaddr(this, &sock_union.sa,
+                                                    &sockaddr_len, &sa_family);
+            if (ret < 0) {
+                /* logged inside client_get_remote_sockaddr */
+                goto unlock;
+            }
         }
 
-        if (sa_family == AF_UNIX) {
-            priv->ssl_enabled = _gf_false;
-            priv->mgmt_ssl = _gf_false;
-        } else {
+        if (sa_family != AF_UNIX) {
             if (port > 0) {
                 sock_union.sin.sin_port = htons(port);
             }
             socket_fix_ssl_opts(this, priv, ntohs(sock_union.sin.sin_port));
+        } else if (!priv->shm) {
+            priv->ssl_enabled = _gf_false;
+            priv->mgmt_ssl = _gf_false;
         }
 
         memcpy(&this->peerinfo.sockaddr, &sock_union.storage, sockaddr_len);
@@ -3369,7 +4206,7 @@ socket_connect(rpc_transport_t *this, int port)
                          priv->use_ssl, priv->sock, this->name,
                          "connecting to");
 
-        if (ign_enoent) {
+        if (ign_enoent && !priv->shm) {
             ret = connect_loop(priv->sock, SA(&this->peerinfo.sockaddr),
                                this->peerinfo.sockaddr_len);
         } else {
@@ -3379,6 +4216,19 @@ socket_connect(rpc_transport_t *this, int port)
 
         connect_attempted = _gf_true;
 
+        if ((ret != 0) && priv->shm) {
+            gf_log(this->name, GF_LOG_DEBUG,
+                   "no shared memory connection on %s (%s), connecting the "
+                   "usual way",
+                   priv->shm_path, strerror(errno));
+            sys_close(priv->sock);
+            priv->sock = -1;
+            __socket_shm_drop(priv);
+            priv->shm_failed = _gf_true;
+            connect_attempted = _gf_false;
+            goto again;
+        }
+
         if ((ret != 0) && (errno == ENOENT) && ign_enoent) {
             gf_log(this->name, GF_LOG_WARNING,
                    "Ignore failed connection attempt on %s, (%s) ",
@@ -3640,14 +4490,160 @@ out:
     return ret;
 }
 
+/* A record which did not shrink enough is sent as it is; too many of
+ * them in a row and the next ones are not even tried for a while. */
+static void
+__socket_deflate_miss(rpc_transport_t *this, struct gf_sock_deflate *out)
+{
+    if (++out->misses < SOCKET_COMPRESS_MAX_MISSES)
+        return;
+
+    out->misses = 0;
+    out->backoff = out->backoff ? min(out->backoff * 2,
+                                      SOCKET_COMPRESS_MAX_BACKOFF)
+                                : SOCKET_COMPRESS_MIN_BACKOFF;
+    out->skip = out->backoff;
+    gf_log(this->name, GF_LOG_DEBUG,
+           "data to %s does not compress, sending the next %u records raw",
+           this->peerinfo.identifier, out->skip);
+}
+
+/* Replaces the vectors of @entry by the compressed record when that is
+ * worth it. Anything going wrong leaves the entry as it was. */
+static void
+socket_deflate_entry(rpc_transport_t *this, struct ioq *entry)
+{
+    socket_private_t *priv = this->private;
+    struct gf_sock_deflate *out = &priv->deflate;
+    struct iobuf *iobuf = NULL;
+    struct iobref *iobref = NULL;
+    uint32_t *hdr = NULL;
+    size_t len = 0;
+    ssize_t size = -1;
+
+    len = iov_length(entry->vector, entry->count);
+    if (len < out->threshold || len > SOCKET_COMPRESS_MAX_RECORD)
+        return;
+
+    pthread_mutex_lock(&out->lock);
+    {
+        if (out->algo == SOCKET_COMPRESS_NONE)
+            goto unlock;
+
+        if (out->skip) {
+            out->skip--;
+            GF_ATOMIC_INC(this->compress_skipped);
+            goto unlock;
+        }
+
+        if (out->scratch_size < len) {
+            GF_FREE(out->scratch);
+            out->scratch_size = 0;
+            out->scratch = GF_MALLOC(len, gf_sock_mt_compress_buf);
+            if (!out->scratch)
+                goto unlock;
+            out->scratch_size = len;
+        }
+        iov_unload(out->scratch, entry->vector, entry->count);
+
+        iobuf = iobuf_get2(this->ctx->iobuf_pool,
+                           SOCKET_COMPRESS_HDR_SIZE +
+                               socket_compress_bound(out->algo, len));
+        if (!iobuf)
+            goto unlock;
+
+        size = socket_compress(out->algo, &out->ctx, out->scratch, len,
+                               iobuf_ptr(iobuf) + SOCKET_COMPRESS_HDR_SIZE,
+                               iobuf_size(iobuf) - SOCKET_COMPRESS_HDR_SIZE);
+        if (size < 0 || size + SOCKET_COMPRESS_HDR_SIZE >= len - len / 16) {
+            __socket_deflate_miss(this, out);
+            goto unlock;
+        }
+        out->misses = 0;
+        out->backoff = 0;
+
+        iobref = iobref_new();
+        if (!iobref || iobref_add(iobref, iobuf))
+            goto unlock;
+
+        hdr = iobuf_ptr(iobuf);
+        hdr[0] = htonl(SOCKET_COMPRESS_MAGIC | out->algo);
+        hdr[1] = htonl(size);
+        hdr[2] = htonl(len);
+
+        entry->vector[0].iov_base = iobuf_ptr(iobuf);
+        entry->vector[0].iov_len = SOCKET_COMPRESS_HDR_SIZE + size;
+        entry->count = 1;
+        entry->pending_vector = entry->vector;
+        entry->pending_count = 1;
+        if (entry->iobref)
+            iobref_unref(entry->iobref);
+        entry->iobref = iobref;
+        iobref = NULL;
+
+        GF_ATOMIC_INC(this->compress_records);
+        GF_ATOMIC_ADD(this->compress_saved_write,
+                      len - size - SOCKET_COMPRESS_HDR_SIZE);
+    }
+unlock:
+    pthread_mutex_unlock(&out->lock);
+
+    if (iobref)
+        iobref_unref(iobref);
+    if (iobuf)
+        iobuf_unref(iobuf);
+}
+
+/* Writes out the submission queue unless another thread already does.
+ * Whoever lets go of outq.flushing looks at the queue again, so that a
+ * message queued by a thread that found the flag taken is not left
+ * behind. */
+static void
+socket_outq_flush(rpc_transport_t *this)
+{
+    socket_private_t *priv = this->private;
+    gf_boolean_t idle = _gf_false;
+    int ret = 0;
+
+    while (GF_ATOMIC_SWAP(priv->outq.flushing, 1) == 0) {
+        pthread_mutex_lock(&priv->out_lock);
+        {
+            /* with a write already pending, socket_event_poll_out()
+             * takes care of everything behind it */
+            idle = list_empty(&priv->ioq);
+            __socket_ioq_splice(priv);
+
+            if (idle && (priv->connected == 1)) {
+                ret = 0;
+                while (!list_empty(&priv->ioq)) {
+                    ret = __socket_ioq_churn_gather(this);
+                    if (ret != 0)
+                        break;
+                }
+                if (ret > 0) {
+                    /* first entry to wait. continue writing on POLLOUT */
+                    priv->idx = gf_event_select_on(
+                        this->ctx->event_pool, priv->sock, priv->idx, -1, 1);
+                }
+            }
+        }
+        pthread_mutex_unlock(&priv->out_lock);
+
+        GF_ATOMIC_SWAP(priv->outq.flushing, 0);
+        cmm_smp_mb();
+
+        if (cds_wfcq_empty(&priv->outq.head, &priv->outq.tail))
+            break;
+    }
+}
+
 static int32_t
 socket_submit_outgoing_msg(rpc_transport_t *this, rpc_transport_msg_t *msg)
 {
     int ret = -1;
-    gf_boolean_t need_poll_out = _gf_false;
-    gf_boolean_t free_entry = _gf_false;
     struct ioq *entry = NULL;
     socket_private_t *priv = NULL;
+    uint32_t gen = 0;
 
     GF_VALIDATE_OR_GOTO("socket", this, out);
     priv = this->private;
@@ -3657,46 +4653,39 @@ socket_submit_outgoing_msg(rpc_transport_t *this, rpc_transport_msg_t *msg)
     if (!entry)
         goto out;
 
-    pthread_mutex_lock(&priv->out_lock);
-    {
-        if (priv->connected != 1) {
-            if (!priv->submit_log && !priv->connect_finish_log) {
-                gf_log(this->name, GF_LOG_INFO,
-                       "not connected (priv->connected = %d)", priv->connected);
-                priv->submit_log = 1;
-            }
-            free_entry = _gf_true;
-            goto unlock;
+    if (priv->deflate.algo != SOCKET_COMPRESS_NONE)
+        socket_deflate_entry(this, entry);
+
+    /* A reset marks the socket disconnected before it bumps the
+     * generation, so finding the socket connected after reading the
+     * generation means the message belongs to that connection. */
+    gen = GF_ATOMIC_GET(priv->outq.gen);
+    if (priv->connected != 1) {
+        if (!priv->submit_log && !priv->connect_finish_log) {
+            gf_log(this->name, GF_LOG_INFO,
+                   "not connected (priv->connected = %d)", priv->connected);
+            priv->submit_log = 1;
         }
+        __socket_ioq_entry_free(entry);
+        goto out;
+    }
 
+    if (priv->submit_log)
         priv->submit_log = 0;
 
-        if (list_empty(&priv->ioq)) {
-            ret = __socket_ioq_churn_entry(this, entry, _gf_false);
+    entry->gen = gen;
+    cds_wfcq_node_init(&entry->node);
+    cds_wfcq_enqueue(&priv->outq.head, &priv->outq.tail, &entry->node);
 
-            if (ret == 0) { /* current entry was completely written */
-                free_entry = _gf_true;
-            } else if (ret > 0) {
-                need_poll_out = _gf_true;
-            }
-        }
+    socket_outq_flush(this);
 
-        if (!free_entry) {
-            list_add_tail(&entry->list, &priv->ioq);
-            ret = 0;
-        }
-        if (need_poll_out) {
-            /* first entry to wait. continue writing on POLLOUT */
-            priv->idx = gf_event_select_on(this->ctx->event_pool, priv->sock,
-                                           priv->idx, -1, 1);
-        }
-    }
-unlock:
-    pthread_mutex_unlock(&priv->out_lock);
+    /* Reset in the meantime, the message was dropped with the rest of
+     * the connection, or will be by the next flush. */
+    if (GF_ATOMIC_GET(priv->outq.gen) != gen)
+        goto out;
 
+    ret = 0;
 out:
-    if (free_entry)
-        __socket_ioq_entry_free(entry);
     return ret;
 }
 
@@ -3809,6 +4798,10 @@ socket_throttle(rpc_transport_t *this, gf_boolean_t onoff)
         if (priv->connected == 1)
             priv->idx = gf_event_select_on(this->ctx->event_pool, priv->sock,
                                            priv->idx, (int)!onoff, -1);
+        if (priv->shm_idx != -1)
+            priv->shm_idx = gf_event_select_on(
+                this->ctx->event_pool, priv->shm->efd[priv->shm->rx],
+                priv->shm_idx, (int)!onoff, -1);
     }
     pthread_mutex_unlock(&priv->out_lock);
     return 0;
@@ -3825,6 +4818,7 @@ struct rpc_transport_ops tops = {
     .get_myname = socket_getmyname,
     .get_myaddr = socket_getmyaddr,
     .throttle = socket_throttle,
+    .set_compression = socket_set_compression,
 };
 
 int
@@ -3905,6 +4899,8 @@ reconfigure(rpc_transport_t *this, dict_t *options)
 
     priv->windowsize = (int)windowsize;
 
+    socket_compress_configure(this, options);
+
     data = dict_get_sizen(options, "non-blocking-io");
     if (data) {
         optstr = data_to_str(data);
@@ -4191,6 +5187,16 @@ ssl_setup_connection_params(rpc_transport_t *this)
 #endif
 #ifdef SSL_OP_NO_COMPRESSION
         SSL_CTX_set_options(priv->ssl_ctx, SSL_OP_NO_COMPRESSION);
+#endif
+#ifdef SSL_OP_ENABLE_KTLS
+        /* only where the kernel has the tls module and the cipher */
+        if (dict_get_str_boolean(this->options, SSL_KTLS_OPT, _gf_true))
+            SSL_CTX_set_options(priv->ssl_ctx, SSL_OP_ENABLE_KTLS);
+#endif
+#if OPENSSL_VERSION_NUMBER >= 0x1010000f
+        /* used once reading ahead, see ssl_setup_offload() */
+        SSL_CTX_set_default_read_buffer_len(priv->ssl_ctx,
+                                            GF_SOCKET_SSL_READ_BUF);
 #endif
         /* Upload file to bio wrapper only if dh param is configured
          */
@@ -4337,6 +5343,8 @@ socket_init(rpc_transport_t *this)
 
     this->private = priv;
     pthread_mutex_init(&priv->out_lock, NULL);
+    pthread_mutex_init(&priv->deflate.lock, NULL);
+    priv->compress_threshold = SOCKET_COMPRESS_THRESHOLD;
 
     /*GF_REF_INIT (priv, socket_poller_mayday);*/
 
@@ -4349,8 +5357,13 @@ socket_init(rpc_transport_t *this)
     priv->ssl_connected = _gf_false;
     priv->windowsize = GF_DEFAULT_SOCKET_WINDOW_SIZE;
     INIT_LIST_HEAD(&priv->ioq);
+    __cds_wfcq_init(&priv->outq.head, &priv->outq.tail);
+    GF_ATOMIC_INIT(priv->outq.flushing, 0);
+    GF_ATOMIC_INIT(priv->outq.gen, 0);
     pthread_mutex_init(&priv->notify.lock, NULL);
     pthread_cond_init(&priv->notify.cond, NULL);
+    priv->shm_idx = -1;
+    priv->shm_memfd = -1;
 
     /* All the below section needs 'this->options' to be present */
     if (!this->options)
@@ -4483,8 +5496,19 @@ socket_init(rpc_transport_t *this)
     priv->srvr_ssl = this->ctx->secure_srvr;
 
     ssl_setup_connection_params(this);
+
+    socket_compress_configure(this, this->options);
+
+    priv->shm_listen = dict_get_str_boolean(this->options,
+                                            "transport.socket.shm", _gf_false);
+    if (dict_get_str_sizen(this->options, "transport.socket.shm-path",
+                           &optstr) == 0) {
+        /* without it, the brick is just reached the usual way */
+        priv->shm_path = gf_strdup(optstr);
+    }
 out:
     this->private = priv;
+    __socket_compress_reset(this);
     return 0;
 }
 
@@ -4510,6 +5534,16 @@ fini(rpc_transport_t *this)
 
         pthread_mutex_destroy(&priv->out_lock);
 
+        pthread_mutex_destroy(&priv->deflate.lock);
+        socket_compress_ctx_free(priv->deflate.ctx);
+        GF_FREE(priv->deflate.scratch);
+        socket_decompress_ctx_free(priv->inflate.ctx);
+        GF_FREE(priv->inflate.wire);
+        GF_FREE(priv->inflate.out);
+
+        __socket_shm_drop(priv);
+        GF_FREE(priv->shm_path);
+
         GF_ASSERT(priv->notify.in_progress == 0);
         pthread_mutex_destroy(&priv->notify.lock);
         pthread_cond_destroy(&priv->notify.cond);
@@ -4533,6 +5567,7 @@ fini(rpc_transport_t *this)
         if (priv->ssl_ca_list) {
             GF_FREE(priv->ssl_ca_list);
         }
+        GF_FREE(priv->ssl_wbuf);
         GF_FREE(priv);
     }
 
@@ -4615,6 +5650,35 @@ struct volume_options options[] = {
      .op_version = {GD_OP_VERSION_3_10_2},
      .default_value = "9"},
     {.key = {"transport.socket.read-fail-log"}, .type = GF_OPTION_TYPE_BOOL},
+    {.key = {"transport.socket.compression"},
+     .type = GF_OPTION_TYPE_STR,
+     .value = {"off", "zlib", "lz4", "zstd"},
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .description = "Compress the RPC records sent over the connection "
+                    "with this algorithm when the other end agrees. On a "
+                    "server, anything but off lets clients use the "
+                    "algorithm they ask for. lz4 and zstd are only there "
+                    "when built in."},
+    {.key = {"transport.socket.compression-threshold"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = SOCKET_COMPRESS_MAX_RECORD,
+     .default_value = TOSTRING(SOCKET_COMPRESS_THRESHOLD),
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .description = "Records smaller than this are not compressed."},
+    {.key = {"transport.socket.shm"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "Clients connecting to this unix socket listener pass "
+                    "it shared memory to exchange messages through."},
+    {.key = {"transport.socket.shm-path"},
+     .type = GF_OPTION_TYPE_PATH,
+     .description = "Where the brick takes shared memory connections from "
+                    "clients on its host. A client that cannot get one "
+                    "connects the usual way."},
     {.key = {SSL_ENABLED_OPT}, .type = GF_OPTION_TYPE_BOOL},
     {.key = {SSL_OWN_CERT_OPT}, .type = GF_OPTION_TYPE_STR},
     {.key = {SSL_PRIVATE_KEY_OPT}, .type = GF_OPTION_TYPE_STR},
@@ -4624,6 +5688,7 @@ struct volume_options options[] = {
     {.key = {SSL_DH_PARAM_OPT}, .type = GF_OPTION_TYPE_STR},
     {.key = {SSL_EC_CURVE_OPT}, .type = GF_OPTION_TYPE_STR},
     {.key = {SSL_CRL_PATH_OPT}, .type = GF_OPTION_TYPE_STR},
+    {.key = {SSL_KTLS_OPT}, .type = GF_OPTION_TYPE_BOOL},
     {.key = {OWN_THREAD_OPT}, .type = GF_OPTION_TYPE_BOOL},
     {.key = {"ssl-own-cert"},
      .op_version = {GD_OP_VERSION_3_7_4},
@@ -4670,4 +5735,12 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE,
      .description = "Path to directory containing CRL. "
                     "Ignored if SSL is not enabled."},
+    {.key = {"ssl-ktls"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "on",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .description = "Let the kernel encrypt and decrypt the records once "
+                    "the handshake is done, where it can. Ignored if SSL "
+                    "is not enabled."},
     {.key = {NULL}}};
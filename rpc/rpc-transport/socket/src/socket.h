@@ -23,6 +23,8 @@
 #endif
 
 #include "rpc-transport.h"
+#include "socket-compress.h"
+#include "socket-shm.h"
 
 #define GF_DEFAULT_SOCKET_LISTEN_PORT GF_DEFAULT_BASE_PORT
 
@@ -99,13 +101,15 @@ struct ioq {
         };
     };
 
+    struct cds_wfcq_node node; /* while on the submission queue */
     struct iovec vector[MAX_IOVEC];
     struct iovec *pending_vector;
     int count;
     int pending_count;
+    int payload_count; /* the last vectors, what goes in a shm slot */
     struct iobref *iobref;
     uint32_t fraghdr;
-    char _pad[4];
+    uint32_t gen; /* outq.gen at the time of the submission */
 };
 
 typedef struct {
@@ -143,6 +147,14 @@ typedef struct {
     sp_rpcfrag_vectored_reply_accepted_success_state_t accepted_success_state;
 } sp_rpcfrag_vectored_reply_state_t;
 
+typedef enum {
+    SOCKET_SHM_NONE,
+    SOCKET_SHM_CONNECTING, /* client: the hello goes out once connected */
+    SOCKET_SHM_HELLO,      /* client: waiting for the brick to attach */
+    SOCKET_SHM_ACCEPTED,   /* server: waiting for the hello */
+    SOCKET_SHM_UP,
+} socket_shm_state_t;
+
 struct gf_sock_incoming_frag {
     char *fragcurrent;
     uint32_t bytes_read;
@@ -160,6 +172,10 @@ struct gf_sock_incoming_frag {
 
 #define GF_SOCKET_RA_MAX 1024
 
+/* what OpenSSL reads off the socket at once when reading ahead, i.e. when
+ * it decrypts the records itself */
+#define GF_SOCKET_SSL_READ_BUF (256 * GF_UNIT_KB)
+
 struct gf_sock_incoming {
     char *proghdr_base_addr;
     struct iobuf *iobuf;
@@ -193,6 +209,15 @@ typedef struct {
         };
     };
     pthread_mutex_t out_lock;
+    /* Submitters queue their messages here without taking out_lock. The
+     * one that finds nobody flushing moves the queue to ioq and writes
+     * as many messages as fit in one writev(). */
+    struct {
+        struct __cds_wfcq_head head;
+        struct cds_wfcq_tail tail;
+        gf_atomic_int32_t flushing;
+        gf_atomic_uint32_t gen; /* bumped on every reset */
+    } outq;
     int windowsize;
     int keepalive;
     int keepaliveidle;
@@ -228,7 +253,18 @@ typedef struct {
     char *ssl_private_key;
     char *ssl_ca_list;
     char *crl_path;
+    char *ssl_wbuf; /* small vectors gathered into one record */
     struct gf_sock_incoming incoming;
+    struct gf_sock_inflate inflate;
+    struct gf_sock_deflate deflate;
+    socket_compress_t compress_conf; /* configured, used from the next
+                                      * connection on */
+    uint32_t compress_threshold;
+    socket_shm_t *shm;
+    char *shm_path; /* where the brick takes shm connections, if it does */
+    int32_t shm_idx;
+    int shm_memfd; /* until it is sent */
+    socket_shm_state_t shm_state;
     mgmt_ssl_t srvr_ssl;
     /* -1 = not connected. 0 = in progress. 1 = connected */
     char connected;
@@ -264,6 +300,10 @@ typedef struct {
                             * socket_event_handler() for
                             * newly accepted socket
                             */
+    gf_boolean_t shm_listen; /* connections to this listener set up shm */
+    gf_boolean_t shm_failed; /* the next attempt goes to the usual place */
+    gf_boolean_t ssl_ktls_tx; /* the kernel encrypts what is written */
+    gf_boolean_t ssl_ktls_rx; /* and decrypts what is read */
     char _pad[4];
 } socket_private_t;
 
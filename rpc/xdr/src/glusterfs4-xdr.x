@@ -718,6 +718,33 @@ struct gfx_seek_rsp {
         gfx_dict xdata; /* Extra data */
 };
 
+/* One request of a BATCH call: the encoded arguments of procedure
+   'procnum' of this program, as they would have been sent on their own */
+struct gfx_batch_op {
+        unsigned int procnum;
+        opaque       args<>;
+};
+
+struct gfx_batch_req {
+        gfx_batch_op ops<>;
+        gfx_dict     xdata; /* Extra data */
+};
+
+/* The reply to one request of a BATCH call, in the order of the requests:
+   'status' is the accept_stat it would have been answered with, 'rsp' the
+   encoded reply of the procedure when that is SUCCESS */
+struct gfx_batch_reply {
+        int    status;
+        opaque rsp<>;
+};
+
+struct gfx_batch_rsp {
+        int             op_ret;
+        int             op_errno;
+        gfx_batch_reply replies<>;
+        gfx_dict        xdata; /* Extra data */
+};
+
  struct  gfx_setvolume_rsp {
         int    op_ret;
         int    op_errno;
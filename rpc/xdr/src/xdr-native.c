@@ -0,0 +1,960 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#include <arpa/inet.h>
+#include <limits.h>
+
+#include <glusterfs/mem-types.h>
+#include "xdr-native.h"
+#include "glusterfs3.h"
+
+#define XDR_NATIVE_PAD(len) (((len) + 3) & ~3U)
+
+/* gfid, 12 hypers and 9 unsigned ints, see gfx_iattx */
+#define XDR_NATIVE_IATTX_SIZE (16 + 12 * 8 + 9 * 4)
+/* xdr_size, count and the number of pairs */
+#define XDR_NATIVE_DICT_HDR_SIZE 12
+
+static inline uint32_t *
+xdr_native_put_u32(uint32_t *buf, uint32_t val)
+{
+    *buf = htonl(val);
+    return buf + 1;
+}
+
+static inline uint32_t *
+xdr_native_put_u64(uint32_t *buf, uint64_t val)
+{
+    buf[0] = htonl((uint32_t)(val >> 32));
+    buf[1] = htonl((uint32_t)val);
+    return buf + 2;
+}
+
+static inline uint32_t *
+xdr_native_get_u32(uint32_t *buf, uint32_t *val)
+{
+    *val = ntohl(*buf);
+    return buf + 1;
+}
+
+static inline uint32_t *
+xdr_native_get_u64(uint32_t *buf, uint64_t *val)
+{
+    *val = ((uint64_t)ntohl(buf[0]) << 32) | ntohl(buf[1]);
+    return buf + 2;
+}
+
+/* same as gfx_stat_from_iattx() followed by xdr_gfx_iattx() */
+static void
+xdr_native_put_iattx(uint32_t *buf, struct iatt *ia)
+{
+    memcpy(buf, ia->ia_gfid, 16);
+    buf += 4;
+
+    buf = xdr_native_put_u64(buf, ia->ia_flags);
+    buf = xdr_native_put_u64(buf, ia->ia_ino);
+    buf = xdr_native_put_u64(buf, ia->ia_dev);
+    buf = xdr_native_put_u64(buf, ia->ia_rdev);
+    buf = xdr_native_put_u64(buf, ia->ia_size);
+    buf = xdr_native_put_u64(buf, ia->ia_blocks);
+    buf = xdr_native_put_u64(buf, ia->ia_attributes);
+    buf = xdr_native_put_u64(buf, ia->ia_attributes_mask);
+    buf = xdr_native_put_u64(buf, ia->ia_atime);
+    buf = xdr_native_put_u64(buf, ia->ia_mtime);
+    buf = xdr_native_put_u64(buf, ia->ia_ctime);
+    buf = xdr_native_put_u64(buf, ia->ia_btime);
+
+    buf = xdr_native_put_u32(buf, ia->ia_atime_nsec);
+    buf = xdr_native_put_u32(buf, ia->ia_mtime_nsec);
+    buf = xdr_native_put_u32(buf, ia->ia_ctime_nsec);
+    buf = xdr_native_put_u32(buf, ia->ia_btime_nsec);
+    buf = xdr_native_put_u32(buf, ia->ia_nlink);
+    buf = xdr_native_put_u32(buf, ia->ia_uid);
+    buf = xdr_native_put_u32(buf, ia->ia_gid);
+    buf = xdr_native_put_u32(buf, ia->ia_blksize);
+    xdr_native_put_u32(buf, st_mode_from_ia(ia->ia_prot, ia->ia_type));
+}
+
+/* same as xdr_gfx_iattx() followed by gfx_stat_to_iattx() */
+static void
+xdr_native_get_iattx(uint32_t *buf, struct iatt *ia)
+{
+    uint64_t val64 = 0;
+    uint32_t val = 0;
+
+    memcpy(ia->ia_gfid, buf, 16);
+    buf += 4;
+
+    buf = xdr_native_get_u64(buf, &ia->ia_flags);
+    buf = xdr_native_get_u64(buf, &ia->ia_ino);
+    buf = xdr_native_get_u64(buf, &ia->ia_dev);
+    buf = xdr_native_get_u64(buf, &ia->ia_rdev);
+    buf = xdr_native_get_u64(buf, &ia->ia_size);
+    buf = xdr_native_get_u64(buf, &ia->ia_blocks);
+    buf = xdr_native_get_u64(buf, &ia->ia_attributes);
+    buf = xdr_native_get_u64(buf, &ia->ia_attributes_mask);
+    buf = xdr_native_get_u64(buf, &val64);
+    ia->ia_atime = val64;
+    buf = xdr_native_get_u64(buf, &val64);
+    ia->ia_mtime = val64;
+    buf = xdr_native_get_u64(buf, &val64);
+    ia->ia_ctime = val64;
+    buf = xdr_native_get_u64(buf, &val64);
+    ia->ia_btime = val64;
+
+    buf = xdr_native_get_u32(buf, &ia->ia_atime_nsec);
+    buf = xdr_native_get_u32(buf, &ia->ia_mtime_nsec);
+    buf = xdr_native_get_u32(buf, &ia->ia_ctime_nsec);
+    buf = xdr_native_get_u32(buf, &ia->ia_btime_nsec);
+    buf = xdr_native_get_u32(buf, &ia->ia_nlink);
+    buf = xdr_native_get_u32(buf, &ia->ia_uid);
+    buf = xdr_native_get_u32(buf, &ia->ia_gid);
+    buf = xdr_native_get_u32(buf, &ia->ia_blksize);
+    xdr_native_get_u32(buf, &val);
+    ia->ia_type = ia_type_from_st_mode(val);
+    ia->ia_prot = ia_prot_from_st_mode(val);
+}
+
+static bool_t
+xdr_native_iattx(XDR *xdrs, struct iatt *ia)
+{
+    gfx_iattx stat = {
+        {0},
+    };
+    uint32_t *buf = NULL;
+
+    if (xdrs->x_op == XDR_FREE)
+        return TRUE;
+
+    buf = (uint32_t *)XDR_INLINE(xdrs, XDR_NATIVE_IATTX_SIZE);
+    if (buf) {
+        if (xdrs->x_op == XDR_DECODE) {
+            if (ia)
+                xdr_native_get_iattx(buf, ia);
+        } else if (ia) {
+            xdr_native_put_iattx(buf, ia);
+        } else {
+            memset(buf, 0, XDR_NATIVE_IATTX_SIZE);
+        }
+        return TRUE;
+    }
+
+    /* not a memory stream: leave it to rpcgen */
+    if (xdrs->x_op == XDR_ENCODE)
+        gfx_stat_from_iattx(&stat, ia);
+    if (!xdr_gfx_iattx(xdrs, &stat))
+        return FALSE;
+    if (xdrs->x_op == XDR_DECODE)
+        gfx_stat_to_iattx(&stat, ia);
+
+    return TRUE;
+}
+
+/* Decodes a string<> and terminates it where it lies: its length has been
+ * read already, so it is moved one byte back over the last byte of that,
+ * which leaves room for the NUL. */
+static bool_t
+xdr_native_string(XDR *xdrs, char **sp)
+{
+    u_int len = 0;
+    char *str = NULL;
+
+    if (xdrs->x_op == XDR_FREE)
+        return TRUE;
+
+    if (xdrs->x_op == XDR_ENCODE) {
+        str = *sp ? *sp : "";
+        len = strlen(str);
+        return xdr_u_int(xdrs, &len) && xdr_opaque(xdrs, str, len);
+    }
+
+    if (!xdr_u_int(xdrs, &len) || len > INT_MAX - 3)
+        return FALSE;
+    str = (char *)XDR_INLINE(xdrs, XDR_NATIVE_PAD(len));
+    if (!str)
+        return FALSE;
+
+    str--;
+    memmove(str, str + 1, len);
+    str[len] = '\0';
+    *sp = str;
+
+    return TRUE;
+}
+
+/* an opaque<>, left in the buffer once decoded */
+static bool_t
+xdr_native_bytes(XDR *xdrs, char **bp, u_int *lenp)
+{
+    if (xdrs->x_op == XDR_FREE)
+        return TRUE;
+
+    if (xdrs->x_op == XDR_ENCODE)
+        return xdr_u_int(xdrs, lenp) && xdr_opaque(xdrs, *bp, *lenp);
+
+    if (!xdr_u_int(xdrs, lenp) || *lenp > INT_MAX - 3)
+        return FALSE;
+    *bp = (char *)XDR_INLINE(xdrs, XDR_NATIVE_PAD(*lenp));
+
+    return (*bp != NULL);
+}
+
+static size_t
+xdr_native_string_size(const char *str)
+{
+    return 4 + XDR_NATIVE_PAD(str ? strlen(str) : 0);
+}
+
+/* what the gfx_value of @data takes on the wire, 0 if it is not sent */
+static size_t
+xdr_native_value_size(data_t *data)
+{
+    switch (data->data_type) {
+        case GF_DATA_TYPE_INT:
+        case GF_DATA_TYPE_UINT:
+        case GF_DATA_TYPE_DOUBLE:
+            return 4 + 8;
+        case GF_DATA_TYPE_STR:
+        case GF_DATA_TYPE_PTR:
+        case GF_DATA_TYPE_STR_OLD:
+            return 4 + 4 + XDR_NATIVE_PAD(data->len);
+        case GF_DATA_TYPE_IATT:
+            return 4 + XDR_NATIVE_IATTX_SIZE;
+        case GF_DATA_TYPE_GFUUID:
+            return 4 + 16;
+        case GF_DATA_TYPE_MDATA:
+            return 4 + 3 * 8 + 3 * 4;
+        default:
+            return 0;
+    }
+}
+
+/* the size of the pairs of the locked @dict, which is what goes in the
+ * xdr_size of a gfx_dict, and how many of them are sent */
+static size_t
+__xdr_native_pairs_size(dict_t *dict, int *count)
+{
+    data_pair_t *pair = NULL;
+    size_t size = 0;
+    size_t value_size = 0;
+    int n = 0;
+
+    for (pair = dict->members_list; pair; pair = pair->next) {
+        value_size = xdr_native_value_size(pair->value);
+        if (!value_size)
+            continue;
+        size += 4 + XDR_NATIVE_PAD(strlen(pair->key) + 1) + value_size;
+        n++;
+    }
+
+    *count = n;
+    return size;
+}
+
+static size_t
+xdr_native_dict_size(dict_t *dict)
+{
+    size_t size = XDR_NATIVE_DICT_HDR_SIZE;
+    int count = 0;
+
+    if (!dict)
+        return size;
+
+    LOCK(&dict->lock);
+    size += __xdr_native_pairs_size(dict, &count);
+    UNLOCK(&dict->lock);
+
+    return size;
+}
+
+/* same as dict_to_xdr() followed by xdr_gfx_value() */
+static bool_t
+xdr_native_encode_value(XDR *xdrs, data_t *data)
+{
+    int type = data->data_type;
+    quad_t val_int = 0;
+    u_quad_t val_uint = 0;
+    double val_dbl = 0;
+    u_int len = 0;
+    gfx_mdata_iatt mdata = {
+        0,
+    };
+
+    if (!xdr_int(xdrs, &type))
+        return FALSE;
+
+    switch (type) {
+        case GF_DATA_TYPE_INT:
+            val_int = strtoll(data->data, NULL, 0);
+            return xdr_quad_t(xdrs, &val_int);
+        case GF_DATA_TYPE_UINT:
+            val_uint = strtoull(data->data, NULL, 0);
+            return xdr_u_quad_t(xdrs, &val_uint);
+        case GF_DATA_TYPE_DOUBLE:
+            val_dbl = strtod(data->data, NULL);
+            return xdr_double(xdrs, &val_dbl);
+        case GF_DATA_TYPE_STR:
+        case GF_DATA_TYPE_PTR:
+        case GF_DATA_TYPE_STR_OLD:
+            len = data->len;
+            return xdr_u_int(xdrs, &len) && xdr_opaque(xdrs, data->data, len);
+        case GF_DATA_TYPE_IATT:
+            return xdr_native_iattx(xdrs, (struct iatt *)data->data);
+        case GF_DATA_TYPE_GFUUID:
+            return xdr_opaque(xdrs, data->data, 16);
+        case GF_DATA_TYPE_MDATA:
+            gfx_mdata_iatt_from_mdata_iatt(&mdata,
+                                           (struct mdata_iatt *)data->data);
+            return xdr_gfx_mdata_iatt(xdrs, &mdata);
+        default:
+            return FALSE;
+    }
+}
+
+static bool_t
+xdr_native_encode_dict(XDR *xdrs, dict_t *dict)
+{
+    data_pair_t *pair = NULL;
+    u_int xdr_size = 0;
+    u_int pairs = 0;
+    u_int keylen = 0;
+    int count = -1;
+    bool_t ret = FALSE;
+
+    if (!dict)
+        return xdr_u_int(xdrs, &xdr_size) && xdr_int(xdrs, &count) &&
+               xdr_u_int(xdrs, &pairs);
+
+    LOCK(&dict->lock);
+
+    xdr_size = __xdr_native_pairs_size(dict, &count);
+    pairs = count;
+    if (!xdr_u_int(xdrs, &xdr_size) || !xdr_int(xdrs, &count) ||
+        !xdr_u_int(xdrs, &pairs))
+        goto unlock;
+
+    for (pair = dict->members_list; pair; pair = pair->next) {
+        if (!xdr_native_value_size(pair->value)) {
+            gf_msg("dict", GF_LOG_WARNING, EINVAL, LG_MSG_DICT_SERIAL_FAILED,
+                   "key '%s' is not sent on wire", pair->key);
+            continue;
+        }
+
+        keylen = strlen(pair->key) + 1;
+        if (!xdr_u_int(xdrs, &keylen) ||
+            !xdr_opaque(xdrs, pair->key, keylen) ||
+            !xdr_native_encode_value(xdrs, pair->value))
+            goto unlock;
+    }
+
+    ret = TRUE;
+unlock:
+    UNLOCK(&dict->lock);
+
+    return ret;
+}
+
+/* same as xdr_gfx_dict_pair() followed by what xdr_to_dict() does with
+ * it; @dict is NULL for the pairs of a NULL dictionary */
+static bool_t
+xdr_native_decode_pair(XDR *xdrs, dict_t *dict)
+{
+    char *key = NULL;
+    char *bytes = NULL;
+    char *value = NULL;
+    u_int len = 0;
+    int type = 0;
+    int ret = 0;
+    quad_t val_int = 0;
+    u_quad_t val_uint = 0;
+    double val_dbl = 0;
+    struct iatt *iatt = NULL;
+    gfx_mdata_iatt mdata = {
+        0,
+    };
+    struct mdata_iatt *mdata_iatt = NULL;
+
+    if (!xdr_native_string(xdrs, &key) || !xdr_int(xdrs, &type))
+        return FALSE;
+
+    switch (type) {
+        case GF_DATA_TYPE_INT:
+            if (!xdr_quad_t(xdrs, &val_int))
+                return FALSE;
+            if (dict)
+                ret = dict_set_int64(dict, key, val_int);
+            break;
+        case GF_DATA_TYPE_UINT:
+            if (!xdr_u_quad_t(xdrs, &val_uint))
+                return FALSE;
+            if (dict)
+                ret = dict_set_uint64(dict, key, val_uint);
+            break;
+        case GF_DATA_TYPE_DOUBLE:
+            if (!xdr_double(xdrs, &val_dbl))
+                return FALSE;
+            if (dict)
+                ret = dict_set_double(dict, key, val_dbl);
+            break;
+        case GF_DATA_TYPE_STR:
+        case GF_DATA_TYPE_PTR:
+        case GF_DATA_TYPE_STR_OLD:
+            if (!xdr_native_bytes(xdrs, &bytes, &len))
+                return FALSE;
+            if (!dict)
+                break;
+            value = GF_MALLOC(len + 1, gf_common_mt_char);
+            if (!value)
+                return FALSE;
+            memcpy(value, bytes, len);
+            value[len] = '\0';
+            if (type == GF_DATA_TYPE_STR)
+                ret = dict_set_dynstr(dict, key, value);
+            else
+                ret = dict_set_dynptr(dict, key, value, len);
+            break;
+        case GF_DATA_TYPE_IATT:
+            if (dict) {
+                iatt = GF_CALLOC(1, sizeof(*iatt), gf_common_mt_char);
+                if (!iatt)
+                    return FALSE;
+            }
+            if (!xdr_native_iattx(xdrs, iatt)) {
+                GF_FREE(iatt);
+                return FALSE;
+            }
+            if (dict)
+                ret = dict_set_iatt(dict, key, iatt, false);
+            break;
+        case GF_DATA_TYPE_GFUUID:
+            bytes = (char *)XDR_INLINE(xdrs, 16);
+            if (!bytes)
+                return FALSE;
+            if (!dict)
+                break;
+            value = GF_MALLOC(sizeof(uuid_t), gf_common_mt_uuid_t);
+            if (!value)
+                return FALSE;
+            memcpy(value, bytes, sizeof(uuid_t));
+            ret = dict_set_gfuuid(dict, key, (unsigned char *)value, false);
+            break;
+        case GF_DATA_TYPE_MDATA:
+            if (!xdr_gfx_mdata_iatt(xdrs, &mdata))
+                return FALSE;
+            if (!dict)
+                break;
+            mdata_iatt = GF_CALLOC(1, sizeof(*mdata_iatt), gf_common_mt_char);
+            if (!mdata_iatt)
+                return FALSE;
+            gfx_mdata_iatt_to_mdata_iatt(&mdata, mdata_iatt);
+            if (dict_set_mdata(dict, key, mdata_iatt, false)) {
+                GF_FREE(mdata_iatt);
+                return FALSE;
+            }
+            break;
+        default:
+            return FALSE;
+    }
+
+    if (ret)
+        gf_msg_debug(THIS->name, ENOMEM, "failed to set the key (%s) into dict",
+                     key);
+
+    return TRUE;
+}
+
+static bool_t
+xdr_native_decode_dict(XDR *xdrs, dict_t **dictp)
+{
+    dict_t *dict = NULL;
+    u_int xdr_size = 0;
+    u_int pairs = 0;
+    u_int i = 0;
+    int count = 0;
+
+    if (!xdr_u_int(xdrs, &xdr_size) || !xdr_int(xdrs, &count) ||
+        !xdr_u_int(xdrs, &pairs))
+        return FALSE;
+
+    /* a negative count stands for a NULL dict */
+    if (count >= 0) {
+        dict = dict_new();
+        if (!dict)
+            return FALSE;
+    }
+
+    for (i = 0; i < pairs; i++) {
+        if (!xdr_native_decode_pair(xdrs, dict)) {
+            if (dict)
+                dict_unref(dict);
+            return FALSE;
+        }
+    }
+
+    *dictp = dict;
+
+    return TRUE;
+}
+
+static bool_t
+xdr_native_dict(XDR *xdrs, dict_t **dictp)
+{
+    switch (xdrs->x_op) {
+        case XDR_ENCODE:
+            return xdr_native_encode_dict(xdrs, *dictp);
+        case XDR_DECODE:
+            return xdr_native_decode_dict(xdrs, dictp);
+        default:
+            if (*dictp) {
+                dict_unref(*dictp);
+                *dictp = NULL;
+            }
+            return TRUE;
+    }
+}
+
+static void
+xdr_native_dict_release(XDR *xdrs, dict_t **dictp)
+{
+    if (xdrs->x_op == XDR_DECODE && *dictp) {
+        dict_unref(*dictp);
+        *dictp = NULL;
+    }
+}
+
+bool_t
+xdr_gfx_native_lookup_req(XDR *xdrs, gfx_native_lookup_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) ||
+        !xdr_opaque(xdrs, objp->pargfid, 16) ||
+        !xdr_u_int(xdrs, &objp->flags) ||
+        !xdr_native_string(xdrs, &objp->bname) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_stat_req(XDR *xdrs, gfx_native_stat_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_rw_req(XDR *xdrs, gfx_native_rw_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) || !xdr_quad_t(xdrs, &objp->fd) ||
+        !xdr_u_quad_t(xdrs, &objp->offset) ||
+        !xdr_u_int(xdrs, &objp->size) || !xdr_u_int(xdrs, &objp->flag) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_readdirp_req(XDR *xdrs, gfx_native_readdirp_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) || !xdr_quad_t(xdrs, &objp->fd) ||
+        !xdr_u_quad_t(xdrs, &objp->offset) ||
+        !xdr_u_int(xdrs, &objp->size) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_getxattr_req(XDR *xdrs, gfx_native_getxattr_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) ||
+        !xdr_u_int(xdrs, &objp->namelen) ||
+        !xdr_native_string(xdrs, &objp->name) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+static bool_t
+xdr_native_flock(XDR *xdrs, gf_proto_flock *objp)
+{
+    if (!xdr_u_int(xdrs, &objp->type) || !xdr_u_int(xdrs, &objp->whence) ||
+        !xdr_u_quad_t(xdrs, &objp->start) ||
+        !xdr_u_quad_t(xdrs, &objp->len) || !xdr_u_int(xdrs, &objp->pid) ||
+        !xdr_native_bytes(xdrs, &objp->lk_owner.lk_owner_val,
+                          &objp->lk_owner.lk_owner_len))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_inodelk_req(XDR *xdrs, gfx_native_inodelk_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) || !xdr_u_int(xdrs, &objp->cmd) ||
+        !xdr_u_int(xdrs, &objp->type) ||
+        !xdr_native_flock(xdrs, &objp->flock) ||
+        !xdr_native_string(xdrs, &objp->volume) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_xattrop_req(XDR *xdrs, gfx_native_xattrop_req *objp)
+{
+    if (!xdr_opaque(xdrs, objp->gfid, 16) ||
+        !xdr_u_int(xdrs, &objp->flags) ||
+        !xdr_native_dict(xdrs, &objp->dict))
+        return FALSE;
+
+    if (!xdr_native_dict(xdrs, &objp->xdata)) {
+        xdr_native_dict_release(xdrs, &objp->dict);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_common_rsp(XDR *xdrs, gfx_native_common_rsp *objp)
+{
+    if (!xdr_int(xdrs, &objp->op_ret) || !xdr_int(xdrs, &objp->op_errno) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_iatt_rsp(XDR *xdrs, gfx_native_iatt_rsp *objp)
+{
+    if (!xdr_int(xdrs, &objp->op_ret) || !xdr_int(xdrs, &objp->op_errno) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    if (!xdr_native_iattx(xdrs, objp->stat)) {
+        xdr_native_dict_release(xdrs, &objp->xdata);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_2iatt_rsp(XDR *xdrs, gfx_native_2iatt_rsp *objp)
+{
+    if (!xdr_int(xdrs, &objp->op_ret) || !xdr_int(xdrs, &objp->op_errno) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    if (!xdr_native_iattx(xdrs, objp->prestat) ||
+        !xdr_native_iattx(xdrs, objp->poststat)) {
+        xdr_native_dict_release(xdrs, &objp->xdata);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_dict_rsp(XDR *xdrs, gfx_native_dict_rsp *objp)
+{
+    if (!xdr_int(xdrs, &objp->op_ret) || !xdr_int(xdrs, &objp->op_errno) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    if (!xdr_native_dict(xdrs, &objp->dict)) {
+        xdr_native_dict_release(xdrs, &objp->xdata);
+        return FALSE;
+    }
+
+    if (!xdr_native_iattx(xdrs, objp->prestat) ||
+        !xdr_native_iattx(xdrs, objp->poststat)) {
+        xdr_native_dict_release(xdrs, &objp->xdata);
+        xdr_native_dict_release(xdrs, &objp->dict);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+bool_t
+xdr_gfx_native_read_rsp(XDR *xdrs, gfx_native_read_rsp *objp)
+{
+    if (!xdr_int(xdrs, &objp->op_ret) || !xdr_int(xdrs, &objp->op_errno) ||
+        !xdr_native_iattx(xdrs, objp->stat) ||
+        !xdr_u_int(xdrs, &objp->size) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    return TRUE;
+}
+
+/* the gfx_dirplist chain: each entry is preceded by TRUE, and the last
+ * one followed by FALSE */
+static bool_t
+xdr_native_encode_dirents(XDR *xdrs, gf_dirent_t *entries)
+{
+    gf_dirent_t *entry = NULL;
+    bool_t more = TRUE;
+    u_quad_t d_ino = 0;
+    u_quad_t d_off = 0;
+    u_int d_len = 0;
+    u_int d_type = 0;
+    char *name = NULL;
+
+    if (entries) {
+        list_for_each_entry(entry, &entries->list, list)
+        {
+            d_ino = entry->d_ino;
+            d_off = entry->d_off;
+            d_len = entry->d_len;
+            d_type = entry->d_type;
+            name = entry->d_name;
+
+            if (!xdr_bool(xdrs, &more) || !xdr_u_quad_t(xdrs, &d_ino) ||
+                !xdr_u_quad_t(xdrs, &d_off) || !xdr_u_int(xdrs, &d_len) ||
+                !xdr_u_int(xdrs, &d_type) || !xdr_native_string(xdrs, &name) ||
+                !xdr_native_iattx(xdrs, &entry->d_stat) ||
+                !xdr_native_encode_dict(xdrs, entry->dict))
+                return FALSE;
+        }
+    }
+
+    more = FALSE;
+    return xdr_bool(xdrs, &more);
+}
+
+static bool_t
+xdr_native_decode_dirents(XDR *xdrs, gf_dirent_t *entries)
+{
+    gf_dirent_t *entry = NULL;
+    bool_t more = FALSE;
+    u_quad_t d_ino = 0;
+    u_quad_t d_off = 0;
+    u_int d_len = 0;
+    u_int d_type = 0;
+    char *name = NULL;
+
+    for (;;) {
+        if (!xdr_bool(xdrs, &more))
+            return FALSE;
+        if (!more)
+            return TRUE;
+
+        if (!entries || !xdr_u_quad_t(xdrs, &d_ino) ||
+            !xdr_u_quad_t(xdrs, &d_off) || !xdr_u_int(xdrs, &d_len) ||
+            !xdr_u_int(xdrs, &d_type) || !xdr_native_string(xdrs, &name))
+            return FALSE;
+
+        entry = gf_dirent_for_name(name);
+        if (!entry)
+            return FALSE;
+
+        entry->d_ino = d_ino;
+        entry->d_off = d_off;
+        entry->d_len = d_len;
+        entry->d_type = d_type;
+
+        if (!xdr_native_iattx(xdrs, &entry->d_stat) ||
+            !xdr_native_decode_dict(xdrs, &entry->dict)) {
+            gf_dirent_entry_free(entry);
+            return FALSE;
+        }
+
+        list_add_tail(&entry->list, &entries->list);
+    }
+}
+
+bool_t
+xdr_gfx_native_readdirp_rsp(XDR *xdrs, gfx_native_readdirp_rsp *objp)
+{
+    if (!xdr_int(xdrs, &objp->op_ret) || !xdr_int(xdrs, &objp->op_errno) ||
+        !xdr_native_dict(xdrs, &objp->xdata))
+        return FALSE;
+
+    switch (xdrs->x_op) {
+        case XDR_ENCODE:
+            return xdr_native_encode_dirents(xdrs, objp->entries);
+        case XDR_DECODE:
+            if (xdr_native_decode_dirents(xdrs, objp->entries))
+                return TRUE;
+            gf_dirent_free(objp->entries);
+            xdr_native_dict_release(xdrs, &objp->xdata);
+            return FALSE;
+        default:
+            return TRUE;
+    }
+}
+
+static size_t
+xdr_native_lookup_req_size(void *msg)
+{
+    gfx_native_lookup_req *req = msg;
+
+    return 16 + 16 + 4 + xdr_native_string_size(req->bname) +
+           xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_stat_req_size(void *msg)
+{
+    gfx_native_stat_req *req = msg;
+
+    return 16 + xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_rw_req_size(void *msg)
+{
+    gfx_native_rw_req *req = msg;
+
+    return 16 + 8 + 8 + 4 + 4 + xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_readdirp_req_size(void *msg)
+{
+    gfx_native_readdirp_req *req = msg;
+
+    return 16 + 8 + 8 + 4 + xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_getxattr_req_size(void *msg)
+{
+    gfx_native_getxattr_req *req = msg;
+
+    return 16 + 4 + xdr_native_string_size(req->name) +
+           xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_inodelk_req_size(void *msg)
+{
+    gfx_native_inodelk_req *req = msg;
+
+    return 16 + 4 + 4 + 4 + 4 + 8 + 8 + 4 + 4 +
+           XDR_NATIVE_PAD(req->flock.lk_owner.lk_owner_len) +
+           xdr_native_string_size(req->volume) +
+           xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_xattrop_req_size(void *msg)
+{
+    gfx_native_xattrop_req *req = msg;
+
+    return 16 + 4 + xdr_native_dict_size(req->dict) +
+           xdr_native_dict_size(req->xdata);
+}
+
+static size_t
+xdr_native_common_rsp_size(void *msg)
+{
+    gfx_native_common_rsp *rsp = msg;
+
+    return 4 + 4 + xdr_native_dict_size(rsp->xdata);
+}
+
+static size_t
+xdr_native_iatt_rsp_size(void *msg)
+{
+    gfx_native_iatt_rsp *rsp = msg;
+
+    return 4 + 4 + xdr_native_dict_size(rsp->xdata) + XDR_NATIVE_IATTX_SIZE;
+}
+
+static size_t
+xdr_native_2iatt_rsp_size(void *msg)
+{
+    gfx_native_2iatt_rsp *rsp = msg;
+
+    return 4 + 4 + xdr_native_dict_size(rsp->xdata) +
+           2 * XDR_NATIVE_IATTX_SIZE;
+}
+
+static size_t
+xdr_native_dict_rsp_size(void *msg)
+{
+    gfx_native_dict_rsp *rsp = msg;
+
+    return 4 + 4 + xdr_native_dict_size(rsp->xdata) +
+           xdr_native_dict_size(rsp->dict) + 2 * XDR_NATIVE_IATTX_SIZE;
+}
+
+static size_t
+xdr_native_read_rsp_size(void *msg)
+{
+    gfx_native_read_rsp *rsp = msg;
+
+    return 4 + 4 + XDR_NATIVE_IATTX_SIZE + 4 +
+           xdr_native_dict_size(rsp->xdata);
+}
+
+static size_t
+xdr_native_readdirp_rsp_size(void *msg)
+{
+    gfx_native_readdirp_rsp *rsp = msg;
+    gf_dirent_t *entry = NULL;
+    size_t size = 4 + 4 + xdr_native_dict_size(rsp->xdata) + 4;
+
+    if (!rsp->entries)
+        return size;
+
+    list_for_each_entry(entry, &rsp->entries->list, list)
+    {
+        size += 4 + 8 + 8 + 4 + 4 + xdr_native_string_size(entry->d_name) +
+                XDR_NATIVE_IATTX_SIZE + xdr_native_dict_size(entry->dict);
+    }
+
+    return size;
+}
+
+static const struct {
+    xdrproc_t proc;
+    size_t (*size)(void *msg);
+} xdr_native_sizers[] = {
+    {(xdrproc_t)xdr_gfx_native_lookup_req, xdr_native_lookup_req_size},
+    {(xdrproc_t)xdr_gfx_native_stat_req, xdr_native_stat_req_size},
+    {(xdrproc_t)xdr_gfx_native_rw_req, xdr_native_rw_req_size},
+    {(xdrproc_t)xdr_gfx_native_readdirp_req, xdr_native_readdirp_req_size},
+    {(xdrproc_t)xdr_gfx_native_getxattr_req, xdr_native_getxattr_req_size},
+    {(xdrproc_t)xdr_gfx_native_inodelk_req, xdr_native_inodelk_req_size},
+    {(xdrproc_t)xdr_gfx_native_xattrop_req, xdr_native_xattrop_req_size},
+    {(xdrproc_t)xdr_gfx_native_common_rsp, xdr_native_common_rsp_size},
+    {(xdrproc_t)xdr_gfx_native_iatt_rsp, xdr_native_iatt_rsp_size},
+    {(xdrproc_t)xdr_gfx_native_2iatt_rsp, xdr_native_2iatt_rsp_size},
+    {(xdrproc_t)xdr_gfx_native_dict_rsp, xdr_native_dict_rsp_size},
+    {(xdrproc_t)xdr_gfx_native_read_rsp, xdr_native_read_rsp_size},
+    {(xdrproc_t)xdr_gfx_native_readdirp_rsp, xdr_native_readdirp_rsp_size},
+};
+
+ssize_t
+xdr_native_sizeof(xdrproc_t proc, void *msg)
+{
+    int i = 0;
+
+    for (i = 0; i < sizeof(xdr_native_sizers) / sizeof(xdr_native_sizers[0]);
+         i++) {
+        if (xdr_native_sizers[i].proc == proc)
+            return xdr_native_sizers[i].size(msg);
+    }
+
+    return xdr_sizeof(proc, msg);
+}
@@ -0,0 +1,189 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef _XDR_NATIVE_H
+#define _XDR_NATIVE_H
+
+#include <glusterfs/dict.h>
+#include <glusterfs/iatt.h>
+#include <glusterfs/gf-dirent.h>
+
+#include "xdr-generic.h"
+#include "glusterfs4-xdr.h"
+
+/* XDR routines for the messages of the hottest fops, which put on the
+ * wire exactly what their gfx_* counterparts of glusterfs4-xdr.x do, but
+ * straight from and into the structures the fops deal with: a gfx_dict
+ * is a dict_t here and a gfx_iattx a struct iatt, so no gfx_dict_pair
+ * array is built for sending and no intermediate copy is allocated on
+ * receiving.
+ *
+ * Encoding:
+ *   - a NULL dict_t goes out as the NULL dictionary, a NULL struct iatt
+ *     as zeroes.
+ *   - xdr_native_sizeof() gives the exact encoded size without going
+ *     through the message twice.
+ *
+ * Decoding:
+ *   - the message must be zeroed beforehand, as with rpcgen.
+ *   - a NULL struct iatt skips the attributes, while the dicts come out
+ *     referenced for the caller.
+ *   - strings are terminated in place and point into the buffer being
+ *     decoded, so they only live as long as that buffer. This needs a
+ *     memory stream, the one xdr_to_generic() uses.
+ *   - a message which fails to decode leaves nothing to release.
+ */
+
+typedef struct {
+    char gfid[16];
+    char pargfid[16];
+    unsigned int flags;
+    char *bname;
+    dict_t *xdata;
+} gfx_native_lookup_req;
+
+typedef struct {
+    char gfid[16];
+    dict_t *xdata;
+} gfx_native_stat_req;
+
+/* READ and WRITE */
+typedef struct {
+    char gfid[16];
+    quad_t fd;
+    u_quad_t offset;
+    unsigned int size;
+    unsigned int flag;
+    dict_t *xdata;
+} gfx_native_rw_req;
+
+typedef struct {
+    char gfid[16];
+    quad_t fd;
+    u_quad_t offset;
+    unsigned int size;
+    dict_t *xdata;
+} gfx_native_readdirp_req;
+
+typedef struct {
+    char gfid[16];
+    unsigned int namelen;
+    char *name;
+    dict_t *xdata;
+} gfx_native_getxattr_req;
+
+typedef struct {
+    char gfid[16];
+    unsigned int cmd;
+    unsigned int type;
+    gf_proto_flock flock; /* lk_owner points into the buffer once decoded */
+    char *volume;
+    dict_t *xdata;
+} gfx_native_inodelk_req;
+
+typedef struct {
+    char gfid[16];
+    unsigned int flags;
+    dict_t *dict;
+    dict_t *xdata;
+} gfx_native_xattrop_req;
+
+typedef struct {
+    int op_ret;
+    int op_errno;
+    dict_t *xdata;
+} gfx_native_common_rsp;
+
+typedef struct {
+    int op_ret;
+    int op_errno;
+    dict_t *xdata;
+    struct iatt *stat;
+} gfx_native_iatt_rsp;
+
+typedef struct {
+    int op_ret;
+    int op_errno;
+    dict_t *xdata;
+    struct iatt *prestat;
+    struct iatt *poststat;
+} gfx_native_2iatt_rsp;
+
+typedef struct {
+    int op_ret;
+    int op_errno;
+    dict_t *xdata;
+    dict_t *dict;
+    struct iatt *prestat;
+    struct iatt *poststat;
+} gfx_native_dict_rsp;
+
+typedef struct {
+    int op_ret;
+    int op_errno;
+    struct iatt *stat;
+    unsigned int size;
+    dict_t *xdata;
+} gfx_native_read_rsp;
+
+/* the entries are sent from the list, and decoded ones are added to it,
+ * which has to be empty then, with their d_off as the peer sent it */
+typedef struct {
+    int op_ret;
+    int op_errno;
+    dict_t *xdata;
+    gf_dirent_t *entries;
+} gfx_native_readdirp_rsp;
+
+bool_t
+xdr_gfx_native_lookup_req(XDR *xdrs, gfx_native_lookup_req *objp);
+
+bool_t
+xdr_gfx_native_stat_req(XDR *xdrs, gfx_native_stat_req *objp);
+
+bool_t
+xdr_gfx_native_rw_req(XDR *xdrs, gfx_native_rw_req *objp);
+
+bool_t
+xdr_gfx_native_readdirp_req(XDR *xdrs, gfx_native_readdirp_req *objp);
+
+bool_t
+xdr_gfx_native_getxattr_req(XDR *xdrs, gfx_native_getxattr_req *objp);
+
+bool_t
+xdr_gfx_native_inodelk_req(XDR *xdrs, gfx_native_inodelk_req *objp);
+
+bool_t
+xdr_gfx_native_xattrop_req(XDR *xdrs, gfx_native_xattrop_req *objp);
+
+bool_t
+xdr_gfx_native_common_rsp(XDR *xdrs, gfx_native_common_rsp *objp);
+
+bool_t
+xdr_gfx_native_iatt_rsp(XDR *xdrs, gfx_native_iatt_rsp *objp);
+
+bool_t
+xdr_gfx_native_2iatt_rsp(XDR *xdrs, gfx_native_2iatt_rsp *objp);
+
+bool_t
+xdr_gfx_native_dict_rsp(XDR *xdrs, gfx_native_dict_rsp *objp);
+
+bool_t
+xdr_gfx_native_read_rsp(XDR *xdrs, gfx_native_read_rsp *objp);
+
+bool_t
+xdr_gfx_native_readdirp_rsp(XDR *xdrs, gfx_native_readdirp_rsp *objp);
+
+/* the encoded size of @msg, computed without encoding it for the routines
+ * above, and through xdr_sizeof() for the others */
+ssize_t
+xdr_native_sizeof(xdrproc_t proc, void *msg);
+
+#endif /* !_XDR_NATIVE_H */
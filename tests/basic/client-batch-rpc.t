@@ -0,0 +1,63 @@
+#!/bin/bash
+
+# With client.batch-window set, LOOKUP, STAT and the other small requests
+# the mount makes at about the same time go to the brick in BATCH calls,
+# which the brick answers request by request in a single reply.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+function stat_all {
+        for i in $(seq 1 64); do
+                stat -c %s $M0/dir/file$i > /dev/null &
+        done
+        wait
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 client.batch-window 2000
+TEST $CLI volume set $V0 client.batch-size 8
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0 --attribute-timeout=0 \
+          --entry-timeout=0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" batch_rpc
+
+TEST mkdir $M0/dir
+for i in $(seq 1 64); do
+        echo $i > $B0/${V0}0/dir/file$i
+done
+
+TEST stat_all
+TEST [ $(get_statedump_key "$mount_dump" batches) -gt 0 ]
+TEST [ $(get_statedump_key "$brick_dump" server.batches) -gt 0 ]
+TEST [ $(get_statedump_key "$brick_dump" server.batched-ops) -ge $(get_statedump_key "$brick_dump" server.batches) ]
+
+# every request gets its own reply
+EXPECT "64" echo $(ls $M0/dir | wc -l)
+EXPECT "3" stat -c %s $M0/dir/file64
+TEST ! stat $M0/dir/missing
+TEST getfattr -n trusted.glusterfs.pathinfo $M0/dir/file1
+
+# and with the window at 0 nothing more is batched
+TEST $CLI volume set $V0 client.batch-window 0
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" get_statedump_key "$mount_dump" batch_window
+batches=$(get_statedump_key "$mount_dump" batches)
+TEST stat_all
+EXPECT "$batches" get_statedump_key "$mount_dump" batches
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
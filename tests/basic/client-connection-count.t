@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# With client.connection-count the mount opens that many connections to the
+# brick, all of them attached to the same client there: a file opened on
+# one connection is read on the others. They go away and come back with the
+# first one when the brick restarts.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 client.connection-count 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+EXPECT "4" get_statedump_key "$mount_dump" connection_count
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connection.1.connected
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connection.2.connected
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connection.3.connected
+
+TEST dd if=/dev/urandom of=$B0/data bs=128k count=64
+TEST cp $B0/data $M0/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connection.3.connected
+
+# the reads of one fd go round robin over the connections
+TEST cmp $B0/data $M0/file
+TEST [ $(get_statedump_key "$mount_dump" connection.1.requests) -gt 0 ]
+TEST [ $(get_statedump_key "$mount_dump" connection.2.requests) -gt 0 ]
+TEST [ $(get_statedump_key "$mount_dump" connection.3.requests) -gt 0 ]
+
+# all of them come back when the brick does
+TEST kill_brick $V0 $H0 $B0/${V0}0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "0" get_statedump_key "$mount_dump" connection.3.connected
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connection.3.connected
+EXPECT "2" get_statedump_key "$mount_dump" connection.3.connects
+TEST cmp $B0/data $M0/file
+
+# and fewer connections can be asked for on a live mount
+TEST $CLI volume set $V0 client.connection-count 2
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "2" get_statedump_key "$mount_dump" connection_count
+EXPECT "0" get_statedump_key "$mount_dump" connection.3.connected
+EXPECT "1" get_statedump_key "$mount_dump" connection.1.connected
+TEST cmp $B0/data $M0/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+rm -f $B0/data
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
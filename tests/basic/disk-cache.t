@@ -0,0 +1,71 @@
+#!/bin/bash
+
+# performance.disk-cache keeps file data in a local directory across
+# remounts. Cached data must be served only while the file is unchanged on
+# the volume.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/$V0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 performance.disk-cache on
+TEST $CLI volume set $V0 performance.disk-cache-dir $B0/cache
+TEST $CLI volume set $V0 performance.disk-cache-block-size 64KB
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/orig bs=1M count=4
+TEST cp $B0/orig $M0/file
+TEST dd if=/dev/urandom of=$B0/small bs=1000 count=1
+TEST cp $B0/small $M0/small
+
+# first read fills the cache
+TEST cmp $B0/orig $M0/file
+TEST cmp $B0/small $M0/small
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST ls $B0/cache/$V0-disk-cache/lock
+
+# after a remount reads are served from the local disk
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST cmp $B0/orig $M0/file
+TEST cmp $B0/small $M0/small
+TEST [ $(get_statedump_key "$mount_dump" bytes_local) -ge $((4 * 1048576)) ]
+
+# a change made behind the cache drops the cached data
+TEST dd if=/dev/urandom of=$B0/orig bs=4k count=1 seek=10 conv=notrunc
+TEST dd if=$B0/orig of=$B0/$V0/file bs=4k count=1 skip=10 seek=10 conv=notrunc
+TEST touch -d "next minute" $B0/$V0/file
+EXPECT_WITHIN $MDC_TIMEOUT "Y" eval "cmp -s $B0/orig $M0/file && echo Y"
+TEST [ $(get_statedump_key "$mount_dump" invalidations) -ge 1 ]
+
+# writes through the mount keep the cache consistent
+TEST dd if=/dev/urandom of=$M0/file bs=64k count=2 seek=3 conv=notrunc
+TEST dd if=$M0/file of=$B0/orig bs=64k count=2 skip=3 seek=3 conv=notrunc
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST cmp $B0/orig $M0/file
+TEST cmp $B0/$V0/file $M0/file
+
+TEST truncate -s 100000 $M0/file
+TEST truncate -s 100000 $B0/orig
+TEST cmp $B0/orig $M0/file
+
+rm -f $B0/orig $B0/small
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+# Listings of a distributed directory must be the same whether the
+# subvolumes are read one after the other or in parallel with
+# cluster.readdir-fanout, including when the reply buffer is too small to
+# hold what the parallel reads returned.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1..6}
+TEST $CLI volume set $V0 performance.readdir-ahead off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 --entry-timeout=0 $M0
+
+TEST mkdir $M0/dir
+for i in $(seq 1 1000); do
+        touch $M0/dir/file-$i
+done
+for i in $(seq 1 50); do
+        mkdir $M0/dir/subdir-$i
+done
+
+expected=$(mktemp)
+ls -1 $M0/dir | sort > $expected
+TEST [ $(wc -l < $expected) -eq 1050 ]
+
+TEST $CLI volume set $V0 cluster.readdir-fanout on
+EXPECT "^1050$" echo $(ls -1 $M0/dir | wc -l)
+TEST diff <(ls -1 $M0/dir | sort) $expected
+
+# directories are only listed from the first subvolume
+TEST $CLI volume set $V0 cluster.readdir-optimize on
+TEST diff <(ls -1 $M0/dir | sort) $expected
+TEST $CLI volume set $V0 cluster.readdir-optimize off
+
+# a small budget narrows the fan-out, results must not change
+TEST $CLI volume set $V0 cluster.readdir-fanout-buffer 256KB
+TEST diff <(ls -1 $M0/dir | sort) $expected
+
+# no entry is lost or duplicated when a subvolume goes away
+TEST kill_brick $V0 $H0 $B0/${V0}6
+EXPECT "^0$" echo $(ls -1 $M0/dir | sort | uniq -d | wc -l)
+
+rm -f $expected
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# With performance.iot-fair-queueing on the brick accounts the requests of
+# each client and class in its statedump and holds the requests of a class
+# to its iops limit.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.iot-fair-queueing on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/zero of=$M0/file bs=4k count=64 oflag=sync
+TEST [ $(get_statedump_key "$brick_dump" class.client.dispatched) -ge 64 ]
+TEST [ $(get_statedump_key "$brick_dump" class.client.bytes) -ge 262144 ]
+EXPECT "0" get_statedump_key "$brick_dump" class.client.throttled
+EXPECT "4" get_statedump_key "$brick_dump" class.client.weight
+
+# the mount is one of the clients listed
+statedump=$($brick_dump)
+TEST grep -q "^client\.[0-9]*\.class=client" $statedump
+TEST grep -q "^client\.[0-9]*\.max_wait_usec=" $statedump
+rm -f $statedump
+
+# 64 writes at 16 per second take more than 2 seconds
+TEST $CLI volume set $V0 performance.iot-client-iops-limit 16
+start=$(date +%s)
+TEST dd if=/dev/zero of=$M0/file bs=4k count=64 oflag=sync
+TEST [ $(( $(date +%s) - start )) -ge 2 ]
+TEST [ $(get_statedump_key "$brick_dump" class.client.throttled) -gt 0 ]
+
+TEST $CLI volume set $V0 performance.iot-client-iops-limit 0
+TEST $CLI volume set $V0 performance.iot-client-weight 8
+EXPECT "8" get_statedump_key "$brick_dump" class.client.weight
+TEST dd if=/dev/zero of=$M0/file bs=4k count=64 oflag=sync
+
+TEST $CLI volume set $V0 performance.iot-fair-queueing off
+TEST dd if=/dev/zero of=$M0/file bs=4k count=64 oflag=sync
+TEST cmp -n 262144 /dev/zero $M0/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
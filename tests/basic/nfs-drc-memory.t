@@ -0,0 +1,48 @@
+#!/bin/bash
+
+# nfs.drc-max-memory bounds the bytes the duplicate request cache takes for
+# the ops and their replies, whatever nfs.drc-size allows: the oldest ops
+# are evicted to stay within it.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../nfs.rc
+. $(dirname $0)/../volume.rc
+
+#G_TESTDEF_TEST_STATUS_CENTOS6=NFS_TEST
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/$V0
+TEST $CLI volume set $V0 nfs.disable off
+TEST $CLI volume set $V0 nfs.drc on
+TEST $CLI volume set $V0 nfs.drc-size 100000
+TEST $CLI volume set $V0 nfs.drc-max-memory 1MB
+TEST $CLI volume start $V0
+EXPECT_WITHIN $NFS_EXPORT_TIMEOUT "1" is_nfs_export_available
+TEST mount_nfs $H0:/$V0 $N0 nolock
+
+EXPECT "1048576" get_statedump_key generate_nfs_statedump drc.max_cache_bytes
+
+# far more creates and setattrs than fit in 1MB
+TEST mkdir $N0/dir
+for i in $(seq 1 5000); do touch $N0/dir/file$i; done
+EXPECT "5000" echo $(ls $N0/dir | wc -l)
+
+TEST [ $(get_statedump_key generate_nfs_statedump drc.current_cache_bytes) -le 1048576 ]
+TEST [ $(get_statedump_key generate_nfs_statedump drc.current_cache_size) -lt 10000 ]
+TEST [ $(get_statedump_key generate_nfs_statedump drc.evictions) -gt 0 ]
+
+# a larger bound is taken up without a restart
+TEST $CLI volume set $V0 nfs.drc-max-memory 4MB
+EXPECT_WITHIN $NFS_EXPORT_TIMEOUT "4194304" get_statedump_key generate_nfs_statedump drc.max_cache_bytes
+
+TEST rm -rf $N0/dir
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $N0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
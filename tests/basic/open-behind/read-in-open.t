@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# With performance.read-in-open the read which triggers the delayed open of
+# a file travels with the open, so a cold open + read of a small file costs
+# a single round trip. The open-behind statedump counts the opens sent with
+# a read and the reads answered from the data returned by them.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+
+function read_files {
+        for i in $(seq 1 20); do
+                cat $M0/file-$i > /dev/null
+        done
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2}
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.open-behind on
+TEST $CLI volume set $V0 performance.lazy-open on
+TEST $CLI volume set $V0 performance.read-after-open on
+TEST $CLI volume start $V0
+
+TEST $GFS -s $H0 --volfile-id $V0 $M0
+for i in $(seq 1 20); do
+        TEST dd if=/dev/urandom of=$B0/data-$i bs=1k count=$((i * 3))
+        TEST cp $B0/data-$i $M0/file-$i
+done
+
+# reads are sent on their own unless the option is enabled
+EXPECT "0" get_statedump_key "$mount_dump" read_in_open
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS -s $H0 --volfile-id $V0 $M0
+read_files
+EXPECT "0" get_statedump_key "$mount_dump" reads_in_open
+EXPECT "0" get_statedump_key "$mount_dump" reads_served
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# data returned with the open must be the file's content
+TEST $CLI volume set $V0 performance.read-in-open on
+TEST $GFS -s $H0 --volfile-id $V0 $M0
+for i in $(seq 1 20); do
+        TEST cmp $B0/data-$i $M0/file-$i
+done
+TEST [ $(get_statedump_key "$mount_dump" reads_in_open) -ge 20 ]
+TEST [ $(get_statedump_key "$mount_dump" reads_served) -ge 20 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+rm -f $B0/data-*
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# With storage.reclaim-rate set, files losing their last name are moved to
+# .glusterfs/reclaim by the unlink and their space is freed there by the
+# brick at the given rate, even across a restart of the brick.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+function reclaim_count {
+        ls $B0/${V0}0/.glusterfs/reclaim | wc -l
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 storage.reclaim-rate 16MB
+TEST $CLI volume set $V0 storage.reclaim-iops 8
+TEST $CLI volume set $V0 storage.reclaim-min-size 16MB
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# small files are freed in the unlink
+TEST dd if=/dev/zero of=$M0/small bs=1M count=4
+TEST rm -f $M0/small
+EXPECT "0" reclaim_count
+
+# large ones in the background, in steps of 2MB
+TEST dd if=/dev/zero of=$M0/large bs=1M count=64
+TEST rm -f $M0/large
+TEST ! stat $M0/large
+EXPECT "1" reclaim_count
+EXPECT_WITHIN 30 "0" reclaim_count
+EXPECT "1" get_statedump_key "$brick_dump" reclaim_files_done
+EXPECT "0" get_statedump_key "$brick_dump" reclaim_backlog_files
+TEST [ $(get_statedump_key "$brick_dump" reclaim_steps) -ge 16 ]
+TEST [ $(get_statedump_key "$brick_dump" reclaim_bytes_done) -ge 67108864 ]
+
+# a file with another name keeps its data
+TEST dd if=/dev/urandom of=$M0/linked bs=1M count=32
+TEST ln $M0/linked $M0/other
+TEST rm -f $M0/linked
+EXPECT "0" reclaim_count
+EXPECT "33554432" stat -c %s $M0/other
+TEST rm -f $M0/other
+EXPECT_WITHIN 30 "0" reclaim_count
+
+# what is left when the brick stops is freed when it starts again
+TEST $CLI volume set $V0 storage.reclaim-rate 1MB
+TEST $CLI volume set $V0 storage.reclaim-iops 1
+TEST dd if=/dev/zero of=$M0/large bs=1M count=64
+TEST rm -f $M0/large
+EXPECT "1" reclaim_count
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+EXPECT "1" reclaim_count
+TEST $CLI volume start $V0
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "1" brick_up_status $V0 $H0 $B0/${V0}0
+EXPECT "1" get_statedump_key "$brick_dump" reclaim_backlog_files
+TEST $CLI volume set $V0 storage.reclaim-rate 64MB
+EXPECT_WITHIN 30 "0" reclaim_count
+
+# and with the option off files are freed in the unlink again
+TEST $CLI volume set $V0 storage.reclaim-rate 0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=/dev/zero of=$M0/large bs=1M count=64
+TEST rm -f $M0/large
+EXPECT "0" reclaim_count
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
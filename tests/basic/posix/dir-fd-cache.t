@@ -0,0 +1,68 @@
+#!/bin/bash
+
+# storage.dir-fd-cache-size keeps O_PATH fds of directories on the brick so
+# that entries are resolved relative to their parent instead of through the
+# chain of gfid handles. Removed and replaced directories must not be
+# resolved through stale fds.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.readdir-ahead off
+TEST $CLI volume set $V0 storage.dir-fd-cache-size 1024
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 --entry-timeout=0 \
+          --attribute-timeout=0 $M0
+
+deep=$M0/a/b/c/d/e/f/g/h
+TEST mkdir -p $deep
+for i in $(seq 1 20); do
+        TEST touch $deep/file-$i
+done
+for i in $(seq 1 20); do
+        TEST stat $deep/file-$i
+done
+TEST [ $(get_statedump_key "$brick_dump" dir_fd_cache_hits) -ge 20 ]
+TEST [ $(get_statedump_key "$brick_dump" dir_fd_cache_count) -ge 1 ]
+
+# a directory recreated under the same name is a new directory
+TEST rm -rf $M0/a/b/c/d
+TEST ! stat $deep/file-1
+TEST mkdir -p $deep
+TEST touch $deep/new
+TEST stat $deep/new
+TEST ! stat $deep/file-1
+TEST [ $(get_statedump_key "$brick_dump" dir_fd_cache_invalidations) -ge 1 ]
+
+# a directory replaced by rename
+TEST mkdir $M0/x $M0/y
+TEST touch $M0/x/in-x $M0/y/in-y
+TEST stat $M0/y/in-y
+TEST rm -f $M0/y/in-y
+TEST mv -T $M0/x $M0/y
+TEST stat $M0/y/in-x
+TEST ! stat $M0/y/in-y
+
+# changes made directly on the brick are seen
+TEST touch $B0/${V0}0/y/on-brick
+TEST stat $M0/y/on-brick
+
+TEST $CLI volume set $V0 storage.dir-fd-cache-size 0
+EXPECT "0" get_statedump_key "$brick_dump" dir_fd_cache_count
+TEST stat $deep/new
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
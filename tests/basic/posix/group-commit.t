@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# storage.batch-fsync-mode group-commit flushes concurrent fsyncs and
+# O_SYNC writes of a brick together. Every request must still return only
+# after its data is on disk, and the brick accounts the groups it formed.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 storage.batch-fsync-mode group-commit
+TEST $CLI volume start $V0
+TEST ! $CLI volume set $V0 storage.batch-fsync-mode no-such-mode
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/data bs=4k count=64
+for i in $(seq 1 16); do
+        dd if=$B0/data of=$M0/fsync-$i bs=4k conv=fsync 2> /dev/null &
+        dd if=$B0/data of=$M0/osync-$i bs=4k oflag=sync 2> /dev/null &
+done
+wait
+
+for i in $(seq 1 16); do
+        TEST cmp $B0/data $M0/fsync-$i
+        TEST cmp $B0/data $M0/osync-$i
+done
+
+TEST [ $(get_statedump_key "$brick_dump" group_commit_groups) -ge 1 ]
+TEST [ $(get_statedump_key "$brick_dump" group_commit_members) -ge 16 ]
+TEST [ $(get_statedump_key "$brick_dump" group_commit_size_1) -ge 0 ]
+
+# back to plain fsyncs
+TEST $CLI volume set $V0 storage.batch-fsync-mode reverse-fsync
+groups=$(get_statedump_key "$brick_dump" group_commit_groups)
+TEST dd if=$B0/data of=$M0/plain bs=4k conv=fsync
+EXPECT "$groups" get_statedump_key "$brick_dump" group_commit_groups
+
+rm -f $B0/data
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
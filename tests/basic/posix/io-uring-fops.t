@@ -0,0 +1,65 @@
+#!/bin/bash
+
+# With storage.linux-io_uring on, fstat, fallocate and discard are served
+# through the io_uring engine and the postbuf of reads, writes and fsyncs
+# comes from a linked statx, optionally over several rings with registered
+# files and buffers. Results must be the same as without it. When
+# the build or the kernel has no io_uring support posix falls back to the
+# synchronous fops and the checks below still hold.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 storage.linux-io_uring on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 --attribute-timeout=0 $M0
+
+TEST dd if=/dev/urandom of=$M0/file bs=64k count=16 conv=fsync
+EXPECT "1048576" stat -c %s $M0/file
+EXPECT "1048576" stat -c %s $B0/${V0}0/file
+TEST cmp $M0/file $B0/${V0}0/file
+
+TEST fallocate -l 4M $M0/alloc
+EXPECT "4194304" stat -c %s $M0/alloc
+EXPECT "4194304" stat -c %s $B0/${V0}0/alloc
+
+TEST fallocate -n -o 4M -l 1M $M0/alloc
+EXPECT "4194304" stat -c %s $M0/alloc
+
+TEST fallocate -p -o 0 -l 512k $M0/file
+EXPECT "1048576" stat -c %s $M0/file
+TEST cmp -n 524288 $M0/file /dev/zero
+TEST cmp $M0/file $B0/${V0}0/file
+
+# several rings, registered files and fixed read buffers
+TEST $CLI volume set $V0 storage.linux-io_uring off
+TEST $CLI volume set $V0 storage.linux-io_uring-rings 4
+TEST $CLI volume set $V0 storage.linux-io_uring-fixed on
+TEST $CLI volume set $V0 storage.linux-io_uring on
+TEST dd if=/dev/urandom of=$B0/data bs=64k count=32
+for i in $(seq 1 4); do
+        TEST cp $B0/data $M0/copy-$i
+done
+for i in $(seq 1 4); do
+        TEST cmp $B0/data $M0/copy-$i
+        TEST cmp $B0/data $B0/${V0}0/copy-$i
+done
+rm -f $B0/data
+
+TEST $CLI volume set $V0 storage.linux-io_uring off
+TEST cmp $M0/file $B0/${V0}0/file
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
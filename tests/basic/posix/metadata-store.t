@@ -0,0 +1,97 @@
+#!/bin/bash
+
+# With storage.metadata-store the time attributes of files are kept in a log
+# in the .glusterfs directory of the brick instead of in the
+# trusted.glusterfs.mdata xattr. They must survive brick restarts, and
+# extras/mdstore-migrate.py moves existing xattrs into the store and back.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+MIGRATE=$(dirname $0)/../../../extras/mdstore-migrate.py
+
+function restart_volume {
+        $CLI volume stop $V0 && $CLI volume start $V0
+}
+
+function mount_volume {
+        $GFS --volfile-id=$V0 --volfile-server=$H0 --attribute-timeout=0 \
+             --entry-timeout=0 $M0
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume start $V0
+
+# files created with the times in xattrs
+TEST mount_volume
+TEST mkdir $M0/dir
+TEST touch -d "2001-02-03 04:05:06 UTC" $M0/old
+TEST touch -d "2002-02-03 04:05:06 UTC" $M0/dir
+TEST getfattr -n trusted.glusterfs.mdata $B0/${V0}0/old
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $MIGRATE import $B0/${V0}0 --remove-xattrs
+TEST ! getfattr -n trusted.glusterfs.mdata $B0/${V0}0/old
+TEST ls $B0/${V0}0/.glusterfs/mdstore.log
+TEST $CLI volume set $V0 storage.metadata-store on
+TEST $CLI volume start $V0
+
+TEST mount_volume
+EXPECT "981173106" stat -c %Y $M0/old
+EXPECT "1012709106" stat -c %Y $M0/dir
+
+# new files and updated times stay out of the xattrs
+TEST touch -d "2003-02-03 04:05:06 UTC" $M0/new
+TEST dd if=/dev/zero of=$M0/old bs=1k count=1 conv=notrunc,fsync
+TEST touch -d "2004-02-03 04:05:06 UTC" $M0/old
+TEST ! getfattr -n trusted.glusterfs.mdata $B0/${V0}0/new
+TEST ! getfattr -n trusted.glusterfs.mdata $B0/${V0}0/old
+TEST [ $(get_statedump_key "$brick_dump" metadata_store_keys) -ge 3 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# times come back from the log after a restart
+TEST restart_volume
+TEST mount_volume
+EXPECT "1044245106" stat -c %Y $M0/new
+EXPECT "1075781106" stat -c %Y $M0/old
+
+# a removed file takes its times along
+TEST rm -f $M0/new
+TEST touch $M0/new
+TEST [ $(stat -c %Y $M0/new) -gt 1044245106 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# and back into xattrs
+TEST $CLI volume stop $V0
+TEST $MIGRATE export $B0/${V0}0
+TEST getfattr -n trusted.glusterfs.mdata $B0/${V0}0/old
+TEST $CLI volume set $V0 storage.metadata-store off
+TEST $CLI volume start $V0
+TEST mount_volume
+EXPECT "1075781106" stat -c %Y $M0/old
+TEST touch -d "2005-02-03 04:05:06 UTC" $M0/lazy
+TEST getfattr -n trusted.glusterfs.mdata $B0/${V0}0/lazy
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# xattrs left behind move into the store when the times are first read
+TEST $CLI volume set $V0 storage.metadata-store on
+TEST restart_volume
+TEST mount_volume
+EXPECT "1107403506" stat -c %Y $M0/lazy
+TEST ! getfattr -n trusted.glusterfs.mdata $B0/${V0}0/lazy
+TEST [ $(get_statedump_key "$brick_dump" metadata_store_migrated) -ge 1 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
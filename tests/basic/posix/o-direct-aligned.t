@@ -0,0 +1,67 @@
+#!/bin/bash
+
+# With storage.o-direct-aligned the brick reads and writes with O_DIRECT the
+# requests aligned to its block size and through the page cache the others.
+# Both kinds of requests, mixed on the same file, must read back the data
+# written.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 storage.o-direct-aligned on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/data bs=1M count=4
+TEST cp $B0/data $B0/ref
+
+# whole blocks at block offsets
+TEST dd if=$B0/data of=$M0/file bs=128k
+TEST [ $(get_statedump_key "$brick_dump" direct_aligned_writes) -ge 32 ]
+
+# unaligned writes over the data written with O_DIRECT
+TEST dd if=/dev/urandom of=$B0/patch bs=1000 count=7
+TEST dd if=$B0/patch of=$B0/ref bs=1000 seek=333 conv=notrunc
+TEST dd if=$B0/patch of=$M0/file bs=1000 seek=333 conv=notrunc
+TEST [ $(get_statedump_key "$brick_dump" direct_unaligned_writes) -ge 7 ]
+
+# and aligned ones over the page cache
+TEST dd if=/dev/urandom of=$B0/patch bs=4k count=4
+TEST dd if=$B0/patch of=$B0/ref bs=4k seek=1 conv=notrunc
+TEST dd if=$B0/patch of=$M0/file bs=4k seek=1 conv=notrunc
+
+TEST cmp $B0/ref $M0/file
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+reads=$(get_statedump_key "$brick_dump" direct_aligned_reads)
+TEST cmp $B0/ref $M0/file
+TEST [ $(get_statedump_key "$brick_dump" direct_aligned_reads) -gt $reads ]
+
+# off again, nothing is counted
+TEST $CLI volume set $V0 storage.o-direct-aligned off
+writes=$(get_statedump_key "$brick_dump" direct_aligned_writes)
+TEST dd if=$B0/data of=$M0/file2 bs=128k
+EXPECT "$writes" get_statedump_key "$brick_dump" direct_aligned_writes
+TEST cmp $B0/data $M0/file2
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+rm -f $B0/data $B0/ref $B0/patch
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# With storage.readdirp-fill-threads the entries of a large readdirp reply
+# are stated by several threads on the brick. The attributes returned must
+# be the same as with the entries filled one after the other, and io-stats
+# accounts the size and time of every batch.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+function list_dir {
+        $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+        ls -ln --full-time $M0/dir
+        force_umount $M0 > /dev/null
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.readdir-ahead off
+TEST $CLI volume start $V0
+TEST $CLI volume profile $V0 start
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST mkdir $M0/dir
+for i in $(seq 1 300); do
+        dd if=/dev/zero of=$M0/dir/file-$i bs=$i count=1 2> /dev/null
+done
+TEST mkdir $M0/dir/subdir
+TEST ln -s file-1 $M0/dir/link
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume set $V0 storage.readdirp-fill-threads 0
+list_dir > $B0/sequential
+TEST $CLI volume set $V0 storage.readdirp-fill-threads 4
+list_dir > $B0/parallel
+
+EXPECT "300" echo $(grep -c "^-" $B0/parallel)
+TEST cmp $B0/sequential $B0/parallel
+TEST [ $(get_statedump_key "$brick_dump" readdirp_fill_threads) -ge 1 ]
+TEST [ $(get_statedump_key "$brick_dump" cumulative.readdirp_batches) -ge 2 ]
+TEST [ $(get_statedump_key "$brick_dump" cumulative.readdirp_batch_entries) -ge 600 ]
+
+rm -f $B0/sequential $B0/parallel
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,92 @@
+#!/bin/bash
+
+# With client.sparse-read the bricks leave the holes of a read out of the
+# reply and the client fills the zeroes back in; storage.punch-zero-writes
+# turns writes of zeroes into holes. The data read must not change either
+# way.
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+mount_dump="generate_mount_statedump $V0 $M0"
+
+# 4MB file with 64KB of data at 512KB and 2560KB and holes elsewhere
+function make_sparse {
+        truncate -s 4M $1
+        dd if=$B0/data of=$1 bs=64k count=1 seek=8 conv=notrunc 2> /dev/null
+        dd if=$B0/data of=$1 bs=64k count=1 seek=40 conv=notrunc 2> /dev/null
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 client.sparse-read on
+TEST $CLI volume start $V0
+
+TEST dd if=/dev/urandom of=$B0/data bs=64k count=1
+TEST make_sparse $B0/ref
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST make_sparse $M0/sparse
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST cmp $B0/ref $M0/sparse
+# reads inside the data, inside a hole and across the end of the file
+TEST cmp <(dd if=$B0/ref bs=4k skip=130 count=8 2> /dev/null) \
+         <(dd if=$M0/sparse bs=4k skip=130 count=8 2> /dev/null)
+TEST cmp <(dd if=$B0/ref bs=4k skip=300 count=8 2> /dev/null) \
+         <(dd if=$M0/sparse bs=4k skip=300 count=8 2> /dev/null)
+TEST cmp <(dd if=$B0/ref bs=4k skip=1020 count=8 2> /dev/null) \
+         <(dd if=$M0/sparse bs=4k skip=1020 count=8 2> /dev/null)
+TEST [ $(get_statedump_key "$brick_dump" sparse_reads) -ge 1 ]
+TEST [ $(get_statedump_key "$brick_dump" sparse_read_hole_bytes) -ge 3145728 ]
+TEST [ $(get_statedump_key "$mount_dump" sparse_reads) -ge 1 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# without the option replies carry all the zeroes
+TEST $CLI volume set $V0 client.sparse-read off
+reads=$(get_statedump_key "$brick_dump" sparse_reads)
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST cmp $B0/ref $M0/sparse
+EXPECT "$reads" get_statedump_key "$brick_dump" sparse_reads
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume set $V0 storage.punch-zero-writes on
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# zeroes written over data leave a hole
+TEST dd if=/dev/urandom of=$B0/ref bs=1M count=4
+TEST cp $B0/ref $M0/image
+TEST dd if=/dev/zero of=$B0/ref bs=1M count=2 seek=1 conv=notrunc
+TEST dd if=/dev/zero of=$M0/image bs=1M count=2 seek=1 conv=notrunc
+TEST cmp $B0/ref $M0/image
+TEST [ $(stat -c %b $B0/${V0}0/image) -lt 6144 ]
+
+# zeroes written past the end of the file only extend it
+TEST dd if=/dev/zero of=$M0/zeroes bs=1M count=4
+EXPECT "4194304" stat -c %s $B0/${V0}0/zeroes
+TEST [ $(stat -c %b $B0/${V0}0/zeroes) -lt 1024 ]
+TEST cmp -n 4194304 /dev/zero $M0/zeroes
+TEST [ $(get_statedump_key "$brick_dump" zero_writes) -ge 2 ]
+
+# small writes of zeroes are written as they are
+writes=$(get_statedump_key "$brick_dump" zero_writes)
+TEST dd if=/dev/zero of=$M0/small bs=1k count=1
+EXPECT "$writes" get_statedump_key "$brick_dump" zero_writes
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+rm -f $B0/data $B0/ref
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
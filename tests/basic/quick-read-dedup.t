@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# With cache-dedup, files with the same content share one cached copy and
+# cache-compression shrinks it further. Data read back must be unchanged.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/$V0
+TEST $CLI volume set $V0 performance.quick-read on
+TEST $CLI volume set $V0 performance.quick-read-cache-timeout 60
+TEST $CLI volume set $V0 performance.quick-read-cache-dedup on
+TEST $CLI volume set $V0 performance.quick-read-cache-compression on
+TEST $CLI volume start $V0
+
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+
+# 10 copies of the same compressible 16KB file
+yes "glusterfs quick-read" | head -c 16384 > $B0/orig
+for i in $(seq 1 10); do
+        cp $B0/orig $M0/copy-$i
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0
+
+for i in $(seq 1 10); do
+        TEST cmp $B0/orig $M0/copy-$i
+done
+
+# reads are served from the cache and the content is stored only once
+for i in $(seq 1 10); do
+        TEST cmp $B0/orig $M0/copy-$i
+done
+TEST [ $(get_statedump_key "$mount_dump" cache-hit) -ge 10 ]
+TEST [ $(get_statedump_key "$mount_dump" shared-contents) -eq 1 ]
+TEST [ $(get_statedump_key "$mount_dump" content-shared) -ge 9 ]
+logical=$(get_statedump_key "$mount_dump" cache-logical-bytes)
+physical=$(get_statedump_key "$mount_dump" cache-physical-bytes)
+TEST [ $logical -eq $((16384 * 10)) ]
+TEST [ $physical -lt 16384 ]
+
+# a write to one copy does not affect the others
+echo "changed" > $M0/copy-1
+EXPECT "changed" cat $M0/copy-1
+TEST cmp $B0/orig $M0/copy-2
+
+rm -f $B0/orig
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
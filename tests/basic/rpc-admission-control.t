@@ -0,0 +1,84 @@
+#!/bin/bash
+
+# With server.admission-control on, the brick counts the requests of each
+# client against a limit of its own and reports how long requests stay in
+# it. A client with many requests is held back, one with few next to it
+# is not; turning it off again leaves no connection held back.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+# throttled count of the client with the most ("max") or the fewest
+# ("min") requests admitted in statedump $1
+function admit_throttled {
+        awk -F'[][=]' -v want=$2 '
+                /^rpcsvc.admission-control.client\[[0-9]+\].admitted=/ {
+                        admitted[$2] = $4 + 0
+                }
+                /^rpcsvc.admission-control.client\[[0-9]+\].throttled=/ {
+                        throttled[$2] = $4
+                }
+                END {
+                        for (c in admitted)
+                                if (pick == "" ||
+                                    (want == "max" && admitted[c] > admitted[pick]) ||
+                                    (want == "min" && admitted[c] < admitted[pick]))
+                                        pick = c
+                        print throttled[pick]
+                }' $1
+}
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 server.admission-control on
+TEST $CLI volume set $V0 server.admission-target-delay 5
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT "yes" get_statedump_key "$brick_dump" rpcsvc.admission-control.enabled
+
+for i in $(seq 1 8); do
+        dd if=/dev/zero of=$M0/file$i bs=128k count=64 oflag=sync 2>/dev/null &
+done
+wait
+
+# the delays are those of the requests since the previous statedump
+statedump=$($brick_dump)
+TEST [ $(grep "^rpcsvc.admission-control.requests=" $statedump | cut -f2 -d'=') -gt 512 ]
+TEST grep -q "^rpcsvc.admission-control.delay-p99-us=[0-9]" $statedump
+# the limits stay between the floor and outstanding-rpc-limit
+limit=$(grep "^rpcsvc.admission-control.client\[0\].limit=" $statedump | cut -f2 -d'=')
+TEST [ ${limit:-0} -ge 4 -a ${limit:-0} -le 64 ]
+rm -f $statedump
+
+# a heavy client next to a light one, while both are busy
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M1
+for i in $(seq 1 16); do
+        dd if=/dev/zero of=$M0/heavy$i bs=128k count=256 oflag=sync 2>/dev/null &
+done
+dd if=/dev/zero of=$M1/light bs=4k count=256 oflag=sync 2>/dev/null &
+sleep 3
+statedump=$($brick_dump)
+wait
+TEST [ $(admit_throttled $statedump max) -gt 0 ]
+EXPECT "0" admit_throttled $statedump min
+rm -f $statedump
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M1
+
+TEST $CLI volume set $V0 server.admission-control off
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "no" get_statedump_key "$brick_dump" rpcsvc.admission-control.enabled
+TEST "echo data > $M0/after"
+EXPECT "data" cat $M0/after
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
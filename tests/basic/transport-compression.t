@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# With client.transport-compression and server.transport-compression set,
+# the mount and the brick compress what they send each other; data which
+# does not compress is soon sent as it is.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 server.transport-compression zlib
+TEST $CLI volume set $V0 client.transport-compression zlib
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "zlib" get_statedump_key "$mount_dump" compression
+
+# text compresses well both ways
+TEST "yes glusterfs | head -c 4194304 > $M0/text"
+TEST [ $(get_statedump_key "$mount_dump" compress_saved_write) -gt 2097152 ]
+TEST [ $(get_statedump_key "$brick_dump" server.compress-saved-read) -gt 2097152 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "zlib" get_statedump_key "$mount_dump" compression
+EXPECT "$(yes glusterfs | head -c 4194304 | md5sum)" echo "$(cat $M0/text | md5sum)"
+TEST [ $(get_statedump_key "$mount_dump" compress_saved_read) -gt 2097152 ]
+
+# random data does not, and stops being tried after a few writes
+TEST dd if=/dev/urandom of=$B0/random bs=128k count=32
+TEST cp $B0/random $M0/random
+TEST [ $(get_statedump_key "$mount_dump" compress_skipped_records) -gt 0 ]
+TEST cmp $B0/random $M0/random
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# nothing is compressed unless the brick agrees to it
+TEST $CLI volume set $V0 server.transport-compression off
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "off" get_statedump_key "$mount_dump" compression
+TEST "yes glusterfs | head -c 1048576 > $M0/text2"
+EXPECT "0" get_statedump_key "$mount_dump" compress_saved_write
+EXPECT "$(yes glusterfs | head -c 1048576 | md5sum)" echo "$(cat $M0/text2 | md5sum)"
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+rm -f $B0/random
+
+cleanup;
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# With transport.shared-memory on, a mount on the host of the brick passes
+# it shared memory, through which most of their messages then go; anything
+# restricting which clients may connect keeps them on TCP.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+brick_dump="generate_brick_statedump $V0 $H0 $B0/${V0}0"
+
+cleanup;
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 transport.shared-memory on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+
+# large writes and reads go through the slots of the rings
+TEST dd if=/dev/urandom of=$B0/random bs=128k count=32
+TEST cp $B0/random $M0/random
+TEST [ $(get_statedump_key "$mount_dump" shm_records_sent) -gt 32 ]
+TEST [ $(get_statedump_key "$brick_dump" server.shm-records-received) -gt 32 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+TEST cmp $B0/random $M0/random
+TEST [ $(get_statedump_key "$mount_dump" shm_records_received) -gt 32 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# the brick cannot check the address of a client on a unix socket
+TEST $CLI volume set $V0 auth.reject 192.0.2.1
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+TEST cmp $B0/random $M0/random
+EXPECT "0" get_statedump_key "$mount_dump" shm_records_sent
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+rm -f $B0/random
+
+cleanup;
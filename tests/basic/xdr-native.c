@@ -0,0 +1,871 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+/* Checks the routines of xdr-native.h against the rpcgen ones, on random
+ * messages: both must encode the same bytes, what the native routines
+ * decode must encode back to the same bytes, and every truncated or
+ * damaged message must fail to decode, or decode into something which can
+ * be released, without crashing.
+ *
+ * usage: xdr-native [iterations] [seed]
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/globals.h>
+#include <glusterfs/rpc/xdr-native.h>
+#include <glusterfs/rpc/glusterfs3.h>
+
+#define MSG_BUF_SIZE (256 * 1024)
+
+#define CHECK(cond, ...)                                                       \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            fprintf(stderr, "%s: ", test->name);                               \
+            fprintf(stderr, __VA_ARGS__);                                      \
+            fprintf(stderr, "\n");                                             \
+            return -1;                                                         \
+        }                                                                      \
+    } while (0)
+
+/* a native message along with the room its pointers point to */
+typedef struct {
+    union {
+        gfx_native_lookup_req lookup;
+        gfx_native_stat_req stat;
+        gfx_native_rw_req rw;
+        gfx_native_readdirp_req readdirp;
+        gfx_native_getxattr_req getxattr;
+        gfx_native_inodelk_req inodelk;
+        gfx_native_xattrop_req xattrop;
+        gfx_native_common_rsp common;
+        gfx_native_iatt_rsp iatt;
+        gfx_native_2iatt_rsp iatt2;
+        gfx_native_dict_rsp dict;
+        gfx_native_read_rsp read;
+        gfx_native_readdirp_rsp dirents;
+    } m;
+    struct iatt ia[2];
+    gf_dirent_t entries;
+    char str[2][512];
+} native_msg_t;
+
+typedef union {
+    gfx_lookup_req lookup;
+    gfx_stat_req stat;
+    gfx_read_req read_req;
+    gfx_write_req write_req;
+    gfx_readdirp_req readdirp;
+    gfx_getxattr_req getxattr;
+    gfx_inodelk_req inodelk;
+    gfx_xattrop_req xattrop;
+    gfx_common_rsp common;
+    gfx_common_iatt_rsp iatt;
+    gfx_common_2iatt_rsp iatt2;
+    gfx_common_dict_rsp dict;
+    gfx_read_rsp read;
+    gfx_readdirp_rsp dirents;
+} rpcgen_msg_t;
+
+#define NONE -1
+#define AT(field) offsetof(native_msg_t, m.field)
+
+/* where the dicts, the iatts and the entries of a native message are, as
+ * everything else is the same for all of them */
+typedef struct {
+    const char *name;
+    xdrproc_t native;
+    xdrproc_t rpcgen;
+    void (*fill)(native_msg_t *n);
+    void (*convert)(native_msg_t *n, rpcgen_msg_t *r);
+    ssize_t dicts[2];
+    ssize_t iatts[2];
+    ssize_t entries;
+} msg_test_t;
+
+static unsigned int
+rnd(unsigned int max)
+{
+    return random() % max;
+}
+
+static uint64_t
+rnd64(void)
+{
+    return ((uint64_t)random() << 33) ^ ((uint64_t)random() << 2) ^ random();
+}
+
+static void
+fill_bytes(char *buf, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = random();
+}
+
+static char *
+fill_string(char *buf, size_t size)
+{
+    size_t len = rnd(size);
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        buf[i] = 'a' + rnd(26);
+    buf[len] = '\0';
+
+    return buf;
+}
+
+static void
+fill_iatt(struct iatt *ia)
+{
+    static const ia_type_t types[] = {IA_IFREG, IA_IFDIR, IA_IFLNK,
+                                      IA_IFBLK, IA_IFCHR, IA_IFIFO,
+                                      IA_IFSOCK};
+
+    memset(ia, 0, sizeof(*ia));
+    fill_bytes((char *)ia->ia_gfid, 16);
+    ia->ia_flags = rnd64();
+    ia->ia_ino = rnd64();
+    ia->ia_dev = rnd64();
+    ia->ia_rdev = rnd64();
+    ia->ia_size = rnd64();
+    ia->ia_blocks = rnd64();
+    ia->ia_attributes = rnd64();
+    ia->ia_attributes_mask = rnd64();
+    ia->ia_atime = rnd64();
+    ia->ia_mtime = rnd64();
+    ia->ia_ctime = rnd64();
+    ia->ia_btime = rnd64();
+    ia->ia_atime_nsec = random();
+    ia->ia_mtime_nsec = random();
+    ia->ia_ctime_nsec = random();
+    ia->ia_btime_nsec = random();
+    ia->ia_nlink = random();
+    ia->ia_uid = random();
+    ia->ia_gid = random();
+    ia->ia_blksize = random();
+    ia->ia_type = types[rnd(sizeof(types) / sizeof(types[0]))];
+    ia->ia_prot = ia_prot_from_st_mode(random());
+}
+
+/* a NULL dict now and then, and values of every type sent on the wire */
+static dict_t *
+fill_dict(void)
+{
+    dict_t *dict = NULL;
+    struct iatt *iatt = NULL;
+    struct mdata_iatt *mdata = NULL;
+    unsigned char *uuid = NULL;
+    char *value = NULL;
+    char key[64];
+    char str[256];
+    int count = 0;
+    int i = 0;
+    size_t len = 0;
+    int ret = 0;
+
+    if (!rnd(5))
+        return NULL;
+
+    dict = dict_new();
+    count = rnd(9);
+    for (i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "trusted.key-%d-%s", i,
+                 fill_string(str, 32));
+        switch (rnd(8)) {
+            case 0:
+                ret = dict_set_int64(dict, key, (int64_t)rnd64());
+                break;
+            case 1:
+                ret = dict_set_uint64(dict, key, rnd64());
+                break;
+            case 2:
+                /* printed as "%f" by the dict, so keep it exact */
+                ret = dict_set_double(dict, key, (double)rnd(1 << 20) / 4);
+                break;
+            case 3:
+                value = gf_strdup(fill_string(str, sizeof(str)));
+                ret = dict_set_dynstr(dict, key, value);
+                break;
+            case 4:
+                len = rnd(256);
+                value = GF_MALLOC(len + 1, gf_common_mt_char);
+                fill_bytes(value, len);
+                value[len] = '\0';
+                ret = dict_set_dynptr(dict, key, value, len);
+                break;
+            case 5:
+                iatt = GF_MALLOC(sizeof(*iatt), gf_common_mt_char);
+                fill_iatt(iatt);
+                ret = dict_set_iatt(dict, key, iatt, false);
+                break;
+            case 6:
+                uuid = GF_MALLOC(sizeof(uuid_t), gf_common_mt_uuid_t);
+                fill_bytes((char *)uuid, sizeof(uuid_t));
+                ret = dict_set_gfuuid(dict, key, uuid, false);
+                break;
+            default:
+                mdata = GF_MALLOC(sizeof(*mdata), gf_common_mt_char);
+                mdata->ia_atime = rnd64();
+                mdata->ia_mtime = rnd64();
+                mdata->ia_ctime = rnd64();
+                mdata->ia_atime_nsec = random();
+                mdata->ia_mtime_nsec = random();
+                mdata->ia_ctime_nsec = random();
+                ret = dict_set_mdata(dict, key, mdata, false);
+                break;
+        }
+        if (ret) {
+            fprintf(stderr, "cannot set %s\n", key);
+            exit(1);
+        }
+    }
+
+    return dict;
+}
+
+static dict_t **
+msg_dict(native_msg_t *n, const msg_test_t *test, int i)
+{
+    return (test->dicts[i] == NONE) ? NULL
+                                    : (dict_t **)((char *)n + test->dicts[i]);
+}
+
+static struct iatt **
+msg_iatt(native_msg_t *n, const msg_test_t *test, int i)
+{
+    return (test->iatts[i] == NONE)
+               ? NULL
+               : (struct iatt **)((char *)n + test->iatts[i]);
+}
+
+/* points the iatts and the entries of @n to its own room */
+static void
+prepare_native(native_msg_t *n, const msg_test_t *test)
+{
+    int i = 0;
+
+    memset(n, 0, sizeof(*n));
+    INIT_LIST_HEAD(&n->entries.list);
+
+    for (i = 0; i < 2; i++) {
+        if (msg_iatt(n, test, i))
+            *msg_iatt(n, test, i) = &n->ia[i];
+    }
+    if (test->entries != NONE)
+        *(gf_dirent_t **)((char *)n + test->entries) = &n->entries;
+}
+
+static void
+release_native(native_msg_t *n, const msg_test_t *test)
+{
+    int i = 0;
+
+    for (i = 0; i < 2; i++) {
+        if (msg_dict(n, test, i) && *msg_dict(n, test, i)) {
+            dict_unref(*msg_dict(n, test, i));
+            *msg_dict(n, test, i) = NULL;
+        }
+    }
+    gf_dirent_free(&n->entries);
+}
+
+/* what a failed decode must not leave behind */
+static int
+native_residue(native_msg_t *n, const msg_test_t *test)
+{
+    int i = 0;
+
+    for (i = 0; i < 2; i++) {
+        if (msg_dict(n, test, i) && *msg_dict(n, test, i))
+            return 1;
+    }
+
+    return !list_empty(&n->entries.list);
+}
+
+/* the iatts are left out now and then, as senders do on errors */
+static void
+fill_native(native_msg_t *n, const msg_test_t *test)
+{
+    int i = 0;
+
+    prepare_native(n, test);
+    for (i = 0; i < 2; i++) {
+        if (!msg_iatt(n, test, i))
+            continue;
+        if (rnd(4))
+            fill_iatt(&n->ia[i]);
+        else
+            *msg_iatt(n, test, i) = NULL;
+    }
+    test->fill(n);
+}
+
+static void
+iatt_to_rpcgen(struct gfx_iattx *stat, struct iatt *ia)
+{
+    memset(stat, 0, sizeof(*stat));
+    gfx_stat_from_iattx(stat, ia);
+}
+
+static void
+dict_to_rpcgen(gfx_dict *xdict, dict_t *dict)
+{
+    memset(xdict, 0, sizeof(*xdict));
+    dict_to_xdr(dict, xdict);
+}
+
+static void
+fill_gfid(char *gfid)
+{
+    fill_bytes(gfid, 16);
+}
+
+static void
+fill_lookup(native_msg_t *n)
+{
+    fill_gfid(n->m.lookup.gfid);
+    fill_gfid(n->m.lookup.pargfid);
+    n->m.lookup.flags = random();
+    n->m.lookup.bname = fill_string(n->str[0], 256);
+    n->m.lookup.xdata = fill_dict();
+}
+
+static void
+convert_lookup(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->lookup.gfid, n->m.lookup.gfid, 16);
+    memcpy(r->lookup.pargfid, n->m.lookup.pargfid, 16);
+    r->lookup.flags = n->m.lookup.flags;
+    r->lookup.bname = n->m.lookup.bname;
+    dict_to_rpcgen(&r->lookup.xdata, n->m.lookup.xdata);
+}
+
+static void
+fill_stat(native_msg_t *n)
+{
+    fill_gfid(n->m.stat.gfid);
+    n->m.stat.xdata = fill_dict();
+}
+
+static void
+convert_stat(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->stat.gfid, n->m.stat.gfid, 16);
+    dict_to_rpcgen(&r->stat.xdata, n->m.stat.xdata);
+}
+
+static void
+fill_rw(native_msg_t *n)
+{
+    fill_gfid(n->m.rw.gfid);
+    n->m.rw.fd = rnd64();
+    n->m.rw.offset = rnd64();
+    n->m.rw.size = random();
+    n->m.rw.flag = random();
+    n->m.rw.xdata = fill_dict();
+}
+
+static void
+convert_read(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->read_req.gfid, n->m.rw.gfid, 16);
+    r->read_req.fd = n->m.rw.fd;
+    r->read_req.offset = n->m.rw.offset;
+    r->read_req.size = n->m.rw.size;
+    r->read_req.flag = n->m.rw.flag;
+    dict_to_rpcgen(&r->read_req.xdata, n->m.rw.xdata);
+}
+
+static void
+convert_write(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->write_req.gfid, n->m.rw.gfid, 16);
+    r->write_req.fd = n->m.rw.fd;
+    r->write_req.offset = n->m.rw.offset;
+    r->write_req.size = n->m.rw.size;
+    r->write_req.flag = n->m.rw.flag;
+    dict_to_rpcgen(&r->write_req.xdata, n->m.rw.xdata);
+}
+
+static void
+fill_readdirp(native_msg_t *n)
+{
+    fill_gfid(n->m.readdirp.gfid);
+    n->m.readdirp.fd = rnd64();
+    n->m.readdirp.offset = rnd64();
+    n->m.readdirp.size = random();
+    n->m.readdirp.xdata = fill_dict();
+}
+
+static void
+convert_readdirp(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->readdirp.gfid, n->m.readdirp.gfid, 16);
+    r->readdirp.fd = n->m.readdirp.fd;
+    r->readdirp.offset = n->m.readdirp.offset;
+    r->readdirp.size = n->m.readdirp.size;
+    dict_to_rpcgen(&r->readdirp.xdata, n->m.readdirp.xdata);
+}
+
+static void
+fill_getxattr(native_msg_t *n)
+{
+    fill_gfid(n->m.getxattr.gfid);
+    n->m.getxattr.name = fill_string(n->str[0], 256);
+    n->m.getxattr.namelen = strlen(n->m.getxattr.name) + 1;
+    n->m.getxattr.xdata = fill_dict();
+}
+
+static void
+convert_getxattr(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->getxattr.gfid, n->m.getxattr.gfid, 16);
+    r->getxattr.namelen = n->m.getxattr.namelen;
+    r->getxattr.name = n->m.getxattr.name;
+    dict_to_rpcgen(&r->getxattr.xdata, n->m.getxattr.xdata);
+}
+
+static void
+fill_inodelk(native_msg_t *n)
+{
+    gf_proto_flock *flock = &n->m.inodelk.flock;
+
+    fill_gfid(n->m.inodelk.gfid);
+    n->m.inodelk.cmd = random();
+    n->m.inodelk.type = random();
+    flock->type = random();
+    flock->whence = random();
+    flock->start = rnd64();
+    flock->len = rnd64();
+    flock->pid = random();
+    flock->lk_owner.lk_owner_len = rnd(sizeof(n->str[1]));
+    flock->lk_owner.lk_owner_val = n->str[1];
+    fill_bytes(n->str[1], flock->lk_owner.lk_owner_len);
+    n->m.inodelk.volume = fill_string(n->str[0], 256);
+    n->m.inodelk.xdata = fill_dict();
+}
+
+static void
+convert_inodelk(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->inodelk.gfid, n->m.inodelk.gfid, 16);
+    r->inodelk.cmd = n->m.inodelk.cmd;
+    r->inodelk.type = n->m.inodelk.type;
+    r->inodelk.flock = n->m.inodelk.flock;
+    r->inodelk.volume = n->m.inodelk.volume;
+    dict_to_rpcgen(&r->inodelk.xdata, n->m.inodelk.xdata);
+}
+
+static void
+fill_xattrop(native_msg_t *n)
+{
+    fill_gfid(n->m.xattrop.gfid);
+    n->m.xattrop.flags = random();
+    n->m.xattrop.dict = fill_dict();
+    n->m.xattrop.xdata = fill_dict();
+}
+
+static void
+convert_xattrop(native_msg_t *n, rpcgen_msg_t *r)
+{
+    memcpy(r->xattrop.gfid, n->m.xattrop.gfid, 16);
+    r->xattrop.flags = n->m.xattrop.flags;
+    dict_to_rpcgen(&r->xattrop.dict, n->m.xattrop.dict);
+    dict_to_rpcgen(&r->xattrop.xdata, n->m.xattrop.xdata);
+}
+
+/* the responses all start the same way */
+static void
+fill_rsp(native_msg_t *n)
+{
+    n->m.common.op_ret = (int)random() - (RAND_MAX / 2);
+    n->m.common.op_errno = random();
+    n->m.common.xdata = fill_dict();
+}
+
+static void
+convert_common(native_msg_t *n, rpcgen_msg_t *r)
+{
+    r->common.op_ret = n->m.common.op_ret;
+    r->common.op_errno = n->m.common.op_errno;
+    dict_to_rpcgen(&r->common.xdata, n->m.common.xdata);
+}
+
+static void
+convert_iatt(native_msg_t *n, rpcgen_msg_t *r)
+{
+    r->iatt.op_ret = n->m.iatt.op_ret;
+    r->iatt.op_errno = n->m.iatt.op_errno;
+    dict_to_rpcgen(&r->iatt.xdata, n->m.iatt.xdata);
+    iatt_to_rpcgen(&r->iatt.stat, n->m.iatt.stat);
+}
+
+static void
+convert_2iatt(native_msg_t *n, rpcgen_msg_t *r)
+{
+    r->iatt2.op_ret = n->m.iatt2.op_ret;
+    r->iatt2.op_errno = n->m.iatt2.op_errno;
+    dict_to_rpcgen(&r->iatt2.xdata, n->m.iatt2.xdata);
+    iatt_to_rpcgen(&r->iatt2.prestat, n->m.iatt2.prestat);
+    iatt_to_rpcgen(&r->iatt2.poststat, n->m.iatt2.poststat);
+}
+
+static void
+fill_dict_rsp(native_msg_t *n)
+{
+    fill_rsp(n);
+    n->m.dict.dict = fill_dict();
+}
+
+static void
+convert_dict(native_msg_t *n, rpcgen_msg_t *r)
+{
+    r->dict.op_ret = n->m.dict.op_ret;
+    r->dict.op_errno = n->m.dict.op_errno;
+    dict_to_rpcgen(&r->dict.xdata, n->m.dict.xdata);
+    dict_to_rpcgen(&r->dict.dict, n->m.dict.dict);
+    iatt_to_rpcgen(&r->dict.prestat, n->m.dict.prestat);
+    iatt_to_rpcgen(&r->dict.poststat, n->m.dict.poststat);
+}
+
+static void
+fill_read_rsp(native_msg_t *n)
+{
+    n->m.read.op_ret = (int)random() - (RAND_MAX / 2);
+    n->m.read.op_errno = random();
+    n->m.read.size = random();
+    n->m.read.xdata = fill_dict();
+}
+
+static void
+convert_read_rsp(native_msg_t *n, rpcgen_msg_t *r)
+{
+    r->read.op_ret = n->m.read.op_ret;
+    r->read.op_errno = n->m.read.op_errno;
+    iatt_to_rpcgen(&r->read.stat, n->m.read.stat);
+    r->read.size = n->m.read.size;
+    dict_to_rpcgen(&r->read.xdata, n->m.read.xdata);
+}
+
+static void
+fill_readdirp_rsp(native_msg_t *n)
+{
+    gf_dirent_t *entry = NULL;
+    char name[256];
+    int count = rnd(16);
+    int i = 0;
+
+    fill_rsp(n);
+    for (i = 0; i < count; i++) {
+        /* the names are not checked, so an empty one is fine */
+        entry = gf_dirent_for_name(fill_string(name, sizeof(name)));
+        entry->d_ino = rnd64();
+        entry->d_off = rnd64();
+        entry->d_len = random();
+        entry->d_type = random();
+        fill_iatt(&entry->d_stat);
+        entry->dict = fill_dict();
+        list_add_tail(&entry->list, &n->entries.list);
+    }
+}
+
+static void
+convert_readdirp_rsp(native_msg_t *n, rpcgen_msg_t *r)
+{
+    gf_dirent_t *entry = NULL;
+    gfx_dirplist *trav = NULL;
+    gfx_dirplist **prev = &r->dirents.reply;
+
+    r->dirents.op_ret = n->m.dirents.op_ret;
+    r->dirents.op_errno = n->m.dirents.op_errno;
+    dict_to_rpcgen(&r->dirents.xdata, n->m.dirents.xdata);
+
+    list_for_each_entry(entry, &n->entries.list, list)
+    {
+        trav = GF_CALLOC(1, sizeof(*trav), gf_common_mt_char);
+        trav->d_ino = entry->d_ino;
+        trav->d_off = entry->d_off;
+        trav->d_len = entry->d_len;
+        trav->d_type = entry->d_type;
+        trav->name = entry->d_name;
+        iatt_to_rpcgen(&trav->stat, &entry->d_stat);
+        dict_to_rpcgen(&trav->dict, entry->dict);
+        *prev = trav;
+        prev = &trav->nextentry;
+    }
+}
+
+/* what dict_to_xdr() allocated for @r, found back through its bytes */
+static void
+free_rpcgen(const msg_test_t *test, rpcgen_msg_t *r)
+{
+    gfx_dirplist *trav = NULL;
+    gfx_dirplist *next = NULL;
+
+    if (test->convert == convert_lookup)
+        GF_FREE(r->lookup.xdata.pairs.pairs_val);
+    else if (test->convert == convert_stat)
+        GF_FREE(r->stat.xdata.pairs.pairs_val);
+    else if (test->convert == convert_read)
+        GF_FREE(r->read_req.xdata.pairs.pairs_val);
+    else if (test->convert == convert_write)
+        GF_FREE(r->write_req.xdata.pairs.pairs_val);
+    else if (test->convert == convert_readdirp)
+        GF_FREE(r->readdirp.xdata.pairs.pairs_val);
+    else if (test->convert == convert_getxattr)
+        GF_FREE(r->getxattr.xdata.pairs.pairs_val);
+    else if (test->convert == convert_inodelk)
+        GF_FREE(r->inodelk.xdata.pairs.pairs_val);
+    else if (test->convert == convert_xattrop) {
+        GF_FREE(r->xattrop.dict.pairs.pairs_val);
+        GF_FREE(r->xattrop.xdata.pairs.pairs_val);
+    } else if (test->convert == convert_common)
+        GF_FREE(r->common.xdata.pairs.pairs_val);
+    else if (test->convert == convert_iatt)
+        GF_FREE(r->iatt.xdata.pairs.pairs_val);
+    else if (test->convert == convert_2iatt)
+        GF_FREE(r->iatt2.xdata.pairs.pairs_val);
+    else if (test->convert == convert_dict) {
+        GF_FREE(r->dict.xdata.pairs.pairs_val);
+        GF_FREE(r->dict.dict.pairs.pairs_val);
+    } else if (test->convert == convert_read_rsp)
+        GF_FREE(r->read.xdata.pairs.pairs_val);
+    else if (test->convert == convert_readdirp_rsp) {
+        GF_FREE(r->dirents.xdata.pairs.pairs_val);
+        for (trav = r->dirents.reply; trav; trav = next) {
+            next = trav->nextentry;
+            GF_FREE(trav->dict.pairs.pairs_val);
+            GF_FREE(trav);
+        }
+    }
+}
+
+static const msg_test_t tests[] = {
+    {"lookup_req", (xdrproc_t)xdr_gfx_native_lookup_req,
+     (xdrproc_t)xdr_gfx_lookup_req, fill_lookup, convert_lookup,
+     {AT(lookup.xdata), NONE}, {NONE, NONE}, NONE},
+    {"stat_req", (xdrproc_t)xdr_gfx_native_stat_req,
+     (xdrproc_t)xdr_gfx_stat_req, fill_stat, convert_stat,
+     {AT(stat.xdata), NONE}, {NONE, NONE}, NONE},
+    {"read_req", (xdrproc_t)xdr_gfx_native_rw_req,
+     (xdrproc_t)xdr_gfx_read_req, fill_rw, convert_read,
+     {AT(rw.xdata), NONE}, {NONE, NONE}, NONE},
+    {"write_req", (xdrproc_t)xdr_gfx_native_rw_req,
+     (xdrproc_t)xdr_gfx_write_req, fill_rw, convert_write,
+     {AT(rw.xdata), NONE}, {NONE, NONE}, NONE},
+    {"readdirp_req", (xdrproc_t)xdr_gfx_native_readdirp_req,
+     (xdrproc_t)xdr_gfx_readdirp_req, fill_readdirp, convert_readdirp,
+     {AT(readdirp.xdata), NONE}, {NONE, NONE}, NONE},
+    {"getxattr_req", (xdrproc_t)xdr_gfx_native_getxattr_req,
+     (xdrproc_t)xdr_gfx_getxattr_req, fill_getxattr, convert_getxattr,
+     {AT(getxattr.xdata), NONE}, {NONE, NONE}, NONE},
+    {"inodelk_req", (xdrproc_t)xdr_gfx_native_inodelk_req,
+     (xdrproc_t)xdr_gfx_inodelk_req, fill_inodelk, convert_inodelk,
+     {AT(inodelk.xdata), NONE}, {NONE, NONE}, NONE},
+    {"xattrop_req", (xdrproc_t)xdr_gfx_native_xattrop_req,
+     (xdrproc_t)xdr_gfx_xattrop_req, fill_xattrop, convert_xattrop,
+     {AT(xattrop.dict), AT(xattrop.xdata)}, {NONE, NONE}, NONE},
+    {"common_rsp", (xdrproc_t)xdr_gfx_native_common_rsp,
+     (xdrproc_t)xdr_gfx_common_rsp, fill_rsp, convert_common,
+     {AT(common.xdata), NONE}, {NONE, NONE}, NONE},
+    {"iatt_rsp", (xdrproc_t)xdr_gfx_native_iatt_rsp,
+     (xdrproc_t)xdr_gfx_common_iatt_rsp, fill_rsp, convert_iatt,
+     {AT(iatt.xdata), NONE}, {AT(iatt.stat), NONE}, NONE},
+    {"2iatt_rsp", (xdrproc_t)xdr_gfx_native_2iatt_rsp,
+     (xdrproc_t)xdr_gfx_common_2iatt_rsp, fill_rsp, convert_2iatt,
+     {AT(iatt2.xdata), NONE}, {AT(iatt2.prestat), AT(iatt2.poststat)}, NONE},
+    {"dict_rsp", (xdrproc_t)xdr_gfx_native_dict_rsp,
+     (xdrproc_t)xdr_gfx_common_dict_rsp, fill_dict_rsp, convert_dict,
+     {AT(dict.xdata), AT(dict.dict)}, {AT(dict.prestat), AT(dict.poststat)},
+     NONE},
+    {"read_rsp", (xdrproc_t)xdr_gfx_native_read_rsp,
+     (xdrproc_t)xdr_gfx_read_rsp, fill_read_rsp, convert_read_rsp,
+     {AT(read.xdata), NONE}, {AT(read.stat), NONE}, NONE},
+    {"readdirp_rsp", (xdrproc_t)xdr_gfx_native_readdirp_rsp,
+     (xdrproc_t)xdr_gfx_readdirp_rsp, fill_readdirp_rsp,
+     convert_readdirp_rsp, {AT(dirents.xdata), NONE}, {NONE, NONE},
+     AT(dirents.entries)},
+};
+
+static int
+encode(xdrproc_t proc, void *msg, char *buf, size_t size)
+{
+    XDR xdr;
+
+    xdrmem_create(&xdr, buf, size, XDR_ENCODE);
+    if (!proc(&xdr, msg))
+        return -1;
+
+    return xdr_getpos(&xdr);
+}
+
+static int
+decode(const msg_test_t *test, native_msg_t *n, char *buf, size_t len)
+{
+    XDR xdr;
+
+    prepare_native(n, test);
+    xdrmem_create(&xdr, buf, len, XDR_DECODE);
+
+    return test->native(&xdr, n) ? 0 : -1;
+}
+
+/* the pairs of a decoded dict come out in the reverse order, so only the
+ * second round gives the bytes back */
+static int
+check_roundtrip(const msg_test_t *test, char *bytes, int len)
+{
+    static char copy[2][MSG_BUF_SIZE];
+    static char out[MSG_BUF_SIZE];
+    native_msg_t n[2];
+    int i = 0;
+    int ret = -1;
+
+    memcpy(copy[0], bytes, len);
+    CHECK(decode(test, &n[0], copy[0], len) == 0, "decoding failed");
+    CHECK(xdr_native_sizeof(test->native, &n[0]) == len,
+          "decoded message has another size");
+    CHECK(encode(test->native, &n[0], copy[1], MSG_BUF_SIZE) == len,
+          "decoded message has another length");
+
+    if (decode(test, &n[1], copy[1], len) == 0) {
+        ret = encode(test->native, &n[1], out, MSG_BUF_SIZE);
+        if (ret == len && memcmp(out, bytes, len) == 0)
+            ret = 0;
+        else
+            ret = -1;
+        release_native(&n[1], test);
+    }
+    release_native(&n[0], test);
+    CHECK(ret == 0, "decoded message encodes differently");
+
+    /* anything short of the whole message is an error */
+    for (i = 0; i < len; i++) {
+        memcpy(copy[0], bytes, i);
+        ret = decode(test, &n[0], copy[0], i);
+        if (ret == 0)
+            release_native(&n[0], test);
+        CHECK(ret != 0, "%d bytes of %d decoded", i, len);
+        CHECK(!native_residue(&n[0], test), "%d bytes of %d left residue", i,
+              len);
+    }
+
+    /* and damage must not crash */
+    for (i = 0; i < 16; i++) {
+        memcpy(copy[0], bytes, len);
+        copy[0][rnd(len)] ^= 1 << rnd(8);
+        if (i & 1)
+            copy[0][rnd(len)] = random();
+        if (decode(test, &n[0], copy[0], len) == 0)
+            release_native(&n[0], test);
+        CHECK(!native_residue(&n[0], test), "damaged message left residue");
+    }
+
+    return 0;
+}
+
+static int
+check_message(const msg_test_t *test)
+{
+    static char native_buf[MSG_BUF_SIZE];
+    static char rpcgen_buf[MSG_BUF_SIZE];
+    native_msg_t n;
+    rpcgen_msg_t r;
+    int native_len = 0;
+    int rpcgen_len = 0;
+    int ret = -1;
+
+    fill_native(&n, test);
+    memset(&r, 0, sizeof(r));
+    test->convert(&n, &r);
+
+    native_len = encode(test->native, &n, native_buf, MSG_BUF_SIZE);
+    rpcgen_len = encode(test->rpcgen, &r, rpcgen_buf, MSG_BUF_SIZE);
+    if (native_len < 0 || native_len != rpcgen_len) {
+        fprintf(stderr, "%s: encoded %d bytes instead of %d\n", test->name,
+                native_len, rpcgen_len);
+    } else if (memcmp(native_buf, rpcgen_buf, native_len)) {
+        fprintf(stderr, "%s: encoded other bytes\n", test->name);
+    } else if (xdr_native_sizeof(test->native, &n) != native_len) {
+        fprintf(stderr, "%s: sized %zd bytes instead of %d\n", test->name,
+                xdr_native_sizeof(test->native, &n), native_len);
+    } else {
+        ret = check_roundtrip(test, native_buf, native_len);
+    }
+
+    free_rpcgen(test, &r);
+    release_native(&n, test);
+
+    return ret;
+}
+
+static int
+init_ctx(void)
+{
+    glusterfs_ctx_t *ctx = NULL;
+
+    ctx = glusterfs_ctx_new();
+    if (!ctx)
+        return -1;
+    if (glusterfs_globals_init(ctx))
+        return -1;
+    THIS->ctx = ctx;
+    mem_pools_init();
+
+    ctx->dict_pool = mem_pool_new(dict_t, 32);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 512);
+    ctx->dict_data_pool = mem_pool_new(data_t, 512);
+    ctx->logbuf_pool = mem_pool_new(log_buf_t, 256);
+    if (!ctx->dict_pool || !ctx->dict_pair_pool || !ctx->dict_data_pool ||
+        !ctx->logbuf_pool)
+        return -1;
+
+    return gf_log_init(ctx, "/dev/null", NULL);
+}
+
+int
+main(int argc, char *argv[])
+{
+    unsigned int seed = time(NULL);
+    int iterations = 200;
+    size_t t = 0;
+    int i = 0;
+
+    if (argc > 1)
+        iterations = atoi(argv[1]);
+    if (argc > 2)
+        seed = strtoul(argv[2], NULL, 0);
+
+    if (init_ctx()) {
+        fprintf(stderr, "cannot set up a context\n");
+        return 1;
+    }
+
+    srandom(seed);
+    for (i = 0; i < iterations; i++) {
+        for (t = 0; t < sizeof(tests) / sizeof(tests[0]); t++) {
+            if (check_message(&tests[t])) {
+                fprintf(stderr, "failed at iteration %d with seed %u\n", i,
+                        seed);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# The native XDR routines of the hot fops must put on the wire exactly what
+# the rpcgen ones do, and survive truncated and damaged messages.
+
+. $(dirname $0)/../include.rc
+
+cleanup;
+
+TEST build_tester $(dirname $0)/xdr-native.c -D_FILE_OFFSET_BITS=64 \
+     -D_GNU_SOURCE -DGF_LINUX_HOST_OS -include $(dirname $0)/../../config.h \
+     -I/usr/include/tirpc -lglusterfs -lgfxdr -ltirpc
+TEST $(dirname $0)/xdr-native 100
+
+cleanup_tester $(dirname $0)/xdr-native
+
+cleanup;
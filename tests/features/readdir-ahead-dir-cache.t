@@ -0,0 +1,69 @@
+#!/bin/bash
+#
+# Test the readdir-ahead directory listing cache. Listings are served from
+# memory after the first ls, entry operations from the mount are applied to
+# the cached listing and changes made behind the mount's back are picked up
+# once the listing expires.
+#
+###
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+
+cleanup;
+
+TEST glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/$V0
+TEST $CLI volume set $V0 readdir-ahead on
+TEST $CLI volume set $V0 rda-dir-cache on
+TEST $CLI volume set $V0 rda-dir-cache-timeout 600
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST mkdir $M0/test
+for i in $(seq 0 99)
+do
+        touch $M0/test/$i
+done
+
+count=`ls -1 $M0/test | wc -l`
+TEST [ $count -eq 100 ]
+
+# second listing comes from the cache
+count=`ls -1 $M0/test | wc -l`
+TEST [ $count -eq 100 ]
+TEST [ $(get_statedump_key "$mount_dump" dir_cache_hits) -ge 1 ]
+
+# entry operations through the mount patch the cached listing
+TEST touch $M0/test/new
+TEST mkdir $M0/test/newdir
+TEST rm -f $M0/test/0
+TEST mv $M0/test/1 $M0/test/renamed
+count=`ls -1 $M0/test | wc -l`
+TEST [ $count -eq 101 ]
+TEST ls $M0/test/renamed
+EXPECT "^0$" echo $(ls -1 $M0/test | grep -c "^1$")
+TEST [ $(get_statedump_key "$mount_dump" dir_cache_patches) -ge 4 ]
+
+# a change on the brick is seen once the listing expires
+TEST $CLI volume set $V0 rda-dir-cache-timeout 1
+TEST mkdir $M0/expire
+TEST touch $M0/expire/file
+count=`ls -1 $M0/expire | wc -l`
+TEST [ $count -eq 1 ]
+TEST touch $B0/$V0/expire/on-brick
+sleep 2
+count=`ls -1 $M0/expire | wc -l`
+TEST [ $count -eq 2 ]
+
+TEST rm -rf $M0/test $M0/expire
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0;
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+
+cleanup;
@@ -0,0 +1,58 @@
+#!/bin/bash
+
+# Over SSL, each connection reports in statedumps whether the kernel or
+# OpenSSL handles the records; with ssl.ktls off it is always OpenSSL, which
+# then reads ahead and gathers small writes into fewer records.
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+mount_dump="generate_mount_statedump $V0 $M0"
+. $(dirname $0)/../ssl.rc
+
+cleanup;
+
+TEST create_self_signed_certs
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}0
+TEST $CLI volume set $V0 server.ssl on
+TEST $CLI volume set $V0 client.ssl on
+TEST $CLI volume set $V0 auth.ssl-allow Anyone
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume start $V0
+
+TEST dd if=/dev/urandom of=$B0/random bs=128k count=64
+
+# whichever way the host supports
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+EXPECT_NOT "none" get_statedump_key "$mount_dump" connection.0.crypto
+TEST cp $B0/random $M0/random
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+TEST cmp $B0/random $M0/random
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# and in userspace
+TEST $CLI volume set $V0 ssl.ktls off
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" get_statedump_key "$mount_dump" connected
+EXPECT "openssl" get_statedump_key "$mount_dump" connection.0.crypto
+TEST cp $B0/random $M0/random2
+TEST cmp $B0/random $M0/random2
+TEST [ $(get_statedump_key "$mount_dump" connection.0.crypto_write_bps) -gt 0 ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+TEST $CLI volume stop $V0
+TEST $CLI volume delete $V0
+rm -f $B0/random
+
+cleanup;
@@ -171,8 +171,11 @@ afr_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
     loc_copy(&local->loc, loc);
     local->fd_ctx = fd_ctx;
     fd_ctx->flags = flags;
-    if (xdata)
+    if (xdata) {
+        /* data read along with the open could come from a stale brick */
+        dict_del_sizen(xdata, GF_OPEN_READ_SIZE_KEY);
         local->xdata_req = dict_ref(xdata);
+    }
 
     local->cont.open.flags = flags;
     local->cont.open.fd = fd_ref(fd);
@@ -6712,20 +6712,39 @@ dht_queue_readdirp(call_frame_t *frame, xlator_t *xl, off_t offset,
     }
 }
 
-/* Posix returns op_errno = ENOENT to indicate that there are no more
- * entries
- */
+static void
+dht_readdirp_set_skip_dirs(xlator_t *this, dht_local_t *local,
+                           xlator_t *subvol)
+{
+    dht_conf_t *conf = this->private;
+    int ret = 0;
+
+    if (conf->readdir_optimize != _gf_true)
+        return;
+
+    if (subvol != local->first_up_subvol) {
+        ret = dict_set_int32(local->xattr, GF_READDIR_SKIP_DIRS, 1);
+        if (ret)
+            gf_msg(this->name, GF_LOG_ERROR, 0, DHT_MSG_DICT_SET_FAILED,
+                   "Failed to set dictionary value"
+                   ":key = %s",
+                   GF_READDIR_SKIP_DIRS);
+    } else {
+        dict_del(local->xattr, GF_READDIR_SKIP_DIRS);
+    }
+}
+
+/* Copy the entries of @orig_entries read from @prev that belong to the
+ * aggregated view of the directory into @entries. @next_offset is set to the
+ * offset of the last entry read from @prev, whether it was kept or not.
+ * Returns the number of entries added, or -1 on allocation failure. */
 static int
-dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
-                 int op_errno, gf_dirent_t *orig_entries, dict_t *xdata)
+dht_readdirp_filter(xlator_t *this, dht_local_t *local, xlator_t *prev,
+                    gf_dirent_t *orig_entries, gf_dirent_t *entries,
+                    off_t *next_offset)
 {
-    dht_local_t *local = NULL;
-    gf_dirent_t entries;
     gf_dirent_t *orig_entry = NULL;
     gf_dirent_t *entry = NULL;
-    xlator_t *prev = NULL;
-    xlator_t *next_subvol = NULL;
-    off_t next_offset = 0;
     int count = 0;
     dht_layout_t *layout = NULL;
     dht_conf_t *conf = NULL;
@@ -6738,22 +6757,9 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     inode_t *inode = NULL;
     gf_boolean_t skip_hashed_check = _gf_false;
 
-    INIT_LIST_HEAD(&entries.list);
-
-    prev = cookie;
-    local = frame->local;
-    GF_VALIDATE_OR_GOTO(this->name, local->fd, unwind);
-
-    itable = local->fd->inode->table;
-
     conf = this->private;
-    GF_VALIDATE_OR_GOTO(this->name, conf, unwind);
-
     methods = &(conf->methods);
-
-    if (op_ret <= 0) {
-        goto done;
-    }
+    itable = local->fd->inode->table;
 
     /* Why aren't we skipping DHT entirely in case of a single subvol?
      * Because if this was a larger volume earlier and all but one subvol
@@ -6776,7 +6782,7 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
      * "directory not empty" errors*/
 
     if (layout == NULL)
-        goto done;
+        return 0;
 
     if (conf->readdir_optimize == _gf_true)
         readdir_optimize = 1;
@@ -6785,7 +6791,7 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
 
     list_for_each_entry(orig_entry, (&orig_entries->list), list)
     {
-        next_offset = orig_entry->d_off;
+        *next_offset = orig_entry->d_off;
 
         gf_msg_debug(this->name, 0, "%s: entry = %s, type = %d", prev->name,
                      orig_entry->d_name, orig_entry->d_type);
@@ -6840,7 +6846,7 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     list:
         entry = gf_dirent_for_name(orig_entry->d_name);
         if (!entry) {
-            goto unwind;
+            return -1;
         }
 
         /* Do this if conf->search_unhashed is set to "auto" */
@@ -6921,10 +6927,445 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
         gf_msg_debug(this->name, 0, "%s: Adding entry = %s", prev->name,
                      entry->d_name);
 
-        list_add_tail(&entry->list, &entries.list);
+        list_add_tail(&entry->list, &entries->list);
         count++;
     }
 
+    return count;
+}
+
+static void
+dht_readdirp_unwind(call_frame_t *frame, xlator_t *this, xlator_t *prev,
+                    int op_ret, int op_errno, gf_dirent_t *entries)
+{
+    dht_local_t *local = frame->local;
+
+    /* We need to ensure that only the last subvolume's end-of-directory
+     * notification is respected so that directory reading does not stop
+     * before all subvolumes have been read. That could happen because the
+     * posix for each subvolume sends a ENOENT on end-of-directory but in
+     * distribute we're not concerned only with a posix's view of the
+     * directory but the aggregated namespace' view of the directory.
+     */
+    if (op_ret < 0)
+        op_ret = 0;
+
+    if (prev != dht_last_up_subvol(this))
+        op_errno = 0;
+
+    /* If we are inside a recursive call (or not inside a recursive call but
+     * the cbk is completed before the wind returns), local->queue will be 1.
+     * In this case we cannot destroy 'local' because it will be needed by
+     * the caller of STACK_WIND. In this case, we decrease the value to let
+     * the caller know that the operation has terminated and it must destroy
+     * 'local'. If local->queue 0, we can destroy it here because there are
+     * no other users. */
+    if (uatomic_sub_return(&local->queue, 1) >= 0) {
+        frame->local = NULL;
+    }
+
+    DHT_STACK_UNWIND(readdirp, frame, op_ret, op_errno, entries, NULL);
+}
+
+static int
+dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                 int op_errno, gf_dirent_t *orig_entries, dict_t *xdata);
+
+/* Readdirp fan-out.
+ *
+ * Reading a distributed directory walks the subvolumes one after the other,
+ * so listing a large directory costs one round trip per subvolume per
+ * buffer even when most subvolumes only hold a few entries of it. With
+ * readdir-fanout enabled, as soon as a subvolume reaches its end of
+ * directory the next subvolumes are read concurrently. Their replies are
+ * merged in subvolume order, so the offsets seen by the application are the
+ * same ones the sequential walk produces. Whatever does not fit in the
+ * reply is kept on the fd and handed out to the next readdirp that resumes
+ * from the last returned offset. The number of subvolumes read at once is
+ * bounded by readdir-fanout-buffer. */
+
+/* Stash entries that continue the listing right after @resume. */
+static void
+dht_readdirp_stream_save(xlator_t *this, fd_t *fd, off_t resume,
+                         gf_dirent_t *entries, xlator_t *tail,
+                         gf_boolean_t tail_eod)
+{
+    dht_readdirp_stream_t *stream = NULL;
+    gf_dirent_t stale;
+
+    INIT_LIST_HEAD(&stale.list);
+
+    stream = dht_readdirp_stream_get(this, fd, _gf_true);
+    if (!stream)
+        return;
+
+    LOCK(&fd->lock);
+    {
+        list_splice_init(&stream->entries.list, &stale.list);
+        list_splice_init(&entries->list, &stream->entries.list);
+        stream->resume = resume;
+        stream->tail = tail;
+        stream->tail_eod = tail_eod;
+    }
+    UNLOCK(&fd->lock);
+
+    gf_dirent_free(&stale);
+}
+
+/* Answer a readdirp resuming at @offset from the entries stashed on the fd.
+ * Returns 0 if the request has been answered. */
+static int
+dht_readdirp_stream_serve(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                          size_t size, off_t offset)
+{
+    dht_readdirp_stream_t *stream = NULL;
+    gf_dirent_t entries;
+    gf_dirent_t stale;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *tmp = NULL;
+    size_t filled = 0;
+    int count = 0;
+    int op_errno = 0;
+    gf_boolean_t eod = _gf_false;
+
+    INIT_LIST_HEAD(&entries.list);
+    INIT_LIST_HEAD(&stale.list);
+
+    stream = dht_readdirp_stream_get(this, fd, _gf_false);
+    if (!stream)
+        return -1;
+
+    LOCK(&fd->lock);
+    {
+        if (list_empty(&stream->entries.list))
+            goto unlock;
+
+        if (stream->resume != offset) {
+            /* the application seeked away, the stash is of no use */
+            list_splice_init(&stream->entries.list, &stale.list);
+            goto unlock;
+        }
+
+        list_for_each_entry_safe(entry, tmp, &stream->entries.list, list)
+        {
+            filled += gf_dirent_size(entry->d_name);
+            if (count && filled > size)
+                break;
+            list_del_init(&entry->list);
+            list_add_tail(&entry->list, &entries.list);
+            stream->resume = entry->d_off;
+            count++;
+        }
+
+        eod = list_empty(&stream->entries.list) && stream->tail_eod &&
+              (stream->tail == dht_last_up_subvol(this));
+    }
+unlock:
+    UNLOCK(&fd->lock);
+
+    gf_dirent_free(&stale);
+
+    if (!count)
+        return -1;
+
+    if (eod)
+        op_errno = ENOENT;
+
+    DHT_STACK_UNWIND(readdirp, frame, count, op_errno, &entries, NULL);
+
+    gf_dirent_free(&entries);
+    return 0;
+}
+
+void
+dht_readdirp_fanout_free(dht_readdirp_fanout_t *fanout)
+{
+    int i = 0;
+
+    if (!fanout)
+        return;
+
+    gf_dirent_free(&fanout->entries);
+    for (i = 0; i < fanout->count; i++)
+        gf_dirent_free(&fanout->slot[i].entries);
+
+    GF_FREE(fanout);
+}
+
+static void
+dht_readdirp_fanout_merge(call_frame_t *frame, xlator_t *this)
+{
+    dht_local_t *local = NULL;
+    dht_readdirp_fanout_t *fanout = NULL;
+    dht_readdirp_slot_t *slot = NULL;
+    gf_dirent_t filtered;
+    gf_dirent_t pending;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *tmp = NULL;
+    xlator_t *last = NULL;
+    xlator_t *next_subvol = NULL;
+    off_t next_offset = 0;
+    off_t resume = 0;
+    int reply = 0;
+    int count = 0;
+    int i = 0;
+    gf_boolean_t eod = _gf_true;
+
+    INIT_LIST_HEAD(&pending.list);
+
+    local = frame->local;
+    fanout = local->fanout;
+
+    list_for_each_entry(entry, &fanout->entries.list, list)
+    {
+        resume = entry->d_off;
+        reply++;
+    }
+
+    /* The merged stream stays contiguous only up to the first subvolume
+     * that still has entries to give. */
+    for (i = 0; i < fanout->count && eod; i++) {
+        slot = &fanout->slot[i];
+
+        INIT_LIST_HEAD(&filtered.list);
+        next_offset = 0;
+        count = 0;
+
+        if (slot->op_ret > 0) {
+            count = dht_readdirp_filter(this, local, slot->subvol,
+                                        &slot->entries, &filtered,
+                                        &next_offset);
+            if (count < 0) {
+                gf_dirent_free(&filtered);
+                eod = _gf_false;
+                break;
+            }
+        }
+
+        eod = (next_offset == 0) || (slot->op_errno == ENOENT);
+
+        if (count == 0) {
+            if (!eod) {
+                /* everything read was filtered out, keep reading
+                 * this subvolume sequentially */
+                next_subvol = slot->subvol;
+            }
+            last = slot->subvol;
+            continue;
+        }
+
+        list_for_each_entry_safe(entry, tmp, &filtered.list, list)
+        {
+            list_del_init(&entry->list);
+            if (list_empty(&pending.list) &&
+                (!reply || (fanout->size + gf_dirent_size(entry->d_name) <=
+                            local->size))) {
+                fanout->size += gf_dirent_size(entry->d_name);
+                list_add_tail(&entry->list, &fanout->entries.list);
+                resume = entry->d_off;
+                reply++;
+            } else {
+                list_add_tail(&entry->list, &pending.list);
+            }
+        }
+        last = slot->subvol;
+    }
+
+    if (!list_empty(&pending.list)) {
+        dht_readdirp_stream_save(this, local->fd, resume, &pending, last, eod);
+        eod = _gf_false;
+    }
+
+    if (reply) {
+        dht_readdirp_unwind(frame, this, last, reply, eod ? ENOENT : 0,
+                            &fanout->entries);
+        return;
+    }
+
+    if (next_subvol) {
+        /* resume the sequential walk where the fan-out stopped */
+        dht_readdirp_set_skip_dirs(this, local, next_subvol);
+        dht_queue_readdirp(frame, next_subvol, next_offset, dht_readdirp_cbk);
+        return;
+    }
+
+    if (last && eod)
+        next_subvol = dht_subvol_next(this, last);
+
+    if (!next_subvol) {
+        dht_readdirp_unwind(frame, this, last, 0, eod ? ENOENT : ENOMEM,
+                            &fanout->entries);
+        return;
+    }
+
+    dht_readdirp_set_skip_dirs(this, local, next_subvol);
+    dht_queue_readdirp(frame, next_subvol, 0, dht_readdirp_cbk);
+}
+
+static int
+dht_readdirp_fanout_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                        int op_ret, int op_errno, gf_dirent_t *orig_entries,
+                        dict_t *xdata)
+{
+    dht_local_t *local = NULL;
+    dht_readdirp_fanout_t *fanout = NULL;
+    xlator_t *prev = cookie;
+    int this_call_cnt = 0;
+    int i = 0;
+
+    local = frame->local;
+    fanout = local->fanout;
+
+    for (i = 0; i < fanout->count; i++) {
+        if (fanout->slot[i].subvol != prev)
+            continue;
+
+        /* every subvolume owns its own slot, no locking needed */
+        fanout->slot[i].op_ret = op_ret;
+        fanout->slot[i].op_errno = op_errno;
+        if (op_ret > 0 && orig_entries)
+            list_splice_init(&orig_entries->list,
+                             &fanout->slot[i].entries.list);
+        break;
+    }
+
+    this_call_cnt = dht_frame_return(frame);
+    if (is_last_call(this_call_cnt))
+        dht_readdirp_fanout_merge(frame, this);
+
+    return 0;
+}
+
+/* Read the subvolumes following @prev, which just reached its end of
+ * directory, all at once. @entries is what @prev returned and is moved to
+ * the head of the reply. Returns 0 if the fan-out has been started. */
+static int
+dht_readdirp_fanout(call_frame_t *frame, xlator_t *this, xlator_t *prev,
+                    gf_dirent_t *entries)
+{
+    dht_local_t *local = NULL;
+    dht_conf_t *conf = NULL;
+    dht_readdirp_fanout_t *fanout = NULL;
+    gf_dirent_t *entry = NULL;
+    xlator_t *first_up_subvol = NULL;
+    xlator_t *subvol = NULL;
+    dict_t *xattr = NULL;
+    dict_t *skip_xattr = NULL;
+    fd_t *fd = NULL;
+    size_t size = 0;
+    int first = 0;
+    int width = 0;
+    int i = 0;
+
+    local = frame->local;
+    conf = this->private;
+
+    first = dht_subvol_cnt(this, prev) + 1;
+    if (first <= 0 || first >= conf->subvolume_cnt || !local->size)
+        return -1;
+
+    width = min(conf->readdir_fanout_buffer / local->size,
+                (uint64_t)(conf->subvolume_cnt - first));
+    if (width <= 0)
+        return -1;
+
+    if (!local->xattr)
+        return -1;
+
+    fanout = GF_CALLOC(1, sizeof(*fanout) + width * sizeof(fanout->slot[0]),
+                       gf_dht_mt_readdirp_fanout_t);
+    if (!fanout)
+        return -1;
+
+    INIT_LIST_HEAD(&fanout->entries.list);
+    fanout->count = width;
+    for (i = 0; i < width; i++) {
+        INIT_LIST_HEAD(&fanout->slot[i].entries.list);
+        fanout->slot[i].subvol = conf->subvolumes[first + i];
+    }
+
+    first_up_subvol = local->first_up_subvol;
+    if (conf->readdir_optimize == _gf_true) {
+        /* only the first up subvolume lists directories */
+        skip_xattr = dict_copy_with_ref(local->xattr, NULL);
+        if (!skip_xattr ||
+            dict_set_int32(skip_xattr, GF_READDIR_SKIP_DIRS, 1)) {
+            if (skip_xattr)
+                dict_unref(skip_xattr);
+            GF_FREE(fanout);
+            return -1;
+        }
+        dict_del(local->xattr, GF_READDIR_SKIP_DIRS);
+    }
+
+    list_for_each_entry(entry, &entries->list, list)
+    {
+        fanout->size += gf_dirent_size(entry->d_name);
+    }
+    list_splice_init(&entries->list, &fanout->entries.list);
+
+    gf_msg_debug(this->name, 0, "reading %d subvolumes after %s at once",
+                 width, prev->name);
+
+    /* 'local' can be gone as soon as the last wind is issued */
+    xattr = dict_ref(local->xattr);
+    fd = local->fd;
+    size = local->size;
+    /* a previous fan-out of this request found nothing to return */
+    dht_readdirp_fanout_free(local->fanout);
+    local->fanout = fanout;
+    local->call_cnt = width;
+
+    for (i = 0; i < width; i++) {
+        subvol = conf->subvolumes[first + i];
+        STACK_WIND_COOKIE(frame, dht_readdirp_fanout_cbk, subvol, subvol,
+                          subvol->fops->readdirp, fd, size, 0,
+                          (skip_xattr && subvol != first_up_subvol)
+                              ? skip_xattr
+                              : xattr);
+    }
+
+    dict_unref(xattr);
+    if (skip_xattr)
+        dict_unref(skip_xattr);
+
+    return 0;
+}
+
+/* Posix returns op_errno = ENOENT to indicate that there are no more
+ * entries
+ */
+static int
+dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                 int op_errno, gf_dirent_t *orig_entries, dict_t *xdata)
+{
+    dht_local_t *local = NULL;
+    gf_dirent_t entries;
+    xlator_t *prev = NULL;
+    xlator_t *next_subvol = NULL;
+    off_t next_offset = 0;
+    int count = 0;
+    dht_conf_t *conf = NULL;
+
+    INIT_LIST_HEAD(&entries.list);
+
+    prev = cookie;
+    local = frame->local;
+    GF_VALIDATE_OR_GOTO(this->name, local->fd, unwind);
+
+    conf = this->private;
+    GF_VALIDATE_OR_GOTO(this->name, conf, unwind);
+
+    if (op_ret <= 0) {
+        goto done;
+    }
+
+    count = dht_readdirp_filter(this, local, prev, orig_entries, &entries,
+                                &next_offset);
+    if (count < 0) {
+        goto unwind;
+    }
+
 done:
 
     /* We need to ensure that only the last subvolume's end-of-directory
@@ -6947,10 +7388,19 @@ done:
      *
      * op_ret > 0 and count > 0:
      *   We found some entries. Unwind even if the buffer is not full.
+     *   With readdir-fanout, if this subvol is done, fill the rest of the
+     *   buffer from the following subvols read in parallel.
      *
      */
 
     op_ret = count;
+
+    if (conf->readdir_fanout &&
+        ((next_offset == 0) || (op_errno == ENOENT)) &&
+        (dht_readdirp_fanout(frame, this, prev, &entries) == 0)) {
+        return 0;
+    }
+
     if (count == 0) {
         /* non-zero next_offset means that
          * EOF is not yet hit on the current subvol
@@ -6966,18 +7416,7 @@ done:
             goto unwind;
         }
 
-        if (conf->readdir_optimize == _gf_true) {
-            if (next_subvol != local->first_up_subvol) {
-                ret = dict_set_int32(local->xattr, GF_READDIR_SKIP_DIRS, 1);
-                if (ret)
-                    gf_msg(this->name, GF_LOG_ERROR, 0, DHT_MSG_DICT_SET_FAILED,
-                           "Failed to set dictionary value"
-                           ":key = %s",
-                           GF_READDIR_SKIP_DIRS);
-            } else {
-                dict_del(local->xattr, GF_READDIR_SKIP_DIRS);
-            }
-        }
+        dht_readdirp_set_skip_dirs(this, local, next_subvol);
 
         dht_queue_readdirp(frame, next_subvol, next_offset, dht_readdirp_cbk);
 
@@ -6985,31 +7424,7 @@ done:
     }
 
 unwind:
-    /* We need to ensure that only the last subvolume's end-of-directory
-     * notification is respected so that directory reading does not stop
-     * before all subvolumes have been read. That could happen because the
-     * posix for each subvolume sends a ENOENT on end-of-directory but in
-     * distribute we're not concerned only with a posix's view of the
-     * directory but the aggregated namespace' view of the directory.
-     */
-    if (op_ret < 0)
-        op_ret = 0;
-
-    if (prev != dht_last_up_subvol(this))
-        op_errno = 0;
-
-    /* If we are inside a recursive call (or not inside a recursive call but
-     * the cbk is completed before the wind returns), local->queue will be 1.
-     * In this case we cannot destroy 'local' because it will be needed by
-     * the caller of STACK_WIND. In this case, we decrease the value to let
-     * the caller know that the operation has terminated and it must destroy
-     * 'local'. If local->queue 0, we can destroy it here because there are
-     * no other users. */
-    if (uatomic_sub_return(&local->queue, 1) >= 0) {
-        frame->local = NULL;
-    }
-
-    DHT_STACK_UNWIND(readdirp, frame, op_ret, op_errno, &entries, NULL);
+    dht_readdirp_unwind(frame, this, prev, op_ret, op_errno, &entries);
 
     gf_dirent_free(&entries);
     return 0;
@@ -7182,6 +7597,11 @@ dht_do_readdir(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
     conf = this->private;
 
+    if ((whichop == GF_FOP_READDIRP) && (yoff != 0) &&
+        (dht_readdirp_stream_serve(frame, this, fd, size, yoff) == 0)) {
+        return 0;
+    }
+
     local = dht_local_init(frame, NULL, NULL, whichop);
     if (!local) {
         op_errno = ENOMEM;
@@ -11370,6 +11790,12 @@ dht_release(xlator_t *this, fd_t *fd)
     return dht_fd_ctx_destroy(this, fd);
 }
 
+int32_t
+dht_releasedir(xlator_t *this, fd_t *fd)
+{
+    return dht_fd_ctx_destroy(this, fd);
+}
+
 static int
 dht_pt_mkdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                  int op_errno, inode_t *inode, struct iatt *stbuf,
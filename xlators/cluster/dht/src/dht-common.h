@@ -341,6 +341,7 @@ struct dht_local {
     xlator_t *queue_xl;
     off_t queue_offset;
     int32_t queue;
+    struct dht_readdirp_fanout *fanout;
 
     /* inodelks during filerename for backward compatibility */
     dht_lock_t **rename_inodelk_backward_compatible;
@@ -621,6 +622,10 @@ struct dht_conf {
     gf_boolean_t randomize_by_gfid;
 
     gf_boolean_t ensure_durability;
+
+    /* Read the subvolumes of a directory in parallel in readdirp */
+    gf_boolean_t readdir_fanout;
+    uint64_t readdir_fanout_buffer;
 };
 typedef struct dht_conf dht_conf_t;
 
@@ -669,8 +674,32 @@ typedef struct dht_migrate_info {
     GF_REF_DECL;
 } dht_migrate_info_t;
 
+typedef struct dht_readdirp_slot {
+    xlator_t *subvol;
+    int op_ret;
+    int op_errno;
+    gf_dirent_t entries;
+} dht_readdirp_slot_t;
+
+typedef struct dht_readdirp_fanout {
+    gf_dirent_t entries; /* reply being built */
+    size_t size;         /* bytes accounted in entries */
+    int count;
+    dht_readdirp_slot_t slot[];
+} dht_readdirp_fanout_t;
+
+/* Entries of a fan-out that did not fit in the reply. They continue the
+ * listing right after the offset 'resume'. Protected by fd->lock. */
+typedef struct dht_readdirp_stream {
+    gf_dirent_t entries;
+    off_t resume;
+    xlator_t *tail;         /* subvolume of the last entry */
+    gf_boolean_t tail_eod;  /* tail has no more entries */
+} dht_readdirp_stream_t;
+
 typedef struct dht_fd_ctx {
     uint64_t opened_on_dst;
+    dht_readdirp_stream_t *stream;
     GF_REF_DECL;
 } dht_fd_ctx_t;
 
@@ -1238,6 +1267,15 @@ dht_fd_ctx_destroy(xlator_t *this, fd_t *fd);
 int32_t
 dht_release(xlator_t *this, fd_t *fd);
 
+int32_t
+dht_releasedir(xlator_t *this, fd_t *fd);
+
+dht_readdirp_stream_t *
+dht_readdirp_stream_get(xlator_t *this, fd_t *fd, gf_boolean_t create);
+
+void
+dht_readdirp_fanout_free(dht_readdirp_fanout_t *fanout);
+
 int32_t
 dht_set_fixed_dir_stat(struct iatt *stat);
 
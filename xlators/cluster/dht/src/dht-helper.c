@@ -15,6 +15,10 @@
 static void
 dht_free_fd_ctx(dht_fd_ctx_t *fd_ctx)
 {
+    if (fd_ctx->stream) {
+        gf_dirent_free(&fd_ctx->stream->entries);
+        GF_FREE(fd_ctx->stream);
+    }
     GF_FREE(fd_ctx);
 }
 
@@ -41,6 +45,50 @@ out:
     return ret;
 }
 
+/* Entries read ahead by a readdirp fan-out live in the fd ctx of the
+ * directory. */
+dht_readdirp_stream_t *
+dht_readdirp_stream_get(xlator_t *this, fd_t *fd, gf_boolean_t create)
+{
+    dht_fd_ctx_t *fd_ctx = NULL;
+    dht_readdirp_stream_t *stream = NULL;
+    uint64_t value = 0;
+    int ret = -1;
+
+    LOCK(&fd->lock);
+    {
+        ret = __fd_ctx_get(fd, this, &value);
+        if (ret == 0 && value) {
+            fd_ctx = (dht_fd_ctx_t *)(uintptr_t)value;
+        } else if (create) {
+            fd_ctx = GF_CALLOC(1, sizeof(*fd_ctx), gf_dht_mt_fd_ctx_t);
+            if (!fd_ctx)
+                goto unlock;
+            GF_REF_INIT(fd_ctx, dht_free_fd_ctx);
+            value = (uint64_t)(uintptr_t)fd_ctx;
+            ret = __fd_ctx_set(fd, this, value);
+            if (ret) {
+                GF_FREE(fd_ctx);
+                goto unlock;
+            }
+        } else {
+            goto unlock;
+        }
+
+        if (!fd_ctx->stream && create) {
+            fd_ctx->stream = GF_CALLOC(1, sizeof(*fd_ctx->stream),
+                                       gf_dht_mt_readdirp_stream_t);
+            if (fd_ctx->stream)
+                INIT_LIST_HEAD(&fd_ctx->stream->entries.list);
+        }
+        stream = fd_ctx->stream;
+    }
+unlock:
+    UNLOCK(&fd->lock);
+
+    return stream;
+}
+
 static int
 __dht_fd_ctx_set(xlator_t *this, fd_t *fd, xlator_t *dst)
 {
@@ -802,6 +850,8 @@ dht_local_wipe(dht_local_t *local)
     if (local->ret_cache)
         GF_FREE(local->ret_cache);
 
+    dht_readdirp_fanout_free(local->fanout);
+
     mem_put(local);
 }
 
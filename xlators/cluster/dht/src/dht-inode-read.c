@@ -28,6 +28,24 @@ static int
 dht_common_xattrop2(xlator_t *this, xlator_t *subvol, call_frame_t *frame,
                     int ret);
 
+/* Data read along with the open of a file being migrated may not be the
+ * current one, let the caller read it again. */
+static void
+dht_open_read_check(dict_t *xdata)
+{
+    struct iatt stbuf = {
+        0,
+    };
+
+    if (!xdata || dict_get_iatt(xdata, GF_OPEN_READ_STAT_KEY, &stbuf))
+        return;
+
+    if (IS_DHT_MIGRATION_PHASE1(&stbuf) || IS_DHT_MIGRATION_PHASE2(&stbuf)) {
+        dict_del_sizen(xdata, GF_OPEN_READ_KEY);
+        dict_del_sizen(xdata, GF_OPEN_READ_STAT_KEY);
+    }
+}
+
 static int
 dht_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
              int op_errno, fd_t *fd, dict_t *xdata)
@@ -49,6 +67,7 @@ dht_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     /* Update ctx if the fd has been opened on the target*/
     if (!op_ret && (local->call_cnt == 1)) {
         dht_fd_ctx_set(this, fd, prev);
+        dht_open_read_check(xdata);
         goto out;
     }
 
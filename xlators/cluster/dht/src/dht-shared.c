@@ -479,6 +479,12 @@ dht_reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("ensure-durability", conf->ensure_durability, options,
                      bool, out);
 
+    GF_OPTION_RECONF("readdir-fanout", conf->readdir_fanout, options, bool,
+                     out);
+
+    GF_OPTION_RECONF("readdir-fanout-buffer", conf->readdir_fanout_buffer,
+                     options, size_uint64, out);
+
     if (conf->defrag) {
         if (dict_get_str(options, "rebal-throttle", &temp_str) == 0) {
             ret = dht_configure_throttle(this, conf, temp_str);
@@ -753,6 +759,11 @@ dht_init(xlator_t *this)
 
     GF_OPTION_INIT("ensure-durability", conf->ensure_durability, bool, err);
 
+    GF_OPTION_INIT("readdir-fanout", conf->readdir_fanout, bool, err);
+
+    GF_OPTION_INIT("readdir-fanout-buffer", conf->readdir_fanout_buffer,
+                   size_uint64, err);
+
     if (defrag) {
         defrag->lock_migration_enabled = conf->lock_migration_enabled;
 
@@ -1113,6 +1124,29 @@ struct volume_options dht_options[] = {
      .level = OPT_STATUS_ADVANCED,
      .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
 
+    {.key = {"readdir-fanout"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "Once a subvolume has no more entries of a directory, "
+                    "read the following subvolumes in parallel and merge "
+                    "their entries into the same readdirp reply, instead of "
+                    "visiting them one after the other.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+
+    {.key = {"readdir-fanout-buffer"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = 256 * GF_UNIT_MB,
+     .default_value = "1MB",
+     .description = "Memory a single readdirp may use to read subvolumes in "
+                    "parallel. The number of subvolumes read at once is this "
+                    "value divided by the size of the request.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+
     {.key = {NULL}},
 };
 
@@ -872,7 +872,8 @@ struct xlator_fops fops = {
     .setattr = dht_setattr,
 };
 
-struct xlator_cbks cbks = {.forget = dht_forget};
+struct xlator_cbks cbks = {.releasedir = dht_releasedir,
+                           .forget = dht_forget};
 extern int32_t
 mem_acct_init(xlator_t *this);
 
@@ -1192,6 +1192,10 @@ int32_t
 ec_gf_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
            fd_t *fd, dict_t *xdata)
 {
+    /* bricks only hold fragments, data can't be read along with the open */
+    if (xdata)
+        dict_del_sizen(xdata, GF_OPEN_READ_SIZE_KEY);
+
     ec_open(frame, this, -1, EC_MINIMUM_MIN, default_open_cbk, NULL, loc, flags,
             fd, xdata);
 
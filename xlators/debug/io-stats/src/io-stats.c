@@ -136,6 +136,10 @@ struct ios_global_stats {
     gf_atomic_t block_count_read[IOS_BLOCK_COUNT_SIZE];
     gf_atomic_t fop_hits[GF_FOP_MAXVALUE];
     gf_atomic_t upcall_hits[GF_UPCALL_FLAGS_MAXVALUE];
+    /* readdirp replies the bricks filled, their entries and fill time */
+    gf_atomic_t readdirp_batches;
+    gf_atomic_t readdirp_batch_entries;
+    gf_atomic_t readdirp_batch_usec;
     time_t started_at;
     struct ios_lat latency[GF_FOP_MAXVALUE];
     uint64_t nr_opens;
@@ -484,6 +488,28 @@ ios_bump_read(xlator_t *this, fd_t *fd, size_t len)
     }
 }
 
+static void
+ios_bump_readdirp_batch(xlator_t *this, dict_t *xdata)
+{
+    struct ios_conf *conf = this->private;
+    uint32_t count = 0;
+    uint64_t usec = 0;
+
+    if (!conf || !xdata)
+        return;
+
+    if (dict_get_uint32(xdata, GF_READDIRP_FILL_COUNT_KEY, &count) ||
+        dict_get_uint64(xdata, GF_READDIRP_FILL_USEC_KEY, &usec))
+        return;
+
+    GF_ATOMIC_INC(conf->cumulative.readdirp_batches);
+    GF_ATOMIC_INC(conf->incremental.readdirp_batches);
+    GF_ATOMIC_ADD(conf->cumulative.readdirp_batch_entries, count);
+    GF_ATOMIC_ADD(conf->incremental.readdirp_batch_entries, count);
+    GF_ATOMIC_ADD(conf->cumulative.readdirp_batch_usec, usec);
+    GF_ATOMIC_ADD(conf->incremental.readdirp_batch_usec, usec);
+}
+
 static void
 ios_bump_write(xlator_t *this, fd_t *fd, size_t len)
 {
@@ -1221,6 +1247,14 @@ io_stats_dump_global_to_logfp(xlator_t *this, struct ios_global_stats *stats,
             GF_ATOMIC_GET(stats->data_read));
     ios_log(this, logfp, "  BytesWritten : %" GF_PRI_ATOMIC "\n",
             GF_ATOMIC_GET(stats->data_written));
+    if (GF_ATOMIC_GET(stats->readdirp_batches)) {
+        ios_log(this, logfp,
+                "ReaddirpBatches : %" GF_PRI_ATOMIC " (%" GF_PRI_ATOMIC
+                " entries, %" GF_PRI_ATOMIC " us)\n",
+                GF_ATOMIC_GET(stats->readdirp_batches),
+                GF_ATOMIC_GET(stats->readdirp_batch_entries),
+                GF_ATOMIC_GET(stats->readdirp_batch_usec));
+    }
 
     snprintf(str_header, sizeof(str_header), "%-12s %c", "Block Size", ':');
     snprintf(str_read, sizeof(str_read), "%-12s %c", "Read Count", ':');
@@ -2124,6 +2158,9 @@ io_stats_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         iosstat = NULL;
     }
 
+    if (op_ret > 0)
+        ios_bump_readdirp_batch(this, xdata);
+
     STACK_UNWIND_STRICT(readdirp, frame, op_ret, op_errno, buf, xdata);
     return 0;
 }
@@ -3240,11 +3277,28 @@ int
 io_stats_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                   off_t offset, dict_t *dict)
 {
+    struct ios_conf *conf = this->private;
+    dict_t *xdata = NULL;
+
     frame->local = fd->inode;
     START_FOP_LATENCY(frame);
 
+    /* the brick only reports the size and the time of its batch when
+     * asked, see ios_bump_readdirp_batch() */
+    if (conf && conf->measure_latency) {
+        xdata = dict ? dict_copy_with_ref(dict, NULL) : dict_new();
+        if (xdata &&
+            dict_set_int32_sizen(xdata, GF_READDIRP_FILL_COUNT_KEY, 1)) {
+            dict_unref(xdata);
+            xdata = NULL;
+        }
+    }
+
     STACK_WIND(frame, io_stats_readdirp_cbk, FIRST_CHILD(this),
-               FIRST_CHILD(this)->fops->readdirp, fd, size, offset, dict);
+               FIRST_CHILD(this)->fops->readdirp, fd, size, offset,
+               xdata ? xdata : dict);
+    if (xdata)
+        dict_unref(xdata);
     return 0;
 }
 
@@ -3614,6 +3668,13 @@ io_priv(xlator_t *this)
     gf_proc_dump_write("incremental.data_written", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(conf->incremental.data_written));
 
+    gf_proc_dump_write("cumulative.readdirp_batches", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(conf->cumulative.readdirp_batches));
+    gf_proc_dump_write("cumulative.readdirp_batch_entries", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(conf->cumulative.readdirp_batch_entries));
+    gf_proc_dump_write("cumulative.readdirp_batch_usec", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(conf->cumulative.readdirp_batch_usec));
+
     snprintf(key_prefix_cumulative, GF_DUMP_MAX_BUF_LEN, "%s.cumulative",
              this->name);
     snprintf(key_prefix_incremental, GF_DUMP_MAX_BUF_LEN, "%s.incremental",
@@ -3861,6 +3922,10 @@ ios_init_stats(struct ios_global_stats *stats)
     for (i = 0; i < GF_UPCALL_FLAGS_MAXVALUE; i++)
         GF_ATOMIC_INIT(stats->upcall_hits[i], 0);
 
+    GF_ATOMIC_INIT(stats->readdirp_batches, 0);
+    GF_ATOMIC_INIT(stats->readdirp_batch_entries, 0);
+    GF_ATOMIC_INIT(stats->readdirp_batch_usec, 0);
+
     stats->started_at = gf_time();
 }
 
@@ -4862,6 +4862,10 @@ int
 shard_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
            fd_t *fd, dict_t *xdata)
 {
+    /* the base file only holds the first block of a sharded file */
+    if (xdata)
+        dict_del_sizen(xdata, GF_OPEN_READ_SIZE_KEY);
+
     STACK_WIND(frame, shard_open_cbk, FIRST_CHILD(this),
                FIRST_CHILD(this)->fops->open, loc, flags, fd, xdata);
     return 0;
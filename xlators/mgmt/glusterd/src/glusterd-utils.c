@@ -1986,6 +1986,27 @@ glusterd_set_brick_socket_filepath(glusterd_volinfo_t *volinfo,
     glusterd_set_socket_filepath(sock_filepath, sockpath, len);
 }
 
+/* Where the brick on @hostname:@path takes shared memory connections */
+void
+glusterd_set_brick_shm_filepath(glusterd_volinfo_t *volinfo, char *hostname,
+                                char *path, char *sockpath, size_t len)
+{
+    char volume_dir[PATH_MAX] = "";
+    glusterd_conf_t *priv = THIS->private;
+    char export_path[PATH_MAX] = "";
+    char sock_filepath[PATH_MAX] = "";
+    int32_t slen = 0;
+
+    GLUSTERD_GET_VOLUME_PID_DIR(volume_dir, volinfo, priv);
+    GLUSTERD_REMOVE_SLASH_FROM_PATH(path, export_path);
+    slen = snprintf(sock_filepath, PATH_MAX, "%s/run/%s-%s-shm", volume_dir,
+                    hostname, export_path);
+    if (slen < 0) {
+        sock_filepath[0] = 0;
+    }
+    glusterd_set_socket_filepath(sock_filepath, sockpath, len);
+}
+
 /* connection happens only if it is not already connected,
  * reconnections are taken care by rpc-layer
  */
@@ -2409,6 +2430,7 @@ glusterd_brick_unlink_socket_file(glusterd_volinfo_t *volinfo,
 {
     char path[PATH_MAX] = "";
     char socketpath[PATH_MAX] = "";
+    char shmpath[PATH_MAX] = "";
     xlator_t *this = THIS;
     glusterd_conf_t *priv = NULL;
 
@@ -2419,6 +2441,10 @@ glusterd_brick_unlink_socket_file(glusterd_volinfo_t *volinfo,
     GLUSTERD_GET_VOLUME_DIR(path, volinfo, priv);
     glusterd_set_brick_socket_filepath(volinfo, brickinfo, socketpath,
                                        sizeof(socketpath));
+    glusterd_set_brick_shm_filepath(volinfo, brickinfo->hostname,
+                                    brickinfo->path, shmpath,
+                                    sizeof(shmpath));
+    (void)glusterd_unlink_file(shmpath);
 
     return glusterd_unlink_file(socketpath);
 }
@@ -288,6 +288,10 @@ glusterd_compute_cksum(glusterd_volinfo_t *volinfo, gf_boolean_t is_quota_conf);
 void
 glusterd_set_socket_filepath(char *sock_filepath, char *sockpath, size_t len);
 
+void
+glusterd_set_brick_shm_filepath(glusterd_volinfo_t *volinfo, char *hostname,
+                                char *path, char *sockpath, size_t len);
+
 struct rpc_clnt *
 glusterd_pending_node_get_rpc(glusterd_pending_node_t *pending_node);
 
@@ -2379,6 +2379,31 @@ out:
     return ret;
 }
 
+/* Sets where clients on the host of the brick may reach it through shared
+ * memory, when the volume lets them. The address check of the brick cannot
+ * tell them apart on a unix socket, so any restriction keeps them on TCP. */
+static int
+volgen_set_shm_path(xlator_t *xl, glusterd_volinfo_t *volinfo,
+                    const char *transt, char *hostname, char *path)
+{
+    char sockpath[PATH_MAX] = "";
+    char *allow = NULL;
+
+    if (strcmp(transt, "tcp") ||
+        !dict_get_str_boolean(volinfo->dict, "transport.shared-memory",
+                              _gf_false) ||
+        dict_get_sizen(volinfo->dict, "auth.reject"))
+        return 0;
+    if (dict_get_str_sizen(volinfo->dict, "auth.allow", &allow) == 0 &&
+        strcmp(allow, "*"))
+        return 0;
+
+    glusterd_set_brick_shm_filepath(volinfo, hostname, path, sockpath,
+                                    sizeof(sockpath));
+
+    return xlator_set_fixed_option(xl, "transport.socket.shm-path", sockpath);
+}
+
 static int
 brick_graph_add_server(volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
                        dict_t *set_dict, glusterd_brickinfo_t *brickinfo)
@@ -2432,6 +2457,7 @@ brick_graph_add_server(volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
     RPC_SET_OPT(xl, SSL_CIPHER_LIST_OPT, "ssl-cipher-list", return -1);
     RPC_SET_OPT(xl, SSL_DH_PARAM_OPT, "ssl-dh-param", return -1);
     RPC_SET_OPT(xl, SSL_EC_CURVE_OPT, "ssl-ec-curve", return -1);
+    RPC_SET_OPT(xl, SSL_KTLS_OPT, "ssl-ktls", return -1);
 
     if (dict_get_str_sizen(volinfo->dict, "transport.address-family",
                            &address_family_data) == 0) {
@@ -2444,6 +2470,11 @@ brick_graph_add_server(volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
         }
     }
 
+    ret = volgen_set_shm_path(xl, volinfo, transt, brickinfo->hostname,
+                              brickinfo->path);
+    if (ret)
+        return -1;
+
     if (username) {
         len = snprintf(key, sizeof(key), "auth.login.%s.allow",
                        brickinfo->path);
@@ -3191,6 +3222,12 @@ volgen_graph_build_client(volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
         }
     }
 
+    if (hostname) {
+        ret = volgen_set_shm_path(xl, volinfo, transt, hostname, subvol);
+        if (ret)
+            goto err;
+    }
+
     ret = dict_get_uint32(set_dict, "trusted-client", &client_type);
 
     if (!ret && (client_type == GF_CLIENT_TRUSTED ||
@@ -3231,6 +3268,7 @@ volgen_graph_build_client(volgen_graph_t *graph, glusterd_volinfo_t *volinfo,
     RPC_SET_OPT(xl, SSL_CIPHER_LIST_OPT, "ssl-cipher-list", goto err);
     RPC_SET_OPT(xl, SSL_DH_PARAM_OPT, "ssl-dh-param", goto err);
     RPC_SET_OPT(xl, SSL_EC_CURVE_OPT, "ssl-ec-curve", goto err);
+    RPC_SET_OPT(xl, SSL_KTLS_OPT, "ssl-ktls", goto err);
 
     return xl;
 err:
@@ -5813,6 +5851,7 @@ glusterd_snapdsvc_generate_volfile(volgen_graph_t *graph,
     RPC_SET_OPT(xl, SSL_CIPHER_LIST_OPT, "ssl-cipher-list", return -1);
     RPC_SET_OPT(xl, SSL_DH_PARAM_OPT, "ssl-dh-param", return -1);
     RPC_SET_OPT(xl, SSL_EC_CURVE_OPT, "ssl-ec-curve", return -1);
+    RPC_SET_OPT(xl, SSL_KTLS_OPT, "ssl-ktls", return -1);
 
     username = glusterd_auth_get_username(volinfo);
     passwd = glusterd_auth_get_password(volinfo);
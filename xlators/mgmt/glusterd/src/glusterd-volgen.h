@@ -57,6 +57,7 @@
 #define SSL_CIPHER_LIST_OPT "ssl.cipher-list"
 #define SSL_DH_PARAM_OPT "ssl.dh-param"
 #define SSL_EC_CURVE_OPT "ssl.ec-curve"
+#define SSL_KTLS_OPT "ssl.ktls"
 
 typedef enum {
     GF_CLIENT_TRUSTED,
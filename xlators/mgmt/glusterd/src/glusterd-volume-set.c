@@ -852,6 +852,14 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/distribute",
      .op_version = 1,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.readdir-fanout",
+     .voltype = "cluster/distribute",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.readdir-fanout-buffer",
+     .voltype = "cluster/distribute",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.rsync-hash-regex",
      .voltype = "cluster/distribute",
      .type = NO_DOC,
@@ -1254,6 +1262,70 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "performance/io-threads",
      .option = "pass-through",
      .op_version = GD_OP_VERSION_4_1_0},
+    {.key = "performance.iot-fair-queueing",
+     .voltype = "performance/io-threads",
+     .option = "fair-queueing",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-client-weight",
+     .voltype = "performance/io-threads",
+     .option = "client-weight",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-client-iops-limit",
+     .voltype = "performance/io-threads",
+     .option = "client-iops-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-client-bandwidth-limit",
+     .voltype = "performance/io-threads",
+     .option = "client-bandwidth-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-self-heal-weight",
+     .voltype = "performance/io-threads",
+     .option = "self-heal-weight",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-self-heal-iops-limit",
+     .voltype = "performance/io-threads",
+     .option = "self-heal-iops-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-self-heal-bandwidth-limit",
+     .voltype = "performance/io-threads",
+     .option = "self-heal-bandwidth-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-rebalance-weight",
+     .voltype = "performance/io-threads",
+     .option = "rebalance-weight",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-rebalance-iops-limit",
+     .voltype = "performance/io-threads",
+     .option = "rebalance-iops-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-rebalance-bandwidth-limit",
+     .voltype = "performance/io-threads",
+     .option = "rebalance-bandwidth-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-bitrot-weight",
+     .voltype = "performance/io-threads",
+     .option = "bitrot-weight",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-bitrot-iops-limit",
+     .voltype = "performance/io-threads",
+     .option = "bitrot-iops-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-bitrot-bandwidth-limit",
+     .voltype = "performance/io-threads",
+     .option = "bitrot-bandwidth-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-internal-weight",
+     .voltype = "performance/io-threads",
+     .option = "internal-weight",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-internal-iops-limit",
+     .voltype = "performance/io-threads",
+     .option = "internal-iops-limit",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.iot-internal-bandwidth-limit",
+     .voltype = "performance/io-threads",
+     .option = "internal-bandwidth-limit",
+     .op_version = GD_OP_VERSION_11_0},
 
     /* Other perf xlators' options */
     {.key = "performance.io-cache-pass-through",
@@ -1293,6 +1365,46 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "ctime-invalidation",
      .op_version = GD_OP_VERSION_5_0,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.quick-read-cache-dedup",
+     .voltype = "performance/quick-read",
+     .option = "cache-dedup",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.quick-read-cache-compression",
+     .voltype = "performance/quick-read",
+     .option = "cache-compression",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-dir",
+     .voltype = "performance/disk-cache",
+     .option = "cache-dir",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-size",
+     .voltype = "performance/disk-cache",
+     .option = "cache-size",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-block-size",
+     .voltype = "performance/disk-cache",
+     .option = "block-size",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-max-file-size",
+     .voltype = "performance/disk-cache",
+     .option = "max-file-size",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-timeout",
+     .voltype = "performance/disk-cache",
+     .option = "cache-timeout",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.disk-cache-pass-through",
+     .voltype = "performance/disk-cache",
+     .option = "pass-through",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "performance.flush-behind",
      .voltype = "performance/write-behind",
      .option = "flush-behind",
@@ -1373,6 +1485,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "read-after-open",
      .op_version = 3,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.read-in-open",
+     .voltype = "performance/open-behind",
+     .option = "read-in-open",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "performance.read-in-open-size",
+     .voltype = "performance/open-behind",
+     .option = "read-in-open-size",
+     .op_version = GD_OP_VERSION_11_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "performance.open-behind-pass-through",
         .voltype = "performance/open-behind",
@@ -1527,6 +1649,61 @@ struct volopt_map_entry glusterd_volopt_map[] = {
                     "necessary for stricter lock complaince as bricks "
                     "cleanup any granted locks when a client "
                     "disconnects."},
+    {.key = "client.sparse-read",
+     .voltype = "protocol/client",
+     .option = "sparse-read",
+     .value = "off",
+     .op_version = GD_OP_VERSION_11_0,
+     .validate_fn = validate_boolean,
+     .type = GLOBAL_DOC,
+     .description = "When set, bricks leave the holes of the range out "
+                    "of the data of read replies, and the zeroes are "
+                    "filled in on the client."},
+    {.key = "client.connection-count",
+     .voltype = "protocol/client",
+     .option = "connection-count",
+     .value = "1",
+     .op_version = GD_OP_VERSION_11_0,
+     .type = GLOBAL_DOC,
+     .description = "Number of connections to each brick. Reads are spread "
+                    "over all of them, the other requests made on an fd go "
+                    "on the connection of the file, locks and all other "
+                    "requests on the first one."},
+    {.key = "client.batch-window",
+     .voltype = "protocol/client",
+     .option = "batch-window",
+     .value = "0",
+     .op_version = GD_OP_VERSION_11_0,
+     .type = GLOBAL_DOC,
+     .description = "Microseconds a LOOKUP, STAT, ACCESS, READLINK, GETXATTR "
+                    "or STATFS request waits for others to go to the brick "
+                    "with it in a single BATCH call. 0 sends each request on "
+                    "its own."},
+    {.key = "client.batch-size",
+     .voltype = "protocol/client",
+     .option = "batch-size",
+     .value = "16",
+     .op_version = GD_OP_VERSION_11_0,
+     .type = GLOBAL_DOC,
+     .description = "Most requests sent to a brick in a BATCH call."},
+    {.key = "client.transport-compression",
+     .voltype = "protocol/client",
+     .option = "transport.socket.compression",
+     .value = "off",
+     .op_version = GD_OP_VERSION_11_0,
+     .type = GLOBAL_DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .description = "Compress the traffic with the bricks with this "
+                    "algorithm (zlib, lz4 or zstd) when they have "
+                    "server.transport-compression on."},
+    {.key = "client.transport-compression-threshold",
+     .voltype = "protocol/client",
+     .option = "transport.socket.compression-threshold",
+     .value = "512",
+     .op_version = GD_OP_VERSION_11_0,
+     .type = GLOBAL_DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .description = "Requests smaller than this are sent as they are."},
 
     /* Although the following option is named ta-remote-port but it will be
      * added as remote-port in client volfile for ta-bricks only.
@@ -1590,6 +1767,28 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "rpc.outstanding-rpc-limit",
      .type = GLOBAL_DOC,
      .op_version = 3},
+    {.key = "server.admission-control",
+     .voltype = "protocol/server",
+     .option = "rpc.admission-control",
+     .value = "off",
+     .type = GLOBAL_DOC,
+     .op_version = GD_OP_VERSION_11_0,
+     .description = "Adapt the number of requests each client may have in "
+                    "the brick to how long requests wait there."},
+    {.key = "server.admission-target-delay",
+     .voltype = "protocol/server",
+     .option = "rpc.admission-target-delay",
+     .type = GLOBAL_DOC,
+     .op_version = GD_OP_VERSION_11_0,
+     .description = "Milliseconds requests may wait in the brick before "
+                    "the busiest clients get a lower limit."},
+    {.key = "server.admission-interval",
+     .voltype = "protocol/server",
+     .option = "rpc.admission-interval",
+     .type = GLOBAL_DOC,
+     .op_version = GD_OP_VERSION_11_0,
+     .description = "Milliseconds between two adjustments of the limits "
+                    "of the admission control."},
     {.key = "server.ssl",
      .voltype = "protocol/server",
      .value = "off",
@@ -1669,6 +1868,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = GD_OP_VERSION_3_10_2,
         .value = "9",
     },
+    {
+        .key = "server.transport-compression",
+        .voltype = "protocol/server",
+        .option = "transport.socket.compression",
+        .op_version = GD_OP_VERSION_11_0,
+        .value = "off",
+        .description = "Let clients compress the traffic with the brick "
+                       "with the algorithm they ask for. Any of zlib, lz4 "
+                       "or zstd turns it on.",
+    },
     {
         .key = "transport.listen-backlog",
         .voltype = "protocol/server",
@@ -1730,6 +1939,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .option = "!ssl-ec-curve",
         .op_version = GD_OP_VERSION_3_7_4,
     },
+    {
+        .key = SSL_KTLS_OPT,
+        .voltype = "rpc-transport/socket",
+        .option = "!ssl-ktls",
+        .op_version = GD_OP_VERSION_11_0,
+    },
     {
         .key = "transport.address-family",
         .voltype = "protocol/server",
@@ -1737,8 +1952,27 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = GD_OP_VERSION_3_7_4,
         .type = NO_DOC,
     },
+    {
+        .key = "transport.shared-memory",
+        .voltype = "protocol/server",
+        .option = "!shared-memory",
+        .value = "off",
+        .op_version = GD_OP_VERSION_11_0,
+        .description = "Let clients on the host of a brick exchange messages "
+                       "with it through shared memory instead of TCP. Not "
+                       "used with SSL, or when auth.allow or auth.reject "
+                       "restrict the clients.",
+    },
 
     /* Performance xlators enable/disbable options */
+    {.key = "performance.disk-cache",
+     .voltype = "performance/disk-cache",
+     .option = "!perf",
+     .value = "off",
+     .op_version = GD_OP_VERSION_11_0,
+     .description = "enable/disable the local disk cache of file data in "
+                    "the volume.",
+     .flags = VOLOPT_FLAG_CLIENT_OPT | VOLOPT_FLAG_XLATOR_OPT},
     {.key = "performance.write-behind",
      .voltype = "performance/write-behind",
      .option = "!perf",
@@ -2233,6 +2467,11 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "nfs.drc-size",
      .type = GLOBAL_DOC,
      .op_version = 3},
+    {.key = "nfs.drc-max-memory",
+     .voltype = "nfs/server",
+     .option = "nfs.drc-max-memory",
+     .type = GLOBAL_DOC,
+     .op_version = GD_OP_VERSION_11_0},
     {.key = "nfs.read-size",
      .voltype = "nfs/server",
      .option = "nfs3.read-size",
@@ -2332,6 +2571,12 @@ struct volopt_map_entry glusterd_volopt_map[] = {
     {.key = "storage.linux-io_uring",
      .voltype = "storage/posix",
      .op_version = GD_OP_VERSION_9_0},
+    {.key = "storage.linux-io_uring-rings",
+     .voltype = "storage/posix",
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "storage.linux-io_uring-fixed",
+     .voltype = "storage/posix",
+     .op_version = GD_OP_VERSION_11_0},
     {.key = "storage.batch-fsync-mode",
      .voltype = "storage/posix",
      .op_version = 3},
@@ -2425,6 +2670,46 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .voltype = "storage/posix",
         .op_version = GD_OP_VERSION_4_0_0,
     },
+    {
+        .key = "storage.dir-fd-cache-size",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.readdirp-fill-threads",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.metadata-store",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.punch-zero-writes",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.o-direct-aligned",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.reclaim-rate",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.reclaim-iops",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
+    {
+        .key = "storage.reclaim-min-size",
+        .voltype = "storage/posix",
+        .op_version = GD_OP_VERSION_11_0,
+    },
     {
         .option = "ctime",
         .key = "features.ctime",
@@ -2833,6 +3118,24 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .flags = VOLOPT_FLAG_CLIENT_OPT,
      .op_version = GD_OP_VERSION_3_9_1,
      .validate_fn = validate_rda_cache_limit},
+    {.key = "performance.rda-dir-cache",
+     .voltype = "performance/readdir-ahead",
+     .value = "off",
+     .type = DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.rda-dir-cache-limit",
+     .voltype = "performance/readdir-ahead",
+     .value = "32MB",
+     .type = DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .op_version = GD_OP_VERSION_11_0},
+    {.key = "performance.rda-dir-cache-timeout",
+     .voltype = "performance/readdir-ahead",
+     .value = "1",
+     .type = DOC,
+     .flags = VOLOPT_FLAG_CLIENT_OPT,
+     .op_version = GD_OP_VERSION_11_0},
     {
         .key = "performance.nl-cache-positive-entry",
         .voltype = "performance/nl-cache",
@@ -2046,6 +2046,12 @@ struct volume_options options[] = {
      .default_value = "0x20000",
      .description = "Sets the number of non-idempotent "
                     "requests to cache in drc"},
+    {.key = {"nfs.drc-max-memory"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .default_value = "64MB",
+     .description = "Sets the memory the requests cached in drc and "
+                    "their replies may take, beyond which the oldest "
+                    "ones are evicted"},
     {.key = {"nfs.exports-auth-enable"},
      .type = GF_OPTION_TYPE_BOOL,
      .description = "Set the option to 'on' to enable exports/netgroup "
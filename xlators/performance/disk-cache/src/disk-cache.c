@@ -0,0 +1,1991 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/* disk-cache: keeps blocks of file data read from the volume on a local
+ * disk of the client, where they survive remounts.
+ *
+ * Every cached file has a data file holding its blocks at their natural
+ * offsets and an index recording which blocks are present, together with
+ * the size, mtime and ctime of the file on the volume when the blocks were
+ * read. Those validators are compared with the attributes returned by
+ * lookup, open and readv; any difference drops the cached blocks. Reads
+ * are only served locally within cache-timeout seconds of such a check,
+ * past that they go to the volume, which checks the validators again.
+ * Writes go through to the volume and update the blocks they fully cover.
+ * The index is written back on release, at most every DKC_FLUSH_INTERVAL
+ * seconds, and at shutdown, so after a crash the cache can only miss
+ * blocks, never serve stale ones.
+ */
+
+#include <math.h>
+#include <sys/file.h>
+#include "disk-cache.h"
+#include <glusterfs/statedump.h>
+#include <glusterfs/syscall.h>
+#include <glusterfs/upcall-utils.h>
+
+typedef struct dkc_local {
+    fd_t *fd;
+    uuid_t gfid;
+    uint64_t gen;
+    off_t offset;
+    int32_t flags;
+    struct iovec *vector;
+    int32_t count;
+    struct iobref *iobref;
+    int32_t op_ret;
+    int32_t op_errno;
+    dict_t *xdata;
+} dkc_local_t;
+
+static void
+dkc_local_wipe(dkc_local_t *local)
+{
+    if (!local)
+        return;
+
+    if (local->fd)
+        fd_unref(local->fd);
+
+    GF_FREE(local->vector);
+
+    if (local->iobref)
+        iobref_unref(local->iobref);
+
+    if (local->xdata)
+        dict_unref(local->xdata);
+
+    mem_put(local);
+}
+
+#define DKC_STACK_UNWIND(fop, frame, params...)                                \
+    do {                                                                       \
+        dkc_local_t *__local = NULL;                                           \
+        if (frame) {                                                           \
+            __local = frame->local;                                            \
+            frame->local = NULL;                                               \
+        }                                                                      \
+        STACK_UNWIND_STRICT(fop, frame, params);                               \
+        dkc_local_wipe(__local);                                               \
+    } while (0)
+
+static dkc_local_t *
+dkc_local_init(call_frame_t *frame, xlator_t *this, uuid_t gfid)
+{
+    dkc_local_t *local = NULL;
+
+    local = mem_get0(this->local_pool);
+    if (!local)
+        return NULL;
+
+    if (gfid)
+        gf_uuid_copy(local->gfid, gfid);
+
+    frame->local = local;
+
+    return local;
+}
+
+static void
+dkc_data_path(dkc_private_t *priv, dkc_entry_t *entry, char *path, size_t len)
+{
+    snprintf(path, len, "%s/%02x/%s-%" PRIu64, priv->cache_dir, entry->gfid[0],
+             uuid_utoa(entry->gfid), entry->id);
+}
+
+static void
+dkc_index_path(dkc_private_t *priv, dkc_entry_t *entry, char *path,
+               size_t len)
+{
+    snprintf(path, len, "%s/%02x/%s-%" PRIu64 DKC_INDEX_SUFFIX,
+             priv->cache_dir, entry->gfid[0], uuid_utoa(entry->gfid),
+             entry->id);
+}
+
+static int
+dkc_data_open(dkc_private_t *priv, dkc_entry_t *entry, int flags)
+{
+    char path[PATH_MAX] = {
+        0,
+    };
+
+    dkc_data_path(priv, entry, path, sizeof(path));
+
+    return sys_open(path, flags, 0600);
+}
+
+/* Returns the descriptor of the data file of @entry, which stays open as
+ * long as the entry is unused. The caller must hold a reference. */
+static int
+dkc_entry_fd(dkc_private_t *priv, dkc_entry_t *entry)
+{
+    int fd = -1;
+    int other = -1;
+
+    LOCK(&priv->lock);
+    {
+        fd = entry->fd;
+    }
+    UNLOCK(&priv->lock);
+
+    if (fd >= 0)
+        return fd;
+
+    fd = dkc_data_open(priv, entry, O_RDWR);
+    if (fd < 0)
+        return -1;
+
+    LOCK(&priv->lock);
+    {
+        if (entry->fd < 0)
+            entry->fd = fd;
+        else
+            other = entry->fd;
+    }
+    UNLOCK(&priv->lock);
+
+    if (other >= 0) {
+        sys_close(fd);
+        fd = other;
+    }
+
+    return fd;
+}
+
+static uint32_t
+dkc_hash(uuid_t gfid)
+{
+    return ((gfid[14] << 8) | gfid[15]) % DKC_HASH_SIZE;
+}
+
+static void
+dkc_validators_set(dkc_validators_t *validators, struct iatt *buf)
+{
+    validators->size = buf->ia_size;
+    validators->mtime = buf->ia_mtime;
+    validators->mtime_nsec = buf->ia_mtime_nsec;
+    validators->ctime = buf->ia_ctime;
+    validators->ctime_nsec = buf->ia_ctime_nsec;
+}
+
+static gf_boolean_t
+dkc_validators_match(dkc_validators_t *validators, struct iatt *buf)
+{
+    return (validators->size == buf->ia_size &&
+            validators->mtime == buf->ia_mtime &&
+            validators->mtime_nsec == buf->ia_mtime_nsec &&
+            validators->ctime == buf->ia_ctime &&
+            validators->ctime_nsec == buf->ia_ctime_nsec);
+}
+
+static gf_boolean_t
+dkc_block_test(dkc_entry_t *entry, uint32_t block)
+{
+    return (block < entry->nblocks) &&
+           (entry->bitmap[block / 8] & (1 << (block % 8)));
+}
+
+/* To be called with priv->lock held */
+static void
+__dkc_block_set(dkc_private_t *priv, dkc_entry_t *entry, uint32_t block)
+{
+    if (block >= entry->nblocks || dkc_block_test(entry, block))
+        return;
+
+    entry->bitmap[block / 8] |= (1 << (block % 8));
+    entry->cached++;
+    priv->used += priv->block_size;
+}
+
+/* To be called with priv->lock held */
+static void
+__dkc_block_clear(dkc_private_t *priv, dkc_entry_t *entry, uint32_t block)
+{
+    if (!dkc_block_test(entry, block))
+        return;
+
+    entry->bitmap[block / 8] &= ~(1 << (block % 8));
+    entry->cached--;
+    priv->used -= priv->block_size;
+}
+
+/* Adapt the bitmap of @entry to a file size of @size. To be called with
+ * priv->lock held */
+static int
+__dkc_entry_resize(dkc_private_t *priv, dkc_entry_t *entry, uint64_t size)
+{
+    uint64_t old_size = entry->validators.size;
+    uint32_t nblocks = 0;
+    uint32_t block = 0;
+    unsigned char *bitmap = NULL;
+    size_t old_bytes = 0;
+    size_t bytes = 0;
+
+    nblocks = (size + priv->block_size - 1) / priv->block_size;
+
+    /* a partial last block does not hold the data that now follows it */
+    if ((size > old_size) && (old_size % priv->block_size))
+        __dkc_block_clear(priv, entry, old_size / priv->block_size);
+
+    for (block = nblocks; block < entry->nblocks; block++)
+        __dkc_block_clear(priv, entry, block);
+
+    old_bytes = (entry->nblocks + 7) / 8;
+    bytes = (nblocks + 7) / 8;
+    if (bytes > old_bytes || !entry->bitmap) {
+        bitmap = GF_REALLOC(entry->bitmap, bytes ? bytes : 1);
+        if (!bitmap)
+            return -1;
+        memset(bitmap + old_bytes, 0, (bytes ? bytes : 1) - old_bytes);
+        entry->bitmap = bitmap;
+    }
+
+    entry->nblocks = nblocks;
+    entry->validators.size = size;
+
+    return 0;
+}
+
+/* To be called with priv->lock held */
+static dkc_entry_t *
+__dkc_entry_find(dkc_private_t *priv, uuid_t gfid)
+{
+    dkc_entry_t *entry = NULL;
+
+    list_for_each_entry(entry, &priv->hash[dkc_hash(gfid)], hash)
+    {
+        if (gf_uuid_compare(entry->gfid, gfid) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static dkc_entry_t *
+dkc_entry_alloc(void)
+{
+    dkc_entry_t *entry = NULL;
+
+    entry = GF_CALLOC(1, sizeof(*entry), gf_dkc_mt_entry_t);
+    if (!entry)
+        return NULL;
+
+    INIT_LIST_HEAD(&entry->hash);
+    INIT_LIST_HEAD(&entry->lru);
+    pthread_mutex_init(&entry->store_lock, NULL);
+    entry->fd = -1;
+
+    return entry;
+}
+
+static void
+dkc_entry_free(dkc_entry_t *entry)
+{
+    pthread_mutex_destroy(&entry->store_lock);
+    if (entry->fd >= 0)
+        sys_close(entry->fd);
+    GF_FREE(entry->bitmap);
+    GF_FREE(entry);
+}
+
+/* Drop @entry from the cache. Its files are left to dkc_reap(), which
+ * holds a reference until they are gone. To be called with priv->lock
+ * held */
+static void
+__dkc_entry_purge(dkc_private_t *priv, dkc_entry_t *entry)
+{
+    if (entry->purged)
+        return;
+
+    list_del_init(&entry->hash);
+    list_move_tail(&entry->lru, &priv->purged);
+    priv->used -= (uint64_t)entry->cached * priv->block_size;
+    priv->entries--;
+    entry->purged = _gf_true;
+    entry->gen = ++priv->gen;
+    entry->ref++;
+}
+
+/* To be called with priv->lock held */
+static void
+__dkc_entry_put(dkc_entry_t *entry)
+{
+    if (!--entry->ref && entry->purged)
+        dkc_entry_free(entry);
+}
+
+static void
+dkc_entry_put(dkc_private_t *priv, dkc_entry_t *entry)
+{
+    LOCK(&priv->lock);
+    {
+        __dkc_entry_put(entry);
+    }
+    UNLOCK(&priv->lock);
+}
+
+/* Remove the files of the entries purged so far, out of priv->lock */
+static void
+dkc_reap(dkc_private_t *priv)
+{
+    struct list_head purged;
+    dkc_entry_t *entry = NULL;
+    dkc_entry_t *tmp = NULL;
+    char path[PATH_MAX] = {
+        0,
+    };
+
+    INIT_LIST_HEAD(&purged);
+
+    LOCK(&priv->lock);
+    {
+        list_splice_init(&priv->purged, &purged);
+    }
+    UNLOCK(&priv->lock);
+
+    list_for_each_entry_safe(entry, tmp, &purged, lru)
+    {
+        list_del_init(&entry->lru);
+        dkc_index_path(priv, entry, path, sizeof(path));
+        sys_unlink(path);
+        dkc_data_path(priv, entry, path, sizeof(path));
+        sys_unlink(path);
+        dkc_entry_put(priv, entry);
+    }
+}
+
+/* To be called with priv->lock held */
+static void
+__dkc_evict(dkc_private_t *priv)
+{
+    dkc_entry_t *entry = NULL;
+
+    while ((priv->used > priv->cache_size) && !list_empty(&priv->lru)) {
+        entry = list_first_entry(&priv->lru, dkc_entry_t, lru);
+        __dkc_entry_purge(priv, entry);
+        GF_ATOMIC_INC(priv->stats.evictions);
+    }
+}
+
+static void
+dkc_invalidate(xlator_t *this, uuid_t gfid)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+
+    if (gf_uuid_is_null(gfid))
+        return;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, gfid);
+        if (entry) {
+            __dkc_entry_purge(priv, entry);
+            GF_ATOMIC_INC(priv->stats.invalidations);
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (entry)
+        dkc_reap(priv);
+}
+
+/* Compare the cached data of a file with its attributes on the volume */
+static void
+dkc_validate(xlator_t *this, struct iatt *buf)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+    gf_boolean_t purged = _gf_false;
+
+    if (!buf || !IA_ISREG(buf->ia_type))
+        return;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, buf->ia_gfid);
+        if (!entry)
+            goto unlock;
+
+        GF_ATOMIC_INC(priv->stats.validations);
+        if (dkc_validators_match(&entry->validators, buf)) {
+            entry->validated = _gf_true;
+            entry->validated_at = gf_time();
+            entry->stat = *buf;
+        } else {
+            __dkc_entry_purge(priv, entry);
+            GF_ATOMIC_INC(priv->stats.invalidations);
+            purged = _gf_true;
+        }
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (purged)
+        dkc_reap(priv);
+}
+
+/* Adopt the attributes of a file after a change made through this client.
+ * Returns a referenced entry, or NULL if the file is not cached or was
+ * changed by somebody else meanwhile. */
+static dkc_entry_t *
+dkc_entry_update(xlator_t *this, uuid_t gfid, struct iatt *prebuf,
+                 struct iatt *postbuf)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+    gf_boolean_t purged = _gf_false;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, gfid);
+        if (!entry)
+            goto unlock;
+
+        if (!prebuf || !postbuf ||
+            !dkc_validators_match(&entry->validators, prebuf) ||
+            (postbuf->ia_size > priv->max_file_size) ||
+            __dkc_entry_resize(priv, entry, postbuf->ia_size)) {
+            __dkc_entry_purge(priv, entry);
+            GF_ATOMIC_INC(priv->stats.invalidations);
+            entry = NULL;
+            purged = _gf_true;
+            goto unlock;
+        }
+
+        dkc_validators_set(&entry->validators, postbuf);
+        entry->stat = *postbuf;
+        entry->gen = ++priv->gen;
+        entry->dirty = _gf_true;
+        entry->ref++;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (purged)
+        dkc_reap(priv);
+
+    return entry;
+}
+
+/* Start caching a file. Returns a referenced entry. */
+static dkc_entry_t *
+dkc_entry_create(xlator_t *this, struct iatt *buf)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+    dkc_entry_t *other = NULL;
+    gf_boolean_t purged = _gf_false;
+    int fd = -1;
+
+    entry = dkc_entry_alloc();
+    if (!entry)
+        return NULL;
+
+    gf_uuid_copy(entry->gfid, buf->ia_gfid);
+    entry->ref = 1;
+    entry->validated = _gf_true;
+    entry->validated_at = entry->flushed = gf_time();
+    entry->dirty = _gf_true;
+    entry->stat = *buf;
+
+    LOCK(&priv->lock);
+    {
+        entry->id = entry->gen = ++priv->gen;
+    }
+    UNLOCK(&priv->lock);
+
+    fd = dkc_data_open(priv, entry, O_CREAT | O_EXCL | O_RDWR);
+    if (fd < 0) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, DKC_MSG_LOCAL_IO_FAILED,
+               "failed to create cache file for %s", uuid_utoa(buf->ia_gfid));
+        GF_ATOMIC_INC(priv->stats.io_errors);
+        dkc_entry_free(entry);
+        return NULL;
+    }
+    entry->fd = fd;
+
+    LOCK(&priv->lock);
+    {
+        other = __dkc_entry_find(priv, buf->ia_gfid);
+        if (other || __dkc_entry_resize(priv, entry, buf->ia_size)) {
+            /* lost a race with another reader, or out of memory */
+            priv->entries++;
+            entry->ref--;
+            __dkc_entry_purge(priv, entry);
+            entry = NULL;
+            purged = _gf_true;
+            goto unlock;
+        }
+
+        dkc_validators_set(&entry->validators, buf);
+        list_add_tail(&entry->hash, &priv->hash[dkc_hash(entry->gfid)]);
+        list_add_tail(&entry->lru, &priv->lru);
+        priv->entries++;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (purged)
+        dkc_reap(priv);
+
+    return entry;
+}
+
+/* Write the blocks of [@offset, @offset + @len) held in @vector that are
+ * complete for a file of @size into the cache, and mark them present,
+ * unless @entry changed since @gen. Stores of an entry are serialized and
+ * check @gen before writing, so data read before a change cannot land in
+ * the file after the data of the change. */
+static void
+dkc_store_blocks(xlator_t *this, dkc_entry_t *entry, uint64_t gen,
+                 off_t offset, size_t len, struct iovec *vector, int count,
+                 uint64_t size)
+{
+    dkc_private_t *priv = this->private;
+    struct iovec *subset = NULL;
+    uint64_t bs = priv->block_size;
+    uint64_t start = 0;
+    uint64_t end = 0;
+    uint32_t first = 0;
+    uint32_t block = 0;
+    gf_boolean_t stale = _gf_false;
+    int fd = -1;
+    int cnt = 0;
+    ssize_t ret = -1;
+
+    first = (offset + bs - 1) / bs;
+    start = first * bs;
+
+    /* a short last block is complete if the data reaches the end of file */
+    if (offset + len >= size)
+        end = size;
+    else
+        end = ((offset + len) / bs) * bs;
+
+    if (end <= start)
+        return;
+
+    cnt = iov_subset(vector, count, start - offset, end - start, &subset, 0);
+    if (cnt <= 0)
+        return;
+
+    pthread_mutex_lock(&entry->store_lock);
+
+    LOCK(&priv->lock);
+    {
+        stale = entry->purged || entry->gen != gen;
+    }
+    UNLOCK(&priv->lock);
+
+    if (stale)
+        goto out;
+
+    fd = dkc_entry_fd(priv, entry);
+    if (fd >= 0)
+        ret = sys_pwritev(fd, subset, cnt, start);
+
+    LOCK(&priv->lock);
+    {
+        if (ret != (ssize_t)(end - start)) {
+            GF_ATOMIC_INC(priv->stats.io_errors);
+            __dkc_entry_purge(priv, entry);
+            goto unlock;
+        }
+
+        if (entry->purged || entry->gen != gen)
+            goto unlock;
+
+        for (block = first; block * bs < end; block++) {
+            __dkc_block_set(priv, entry, block);
+            GF_ATOMIC_INC(priv->stats.blocks_stored);
+        }
+        entry->dirty = _gf_true;
+        list_move_tail(&entry->lru, &priv->lru);
+
+        __dkc_evict(priv);
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    dkc_reap(priv);
+out:
+    pthread_mutex_unlock(&entry->store_lock);
+    GF_FREE(subset);
+}
+
+/* Write the index of @entry if it is behind. Data is synced first so that
+ * the index never points at blocks that did not reach the disk. */
+static void
+dkc_entry_flush(xlator_t *this, dkc_private_t *priv, dkc_entry_t *entry)
+{
+    dkc_index_header_t *header = NULL;
+    char path[PATH_MAX] = {
+        0,
+    };
+    char tmp[PATH_MAX] = {
+        0,
+    };
+    gf_boolean_t purged = _gf_false;
+    size_t bytes = 0;
+    size_t size = 0;
+    int fd = -1;
+    int ret = -1;
+
+    LOCK(&priv->lock);
+    {
+        if (!entry->dirty || entry->purged)
+            goto unlock;
+
+        bytes = (entry->nblocks + 7) / 8;
+        size = sizeof(*header) + bytes;
+        header = GF_CALLOC(1, size, gf_dkc_mt_bitmap_t);
+        if (!header)
+            goto unlock;
+
+        header->magic = DKC_INDEX_MAGIC;
+        header->block_size = priv->block_size;
+        header->id = entry->id;
+        gf_uuid_copy(header->gfid, entry->gfid);
+        header->validators = entry->validators;
+        header->nblocks = entry->nblocks;
+        memcpy((char *)header + sizeof(*header), entry->bitmap, bytes);
+
+        entry->dirty = _gf_false;
+        entry->ref++;
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (!header)
+        return;
+
+    fd = dkc_entry_fd(priv, entry);
+    if (fd < 0)
+        goto out;
+    ret = sys_fdatasync(fd);
+    if (ret)
+        goto out;
+
+    dkc_index_path(priv, entry, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    /* O_EXCL keeps a concurrent flush of the same entry out */
+    fd = sys_open(tmp, O_CREAT | O_EXCL | O_WRONLY, 0600);
+    if (fd < 0) {
+        ret = -1;
+        goto out;
+    }
+
+    ret = (sys_write(fd, header, size) == size) ? 0 : -1;
+    sys_close(fd);
+    if (!ret)
+        ret = sys_rename(tmp, path);
+    if (ret)
+        sys_unlink(tmp);
+
+out:
+    if (ret)
+        gf_msg(this->name, GF_LOG_WARNING, errno, DKC_MSG_INDEX_WRITE_FAILED,
+               "failed to write cache index for %s", uuid_utoa(entry->gfid));
+
+    LOCK(&priv->lock);
+    {
+        if (ret)
+            entry->dirty = _gf_true;
+        else
+            entry->flushed = gf_time();
+        purged = entry->purged;
+    }
+    UNLOCK(&priv->lock);
+
+    /* purged while being written, don't leave the index behind */
+    if (purged)
+        sys_unlink(path);
+
+    dkc_entry_put(priv, entry);
+
+    GF_FREE(header);
+}
+
+static int
+dkc_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, inode_t *inode,
+               struct iatt *buf, dict_t *xdata, struct iatt *postparent)
+{
+    if (op_ret == 0)
+        dkc_validate(this, buf);
+
+    DKC_STACK_UNWIND(lookup, frame, op_ret, op_errno, inode, buf, xdata,
+                     postparent);
+    return 0;
+}
+
+static int
+dkc_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
+{
+    STACK_WIND(frame, dkc_lookup_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->lookup, loc, xdata);
+    return 0;
+}
+
+static int
+dkc_open_fstat_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                   int32_t op_ret, int32_t op_errno, struct iatt *buf,
+                   dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    if (op_ret == 0)
+        dkc_validate(this, buf);
+    else
+        dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(open, frame, local->op_ret, local->op_errno, local->fd,
+                     local->xdata);
+    return 0;
+}
+
+static int
+dkc_open_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+             int32_t op_errno, fd_t *fd, dict_t *xdata)
+{
+    dkc_private_t *priv = this->private;
+    dkc_local_t *local = frame->local;
+    dkc_entry_t *entry = NULL;
+
+    if (op_ret < 0)
+        goto unwind;
+
+    if (local->flags & O_TRUNC) {
+        dkc_invalidate(this, local->gfid);
+        goto unwind;
+    }
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, local->gfid);
+        if (entry)
+            entry->validated = _gf_false;
+    }
+    UNLOCK(&priv->lock);
+
+    if (!entry)
+        goto unwind;
+
+    /* check the cached blocks against the file before they are used */
+    local->op_ret = op_ret;
+    local->op_errno = op_errno;
+    if (xdata)
+        local->xdata = dict_ref(xdata);
+
+    STACK_WIND(frame, dkc_open_fstat_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->fstat, local->fd, NULL);
+    return 0;
+
+unwind:
+    DKC_STACK_UNWIND(open, frame, op_ret, op_errno, fd, xdata);
+    return 0;
+}
+
+static int
+dkc_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+         fd_t *fd, dict_t *xdata)
+{
+    dkc_private_t *priv = this->private;
+    dkc_local_t *local = NULL;
+
+    if (!priv->active)
+        goto wind;
+
+    local = dkc_local_init(frame, this, fd->inode->gfid);
+    if (!local)
+        goto wind;
+
+    local->fd = fd_ref(fd);
+    local->flags = flags;
+
+    STACK_WIND(frame, dkc_open_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->open, loc, flags, fd, xdata);
+    return 0;
+
+wind:
+    STACK_WIND_TAIL(frame, FIRST_CHILD(this), FIRST_CHILD(this)->fops->open,
+                    loc, flags, fd, xdata);
+    return 0;
+}
+
+/* Serve a read from the cache if all the blocks it covers are present.
+ * Returns 0 if the read was answered. */
+static int
+dkc_readv_cached(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                 off_t offset)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+    struct iobuf *iobuf = NULL;
+    struct iobref *iobref = NULL;
+    struct iovec iov = {
+        0,
+    };
+    struct iatt stat = {
+        0,
+    };
+    uint64_t gen = 0;
+    uint32_t block = 0;
+    size_t len = 0;
+    ssize_t ret = -1;
+    int local_fd = -1;
+    gf_boolean_t purged = _gf_false;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, fd->inode->gfid);
+        if (!entry || !entry->validated)
+            goto unlock;
+
+        /* let the volume check the file again */
+        if (gf_time() - entry->validated_at >= priv->cache_timeout) {
+            entry->validated = _gf_false;
+            goto unlock;
+        }
+
+        if (offset >= entry->validators.size)
+            goto unlock;
+
+        len = min(size, entry->validators.size - offset);
+        if (!len)
+            goto unlock;
+        for (block = offset / priv->block_size;
+             block <= (offset + len - 1) / priv->block_size; block++) {
+            if (!dkc_block_test(entry, block))
+                goto unlock;
+        }
+
+        entry->ref++;
+        gen = entry->gen;
+        stat = entry->stat;
+        list_move_tail(&entry->lru, &priv->lru);
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (!gen)
+        return -1;
+
+    iobuf = iobuf_get2(this->ctx->iobuf_pool, len);
+    if (iobuf) {
+        local_fd = dkc_entry_fd(priv, entry);
+        if (local_fd >= 0)
+            ret = sys_pread(local_fd, iobuf->ptr, len, offset);
+    }
+
+    LOCK(&priv->lock);
+    {
+        if (iobuf && ret != (ssize_t)len) {
+            GF_ATOMIC_INC(priv->stats.io_errors);
+            __dkc_entry_purge(priv, entry);
+            purged = _gf_true;
+        }
+        /* the blocks may have been changed while being read */
+        if (entry->gen != gen)
+            ret = -1;
+        __dkc_entry_put(entry);
+    }
+    UNLOCK(&priv->lock);
+
+    if (purged)
+        dkc_reap(priv);
+
+    if (ret != (ssize_t)len)
+        goto err;
+
+    iobref = iobref_new();
+    if (!iobref)
+        goto err;
+    iobref_add(iobref, iobuf);
+
+    iov.iov_base = iobuf->ptr;
+    iov.iov_len = len;
+
+    GF_ATOMIC_INC(priv->stats.hits);
+    GF_ATOMIC_ADD(priv->stats.bytes_local, len);
+
+    STACK_UNWIND_STRICT(readv, frame, len, 0, &iov, 1, &stat, iobref, NULL);
+
+    iobref_unref(iobref);
+    iobuf_unref(iobuf);
+    return 0;
+
+err:
+    if (iobuf)
+        iobuf_unref(iobuf);
+    return -1;
+}
+
+static int
+dkc_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iovec *vector,
+              int32_t count, struct iatt *stbuf, struct iobref *iobref,
+              dict_t *xdata)
+{
+    dkc_private_t *priv = this->private;
+    dkc_local_t *local = frame->local;
+    dkc_entry_t *entry = NULL;
+    gf_boolean_t purged = _gf_false;
+    uint64_t gen = 0;
+
+    if (op_ret <= 0 || !stbuf || !IA_ISREG(stbuf->ia_type))
+        goto unwind;
+
+    GF_ATOMIC_ADD(priv->stats.bytes_remote, op_ret);
+
+    if (stbuf->ia_size > priv->max_file_size)
+        goto unwind;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, stbuf->ia_gfid);
+        if (entry) {
+            if (entry->gen != local->gen) {
+                /* changed through this client while being read */
+                entry = NULL;
+                goto unlock;
+            }
+            if (!dkc_validators_match(&entry->validators, stbuf)) {
+                __dkc_entry_purge(priv, entry);
+                GF_ATOMIC_INC(priv->stats.invalidations);
+                entry = NULL;
+                purged = _gf_true;
+                goto unlock;
+            }
+            entry->validated = _gf_true;
+            entry->validated_at = gf_time();
+            entry->stat = *stbuf;
+            entry->ref++;
+            gen = entry->gen;
+        } else if (local->gen) {
+            /* dropped while being read */
+            goto unlock;
+        }
+    }
+unlock:
+    UNLOCK(&priv->lock);
+
+    if (purged)
+        dkc_reap(priv);
+
+    if (!entry && !local->gen) {
+        entry = dkc_entry_create(this, stbuf);
+        if (entry)
+            gen = entry->gen;
+    }
+
+    if (!entry)
+        goto unwind;
+
+    dkc_store_blocks(this, entry, gen, local->offset, op_ret, vector, count,
+                     stbuf->ia_size);
+    dkc_entry_put(priv, entry);
+
+unwind:
+    DKC_STACK_UNWIND(readv, frame, op_ret, op_errno, vector, count, stbuf,
+                     iobref, xdata);
+    return 0;
+}
+
+static int
+dkc_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+          off_t offset, uint32_t flags, dict_t *xdata)
+{
+    dkc_private_t *priv = this->private;
+    dkc_local_t *local = NULL;
+    dkc_entry_t *entry = NULL;
+
+    if (!priv->active || (fd->flags & O_DIRECT))
+        goto wind;
+
+    if (dkc_readv_cached(frame, this, fd, size, offset) == 0)
+        return 0;
+
+    GF_ATOMIC_INC(priv->stats.misses);
+
+    local = dkc_local_init(frame, this, fd->inode->gfid);
+    if (!local)
+        goto wind;
+
+    local->offset = offset;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, fd->inode->gfid);
+        if (entry)
+            local->gen = entry->gen;
+    }
+    UNLOCK(&priv->lock);
+
+    STACK_WIND(frame, dkc_readv_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->readv, fd, size, offset, flags, xdata);
+    return 0;
+
+wind:
+    STACK_WIND_TAIL(frame, FIRST_CHILD(this), FIRST_CHILD(this)->fops->readv,
+                    fd, size, offset, flags, xdata);
+    return 0;
+}
+
+static int
+dkc_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+               struct iatt *postbuf, dict_t *xdata)
+{
+    dkc_private_t *priv = this->private;
+    dkc_local_t *local = frame->local;
+    dkc_entry_t *entry = NULL;
+    uint32_t block = 0;
+    uint64_t gen = 0;
+    off_t offset = local->offset;
+
+    if (op_ret < 0) {
+        /* the file may have been partially written */
+        dkc_invalidate(this, local->gfid);
+        goto unwind;
+    }
+
+    entry = dkc_entry_update(this, local->gfid, prebuf, postbuf);
+    if (!entry)
+        goto unwind;
+
+    if (local->fd->flags & O_APPEND)
+        offset = prebuf->ia_size;
+
+    /* nothing of the written range may be served until it is stored */
+    LOCK(&priv->lock);
+    {
+        for (block = offset / priv->block_size;
+             op_ret && block <= (offset + op_ret - 1) / priv->block_size;
+             block++)
+            __dkc_block_clear(priv, entry, block);
+        gen = entry->gen;
+    }
+    UNLOCK(&priv->lock);
+
+    if (op_ret)
+        dkc_store_blocks(this, entry, gen, offset, op_ret, local->vector,
+                         local->count, postbuf->ia_size);
+    dkc_entry_put(priv, entry);
+
+unwind:
+    DKC_STACK_UNWIND(writev, frame, op_ret, op_errno, prebuf, postbuf, xdata);
+    return 0;
+}
+
+static int
+dkc_writev(call_frame_t *frame, xlator_t *this, fd_t *fd, struct iovec *vector,
+           int32_t count, off_t offset, uint32_t flags, struct iobref *iobref,
+           dict_t *xdata)
+{
+    dkc_private_t *priv = this->private;
+    dkc_local_t *local = NULL;
+
+    if (!priv->active)
+        goto wind;
+
+    local = dkc_local_init(frame, this, fd->inode->gfid);
+    if (!local)
+        goto err;
+
+    local->fd = fd_ref(fd);
+    local->offset = offset;
+    local->vector = iov_dup(vector, count);
+    local->count = count;
+    local->iobref = iobref_ref(iobref);
+    if (!local->vector)
+        goto err;
+
+    STACK_WIND(frame, dkc_writev_cbk, FIRST_CHILD(this),
+               FIRST_CHILD(this)->fops->writev, fd, vector, count, offset,
+               flags, iobref, xdata);
+    return 0;
+
+wind:
+    STACK_WIND_TAIL(frame, FIRST_CHILD(this), FIRST_CHILD(this)->fops->writev,
+                    fd, vector, count, offset, flags, iobref, xdata);
+    return 0;
+
+err:
+    DKC_STACK_UNWIND(writev, frame, -1, ENOMEM, NULL, NULL, NULL);
+    return 0;
+}
+
+/* Fops changing the data in ways not worth mirroring drop the cached
+ * blocks once they complete. */
+#define DKC_INVALIDATING_FOP(name, gfid, args...)                              \
+    do {                                                                       \
+        dkc_private_t *__priv = this->private;                                 \
+        dkc_local_t *__local = NULL;                                           \
+                                                                               \
+        if (!__priv->active)                                                   \
+            goto wind;                                                         \
+                                                                               \
+        __local = dkc_local_init(frame, this, gfid);                           \
+        if (!__local)                                                          \
+            goto wind;                                                         \
+                                                                               \
+        STACK_WIND(frame, dkc_##name##_cbk, FIRST_CHILD(this),                 \
+                   FIRST_CHILD(this)->fops->name, args);                       \
+        return 0;                                                              \
+                                                                               \
+    wind:                                                                      \
+        STACK_WIND_TAIL(frame, FIRST_CHILD(this),                              \
+                        FIRST_CHILD(this)->fops->name, args);                  \
+        return 0;                                                              \
+    } while (0)
+
+static int
+dkc_truncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(truncate, frame, op_ret, op_errno, prebuf, postbuf,
+                     xdata);
+    return 0;
+}
+
+static int
+dkc_truncate(call_frame_t *frame, xlator_t *this, loc_t *loc, off_t offset,
+             dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(truncate, loc->inode->gfid, loc, offset, xdata);
+}
+
+static int
+dkc_ftruncate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                  struct iatt *postbuf, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(ftruncate, frame, op_ret, op_errno, prebuf, postbuf,
+                     xdata);
+    return 0;
+}
+
+static int
+dkc_ftruncate(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(ftruncate, fd->inode->gfid, fd, offset, xdata);
+}
+
+static int
+dkc_fallocate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                  int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                  struct iatt *post, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(fallocate, frame, op_ret, op_errno, pre, post, xdata);
+    return 0;
+}
+
+static int
+dkc_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t keep_size,
+              off_t offset, size_t len, dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(fallocate, fd->inode->gfid, fd, keep_size, offset,
+                         len, xdata);
+}
+
+static int
+dkc_discard_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                struct iatt *post, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(discard, frame, op_ret, op_errno, pre, post, xdata);
+    return 0;
+}
+
+static int
+dkc_discard(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+            size_t len, dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(discard, fd->inode->gfid, fd, offset, len, xdata);
+}
+
+static int
+dkc_zerofill_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *pre,
+                 struct iatt *post, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(zerofill, frame, op_ret, op_errno, pre, post, xdata);
+    return 0;
+}
+
+static int
+dkc_zerofill(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+             off_t len, dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(zerofill, fd->inode->gfid, fd, offset, len, xdata);
+}
+
+static int
+dkc_copy_file_range_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                        int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
+                        struct iatt *prebuf_dst, struct iatt *postbuf_dst,
+                        dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(copy_file_range, frame, op_ret, op_errno, stbuf,
+                     prebuf_dst, postbuf_dst, xdata);
+    return 0;
+}
+
+static int
+dkc_copy_file_range(call_frame_t *frame, xlator_t *this, fd_t *fd_in,
+                    off64_t off_in, fd_t *fd_out, off64_t off_out, size_t len,
+                    uint32_t flags, dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(copy_file_range, fd_out->inode->gfid, fd_in, off_in,
+                         fd_out, off_out, len, flags, xdata);
+}
+
+static int
+dkc_unlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    if (op_ret == 0)
+        dkc_invalidate(this, local->gfid);
+
+    DKC_STACK_UNWIND(unlink, frame, op_ret, op_errno, preparent, postparent,
+                     xdata);
+    return 0;
+}
+
+static int
+dkc_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int xflag,
+           dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(unlink, loc->inode->gfid, loc, xflag, xdata);
+}
+
+static void
+dkc_setattr_done(xlator_t *this, int32_t op_ret, uuid_t gfid,
+                 struct iatt *prebuf, struct iatt *postbuf)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+
+    if (op_ret < 0)
+        return;
+
+    /* ctime moved on, keep the cached blocks valid */
+    entry = dkc_entry_update(this, gfid, prebuf, postbuf);
+    if (entry)
+        dkc_entry_put(priv, entry);
+}
+
+static int
+dkc_setattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                struct iatt *postbuf, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_setattr_done(this, op_ret, local->gfid, prebuf, postbuf);
+
+    DKC_STACK_UNWIND(setattr, frame, op_ret, op_errno, prebuf, postbuf, xdata);
+    return 0;
+}
+
+static int
+dkc_setattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
+            struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(setattr, loc->inode->gfid, loc, stbuf, valid, xdata);
+}
+
+static int
+dkc_fsetattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                 int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
+                 struct iatt *postbuf, dict_t *xdata)
+{
+    dkc_local_t *local = frame->local;
+
+    dkc_setattr_done(this, op_ret, local->gfid, prebuf, postbuf);
+
+    DKC_STACK_UNWIND(fsetattr, frame, op_ret, op_errno, prebuf, postbuf,
+                     xdata);
+    return 0;
+}
+
+static int
+dkc_fsetattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
+             struct iatt *stbuf, int32_t valid, dict_t *xdata)
+{
+    DKC_INVALIDATING_FOP(fsetattr, fd->inode->gfid, fd, stbuf, valid, xdata);
+}
+
+static int
+dkc_release(xlator_t *this, fd_t *fd)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+    gf_boolean_t last = _gf_false;
+    int local_fd = -1;
+
+    if (!priv->active)
+        return 0;
+
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, fd->inode->gfid);
+        if (entry && entry->dirty &&
+            (gf_time() - entry->flushed >= DKC_FLUSH_INTERVAL))
+            entry->ref++;
+        else
+            entry = NULL;
+    }
+    UNLOCK(&priv->lock);
+
+    if (entry) {
+        dkc_entry_flush(this, priv, entry);
+        dkc_entry_put(priv, entry);
+    }
+
+    LOCK(&fd->inode->lock);
+    {
+        last = (fd->inode->fd_count <= 1);
+    }
+    UNLOCK(&fd->inode->lock);
+
+    if (!last)
+        return 0;
+
+    /* don't keep the data file open for a file that is not open any
+     * more, unless a read or write is using it */
+    LOCK(&priv->lock);
+    {
+        entry = __dkc_entry_find(priv, fd->inode->gfid);
+        if (entry && !entry->ref) {
+            local_fd = entry->fd;
+            entry->fd = -1;
+        }
+    }
+    UNLOCK(&priv->lock);
+
+    if (local_fd >= 0)
+        sys_close(local_fd);
+
+    return 0;
+}
+
+static int
+dkc_priv_dump(xlator_t *this)
+{
+    dkc_private_t *priv = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    if (!this || !this->private)
+        return -1;
+
+    priv = this->private;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.disk-cache",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    hits = GF_ATOMIC_GET(priv->stats.hits);
+    misses = GF_ATOMIC_GET(priv->stats.misses);
+
+    gf_proc_dump_write("cache_dir", "%s", priv->cache_dir);
+    gf_proc_dump_write("active", "%d", priv->active);
+    gf_proc_dump_write("cache_size", "%" PRIu64, priv->cache_size);
+    gf_proc_dump_write("block_size", "%" PRIu64, priv->block_size);
+    gf_proc_dump_write("max_file_size", "%" PRIu64, priv->max_file_size);
+    gf_proc_dump_write("cache_used", "%" PRIu64, priv->used);
+    gf_proc_dump_write("files_cached", "%" PRIu64, priv->entries);
+    gf_proc_dump_write("hits", "%" PRIu64, hits);
+    gf_proc_dump_write("misses", "%" PRIu64, misses);
+    gf_proc_dump_write("hit_ratio", "%.2f",
+                       (hits + misses) ? (hits * 100.0) / (hits + misses) : 0);
+    gf_proc_dump_write("bytes_local", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.bytes_local));
+    gf_proc_dump_write("bytes_remote", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.bytes_remote));
+    gf_proc_dump_write("blocks_stored", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.blocks_stored));
+    gf_proc_dump_write("validations", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.validations));
+    gf_proc_dump_write("invalidations", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.invalidations));
+    gf_proc_dump_write("evictions", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.evictions));
+    gf_proc_dump_write("io_errors", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->stats.io_errors));
+
+    return 0;
+}
+
+static int32_t
+dkc_dump_metrics(xlator_t *this, int fd)
+{
+    dkc_private_t *priv = this->private;
+
+    dprintf(fd, "%s.cache_used %" PRIu64 "\n", this->name, priv->used);
+    dprintf(fd, "%s.files_cached %" PRIu64 "\n", this->name, priv->entries);
+    dprintf(fd, "%s.hits %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->stats.hits));
+    dprintf(fd, "%s.misses %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->stats.misses));
+    dprintf(fd, "%s.bytes_local %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->stats.bytes_local));
+    dprintf(fd, "%s.bytes_remote %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->stats.bytes_remote));
+
+    return 0;
+}
+
+static int
+dkc_notify(xlator_t *this, int event, void *data, ...)
+{
+    struct gf_upcall *up_data = NULL;
+    struct gf_upcall_cache_invalidation *up_ci = NULL;
+    dkc_private_t *priv = this->private;
+
+    if ((event == GF_EVENT_UPCALL) && priv && priv->active) {
+        up_data = (struct gf_upcall *)data;
+        if (up_data->event_type == GF_UPCALL_CACHE_INVALIDATION) {
+            up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
+            if (up_ci && (up_ci->flags & UP_WRITE_FLAGS))
+                dkc_invalidate(this, up_data->gfid);
+        }
+    }
+
+    return default_notify(this, event, data);
+}
+
+/* Load the index of a cached file left by a previous run. Anything that
+ * does not match the current configuration is thrown away. */
+static void
+dkc_index_load(xlator_t *this, const char *dir, const char *name)
+{
+    dkc_private_t *priv = this->private;
+    dkc_index_header_t header;
+    dkc_entry_t *entry = NULL;
+    struct stat st = {
+        0,
+    };
+    char path[PATH_MAX] = {
+        0,
+    };
+    size_t bytes = 0;
+    uint32_t block = 0;
+    int fd = -1;
+    int ret = -1;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+
+    fd = sys_open(path, O_RDONLY, 0);
+    if (fd < 0)
+        goto out;
+
+    if (sys_fstat(fd, &st) ||
+        sys_read(fd, &header, sizeof(header)) != sizeof(header))
+        goto out;
+
+    bytes = (header.nblocks + 7) / 8;
+    if ((header.magic != DKC_INDEX_MAGIC) ||
+        (header.block_size != priv->block_size) ||
+        (header.validators.size > priv->max_file_size) ||
+        (header.nblocks !=
+         (header.validators.size + priv->block_size - 1) / priv->block_size) ||
+        (st.st_size != sizeof(header) + bytes))
+        goto out;
+
+    entry = dkc_entry_alloc();
+    if (!entry)
+        goto out;
+
+    gf_uuid_copy(entry->gfid, header.gfid);
+    entry->id = entry->gen = header.id;
+    entry->validators = header.validators;
+    entry->nblocks = header.nblocks;
+    entry->bitmap = GF_CALLOC(1, bytes ? bytes : 1, gf_dkc_mt_bitmap_t);
+    if (!entry->bitmap)
+        goto out;
+
+    if (sys_read(fd, entry->bitmap, bytes) != bytes)
+        goto out;
+
+    dkc_data_path(priv, entry, path, sizeof(path));
+    if (sys_access(path, F_OK))
+        goto out;
+
+    for (block = 0; block < entry->nblocks; block++) {
+        if (dkc_block_test(entry, block))
+            entry->cached++;
+    }
+
+    if (__dkc_entry_find(priv, entry->gfid))
+        goto out;
+
+    list_add_tail(&entry->hash, &priv->hash[dkc_hash(entry->gfid)]);
+    list_add_tail(&entry->lru, &priv->lru);
+    priv->entries++;
+    priv->used += (uint64_t)entry->cached * priv->block_size;
+    priv->gen = max(priv->gen, entry->id);
+    entry = NULL;
+    ret = 0;
+out:
+    if (fd >= 0)
+        sys_close(fd);
+
+    if (ret) {
+        gf_msg_debug(this->name, 0, "discarding cache index %s/%s", dir,
+                     name);
+        if (entry) {
+            dkc_data_path(priv, entry, path, sizeof(path));
+            sys_unlink(path);
+            dkc_entry_free(entry);
+        }
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        sys_unlink(path);
+    }
+}
+
+/* Rebuild the in-memory index from the cache directory. Data files without
+ * an index and leftovers of interrupted index writes are removed. */
+static void
+dkc_cache_load(xlator_t *this)
+{
+    dkc_private_t *priv = this->private;
+    struct dirent *entry = NULL;
+    struct dirent scratch[2] = {
+        {
+            0,
+        },
+    };
+    char dir[PATH_MAX] = {
+        0,
+    };
+    char path[PATH_MAX] = {
+        0,
+    };
+    size_t len = 0;
+    DIR *dirp = NULL;
+    int i = 0;
+
+    for (i = 0; i < 256; i++) {
+        snprintf(dir, sizeof(dir), "%s/%02x", priv->cache_dir, i);
+        dirp = sys_opendir(dir);
+        if (!dirp)
+            continue;
+
+        while ((entry = sys_readdir(dirp, scratch)) != NULL) {
+            if (entry->d_name[0] == '.')
+                continue;
+
+            len = strlen(entry->d_name);
+            if (len > SLEN(DKC_INDEX_SUFFIX) &&
+                !strcmp(entry->d_name + len - SLEN(DKC_INDEX_SUFFIX),
+                        DKC_INDEX_SUFFIX))
+                dkc_index_load(this, dir, entry->d_name);
+        }
+
+        /* second pass: data files whose index is missing */
+        rewinddir(dirp);
+        while ((entry = sys_readdir(dirp, scratch)) != NULL) {
+            if (entry->d_name[0] == '.' || strchr(entry->d_name, '.'))
+                continue;
+
+            snprintf(path, sizeof(path), "%s/%s" DKC_INDEX_SUFFIX, dir,
+                     entry->d_name);
+            if (sys_access(path, F_OK) == 0)
+                continue;
+
+            snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+            sys_unlink(path);
+        }
+
+        rewinddir(dirp);
+        while ((entry = sys_readdir(dirp, scratch)) != NULL) {
+            len = strlen(entry->d_name);
+            if (len > SLEN(".tmp") &&
+                !strcmp(entry->d_name + len - SLEN(".tmp"), ".tmp")) {
+                snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+                sys_unlink(path);
+            }
+        }
+
+        sys_closedir(dirp);
+    }
+
+    __dkc_evict(priv);
+    dkc_reap(priv);
+
+    gf_msg(this->name, GF_LOG_INFO, 0, DKC_MSG_INDEX_LOAD_FAILED,
+           "loaded %" PRIu64 " cached files (%" PRIu64 " bytes) from %s",
+           priv->entries, priv->used, priv->cache_dir);
+}
+
+/* Set up the cache directory of this volume. Only one process may use it
+ * at a time; others run without the cache. */
+static int
+dkc_cache_dir_init(xlator_t *this, const char *cache_dir)
+{
+    dkc_private_t *priv = this->private;
+    char path[PATH_MAX] = {
+        0,
+    };
+    int ret = -1;
+    int i = 0;
+
+    ret = gf_asprintf(&priv->cache_dir, "%s/%s", cache_dir, this->name);
+    if (ret < 0) {
+        priv->cache_dir = NULL;
+        return -1;
+    }
+
+    snprintf(path, sizeof(path), "%s", priv->cache_dir);
+    ret = mkdir_p(path, 0700, _gf_true);
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, DKC_MSG_DIR_CREATE_FAILED,
+               "failed to create cache directory %s", priv->cache_dir);
+        return -1;
+    }
+
+    for (i = 0; i < 256; i++) {
+        snprintf(path, sizeof(path), "%s/%02x", priv->cache_dir, i);
+        if (sys_mkdir(path, 0700) && errno != EEXIST) {
+            gf_msg(this->name, GF_LOG_ERROR, errno, DKC_MSG_DIR_CREATE_FAILED,
+                   "failed to create cache directory %s", path);
+            return -1;
+        }
+    }
+
+    snprintf(path, sizeof(path), "%s/" DKC_LOCK_FILE, priv->cache_dir);
+    priv->lock_fd = sys_open(path, O_CREAT | O_RDWR, 0600);
+    if (priv->lock_fd < 0)
+        return -1;
+
+    if (flock(priv->lock_fd, LOCK_EX | LOCK_NB)) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, DKC_MSG_DIR_LOCKED,
+               "cache directory %s is used by another process, running "
+               "without a disk cache",
+               priv->cache_dir);
+        return 0;
+    }
+
+    priv->active = _gf_true;
+    dkc_cache_load(this);
+
+    return 0;
+}
+
+static int32_t
+dkc_mem_acct_init(xlator_t *this)
+{
+    int ret = -1;
+
+    if (!this)
+        return ret;
+
+    ret = xlator_mem_acct_init(this, gf_dkc_mt_end);
+    if (ret != 0) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, DKC_MSG_NO_MEMORY,
+               "Memory accounting init failed");
+        return ret;
+    }
+
+    return ret;
+}
+
+static int
+dkc_reconfigure(xlator_t *this, dict_t *options)
+{
+    dkc_private_t *priv = this->private;
+    gf_boolean_t enabled = _gf_true;
+    int ret = -1;
+
+    GF_OPTION_RECONF("cache-size", priv->cache_size, options, size_uint64,
+                     out);
+    GF_OPTION_RECONF("max-file-size", priv->max_file_size, options,
+                     size_uint64, out);
+    GF_OPTION_RECONF("cache-timeout", priv->cache_timeout, options, uint32,
+                     out);
+    GF_OPTION_RECONF("disk-cache", enabled, options, bool, out);
+    GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
+    if (!enabled)
+        this->pass_through = _gf_true;
+
+    LOCK(&priv->lock);
+    {
+        __dkc_evict(priv);
+    }
+    UNLOCK(&priv->lock);
+
+    dkc_reap(priv);
+
+    ret = 0;
+out:
+    return ret;
+}
+
+static void
+dkc_fini(xlator_t *this)
+{
+    dkc_private_t *priv = this->private;
+    dkc_entry_t *entry = NULL;
+    dkc_entry_t *tmp = NULL;
+
+    if (!priv)
+        return;
+
+    if (priv->active) {
+        list_for_each_entry(entry, &priv->lru, lru)
+        {
+            dkc_entry_flush(this, priv, entry);
+        }
+    }
+
+    dkc_reap(priv);
+
+    list_for_each_entry_safe(entry, tmp, &priv->lru, lru)
+    {
+        list_del_init(&entry->lru);
+        list_del_init(&entry->hash);
+        dkc_entry_free(entry);
+    }
+
+    if (priv->lock_fd >= 0)
+        sys_close(priv->lock_fd);
+
+    LOCK_DESTROY(&priv->lock);
+    GF_FREE(priv->hash);
+    GF_FREE(priv->cache_dir);
+    GF_FREE(priv);
+
+    this->private = NULL;
+}
+
+static int
+dkc_init(xlator_t *this)
+{
+    dkc_private_t *priv = NULL;
+    char *cache_dir = NULL;
+    gf_boolean_t enabled = _gf_true;
+    int ret = -1;
+    int i = 0;
+
+    if (!this->children || this->children->next) {
+        gf_msg(this->name, GF_LOG_ERROR, 0, DKC_MSG_XLATOR_CHILD_MISCONFIGURED,
+               "FATAL: volume (%s) not configured with exactly one "
+               "child",
+               this->name);
+        return -1;
+    }
+
+    if (!this->parents) {
+        gf_msg(this->name, GF_LOG_WARNING, 0, DKC_MSG_VOL_MISCONFIGURED,
+               "dangling volume. check volfile ");
+    }
+
+    priv = GF_CALLOC(1, sizeof(*priv), gf_dkc_mt_private_t);
+    if (!priv)
+        goto out;
+
+    LOCK_INIT(&priv->lock);
+    INIT_LIST_HEAD(&priv->lru);
+    INIT_LIST_HEAD(&priv->purged);
+    priv->lock_fd = -1;
+    this->private = priv;
+
+    GF_OPTION_INIT("cache-dir", cache_dir, path, out);
+    GF_OPTION_INIT("cache-size", priv->cache_size, size_uint64, out);
+    GF_OPTION_INIT("block-size", priv->block_size, size_uint64, out);
+    GF_OPTION_INIT("max-file-size", priv->max_file_size, size_uint64, out);
+    GF_OPTION_INIT("cache-timeout", priv->cache_timeout, uint32, out);
+    GF_OPTION_INIT("disk-cache", enabled, bool, out);
+    GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
+    if (!enabled)
+        this->pass_through = _gf_true;
+
+    priv->hash = GF_CALLOC(DKC_HASH_SIZE, sizeof(*priv->hash),
+                           gf_common_mt_list_head);
+    if (!priv->hash)
+        goto out;
+
+    for (i = 0; i < DKC_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&priv->hash[i]);
+
+    this->local_pool = mem_pool_new(dkc_local_t, 64);
+    if (!this->local_pool) {
+        gf_msg(this->name, GF_LOG_ERROR, ENOMEM, DKC_MSG_NO_MEMORY,
+               "failed to create local_t's memory pool");
+        goto out;
+    }
+
+    ret = dkc_cache_dir_init(this, cache_dir);
+out:
+    if (ret) {
+        dkc_fini(this);
+        if (this->local_pool) {
+            mem_pool_destroy(this->local_pool);
+            this->local_pool = NULL;
+        }
+    }
+
+    return ret;
+}
+
+struct xlator_fops dkc_fops = {
+    .lookup = dkc_lookup,
+    .open = dkc_open,
+    .readv = dkc_readv,
+    .writev = dkc_writev,
+    .truncate = dkc_truncate,
+    .ftruncate = dkc_ftruncate,
+    .fallocate = dkc_fallocate,
+    .discard = dkc_discard,
+    .zerofill = dkc_zerofill,
+    .copy_file_range = dkc_copy_file_range,
+    .unlink = dkc_unlink,
+    .setattr = dkc_setattr,
+    .fsetattr = dkc_fsetattr,
+};
+
+struct xlator_cbks dkc_cbks = {
+    .release = dkc_release,
+};
+
+struct xlator_dumpops dkc_dumpops = {
+    .priv = dkc_priv_dump,
+};
+
+struct volume_options dkc_options[] = {
+    {
+        .key = {"disk-cache"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "on",
+        .description = "enable/disable disk-cache. glusterd leaves the "
+                       "translator out of the graph while "
+                       "performance.disk-cache is off; in a graph that has "
+                       "it, off passes every fop through uncached.",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE,
+    },
+    {
+        .key = {"cache-dir"},
+        .type = GF_OPTION_TYPE_PATH,
+        .default_value = "/var/cache/glusterfs",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Local directory, preferably on a fast disk, where "
+                       "file data is cached. Each volume uses its own "
+                       "subdirectory, which a single client process at a "
+                       "time can use.",
+    },
+    {
+        .key = {"cache-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = INFINITY,
+        .default_value = "10GB",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Maximum amount of data kept in the cache directory. "
+                       "The least recently used files are evicted first.",
+    },
+    {
+        .key = {"block-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 4 * GF_UNIT_KB,
+        .max = 4 * GF_UNIT_MB,
+        .default_value = "128KB",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Unit in which file data is cached. Changing it "
+                       "discards the existing cache on the next mount.",
+    },
+    {
+        .key = {"max-file-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 0,
+        .max = INFINITY,
+        .default_value = "1GB",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Files larger than this are not cached.",
+    },
+    {
+        .key = {"cache-timeout"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 1,
+        .max = 60,
+        .default_value = "1",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Seconds for which cached data of a file is used "
+                       "after its attributes were last checked against the "
+                       "volume. Reads past that are sent to the volume, "
+                       "which checks them again.",
+    },
+    {
+        .key = {"pass-through"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "false",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
+        .tags = {"disk-cache"},
+        .description = "Enable/Disable disk cache translator",
+    },
+    {.key = {NULL}},
+};
+
+xlator_api_t xlator_api = {
+    .init = dkc_init,
+    .fini = dkc_fini,
+    .notify = dkc_notify,
+    .reconfigure = dkc_reconfigure,
+    .mem_acct_init = dkc_mem_acct_init,
+    .dump_metrics = dkc_dump_metrics,
+    .op_version = {GD_OP_VERSION_11_0},
+    .dumpops = &dkc_dumpops,
+    .fops = &dkc_fops,
+    .cbks = &dkc_cbks,
+    .options = dkc_options,
+    .identifier = "disk-cache",
+    .category = GF_TECH_PREVIEW,
+};
@@ -0,0 +1,109 @@
+/*
+  Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#ifndef __DISK_CACHE_H__
+#define __DISK_CACHE_H__
+
+#include <glusterfs/glusterfs.h>
+#include <glusterfs/logging.h>
+#include <glusterfs/dict.h>
+#include <glusterfs/xlator.h>
+#include <glusterfs/list.h>
+#include <glusterfs/locking.h>
+#include <glusterfs/iatt.h>
+#include <glusterfs/common-utils.h>
+#include <glusterfs/defaults.h>
+#include "disk-cache-mem-types.h"
+#include "disk-cache-messages.h"
+
+#define DKC_INDEX_MAGIC 0x646b6331 /* "dkc1" */
+#define DKC_HASH_SIZE 4096
+#define DKC_INDEX_SUFFIX ".idx"
+#define DKC_LOCK_FILE "lock"
+/* seconds between index writes of a file on release */
+#define DKC_FLUSH_INTERVAL 60
+
+/* Attributes of the file on the volume the cached blocks were read from.
+ * Cached data is only used while they match what the server reports. */
+typedef struct dkc_validators {
+    uint64_t size;
+    int64_t mtime;
+    int64_t ctime;
+    uint32_t mtime_nsec;
+    uint32_t ctime_nsec;
+} dkc_validators_t;
+
+/* On-disk index of a cached file, followed by the bitmap of the blocks
+ * present in the data file. The cache is local to the machine, fields are
+ * stored in host byte order. */
+typedef struct dkc_index_header {
+    uint32_t magic;
+    uint32_t block_size;
+    uint64_t id;
+    uuid_t gfid;
+    dkc_validators_t validators;
+    uint32_t nblocks;
+} __attribute__((packed)) dkc_index_header_t;
+
+typedef struct dkc_entry {
+    struct list_head hash;
+    struct list_head lru; /* or priv->purged */
+    pthread_mutex_t store_lock; /* orders the writes into the data file */
+    int fd;                     /* data file, opened on first use */
+    uuid_t gfid;
+    uint64_t id; /* names the files of this incarnation of the entry */
+    dkc_validators_t validators;
+    struct iatt stat; /* as of the last validation */
+    unsigned char *bitmap;
+    uint32_t nblocks;
+    uint32_t cached; /* blocks set in bitmap */
+    uint64_t gen;    /* bumped on every change of the cached data */
+    int32_t ref;
+    time_t validated_at;    /* last check against the server */
+    time_t flushed;         /* last write of the index */
+    gf_boolean_t validated; /* checked within cache-timeout */
+    gf_boolean_t dirty;     /* index on disk is behind */
+    gf_boolean_t purged;    /* files removed, gone once unreferenced */
+} dkc_entry_t;
+
+typedef struct dkc_statistics {
+    gf_atomic_t hits;
+    gf_atomic_t misses;
+    gf_atomic_t bytes_local;  /* read data served from the cache */
+    gf_atomic_t bytes_remote; /* read data fetched from the volume */
+    gf_atomic_t blocks_stored;
+    gf_atomic_t validations;
+    gf_atomic_t invalidations;
+    gf_atomic_t evictions;
+    gf_atomic_t io_errors;
+} dkc_statistics_t;
+
+typedef struct dkc_private {
+    char *cache_dir; /* cache-dir/<xlator name> */
+    int lock_fd;
+    gf_boolean_t active;
+
+    uint64_t cache_size;
+    uint64_t block_size;
+    uint64_t max_file_size;
+    uint32_t cache_timeout;
+
+    gf_lock_t lock;
+    struct list_head *hash;
+    struct list_head lru;
+    struct list_head purged; /* entries whose files are still to remove */
+    uint64_t entries;
+    uint64_t used; /* bytes of cached blocks */
+    uint64_t gen;
+
+    dkc_statistics_t stats;
+} dkc_private_t;
+
+#endif /* __DISK_CACHE_H__ */
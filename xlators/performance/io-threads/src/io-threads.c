@@ -53,24 +53,38 @@ struct volume_options options[];
         }                                                                      \
     } while (0)
 
-static iot_client_ctx_t *
-iot_get_ctx(xlator_t *this, client_t *client)
+static void
+iot_client_init(iot_client_t *iot_client, client_t *client)
 {
-    iot_client_ctx_t *ctx = NULL;
-    iot_client_ctx_t *setted_ctx = NULL;
     int i;
 
-    if (client_ctx_get(client, this, (void **)&ctx) != 0) {
-        ctx = GF_MALLOC(GF_FOP_PRI_MAX * sizeof(*ctx), gf_iot_mt_client_ctx_t);
+    memset(iot_client, 0, sizeof(*iot_client));
+    for (i = 0; i < GF_FOP_PRI_MAX; ++i) {
+        INIT_LIST_HEAD(&iot_client->queues[i].reqs);
+        INIT_LIST_HEAD(&iot_client->queues[i].clients);
+        iot_client->queues[i].owner = iot_client;
+    }
+    INIT_LIST_HEAD(&iot_client->list);
+    iot_client->client = client;
+}
+
+/* Called with conf->mutex held. */
+static iot_client_t *
+iot_get_ctx(iot_conf_t *conf, client_t *client)
+{
+    iot_client_t *ctx = NULL;
+    iot_client_t *setted_ctx = NULL;
+
+    if (client_ctx_get(client, conf->this, (void **)&ctx) != 0) {
+        ctx = GF_MALLOC(sizeof(*ctx), gf_iot_mt_client_ctx_t);
         if (ctx) {
-            for (i = 0; i < GF_FOP_PRI_MAX; ++i) {
-                INIT_LIST_HEAD(&ctx[i].reqs);
-                INIT_LIST_HEAD(&ctx[i].clients);
-            }
-            setted_ctx = client_ctx_set(client, this, ctx);
+            iot_client_init(ctx, client);
+            setted_ctx = client_ctx_set(client, conf->this, ctx);
             if (ctx != setted_ctx) {
                 GF_FREE(ctx);
                 ctx = setted_ctx;
+            } else {
+                list_add_tail(&ctx->list, &conf->client_list);
             }
         }
     }
@@ -78,14 +92,197 @@ iot_get_ctx(xlator_t *this, client_t *client)
     return ctx;
 }
 
+static iot_class_t
+iot_pid_class(pid_t pid)
+{
+    switch (pid) {
+        case GF_CLIENT_PID_SELF_HEALD:
+        case GF_CLIENT_PID_GLFS_HEAL:
+            return IOT_CLASS_SELF_HEAL;
+        case GF_CLIENT_PID_DEFRAG:
+        case GF_CLIENT_PID_TIER_DEFRAG:
+            return IOT_CLASS_REBALANCE;
+        case GF_CLIENT_PID_BITD:
+        case GF_CLIENT_PID_SCRUB:
+            return IOT_CLASS_BITROT;
+        case GF_CLIENT_PID_NO_ROOT_SQUASH:
+            return IOT_CLASS_CLIENT;
+        default:
+            break;
+    }
+
+    return (pid < GF_CLIENT_PID_MAX) ? IOT_CLASS_INTERNAL : IOT_CLASS_CLIENT;
+}
+
+static const char *
+iot_class_name(iot_class_t class)
+{
+    static const char *names[IOT_CLASS_MAX] = {
+        [IOT_CLASS_CLIENT] = "client",
+        [IOT_CLASS_SELF_HEAL] = "self-heal",
+        [IOT_CLASS_REBALANCE] = "rebalance",
+        [IOT_CLASS_BITROT] = "bitrot",
+        [IOT_CLASS_INTERNAL] = "internal",
+    };
+
+    return names[class];
+}
+
+static uint64_t
+iot_stub_bytes(call_stub_t *stub)
+{
+    switch (stub->fop) {
+        case GF_FOP_READ:
+            return stub->args.size;
+        case GF_FOP_WRITE:
+            return iov_length(stub->args.vector, stub->args.count);
+        default:
+            return 0;
+    }
+}
+
+/* Refills the token buckets of @cls. Returns how long its next request
+ * has to wait for them, 0 if it can go now. */
+static uint64_t
+__iot_class_wait(iot_class_data_t *cls)
+{
+    struct timespec now;
+    struct timespec delta;
+    double secs = 0;
+    uint64_t wait_ns = 0;
+
+    if (!cls->iops_limit && !cls->bandwidth_limit)
+        return 0;
+
+    timespec_now(&now);
+    timespec_sub(&cls->refill, &now, &delta);
+    secs = delta.tv_sec + delta.tv_nsec * NANO;
+    cls->refill = now;
+
+    if (cls->iops_limit) {
+        cls->iops_tokens = min(cls->iops_tokens + secs * cls->iops_limit,
+                               (double)cls->iops_limit);
+        if (cls->iops_tokens <= 0)
+            wait_ns = (1 - cls->iops_tokens) * GF_SEC_IN_NS / cls->iops_limit;
+    }
+    if (cls->bandwidth_limit) {
+        cls->byte_tokens = min(cls->byte_tokens + secs * cls->bandwidth_limit,
+                               (double)cls->bandwidth_limit);
+        if (cls->byte_tokens <= 0)
+            wait_ns = max(wait_ns, (uint64_t)((1 - cls->byte_tokens) *
+                                              GF_SEC_IN_NS /
+                                              cls->bandwidth_limit));
+    }
+
+    return wait_ns;
+}
+
+/* Takes @stub off the queue @ctx at the head of the priority. The queue
+ * goes to the tail unless @stay. */
+static void
+__iot_dequeued(iot_conf_t *conf, iot_client_ctx_t *ctx, call_stub_t *stub,
+               int pri, gf_boolean_t stay)
+{
+    iot_fop_data_t *fop_data = &conf->fops_data[pri];
+    iot_client_t *iot_client = ctx->owner;
+    struct timespec now;
+    struct timespec delta;
+    uint64_t wait_ns = 0;
+
+    list_del_init(&stub->list);
+    if (list_empty(&ctx->reqs)) {
+        list_del_init(&ctx->clients);
+        fop_data->active--;
+        ctx->deficit = 0;
+    } else if (!stay) {
+        list_rotate_left(&fop_data->clients);
+    }
+
+    fop_data->ac_iot_count++;
+    fop_data->queue_marked = _gf_false;
+    fop_data->queue_sizes--;
+    conf->queue_size--;
+
+    timespec_now(&now);
+    timespec_sub(&stub->frame->begin, &now, &delta);
+    wait_ns = TS(delta);
+    iot_client->depth--;
+    iot_client->dispatched++;
+    iot_client->wait_ns += wait_ns;
+    if (wait_ns > iot_client->max_wait_ns)
+        iot_client->max_wait_ns = wait_ns;
+}
+
+/*
+ * Deficit round robin: the queue at the head of the priority sends
+ * requests as long as its credit covers their cost, then goes to the tail
+ * with the weight of its class added to its credit. Queues of a class over
+ * its limits are passed over; when all of them are, *wait_ns is how long
+ * until the first one can send again.
+ */
+static call_stub_t *
+__iot_dequeue_fair(iot_conf_t *conf, int pri, uint64_t *wait_ns)
+{
+    iot_fop_data_t *fop_data = &conf->fops_data[pri];
+    iot_client_ctx_t *ctx = NULL;
+    iot_class_data_t *cls = NULL;
+    call_stub_t *stub = NULL;
+    uint64_t bytes = 0;
+    uint64_t wait = 0;
+    int64_t cost = 0;
+    int throttled = 0;
+
+    while (throttled < fop_data->active) {
+        ctx = list_first_entry(&fop_data->clients, iot_client_ctx_t, clients);
+        cls = &conf->classes[ctx->owner->class];
+
+        wait = __iot_class_wait(cls);
+        if (wait) {
+            if (!*wait_ns || wait < *wait_ns)
+                *wait_ns = wait;
+            throttled++;
+            list_rotate_left(&fop_data->clients);
+            continue;
+        }
+        throttled = 0;
+
+        stub = list_first_entry(&ctx->reqs, call_stub_t, list);
+        bytes = iot_stub_bytes(stub);
+        cost = 1 + bytes / IOT_FQ_COST_BYTES;
+        if (ctx->deficit < cost) {
+            ctx->deficit += cls->weight;
+            list_rotate_left(&fop_data->clients);
+            continue;
+        }
+        ctx->deficit -= cost;
+
+        cls->iops_tokens -= 1;
+        cls->byte_tokens -= bytes;
+        cls->dispatched++;
+        cls->bytes += bytes;
+        *wait_ns = 0;
+        return stub;
+    }
+
+    /* all the queues are throttled */
+    list_for_each_entry(ctx, &fop_data->clients, clients)
+    {
+        conf->classes[ctx->owner->class].throttled++;
+    }
+
+    return NULL;
+}
+
 static call_stub_t *
-__iot_dequeue(iot_conf_t *conf, int *pri)
+__iot_dequeue(iot_conf_t *conf, int *pri, uint64_t *wait_ns)
 {
     call_stub_t *stub = NULL;
     int i = 0;
     iot_client_ctx_t *ctx;
     iot_fop_data_t *fop_data;
 
+    *wait_ns = 0;
+
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
         fop_data = &conf->fops_data[i];
         if (fop_data->ac_iot_count >= fop_data->ac_iot_limit) {
@@ -96,26 +293,26 @@ __iot_dequeue(iot_conf_t *conf, int *pri)
             continue;
         }
 
-        /* Get the first per-client queue for this priority. */
-        ctx = list_first_entry(&fop_data->clients, iot_client_ctx_t, clients);
-        if (list_empty(&ctx->reqs)) {
-            continue;
-        }
-
-        /* Get the first request on that queue. */
-        stub = list_first_entry(&ctx->reqs, call_stub_t, list);
-        list_del_init(&stub->list);
-        if (list_empty(&ctx->reqs)) {
-            list_del_init(&ctx->clients);
+        if (conf->fair_queueing) {
+            stub = __iot_dequeue_fair(conf, i, wait_ns);
+            if (!stub)
+                continue;
+            ctx = list_first_entry(&fop_data->clients, iot_client_ctx_t,
+                                   clients);
         } else {
-            list_rotate_left(&fop_data->clients);
+            /* Get the first per-client queue for this priority. */
+            ctx = list_first_entry(&fop_data->clients, iot_client_ctx_t,
+                                   clients);
+            if (list_empty(&ctx->reqs)) {
+                continue;
+            }
+
+            /* Get the first request on that queue. */
+            stub = list_first_entry(&ctx->reqs, call_stub_t, list);
         }
 
-        fop_data->ac_iot_count++;
-        fop_data->queue_marked = _gf_false;
-        fop_data->queue_sizes--;
+        __iot_dequeued(conf, ctx, stub, i, conf->fair_queueing);
         *pri = i;
-        conf->queue_size--;
 
         return stub;
     }
@@ -127,23 +324,28 @@ static void
 __iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
 {
     client_t *client = stub->frame->root->client;
+    iot_client_t *iot_client = NULL;
     iot_client_ctx_t *ctx;
     iot_fop_data_t *fop_data = &conf->fops_data[pri];
 
     if (client) {
-        ctx = iot_get_ctx(conf->this, client);
-        if (ctx) {
-            ctx = &ctx[pri];
-        }
-    } else {
-        ctx = NULL;
+        iot_client = iot_get_ctx(conf, client);
     }
-    if (!ctx) {
-        ctx = &fop_data->no_client;
+    if (!iot_client) {
+        iot_client = &conf->no_client;
     }
+    ctx = &iot_client->queues[pri];
+
+    iot_client->class = iot_pid_class(stub->frame->root->pid);
+    if (++iot_client->depth > iot_client->max_depth)
+        iot_client->max_depth = iot_client->depth;
+    /* the frame is ours until the stub is resumed, its start time
+     * becomes the time it was queued */
+    timespec_now(&stub->frame->begin);
 
     if (list_empty(&ctx->reqs)) {
         list_add_tail(&ctx->clients, &fop_data->clients);
+        fop_data->active++;
     }
     list_add_tail(&stub->list, &ctx->reqs);
 
@@ -152,6 +354,21 @@ __iot_enqueue(iot_conf_t *conf, call_stub_t *stub, int pri)
     fop_data->queue_sizes++;
 }
 
+/* Waits for the token buckets of the classes with requests queued. */
+static void
+__iot_throttle_wait(iot_conf_t *conf, uint64_t wait_ns)
+{
+    struct timespec deadline;
+
+    timespec_now_realtime(&deadline);
+    deadline.tv_sec += (deadline.tv_nsec + wait_ns) / GF_SEC_IN_NS;
+    deadline.tv_nsec = (deadline.tv_nsec + wait_ns) % GF_SEC_IN_NS;
+
+    conf->sleep_count++;
+    (void)pthread_cond_timedwait(&conf->cond, &conf->mutex, &deadline);
+    conf->sleep_count--;
+}
+
 static void *
 iot_worker(void *data)
 {
@@ -159,6 +376,7 @@ iot_worker(void *data)
     xlator_t *this = NULL;
     call_stub_t *stub = NULL;
     struct timespec sleep_till;
+    uint64_t wait_ns = 0;
     int ret = 0;
     int pri = -1;
     gf_boolean_t bye = _gf_false;
@@ -208,8 +426,11 @@ iot_worker(void *data)
                 }
             }
 
-            if (!bye)
-                stub = __iot_dequeue(conf, &pri);
+            if (!bye) {
+                stub = __iot_dequeue(conf, &pri, &wait_ns);
+                if (!stub && wait_ns)
+                    __iot_throttle_wait(conf, wait_ns);
+            }
         }
         pthread_mutex_unlock(&conf->mutex);
 
@@ -903,6 +1124,67 @@ mem_acct_init(xlator_t *this)
     return ret;
 }
 
+static void
+iot_client_dump(iot_client_t *iot_client, int n)
+{
+    char key[GF_DUMP_MAX_BUF_LEN];
+
+    snprintf(key, sizeof(key), "client.%d.uid", n);
+    gf_proc_dump_write(key, "%s",
+                       iot_client->client ? iot_client->client->client_uid
+                                          : "-");
+    snprintf(key, sizeof(key), "client.%d.class", n);
+    gf_proc_dump_write(key, "%s", iot_class_name(iot_client->class));
+    snprintf(key, sizeof(key), "client.%d.queue_depth", n);
+    gf_proc_dump_write(key, "%u", iot_client->depth);
+    snprintf(key, sizeof(key), "client.%d.max_queue_depth", n);
+    gf_proc_dump_write(key, "%u", iot_client->max_depth);
+    snprintf(key, sizeof(key), "client.%d.dispatched", n);
+    gf_proc_dump_write(key, "%" PRIu64, iot_client->dispatched);
+    snprintf(key, sizeof(key), "client.%d.avg_wait_usec", n);
+    gf_proc_dump_write(key, "%" PRIu64,
+                       iot_client->dispatched ? iot_client->wait_ns /
+                                                    iot_client->dispatched /
+                                                    1000
+                                              : 0);
+    snprintf(key, sizeof(key), "client.%d.max_wait_usec", n);
+    gf_proc_dump_write(key, "%" PRIu64, iot_client->max_wait_ns / 1000);
+}
+
+static void
+iot_fq_dump(iot_conf_t *conf)
+{
+    char key[GF_DUMP_MAX_BUF_LEN];
+    iot_class_data_t *cls = NULL;
+    iot_client_t *iot_client = NULL;
+    int i = 0;
+
+    pthread_mutex_lock(&conf->mutex);
+    {
+        for (i = 0; i < IOT_CLASS_MAX; i++) {
+            cls = &conf->classes[i];
+            snprintf(key, sizeof(key), "class.%s.weight", iot_class_name(i));
+            gf_proc_dump_write(key, "%u", cls->weight);
+            snprintf(key, sizeof(key), "class.%s.dispatched",
+                     iot_class_name(i));
+            gf_proc_dump_write(key, "%" PRIu64, cls->dispatched);
+            snprintf(key, sizeof(key), "class.%s.bytes", iot_class_name(i));
+            gf_proc_dump_write(key, "%" PRIu64, cls->bytes);
+            snprintf(key, sizeof(key), "class.%s.throttled",
+                     iot_class_name(i));
+            gf_proc_dump_write(key, "%" PRIu64, cls->throttled);
+        }
+
+        i = 0;
+        iot_client_dump(&conf->no_client, i++);
+        list_for_each_entry(iot_client, &conf->client_list, list)
+        {
+            iot_client_dump(iot_client, i++);
+        }
+    }
+    pthread_mutex_unlock(&conf->mutex);
+}
+
 int
 iot_priv_dump(xlator_t *this)
 {
@@ -951,6 +1233,9 @@ iot_priv_dump(xlator_t *this)
         gf_proc_dump_write(key, "%d", conf->fops_data[i].queue_sizes);
     }
 
+    gf_proc_dump_write("fair_queueing", "%d", conf->fair_queueing);
+    iot_fq_dump(conf);
+
     return 0;
 }
 
@@ -1114,6 +1399,44 @@ stop_iot_watchdog(xlator_t *this)
     priv->watchdog_running = _gf_false;
 }
 
+/* Reads the <class>-weight, -iops-limit and -bandwidth-limit options,
+ * from @options on reconfigure, from those of the xlator on init. */
+static int
+iot_class_options(iot_conf_t *conf, dict_t *options)
+{
+    iot_class_data_t *cls = NULL;
+    char key[64];
+    int ret = -1;
+    int i = 0;
+
+    for (i = 0; i < IOT_CLASS_MAX; i++) {
+        cls = &conf->classes[i];
+
+        snprintf(key, sizeof(key), "%s-weight", iot_class_name(i));
+        if (options)
+            GF_OPTION_RECONF(key, cls->weight, options, uint32, out);
+        else
+            GF_OPTION_INIT(key, cls->weight, uint32, out);
+
+        snprintf(key, sizeof(key), "%s-iops-limit", iot_class_name(i));
+        if (options)
+            GF_OPTION_RECONF(key, cls->iops_limit, options, uint32, out);
+        else
+            GF_OPTION_INIT(key, cls->iops_limit, uint32, out);
+
+        snprintf(key, sizeof(key), "%s-bandwidth-limit", iot_class_name(i));
+        if (options)
+            GF_OPTION_RECONF(key, cls->bandwidth_limit, options, size_uint64,
+                             out);
+        else
+            GF_OPTION_INIT(key, cls->bandwidth_limit, size_uint64, out);
+    }
+
+    ret = 0;
+out:
+    return ret;
+}
+
 int
 reconfigure(xlator_t *this, dict_t *options)
 {
@@ -1152,6 +1475,11 @@ reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
 
+    GF_OPTION_RECONF("fair-queueing", conf->fair_queueing, options, bool, out);
+
+    if (iot_class_options(conf, options))
+        goto out;
+
     if (conf->watchdog_secs > 0) {
         start_iot_watchdog(this);
     } else {
@@ -1232,13 +1560,21 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("pass-through", this->pass_through, bool, out);
 
+    GF_OPTION_INIT("fair-queueing", conf->fair_queueing, bool, out);
+
+    if (iot_class_options(conf, NULL))
+        goto out;
+
     conf->this = this;
     GF_ATOMIC_INIT(conf->stub_cnt, 0);
 
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
         INIT_LIST_HEAD(&conf->fops_data[i].clients);
-        INIT_LIST_HEAD(&conf->fops_data[i].no_client.reqs);
-        INIT_LIST_HEAD(&conf->fops_data[i].no_client.clients);
+    }
+    iot_client_init(&conf->no_client, NULL);
+    INIT_LIST_HEAD(&conf->client_list);
+    for (i = 0; i < IOT_CLASS_MAX; i++) {
+        timespec_now(&conf->classes[i].refill);
     }
 
     if (!this->pass_through) {
@@ -1357,10 +1693,16 @@ fini(xlator_t *this)
 int
 iot_client_destroy(xlator_t *this, client_t *client)
 {
-    void *tmp = NULL;
+    iot_conf_t *conf = this->private;
+    iot_client_t *iot_client = NULL;
 
-    if (client_ctx_del(client, this, &tmp) == 0) {
-        GF_FREE(tmp);
+    if (client_ctx_del(client, this, (void **)&iot_client) == 0) {
+        if (conf) {
+            pthread_mutex_lock(&conf->mutex);
+            list_del_init(&iot_client->list);
+            pthread_mutex_unlock(&conf->mutex);
+        }
+        GF_FREE(iot_client);
     }
 
     return 0;
@@ -1381,7 +1723,7 @@ iot_disconnect_cbk(xlator_t *this, client_t *client)
 
     pthread_mutex_lock(&conf->mutex);
     for (i = 0; i < GF_FOP_PRI_MAX; i++) {
-        ctx = &conf->fops_data[i].no_client;
+        ctx = &conf->no_client.queues[i];
         list_for_each_entry_safe(curr, next, &ctx->reqs, list)
         {
             if (curr->frame->root->client != client) {
@@ -1460,6 +1802,37 @@ struct xlator_cbks cbks = {
     .client_disconnect = iot_disconnect_cbk,
 };
 
+#define IOT_CLASS_OPTIONS(class, requests, weight)                             \
+    {.key = {class "-weight"},                                                 \
+     .type = GF_OPTION_TYPE_INT,                                               \
+     .min = 1,                                                                 \
+     .max = 1000,                                                              \
+     .default_value = weight,                                                  \
+     .op_version = {GD_OP_VERSION_11_0},                                       \
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_RANGE,               \
+     .tags = {"io-threads"},                                                   \
+     .description = "Share of the threads of a priority given to each "        \
+                    "client queueing " requests " in it when "                 \
+                    "fair-queueing is on, relative to the weights of "         \
+                    "the other clients."},                                     \
+    {.key = {class "-iops-limit"},                                             \
+     .type = GF_OPTION_TYPE_INT,                                               \
+     .min = 0,                                                                 \
+     .default_value = "0",                                                     \
+     .op_version = {GD_OP_VERSION_11_0},                                       \
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,                                \
+     .tags = {"io-threads"},                                                   \
+     .description = "Most " requests " started per second when "               \
+                    "fair-queueing is on, 0 for no limit."},                   \
+    {.key = {class "-bandwidth-limit"},                                        \
+     .type = GF_OPTION_TYPE_SIZET,                                             \
+     .default_value = "0",                                                     \
+     .op_version = {GD_OP_VERSION_11_0},                                       \
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,                                \
+     .tags = {"io-threads"},                                                   \
+     .description = "Most bytes per second read and written by " requests      \
+                    " when fair-queueing is on, 0 for no limit."}
+
 struct volume_options options[] = {
     {.key = {"thread-count"},
      .type = GF_OPTION_TYPE_INT,
@@ -1550,6 +1923,24 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"io-threads"},
      .description = "Enable/Disable io threads translator"},
+    {.key = {"fair-queueing"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"io-threads"},
+     .description = "Share the threads of each priority between the "
+                    "clients in proportion to the weight of their class "
+                    "(applications, self-heal, rebalance, bitrot or other "
+                    "internal clients) and within the limits of the class, "
+                    "instead of taking a request of each client in turn."},
+    IOT_CLASS_OPTIONS("client", "the requests of applications", "4"),
+    IOT_CLASS_OPTIONS("self-heal", "the self-heal requests", "2"),
+    IOT_CLASS_OPTIONS("rebalance", "the rebalance requests", "2"),
+    IOT_CLASS_OPTIONS("bitrot", "the bitrot signer and scrubber requests",
+                      "1"),
+    IOT_CLASS_OPTIONS("internal", "the requests of other internal clients",
+                      "4"),
     {
         .key = {NULL},
     },
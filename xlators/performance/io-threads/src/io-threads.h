@@ -32,22 +32,61 @@
 
 #define IOT_THREAD_STACK_SIZE ((size_t)(256 * 1024))
 
+/* Fair queueing shares the threads of a priority between the clients
+ * queueing requests in it, in proportion to the weight of their class. The
+ * class of a client comes from the pid of its requests. */
+typedef enum {
+    IOT_CLASS_CLIENT,    /* applications */
+    IOT_CLASS_SELF_HEAL, /* self-heal daemon and heal commands */
+    IOT_CLASS_REBALANCE,
+    IOT_CLASS_BITROT, /* bitrot signer and scrubber */
+    IOT_CLASS_INTERNAL,
+    IOT_CLASS_MAX
+} iot_class_t;
+
+/* a request costs one unit plus one for each IOT_FQ_COST_BYTES it moves */
+#define IOT_FQ_COST_BYTES 65536
+
+typedef struct {
+    uint32_t weight;
+    uint32_t iops_limit;      /* 0 if unlimited */
+    uint64_t bandwidth_limit; /* bytes per second, 0 if unlimited */
+    /* token buckets refilled at the limits, holding a second of them */
+    double iops_tokens;
+    double byte_tokens;
+    struct timespec refill;
+    uint64_t dispatched;
+    uint64_t bytes;
+    uint64_t throttled; /* times its requests waited for tokens */
+} iot_class_data_t;
+
+struct iot_client;
+
 typedef struct {
     struct list_head reqs;
     struct list_head clients;
+    struct iot_client *owner;
+    int64_t deficit; /* fair queueing credit, in cost units */
 } iot_client_ctx_t;
 
+/* The queues of a client_t, one per priority, and their statistics. */
+typedef struct iot_client {
+    iot_client_ctx_t queues[GF_FOP_PRI_MAX];
+    struct list_head list; /* in iot_conf_t.client_list */
+    client_t *client;      /* NULL for the requests without one */
+    iot_class_t class;     /* of the last request queued */
+    uint32_t depth;        /* requests queued */
+    uint32_t max_depth;
+    uint64_t dispatched;
+    uint64_t wait_ns; /* total time the dispatched requests were queued */
+    uint64_t max_wait_ns;
+} iot_client_t;
+
 typedef struct {
     int32_t ac_iot_limit;
     int32_t ac_iot_count;
     struct list_head clients;
-    /*
-     * It turns out that there are several ways a frame can get to us
-     * without having an associated client (server_first_lookup was the
-     * first one I hit).  Instead of trying to update all such callers,
-     * we use this to queue them.
-     */
-    iot_client_ctx_t no_client;
+    int active; /* queues in clients */
     int queue_sizes;
     uint queue_marked;
 } iot_fop_data_t;
@@ -70,6 +109,18 @@ struct iot_conf {
 
     iot_fop_data_t fops_data[GF_FOP_PRI_MAX];
 
+    /*
+     * It turns out that there are several ways a frame can get to us
+     * without having an associated client (server_first_lookup was the
+     * first one I hit).  Instead of trying to update all such callers,
+     * we use this to queue them.
+     */
+    iot_client_t no_client;
+    struct list_head client_list;
+
+    gf_boolean_t fair_queueing;
+    iot_class_data_t classes[IOT_CLASS_MAX];
+
     pthread_attr_t w_attr;
     size_t stack_size;
     pthread_t watchdog_thread;
@@ -42,6 +42,13 @@ typedef struct ob_conf {
                                            first and then send readv i.e
                                            similar to what writev does
                                         */
+    gf_boolean_t read_in_open;     /* when a readv triggers the open, ask
+                                      the bricks to return its data along
+                                      with the open */
+    uint64_t read_in_open_size;    /* largest readv handled that way */
+
+    gf_atomic_t reads_in_open;  /* opens sent with a read */
+    gf_atomic_t reads_served;   /* readvs answered from their data */
 } ob_conf_t;
 
 /* A negative state represents an errno value negated. In this case the
@@ -93,6 +100,11 @@ typedef struct ob_inode {
     /* This flag is set as soon as we know that the open will be
      * sent to the bricks, even before the stub is ready. */
     bool triggered;
+
+    /* Range of the readv that triggered the open, to be read along with
+     * it. read_size is 0 if there's none. */
+    off_t read_offset;
+    uint32_t read_size;
 } ob_inode_t;
 
 /* Dummy pointer used temporarily while the actual open stub is being created */
@@ -386,9 +398,90 @@ ob_resume_pending(struct list_head *list)
     }
 }
 
+/* Answer the readvs pending on the open of @fd with the data the bricks
+ * returned along with it. Only the readvs queued before any other fop can
+ * be served, later ones could depend on the effects of that fop. */
+static void
+ob_read_in_open_serve(xlator_t *xl, fd_t *fd, struct list_head *list,
+                      dict_t *xdata)
+{
+    ob_conf_t *conf = xl->private;
+    call_stub_t *stub = NULL;
+    call_stub_t *tmp = NULL;
+    struct iobuf *iobuf = NULL;
+    struct iobref *iobref = NULL;
+    struct iovec iov = {
+        0,
+    };
+    struct iatt stbuf = {
+        0,
+    };
+    data_t *data = NULL;
+    int64_t offset = 0;
+    size_t start = 0;
+    size_t len = 0;
+    bool eof = false;
+
+    if (!xdata || dict_get_int64(xdata, GF_OPEN_READ_OFFSET_KEY, &offset) ||
+        dict_get_iatt(xdata, GF_OPEN_READ_STAT_KEY, &stbuf))
+        return;
+
+    data = dict_get_sizen(xdata, GF_OPEN_READ_KEY);
+    if (!data)
+        return;
+
+    eof = (offset + data->len >= stbuf.ia_size);
+
+    list_for_each_entry_safe(stub, tmp, list, list)
+    {
+        if ((stub->fop != GF_FOP_READ) || (stub->args.fd != fd))
+            break;
+
+        if ((stub->args.offset < offset) ||
+            (stub->args.offset > offset + data->len) ||
+            (!eof && (stub->args.offset + stub->args.size >
+                      offset + data->len)))
+            continue;
+
+        if (!iobref) {
+            iobuf = iobuf_get2(xl->ctx->iobuf_pool, data->len);
+            if (!iobuf)
+                break;
+
+            iobref = iobref_new();
+            if (!iobref)
+                break;
+
+            iobref_add(iobref, iobuf);
+            memcpy(iobuf->ptr, data->data, data->len);
+        }
+
+        start = stub->args.offset - offset;
+        len = min(stub->args.size, data->len - start);
+
+        iov.iov_base = iobuf->ptr + start;
+        iov.iov_len = len;
+
+        list_del_init(&stub->list);
+
+        GF_ATOMIC_INC(conf->reads_served);
+
+        STACK_UNWIND_STRICT(readv, stub->frame, len,
+                            (stub->args.offset + len >= stbuf.ia_size) ? ENOENT
+                                                                       : 0,
+                            &iov, 1, &stbuf, iobref, NULL);
+        call_stub_destroy(stub);
+    }
+
+    if (iobref)
+        iobref_unref(iobref);
+    if (iobuf)
+        iobuf_unref(iobuf);
+}
+
 static void
 ob_open_completed(xlator_t *xl, ob_inode_t *ob_inode, fd_t *fd, int32_t op_ret,
-                  int32_t op_errno)
+                  int32_t op_errno, dict_t *xdata)
 {
     struct list_head list;
 
@@ -407,10 +500,14 @@ ob_open_completed(xlator_t *xl, ob_inode_t *ob_inode, fd_t *fd, int32_t op_ret,
             ob_inode->first_fd = NULL;
             ob_inode->first_open = NULL;
             ob_inode->triggered = false;
+            ob_inode->read_size = 0;
         }
     }
     UNLOCK(&ob_inode->inode->lock);
 
+    if (op_ret >= 0)
+        ob_read_in_open_serve(xl, fd, &list, xdata);
+
     ob_resume_pending(&list);
 
     fd_unref(fd);
@@ -425,20 +522,63 @@ ob_open_cbk(call_frame_t *frame, void *cookie, xlator_t *xl, int32_t op_ret,
     ob_inode = frame->local;
     frame->local = NULL;
 
-    ob_open_completed(xl, ob_inode, cookie, op_ret, op_errno);
+    ob_open_completed(xl, ob_inode, cookie, op_ret, op_errno, xdata);
 
     STACK_DESTROY(frame->root);
 
     return 0;
 }
 
+static dict_t *
+ob_read_in_open_request(dict_t *xdata, off_t offset, uint32_t size)
+{
+    dict_t *dict = NULL;
+
+    dict = xdata ? dict_copy_with_ref(xdata, NULL) : dict_new();
+    if (!dict)
+        return NULL;
+
+    if (dict_set_int64(dict, GF_OPEN_READ_OFFSET_KEY, offset) ||
+        dict_set_uint32(dict, GF_OPEN_READ_SIZE_KEY, size)) {
+        dict_unref(dict);
+        return NULL;
+    }
+
+    return dict;
+}
+
 static int32_t
 ob_open_resume(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
                fd_t *fd, dict_t *xdata)
 {
+    ob_conf_t *conf = this->private;
+    ob_inode_t *ob_inode = frame->local;
+    dict_t *dict = NULL;
+    off_t offset = 0;
+    uint32_t size = 0;
+
+    LOCK(&fd->inode->lock);
+    {
+        offset = ob_inode->read_offset;
+        size = ob_inode->read_size;
+        ob_inode->read_size = 0;
+    }
+    UNLOCK(&fd->inode->lock);
+
+    if (size != 0) {
+        dict = ob_read_in_open_request(xdata, offset, size);
+        if (dict) {
+            GF_ATOMIC_INC(conf->reads_in_open);
+            xdata = dict;
+        }
+    }
+
     STACK_WIND_COOKIE(frame, ob_open_cbk, fd, FIRST_CHILD(this),
                       FIRST_CHILD(this)->fops->open, loc, flags, fd, xdata);
 
+    if (dict)
+        dict_unref(dict);
+
     return 0;
 }
 
@@ -496,7 +636,7 @@ ob_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags, fd_t *fd,
 
         /* In case of error, simulate a regular completion but with an error
          * code. */
-        ob_open_completed(this, ob_inode, first_fd, -1, ENOMEM);
+        ob_open_completed(this, ob_inode, first_fd, -1, ENOMEM, NULL);
 
         state = -ENOMEM;
     }
@@ -566,6 +706,25 @@ ob_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
     return default_create_failure_cbk(frame, -state);
 }
 
+/* If this readv is going to trigger the pending open of @fd, remember its
+ * range so that it's read along with the open. */
+static void
+ob_read_in_open(xlator_t *xl, fd_t *fd, off_t offset, size_t size)
+{
+    ob_inode_t *ob_inode = NULL;
+
+    LOCK(&fd->inode->lock);
+    {
+        ob_inode = ob_inode_get_locked(xl, fd->inode);
+        if ((ob_inode != NULL) && (ob_inode->first_fd == fd) &&
+            !ob_inode->triggered) {
+            ob_inode->read_offset = offset;
+            ob_inode->read_size = size;
+        }
+    }
+    UNLOCK(&fd->inode->lock);
+}
+
 static int32_t
 ob_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
          off_t offset, uint32_t flags, dict_t *xdata)
@@ -573,6 +732,10 @@ ob_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     ob_conf_t *conf = this->private;
     bool trigger = conf->read_after_open || !conf->use_anonymous_fd;
 
+    if (trigger && conf->read_in_open && (size != 0) &&
+        (size <= conf->read_in_open_size))
+        ob_read_in_open(this, fd, offset, size);
+
     OB_POST_FD(readv, this, frame, fd, trigger, fd, size, offset, flags, xdata);
 
     return 0;
@@ -814,6 +977,7 @@ ob_fdclose(xlator_t *this, fd_t *fd)
                     ob_inode->first_fd = NULL;
                     ob_inode->first_open = NULL;
                     ob_inode->triggered = false;
+                    ob_inode->read_size = 0;
                     list_splice_init(&ob_inode->resume_fops, &list);
                 } else if (!ob_inode->triggered) {
                     /* If the open has already been dispatched, we can only
@@ -874,6 +1038,14 @@ ob_priv_dump(xlator_t *this)
 
     gf_proc_dump_write("lazy_open", "%d", conf->lazy_open);
 
+    gf_proc_dump_write("read_in_open", "%d", conf->read_in_open);
+
+    gf_proc_dump_write("reads_in_open", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(conf->reads_in_open));
+
+    gf_proc_dump_write("reads_served", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(conf->reads_served));
+
     return 0;
 }
 
@@ -937,6 +1109,11 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("read-after-open", conf->read_after_open, options, bool,
                      out);
 
+    GF_OPTION_RECONF("read-in-open", conf->read_in_open, options, bool, out);
+
+    GF_OPTION_RECONF("read-in-open-size", conf->read_in_open_size, options,
+                     size_uint64, out);
+
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, out);
     ret = 0;
 out:
@@ -971,6 +1148,14 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("read-after-open", conf->read_after_open, bool, err);
 
+    GF_OPTION_INIT("read-in-open", conf->read_in_open, bool, err);
+
+    GF_OPTION_INIT("read-in-open-size", conf->read_in_open_size, size_uint64,
+                   err);
+
+    GF_ATOMIC_INIT(conf->reads_in_open, 0);
+    GF_ATOMIC_INIT(conf->reads_served, 0);
+
     GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
 
     this->private = conf;
@@ -1075,6 +1260,28 @@ struct volume_options options[] = {
         .tags = {},
         /* option_validation_fn validate_fn; */
     },
+    {
+        .key = {"read-in-open"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .description = "When a read triggers the delayed open of a file, "
+                       "the bricks return the data along with the open, "
+                       "saving the round trip of the read.",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT,
+        .tags = {"open-behind"},
+    },
+    {
+        .key = {"read-in-open-size"},
+        .type = GF_OPTION_TYPE_SIZET,
+        .min = 4 * GF_UNIT_KB,
+        .max = 1 * GF_UNIT_MB,
+        .default_value = "128KB",
+        .description = "Largest read which is sent along with the open.",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT,
+        .tags = {"open-behind"},
+    },
     {.key = {"pass-through"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "false",
@@ -9,11 +9,16 @@
 */
 
 #include <math.h>
+#include <zlib.h>
+#ifdef HAVE_LIB_LZ4
+#include <lz4.h>
+#endif
 #include "quick-read.h"
 #include <glusterfs/statedump.h>
 #include "quick-read-messages.h"
 #include <glusterfs/upcall-utils.h>
 #include <glusterfs/atomic.h>
+#include <glusterfs/checksum.h>
 
 typedef struct qr_local {
     inode_t *inode;
@@ -28,6 +33,12 @@ void
 __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
                       qr_inode_t *qr_inode);
 
+static inline gf_boolean_t
+__qr_inode_has_data(qr_inode_t *qr_inode)
+{
+    return (qr_inode->data || qr_inode->content);
+}
+
 void
 qr_local_wipe(qr_local_t *local)
 {
@@ -242,18 +253,22 @@ __qr_inode_register(xlator_t *this, qr_inode_table_t *table,
 {
     qr_private_t *priv = NULL;
 
-    if (!qr_inode->data)
+    if (!__qr_inode_has_data(qr_inode))
         return;
 
     priv = this->private;
     if (!priv)
         return;
 
-    if (list_empty(&qr_inode->lru))
-        /* first time addition of this qr_inode into table */
-        table->cache_used += qr_inode->size;
-    else
+    if (list_empty(&qr_inode->lru)) {
+        /* first time addition of this qr_inode into table. Shared
+         * content is accounted for when it is created. */
+        if (!qr_inode->content)
+            table->cache_used += qr_inode->size;
+        table->cache_logical += qr_inode->size;
+    } else {
         list_del_init(&qr_inode->lru);
+    }
 
     list_add_tail(&qr_inode->lru, &table->lru[qr_inode->priority]);
 
@@ -294,6 +309,21 @@ qr_inode_set_priority(xlator_t *this, inode_t *inode, const char *path)
     UNLOCK(&table->lock);
 }
 
+/* To be called with priv->table.lock held */
+static void
+__qr_content_unref(qr_inode_table_t *table, qr_content_t *content)
+{
+    if (--content->ref)
+        return;
+
+    list_del_init(&content->hash);
+    table->cache_used -= content->stored;
+    table->contents--;
+
+    GF_FREE(content->data);
+    GF_FREE(content);
+}
+
 void
 __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
                       qr_inode_t *qr_inode)
@@ -302,11 +332,10 @@ __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
 
     priv = this->private;
 
-    GF_FREE(qr_inode->data);
-    qr_inode->data = NULL;
-
     if (!list_empty(&qr_inode->lru)) {
-        table->cache_used -= qr_inode->size;
+        if (!qr_inode->content)
+            table->cache_used -= qr_inode->size;
+        table->cache_logical -= qr_inode->size;
         qr_inode->size = 0;
 
         list_del_init(&qr_inode->lru);
@@ -314,6 +343,14 @@ __qr_inode_prune_data(xlator_t *this, qr_inode_table_t *table,
         GF_ATOMIC_DEC(priv->qr_counter.files_cached);
     }
 
+    if (qr_inode->content) {
+        __qr_content_unref(table, qr_inode->content);
+        qr_inode->content = NULL;
+    }
+
+    GF_FREE(qr_inode->data);
+    qr_inode->data = NULL;
+
     memset(&qr_inode->buf, 0, sizeof(qr_inode->buf));
 }
 
@@ -414,12 +451,198 @@ out:
     return content;
 }
 
+/* To be called with priv->table.lock held */
+static qr_content_t *
+__qr_content_find(qr_inode_table_t *table, unsigned char *checksum,
+                  size_t size, uint32_t bucket)
+{
+    qr_content_t *content = NULL;
+
+    list_for_each_entry(content, &table->content_hash[bucket], hash)
+    {
+        if ((content->size == size) &&
+            !memcmp(content->checksum, checksum, SHA256_DIGEST_LENGTH)) {
+            content->ref++;
+            return content;
+        }
+    }
+
+    return NULL;
+}
+
+/* Cached content is compressed with LZ4 when the build has it, being the
+ * faster of the two to decompress on every read, and with zlib otherwise. */
+#ifdef HAVE_LIB_LZ4
+#define QR_COMPRESSOR "lz4"
+#else
+#define QR_COMPRESSOR "zlib"
+#endif
+
+static size_t
+qr_compress_bound(size_t size)
+{
+#ifdef HAVE_LIB_LZ4
+    return LZ4_compressBound(size);
+#else
+    return compressBound(size);
+#endif
+}
+
+/* Returns the compressed size of @src in @dst, -1 if it does not fit */
+static ssize_t
+qr_compress(const void *src, size_t size, void *dst, size_t dsize)
+{
+#ifdef HAVE_LIB_LZ4
+    int ret = LZ4_compress_default(src, dst, size, dsize);
+
+    return (ret > 0) ? ret : -1;
+#else
+    uLongf zsize = dsize;
+
+    if (compress2(dst, &zsize, src, size, Z_BEST_SPEED) != Z_OK)
+        return -1;
+    return zsize;
+#endif
+}
+
+/* Inflates @src into @dst, 0 if that gave exactly @size bytes */
+static int
+qr_decompress(const void *src, size_t stored, void *dst, size_t size)
+{
+#ifdef HAVE_LIB_LZ4
+    return (LZ4_decompress_safe(src, dst, stored, size) == (int)size) ? 0
+                                                                       : -1;
+#else
+    uLongf zsize = size;
+
+    if (uncompress(dst, &zsize, src, stored) != Z_OK)
+        return -1;
+    return (zsize == size) ? 0 : -1;
+#endif
+}
+
+/* Wrap @data into a new content, compressed if cache-compression is set
+ * and it makes the content smaller. Takes ownership of @data. */
+static qr_content_t *
+qr_content_new(xlator_t *this, void *data, size_t size,
+               unsigned char *checksum)
+{
+    qr_private_t *priv = NULL;
+    qr_content_t *content = NULL;
+    void *zdata = NULL;
+    void *shrunk = NULL;
+    size_t bound = 0;
+    ssize_t zsize = 0;
+
+    priv = this->private;
+
+    content = GF_CALLOC(1, sizeof(*content), gf_qr_mt_qr_content_t);
+    if (!content) {
+        GF_FREE(data);
+        return NULL;
+    }
+
+    INIT_LIST_HEAD(&content->hash);
+    memcpy(content->checksum, checksum, SHA256_DIGEST_LENGTH);
+    content->ref = 1;
+    content->data = data;
+    content->size = size;
+    content->stored = size;
+
+    if (!priv->conf.cache_compression || !size)
+        return content;
+
+    bound = qr_compress_bound(size);
+    zdata = GF_MALLOC(bound, gf_qr_mt_content_t);
+    if (!zdata)
+        return content;
+
+    zsize = qr_compress(data, size, zdata, bound);
+    if ((zsize < 0) || ((size_t)zsize >= size)) {
+        GF_FREE(zdata);
+        return content;
+    }
+
+    shrunk = GF_REALLOC(zdata, zsize);
+    if (shrunk)
+        zdata = shrunk;
+
+    GF_FREE(data);
+    content->data = zdata;
+    content->stored = zsize;
+    content->compressed = _gf_true;
+
+    return content;
+}
+
+/* Return the content equal to @data from the content store, adding it if
+ * no inode caches the same data yet. Takes ownership of @data. */
+static qr_content_t *
+qr_content_share(xlator_t *this, void *data, size_t size)
+{
+    qr_private_t *priv = NULL;
+    qr_inode_table_t *table = NULL;
+    qr_content_t *content = NULL;
+    qr_content_t *new = NULL;
+    unsigned char checksum[SHA256_DIGEST_LENGTH] = {
+        0,
+    };
+    uint32_t bucket = 0;
+
+    priv = this->private;
+    table = &priv->table;
+
+    gf_rsync_strong_checksum(data, size, checksum);
+    memcpy(&bucket, checksum, sizeof(bucket));
+    bucket %= QR_CONTENT_HASH_SIZE;
+
+    LOCK(&table->lock);
+    {
+        content = __qr_content_find(table, checksum, size, bucket);
+    }
+    UNLOCK(&table->lock);
+
+    if (content) {
+        GF_ATOMIC_INC(priv->qr_counter.content_shared);
+        GF_FREE(data);
+        return content;
+    }
+
+    /* compress without holding the table lock */
+    new = qr_content_new(this, data, size, checksum);
+    if (!new)
+        return NULL;
+
+    LOCK(&table->lock);
+    {
+        content = __qr_content_find(table, checksum, size, bucket);
+        if (!content) {
+            list_add(&new->hash, &table->content_hash[bucket]);
+            table->cache_used += new->stored;
+            table->contents++;
+            content = new;
+            new = NULL;
+        }
+    }
+    UNLOCK(&table->lock);
+
+    if (new) {
+        /* somebody else added the same content meanwhile */
+        GF_ATOMIC_INC(priv->qr_counter.content_shared);
+        GF_FREE(new->data);
+        GF_FREE(new);
+    }
+
+    return content;
+}
+
 void
 qr_content_update(xlator_t *this, qr_inode_t *qr_inode, void *data,
                   struct iatt *buf, uint64_t gen)
 {
     qr_private_t *priv = NULL;
     qr_inode_table_t *table = NULL;
+    qr_content_t *content = NULL;
     uint32_t rollover = 0;
 
     rollover = gen >> 32;
@@ -428,19 +651,29 @@ qr_content_update(xlator_t *this, qr_inode_t *qr_inode, void *data,
     priv = this->private;
     table = &priv->table;
 
+    if (priv->conf.cache_dedup) {
+        content = qr_content_share(this, data, buf->ia_size);
+        data = NULL;
+        if (!content)
+            return;
+    }
+
     LOCK(&table->lock);
     {
         if ((rollover != qr_inode->gen_rollover) ||
             (gen && qr_inode->gen && (qr_inode->gen >= gen)))
             goto unlock;
 
-        if ((qr_inode->data == NULL) && (qr_inode->invalidation_time >= gen))
+        if (!__qr_inode_has_data(qr_inode) &&
+            (qr_inode->invalidation_time >= gen))
             goto unlock;
 
         __qr_inode_prune(this, table, qr_inode, gen);
 
         qr_inode->data = data;
         data = NULL;
+        qr_inode->content = content;
+        content = NULL;
         qr_inode->size = buf->ia_size;
 
         qr_inode->ia_mtime = buf->ia_mtime;
@@ -454,6 +687,8 @@ qr_content_update(xlator_t *this, qr_inode_t *qr_inode, void *data,
         __qr_inode_register(this, table, qr_inode);
     }
 unlock:
+    if (content)
+        __qr_content_unref(table, content);
     UNLOCK(&table->lock);
 
     if (data)
@@ -512,7 +747,7 @@ __qr_content_refresh(xlator_t *this, qr_inode_t *qr_inode, struct iatt *buf,
         (gen && qr_inode->gen && (qr_inode->gen >= gen)))
         goto done;
 
-    if ((qr_inode->data == NULL) && (qr_inode->invalidation_time >= gen))
+    if (!__qr_inode_has_data(qr_inode) && (qr_inode->invalidation_time >= gen))
         goto done;
 
     qr_inode->gen = gen;
@@ -629,7 +864,7 @@ qr_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc, dict_t *xdata)
     frame->local = local;
 
     qr_inode = qr_inode_ctx_get(this, loc->inode);
-    if (qr_inode && qr_inode->data)
+    if (qr_inode && __qr_inode_has_data(qr_inode))
         /* cached. only validate in qr_lookup_cbk */
         goto wind;
 
@@ -704,6 +939,41 @@ qr_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     return 0;
 }
 
+/* Copy @len bytes at @offset of @content into a new iobuf, *@base pointing
+ * to the first byte. */
+static int
+qr_content_read(xlator_t *this, qr_content_t *content, off_t offset,
+                size_t len, struct iobuf **iobuf_p, char **base)
+{
+    struct iobuf *iobuf = NULL;
+
+    if (!content->compressed) {
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, len);
+        if (!iobuf)
+            return -1;
+
+        memcpy(iobuf->ptr, content->data + offset, len);
+        *base = iobuf->ptr;
+    } else {
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, content->size);
+        if (!iobuf)
+            return -1;
+
+        if (qr_decompress(content->data, content->stored, iobuf->ptr,
+                          content->size)) {
+            gf_msg(this->name, GF_LOG_WARNING, 0,
+                   QUICK_READ_MSG_DECOMPRESS_FAILED,
+                   "failed to decompress cached content");
+            iobuf_unref(iobuf);
+            return -1;
+        }
+        *base = iobuf->ptr + offset;
+    }
+
+    *iobuf_p = iobuf;
+    return 0;
+}
+
 int
 qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
                 off_t offset, uint32_t flags, dict_t *xdata)
@@ -711,7 +981,9 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
     xlator_t *this = NULL;
     qr_private_t *priv = NULL;
     qr_inode_table_t *table = NULL;
+    qr_content_t *content = NULL;
     int op_ret = -1;
+    char *base = NULL;
     struct iobuf *iobuf = NULL;
     struct iobref *iobref = NULL;
     struct iovec iov = {
@@ -727,7 +999,7 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
 
     LOCK(&table->lock);
     {
-        if (!qr_inode->data)
+        if (!__qr_inode_has_data(qr_inode))
             goto unlock;
 
         if (offset >= qr_inode->size)
@@ -738,22 +1010,21 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
 
         op_ret = min(size, (qr_inode->size - offset));
 
-        iobuf = iobuf_get2(this->ctx->iobuf_pool, op_ret);
-        if (!iobuf) {
-            op_ret = -1;
-            goto unlock;
-        }
+        if (qr_inode->content) {
+            /* copied out of the lock, decompression may be needed */
+            content = qr_inode->content;
+            content->ref++;
+        } else {
+            iobuf = iobuf_get2(this->ctx->iobuf_pool, op_ret);
+            if (!iobuf) {
+                op_ret = -1;
+                goto unlock;
+            }
 
-        iobref = iobref_new();
-        if (!iobref) {
-            op_ret = -1;
-            goto unlock;
+            memcpy(iobuf->ptr, qr_inode->data + offset, op_ret);
+            base = iobuf->ptr;
         }
 
-        iobref_add(iobref, iobuf);
-
-        memcpy(iobuf->ptr, qr_inode->data + offset, op_ret);
-
         buf = qr_inode->buf;
 
         /* bump LRU */
@@ -762,8 +1033,27 @@ qr_readv_cached(call_frame_t *frame, qr_inode_t *qr_inode, size_t size,
 unlock:
     UNLOCK(&table->lock);
 
+    if (content) {
+        if (qr_content_read(this, content, offset, op_ret, &iobuf, &base))
+            op_ret = -1;
+
+        LOCK(&table->lock);
+        {
+            __qr_content_unref(table, content);
+        }
+        UNLOCK(&table->lock);
+    }
+
+    if (op_ret >= 0) {
+        iobref = iobref_new();
+        if (!iobref)
+            op_ret = -1;
+        else
+            iobref_add(iobref, iobuf);
+    }
+
     if (op_ret >= 0) {
-        iov.iov_base = iobuf->ptr;
+        iov.iov_base = base;
         iov.iov_len = op_ret;
 
         GF_ATOMIC_INC(priv->qr_counter.cache_hit);
@@ -1030,7 +1320,7 @@ qr_inodectx_dump(xlator_t *this, inode_t *inode)
     gf_proc_dump_add_section("%s", key_prefix);
 
     gf_proc_dump_write("entire-file-cached", "%s",
-                       qr_inode->data ? "yes" : "no");
+                       __qr_inode_has_data(qr_inode) ? "yes" : "no");
 
     if (qr_inode->last_refresh) {
         gf_time_fmt(buf, sizeof buf, qr_inode->last_refresh, gf_timefmt_FT);
@@ -1092,6 +1382,14 @@ qr_priv_dump(xlator_t *this)
                        GF_ATOMIC_GET(priv->qr_counter.cache_miss));
     gf_proc_dump_write("cache-invalidations", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(priv->qr_counter.file_data_invals));
+    gf_proc_dump_write("cache-dedup", "%d", conf->cache_dedup);
+    gf_proc_dump_write("cache-compression", "%d", conf->cache_compression);
+    gf_proc_dump_write("cache-compressor", "%s", QR_COMPRESSOR);
+    gf_proc_dump_write("cache-logical-bytes", "%" PRIu64, table->cache_logical);
+    gf_proc_dump_write("cache-physical-bytes", "%" PRIu64, table->cache_used);
+    gf_proc_dump_write("shared-contents", "%" PRIu64, table->contents);
+    gf_proc_dump_write("content-shared", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->qr_counter.content_shared));
 
 out:
     return 0;
@@ -1116,6 +1414,10 @@ qr_dump_metrics(xlator_t *this, int fd)
             GF_ATOMIC_GET(priv->qr_counter.cache_miss));
     dprintf(fd, "%s.cache-invalidations %" PRId64 "\n", this->name,
             GF_ATOMIC_GET(priv->qr_counter.file_data_invals));
+    dprintf(fd, "%s.cache-logical-bytes %" PRId64 "\n", this->name,
+            table->cache_logical);
+    dprintf(fd, "%s.content-shared %" PRId64 "\n", this->name,
+            GF_ATOMIC_GET(priv->qr_counter.content_shared));
 
     return 0;
 }
@@ -1203,6 +1505,11 @@ qr_reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("ctime-invalidation", conf->ctime_invalidation, options,
                      bool, out);
 
+    GF_OPTION_RECONF("cache-dedup", conf->cache_dedup, options, bool, out);
+
+    GF_OPTION_RECONF("cache-compression", conf->cache_compression, options,
+                     bool, out);
+
     GF_OPTION_RECONF("cache-size", cache_size_new, options, size_uint64, out);
     if (!check_cache_size_ok(this, cache_size_new)) {
         ret = -1;
@@ -1360,6 +1667,10 @@ qr_init(xlator_t *this)
 
     GF_OPTION_INIT("ctime-invalidation", conf->ctime_invalidation, bool, out);
 
+    GF_OPTION_INIT("cache-dedup", conf->cache_dedup, bool, out);
+
+    GF_OPTION_INIT("cache-compression", conf->cache_compression, bool, out);
+
     INIT_LIST_HEAD(&conf->priority_list);
     conf->max_pri = 1;
     if (dict_get(this->options, "priority")) {
@@ -1385,6 +1696,18 @@ qr_init(xlator_t *this)
         INIT_LIST_HEAD(&priv->table.lru[i]);
     }
 
+    priv->table.content_hash = GF_CALLOC(QR_CONTENT_HASH_SIZE,
+                                         sizeof(*priv->table.content_hash),
+                                         gf_common_mt_list_head);
+    if (priv->table.content_hash == NULL) {
+        ret = -1;
+        goto out;
+    }
+
+    for (i = 0; i < QR_CONTENT_HASH_SIZE; i++) {
+        INIT_LIST_HEAD(&priv->table.content_hash[i]);
+    }
+
     ret = 0;
 
     priv->last_child_down = gf_time();
@@ -1623,6 +1946,27 @@ struct volume_options qr_options[] = {
                        "changes to file data. So, use this only when mtime "
                        "is not reliable",
     },
+    {
+        .key = {"cache-dedup"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Store cached file content by its checksum, so that "
+                       "files with identical content share a single copy "
+                       "in the cache.",
+    },
+    {
+        .key = {"cache-compression"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_11_0},
+        .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+        .description = "Compress cached file content when it is shared "
+                       "with cache-dedup, with LZ4 if built with it and "
+                       "zlib otherwise. Trades CPU time on reads for "
+                       "more files fitting in cache-size.",
+    },
     {.key = {NULL}}};
 
 xlator_api_t xlator_api = {
@@ -29,8 +29,23 @@
 #include <fnmatch.h>
 #include "quick-read-mem-types.h"
 
+#define QR_CONTENT_HASH_SIZE 1024
+
+/* File content shared by all the inodes caching the same data. */
+struct qr_content {
+    struct list_head hash;
+    unsigned char checksum[SHA256_DIGEST_LENGTH];
+    void *data;
+    size_t size;   /* size of the file content */
+    size_t stored; /* bytes held in data, smaller when compressed */
+    uint32_t ref;
+    gf_boolean_t compressed;
+};
+typedef struct qr_content qr_content_t;
+
 struct qr_inode {
     void *data;
+    qr_content_t *content; /* used instead of data with cache-dedup */
     size_t size;
     int priority;
     uint32_t ia_mtime;
@@ -60,13 +75,18 @@ struct qr_conf {
     int max_pri;
     gf_boolean_t qr_invalidation;
     gf_boolean_t ctime_invalidation;
+    gf_boolean_t cache_dedup;
+    gf_boolean_t cache_compression;
     struct list_head priority_list;
 };
 typedef struct qr_conf qr_conf_t;
 
 struct qr_inode_table {
-    uint64_t cache_used;
+    uint64_t cache_used;    /* bytes of memory holding file content */
+    uint64_t cache_logical; /* sum of the sizes of the cached files */
+    uint64_t contents;
     struct list_head *lru;
+    struct list_head *content_hash;
     gf_lock_t lock;
 };
 typedef struct qr_inode_table qr_inode_table_t;
@@ -76,6 +96,7 @@ struct qr_statistics {
     gf_atomic_t cache_miss;
     gf_atomic_t file_data_invals; /* No. of invalidates received from upcall */
     gf_atomic_t files_cached;
+    gf_atomic_t content_shared; /* files cached without a new copy */
 };
 
 struct qr_private {
@@ -21,12 +21,20 @@
  * The translator is currently designed to handle the simple, sequential case
  * only. If a non-sequential directory read occurs, readdir-ahead disables
  * preloads on the directory.
+ *
+ * With rda-dir-cache enabled, a complete listing read through an fd is also
+ * kept in the inode context of the directory after the fd is released. Later
+ * opendir+readdirp of the same directory is then served from memory. Entry
+ * fops passing through this xlator are replayed on the cached listing and
+ * upcall invalidations (or rda-dir-cache-timeout) drop it.
  */
 
 #include <math.h>
 #include <glusterfs/glusterfs.h>
 #include <glusterfs/xlator.h>
 #include <glusterfs/call-stub.h>
+#include <glusterfs/statedump.h>
+#include <glusterfs/upcall-utils.h>
 #include "readdir-ahead.h"
 #include "readdir-ahead-mem-types.h"
 #include <glusterfs/defaults.h>
@@ -43,6 +51,8 @@ rda_local_wipe(struct rda_local *local)
         dict_unref(local->xattrs);
     if (local->inode)
         inode_unref(local->inode);
+    loc_wipe(&local->loc);
+    loc_wipe(&local->loc2);
 }
 
 /*
@@ -64,6 +74,7 @@ get_rda_fd_ctx(fd_t *fd, xlator_t *this)
 
         LOCK_INIT(&ctx->lock);
         INIT_LIST_HEAD(&ctx->entries.list);
+        INIT_LIST_HEAD(&ctx->snapshot.list);
         ctx->state = RDA_FD_NEW;
         /* ctx offset values initialized to 0 */
         ctx->xattrs = NULL;
@@ -97,6 +108,7 @@ __rda_inode_ctx_get(inode_t *inode, xlator_t *this)
         return NULL;
 
     GF_ATOMIC_INIT(ctx_p->generation, 0);
+    GF_ATOMIC_INIT(ctx_p->dir_generation, 0);
 
     ctx_uint = (uint64_t)(uintptr_t)ctx_p;
     ret = __inode_ctx_set1(inode, this, &ctx_uint);
@@ -108,6 +120,20 @@ __rda_inode_ctx_get(inode_t *inode, xlator_t *this)
     return ctx_p;
 }
 
+static rda_inode_ctx_t *
+rda_inode_ctx_get(inode_t *inode, xlator_t *this)
+{
+    rda_inode_ctx_t *ctx_p = NULL;
+
+    LOCK(&inode->lock);
+    {
+        ctx_p = __rda_inode_ctx_get(inode, this);
+    }
+    UNLOCK(&inode->lock);
+
+    return ctx_p;
+}
+
 static int
 __rda_inode_ctx_update_iatts(inode_t *inode, xlator_t *this,
                              struct iatt *stbuf_in, struct iatt *stbuf_out,
@@ -181,6 +207,359 @@ rda_inode_ctx_update_iatts(inode_t *inode, xlator_t *this,
     return ret;
 }
 
+static void
+__rda_snapshot_discard(struct rda_fd_ctx *ctx)
+{
+    ctx->snapshotting = _gf_false;
+    ctx->snapshot_size = 0;
+    gf_dirent_free(&ctx->snapshot);
+}
+
+/*
+ * Record a copy of an entry read from the children, so that the complete
+ * listing can be installed in the dir cache once we hit EOD. ctx must be
+ * locked.
+ */
+static void
+__rda_snapshot_add(xlator_t *this, struct rda_fd_ctx *ctx, gf_dirent_t *dirent,
+                   size_t dirent_size)
+{
+    struct rda_priv *priv = this->private;
+    gf_dirent_t *copy = NULL;
+
+    if (ctx->snapshot_size + dirent_size > priv->dir_cache_limit)
+        goto discard;
+
+    copy = entry_copy(dirent);
+    if (!copy)
+        goto discard;
+
+    /* inodes are resolved again when the listing is served */
+    if (copy->inode) {
+        inode_unref(copy->inode);
+        copy->inode = NULL;
+    }
+
+    list_add_tail(&copy->list, &ctx->snapshot.list);
+    ctx->snapshot_size += dirent_size;
+    return;
+
+discard:
+    __rda_snapshot_discard(ctx);
+}
+
+/* dc_lock must be held */
+static void
+__rda_dir_cache_free(struct rda_priv *priv, struct rda_dir_cache *dcache)
+{
+    list_del_init(&dcache->lru);
+    if (dcache->ictx)
+        dcache->ictx->dcache = NULL;
+
+    priv->dc_size -= dcache->size;
+    gf_dirent_free(&dcache->entries);
+    GF_FREE(dcache);
+}
+
+/* Evict least recently used listings until @extra more bytes fit. */
+static void
+__rda_dir_cache_prune(struct rda_priv *priv, uint64_t extra)
+{
+    struct rda_dir_cache *victim = NULL;
+
+    while ((priv->dc_size + extra > priv->dir_cache_limit) &&
+           !list_empty(&priv->dc_lru)) {
+        victim = list_entry(priv->dc_lru.prev, struct rda_dir_cache, lru);
+        __rda_dir_cache_free(priv, victim);
+        GF_ATOMIC_INC(priv->dc_counter.evictions);
+    }
+}
+
+static void
+rda_dir_cache_flush(xlator_t *this)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_cache *dcache = NULL;
+    struct rda_dir_cache *tmp = NULL;
+
+    LOCK(&priv->dc_lock);
+    {
+        list_for_each_entry_safe(dcache, tmp, &priv->dc_lru, lru)
+        {
+            __rda_dir_cache_free(priv, dcache);
+        }
+    }
+    UNLOCK(&priv->dc_lock);
+}
+
+static rda_inode_ctx_t *
+rda_dir_cache_ctx(xlator_t *this, inode_t *inode)
+{
+    uint64_t ctx_uint = 0;
+
+    if (!inode || (inode_ctx_get1(inode, this, &ctx_uint) != 0))
+        return NULL;
+
+    return (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
+}
+
+/*
+ * Drop the cached listing of a directory. Bumping the generation also makes
+ * any listing of it that is currently being read unfit for caching.
+ */
+static void
+rda_dir_cache_invalidate(xlator_t *this, inode_t *inode)
+{
+    struct rda_priv *priv = this->private;
+    rda_inode_ctx_t *ctx_p = NULL;
+
+    ctx_p = rda_dir_cache_ctx(this, inode);
+    if (!ctx_p)
+        return;
+
+    GF_ATOMIC_INC(ctx_p->dir_generation);
+
+    LOCK(&priv->dc_lock);
+    {
+        if (ctx_p->dcache) {
+            __rda_dir_cache_free(priv, ctx_p->dcache);
+            GF_ATOMIC_INC(priv->dc_counter.invals);
+        }
+    }
+    UNLOCK(&priv->dc_lock);
+}
+
+static void
+rda_dir_cache_install(xlator_t *this, inode_t *inode, gf_dirent_t *snapshot,
+                      size_t size, uint64_t generation)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_cache *dcache = NULL;
+    rda_inode_ctx_t *ctx_p = NULL;
+
+    ctx_p = rda_inode_ctx_get(inode, this);
+    if (!ctx_p)
+        goto out;
+
+    dcache = GF_CALLOC(1, sizeof(*dcache), gf_rda_mt_dir_cache_t);
+    if (!dcache)
+        goto out;
+
+    INIT_LIST_HEAD(&dcache->lru);
+    INIT_LIST_HEAD(&dcache->entries.list);
+
+    LOCK(&priv->dc_lock);
+    {
+        /* the directory changed while it was being listed */
+        if ((GF_ATOMIC_GET(ctx_p->dir_generation) != generation) ||
+            (size > priv->dir_cache_limit))
+            goto unlock;
+
+        if (ctx_p->dcache)
+            __rda_dir_cache_free(priv, ctx_p->dcache);
+
+        __rda_dir_cache_prune(priv, size);
+
+        list_splice_init(&snapshot->list, &dcache->entries.list);
+        dcache->size = size;
+        dcache->expire = gf_time() + priv->dir_cache_timeout;
+        dcache->ictx = ctx_p;
+        ctx_p->dcache = dcache;
+        list_add(&dcache->lru, &priv->dc_lru);
+        priv->dc_size += size;
+        dcache = NULL;
+    }
+unlock:
+    UNLOCK(&priv->dc_lock);
+
+out:
+    GF_FREE(dcache);
+    gf_dirent_free(snapshot);
+}
+
+/*
+ * Copy the cached listing of directory @inode into @entries, resolving the
+ * inode of every entry the way protocol/client does. Returns the size to be
+ * accounted for the entries, or -1 if there is no usable listing.
+ */
+static ssize_t
+rda_dir_cache_get(xlator_t *this, inode_t *inode, gf_dirent_t *entries)
+{
+    struct rda_priv *priv = this->private;
+    struct rda_dir_cache *dcache = NULL;
+    rda_inode_ctx_t *ctx_p = NULL;
+    gf_dirent_t *dirent = NULL;
+    gf_dirent_t *copy = NULL;
+    ssize_t size = -1;
+
+    ctx_p = rda_dir_cache_ctx(this, inode);
+    if (!ctx_p)
+        goto out;
+
+    LOCK(&priv->dc_lock);
+    {
+        dcache = ctx_p->dcache;
+        if (dcache && (dcache->expire <= gf_time())) {
+            __rda_dir_cache_free(priv, dcache);
+            dcache = NULL;
+        }
+
+        if (dcache) {
+            list_move(&dcache->lru, &priv->dc_lru);
+            size = dcache->size;
+            list_for_each_entry(dirent, &dcache->entries.list, list)
+            {
+                copy = entry_copy(dirent);
+                if (!copy) {
+                    size = -1;
+                    break;
+                }
+                list_add_tail(&copy->list, &entries->list);
+            }
+        }
+    }
+    UNLOCK(&priv->dc_lock);
+
+    if (size < 0) {
+        gf_dirent_free(entries);
+        goto out;
+    }
+
+    list_for_each_entry(dirent, &entries->list, list)
+    {
+        dirent->inode = inode_find(inode->table, dirent->d_stat.ia_gfid);
+        if (!dirent->inode)
+            dirent->inode = inode_new(inode->table);
+
+        if (dirent->inode && !((strcmp(dirent->d_name, ".") == 0) ||
+                               (strcmp(dirent->d_name, "..") == 0))) {
+            rda_inode_ctx_update_iatts(dirent->inode, this, &dirent->d_stat,
+                                       &dirent->d_stat, -1);
+        }
+    }
+
+out:
+    if (size < 0)
+        GF_ATOMIC_INC(priv->dc_counter.misses);
+    else
+        GF_ATOMIC_INC(priv->dc_counter.hits);
+
+    return size;
+}
+
+/* dc_lock must be held */
+static void
+__rda_dir_cache_del_name(struct rda_priv *priv, struct rda_dir_cache *dcache,
+                         const char *name)
+{
+    gf_dirent_t *dirent = NULL;
+    size_t dirent_size = 0;
+
+    list_for_each_entry(dirent, &dcache->entries.list, list)
+    {
+        if (strcmp(dirent->d_name, name) != 0)
+            continue;
+
+        dirent_size = gf_dirent_size(dirent->d_name);
+        gf_dirent_entry_free(dirent);
+        dcache->size -= dirent_size;
+        priv->dc_size -= dirent_size;
+        break;
+    }
+}
+
+/*
+ * Replay the creation of @name on the cached listing of @parent. The new
+ * entry takes the offset of the current last entry, so a listing resumed
+ * from it continues past the end of the directory.
+ */
+static void
+rda_dir_cache_add_entry(xlator_t *this, inode_t *parent, const char *name,
+                        struct iatt *stbuf)
+{
+    struct rda_priv *priv = this->private;
+    rda_inode_ctx_t *ctx_p = NULL;
+    gf_dirent_t *entry = NULL;
+    gf_dirent_t *last = NULL;
+    size_t dirent_size = 0;
+
+    if (!name || !stbuf)
+        return;
+
+    /* dht linkto files are filtered using xattrs we don't have here */
+    if (IS_DHT_LINKFILE_MODE(stbuf)) {
+        rda_dir_cache_invalidate(this, parent);
+        return;
+    }
+
+    ctx_p = rda_dir_cache_ctx(this, parent);
+    if (!ctx_p)
+        return;
+
+    entry = gf_dirent_for_name(name);
+    if (!entry) {
+        rda_dir_cache_invalidate(this, parent);
+        return;
+    }
+
+    entry->d_ino = stbuf->ia_ino;
+    entry->d_type = gf_d_type_from_ia_type(stbuf->ia_type);
+    entry->d_stat = *stbuf;
+    dirent_size = gf_dirent_size(name);
+
+    GF_ATOMIC_INC(ctx_p->dir_generation);
+
+    LOCK(&priv->dc_lock);
+    {
+        if (ctx_p->dcache) {
+            __rda_dir_cache_del_name(priv, ctx_p->dcache, name);
+
+            if (!list_empty(&ctx_p->dcache->entries.list)) {
+                last = list_entry(ctx_p->dcache->entries.list.prev,
+                                  gf_dirent_t, list);
+                entry->d_off = last->d_off;
+            }
+
+            list_add_tail(&entry->list, &ctx_p->dcache->entries.list);
+            ctx_p->dcache->size += dirent_size;
+            priv->dc_size += dirent_size;
+            entry = NULL;
+
+            __rda_dir_cache_prune(priv, 0);
+            GF_ATOMIC_INC(priv->dc_counter.patches);
+        }
+    }
+    UNLOCK(&priv->dc_lock);
+
+    if (entry)
+        gf_dirent_entry_free(entry);
+}
+
+static void
+rda_dir_cache_del_entry(xlator_t *this, inode_t *parent, const char *name)
+{
+    struct rda_priv *priv = this->private;
+    rda_inode_ctx_t *ctx_p = NULL;
+
+    if (!name)
+        return;
+
+    ctx_p = rda_dir_cache_ctx(this, parent);
+    if (!ctx_p)
+        return;
+
+    GF_ATOMIC_INC(ctx_p->dir_generation);
+
+    LOCK(&priv->dc_lock);
+    {
+        if (ctx_p->dcache) {
+            __rda_dir_cache_del_name(priv, ctx_p->dcache, name);
+            GF_ATOMIC_INC(priv->dc_counter.patches);
+        }
+    }
+    UNLOCK(&priv->dc_lock);
+}
+
 /*
  * Reset the tracking state of the context.
  */
@@ -191,6 +570,8 @@ rda_reset_ctx(xlator_t *this, struct rda_fd_ctx *ctx)
 
     priv = this->private;
 
+    __rda_snapshot_discard(ctx);
+
     ctx->state = RDA_FD_NEW;
     ctx->cur_offset = 0;
     ctx->next_offset = 0;
@@ -499,8 +880,13 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     };
     uint64_t generation = 0;
     call_frame_t *fill_frame = NULL;
+    gf_dirent_t snapshot;
+    size_t snapshot_size = 0;
+    uint64_t dir_generation = 0;
+    gf_boolean_t install = _gf_false;
 
     INIT_LIST_HEAD(&serve_entries.list);
+    INIT_LIST_HEAD(&snapshot.list);
     LOCK(&ctx->lock);
 
     /* Verify that the preload buffer is still pending on this data. */
@@ -546,6 +932,9 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
 
             dirent_size = gf_dirent_size(dirent->d_name);
 
+            if (ctx->snapshotting)
+                __rda_snapshot_add(this, ctx, dirent, dirent_size);
+
             ctx->cur_size += dirent_size;
 
             GF_ATOMIC_ADD(priv->rda_cache_size, dirent_size);
@@ -569,6 +958,14 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         ctx->state &= ~RDA_FD_RUNNING;
         ctx->state |= RDA_FD_EOD;
         ctx->op_errno = op_errno;
+
+        if (ctx->snapshotting) {
+            list_splice_init(&ctx->snapshot.list, &snapshot.list);
+            snapshot_size = ctx->snapshot_size;
+            dir_generation = ctx->dir_generation;
+            install = _gf_true;
+            __rda_snapshot_discard(ctx);
+        }
     } else if (op_ret == -1) {
         /* kill the preload and pend the error */
         ctx->state &= ~RDA_FD_RUNNING;
@@ -589,6 +986,10 @@ rda_fill_fd_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
 out:
+    /* a partial or broken listing must not end up in the dir cache */
+    if (ctx->snapshotting && (ctx->state & (RDA_FD_BYPASS | RDA_FD_ERROR)))
+        __rda_snapshot_discard(ctx);
+
     /*
      * If we have been marked for bypass and have no pending stub, clear the
      * run state so we stop preloading the context with entries.
@@ -618,6 +1019,11 @@ out:
         op_errno = 0;
 
     UNLOCK(&ctx->lock);
+
+    if (install)
+        rda_dir_cache_install(this, local->fd->inode, &snapshot, snapshot_size,
+                              dir_generation);
+
     if (fill_frame) {
         rda_local_wipe(fill_frame->local);
         STACK_DESTROY(fill_frame->root);
@@ -636,6 +1042,83 @@ out:
     return 0;
 }
 
+/*
+ * Populate a new (or rewound) fd context from the dir cache instead of
+ * reading the directory from the children. Returns 0 if the listing was
+ * served from the cache.
+ */
+static int
+rda_fill_fd_from_cache(xlator_t *this, fd_t *fd, struct rda_fd_ctx *ctx)
+{
+    struct rda_priv *priv = this->private;
+    gf_dirent_t entries;
+    gf_dirent_t serve_entries;
+    gf_dirent_t *last = NULL;
+    call_stub_t *stub = NULL;
+    dict_t *xattrs = NULL;
+    ssize_t size = 0;
+    int ret = 0;
+    int op_errno = 0;
+
+    if (!(ctx->state & RDA_FD_NEW) || ctx->next_offset)
+        return -1;
+
+    INIT_LIST_HEAD(&entries.list);
+    INIT_LIST_HEAD(&serve_entries.list);
+
+    size = rda_dir_cache_get(this, fd->inode, &entries);
+    if (size < 0)
+        return -1;
+
+    LOCK(&ctx->lock);
+    {
+        if (!(ctx->state & RDA_FD_NEW) || ctx->next_offset ||
+            !list_empty(&ctx->entries.list)) {
+            UNLOCK(&ctx->lock);
+            gf_dirent_free(&entries);
+            return -1;
+        }
+
+        if (!list_empty(&entries.list)) {
+            last = list_entry(entries.list.prev, gf_dirent_t, list);
+            ctx->next_offset = last->d_off;
+        }
+
+        list_splice_init(&entries.list, &ctx->entries.list);
+        ctx->cur_size += size;
+        GF_ATOMIC_ADD(priv->rda_cache_size, size);
+
+        ctx->state = RDA_FD_EOD | RDA_FD_CACHED;
+        ctx->op_errno = ENOENT;
+
+        xattrs = ctx->xattrs;
+        ctx->xattrs = NULL;
+
+        if (ctx->stub && rda_can_serve_readdirp(ctx, ctx->stub->args.size)) {
+            ret = __rda_serve_readdirp(this, ctx, ctx->stub->args.size,
+                                       &serve_entries, &op_errno);
+            stub = ctx->stub;
+            ctx->stub = NULL;
+
+            if (op_errno == ENOENT && ctx->cur_size)
+                op_errno = 0;
+        }
+    }
+    UNLOCK(&ctx->lock);
+
+    if (xattrs)
+        dict_unref(xattrs);
+
+    if (stub) {
+        STACK_UNWIND_STRICT(readdirp, stub->frame, ret, op_errno,
+                            &serve_entries, NULL);
+        gf_dirent_free(&serve_entries);
+        call_stub_destroy(stub);
+    }
+
+    return 0;
+}
+
 /*
  * Start prepopulating the fd context with directory entries.
  */
@@ -648,11 +1131,23 @@ rda_fill_fd(call_frame_t *frame, xlator_t *this, fd_t *fd)
     struct rda_fd_ctx *ctx;
     off_t offset;
     struct rda_priv *priv = this->private;
+    rda_inode_ctx_t *dir_ctx = NULL;
+    uint64_t dir_generation = 0;
 
     ctx = get_rda_fd_ctx(fd, this);
     if (!ctx)
         goto err;
 
+    if (priv->dir_cache && (ctx->state & RDA_FD_NEW)) {
+        if (rda_fill_fd_from_cache(this, fd, ctx) == 0)
+            return 0;
+
+        /* sample the generation before reading, see rda_fill_fd_cbk() */
+        dir_ctx = rda_inode_ctx_get(fd->inode, this);
+        if (dir_ctx)
+            dir_generation = GF_ATOMIC_GET(dir_ctx->dir_generation);
+    }
+
     LOCK(&ctx->lock);
 
     if (ctx->state & RDA_FD_NEW) {
@@ -660,6 +1155,11 @@ rda_fill_fd(call_frame_t *frame, xlator_t *this, fd_t *fd)
         ctx->state |= RDA_FD_RUNNING;
         if (priv->rda_low_wmark)
             ctx->state |= RDA_FD_PLUGGED;
+
+        if (dir_ctx && !ctx->next_offset) {
+            ctx->snapshotting = _gf_true;
+            ctx->dir_generation = dir_generation;
+        }
     }
 
     offset = ctx->next_offset;
@@ -1129,6 +1629,232 @@ rda_fremovexattr(call_frame_t *frame, xlator_t *this, fd_t *fd,
     return 0;
 }
 
+static int32_t
+rda_create_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, fd_t *fd, inode_t *inode,
+               struct iatt *buf, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_add_entry(this, local->loc.parent, local->loc.name, buf);
+
+unwind:
+    RDA_STACK_UNWIND(create, frame, op_ret, op_errno, fd, inode, buf,
+                     preparent, postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_create(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+           mode_t mode, mode_t umask, fd_t *fd, dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(create, frame, this, loc, NULL, xdata, loc, flags,
+                         mode, umask, fd);
+    return 0;
+}
+
+static int32_t
+rda_mkdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, inode_t *inode,
+              struct iatt *buf, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_add_entry(this, local->loc.parent, local->loc.name, buf);
+
+unwind:
+    RDA_STACK_UNWIND(mkdir, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_mkdir(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+          mode_t umask, dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(mkdir, frame, this, loc, NULL, xdata, loc, mode,
+                         umask);
+    return 0;
+}
+
+static int32_t
+rda_mknod_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, inode_t *inode,
+              struct iatt *buf, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_add_entry(this, local->loc.parent, local->loc.name, buf);
+
+unwind:
+    RDA_STACK_UNWIND(mknod, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_mknod(call_frame_t *frame, xlator_t *this, loc_t *loc, mode_t mode,
+          dev_t rdev, mode_t umask, dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(mknod, frame, this, loc, NULL, xdata, loc, mode, rdev,
+                         umask);
+    return 0;
+}
+
+static int32_t
+rda_symlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                int32_t op_ret, int32_t op_errno, inode_t *inode,
+                struct iatt *buf, struct iatt *preparent,
+                struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_add_entry(this, local->loc.parent, local->loc.name, buf);
+
+unwind:
+    RDA_STACK_UNWIND(symlink, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_symlink(call_frame_t *frame, xlator_t *this, const char *linkname,
+            loc_t *loc, mode_t umask, dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(symlink, frame, this, loc, NULL, xdata, linkname, loc,
+                         umask);
+    return 0;
+}
+
+static int32_t
+rda_link_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int32_t op_ret,
+             int32_t op_errno, inode_t *inode, struct iatt *buf,
+             struct iatt *preparent, struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_add_entry(this, local->loc2.parent, local->loc2.name, buf);
+
+unwind:
+    RDA_STACK_UNWIND(link, frame, op_ret, op_errno, inode, buf, preparent,
+                     postparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_link(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+         dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(link, frame, this, oldloc, newloc, xdata, oldloc,
+                         newloc);
+    return 0;
+}
+
+static int32_t
+rda_unlink_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+               struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_del_entry(this, local->loc.parent, local->loc.name);
+
+unwind:
+    RDA_STACK_UNWIND(unlink, frame, op_ret, op_errno, preparent, postparent,
+                     xdata);
+    return 0;
+}
+
+static int32_t
+rda_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t xflags,
+           dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(unlink, frame, this, loc, NULL, xdata, loc, xflags);
+    return 0;
+}
+
+static int32_t
+rda_rmdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+              int32_t op_ret, int32_t op_errno, struct iatt *preparent,
+              struct iatt *postparent, dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_del_entry(this, local->loc.parent, local->loc.name);
+    rda_dir_cache_invalidate(this, local->loc.inode);
+
+unwind:
+    RDA_STACK_UNWIND(rmdir, frame, op_ret, op_errno, preparent, postparent,
+                     xdata);
+    return 0;
+}
+
+static int32_t
+rda_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+          dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(rmdir, frame, this, loc, NULL, xdata, loc, flags);
+    return 0;
+}
+
+static int32_t
+rda_rename_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+               int32_t op_ret, int32_t op_errno, struct iatt *buf,
+               struct iatt *preoldparent, struct iatt *postoldparent,
+               struct iatt *prenewparent, struct iatt *postnewparent,
+               dict_t *xdata)
+{
+    struct rda_local *local = frame->local;
+
+    if (op_ret < 0 || !local)
+        goto unwind;
+
+    rda_dir_cache_del_entry(this, local->loc.parent, local->loc.name);
+    rda_dir_cache_add_entry(this, local->loc2.parent, local->loc2.name, buf);
+
+    /* ".." of a renamed directory may now point elsewhere */
+    if (buf && buf->ia_type == IA_IFDIR)
+        rda_dir_cache_invalidate(this, local->loc.inode);
+
+unwind:
+    RDA_STACK_UNWIND(rename, frame, op_ret, op_errno, buf, preoldparent,
+                     postoldparent, prenewparent, postnewparent, xdata);
+    return 0;
+}
+
+static int32_t
+rda_rename(call_frame_t *frame, xlator_t *this, loc_t *oldloc, loc_t *newloc,
+           dict_t *xdata)
+{
+    RDA_COMMON_ENTRY_FOP(rename, frame, this, oldloc, newloc, xdata, oldloc,
+                         newloc);
+    return 0;
+}
+
 static int32_t
 rda_releasedir(xlator_t *this, fd_t *fd)
 {
@@ -1161,6 +1887,7 @@ rda_forget(xlator_t *this, inode_t *inode)
 {
     uint64_t ctx_uint = 0;
     rda_inode_ctx_t *ctx = NULL;
+    struct rda_priv *priv = NULL;
 
     inode_ctx_del1(inode, this, &ctx_uint);
     if (!ctx_uint)
@@ -1168,11 +1895,127 @@ rda_forget(xlator_t *this, inode_t *inode)
 
     ctx = (rda_inode_ctx_t *)(uintptr_t)ctx_uint;
 
+    if (ctx->dcache) {
+        priv = this->private;
+        LOCK(&priv->dc_lock);
+        {
+            if (ctx->dcache)
+                __rda_dir_cache_free(priv, ctx->dcache);
+        }
+        UNLOCK(&priv->dc_lock);
+    }
+
     GF_FREE(ctx);
 
     return 0;
 }
 
+static void
+rda_dir_cache_invalidate_gfid(xlator_t *this, inode_table_t *itable,
+                              uuid_t gfid)
+{
+    inode_t *inode = NULL;
+
+    if (gf_uuid_is_null(gfid))
+        return;
+
+    inode = inode_find(itable, gfid);
+    if (!inode)
+        return;
+
+    rda_dir_cache_invalidate(this, inode);
+    inode_unref(inode);
+}
+
+/*
+ * Another client changed something. Upcalls don't carry entry names, so
+ * the listings of the inode and of its parent(s) are dropped instead of
+ * patched.
+ */
+static void
+rda_dir_cache_upcall(xlator_t *this, struct gf_upcall *up_data)
+{
+    struct gf_upcall_cache_invalidation *up_ci = NULL;
+    inode_table_t *itable = NULL;
+
+    if (up_data->event_type != GF_UPCALL_CACHE_INVALIDATION)
+        return;
+
+    up_ci = (struct gf_upcall_cache_invalidation *)up_data->data;
+    itable = ((xlator_t *)this->graph->top)->itable;
+    if (!itable)
+        return;
+
+    rda_dir_cache_invalidate_gfid(this, itable, up_data->gfid);
+
+    if (up_ci->flags & UP_PARENT_DENTRY_FLAGS) {
+        rda_dir_cache_invalidate_gfid(this, itable, up_ci->p_stat.ia_gfid);
+        if (up_ci->flags & UP_RENAME_FLAGS)
+            rda_dir_cache_invalidate_gfid(this, itable,
+                                          up_ci->oldp_stat.ia_gfid);
+    }
+}
+
+static int
+rda_notify(xlator_t *this, int event, void *data, ...)
+{
+    struct rda_priv *priv = this->private;
+
+    if ((event == GF_EVENT_UPCALL) && priv && priv->dir_cache)
+        rda_dir_cache_upcall(this, data);
+
+    return default_notify(this, event, data);
+}
+
+static int
+rda_priv_dump(xlator_t *this)
+{
+    struct rda_priv *priv = NULL;
+    char key_prefix[GF_DUMP_MAX_BUF_LEN];
+    uint64_t dc_size = 0;
+    uint32_t dc_count = 0;
+    struct rda_dir_cache *dcache = NULL;
+
+    if (!this || !this->private)
+        return -1;
+
+    priv = this->private;
+
+    gf_proc_dump_build_key(key_prefix, "xlator.performance.readdir-ahead",
+                           "priv");
+    gf_proc_dump_add_section("%s", key_prefix);
+
+    gf_proc_dump_write("rda_cache_size", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->rda_cache_size));
+    gf_proc_dump_write("dir_cache", "%s", priv->dir_cache ? "on" : "off");
+
+    LOCK(&priv->dc_lock);
+    {
+        dc_size = priv->dc_size;
+        list_for_each_entry(dcache, &priv->dc_lru, lru)
+        {
+            dc_count++;
+        }
+    }
+    UNLOCK(&priv->dc_lock);
+
+    gf_proc_dump_write("dir_cache_limit", "%" PRIu64, priv->dir_cache_limit);
+    gf_proc_dump_write("dir_cache_used", "%" PRIu64, dc_size);
+    gf_proc_dump_write("dir_cache_dirs", "%" PRIu32, dc_count);
+    gf_proc_dump_write("dir_cache_hits", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->dc_counter.hits));
+    gf_proc_dump_write("dir_cache_misses", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->dc_counter.misses));
+    gf_proc_dump_write("dir_cache_patches", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->dc_counter.patches));
+    gf_proc_dump_write("dir_cache_invalidations", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->dc_counter.invals));
+    gf_proc_dump_write("dir_cache_evictions", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(priv->dc_counter.evictions));
+
+    return 0;
+}
+
 int32_t
 mem_acct_init(xlator_t *this)
 {
@@ -1208,6 +2051,22 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("parallel-readdir", priv->parallel_readdir, options, bool,
                      err);
     GF_OPTION_RECONF("pass-through", this->pass_through, options, bool, err);
+    GF_OPTION_RECONF("rda-dir-cache", priv->dir_cache, options, bool, err);
+    GF_OPTION_RECONF("rda-dir-cache-limit", priv->dir_cache_limit, options,
+                     size_uint64, err);
+    GF_OPTION_RECONF("rda-dir-cache-timeout", priv->dir_cache_timeout, options,
+                     uint32, err);
+
+    /* entry fops are not tracked with the dir cache off, drop what we have */
+    if (!priv->dir_cache) {
+        rda_dir_cache_flush(this);
+    } else {
+        LOCK(&priv->dc_lock);
+        {
+            __rda_dir_cache_prune(priv, 0);
+        }
+        UNLOCK(&priv->dc_lock);
+    }
 
     return 0;
 err:
@@ -1241,6 +2100,13 @@ init(xlator_t *this)
     this->private = priv;
 
     GF_ATOMIC_INIT(priv->rda_cache_size, 0);
+    LOCK_INIT(&priv->dc_lock);
+    INIT_LIST_HEAD(&priv->dc_lru);
+    GF_ATOMIC_INIT(priv->dc_counter.hits, 0);
+    GF_ATOMIC_INIT(priv->dc_counter.misses, 0);
+    GF_ATOMIC_INIT(priv->dc_counter.patches, 0);
+    GF_ATOMIC_INIT(priv->dc_counter.invals, 0);
+    GF_ATOMIC_INIT(priv->dc_counter.evictions, 0);
 
     this->local_pool = mem_pool_new(struct rda_local, 32);
     if (!this->local_pool)
@@ -1252,14 +2118,21 @@ init(xlator_t *this)
     GF_OPTION_INIT("rda-cache-limit", priv->rda_cache_limit, size_uint64, err);
     GF_OPTION_INIT("parallel-readdir", priv->parallel_readdir, bool, err);
     GF_OPTION_INIT("pass-through", this->pass_through, bool, err);
+    GF_OPTION_INIT("rda-dir-cache", priv->dir_cache, bool, err);
+    GF_OPTION_INIT("rda-dir-cache-limit", priv->dir_cache_limit, size_uint64,
+                   err);
+    GF_OPTION_INIT("rda-dir-cache-timeout", priv->dir_cache_timeout, uint32,
+                   err);
 
     return 0;
 
 err:
     if (this->local_pool)
         mem_pool_destroy(this->local_pool);
-    if (priv)
+    if (priv) {
+        LOCK_DESTROY(&priv->dc_lock);
         GF_FREE(priv);
+    }
 
     return -1;
 }
@@ -1267,9 +2140,17 @@ err:
 void
 fini(xlator_t *this)
 {
+    struct rda_priv *priv = NULL;
+
     GF_VALIDATE_OR_GOTO("readdir-ahead", this, out);
 
-    GF_FREE(this->private);
+    priv = this->private;
+    if (priv) {
+        rda_dir_cache_flush(this);
+        LOCK_DESTROY(&priv->dc_lock);
+    }
+
+    GF_FREE(priv);
 
 out:
     return;
@@ -1295,6 +2176,15 @@ struct xlator_fops fops = {
     .fsetattr = rda_fsetattr,
     .removexattr = rda_removexattr,
     .fremovexattr = rda_fremovexattr,
+    /* entry ops, to keep the dir cache up to date */
+    .create = rda_create,
+    .mkdir = rda_mkdir,
+    .mknod = rda_mknod,
+    .symlink = rda_symlink,
+    .link = rda_link,
+    .unlink = rda_unlink,
+    .rmdir = rda_rmdir,
+    .rename = rda_rename,
 };
 
 struct xlator_cbks cbks = {
@@ -1302,6 +2192,10 @@ struct xlator_cbks cbks = {
     .forget = rda_forget,
 };
 
+struct xlator_dumpops dumpops = {
+    .priv = rda_priv_dump,
+};
+
 struct volume_options options[] = {
     {
         .key = {"readdir-ahead"},
@@ -1365,6 +2259,38 @@ struct volume_options options[] = {
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_CLIENT_OPT,
      .tags = {"readdir-ahead"},
      .description = "Enable/Disable readdir ahead translator"},
+    {.key = {"rda-dir-cache"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"readdir-ahead"},
+     .description = "If enabled, complete directory listings are kept after "
+                    "the directory is closed and later listings of the "
+                    "same directory are served from memory. Entry "
+                    "operations from this client are applied to the "
+                    "cached listing; enable features.cache-invalidation "
+                    "to have changes from other clients drop it."},
+    {.key = {"rda-dir-cache-limit"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = INFINITY,
+     .default_value = "32MB",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"readdir-ahead"},
+     .description = "maximum memory used by the directory listing cache. "
+                    "Least recently used listings are evicted beyond it."},
+    {.key = {"rda-dir-cache-timeout"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 600,
+     .default_value = "1",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"readdir-ahead"},
+     .description = "Time period in seconds after which a cached directory "
+                    "listing is refreshed from the bricks."},
     {.key = {NULL}},
 };
 
@@ -1372,8 +2298,10 @@ xlator_api_t xlator_api = {
     .init = init,
     .fini = fini,
     .reconfigure = reconfigure,
+    .notify = rda_notify,
     .mem_acct_init = mem_acct_init,
     .op_version = {1}, /* Present from the initial version */
+    .dumpops = &dumpops,
     .fops = &fops,
     .cbks = &cbks,
     .options = options,
@@ -18,6 +18,7 @@
 #define RDA_FD_ERROR (1 << 3)
 #define RDA_FD_BYPASS (1 << 4)
 #define RDA_FD_PLUGGED (1 << 5)
+#define RDA_FD_CACHED (1 << 6) /* entries were served from the dir cache */
 
 #define RDA_COMMON_MODIFICATION_FOP(name, frame, this, __inode, __xdata,       \
                                     args...)                                   \
@@ -42,6 +43,37 @@
                    FIRST_CHILD(this)->fops->name, args, __xdata);              \
     } while (0)
 
+/*
+ * Entry fops are only tracked when the dir cache is enabled, so that the
+ * cached listing of the parent(s) can be patched in the callback.
+ */
+#define RDA_COMMON_ENTRY_FOP(name, frame, this, __loc, __loc2, __xdata,       \
+                             args...)                                          \
+    do {                                                                       \
+        struct rda_local *__local = NULL;                                      \
+        struct rda_priv *__priv = this->private;                               \
+                                                                               \
+        if (!__priv->dir_cache) {                                              \
+            STACK_WIND_TAIL(frame, FIRST_CHILD(this),                          \
+                            FIRST_CHILD(this)->fops->name, args, __xdata);     \
+            break;                                                             \
+        }                                                                      \
+                                                                               \
+        __local = mem_get0(this->local_pool);                                  \
+        if (__local) {                                                         \
+            loc_copy(&__local->loc, __loc);                                    \
+            if (__loc2)                                                        \
+                loc_copy(&__local->loc2, __loc2);                              \
+        } else {                                                               \
+            /* can't patch the listing in the cbk, drop everything */         \
+            rda_dir_cache_flush(this);                                         \
+        }                                                                      \
+        frame->local = __local;                                                \
+                                                                               \
+        STACK_WIND(frame, rda_##name##_cbk, FIRST_CHILD(this),                 \
+                   FIRST_CHILD(this)->fops->name, args, __xdata);              \
+    } while (0)
+
 #define RDA_STACK_UNWIND(fop, frame, params...)                                \
     do {                                                                       \
         struct rda_local *__local = NULL;                                      \
@@ -69,6 +101,10 @@ struct rda_fd_ctx {
     dict_t *xattrs; /* md-cache keys to be sent in readdirp() */
     dict_t *writes_during_prefetch;
     gf_atomic_t prefetching;
+    gf_dirent_t snapshot; /* copy of the listing, to seed the dir cache */
+    size_t snapshot_size;
+    uint64_t dir_generation; /* dir generation when the snapshot began */
+    gf_boolean_t snapshotting;
 };
 
 struct rda_local {
@@ -79,6 +115,21 @@ struct rda_local {
     off_t offset;
     uint64_t generation;
     int32_t skip_dir;
+    loc_t loc;  /* entry fops: the entry created/removed */
+    loc_t loc2; /* rename: the destination entry */
+};
+
+/*
+ * A complete listing of a directory, kept beyond the life of the fd that
+ * read it. Entries are stored without inodes; they are looked up (or
+ * created) again in the inode table when the listing is served.
+ */
+struct rda_dir_cache {
+    struct list_head lru; /* rda_priv->dc_lru, protected by dc_lock */
+    struct rda_inode_ctx *ictx;
+    gf_dirent_t entries;
+    size_t size;
+    time_t expire;
 };
 
 struct rda_priv {
@@ -88,11 +139,29 @@ struct rda_priv {
     uint64_t rda_cache_limit;
     gf_atomic_t rda_cache_size;
     gf_boolean_t parallel_readdir;
+
+    /* directory listing cache */
+    gf_boolean_t dir_cache;
+    uint64_t dir_cache_limit;
+    uint32_t dir_cache_timeout;
+    gf_lock_t dc_lock;
+    struct list_head dc_lru;
+    uint64_t dc_size; /* protected by dc_lock */
+    struct {
+        gf_atomic_t hits;
+        gf_atomic_t misses;
+        gf_atomic_t patches;
+        gf_atomic_t invals;
+        gf_atomic_t evictions;
+    } dc_counter;
 };
 
 typedef struct rda_inode_ctx {
     struct iatt statbuf;
     gf_atomic_t generation;
+    /* bumped whenever an entry of this directory changes */
+    gf_atomic_t dir_generation;
+    struct rda_dir_cache *dcache; /* protected by rda_priv->dc_lock */
 } rda_inode_ctx_t;
 
 #endif /* __READDIR_AHEAD_H */
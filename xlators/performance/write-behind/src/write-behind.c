@@ -2407,6 +2407,7 @@ wb_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
         fd_t *fd, dict_t *xdata)
 {
     wb_inode_t *wb_inode = NULL;
+    gf_boolean_t pending = _gf_false;
 
     wb_inode = wb_inode_create(this, fd->inode);
     if (!wb_inode)
@@ -2415,6 +2416,18 @@ wb_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
     if (((flags & O_RDWR) || (flags & O_WRONLY)) && (flags & O_TRUNC))
         wb_inode->size = 0;
 
+    /* data read along with the open would miss the cached writes */
+    if (xdata && dict_get_sizen(xdata, GF_OPEN_READ_SIZE_KEY)) {
+        LOCK(&wb_inode->lock);
+        {
+            pending = !list_empty(&wb_inode->all);
+        }
+        UNLOCK(&wb_inode->lock);
+
+        if (pending)
+            dict_del_sizen(xdata, GF_OPEN_READ_SIZE_KEY);
+    }
+
     STACK_WIND_TAIL(frame, FIRST_CHILD(this), FIRST_CHILD(this)->fops->open,
                     loc, flags, fd, xdata);
     return 0;
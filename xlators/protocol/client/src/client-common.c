@@ -13,6 +13,7 @@
 #include "rpc-common-xdr.h"
 #include "glusterfs4-xdr.h"
 #include "glusterfs3.h"
+#include "xdr-native.h"
 #include "client.h"
 
 int32_t
@@ -94,16 +95,13 @@ client_post_common_dict(xlator_t *this, gfx_common_dict_rsp *rsp, dict_t **dict,
 }
 
 int
-client_post_readv_v2(xlator_t *this, gfx_read_rsp *rsp, struct iobref **iobref,
-                     struct iobref *rsp_iobref, struct iatt *stat,
+client_post_readv_v2(xlator_t *this, gfx_native_read_rsp *rsp,
+                     struct iobref **iobref, struct iobref *rsp_iobref,
                      struct iovec *vector, struct iovec *rsp_vector,
                      int *rspcount, dict_t **xdata)
 {
-    int ret = -1;
-
     if (rsp->op_ret != -1) {
         *iobref = rsp_iobref;
-        gfx_stat_to_iattx(&rsp->stat, stat);
 
         vector[0].iov_len = rsp->op_ret;
         if (rsp->op_ret > 0)
@@ -111,16 +109,17 @@ client_post_readv_v2(xlator_t *this, gfx_read_rsp *rsp, struct iobref **iobref,
         *rspcount = 1;
     }
 
-    ret = xdr_to_dict(&rsp->xdata, xdata);
+    *xdata = rsp->xdata;
 
 #ifdef GF_TESTING_IO_XDATA
     dict_dump_to_log(xdata);
 #endif
-    return ret;
+    return 0;
 }
 
 int
-client_pre_stat_v2(xlator_t *this, gfx_stat_req *req, loc_t *loc, dict_t *xdata)
+client_pre_stat_v2(xlator_t *this, gfx_native_stat_req *req, loc_t *loc,
+                   dict_t *xdata)
 {
     int op_errno = ESTALE;
 
@@ -135,7 +134,7 @@ client_pre_stat_v2(xlator_t *this, gfx_stat_req *req, loc_t *loc, dict_t *xdata)
     GF_ASSERT_AND_GOTO_WITH_ERROR(!gf_uuid_is_null(*((uuid_t *)req->gfid)), out,
                                   op_errno, EINVAL);
 
-    dict_to_xdr(xdata, &req->xdata);
+    req->xdata = xdata;
 
     return 0;
 out:
@@ -414,8 +413,8 @@ out:
 }
 
 int
-client_pre_readv_v2(xlator_t *this, gfx_read_req *req, fd_t *fd, size_t size,
-                    off_t offset, int32_t flags, dict_t *xdata)
+client_pre_readv_v2(xlator_t *this, gfx_native_rw_req *req, fd_t *fd,
+                    size_t size, off_t offset, int32_t flags, dict_t *xdata)
 {
     int64_t remote_fd = -1;
     int op_errno = ESTALE;
@@ -430,7 +429,7 @@ client_pre_readv_v2(xlator_t *this, gfx_read_req *req, fd_t *fd, size_t size,
 
     memcpy(req->gfid, fd->inode->gfid, 16);
 
-    dict_to_xdr(xdata, &req->xdata);
+    req->xdata = xdata;
 
     return 0;
 out:
@@ -438,8 +437,8 @@ out:
 }
 
 int
-client_pre_writev_v2(xlator_t *this, gfx_write_req *req, fd_t *fd, size_t size,
-                     off_t offset, int32_t flags, dict_t **xdata)
+client_pre_writev_v2(xlator_t *this, gfx_native_rw_req *req, fd_t *fd,
+                     size_t size, off_t offset, int32_t flags, dict_t **xdata)
 {
     int64_t remote_fd = -1;
     int op_errno = ESTALE;
@@ -462,7 +461,7 @@ client_pre_writev_v2(xlator_t *this, gfx_write_req *req, fd_t *fd, size_t size,
                        "testing-the-xdata-value");
 #endif
 
-    dict_to_xdr(*xdata, &req->xdata);
+    req->xdata = *xdata;
 
     return 0;
 out:
@@ -599,8 +598,8 @@ out:
 }
 
 int
-client_pre_getxattr_v2(xlator_t *this, gfx_getxattr_req *req, loc_t *loc,
-                       const char *name, dict_t *xdata)
+client_pre_getxattr_v2(xlator_t *this, gfx_native_getxattr_req *req,
+                       loc_t *loc, const char *name, dict_t *xdata)
 {
     int op_errno = ESTALE;
 
@@ -624,7 +623,7 @@ client_pre_getxattr_v2(xlator_t *this, gfx_getxattr_req *req, loc_t *loc,
         req->namelen = 0;
     }
 
-    dict_to_xdr(xdata, &req->xdata);
+    req->xdata = xdata;
 
     return 0;
 out:
@@ -840,7 +839,7 @@ out:
 }
 
 int
-client_pre_lookup_v2(xlator_t *this, gfx_lookup_req *req, loc_t *loc,
+client_pre_lookup_v2(xlator_t *this, gfx_native_lookup_req *req, loc_t *loc,
                      dict_t *xdata)
 {
     int op_errno = ESTALE;
@@ -863,9 +862,8 @@ client_pre_lookup_v2(xlator_t *this, gfx_lookup_req *req, loc_t *loc,
     else
         req->bname = "";
 
-    if (xdata) {
-        dict_to_xdr(xdata, &req->xdata);
-    }
+    req->xdata = xdata;
+
     return 0;
 out:
     return -op_errno;
@@ -894,8 +892,9 @@ out:
 }
 
 int
-client_pre_inodelk_v2(xlator_t *this, gfx_inodelk_req *req, loc_t *loc, int cmd,
-                      struct gf_flock *flock, const char *volume, dict_t *xdata)
+client_pre_inodelk_v2(xlator_t *this, gfx_native_inodelk_req *req, loc_t *loc,
+                      int cmd, struct gf_flock *flock, const char *volume,
+                      dict_t *xdata)
 {
     int op_errno = ESTALE;
     int32_t gf_cmd = 0;
@@ -941,7 +940,7 @@ client_pre_inodelk_v2(xlator_t *this, gfx_inodelk_req *req, loc_t *loc, int cmd,
     req->type = gf_type;
     gf_proto_flock_from_flock(&req->flock, flock);
 
-    dict_to_xdr(xdata, &req->xdata);
+    req->xdata = xdata;
 
     return 0;
 out:
@@ -1061,7 +1060,7 @@ out:
 }
 
 int
-client_pre_xattrop_v2(xlator_t *this, gfx_xattrop_req *req, loc_t *loc,
+client_pre_xattrop_v2(xlator_t *this, gfx_native_xattrop_req *req, loc_t *loc,
                       dict_t *xattr, int32_t flags, dict_t *xdata)
 {
     int op_errno = ESTALE;
@@ -1076,11 +1075,11 @@ client_pre_xattrop_v2(xlator_t *this, gfx_xattrop_req *req, loc_t *loc,
 
     GF_ASSERT_AND_GOTO_WITH_ERROR(!gf_uuid_is_null(*((uuid_t *)req->gfid)), out,
                                   op_errno, EINVAL);
-    dict_to_xdr(xattr, &req->dict);
+    req->dict = xattr;
 
     req->flags = flags;
 
-    dict_to_xdr(xdata, &req->xdata);
+    req->xdata = xdata;
 
     return 0;
 out:
@@ -1231,7 +1230,7 @@ out:
 }
 
 int
-client_pre_readdirp_v2(xlator_t *this, gfx_readdirp_req *req, fd_t *fd,
+client_pre_readdirp_v2(xlator_t *this, gfx_native_readdirp_req *req, fd_t *fd,
                        size_t size, off_t offset, dict_t *xdata)
 {
     int op_errno = ESTALE;
@@ -1246,7 +1245,7 @@ client_pre_readdirp_v2(xlator_t *this, gfx_readdirp_req *req, fd_t *fd,
     memcpy(req->gfid, fd->inode->gfid, 16);
 
     /* dict itself is 'xdata' here */
-    dict_to_xdr(xdata, &req->xdata);
+    req->xdata = xdata;
 
     return 0;
 out:
@@ -1477,13 +1476,15 @@ client_post_readdir_v2(xlator_t *this, gfx_readdir_rsp *rsp,
 }
 
 int
-client_post_readdirp_v2(xlator_t *this, gfx_readdirp_rsp *rsp, fd_t *fd,
-                        gf_dirent_t *entries, dict_t **xdata)
+client_post_readdirp_v2(xlator_t *this, gfx_native_readdirp_rsp *rsp,
+                        fd_t *fd, dict_t **xdata)
 {
     if (rsp->op_ret > 0) {
-        unserialize_rsp_direntp_v2(this, fd, rsp, entries);
+        unserialize_rsp_direntp_v2(this, fd, rsp->entries);
     }
-    return xdr_to_dict(&rsp->xdata, xdata);
+    *xdata = rsp->xdata;
+
+    return 0;
 }
 
 int
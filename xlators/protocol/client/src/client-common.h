@@ -16,6 +16,7 @@
 #include "rpc-common-xdr.h"
 #include "glusterfs4-xdr.h"
 #include "glusterfs3.h"
+#include "xdr-native.h"
 #include "client.h"
 
 
@@ -37,7 +38,7 @@ int
 client_post_common_rsp(xlator_t *this, gfx_common_rsp *rsp, dict_t **xdata);
 
 int
-client_pre_stat_v2(xlator_t *this, gfx_stat_req *req, loc_t *loc,
+client_pre_stat_v2(xlator_t *this, gfx_native_stat_req *req, loc_t *loc,
                    dict_t *xdata);
 
 int
@@ -81,12 +82,12 @@ client_pre_open_v2(xlator_t *this, gfx_open_req *req, loc_t *loc, fd_t *fd,
                    int32_t flags, dict_t *xdata);
 
 int
-client_pre_readv_v2(xlator_t *this, gfx_read_req *req, fd_t *fd, size_t size,
-                    off_t offset, int32_t flags, dict_t *xdata);
+client_pre_readv_v2(xlator_t *this, gfx_native_rw_req *req, fd_t *fd,
+                    size_t size, off_t offset, int32_t flags, dict_t *xdata);
 
 int
-client_pre_writev_v2(xlator_t *this, gfx_write_req *req, fd_t *fd, size_t size,
-                     off_t offset, int32_t flags, dict_t **xdata);
+client_pre_writev_v2(xlator_t *this, gfx_native_rw_req *req, fd_t *fd,
+                     size_t size, off_t offset, int32_t flags, dict_t **xdata);
 
 int
 client_pre_statfs_v2(xlator_t *this, gfx_statfs_req *req, loc_t *loc,
@@ -105,8 +106,8 @@ client_pre_setxattr_v2(xlator_t *this, gfx_setxattr_req *req, loc_t *loc,
                        dict_t *xattr, int32_t flags, dict_t *xdata);
 
 int
-client_pre_getxattr_v2(xlator_t *this, gfx_getxattr_req *req, loc_t *loc,
-                       const char *name, dict_t *xdata);
+client_pre_getxattr_v2(xlator_t *this, gfx_native_getxattr_req *req,
+                       loc_t *loc, const char *name, dict_t *xdata);
 
 int
 client_pre_removexattr_v2(xlator_t *this, gfx_removexattr_req *req, loc_t *loc,
@@ -141,7 +142,7 @@ client_pre_lk_v2(xlator_t *this, gfx_lk_req *req, int32_t cmd,
                  struct gf_flock *flock, fd_t *fd, dict_t *xdata);
 
 int
-client_pre_lookup_v2(xlator_t *this, gfx_lookup_req *req, loc_t *loc,
+client_pre_lookup_v2(xlator_t *this, gfx_native_lookup_req *req, loc_t *loc,
                      dict_t *xdata);
 
 int
@@ -149,8 +150,8 @@ client_pre_readdir_v2(xlator_t *this, gfx_readdir_req *req, fd_t *fd,
                       size_t size, off_t offset, dict_t *xdata);
 
 int
-client_pre_inodelk_v2(xlator_t *this, gfx_inodelk_req *req, loc_t *loc, int cmd,
-                      struct gf_flock *flock, const char *volume,
+client_pre_inodelk_v2(xlator_t *this, gfx_native_inodelk_req *req, loc_t *loc,
+                      int cmd, struct gf_flock *flock, const char *volume,
                       dict_t *xdata);
 
 int
@@ -169,7 +170,7 @@ client_pre_fentrylk_v2(xlator_t *this, gfx_fentrylk_req *req, fd_t *fd,
                        const char *volume, const char *basename, dict_t *xdata);
 
 int
-client_pre_xattrop_v2(xlator_t *this, gfx_xattrop_req *req, loc_t *loc,
+client_pre_xattrop_v2(xlator_t *this, gfx_native_xattrop_req *req, loc_t *loc,
                       dict_t *xattr, int32_t flags, dict_t *xdata);
 
 int
@@ -199,7 +200,7 @@ client_pre_fsetattr_v2(xlator_t *this, gfx_fsetattr_req *req, fd_t *fd,
                        int32_t valid, struct iatt *stbuf, dict_t *xdata);
 
 int
-client_pre_readdirp_v2(xlator_t *this, gfx_readdirp_req *req, fd_t *fd,
+client_pre_readdirp_v2(xlator_t *this, gfx_native_readdirp_req *req, fd_t *fd,
                        size_t size, off_t offset, dict_t *xdata);
 
 int
@@ -229,8 +230,8 @@ client_pre_put_v2(xlator_t *this, gfx_put_req *req, loc_t *loc, mode_t mode,
                   dict_t *xattr, dict_t *xdata);
 
 int
-client_post_readv_v2(xlator_t *this, gfx_read_rsp *rsp, struct iobref **iobref,
-                     struct iobref *rsp_iobref, struct iatt *stat,
+client_post_readv_v2(xlator_t *this, gfx_native_read_rsp *rsp,
+                     struct iobref **iobref, struct iobref *rsp_iobref,
                      struct iovec *vector, struct iovec *rsp_vector,
                      int *rspcount, dict_t **xdata);
 
@@ -248,8 +249,8 @@ int
 client_post_readdir_v2(xlator_t *this, gfx_readdir_rsp *rsp,
                        gf_dirent_t *entries, dict_t **xdata);
 int
-client_post_readdirp_v2(xlator_t *this, gfx_readdirp_rsp *rsp, fd_t *fd,
-                        gf_dirent_t *entries, dict_t **xdata);
+client_post_readdirp_v2(xlator_t *this, gfx_native_readdirp_rsp *rsp,
+                        fd_t *fd, dict_t **xdata);
 int
 client_post_rename_v2(xlator_t *this, gfx_rename_rsp *rsp, struct iatt *stbuf,
                       struct iatt *preoldparent, struct iatt *postoldparent,
@@ -469,6 +469,8 @@ client_setvolume_cbk(struct rpc_req *req, struct iovec *iov, int count,
     int ret = 0;
     int32_t op_ret = 0;
     int32_t op_errno = 0;
+    int32_t batch_rpc = 0;
+    char *compression = NULL;
     gf_boolean_t auth_fail = _gf_false;
     glusterfs_ctx_t *ctx = NULL;
 
@@ -599,6 +601,20 @@ client_setvolume_cbk(struct rpc_req *req, struct iovec *iov, int count,
         conf->child_up = (child_up_int != 0);
     }
 
+    /* bricks not knowing BATCH calls leave the key out */
+    ret = dict_get_int32_sizen(reply, "batch-rpc", &batch_rpc);
+    conf->batch_rpc = (ret == 0 && batch_rpc);
+
+    /* the brick compresses what it sends from now on, and takes the same
+     * from us */
+    ret = dict_get_str_sizen(reply, "compression", &compression);
+    if (ret == 0 && rpc_transport_set_compression(req->conn->trans,
+                                                  compression) == 0)
+        snprintf(conf->compression, sizeof(conf->compression), "%s",
+                 compression);
+    else
+        snprintf(conf->compression, sizeof(conf->compression), "off");
+
     /* TODO: currently setpeer path is broken */
     /*
     if (process_uuid && req->conn &&
@@ -630,6 +646,7 @@ client_setvolume_cbk(struct rpc_req *req, struct iovec *iov, int count,
     op_ret = 0;
     conf->connected = 1;
 
+    client_channels_start(this);
     client_post_handshake(frame, frame->this);
 out:
     if (auth_fail) {
@@ -747,6 +764,19 @@ client_setvolume(xlator_t *this, struct rpc_clnt *rpc)
                 "client-version=%s", PACKAGE_VERSION, NULL);
     }
 
+    /* what the transport inflates, which is not necessarily what the
+     * options say when the algorithm is not built in */
+    if (rpc->conn.trans->compress_offer) {
+        ret = dict_set_str_sizen(options, "transport-compression",
+                                 (char *)rpc->conn.trans->compress_offer);
+        if (ret < 0) {
+            gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_DICT_SET_FAILED,
+                    "transport-compression", NULL);
+        }
+    } else {
+        dict_del_sizen(options, "transport-compression");
+    }
+
     ret = dict_get_str_sizen(this->options, "remote-subvolume", &remote_subvol);
     if (ret || !remote_subvol) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FIND_KEY_FAILED,
@@ -835,6 +865,128 @@ fail:
     return ret;
 }
 
+static int
+client_channel_setvolume_cbk(struct rpc_req *req, struct iovec *iov, int count,
+                             void *myframe)
+{
+    call_frame_t *frame = myframe;
+    xlator_t *this = frame->this;
+    clnt_conf_t *conf = this->private;
+    client_channel_t *ch = NULL;
+    dict_t *reply = NULL;
+    char *compression = NULL;
+    gf_setvolume_rsp rsp = {
+        0,
+    };
+    int ret = -1;
+
+    ch = client_channel_get(conf, req->conn->rpc_clnt);
+    if (!ch || req->rpc_status == -1)
+        goto out;
+
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gf_setvolume_rsp);
+    if (ret < 0) {
+        gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
+                NULL);
+        goto out;
+    }
+    if (rsp.op_ret < 0) {
+        gf_smsg(this->name, GF_LOG_WARNING, gf_error_to_errno(rsp.op_errno),
+                PC_MSG_SETVOLUME_FAIL, "conn-name=%s",
+                req->conn->rpc_clnt->conn.name, NULL);
+        ret = -1;
+        goto out;
+    }
+
+    /* The first connection may have been lost, or even attached again as
+     * another client, while this SETVOLUME was on the way. */
+    pthread_mutex_lock(&conf->lock);
+    {
+        ret = -1;
+        if (ch->started && conf->connected &&
+            ch->setvol_gen == conf->setvol_count) {
+            ch->up = _gf_true;
+            ret = 0;
+        }
+    }
+    pthread_mutex_unlock(&conf->lock);
+
+    /* same options as the first connection, same answer */
+    if (!ret && rsp.dict.dict_len) {
+        reply = dict_new();
+        if (reply &&
+            dict_unserialize(rsp.dict.dict_val, rsp.dict.dict_len, &reply) ==
+                0 &&
+            dict_get_str_sizen(reply, "compression", &compression) == 0)
+            rpc_transport_set_compression(req->conn->trans, compression);
+    }
+
+    if (!ret) {
+        GF_ATOMIC_INC(ch->connects);
+        gf_smsg(this->name, GF_LOG_INFO, 0, PC_MSG_CHANNEL_CONNECTED,
+                "conn-name=%s", req->conn->rpc_clnt->conn.name, NULL);
+    }
+out:
+    /* reconnect and try again */
+    if (ret && ch && req->rpc_status != -1)
+        rpc_transport_disconnect(req->conn->trans, _gf_false);
+
+    free(rsp.dict.dict_val);
+
+    if (reply)
+        dict_unref(reply);
+
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+/* Attaches an additional connection to the client the first connection
+ * made on the brick, sending the same options, process-uuid included. */
+int
+client_channel_setvolume(xlator_t *this, client_channel_t *ch)
+{
+    int ret = -1;
+    gf_setvolume_req req = {
+        {
+            0,
+        },
+    };
+    call_frame_t *fr = NULL;
+    clnt_conf_t *conf = this->private;
+
+    ret = dict_allocate_and_serialize(this->options,
+                                      (char **)&req.dict.dict_val,
+                                      &req.dict.dict_len);
+    if (ret != 0) {
+        ret = -1;
+        gf_smsg(this->name, GF_LOG_ERROR, 0, PC_MSG_DICT_SERIALIZE_FAIL, NULL);
+        goto out;
+    }
+
+    fr = create_frame(this, this->ctx->pool);
+    if (!fr) {
+        ret = -1;
+        goto out;
+    }
+
+    pthread_mutex_lock(&conf->lock);
+    {
+        ch->setvol_gen = conf->setvol_count;
+    }
+    pthread_mutex_unlock(&conf->lock);
+    ch->rpc->auth_value = conf->rpc->auth_value;
+
+    ret = client_submit_request_channel(this, ch, &req, fr, conf->handshake,
+                                        GF_HNDSK_SETVOLUME,
+                                        client_channel_setvolume_cbk, NULL,
+                                        (xdrproc_t)xdr_gf_setvolume_req);
+out:
+    GF_FREE(req.dict.dict_val);
+
+    return ret;
+}
+
 static int
 select_server_supported_programs(xlator_t *this, gf_prog_detail *prog)
 {
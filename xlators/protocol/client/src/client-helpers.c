@@ -171,19 +171,16 @@ out:
     return ret;
 }
 
+/* the entries come decoded already, only their d_off and inode are not
+ * what the fops above expect yet */
 int
-unserialize_rsp_direntp_v2(xlator_t *this, fd_t *fd,
-                           struct gfx_readdirp_rsp *rsp, gf_dirent_t *entries)
+unserialize_rsp_direntp_v2(xlator_t *this, fd_t *fd, gf_dirent_t *entries)
 {
-    struct gfx_dirplist *trav = NULL;
     gf_dirent_t *entry = NULL;
     inode_table_t *itable = NULL;
-    int entry_len = 0;
     int ret = -1;
     clnt_conf_t *conf = NULL;
 
-    trav = rsp->reply;
-
     if (fd)
         itable = fd->inode->table;
 
@@ -191,30 +188,13 @@ unserialize_rsp_direntp_v2(xlator_t *this, fd_t *fd,
     if (!conf)
         goto out;
 
-    while (trav) {
-        entry_len = gf_dirent_size(trav->name);
-        entry = GF_CALLOC(1, entry_len, gf_common_mt_gf_dirent_t);
-        if (!entry)
-            goto out;
-
-        entry->d_ino = trav->d_ino;
-        gf_itransform(this, trav->d_off, &entry->d_off, conf->client_id);
-        entry->d_len = trav->d_len;
-        entry->d_type = trav->d_type;
-
-        gfx_stat_to_iattx(&trav->stat, &entry->d_stat);
-
-        strcpy(entry->d_name, trav->name);
-
-        xdr_to_dict(&trav->dict, &entry->dict);
+    list_for_each_entry(entry, &entries->list, list)
+    {
+        gf_itransform(this, entry->d_off, &entry->d_off, conf->client_id);
 
         entry->inode = inode_find(itable, entry->d_stat.ia_gfid);
         if (!entry->inode)
             entry->inode = inode_new(itable);
-
-        list_add_tail(&entry->list, &entries->list);
-
-        trav = trav->nextentry;
     }
 
     ret = 0;
@@ -222,24 +202,6 @@ out:
     return ret;
 }
 
-int
-clnt_readdirp_rsp_cleanup_v2(gfx_readdirp_rsp *rsp)
-{
-    gfx_dirplist *prev = NULL;
-    gfx_dirplist *trav = NULL;
-
-    trav = rsp->reply;
-    prev = trav;
-    while (trav) {
-        trav = trav->nextentry;
-        free(prev->name);
-        free(prev);
-        prev = trav;
-    }
-
-    return 0;
-}
-
 int
 clnt_readdir_rsp_cleanup_v2(gfx_readdir_rsp *rsp)
 {
@@ -596,3 +558,95 @@ out:
 
     return ret;
 }
+
+/* Rebuilds the data of a readv reply sent without the holes of the range:
+ * the extents received back to back in *vector are copied where the map of
+ * GF_READ_DATA_MAP_KEY places them in a new buffer of the length given by
+ * GF_READ_DATA_SIZE_KEY, at most max bytes, the rest of which is zeroed.
+ * Returns 1 when *vector and *iobref were replaced (the caller then unrefs
+ * *iobref), 0 when the reply is not sparse, or -errno. */
+int
+client_sparse_read_expand(xlator_t *this, dict_t *xdata, size_t max,
+                          struct iovec *vector, struct iobref **iobref)
+{
+    clnt_conf_t *conf = this->private;
+    struct iobuf *iobuf = NULL;
+    struct iobref *new_iobref = NULL;
+    data_t *map = NULL;
+    uint32_t *extents = NULL;
+    char *buf = NULL;
+    char *payload = NULL;
+    size_t data = 0;
+    uint32_t size = 0;
+    uint32_t start = 0;
+    uint32_t end = 0;
+    uint32_t len = 0;
+    int count = 0;
+    int i = 0;
+
+    map = dict_get_sizen(xdata, GF_READ_DATA_MAP_KEY);
+    if (!map)
+        return 0;
+
+    if (dict_get_uint32(xdata, GF_READ_DATA_SIZE_KEY, &size) || !size ||
+        size > max)
+        goto invalid;
+
+    extents = (uint32_t *)map->data;
+    count = map->len / (2 * sizeof(uint32_t));
+    payload = vector->iov_base;
+
+    /* extents come in order, inside the range and are what was received */
+    for (i = 0; i < count; i++) {
+        start = ntohl(extents[i * 2]);
+        len = ntohl(extents[i * 2 + 1]);
+        if (start < end || len > size || start > size - len)
+            goto invalid;
+        end = start + len;
+        data += len;
+    }
+    if (!count || data != vector->iov_len)
+        goto invalid;
+
+    iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+    new_iobref = iobref_new();
+    if (!iobuf || !new_iobref) {
+        if (iobuf)
+            iobuf_unref(iobuf);
+        if (new_iobref)
+            iobref_unref(new_iobref);
+        return -ENOMEM;
+    }
+    iobref_add(new_iobref, iobuf);
+    iobuf_unref(iobuf);
+
+    buf = iobuf_ptr(iobuf);
+    end = 0;
+    data = 0;
+    for (i = 0; i < count; i++) {
+        start = ntohl(extents[i * 2]);
+        len = ntohl(extents[i * 2 + 1]);
+        memset(buf + end, 0, start - end);
+        if (len)
+            memcpy(buf + start, payload + data, len);
+        end = start + len;
+        data += len;
+    }
+    memset(buf + end, 0, size - end);
+
+    GF_ATOMIC_INC(conf->sparse_reads);
+    GF_ATOMIC_ADD(conf->sparse_read_hole_bytes, size - data);
+
+    dict_del_sizen(xdata, GF_READ_DATA_MAP_KEY);
+    dict_del_sizen(xdata, GF_READ_DATA_SIZE_KEY);
+    vector->iov_base = buf;
+    vector->iov_len = size;
+    *iobref = new_iobref;
+
+    return 1;
+
+invalid:
+    gf_smsg(this->name, GF_LOG_ERROR, EIO, PC_MSG_XDR_DECODING_FAILED,
+            "key=" GF_READ_DATA_MAP_KEY, NULL);
+    return -EIO;
+}
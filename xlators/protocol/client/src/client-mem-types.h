@@ -18,6 +18,7 @@ enum gf_client_mem_types_ {
     gf_client_mt_clnt_req_buf_t,
     gf_client_mt_clnt_fdctx_t,
     gf_client_mt_clnt_lock_request_t,
+    gf_client_mt_batch_t,
     gf_client_mt_end,
 };
 #endif /* __CLIENT_MEM_TYPES_H__ */
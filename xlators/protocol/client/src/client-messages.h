@@ -61,7 +61,9 @@ GLFS_MSGID(
     PC_MSG_FATAL_CLIENT_PROTOCOL, PC_MSG_VOL_DANGLING,
     PC_MSG_CREATE_MEM_POOL_FAILED, PC_MSG_PVT_XLATOR_NULL, PC_MSG_XLATOR_NULL,
     PC_MSG_LEASE_FOP_FAILED, PC_MSG_DICT_SET_FAIL, PC_MSG_NO_MEM,
-    PC_MSG_UNKNOWN_LOCK_TYPE, PC_MSG_CLIENT_UID_ALLOC_FAILED);
+    PC_MSG_UNKNOWN_LOCK_TYPE, PC_MSG_CLIENT_UID_ALLOC_FAILED,
+    PC_MSG_CHANNEL_INIT_FAILED, PC_MSG_CHANNEL_CONNECTED,
+    PC_MSG_CHANNEL_DISCONNECTED);
 
 #define PC_MSG_REMOTE_OP_FAILED_STR "remote operation failed."
 #define PC_MSG_XDR_DECODING_FAILED_STR "XDR decoding failed"
@@ -170,5 +172,9 @@ GLFS_MSGID(
 #define PC_MSG_NO_MEM_STR "No memory"
 #define PC_MSG_UNKNOWN_LOCK_TYPE_STR "Unknown lock type"
 #define PC_MSG_CLIENT_UID_ALLOC_FAILED_STR "client-uid could not be allocated"
+#define PC_MSG_CHANNEL_INIT_FAILED_STR                                         \
+    "failed to initialize an additional connection"
+#define PC_MSG_CHANNEL_CONNECTED_STR "Additional connection attached"
+#define PC_MSG_CHANNEL_DISCONNECTED_STR "Additional connection lost"
 
 #endif /* !_PC_MESSAGES_H__ */
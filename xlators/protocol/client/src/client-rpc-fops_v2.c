@@ -371,7 +371,7 @@ int
 client4_0_stat_cbk(struct rpc_req *req, struct iovec *iov, int count,
                    void *myframe)
 {
-    gfx_common_iatt_rsp rsp = {
+    gfx_native_iatt_rsp rsp = {
         0,
     };
     call_frame_t *frame = NULL;
@@ -391,7 +391,9 @@ client4_0_stat_cbk(struct rpc_req *req, struct iovec *iov, int count,
         rsp.op_errno = ENOTCONN;
         goto out;
     }
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_common_iatt_rsp);
+
+    rsp.stat = &iatt;
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_iatt_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -400,7 +402,7 @@ client4_0_stat_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = client_post_common_iatt(this, &rsp, &iatt, &xdata);
+    xdata = rsp.xdata;
 out:
     if (rsp.op_ret == -1) {
         /* stale filehandles are possible during normal operations, no
@@ -705,7 +707,7 @@ int
 client4_0_writev_cbk(struct rpc_req *req, struct iovec *iov, int count,
                      void *myframe)
 {
-    gfx_common_2iatt_rsp rsp = {
+    gfx_native_2iatt_rsp rsp = {
         0,
     };
     call_frame_t *frame = NULL;
@@ -731,7 +733,9 @@ client4_0_writev_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_common_2iatt_rsp);
+    rsp.prestat = &prestat;
+    rsp.poststat = &poststat;
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_2iatt_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -740,9 +744,7 @@ client4_0_writev_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = client_post_common_2iatt(this, &rsp, &prestat, &poststat, &xdata);
-    if (ret < 0)
-        goto out;
+    xdata = rsp.xdata;
 out:
     if (rsp.op_ret == -1) {
         gf_smsg(this->name, GF_LOG_WARNING, gf_error_to_errno(rsp.op_errno),
@@ -918,7 +920,7 @@ int
 client4_0_getxattr_cbk(struct rpc_req *req, struct iovec *iov, int count,
                        void *myframe)
 {
-    gfx_common_dict_rsp rsp = {
+    gfx_native_dict_rsp rsp = {
         0,
     };
     call_frame_t *frame = NULL;
@@ -940,7 +942,7 @@ client4_0_getxattr_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_common_dict_rsp);
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_dict_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -950,11 +952,8 @@ client4_0_getxattr_cbk(struct rpc_req *req, struct iovec *iov, int count,
     }
 
     op_errno = gf_error_to_errno(rsp.op_errno);
-    ret = client_post_common_dict(this, &rsp, &dict, &xdata);
-    if (ret) {
-        op_errno = -ret;
-        goto out;
-    }
+    dict = rsp.dict;
+    xdata = rsp.xdata;
 
 out:
     if (rsp.op_ret == -1) {
@@ -1359,7 +1358,7 @@ client4_0_inodelk_cbk(struct rpc_req *req, struct iovec *iov, int count,
                       void *myframe)
 {
     call_frame_t *frame = NULL;
-    gfx_common_rsp rsp = {
+    gfx_native_common_rsp rsp = {
         0,
     };
     int ret = 0;
@@ -1375,7 +1374,7 @@ client4_0_inodelk_cbk(struct rpc_req *req, struct iovec *iov, int count,
         rsp.op_errno = ENOTCONN;
         goto out;
     }
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_common_rsp);
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_common_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -1384,7 +1383,7 @@ client4_0_inodelk_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    xdr_to_dict(&rsp.xdata, &xdata);
+    xdata = rsp.xdata;
 out:
     if (rsp.op_ret == -1) {
         gf_smsg(this->name,
@@ -1550,7 +1549,7 @@ client4_0_xattrop_cbk(struct rpc_req *req, struct iovec *iov, int count,
 {
     call_frame_t *frame = NULL;
     dict_t *dict = NULL;
-    gfx_common_dict_rsp rsp = {
+    gfx_native_dict_rsp rsp = {
         0,
     };
     int ret = 0;
@@ -1569,7 +1568,7 @@ client4_0_xattrop_cbk(struct rpc_req *req, struct iovec *iov, int count,
         op_errno = ENOTCONN;
         goto out;
     }
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_common_dict_rsp);
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_dict_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -1579,11 +1578,8 @@ client4_0_xattrop_cbk(struct rpc_req *req, struct iovec *iov, int count,
     }
 
     op_errno = rsp.op_errno;
-    ret = client_post_common_dict(this, &rsp, &dict, &xdata);
-    if (ret) {
-        op_errno = -ret;
-        goto out;
-    }
+    dict = rsp.dict;
+    xdata = rsp.xdata;
 out:
     if (rsp.op_ret == -1) {
         gf_smsg(this->name, fop_log_level(GF_FOP_XATTROP, op_errno),
@@ -2346,7 +2342,7 @@ client4_0_readdirp_cbk(struct rpc_req *req, struct iovec *iov, int count,
                        void *myframe)
 {
     call_frame_t *frame = NULL;
-    gfx_readdirp_rsp rsp = {
+    gfx_native_readdirp_rsp rsp = {
         0,
     };
     int32_t ret = 0;
@@ -2368,7 +2364,8 @@ client4_0_readdirp_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_readdirp_rsp);
+    rsp.entries = &entries;
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_readdirp_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -2377,7 +2374,7 @@ client4_0_readdirp_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = client_post_readdirp_v2(this, &rsp, local->fd, &entries, &xdata);
+    ret = client_post_readdirp_v2(this, &rsp, local->fd, &xdata);
 out:
     if (rsp.op_ret == -1) {
         gf_smsg(this->name, GF_LOG_WARNING, gf_error_to_errno(rsp.op_errno),
@@ -2386,15 +2383,11 @@ out:
     CLIENT_STACK_UNWIND(readdirp, frame, rsp.op_ret,
                         gf_error_to_errno(rsp.op_errno), &entries, xdata);
 
-    if (rsp.op_ret != -1) {
-        gf_dirent_free(&entries);
-    }
+    gf_dirent_free(&entries);
 
     if (xdata)
         dict_unref(xdata);
 
-    clnt_readdirp_rsp_cleanup_v2(&rsp);
-
     return 0;
 }
 
@@ -2597,7 +2590,7 @@ int
 client4_0_lookup_cbk(struct rpc_req *req, struct iovec *iov, int count,
                      void *myframe)
 {
-    gfx_common_2iatt_rsp rsp = {
+    gfx_native_2iatt_rsp rsp = {
         0,
     };
     clnt_local_t *local = NULL;
@@ -2626,7 +2619,9 @@ client4_0_lookup_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_common_2iatt_rsp);
+    rsp.prestat = &stbuf;
+    rsp.poststat = &postparent;
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_2iatt_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -2638,17 +2633,14 @@ client4_0_lookup_cbk(struct rpc_req *req, struct iovec *iov, int count,
     /* Preserve the op_errno received from the server */
     op_errno = gf_error_to_errno(rsp.op_errno);
 
-    ret = client_post_common_2iatt(this, &rsp, &stbuf, &postparent, &xdata);
-    if (ret < 0) {
-        /* Don't change the op_errno if the fop failed on server */
-        if (rsp.op_ret == 0)
-            op_errno = rsp.op_errno;
-        rsp.op_ret = -1;
-        goto out;
-    }
+    xdata = rsp.xdata;
 
-    if (rsp.op_ret < 0)
+    if (rsp.op_ret < 0) {
+        /* the attributes are only meaningful on success */
+        memset(&stbuf, 0, sizeof(stbuf));
+        memset(&postparent, 0, sizeof(postparent));
         goto out;
+    }
 
     if ((!gf_uuid_is_null(inode->gfid)) &&
         (gf_uuid_compare(stbuf.ia_gfid, inode->gfid) != 0)) {
@@ -2702,13 +2694,14 @@ client4_0_readv_cbk(struct rpc_req *req, struct iovec *iov, int count,
     struct iatt stat = {
         0,
     };
-    gfx_read_rsp rsp = {
+    gfx_native_read_rsp rsp = {
         0,
     };
     int ret = 0, rspcount = 0;
     clnt_local_t *local = NULL;
     xlator_t *this = NULL;
     dict_t *xdata = NULL;
+    struct iobref *sparse_iobref = NULL;
 
     this = THIS;
 
@@ -2721,7 +2714,8 @@ client4_0_readv_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_read_rsp);
+    rsp.stat = &stat;
+    ret = xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_native_read_rsp);
     if (ret < 0) {
         gf_smsg(this->name, GF_LOG_ERROR, EINVAL, PC_MSG_XDR_DECODING_FAILED,
                 NULL);
@@ -2732,8 +2726,22 @@ client4_0_readv_cbk(struct rpc_req *req, struct iovec *iov, int count,
 
     memset(vector, 0, sizeof(vector));
 
-    ret = client_post_readv_v2(this, &rsp, &iobref, req->rsp_iobref, &stat,
-                               vector, &req->rsp[1], &rspcount, &xdata);
+    ret = client_post_readv_v2(this, &rsp, &iobref, req->rsp_iobref, vector,
+                               &req->rsp[1], &rspcount, &xdata);
+
+    /* the brick left the holes of the range out, op_ret only counts the
+     * bytes it sent */
+    if (rsp.op_ret >= 0 && xdata) {
+        ret = client_sparse_read_expand(this, xdata, local->size, vector,
+                                        &iobref);
+        if (ret < 0) {
+            rsp.op_ret = -1;
+            rsp.op_errno = -ret;
+        } else if (ret) {
+            rsp.op_ret = vector[0].iov_len;
+            sparse_iobref = iobref;
+        }
+    }
 out:
     if (rsp.op_ret == -1) {
         gf_smsg(this->name, GF_LOG_WARNING, gf_error_to_errno(rsp.op_errno),
@@ -2746,6 +2754,8 @@ out:
                         gf_error_to_errno(rsp.op_errno), vector, rspcount,
                         &stat, iobref, xdata);
 
+    if (sparse_iobref)
+        iobref_unref(sparse_iobref);
     if (xdata)
         dict_unref(xdata);
 
@@ -3033,7 +3043,7 @@ client4_0_lookup(call_frame_t *frame, xlator_t *this, void *data)
     clnt_conf_t *conf = NULL;
     clnt_local_t *local = NULL;
     clnt_args_t *args = NULL;
-    gfx_lookup_req req = {
+    gfx_native_lookup_req req = {
         {
             0,
         },
@@ -3110,21 +3120,17 @@ client4_0_lookup(call_frame_t *frame, xlator_t *this, void *data)
     cp.rsp_iobref = local->iobref;
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_LOOKUP,
                                 client4_0_lookup_cbk, &cp,
-                                (xdrproc_t)xdr_gfx_lookup_req);
+                                (xdrproc_t)xdr_gfx_native_lookup_req);
 
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 
 unwind:
     CLIENT_STACK_UNWIND(lookup, frame, -1, op_errno, NULL, NULL, NULL, NULL);
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     if (rsp_iobref)
         iobref_unref(rsp_iobref);
 
@@ -3136,7 +3142,7 @@ client4_0_stat(call_frame_t *frame, xlator_t *this, void *data)
 {
     clnt_conf_t *conf = NULL;
     clnt_args_t *args = NULL;
-    gfx_stat_req req = {
+    gfx_native_stat_req req = {
         {
             0,
         },
@@ -3157,19 +3163,15 @@ client4_0_stat(call_frame_t *frame, xlator_t *this, void *data)
     }
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_STAT,
                                 client4_0_stat_cbk, NULL,
-                                (xdrproc_t)xdr_gfx_stat_req);
+                                (xdrproc_t)xdr_gfx_native_stat_req);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 unwind:
     CLIENT_STACK_UNWIND(stat, frame, -1, op_errno, NULL, NULL);
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 }
 
@@ -3844,7 +3846,7 @@ client4_0_readv(call_frame_t *frame, xlator_t *this, void *data)
     clnt_conf_t *conf = NULL;
     clnt_local_t *local = NULL;
     int op_errno = ESTALE;
-    gfx_read_req req = {
+    gfx_native_rw_req req = {
         {
             0,
         },
@@ -3855,6 +3857,7 @@ client4_0_readv(call_frame_t *frame, xlator_t *this, void *data)
     };
     struct iobuf *rsp_iobuf = NULL;
     struct iobref *rsp_iobref = NULL;
+    dict_t *xdata = NULL;
     client_payload_t cp;
 
     if (!frame || !this || !data)
@@ -3863,8 +3866,17 @@ client4_0_readv(call_frame_t *frame, xlator_t *this, void *data)
     args = data;
     conf = this->private;
 
+    if (conf->sparse_read) {
+        xdata = args->xdata ? dict_copy_with_ref(args->xdata, NULL)
+                            : dict_new();
+        if (!xdata || dict_set_int8(xdata, GF_READ_SPARSE_KEY, 1)) {
+            op_errno = ENOMEM;
+            goto unwind;
+        }
+    }
+
     ret = client_pre_readv_v2(this, &req, args->fd, args->size, args->offset,
-                              args->flags, args->xdata);
+                              args->flags, xdata ? xdata : args->xdata);
     if (ret) {
         op_errno = -ret;
         goto unwind;
@@ -3876,6 +3888,7 @@ client4_0_readv(call_frame_t *frame, xlator_t *this, void *data)
         goto unwind;
     }
     local = frame->local;
+    local->size = args->size;
 
     rsp_iobuf = iobuf_get2(this->ctx->iobuf_pool, args->size);
     if (rsp_iobuf == NULL) {
@@ -3912,12 +3925,13 @@ client4_0_readv(call_frame_t *frame, xlator_t *this, void *data)
     cp.rsp_iobref = local->iobref;
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_READ,
                                 client4_0_readv_cbk, &cp,
-                                (xdrproc_t)xdr_gfx_read_req);
+                                (xdrproc_t)xdr_gfx_native_rw_req);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
+    if (xdata)
+        dict_unref(xdata);
 
     return 0;
 unwind:
@@ -3925,7 +3939,8 @@ unwind:
         iobuf_unref(rsp_iobuf);
 
     CLIENT_STACK_UNWIND(readv, frame, -1, op_errno, NULL, 0, NULL, NULL, NULL);
-    GF_FREE(req.xdata.pairs.pairs_val);
+    if (xdata)
+        dict_unref(xdata);
 
     return 0;
 }
@@ -3935,7 +3950,7 @@ client4_0_writev(call_frame_t *frame, xlator_t *this, void *data)
 {
     clnt_args_t *args = NULL;
     clnt_conf_t *conf = NULL;
-    gfx_write_req req = {
+    gfx_native_rw_req req = {
         {
             0,
         },
@@ -3971,7 +3986,7 @@ client4_0_writev(call_frame_t *frame, xlator_t *this, void *data)
     cp.payload_cnt = args->count;
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_WRITE,
                                 client4_0_writev_cbk, &cp,
-                                (xdrproc_t)xdr_gfx_write_req);
+                                (xdrproc_t)xdr_gfx_native_rw_req);
     if (ret) {
         /*
          * If the lower layers fail to submit a request, they'll also
@@ -3981,13 +3996,10 @@ client4_0_writev(call_frame_t *frame, xlator_t *this, void *data)
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 
 unwind:
     CLIENT_STACK_UNWIND(writev, frame, -1, op_errno, NULL, NULL, NULL);
-    GF_FREE(req.xdata.pairs.pairs_val);
 
     return 0;
 }
@@ -4417,7 +4429,7 @@ client4_0_getxattr(call_frame_t *frame, xlator_t *this, void *data)
 {
     clnt_conf_t *conf = NULL;
     clnt_args_t *args = NULL;
-    gfx_getxattr_req req = {
+    gfx_native_getxattr_req req = {
         {
             0,
         },
@@ -4457,19 +4469,15 @@ client4_0_getxattr(call_frame_t *frame, xlator_t *this, void *data)
     }
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_GETXATTR,
                                 client4_0_getxattr_cbk, NULL,
-                                (xdrproc_t)xdr_gfx_getxattr_req);
+                                (xdrproc_t)xdr_gfx_native_getxattr_req);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 unwind:
     CLIENT_STACK_UNWIND(getxattr, frame, op_ret, op_errno, NULL, NULL);
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 }
 
@@ -4478,7 +4486,7 @@ client4_0_xattrop(call_frame_t *frame, xlator_t *this, void *data)
 {
     clnt_conf_t *conf = NULL;
     clnt_args_t *args = NULL;
-    gfx_xattrop_req req = {
+    gfx_native_xattrop_req req = {
         {
             0,
         },
@@ -4514,21 +4522,15 @@ client4_0_xattrop(call_frame_t *frame, xlator_t *this, void *data)
     }
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_XATTROP,
                                 client4_0_xattrop_cbk, NULL,
-                                (xdrproc_t)xdr_gfx_xattrop_req);
+                                (xdrproc_t)xdr_gfx_native_xattrop_req);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.dict.pairs.pairs_val);
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 unwind:
     CLIENT_STACK_UNWIND(xattrop, frame, -1, op_errno, NULL, NULL);
 
-    GF_FREE(req.dict.pairs.pairs_val);
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 }
 
@@ -4798,7 +4800,7 @@ client4_0_inodelk(call_frame_t *frame, xlator_t *this, void *data)
 {
     clnt_conf_t *conf = NULL;
     clnt_args_t *args = NULL;
-    gfx_inodelk_req req = {
+    gfx_native_inodelk_req req = {
         {
             0,
         },
@@ -4820,17 +4822,14 @@ client4_0_inodelk(call_frame_t *frame, xlator_t *this, void *data)
     }
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_INODELK,
                                 client4_0_inodelk_cbk, NULL,
-                                (xdrproc_t)xdr_gfx_inodelk_req);
+                                (xdrproc_t)xdr_gfx_native_inodelk_req);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 unwind:
     CLIENT_STACK_UNWIND(inodelk, frame, -1, op_errno, NULL);
-    GF_FREE(req.xdata.pairs.pairs_val);
 
     return 0;
 }
@@ -5081,7 +5080,7 @@ int32_t
 client4_0_readdirp(call_frame_t *frame, xlator_t *this, void *data)
 {
     clnt_args_t *args = NULL;
-    gfx_readdirp_req req = {
+    gfx_native_readdirp_req req = {
         {
             0,
         },
@@ -5162,20 +5161,16 @@ client4_0_readdirp(call_frame_t *frame, xlator_t *this, void *data)
     cp.rsp_iobref = rsp_iobref;
     ret = client_submit_request(this, &req, frame, conf->fops, GFS3_OP_READDIRP,
                                 client4_0_readdirp_cbk, &cp,
-                                (xdrproc_t)xdr_gfx_readdirp_req);
+                                (xdrproc_t)xdr_gfx_native_readdirp_req);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_FOP_SEND_FAILED, NULL);
     }
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     return 0;
 unwind:
     if (rsp_iobref)
         iobref_unref(rsp_iobref);
 
-    GF_FREE(req.xdata.pairs.pairs_val);
-
     CLIENT_STACK_UNWIND(readdirp, frame, -1, op_errno, NULL, NULL);
     return 0;
 }
@@ -6131,6 +6126,7 @@ char *clnt4_0_fop_names[GFS3_OP_MAXVALUE] = {
     [GFS3_OP_COMPOUND] = "COMPOUND",
     [GFS3_OP_ICREATE] = "ICREATE",
     [GFS3_OP_NAMELINK] = "NAMELINK",
+    [GFS3_OP_BATCH] = "BATCH",
 };
 
 rpc_clnt_procedure_t clnt4_0_fop_actors[GF_FOP_MAXVALUE] = {
@@ -15,9 +15,11 @@
 #include <glusterfs/statedump.h>
 #include <glusterfs/compat-errno.h>
 #include <glusterfs/gf-event.h>
+#include <glusterfs/hashfn.h>
 
 #include "xdr-rpc.h"
 #include "glusterfs3.h"
+#include "xdr-native.h"
 #include "client-messages.h"
 
 extern rpc_clnt_prog_t clnt_handshake_prog;
@@ -169,10 +171,295 @@ client_notify_dispatch(xlator_t *this, int32_t event, void *data, ...)
     return ret;
 }
 
+/* Picks the connection a request goes out on. Only requests on an fd are
+ * spread over the connections: reads go round robin, the others follow the
+ * gfid of the inode so that the requests on a file keep their order. Locks
+ * and everything else go on the first connection. */
+static client_channel_t *
+client_channel_pick(clnt_conf_t *conf, call_frame_t *frame,
+                    rpc_clnt_prog_t *prog, int procnum)
+{
+    clnt_local_t *local = frame->local;
+    client_channel_t *ch = NULL;
+    int count = conf->channel_count;
+    uint32_t key = 0;
+
+    if (count < 2 || prog != conf->fops || !local || !local->fd ||
+        !local->fd->inode)
+        goto first;
+
+    switch (procnum) {
+        case GFS3_OP_CREATE: /* the inode has no gfid yet */
+        case GFS3_OP_LK:
+        case GFS3_OP_INODELK:
+        case GFS3_OP_FINODELK:
+        case GFS3_OP_ENTRYLK:
+        case GFS3_OP_FENTRYLK:
+        case GFS3_OP_LEASE:
+            goto first;
+        case GFS3_OP_READ:
+            key = GF_ATOMIC_INC(conf->channel_next);
+            break;
+        default:
+            key = gf_dm_hashfn((char *)local->fd->inode->gfid,
+                               sizeof(uuid_t));
+            break;
+    }
+
+    ch = &conf->channels[key % count];
+    if (ch->up)
+        return ch;
+first:
+    return &conf->channels[0];
+}
+
+static void
+client_batch_free(client_batch_t *batch)
+{
+    int i = 0;
+
+    for (i = 0; i < batch->count; i++)
+        iobref_unref(batch->ops[i].iobref);
+    GF_FREE(batch);
+}
+
+static int
+client_batch_cbk(struct rpc_req *req, struct iovec *iov, int count,
+                 void *myframe)
+{
+    call_frame_t *frame = myframe;
+    client_batch_t *batch = frame->local;
+    client_batch_op_t *op = NULL;
+    gfx_batch_reply *reply = NULL;
+    gfx_batch_rsp rsp = {
+        0,
+    };
+    struct rpc_req opreq = {
+        0,
+    };
+    struct iovec opiov = {
+        0,
+    };
+    gf_boolean_t failed = _gf_true;
+    int i = 0;
+
+    frame->local = NULL;
+
+    if (req->rpc_status != -1 && count > 0) {
+        if (xdr_to_generic(*iov, &rsp, (xdrproc_t)xdr_gfx_batch_rsp) < 0 ||
+            rsp.replies.replies_len != batch->count)
+            gf_smsg(batch->this->name, GF_LOG_ERROR, EINVAL,
+                    PC_MSG_XDR_DECODING_FAILED, NULL);
+        else
+            failed = _gf_false;
+    }
+
+    /* each request is answered as if its reply had come on its own */
+    for (i = 0; i < batch->count; i++) {
+        op = &batch->ops[i];
+        opreq = *req;
+        opreq.procnum = op->procnum;
+
+        reply = failed ? NULL : &rsp.replies.replies_val[i];
+        if (!reply || reply->status != SUCCESS) {
+            opreq.rpc_status = -1;
+            op->cbkfn(&opreq, NULL, 0, op->frame);
+            continue;
+        }
+
+        opiov.iov_base = reply->rsp.rsp_val;
+        opiov.iov_len = reply->rsp.rsp_len;
+        opreq.rsp[0] = opiov;
+        opreq.rspcnt = 1;
+        op->cbkfn(&opreq, &opiov, 1, op->frame);
+    }
+
+    for (i = 0; i < rsp.replies.replies_len; i++)
+        free(rsp.replies.replies_val[i].rsp.rsp_val);
+    free(rsp.replies.replies_val);
+    free(rsp.xdata.pairs.pairs_val);
+
+    client_batch_free(batch);
+    STACK_DESTROY(frame->root);
+
+    return 0;
+}
+
+static void
+client_batch_send(xlator_t *this, client_batch_t *batch)
+{
+    clnt_conf_t *conf = this->private;
+    client_batch_op_t *op = NULL;
+    call_frame_t *frame = NULL;
+    struct rpc_req rpcreq = {
+        0,
+    };
+    gfx_batch_op ops[GFS3_BATCH_MAX_OPS];
+    gfx_batch_req req = {
+        {
+            0,
+        },
+    };
+    int i = 0;
+
+    if (batch->count == 1) {
+        /* nothing came along within the window */
+        op = &batch->ops[0];
+        rpc_clnt_submit(conf->rpc, conf->fops, op->procnum, op->cbkfn,
+                        &op->args, 1, NULL, 0, op->iobref, op->frame, NULL, 0,
+                        NULL, 0, NULL);
+        client_batch_free(batch);
+        return;
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        ops[i].procnum = batch->ops[i].procnum;
+        ops[i].args.args_val = batch->ops[i].args.iov_base;
+        ops[i].args.args_len = batch->ops[i].args.iov_len;
+    }
+    req.ops.ops_val = ops;
+    req.ops.ops_len = batch->count;
+
+    GF_ATOMIC_INC(conf->batches);
+    GF_ATOMIC_ADD(conf->batched_ops, batch->count);
+
+    /* the call goes with the credentials of the first request */
+    frame = copy_frame(batch->ops[0].frame);
+    if (!frame) {
+        rpcreq.rpc_status = -1;
+        for (i = 0; i < batch->count; i++)
+            batch->ops[i].cbkfn(&rpcreq, NULL, 0, batch->ops[i].frame);
+        client_batch_free(batch);
+        return;
+    }
+    frame->local = batch;
+
+    client_submit_request_channel(this, &conf->channels[0], &req, frame,
+                                  conf->fops, GFS3_OP_BATCH, client_batch_cbk,
+                                  NULL, (xdrproc_t)xdr_gfx_batch_req);
+}
+
+static void
+client_batch_timeout(void *data)
+{
+    client_batch_flush(data);
+}
+
+/* Sends the requests waiting for a BATCH call right away. */
+void
+client_batch_flush(xlator_t *this)
+{
+    clnt_conf_t *conf = this->private;
+    client_batch_t *batch = NULL;
+
+    pthread_mutex_lock(&conf->lock);
+    {
+        /* a timer firing late may find the batch of another window here,
+         * which only goes a little early */
+        batch = conf->batch;
+        conf->batch = NULL;
+        if (batch)
+            gf_timer_call_cancel(this->ctx, batch->timer);
+    }
+    pthread_mutex_unlock(&conf->lock);
+
+    if (batch)
+        client_batch_send(this, batch);
+}
+
+static gf_boolean_t
+client_batch_same_caller(call_frame_t *a, call_frame_t *b)
+{
+    return a->root->uid == b->root->uid && a->root->gid == b->root->gid &&
+           a->root->pid == b->root->pid && a->root->ngrps == b->root->ngrps &&
+           !memcmp(a->root->groups, b->root->groups,
+                   a->root->ngrps * sizeof(gid_t)) &&
+           is_same_lkowner(&a->root->lk_owner, &b->root->lk_owner);
+}
+
+/* Queues an encoded request for the next BATCH call, which is sent once
+ * it is full or client.batch-window after its first request. Returns -1
+ * if the request has to go on its own. */
+static int
+client_batch_add(xlator_t *this, call_frame_t *frame, int procnum,
+                 fop_cbk_fn_t cbkfn, struct iobref *iobref, struct iovec *args)
+{
+    clnt_conf_t *conf = this->private;
+    client_batch_t *batch = NULL;
+    client_batch_t *other = NULL;
+    client_batch_t *full = NULL;
+    client_batch_op_t *op = NULL;
+    struct timespec delta = {
+        0,
+    };
+    int ret = -1;
+
+    pthread_mutex_lock(&conf->lock);
+    {
+        batch = conf->batch;
+        if (batch && !client_batch_same_caller(batch->ops[0].frame, frame)) {
+            other = batch;
+            conf->batch = NULL;
+            gf_timer_call_cancel(this->ctx, other->timer);
+            batch = NULL;
+        }
+
+        if (!batch) {
+            batch = GF_CALLOC(1, sizeof(*batch), gf_client_mt_batch_t);
+            if (!batch)
+                goto unlock;
+            batch->this = this;
+            delta.tv_nsec = conf->batch_window * 1000;
+            batch->timer = gf_timer_call_after(this->ctx, delta,
+                                               client_batch_timeout, this);
+            if (!batch->timer) {
+                GF_FREE(batch);
+                goto unlock;
+            }
+            conf->batch = batch;
+        }
+
+        op = &batch->ops[batch->count++];
+        op->frame = frame;
+        op->cbkfn = cbkfn;
+        op->procnum = procnum;
+        op->iobref = iobref_ref(iobref);
+        op->args = *args;
+
+        if (batch->count >= conf->batch_size) {
+            full = batch;
+            conf->batch = NULL;
+            gf_timer_call_cancel(this->ctx, full->timer);
+        }
+        ret = 0;
+    }
+unlock:
+    pthread_mutex_unlock(&conf->lock);
+
+    if (other)
+        client_batch_send(this, other);
+    if (full)
+        client_batch_send(this, full);
+
+    return ret;
+}
+
 int
 client_submit_request(xlator_t *this, void *req, call_frame_t *frame,
                       rpc_clnt_prog_t *prog, int procnum, fop_cbk_fn_t cbkfn,
                       client_payload_t *cp, xdrproc_t xdrproc)
+{
+    return client_submit_request_channel(this, NULL, req, frame, prog,
+                                         procnum, cbkfn, cp, xdrproc);
+}
+
+/* Sends the request on @ch, or on the connection picked for it if NULL. */
+int
+client_submit_request_channel(xlator_t *this, client_channel_t *ch,
+                              void *req, call_frame_t *frame,
+                              rpc_clnt_prog_t *prog, int procnum,
+                              fop_cbk_fn_t cbkfn, client_payload_t *cp,
+                              xdrproc_t xdrproc)
 {
     int ret = -1;
     clnt_conf_t *conf = NULL;
@@ -207,7 +494,7 @@ client_submit_request(xlator_t *this, void *req, call_frame_t *frame,
     }
 
     if (req && xdrproc) {
-        xdr_size = xdr_sizeof(xdrproc, req);
+        xdr_size = xdr_native_sizeof(xdrproc, req);
         iobuf = iobuf_get2(this->ctx->iobuf_pool, xdr_size);
         if (!iobuf) {
             goto out;
@@ -258,14 +545,29 @@ client_submit_request(xlator_t *this, void *req, call_frame_t *frame,
         frame->root->ngrps = 1;
     }
 
+    if (!ch)
+        ch = client_channel_pick(conf, frame, prog, procnum);
+    GF_ATOMIC_INC(ch->requests);
+    GF_ATOMIC_ADD(ch->bytes, iov.iov_len);
+
+    if (conf->batch_window && conf->batch_rpc && !cp && count &&
+        ch == &conf->channels[0] && prog == conf->fops &&
+        prog->progver == GLUSTER_FOP_VERSION_v2 &&
+        GFS3_OP_BATCHABLE(procnum) &&
+        !client_batch_add(this, frame, procnum, cbkfn, new_iobref, &iov)) {
+        ret = 0;
+        goto done;
+    }
+
     /* Send the msg */
     if (cp) {
-        ret = rpc_clnt_submit(conf->rpc, prog, procnum, cbkfn, &iov, count,
+        GF_ATOMIC_ADD(ch->bytes, iov_length(cp->payload, cp->payload_cnt));
+        ret = rpc_clnt_submit(ch->rpc, prog, procnum, cbkfn, &iov, count,
                               cp->payload, cp->payload_cnt, new_iobref, frame,
                               cp->rsphdr, cp->rsphdr_cnt, cp->rsp_payload,
                               cp->rsp_payload_cnt, cp->rsp_iobref);
     } else {
-        ret = rpc_clnt_submit(conf->rpc, prog, procnum, cbkfn, &iov, count,
+        ret = rpc_clnt_submit(ch->rpc, prog, procnum, cbkfn, &iov, count,
                               NULL, 0, new_iobref, frame, NULL, 0, NULL, 0,
                               NULL);
     }
@@ -276,6 +578,7 @@ client_submit_request(xlator_t *this, void *req, call_frame_t *frame,
 
     ret = 0;
 
+done:
     if (new_iobref)
         iobref_unref(new_iobref);
 
@@ -2177,6 +2480,165 @@ out:
     return 0;
 }
 
+client_channel_t *
+client_channel_get(clnt_conf_t *conf, struct rpc_clnt *rpc)
+{
+    int i = 0;
+
+    for (i = 1; i < CLIENT_MAX_CONNECTIONS; i++) {
+        if (conf->channels[i].rpc == rpc)
+            return &conf->channels[i];
+    }
+
+    return NULL;
+}
+
+static int
+client_channel_notify(struct rpc_clnt *rpc, void *mydata,
+                      rpc_clnt_event_t event, void *data)
+{
+    xlator_t *this = mydata;
+    clnt_conf_t *conf = this->private;
+    client_channel_t *ch = NULL;
+
+    switch (event) {
+        case RPC_CLNT_CONNECT:
+            ch = client_channel_get(conf, rpc);
+            if (ch)
+                client_channel_setvolume(this, ch);
+            break;
+        case RPC_CLNT_DISCONNECT:
+            ch = client_channel_get(conf, rpc);
+            if (ch && ch->up) {
+                ch->up = _gf_false;
+                gf_smsg(this->name, GF_LOG_INFO, 0,
+                        PC_MSG_CHANNEL_DISCONNECTED, "conn-name=%s",
+                        rpc->conn.name, NULL);
+            }
+            break;
+        case RPC_CLNT_DESTROY:
+            pthread_mutex_lock(&conf->lock);
+            {
+                conf->channels_alive--;
+                pthread_cond_broadcast(&conf->fini_complete_cond);
+            }
+            pthread_mutex_unlock(&conf->lock);
+            break;
+        default:
+            break;
+    }
+
+    return 0;
+}
+
+static int
+client_channel_init(xlator_t *this, client_channel_t *ch)
+{
+    clnt_conf_t *conf = this->private;
+    dict_t *options = NULL;
+    char *name = NULL;
+    int ret = -1;
+
+    /* ping-timeout is kept: a connection the brick stops answering on is
+     * dropped on its own, failing its requests instead of leaving them
+     * waiting while the first connection still gets its pings through */
+    options = dict_copy_with_ref(this->options, NULL);
+    if (!options)
+        goto out;
+
+    if (gf_asprintf(&name, "%s.%d", this->name, ch->index) < 0) {
+        name = NULL;
+        goto out;
+    }
+
+    ch->rpc = rpc_clnt_new(options, this, name, 0);
+    if (!ch->rpc)
+        goto out;
+
+    ret = rpc_clnt_register_notify(ch->rpc, client_channel_notify, this);
+    if (ret) {
+        ch->rpc = rpc_clnt_unref(ch->rpc);
+        goto out;
+    }
+
+    pthread_mutex_lock(&conf->lock);
+    {
+        conf->channels_alive++;
+    }
+    pthread_mutex_unlock(&conf->lock);
+
+    /* the brick sends its upcalls on any of the connections */
+    ret = rpcclnt_cbk_program_register(ch->rpc, &gluster_cbk_prog, this);
+out:
+    if (ret)
+        gf_smsg(this->name, GF_LOG_WARNING, 0, PC_MSG_CHANNEL_INIT_FAILED,
+                "channel=%d", ch->index, NULL);
+    GF_FREE(name);
+    if (options)
+        dict_unref(options);
+
+    return ret;
+}
+
+/* Connects the additional connections, to the port the first one found. */
+void
+client_channels_start(xlator_t *this)
+{
+    clnt_conf_t *conf = this->private;
+    client_channel_t *ch = NULL;
+    struct rpc_clnt_config config = {
+        0,
+    };
+    gf_boolean_t start = _gf_false;
+    int i = 0;
+
+    config.remote_port = conf->rpc->conn.config.remote_port;
+
+    for (i = 1; i < conf->channel_count; i++) {
+        ch = &conf->channels[i];
+        ch->index = i;
+        if (!ch->rpc && client_channel_init(this, ch))
+            continue;
+
+        pthread_mutex_lock(&conf->lock);
+        {
+            start = !ch->started;
+            ch->started = _gf_true;
+        }
+        pthread_mutex_unlock(&conf->lock);
+
+        if (start) {
+            rpc_clnt_reconfig(ch->rpc, &config);
+            rpc_clnt_start(ch->rpc);
+        }
+    }
+}
+
+/* Disconnects the connections from @from on, without reconnecting them. */
+void
+client_channels_stop(xlator_t *this, int from)
+{
+    clnt_conf_t *conf = this->private;
+    client_channel_t *ch = NULL;
+    gf_boolean_t stop = _gf_false;
+    int i = 0;
+
+    for (i = from; i < CLIENT_MAX_CONNECTIONS; i++) {
+        ch = &conf->channels[i];
+
+        pthread_mutex_lock(&conf->lock);
+        {
+            stop = ch->started;
+            ch->started = _gf_false;
+            ch->up = _gf_false;
+        }
+        pthread_mutex_unlock(&conf->lock);
+
+        if (stop)
+            rpc_clnt_disable(ch->rpc);
+    }
+}
+
 static void
 client_mark_fd_bad(xlator_t *this)
 {
@@ -2236,6 +2698,11 @@ client_rpc_notify(struct rpc_clnt *rpc, void *mydata, rpc_clnt_event_t event,
         case RPC_CLNT_DISCONNECT:
             gf_msg_debug(this->name, 0, "got RPC_CLNT_DISCONNECT");
 
+            /* fail the requests held back for a BATCH call */
+            client_batch_flush(this);
+            /* the brick releases the fds and locks of the client only
+             * once all its connections are gone */
+            client_channels_stop(this, 1);
             client_mark_fd_bad(this);
 
             if (!conf->skip_notify) {
@@ -2348,6 +2815,8 @@ notify(xlator_t *this, int32_t event, void *data, ...)
             }
             pthread_mutex_unlock(&conf->lock);
 
+            client_batch_flush(this);
+            client_channels_stop(this, 1);
             ret = rpc_clnt_disable(conf->rpc);
             if (ret == -1 && graph) {
                 pthread_mutex_lock(&graph->mutex);
@@ -2410,6 +2879,7 @@ static int
 build_client_config(xlator_t *this, clnt_conf_t *conf)
 {
     int ret = -1;
+    int i = 0;
 
     GF_OPTION_INIT("frame-timeout", conf->rpc_conf.rpc_timeout, time, out);
 
@@ -2428,6 +2898,20 @@ build_client_config(xlator_t *this, clnt_conf_t *conf)
 
     GF_OPTION_INIT("testing.old-protocol", conf->old_protocol, bool, out);
     GF_OPTION_INIT("strict-locks", conf->strict_locks, bool, out);
+    GF_OPTION_INIT("sparse-read", conf->sparse_read, bool, out);
+    GF_ATOMIC_INIT(conf->sparse_reads, 0);
+    GF_ATOMIC_INIT(conf->sparse_read_hole_bytes, 0);
+    GF_OPTION_INIT("connection-count", conf->channel_count, int32, out);
+    GF_ATOMIC_INIT(conf->channel_next, 0);
+    GF_OPTION_INIT("batch-window", conf->batch_window, uint32, out);
+    GF_OPTION_INIT("batch-size", conf->batch_size, int32, out);
+    GF_ATOMIC_INIT(conf->batches, 0);
+    GF_ATOMIC_INIT(conf->batched_ops, 0);
+    for (i = 0; i < CLIENT_MAX_CONNECTIONS; i++) {
+        GF_ATOMIC_INIT(conf->channels[i].requests, 0);
+        GF_ATOMIC_INIT(conf->channels[i].bytes, 0);
+        GF_ATOMIC_INIT(conf->channels[i].connects, 0);
+    }
 
     conf->client_id = glusterfs_leaf_position(this);
 
@@ -2469,10 +2953,13 @@ client_destroy_rpc(xlator_t *this)
         goto out;
 
     if (conf->rpc) {
+        client_channels_stop(this, 1);
+
         /* cleanup the saved-frames before last unref */
         rpc_clnt_connection_cleanup(&conf->rpc->conn);
 
         conf->rpc = rpc_clnt_unref(conf->rpc);
+        conf->channels[0].rpc = conf->rpc;
         ret = 0;
         gf_msg_debug(this->name, 0, "Client rpc conn destroyed");
         goto out;
@@ -2509,6 +2996,7 @@ client_init_rpc(xlator_t *this)
         gf_smsg(this->name, GF_LOG_ERROR, 0, PC_MSG_RPC_NOTIFY_FAILED, NULL);
         goto out;
     }
+    conf->channels[0].rpc = conf->rpc;
 
     conf->handshake = &clnt_handshake_prog;
     conf->dump = &clnt_dump_prog;
@@ -2549,9 +3037,11 @@ reconfigure(xlator_t *this, dict_t *options)
     char *old_remote_host = NULL;
     char *new_remote_host = NULL;
     int32_t new_nthread = 0;
+    int32_t channel_count = 0;
     struct rpc_clnt_config rpc_config = {
         0,
     };
+    int i = 0;
 
     conf = this->private;
 
@@ -2602,12 +3092,32 @@ reconfigure(xlator_t *this, dict_t *options)
     /* Reconfiguring client xlator's @rpc with new frame-timeout
      * and ping-timeout */
     rpc_clnt_reconfig(conf->rpc, &rpc_config);
+    for (i = 1; i < CLIENT_MAX_CONNECTIONS; i++) {
+        if (conf->channels[i].rpc)
+            rpc_clnt_reconfig(conf->channels[i].rpc, &rpc_config);
+    }
 
     GF_OPTION_RECONF("filter-O_DIRECT", conf->filter_o_direct, options, bool,
                      out);
 
     GF_OPTION_RECONF("send-gids", conf->send_gids, options, bool, out);
     GF_OPTION_RECONF("strict-locks", conf->strict_locks, options, bool, out);
+    GF_OPTION_RECONF("sparse-read", conf->sparse_read, options, bool, out);
+
+    GF_OPTION_RECONF("connection-count", channel_count, options, int32, out);
+    if (channel_count < conf->channel_count) {
+        conf->channel_count = channel_count;
+        client_channels_stop(this, channel_count);
+    } else if (channel_count > conf->channel_count) {
+        conf->channel_count = channel_count;
+        if (conf->connected)
+            client_channels_start(this);
+    }
+
+    GF_OPTION_RECONF("batch-window", conf->batch_window, options, uint32, out);
+    GF_OPTION_RECONF("batch-size", conf->batch_size, options, int32, out);
+    if (!conf->batch_window)
+        client_batch_flush(this);
 
     ret = 0;
 out:
@@ -2689,6 +3199,7 @@ void
 fini(xlator_t *this)
 {
     clnt_conf_t *conf = NULL;
+    int i = 0;
 
     conf = this->private;
     if (!conf)
@@ -2696,6 +3207,13 @@ fini(xlator_t *this)
 
     conf->fini_completed = _gf_false;
     conf->destroy = 1;
+    client_batch_flush(this);
+    for (i = 1; i < CLIENT_MAX_CONNECTIONS; i++) {
+        if (!conf->channels[i].rpc)
+            continue;
+        rpc_clnt_connection_cleanup(&conf->channels[i].rpc->conn);
+        rpc_clnt_unref(conf->channels[i].rpc);
+    }
     if (conf->rpc) {
         /* cleanup the saved-frames before last unref */
         rpc_clnt_connection_cleanup(&conf->rpc->conn);
@@ -2704,7 +3222,7 @@ fini(xlator_t *this)
 
     pthread_mutex_lock(&conf->lock);
     {
-        while (!conf->fini_completed)
+        while (!conf->fini_completed || conf->channels_alive)
             pthread_cond_wait(&conf->fini_complete_cond, &conf->lock);
     }
     pthread_mutex_unlock(&conf->lock);
@@ -2779,6 +3297,18 @@ client_priv_dump(xlator_t *this)
     char key[GF_DUMP_MAX_BUF_LEN];
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
     rpc_clnt_connection_t *conn = NULL;
+    client_channel_t *ch = NULL;
+    rpc_transport_t *trans = NULL;
+    int64_t outstanding = 0;
+    const char *mode = NULL;
+    time_t secs = 0;
+    uint64_t saved_read = 0;
+    uint64_t saved_write = 0;
+    uint64_t compressed = 0;
+    uint64_t skipped = 0;
+    uint64_t shm_sent = 0;
+    uint64_t shm_received = 0;
+    uint64_t shm_full = 0;
 
     if (!this)
         return -1;
@@ -2807,6 +3337,10 @@ client_priv_dump(xlator_t *this)
     pthread_spin_unlock(&conf->fd_lock);
 
     gf_proc_dump_write("connected", "%d", conf->connected);
+    gf_proc_dump_write("sparse_reads", "%" PRId64,
+                       GF_ATOMIC_GET(conf->sparse_reads));
+    gf_proc_dump_write("sparse_read_hole_bytes", "%" PRId64,
+                       GF_ATOMIC_GET(conf->sparse_read_hole_bytes));
 
     if (conf->rpc) {
         conn = &conf->rpc->conn;
@@ -2817,6 +3351,81 @@ client_priv_dump(xlator_t *this)
                            conn->trans->total_bytes_write);
         gf_proc_dump_write("ping_msgs_sent", "%" PRIu64, conn->pingcnt);
         gf_proc_dump_write("msgs_sent", "%" PRIu64, conn->msgcnt);
+
+        for (i = 0; i < CLIENT_MAX_CONNECTIONS; i++) {
+            if (!conf->channels[i].rpc)
+                continue;
+            trans = conf->channels[i].rpc->conn.trans;
+            saved_read += GF_ATOMIC_GET(trans->compress_saved_read);
+            saved_write += GF_ATOMIC_GET(trans->compress_saved_write);
+            compressed += GF_ATOMIC_GET(trans->compress_records);
+            skipped += GF_ATOMIC_GET(trans->compress_skipped);
+            shm_sent += GF_ATOMIC_GET(trans->shm_records_sent);
+            shm_received += GF_ATOMIC_GET(trans->shm_records_received);
+            shm_full += GF_ATOMIC_GET(trans->shm_ring_full);
+        }
+        gf_proc_dump_write("compression", "%s",
+                           conf->compression[0] ? conf->compression : "off");
+        gf_proc_dump_write("compress_saved_read", "%" PRIu64, saved_read);
+        gf_proc_dump_write("compress_saved_write", "%" PRIu64, saved_write);
+        gf_proc_dump_write("compressed_records", "%" PRIu64, compressed);
+        gf_proc_dump_write("compress_skipped_records", "%" PRIu64, skipped);
+        gf_proc_dump_write("shm_records_sent", "%" PRIu64, shm_sent);
+        gf_proc_dump_write("shm_records_received", "%" PRIu64, shm_received);
+        gf_proc_dump_write("shm_ring_full", "%" PRIu64, shm_full);
+    }
+
+    gf_proc_dump_write("batch_window", "%" PRIu32, conf->batch_window);
+    gf_proc_dump_write("batch_rpc", "%d", conf->batch_rpc);
+    gf_proc_dump_write("batches", "%" PRIu64, GF_ATOMIC_GET(conf->batches));
+    gf_proc_dump_write("batched_ops", "%" PRIu64,
+                       GF_ATOMIC_GET(conf->batched_ops));
+    if (GF_ATOMIC_GET(conf->batches))
+        gf_proc_dump_write("batch_avg_size", "%.2f",
+                           (double)GF_ATOMIC_GET(conf->batched_ops) /
+                               GF_ATOMIC_GET(conf->batches));
+
+    gf_proc_dump_write("connection_count", "%d", conf->channel_count);
+    for (i = 0; i < CLIENT_MAX_CONNECTIONS; i++) {
+        ch = &conf->channels[i];
+        if (!ch->rpc)
+            continue;
+
+        conn = &ch->rpc->conn;
+        pthread_mutex_lock(&conn->lock);
+        {
+            outstanding = conn->saved_frames ? conn->saved_frames->count : 0;
+        }
+        pthread_mutex_unlock(&conn->lock);
+
+        snprintf(key, sizeof(key), "connection.%d.connected", i);
+        gf_proc_dump_write(key, "%d", i ? ch->up : conf->connected);
+        snprintf(key, sizeof(key), "connection.%d.requests", i);
+        gf_proc_dump_write(key, "%" PRId64, GF_ATOMIC_GET(ch->requests));
+        snprintf(key, sizeof(key), "connection.%d.bytes", i);
+        gf_proc_dump_write(key, "%" PRId64, GF_ATOMIC_GET(ch->bytes));
+        snprintf(key, sizeof(key), "connection.%d.outstanding", i);
+        gf_proc_dump_write(key, "%" PRId64, outstanding);
+        /* the averages since the handshake */
+        trans = conn->trans;
+        mode = trans->crypto_mode;
+        snprintf(key, sizeof(key), "connection.%d.crypto", i);
+        gf_proc_dump_write(key, "%s", mode ? mode : "none");
+        if (mode) {
+            secs = gf_time() - trans->crypto_since;
+            if (secs <= 0)
+                secs = 1;
+            snprintf(key, sizeof(key), "connection.%d.crypto_read_bps", i);
+            gf_proc_dump_write(key, "%" PRIu64,
+                               trans->crypto_bytes_read / secs);
+            snprintf(key, sizeof(key), "connection.%d.crypto_write_bps", i);
+            gf_proc_dump_write(key, "%" PRIu64,
+                               trans->crypto_bytes_write / secs);
+        }
+        if (i) {
+            snprintf(key, sizeof(key), "connection.%d.connects", i);
+            gf_proc_dump_write(key, "%" PRId64, GF_ATOMIC_GET(ch->connects));
+        }
     }
     pthread_mutex_unlock(&conf->lock);
 
@@ -2998,6 +3607,46 @@ struct volume_options options[] = {
                     "necessary for stricter lock complaince as bricks "
                     "cleanup any granted locks when a client "
                     "disconnects."},
+    {.key = {"sparse-read"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .description = "When set, bricks leave the holes of the range out "
+                    "of the data of read replies, and the zeroes are "
+                    "filled in on the client."},
+    {.key = {"connection-count"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = CLIENT_MAX_CONNECTIONS,
+     .default_value = "1",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_RANGE,
+     .description = "Number of connections to the brick. Reads are spread "
+                    "over all of them, the other requests made on an fd "
+                    "go on the connection of the file. Locks and all "
+                    "other requests use the first connection. Each "
+                    "connection is pinged on its own."},
+    {.key = {"batch-window"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 100000,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_RANGE,
+     .description = "Microseconds a LOOKUP, STAT, ACCESS, READLINK, "
+                    "GETXATTR or STATFS request waits for others to go to "
+                    "the brick with it in a single BATCH call. 0 sends each "
+                    "request on its own."},
+    {.key = {"batch-size"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 2,
+     .max = GFS3_BATCH_MAX_OPS,
+     .default_value = "16",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_RANGE,
+     .description = "Most requests sent in a BATCH call, which goes as "
+                    "soon as it has that many."},
     {.key = {NULL}},
 };
 
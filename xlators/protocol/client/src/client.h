@@ -33,6 +33,9 @@
 
 #define CLIENT_DUMP_LOCKS "trusted.glusterfs.clientlk-dump"
 
+/* Limit of the connections to a brick (option connection-count). */
+#define CLIENT_MAX_CONNECTIONS 16
+
 typedef enum {
     DEFAULT_REMOTE_FD = 0,
     FALLBACK_TO_ANON_FD = 1
@@ -73,6 +76,41 @@ typedef enum {
         client_local_wipe(__local);                                            \
     } while (0)
 
+/* One of the connections to the brick. The first one is conf->rpc: it
+ * carries the handshake, the locks and all the requests not made on an fd.
+ * The others are attached to the same client on the brick by a SETVOLUME
+ * with the same process-uuid once the first one is connected, and are
+ * dropped whenever it is disconnected. Each of them is pinged on its own. */
+typedef struct client_channel {
+    struct rpc_clnt *rpc;
+    int index;
+    gf_boolean_t started; /* connecting or connected */
+    gf_boolean_t up;      /* attached, requests may be sent on it */
+    uint64_t setvol_gen;  /* conf->setvol_count its SETVOLUME was sent at */
+    gf_atomic_t requests; /* requests sent on it */
+    gf_atomic_t bytes;    /* bytes of these requests */
+    gf_atomic_t connects; /* times it got attached */
+} client_channel_t;
+
+/* A request waiting for the next BATCH call to the brick, with its
+ * arguments already encoded. */
+typedef struct client_batch_op {
+    call_frame_t *frame;
+    fop_cbk_fn_t cbkfn;
+    int procnum;
+    struct iobref *iobref; /* holds the arguments */
+    struct iovec args;
+} client_batch_op_t;
+
+/* Requests made within client.batch-window of the first of them, sent
+ * together in one BATCH call with the credentials of the first. */
+typedef struct client_batch {
+    xlator_t *this;
+    gf_timer_t *timer; /* sends the call at the end of the window */
+    int count;
+    client_batch_op_t ops[GFS3_BATCH_MAX_OPS];
+} client_batch_t;
+
 struct clnt_options {
     char *remote_subvolume;
     time_t ping_timeout;
@@ -152,6 +190,25 @@ typedef struct clnt_conf {
 
     gf_boolean_t connection_to_brick; /*True from attempt to connect to brick
                                         till disconnection to brick*/
+
+    gf_boolean_t sparse_read;           /* ask bricks to leave holes out of
+                                           readv replies */
+    gf_atomic_t sparse_reads;           /* replies received without holes */
+    gf_atomic_t sparse_read_hole_bytes; /* zeroes not received */
+
+    int channel_count;        /* connections in use, the first included */
+    int channels_alive;       /* additional rpc objects not destroyed yet */
+    gf_atomic_t channel_next; /* round robin of the reads */
+    client_channel_t channels[CLIENT_MAX_CONNECTIONS];
+
+    uint32_t batch_window;   /* usecs requests wait for others, 0 is off */
+    int batch_size;          /* most requests in a BATCH call */
+    gf_boolean_t batch_rpc;  /* the brick takes BATCH calls */
+    client_batch_t *batch;   /* requests for the next one, under lock */
+    gf_atomic_t batches;     /* BATCH calls sent */
+    gf_atomic_t batched_ops; /* requests they carried */
+
+    char compression[8]; /* of the connections, as agreed with the brick */
 } clnt_conf_t;
 
 typedef struct _client_fd_ctx {
@@ -176,6 +233,7 @@ typedef struct client_local {
     clnt_fd_ctx_t *fdctx;
     uint32_t flags;
     struct iobref *iobref;
+    size_t size; /* of a read, the most a sparse reply expands to */
 
     gf_lkowner_t owner;
     int32_t cmd;
@@ -269,6 +327,12 @@ int
 client_submit_request(xlator_t *this, void *req, call_frame_t *frame,
                       rpc_clnt_prog_t *prog, int procnum, fop_cbk_fn_t cbk,
                       client_payload_t *cp, xdrproc_t xdrproc);
+int
+client_submit_request_channel(xlator_t *this, client_channel_t *ch,
+                              void *req, call_frame_t *frame,
+                              rpc_clnt_prog_t *prog, int procnum,
+                              fop_cbk_fn_t cbkfn, client_payload_t *cp,
+                              xdrproc_t xdrproc);
 
 int
 client_fdctx_destroy(xlator_t *this, clnt_fd_ctx_t *fdctx);
@@ -317,13 +381,10 @@ int
 unserialize_rsp_dirent_v2(xlator_t *this, struct gfx_readdir_rsp *rsp,
                           gf_dirent_t *entries);
 int
-unserialize_rsp_direntp_v2(xlator_t *this, fd_t *fd,
-                           struct gfx_readdirp_rsp *rsp, gf_dirent_t *entries);
+unserialize_rsp_direntp_v2(xlator_t *this, fd_t *fd, gf_dirent_t *entries);
 
 int
 clnt_readdir_rsp_cleanup_v2(gfx_readdir_rsp *rsp);
-int
-clnt_readdirp_rsp_cleanup_v2(gfx_readdirp_rsp *rsp);
 
 int
 client_add_lock_for_recovery(fd_t *fd, struct gf_flock *flock,
@@ -334,4 +395,19 @@ client_is_setlk(int32_t cmd);
 
 int32_t
 client_cmd_to_gf_cmd(int32_t cmd, int32_t *gf_cmd);
+
+void
+client_channels_start(xlator_t *this);
+void
+client_channels_stop(xlator_t *this, int from);
+client_channel_t *
+client_channel_get(clnt_conf_t *conf, struct rpc_clnt *rpc);
+int
+client_channel_setvolume(xlator_t *this, client_channel_t *ch);
+void
+client_batch_flush(xlator_t *this);
+
+int
+client_sparse_read_expand(xlator_t *this, dict_t *xdata, size_t max,
+                          struct iovec *vector, struct iobref **iobref);
 #endif /* !_CLIENT_H */
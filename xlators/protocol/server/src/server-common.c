@@ -3,6 +3,7 @@
 #include "rpc-common-xdr.h"
 #include "glusterfs4-xdr.h"
 #include "glusterfs3.h"
+#include "xdr-native.h"
 #include <glusterfs/compat-errno.h>
 #include "server-messages.h"
 #include "server-helpers.h"
@@ -91,9 +92,8 @@ server4_post_statfs(gfx_statfs_rsp *rsp, struct statvfs *stbuf)
     gf_statfs_from_statfs(&rsp->statfs, stbuf);
 }
 
-void
-server4_post_common_iatt(server_state_t *state, gfx_common_iatt_rsp *rsp,
-                         struct iatt *stbuf)
+static void
+server4_post_subdir_iatt(server_state_t *state, struct iatt *stbuf)
 {
     if (state->client->subdir_mount &&
         !gf_uuid_compare(stbuf->ia_gfid, state->client->subdir_gfid)) {
@@ -108,10 +108,24 @@ server4_post_common_iatt(server_state_t *state, gfx_common_iatt_rsp *rsp,
         stbuf->ia_ino = 1;
         gf_uuid_copy(stbuf->ia_gfid, gfid);
     }
+}
 
+void
+server4_post_common_iatt(server_state_t *state, gfx_common_iatt_rsp *rsp,
+                         struct iatt *stbuf)
+{
+    server4_post_subdir_iatt(state, stbuf);
     gfx_stat_from_iattx(&rsp->stat, stbuf);
 }
 
+void
+server4_post_native_iatt(server_state_t *state, gfx_native_iatt_rsp *rsp,
+                         struct iatt *stbuf)
+{
+    server4_post_subdir_iatt(state, stbuf);
+    rsp->stat = stbuf;
+}
+
 void
 server4_post_lk(xlator_t *this, gfx_lk_rsp *rsp, struct gf_flock *lock)
 {
@@ -150,14 +164,10 @@ server4_post_seek(gfx_seek_rsp *rsp, off_t offset)
     rsp->offset = offset;
 }
 
-int
-server4_post_readdirp(gfx_readdirp_rsp *rsp, gf_dirent_t *entries)
+void
+server4_post_readdirp(gfx_native_readdirp_rsp *rsp, gf_dirent_t *entries)
 {
-    int ret = 0;
-
-    ret = serialize_rsp_direntp_v2(entries, rsp);
-
-    return ret;
+    rsp->entries = entries;
 }
 
 void
@@ -240,9 +250,9 @@ server4_post_open(call_frame_t *frame, xlator_t *this, gfx_open_rsp *rsp,
 }
 
 void
-server4_post_readv(gfx_read_rsp *rsp, struct iatt *stbuf, int op_ret)
+server4_post_readv(gfx_native_read_rsp *rsp, struct iatt *stbuf, int op_ret)
 {
-    gfx_stat_from_iattx(&rsp->stat, stbuf);
+    rsp->stat = stbuf;
     rsp->size = op_ret;
 }
 
@@ -306,7 +316,7 @@ out:
 
 /*TODO: Handle revalidate path */
 void
-server4_post_lookup(gfx_common_2iatt_rsp *rsp, call_frame_t *frame,
+server4_post_lookup(gfx_native_2iatt_rsp *rsp, call_frame_t *frame,
                     server_state_t *state, inode_t *inode, struct iatt *stbuf,
                     dict_t *xdata)
 {
@@ -345,7 +355,7 @@ server4_post_lookup(gfx_common_2iatt_rsp *rsp, call_frame_t *frame,
             inode->ia_type = stbuf->ia_type;
     }
 
-    gfx_stat_from_iattx(&rsp->prestat, stbuf);
+    rsp->prestat = stbuf;
 }
 
 void
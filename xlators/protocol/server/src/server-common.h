@@ -3,6 +3,7 @@
 #include "rpc-common-xdr.h"
 #include "glusterfs4-xdr.h"
 #include "glusterfs3.h"
+#include "xdr-native.h"
 #include <glusterfs/compat-errno.h>
 #include "server-messages.h"
 #include <glusterfs/defaults.h>
@@ -25,8 +26,8 @@ server4_post_readdir(gfx_readdir_rsp *rsp, gf_dirent_t *entries);
 void
 server4_post_seek(gfx_seek_rsp *rsp, off_t offset);
 
-int
-server4_post_readdirp(gfx_readdirp_rsp *rsp, gf_dirent_t *entries);
+void
+server4_post_readdirp(gfx_native_readdirp_rsp *rsp, gf_dirent_t *entries);
 
 void
 server4_post_rchecksum(gfx_rchecksum_rsp *rsp, uint32_t weak_checksum,
@@ -42,7 +43,7 @@ int
 server4_post_open(call_frame_t *frame, xlator_t *this, gfx_open_rsp *rsp,
                   fd_t *fd);
 void
-server4_post_readv(gfx_read_rsp *rsp, struct iatt *stbuf, int op_ret);
+server4_post_readv(gfx_native_read_rsp *rsp, struct iatt *stbuf, int op_ret);
 
 int
 server4_post_create(call_frame_t *frame, gfx_create_rsp *rsp,
@@ -66,9 +67,12 @@ void
 server4_post_common_iatt(server_state_t *state, gfx_common_iatt_rsp *rsp,
                          struct iatt *stbuf);
 void
+server4_post_native_iatt(server_state_t *state, gfx_native_iatt_rsp *rsp,
+                         struct iatt *stbuf);
+void
 server4_post_lease(gfx_lease_rsp *rsp, struct gf_lease *lease);
 void
-server4_post_lookup(gfx_common_2iatt_rsp *rsp, call_frame_t *frame,
+server4_post_lookup(gfx_native_2iatt_rsp *rsp, call_frame_t *frame,
                     server_state_t *state, inode_t *inode, struct iatt *stbuf,
                     dict_t *xdata);
 void
@@ -247,6 +247,7 @@ server_setvolume(rpcsvc_request_t *req)
     struct _child_status *tmp = NULL;
     char *subdir_mount = NULL;
     char *client_name = NULL;
+    char *compression = NULL;
     gf_boolean_t cleanup_starting = _gf_false;
     gf_boolean_t xlator_in_graph = _gf_true;
 
@@ -664,6 +665,21 @@ server_setvolume(rpcsvc_request_t *req)
     if (ret)
         gf_msg_debug(this->name, 0, "failed to set 'transport-ptr'");
 
+    /* let the client know it may send BATCH calls */
+    ret = dict_set_int32_sizen(reply, "batch-rpc", 1);
+    if (ret)
+        gf_msg_debug(this->name, 0, "failed to set 'batch-rpc'");
+
+    /* the client inflates the algorithm it offers; compress both ways if
+     * this end can do it too */
+    if (dict_get_str_sizen(params, "transport-compression", &compression) ==
+            0 &&
+        rpc_transport_set_compression(req->trans, compression) == 0) {
+        ret = dict_set_dynstr_with_alloc(reply, "compression", compression);
+        if (ret)
+            gf_msg_debug(this->name, 0, "failed to set 'compression'");
+    }
+
 fail:
     /* It is important to validate the lookup on '/' as part of handshake,
        because if lookup itself can't succeed, we should communicate this
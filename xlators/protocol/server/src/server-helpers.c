@@ -859,48 +859,6 @@ out:
     return;
 }
 
-int
-serialize_rsp_direntp_v2(gf_dirent_t *entries, gfx_readdirp_rsp *rsp)
-{
-    gf_dirent_t *entry = NULL;
-    gfx_dirplist *trav = NULL;
-    gfx_dirplist *prev = NULL;
-    int ret = -1;
-
-    GF_VALIDATE_OR_GOTO("server", entries, out);
-    GF_VALIDATE_OR_GOTO("server", rsp, out);
-
-    list_for_each_entry(entry, &entries->list, list)
-    {
-        trav = GF_CALLOC(1, sizeof(*trav), gf_server_mt_dirent_rsp_t);
-        if (!trav)
-            goto out;
-
-        trav->d_ino = entry->d_ino;
-        trav->d_off = entry->d_off;
-        trav->d_len = entry->d_len;
-        trav->d_type = entry->d_type;
-        trav->name = entry->d_name;
-
-        gfx_stat_from_iattx(&trav->stat, &entry->d_stat);
-        dict_to_xdr(entry->dict, &trav->dict);
-
-        if (prev)
-            prev->nextentry = trav;
-        else
-            rsp->reply = trav;
-
-        prev = trav;
-        trav = NULL;
-    }
-
-    ret = 0;
-out:
-    GF_FREE(trav);
-
-    return ret;
-}
-
 int
 serialize_rsp_dirent_v2(gf_dirent_t *entries, gfx_readdir_rsp *rsp)
 {
@@ -952,24 +910,6 @@ readdir_rsp_cleanup_v2(gfx_readdir_rsp *rsp)
     return 0;
 }
 
-int
-readdirp_rsp_cleanup_v2(gfx_readdirp_rsp *rsp)
-{
-    gfx_dirplist *prev = NULL;
-    gfx_dirplist *trav = NULL;
-
-    trav = rsp->reply;
-    prev = trav;
-    while (trav) {
-        trav = trav->nextentry;
-        GF_FREE(prev->dict.pairs.pairs_val);
-        GF_FREE(prev);
-        prev = trav;
-    }
-
-    return 0;
-}
-
 static int
 common_rsp_locklist(lock_migration_info_t *locklist, gfs3_locklist **reply)
 {
@@ -49,8 +49,6 @@ server_connection_cleanup(xlator_t *this, struct _client *client, int32_t flags,
 int
 server_build_config(xlator_t *this, server_conf_t *conf);
 
-int
-readdirp_rsp_cleanup_v2(gfx_readdirp_rsp *rsp);
 int
 readdir_rsp_cleanup_v2(gfx_readdir_rsp *rsp);
 int
@@ -79,7 +77,4 @@ unserialize_req_locklist_v2(gfx_setactivelk_req *req,
 int
 serialize_rsp_dirent_v2(gf_dirent_t *entries, gfx_readdir_rsp *rsp);
 
-int
-serialize_rsp_direntp_v2(gf_dirent_t *entries, gfx_readdirp_rsp *rsp);
-
 #endif /* !_SERVER_HELPERS_H */
@@ -173,7 +173,7 @@ server4_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     loc_t fresh_loc = {
         0,
     };
-    gfx_common_2iatt_rsp rsp = {
+    gfx_native_2iatt_rsp rsp = {
         0,
     };
 
@@ -193,9 +193,8 @@ server4_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         return 0;
     }
 
-    gfx_stat_from_iattx(&rsp.poststat, postparent);
-
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.poststat = postparent;
+    rsp.xdata = xdata;
 
     if (op_ret) {
         if (state->is_revalidate && op_errno == ENOENT) {
@@ -250,9 +249,7 @@ out:
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_common_2iatt_rsp);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_2iatt_rsp);
 
     return 0;
 }
@@ -335,13 +332,13 @@ int
 server4_inodelk_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, dict_t *xdata)
 {
-    gfx_common_rsp rsp = {
+    gfx_native_common_rsp rsp = {
         0,
     };
     server_state_t *state = NULL;
     rpcsvc_request_t *req = NULL;
 
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     state = CALL_STATE(frame);
 
@@ -361,9 +358,7 @@ out:
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_common_rsp);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_common_rsp);
 
     return 0;
 }
@@ -850,13 +845,13 @@ server4_getxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, dict_t *dict,
                      dict_t *xdata)
 {
-    gfx_common_dict_rsp rsp = {
+    gfx_native_dict_rsp rsp = {
         0,
     };
     rpcsvc_request_t *req = NULL;
     server_state_t *state = NULL;
 
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     if (op_ret == -1) {
         state = CALL_STATE(frame);
@@ -869,18 +864,14 @@ server4_getxattr_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         goto out;
     }
 
-    dict_to_xdr(dict, &rsp.dict);
+    rsp.dict = dict;
 out:
     rsp.op_ret = op_ret;
     rsp.op_errno = gf_errno_to_error(op_errno);
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_common_dict_rsp);
-
-    GF_FREE(rsp.dict.pairs.pairs_val);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_dict_rsp);
 
     return 0;
 }
@@ -1400,13 +1391,13 @@ server4_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                    int32_t op_ret, int32_t op_errno, struct iatt *prebuf,
                    struct iatt *postbuf, dict_t *xdata)
 {
-    gfx_common_2iatt_rsp rsp = {
+    gfx_native_2iatt_rsp rsp = {
         0,
     };
     server_state_t *state = NULL;
     rpcsvc_request_t *req = NULL;
 
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     if (op_ret < 0) {
         state = CALL_STATE(frame);
@@ -1419,7 +1410,8 @@ server4_writev_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         goto out;
     }
 
-    server4_post_common_2iatt(&rsp, prebuf, postbuf);
+    rsp.prestat = prebuf;
+    rsp.poststat = postbuf;
 
 out:
     rsp.op_ret = op_ret;
@@ -1427,9 +1419,7 @@ out:
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_common_2iatt_rsp);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_2iatt_rsp);
 
     return 0;
 }
@@ -1440,7 +1430,7 @@ server4_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                   int32_t count, struct iatt *stbuf, struct iobref *iobref,
                   dict_t *xdata)
 {
-    gfx_read_rsp rsp = {
+    gfx_native_read_rsp rsp = {
         0,
     };
     server_state_t *state = NULL;
@@ -1456,7 +1446,7 @@ server4_readv_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                            "testing-xdata-value");
     }
 #endif
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     if (op_ret < 0) {
         state = CALL_STATE(frame);
@@ -1477,9 +1467,7 @@ out:
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, vector, count, iobref,
-                        (xdrproc_t)xdr_gfx_read_rsp);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_read_rsp);
 
     return 0;
 }
@@ -1662,13 +1650,13 @@ server4_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno, struct iatt *stbuf,
                  dict_t *xdata)
 {
-    gfx_common_iatt_rsp rsp = {
+    gfx_native_iatt_rsp rsp = {
         0,
     };
     server_state_t *state = NULL;
     rpcsvc_request_t *req = NULL;
 
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     state = CALL_STATE(frame);
     if (op_ret) {
@@ -1681,16 +1669,14 @@ server4_stat_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         goto out;
     }
 
-    server4_post_common_iatt(state, &rsp, stbuf);
+    server4_post_native_iatt(state, &rsp, stbuf);
 out:
     rsp.op_ret = op_ret;
     rsp.op_errno = gf_errno_to_error(op_errno);
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_common_iatt_rsp);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_iatt_rsp);
 
     return 0;
 }
@@ -1778,13 +1764,13 @@ server4_xattrop_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                     int32_t op_ret, int32_t op_errno, dict_t *dict,
                     dict_t *xdata)
 {
-    gfx_common_dict_rsp rsp = {
+    gfx_native_dict_rsp rsp = {
         0,
     };
     server_state_t *state = NULL;
     rpcsvc_request_t *req = NULL;
 
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     if (op_ret < 0) {
         state = CALL_STATE(frame);
@@ -1797,18 +1783,14 @@ server4_xattrop_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         goto out;
     }
 
-    dict_to_xdr(dict, &rsp.dict);
+    rsp.dict = dict;
 out:
     rsp.op_ret = op_ret;
     rsp.op_errno = gf_errno_to_error(op_errno);
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_common_dict_rsp);
-
-    GF_FREE(rsp.dict.pairs.pairs_val);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
+                        (xdrproc_t)xdr_gfx_native_dict_rsp);
 
     return 0;
 }
@@ -1859,16 +1841,15 @@ server4_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, gf_dirent_t *entries,
                      dict_t *xdata)
 {
-    gfx_readdirp_rsp rsp = {
+    gfx_native_readdirp_rsp rsp = {
         0,
     };
     server_state_t *state = NULL;
     rpcsvc_request_t *req = NULL;
-    int ret = 0;
 
     state = CALL_STATE(frame);
 
-    dict_to_xdr(xdata, &rsp.xdata);
+    rsp.xdata = xdata;
 
     if (op_ret < 0) {
         state = CALL_STATE(frame);
@@ -1882,14 +1863,8 @@ server4_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     }
 
     /* (op_ret == 0) is valid, and means EOF */
-    if (op_ret) {
-        ret = server4_post_readdirp(&rsp, entries);
-        if (ret == -1) {
-            op_ret = -1;
-            op_errno = ENOMEM;
-            goto out;
-        }
-    }
+    if (op_ret)
+        server4_post_readdirp(&rsp, entries);
 
     gf_link_inodes_from_dirent(state->fd->inode, entries);
 
@@ -1899,11 +1874,7 @@ out:
 
     req = frame->local;
     server_submit_reply(frame, req, &rsp, NULL, 0, NULL,
-                        (xdrproc_t)xdr_gfx_readdirp_rsp);
-
-    GF_FREE(rsp.xdata.pairs.pairs_val);
-
-    readdirp_rsp_cleanup_v2(&rsp);
+                        (xdrproc_t)xdr_gfx_native_readdirp_rsp);
 
     return 0;
 }
@@ -3617,7 +3588,7 @@ server4_0_stat(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_stat_req args = {
+    gfx_native_stat_req args = {
         {
             0,
         },
@@ -3628,19 +3599,17 @@ server4_0_stat(rpcsvc_request_t *req)
         return 0;
 
     /* Initialize args first, then decode */
-    ret = rpc_receive_common(req, &frame, &state, NULL, &args, xdr_gfx_stat_req,
-                             GF_FOP_STAT);
+    ret = rpc_receive_common(req, &frame, &state, NULL, &args,
+                             xdr_gfx_native_stat_req, GF_FOP_STAT);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_stat_req, (char *)&args);
         goto out;
     }
 
     state->resolve.type = RESOLVE_MUST;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_stat_resume);
@@ -4014,7 +3983,7 @@ server4_0_readv(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_read_req args = {
+    gfx_native_rw_req args = {
         {
             0,
         },
@@ -4024,9 +3993,10 @@ server4_0_readv(rpcsvc_request_t *req)
     if (!req)
         goto out;
 
-    ret = rpc_receive_common(req, &frame, &state, NULL, &args, xdr_gfx_read_req,
-                             GF_FOP_READ);
+    ret = rpc_receive_common(req, &frame, &state, NULL, &args,
+                             xdr_gfx_native_rw_req, GF_FOP_READ);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_rw_req, (char *)&args);
         goto out;
     }
 
@@ -4038,10 +4008,7 @@ server4_0_readv(rpcsvc_request_t *req)
 
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_readv_resume);
@@ -4054,7 +4021,7 @@ server4_0_writev(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_write_req args = {
+    gfx_native_rw_req args = {
         {
             0,
         },
@@ -4067,8 +4034,9 @@ server4_0_writev(rpcsvc_request_t *req)
         return ret;
 
     ret = rpc_receive_common(req, &frame, &state, &len, &args,
-                             xdr_gfx_write_req, GF_FOP_WRITE);
+                             xdr_gfx_native_rw_req, GF_FOP_WRITE);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_rw_req, (char *)&args);
         goto out;
     }
 
@@ -4094,10 +4062,7 @@ server4_0_writev(rpcsvc_request_t *req)
 
     GF_ASSERT(state->size == len);
 
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->xdata = args.xdata;
 
 #ifdef GF_TESTING_IO_XDATA
     dict_dump_to_log(state->xdata);
@@ -4632,7 +4597,7 @@ server4_0_xattrop(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_xattrop_req args = {
+    gfx_native_xattrop_req args = {
         {
             0,
         },
@@ -4643,8 +4608,9 @@ server4_0_xattrop(rpcsvc_request_t *req)
         return ret;
 
     ret = rpc_receive_common(req, &frame, &state, NULL, &args,
-                             xdr_gfx_xattrop_req, GF_FOP_XATTROP);
+                             xdr_gfx_native_xattrop_req, GF_FOP_XATTROP);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_xattrop_req, (char *)&args);
         goto out;
     }
 
@@ -4652,15 +4618,8 @@ server4_0_xattrop(rpcsvc_request_t *req)
     state->flags = args.flags;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    if (xdr_to_dict(&args.dict, &state->dict)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
-
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->dict = args.dict;
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_xattrop_resume);
@@ -4674,7 +4633,7 @@ server4_0_getxattr(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_getxattr_req args = {
+    gfx_native_getxattr_req args = {
         {
             0,
         },
@@ -4685,8 +4644,9 @@ server4_0_getxattr(rpcsvc_request_t *req)
         return ret;
 
     ret = rpc_receive_common(req, &frame, &state, NULL, &args,
-                             xdr_gfx_getxattr_req, GF_FOP_GETXATTR);
+                             xdr_gfx_native_getxattr_req, GF_FOP_GETXATTR);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_getxattr_req, (char *)&args);
         goto out;
     }
 
@@ -4699,16 +4659,11 @@ server4_0_getxattr(rpcsvc_request_t *req)
         gf_server_check_getxattr_cmd(frame, state->name);
     }
 
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_getxattr_resume);
 out:
-    free(args.name);
-
     return ret;
 }
 
@@ -4870,7 +4825,7 @@ server4_0_readdirp(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_readdirp_req args = {
+    gfx_native_readdirp_req args = {
         {
             0,
         },
@@ -4882,8 +4837,9 @@ server4_0_readdirp(rpcsvc_request_t *req)
         return ret;
 
     ret = rpc_receive_common(req, &frame, &state, NULL, &args,
-                             xdr_gfx_readdirp_req, GF_FOP_READDIRP);
+                             xdr_gfx_native_readdirp_req, GF_FOP_READDIRP);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_readdirp_req, (char *)&args);
         goto out;
     }
 
@@ -4904,10 +4860,7 @@ server4_0_readdirp(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
     /* here, dict itself works as xdata */
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_readdirp_resume);
@@ -5134,7 +5087,7 @@ server4_0_inodelk(rpcsvc_request_t *req)
 {
     server_state_t *state = NULL;
     call_frame_t *frame = NULL;
-    gfx_inodelk_req args = {
+    gfx_native_inodelk_req args = {
         {
             0,
         },
@@ -5146,8 +5099,9 @@ server4_0_inodelk(rpcsvc_request_t *req)
         return ret;
 
     ret = rpc_receive_common(req, &frame, &state, NULL, &args,
-                             xdr_gfx_inodelk_req, GF_FOP_INODELK);
+                             xdr_gfx_native_inodelk_req, GF_FOP_INODELK);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_inodelk_req, (char *)&args);
         goto out;
     }
 
@@ -5184,18 +5138,11 @@ server4_0_inodelk(rpcsvc_request_t *req)
             break;
     }
 
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto out;
-    }
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_inodelk_resume);
 out:
-    free(args.volume);
-
-    free(args.flock.lk_owner.lk_owner_val);
-
     return ret;
 }
 
@@ -5666,7 +5613,7 @@ server4_0_lookup(rpcsvc_request_t *req)
 {
     call_frame_t *frame = NULL;
     server_state_t *state = NULL;
-    gfx_lookup_req args = {
+    gfx_native_lookup_req args = {
         {
             0,
         },
@@ -5676,8 +5623,9 @@ server4_0_lookup(rpcsvc_request_t *req)
     GF_VALIDATE_OR_GOTO("server", req, err);
 
     ret = rpc_receive_common(req, &frame, &state, NULL, &args,
-                             xdr_gfx_lookup_req, GF_FOP_LOOKUP);
+                             xdr_gfx_native_lookup_req, GF_FOP_LOOKUP);
     if (ret != 0) {
+        xdr_free((xdrproc_t)xdr_gfx_native_lookup_req, (char *)&args);
         goto err;
     }
 
@@ -5691,17 +5639,12 @@ server4_0_lookup(rpcsvc_request_t *req)
         set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
     }
 
-    if (xdr_to_dict(&args.xdata, &state->xdata)) {
-        SERVER_REQ_SET_ERROR(req, ret);
-        goto err;
-    }
+    state->xdata = args.xdata;
 
     ret = 0;
     resolve_and_resume(frame, server4_lookup_resume);
 
 err:
-    free(args.bname);
-
     return ret;
 }
 
@@ -6054,6 +5997,169 @@ server4_0_compound(rpcsvc_request_t *req)
     return ret;
 }
 
+static void
+server_batch_free(server_batch_t *batch)
+{
+    int i = 0;
+
+    for (i = 0; i < batch->args.ops.ops_len; i++)
+        free(batch->args.ops.ops_val[i].args.args_val);
+    free(batch->args.ops.ops_val);
+    free(batch->args.xdata.pairs.pairs_val);
+
+    if (batch->replies) {
+        for (i = 0; i < batch->count; i++)
+            GF_FREE(batch->replies[i].rsp.rsp_val);
+        GF_FREE(batch->replies);
+    }
+    GF_FREE(batch->ops);
+    LOCK_DESTROY(&batch->lock);
+    GF_FREE(batch);
+}
+
+static void
+server_batch_unref(server_batch_t *batch)
+{
+    gfx_batch_rsp rsp = {
+        0,
+    };
+    int pending = 0;
+
+    LOCK(&batch->lock);
+    {
+        pending = --batch->pending;
+    }
+    UNLOCK(&batch->lock);
+
+    if (pending)
+        return;
+
+    rsp.replies.replies_len = batch->count;
+    rsp.replies.replies_val = batch->replies;
+    server_submit_reply(NULL, batch->req, &rsp, NULL, 0, NULL,
+                        (xdrproc_t)xdr_gfx_batch_rsp);
+
+    server_batch_free(batch);
+}
+
+/* Called with the encoded reply of a request of a BATCH call, empty if it
+ * could not be encoded. */
+void
+server_batch_reply(rpcsvc_request_t *req, struct iovec *rsp)
+{
+    server_batch_t *batch = req->batch;
+    gfx_batch_reply *reply = &batch->replies[req - batch->ops];
+
+    if (rsp->iov_len) {
+        reply->rsp.rsp_val = gf_memdup(rsp->iov_base, rsp->iov_len);
+        if (reply->rsp.rsp_val) {
+            reply->rsp.rsp_len = rsp->iov_len;
+            reply->status = SUCCESS;
+        } else {
+            reply->status = SYSTEM_ERR;
+        }
+    } else {
+        reply->status = req->rpc_err ? req->rpc_err : SYSTEM_ERR;
+    }
+
+    server_batch_unref(batch);
+}
+
+/* Runs each request of the batch through the actor it would have gone to
+ * on its own, in a request of its own cloned from the BATCH call so that
+ * it gets the same credentials. */
+int
+server4_0_batch(rpcsvc_request_t *req)
+{
+    server_batch_t *batch = NULL;
+    server_conf_t *conf = NULL;
+    rpcsvc_request_t *op = NULL;
+    gfx_batch_op *args = NULL;
+    rpcsvc_actor actor = NULL;
+    struct iovec none = {
+        0,
+    };
+    int ret = -1;
+    int i = 0;
+
+    if (!req)
+        return ret;
+
+    conf = ((xlator_t *)req->trans->xl)->private;
+
+    batch = GF_CALLOC(1, sizeof(*batch), gf_server_mt_batch_t);
+    if (!batch) {
+        SERVER_REQ_SET_ERROR(req, ret);
+        return ret;
+    }
+    LOCK_INIT(&batch->lock);
+
+    if (xdr_to_generic(req->msg[0], &batch->args,
+                       (xdrproc_t)xdr_gfx_batch_req) < 0) {
+        SERVER_REQ_SET_ERROR(req, ret);
+        goto err;
+    }
+
+    batch->count = batch->args.ops.ops_len;
+    if (batch->count == 0 || batch->count > GFS3_BATCH_MAX_OPS) {
+        SERVER_REQ_SET_ERROR(req, ret);
+        goto err;
+    }
+
+    batch->ops = GF_CALLOC(batch->count, sizeof(*batch->ops),
+                           gf_server_mt_batch_t);
+    batch->replies = GF_CALLOC(batch->count, sizeof(*batch->replies),
+                               gf_server_mt_batch_t);
+    if (!batch->ops || !batch->replies) {
+        SERVER_REQ_SET_ERROR(req, ret);
+        goto err;
+    }
+
+    batch->req = req;
+    batch->pending = batch->count + 1;
+    GF_ATOMIC_INC(conf->batches);
+    GF_ATOMIC_ADD(conf->batched_ops, batch->count);
+
+    for (i = 0; i < batch->count; i++) {
+        args = &batch->args.ops.ops_val[i];
+        op = &batch->ops[i];
+
+        *op = *req;
+        op->procnum = args->procnum;
+        op->count = 1;
+        op->msg[0].iov_base = args->args.args_val;
+        op->msg[0].iov_len = args->args.args_len;
+        op->iobref = NULL;
+        op->reply = NULL;
+        op->auxgidlarge = NULL;
+        if (req->auxgids == req->auxgidsmall)
+            op->auxgids = op->auxgidsmall;
+        INIT_LIST_HEAD(&op->request_list);
+        op->batch = batch;
+
+        actor = NULL;
+        if (GFS3_OP_BATCHABLE(args->procnum))
+            actor = glusterfs4_0_fop_prog.actors[args->procnum].actor;
+        if (!actor) {
+            rpcsvc_request_seterr(op, PROC_UNAVAIL);
+            server_batch_reply(op, &none);
+        } else if (actor(op) < 0) {
+            /* nothing was sent for it, rpcsvc would have answered with
+             * the error set */
+            server_batch_reply(op, &none);
+        }
+    }
+
+    server_batch_unref(batch);
+
+    return 0;
+
+err:
+    server_batch_free(batch);
+
+    return ret;
+}
+
 int
 server4_0_copy_file_range(rpcsvc_request_t *req)
 {
@@ -6209,6 +6315,8 @@ static rpcsvc_actor_t glusterfs4_0_fop_actors[] = {
                           GFS3_OP_NAMELINK, 0},
     [GFS3_OP_COPY_FILE_RANGE] = {"COPY-FILE-RANGE", server4_0_copy_file_range,
                                  NULL, DRC_NA, GFS3_OP_COPY_FILE_RANGE, 0},
+    [GFS3_OP_BATCH] = {"BATCH", server4_0_batch, NULL, DRC_NA, GFS3_OP_BATCH,
+                       0},
 };
 
 struct rpcsvc_program glusterfs4_0_fop_prog = {
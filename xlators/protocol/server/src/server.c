@@ -14,6 +14,7 @@
 #include "server.h"
 #include "server-helpers.h"
 #include "glusterfs4-xdr.h"
+#include "xdr-native.h"
 #include <glusterfs/call-stub.h>
 #include <glusterfs/statedump.h>
 #include <glusterfs/defaults.h>
@@ -44,7 +45,7 @@ gfs_serialize_reply(rpcsvc_request_t *req, void *arg, struct iovec *outmsg,
      * be serialized.
      */
     if (arg && xdrproc) {
-        xdr_size = xdr_sizeof(xdrproc, arg);
+        xdr_size = xdr_native_sizeof(xdrproc, arg);
         iob = iobuf_get2(req->svc->ctx->iobuf_pool, xdr_size);
         if (!iob) {
             gf_msg_callingfn(THIS->name, GF_LOG_ERROR, ENOMEM, PS_MSG_NO_MEMORY,
@@ -115,6 +116,15 @@ server_submit_reply(call_frame_t *frame, rpcsvc_request_t *req, void *arg,
 
     iobref_add(iobref, iob);
 
+    if (req->batch) {
+        /* One of the requests of a BATCH call, its reply goes back with
+         * those of the others. */
+        server_batch_reply(req, &rsp);
+        iobuf_unref(iob);
+        ret = 0;
+        goto ret;
+    }
+
     /* Then, submit the message for transmission. */
     ret = rpcsvc_submit_generic(req, &rsp, 1, payload, payloadcount, iobref);
 
@@ -140,6 +150,13 @@ server_submit_reply(call_frame_t *frame, rpcsvc_request_t *req, void *arg,
 
     ret = 0;
 ret:
+    /* a request of a BATCH call is answered whatever happens to it, the
+     * call would get no reply otherwise */
+    if (ret && req && req->batch) {
+        rsp.iov_len = 0;
+        server_batch_reply(req, &rsp);
+    }
+
     if (client)
         gf_client_unref(client);
 
@@ -235,6 +252,15 @@ server_priv(xlator_t *this)
     };
     uint64_t total_read = 0;
     uint64_t total_write = 0;
+    uint64_t saved_read = 0;
+    uint64_t saved_write = 0;
+    uint64_t compressed = 0;
+    uint64_t skipped = 0;
+    uint64_t shm_sent = 0;
+    uint64_t shm_received = 0;
+    uint64_t shm_full = 0;
+    const char *mode = NULL;
+    time_t secs = 0;
     int32_t ret = -1;
 
     GF_VALIDATE_OR_GOTO("server", this, out);
@@ -254,6 +280,31 @@ server_priv(xlator_t *this)
         {
             total_read += xprt->total_bytes_read;
             total_write += xprt->total_bytes_write;
+            saved_read += GF_ATOMIC_GET(xprt->compress_saved_read);
+            saved_write += GF_ATOMIC_GET(xprt->compress_saved_write);
+            compressed += GF_ATOMIC_GET(xprt->compress_records);
+            skipped += GF_ATOMIC_GET(xprt->compress_skipped);
+            shm_sent += GF_ATOMIC_GET(xprt->shm_records_sent);
+            shm_received += GF_ATOMIC_GET(xprt->shm_records_received);
+            shm_full += GF_ATOMIC_GET(xprt->shm_ring_full);
+
+            /* the averages since the handshake */
+            mode = xprt->crypto_mode;
+            if (!mode)
+                continue;
+            secs = gf_time() - xprt->crypto_since;
+            if (secs <= 0)
+                secs = 1;
+            gf_proc_dump_build_key(key, "server", "%s.crypto",
+                                   xprt->peerinfo.identifier);
+            gf_proc_dump_write(key, "%s", mode);
+            gf_proc_dump_build_key(key, "server", "%s.crypto-read-bps",
+                                   xprt->peerinfo.identifier);
+            gf_proc_dump_write(key, "%" PRIu64, xprt->crypto_bytes_read / secs);
+            gf_proc_dump_build_key(key, "server", "%s.crypto-write-bps",
+                                   xprt->peerinfo.identifier);
+            gf_proc_dump_write(key, "%" PRIu64,
+                               xprt->crypto_bytes_write / secs);
         }
     }
     pthread_mutex_unlock(&conf->mutex);
@@ -264,6 +315,33 @@ server_priv(xlator_t *this)
     gf_proc_dump_build_key(key, "server", "total-bytes-write");
     gf_proc_dump_write(key, "%" PRIu64, total_write);
 
+    gf_proc_dump_build_key(key, "server", "compress-saved-read");
+    gf_proc_dump_write(key, "%" PRIu64, saved_read);
+
+    gf_proc_dump_build_key(key, "server", "compress-saved-write");
+    gf_proc_dump_write(key, "%" PRIu64, saved_write);
+
+    gf_proc_dump_build_key(key, "server", "compressed-records");
+    gf_proc_dump_write(key, "%" PRIu64, compressed);
+
+    gf_proc_dump_build_key(key, "server", "compress-skipped-records");
+    gf_proc_dump_write(key, "%" PRIu64, skipped);
+
+    gf_proc_dump_build_key(key, "server", "shm-records-sent");
+    gf_proc_dump_write(key, "%" PRIu64, shm_sent);
+
+    gf_proc_dump_build_key(key, "server", "shm-records-received");
+    gf_proc_dump_write(key, "%" PRIu64, shm_received);
+
+    gf_proc_dump_build_key(key, "server", "shm-ring-full");
+    gf_proc_dump_write(key, "%" PRIu64, shm_full);
+
+    gf_proc_dump_build_key(key, "server", "batches");
+    gf_proc_dump_write(key, "%" PRIu64, GF_ATOMIC_GET(conf->batches));
+
+    gf_proc_dump_build_key(key, "server", "batched-ops");
+    gf_proc_dump_write(key, "%" PRIu64, GF_ATOMIC_GET(conf->batched_ops));
+
     rpcsvc_statedump(conf->rpc);
 
     ret = 0;
@@ -982,6 +1060,12 @@ do_rpc:
         goto out;
     }
 
+    ret = rpcsvc_set_admission_control(rpc_conf, options);
+    if (ret < 0) {
+        gf_smsg(this->name, GF_LOG_ERROR, 0, PS_MSG_RECONFIGURE_FAILED, NULL);
+        goto out;
+    }
+
     list_for_each_entry(listeners, &(rpc_conf->listeners), list)
     {
         if (listeners->trans != NULL) {
@@ -1105,6 +1189,44 @@ server_cleanup(xlator_t *this, server_conf_t *conf)
     this->private = NULL;
 }
 
+/* Clients on this host may pass the brick shared memory through a unix
+ * socket of its own. Not having it only costs them the copies. */
+static void
+server_create_shm_listener(xlator_t *this, server_conf_t *conf)
+{
+    dict_t *options = NULL;
+    char *path = NULL;
+    char name[256];
+    int ret = -1;
+
+    if (dict_get_str_sizen(this->options, "transport.socket.shm-path",
+                           &path) != 0)
+        return;
+    if (dict_get_str_boolean(this->options, "transport.socket.ssl-enabled",
+                             _gf_false))
+        return;
+
+    options = dict_copy_with_ref(this->options, NULL);
+    if (!options)
+        goto out;
+
+    ret = dict_set_str_sizen(options, "transport-type", "socket");
+    ret |= dict_set_str_sizen(options, "transport.address-family", "unix");
+    ret |= dict_set_str_sizen(options, "transport.socket.listen-path", path);
+    ret |= dict_set_str_sizen(options, "transport.socket.shm", "on");
+    if (ret)
+        goto out;
+
+    snprintf(name, sizeof(name), "%s-shm", this->name);
+    ret = rpcsvc_create_listener(conf->rpc, options, name);
+out:
+    if (ret)
+        gf_smsg(this->name, GF_LOG_WARNING, 0,
+                PS_MSG_RPCSVC_LISTENER_CREATE_FAILED, "path=%s", path, NULL);
+    if (options)
+        dict_unref(options);
+}
+
 int
 server_init(xlator_t *this)
 {
@@ -1134,6 +1256,8 @@ server_init(xlator_t *this)
     pthread_mutex_init(&conf->mutex, NULL);
 
     LOCK_INIT(&conf->itable_lock);
+    GF_ATOMIC_INIT(conf->batches, 0);
+    GF_ATOMIC_INIT(conf->batched_ops, 0);
 
     /* Set event threads to the configured default */
     GF_OPTION_INIT("event-threads", conf->event_threads, int32, err);
@@ -1222,6 +1346,12 @@ server_init(xlator_t *this)
         goto err;
     }
 
+    ret = rpcsvc_set_admission_control(conf->rpc, this->options);
+    if (ret < 0) {
+        gf_smsg(this->name, GF_LOG_ERROR, 0, PS_MSG_RPC_CONFIGURE_FAILED, NULL);
+        goto err;
+    }
+
     /*
      * This is the only place where we want secure_srvr to reflect
      * the data-plane setting.
@@ -1259,6 +1389,8 @@ server_init(xlator_t *this)
                 NULL);
     }
 
+    server_create_shm_listener(this, conf);
+
     ret = rpcsvc_register_notify(conf->rpc, server_rpc_notify, this);
     if (ret) {
         gf_smsg(this->name, GF_LOG_WARNING, 0, PS_MSG_RPCSVC_NOTIFY, NULL);
@@ -1895,6 +2027,37 @@ struct volume_options server_options[] = {
                     "potentially run out of memory)",
      .op_version = {1},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC | OPT_FLAG_GLOBAL},
+    {.key = {"rpc.admission-control"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "Limit the requests each client has in the brick, "
+                    "lowering the limits of the busiest clients while "
+                    "requests wait longer than rpc.admission-target-delay "
+                    "and raising them up to rpc.outstanding-rpc-limit "
+                    "otherwise. Locks, leases and pings are not counted. "
+                    "A connection is not held back while some of its "
+                    "locks or leases are in the brick, and is read again "
+                    "at least once every rpc.admission-interval.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"rpc.admission-target-delay"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 10000,
+     .default_value = TOSTRING(RPCSVC_DEFAULT_ADMIT_TARGET),
+     .description = "Time in milliseconds requests may stay in the brick "
+                    "before the admission control considers it congested.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"rpc.admission-interval"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 10,
+     .max = 60000,
+     .default_value = TOSTRING(RPCSVC_DEFAULT_ADMIT_INTERVAL),
+     .description = "Time in milliseconds over which the admission control "
+                    "looks for congestion before changing the limits.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"manage-gids"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "off",
@@ -79,6 +79,8 @@ struct server_conf {
     struct _child_status *child_status;
     gf_lock_t itable_lock;
     gf_boolean_t strict_auth_enabled;
+    gf_atomic_t batches;     /* BATCH calls answered */
+    gf_atomic_t batched_ops; /* requests they carried */
 };
 typedef struct server_conf server_conf_t;
 
@@ -182,6 +184,19 @@ extern struct rpcsvc_program gluster_handshake_prog;
 extern struct rpcsvc_program glusterfs3_3_fop_prog;
 extern struct rpcsvc_program glusterfs4_0_fop_prog;
 
+/* A BATCH call being answered: the requests it carries are run as if they
+ * had come one by one, and their replies are gathered here until the last
+ * of them is in, when they go back together. */
+typedef struct server_batch {
+    rpcsvc_request_t *req; /* the BATCH call */
+    gf_lock_t lock;
+    int count;
+    int pending; /* replies still due, plus one while dispatching */
+    gfx_batch_req args;
+    rpcsvc_request_t *ops;
+    gfx_batch_reply *replies;
+} server_batch_t;
+
 typedef struct _server_ctx {
     gf_lock_t fdtable_lock;
     fdtable_t *fdtable;
@@ -197,6 +212,9 @@ server_submit_reply(call_frame_t *frame, rpcsvc_request_t *req, void *arg,
                     struct iovec *payload, int payloadcount,
                     struct iobref *iobref, xdrproc_t xdrproc);
 
+void
+server_batch_reply(rpcsvc_request_t *req, struct iovec *rsp);
+
 int
 gf_server_check_setxattr_cmd(call_frame_t *frame, dict_t *dict);
 int
@@ -14,6 +14,8 @@
 #ifdef HAVE_LIBAIO
 #include <libaio.h>
 
+#define ALIGN_SIZE 4096
+
 void
 __posix_fd_set_odirect(fd_t *fd, struct posix_fd *pfd, int opflags, int direct)
 {
@@ -181,6 +183,7 @@ posix_aio_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     int _fd = -1;
     struct posix_fd *pfd = NULL;
     int ret = -1;
+    int direct = 0;
     struct posix_aio_cb *paiocb = NULL;
     struct posix_private *priv = NULL;
     struct iocb *iocb = NULL;
@@ -191,6 +194,10 @@ posix_aio_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
     priv = this->private;
 
+    /* the holes of the range are looked up synchronously */
+    if (xdata && dict_get_sizen(xdata, GF_READ_SPARSE_KEY))
+        return posix_readv(frame, this, fd, size, offset, flags, xdata);
+
     ret = posix_fd_ctx_get(fd, this, &pfd, &op_errno);
     if (ret < 0) {
         gf_msg(this->name, GF_LOG_WARNING, op_errno, P_MSG_PFD_NULL,
@@ -212,7 +219,9 @@ posix_aio_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto err;
     }
 
-    paiocb->iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+    /* aligned like the buffers of posix_readv, for O_DIRECT */
+    paiocb->iobuf = iobuf_get_page_aligned(this->ctx->iobuf_pool, size,
+                                           ALIGN_SIZE);
     if (!paiocb->iobuf) {
         op_errno = ENOMEM;
         goto err;
@@ -227,12 +236,13 @@ posix_aio_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
 
     iocb = &paiocb->iocb;
 
+    direct = (DIRECT_ALIGNED(size, priv) && DIRECT_ALIGNED(offset, priv) &&
+              DIRECT_ALIGNED(iobuf_ptr(paiocb->iobuf), priv));
+    posix_direct_io_account(this, _gf_false, direct);
+
     LOCK(&fd->lock);
     {
-        __posix_fd_set_odirect(
-            fd, pfd, flags,
-            (DIRECT_ALIGNED(size, priv) && DIRECT_ALIGNED(offset, priv) &&
-             DIRECT_ALIGNED(iobuf_ptr(paiocb->iobuf), priv)));
+        __posix_fd_set_odirect(fd, pfd, flags, direct);
 
         ret = io_submit(priv->ctxp, 1, &iocb);
     }
@@ -334,6 +344,10 @@ posix_aio_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     priv = this->private;
     DISK_SPACE_CHECK_AND_GOTO(frame, priv, xdata, op_errno, op_errno, err);
 
+    if (priv->punch_zero_writes && !iov_0filled(iov, count))
+        return posix_writev(frame, this, fd, iov, count, offset, flags, iobref,
+                            xdata);
+
     ret = posix_fd_ctx_get(fd, this, &pfd, &op_errno);
     if (ret < 0) {
         gf_msg(this->name, GF_LOG_WARNING, op_errno, P_MSG_PFD_NULL,
@@ -370,6 +384,7 @@ posix_aio_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     for (i = 0; direct && i < count; i++)
         direct = (direct && DIRECT_ALIGNED(iov[i].iov_base, priv) &&
                   DIRECT_ALIGNED(iov[i].iov_len, priv));
+    posix_direct_io_account(this, _gf_true, direct);
 
     LOCK(&fd->lock);
     {
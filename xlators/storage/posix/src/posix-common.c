@@ -36,6 +36,7 @@
 #endif /* HAVE_LINKAT */
 
 #include "posix-inode-handle.h"
+#include "posix-handle.h"
 #include <glusterfs/compat-errno.h>
 #include <glusterfs/compat.h>
 #include <glusterfs/syscall.h>
@@ -45,6 +46,8 @@
 #include "glusterfs4-xdr.h"
 #include "posix-aio.h"
 #include "posix-io-uring.h"
+#include "posix-mdstore.h"
+#include "posix-reclaim.h"
 #include <glusterfs/glusterfs-acl.h>
 #include "posix-messages.h"
 #include <glusterfs/events.h>
@@ -118,6 +121,37 @@ posix_priv(xlator_t *this)
     gf_proc_dump_write("max_read", "%" PRId64, GF_ATOMIC_GET(priv->read_value));
     gf_proc_dump_write("max_write", "%" PRId64,
                        GF_ATOMIC_GET(priv->write_value));
+    gf_proc_dump_write("dir_fd_cache_size", "%u", priv->dirfd_cache.limit);
+    gf_proc_dump_write("dir_fd_cache_count", "%u", priv->dirfd_cache.count);
+    gf_proc_dump_write("dir_fd_cache_hits", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->dirfd_cache.hits));
+    gf_proc_dump_write("dir_fd_cache_misses", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->dirfd_cache.misses));
+    gf_proc_dump_write("dir_fd_cache_evictions", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->dirfd_cache.evictions));
+    gf_proc_dump_write("dir_fd_cache_invalidations", "%" PRIu64,
+                       GF_ATOMIC_GET(priv->dirfd_cache.invalidations));
+    gf_proc_dump_write("readdirp_fill_threads", "%u",
+                       priv->rdp_pool.nthreads);
+    gf_proc_dump_write("sparse_reads", "%" PRId64,
+                       GF_ATOMIC_GET(priv->sparse_reads));
+    gf_proc_dump_write("sparse_read_hole_bytes", "%" PRId64,
+                       GF_ATOMIC_GET(priv->sparse_read_hole_bytes));
+    gf_proc_dump_write("zero_writes", "%" PRId64,
+                       GF_ATOMIC_GET(priv->zero_writes));
+    gf_proc_dump_write("zero_write_bytes", "%" PRId64,
+                       GF_ATOMIC_GET(priv->zero_write_bytes));
+    gf_proc_dump_write("direct_aligned_reads", "%" PRId64,
+                       GF_ATOMIC_GET(priv->direct_aligned_reads));
+    gf_proc_dump_write("direct_aligned_writes", "%" PRId64,
+                       GF_ATOMIC_GET(priv->direct_aligned_writes));
+    gf_proc_dump_write("direct_unaligned_reads", "%" PRId64,
+                       GF_ATOMIC_GET(priv->direct_unaligned_reads));
+    gf_proc_dump_write("direct_unaligned_writes", "%" PRId64,
+                       GF_ATOMIC_GET(priv->direct_unaligned_writes));
+    posix_group_commit_dump(this);
+    posix_mds_dump(this);
+    posix_reclaim_dump(this);
 
     return 0;
 }
@@ -303,6 +337,8 @@ set_batch_fsync_mode(struct posix_private *priv, const char *str)
         priv->batch_fsync_mode = BATCH_SYNCFS_REVERSE_FSYNC;
     else if (strcmp(str, "reverse-fsync") == 0)
         priv->batch_fsync_mode = BATCH_REVERSE_FSYNC;
+    else if (strcmp(str, "group-commit") == 0)
+        priv->batch_fsync_mode = BATCH_GROUP_COMMIT;
     else
         return -1;
 
@@ -340,6 +376,7 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     int32_t force_directory_mode = -1;
     int32_t create_mask = -1;
     int32_t create_directory_mask = -1;
+    uint32_t dirfd_cache_size = 0;
     double old_disk_reserve = 0.0;
 
     priv = this->private;
@@ -392,6 +429,10 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     else
         posix_aio_off(this);
 
+    GF_OPTION_RECONF("linux-io_uring-rings", priv->io_uring_rings, options,
+                     uint32, out);
+    GF_OPTION_RECONF("linux-io_uring-fixed", priv->io_uring_fixed, options,
+                     bool, out);
     GF_OPTION_RECONF("linux-io_uring", priv->io_uring_configured, options, bool,
                      out);
 
@@ -488,6 +529,26 @@ posix_reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("ctime", priv->ctime, options, bool, out);
 
+    GF_OPTION_RECONF("dir-fd-cache-size", dirfd_cache_size, options, uint32,
+                     out);
+    posix_dirfd_cache_resize(this, dirfd_cache_size);
+
+    GF_OPTION_RECONF("readdirp-fill-threads", priv->readdirp_fill_threads,
+                     options, uint32, out);
+
+    GF_OPTION_RECONF("punch-zero-writes", priv->punch_zero_writes, options,
+                     bool, out);
+
+    GF_OPTION_RECONF("o-direct-aligned", priv->o_direct_aligned, options, bool,
+                     out);
+
+    GF_OPTION_RECONF("reclaim-rate", priv->reclaim_rate, options, size_uint64,
+                     out);
+    GF_OPTION_RECONF("reclaim-iops", priv->reclaim_iops, options, uint32, out);
+    GF_OPTION_RECONF("reclaim-min-size", priv->reclaim_min_size, options,
+                     size_uint64, out);
+    posix_reclaim_wake(this);
+
     ret = 0;
 out:
     return ret;
@@ -665,6 +726,8 @@ posix_init(xlator_t *this)
     int force_directory = -1;
     int create_mask = -1;
     int create_directory_mask = -1;
+    uint32_t dirfd_cache_size = 0;
+    gf_boolean_t mdstore = _gf_false;
     char dir_handle[PATH_MAX] = {
         0,
     };
@@ -899,6 +962,14 @@ posix_init(xlator_t *this)
     LOCK_INIT(&_private->lock);
     GF_ATOMIC_INIT(_private->read_value, 0);
     GF_ATOMIC_INIT(_private->write_value, 0);
+    GF_ATOMIC_INIT(_private->sparse_reads, 0);
+    GF_ATOMIC_INIT(_private->sparse_read_hole_bytes, 0);
+    GF_ATOMIC_INIT(_private->zero_writes, 0);
+    GF_ATOMIC_INIT(_private->zero_write_bytes, 0);
+    GF_ATOMIC_INIT(_private->direct_aligned_reads, 0);
+    GF_ATOMIC_INIT(_private->direct_aligned_writes, 0);
+    GF_ATOMIC_INIT(_private->direct_unaligned_reads, 0);
+    GF_ATOMIC_INIT(_private->direct_unaligned_writes, 0);
 
     _private->export_statfs = 1;
     tmp_data = dict_get(this->options, "export-statfs-size");
@@ -1100,6 +1171,9 @@ posix_init(xlator_t *this)
         }
     }
 
+    GF_OPTION_INIT("linux-io_uring-rings", _private->io_uring_rings, uint32,
+                   out);
+    GF_OPTION_INIT("linux-io_uring-fixed", _private->io_uring_fixed, bool, out);
     GF_OPTION_INIT("linux-io_uring", _private->io_uring_configured, bool, out);
     if (_private->io_uring_configured) {
         op_ret = posix_io_uring_on(this);
@@ -1154,6 +1228,10 @@ posix_init(xlator_t *this)
     pthread_cond_init(&_private->janitor_cond, NULL);
     pthread_cond_init(&_private->fd_cond, NULL);
     INIT_LIST_HEAD(&_private->fsyncs);
+    pthread_mutex_init(&_private->group_commit.lock, NULL);
+    pthread_cond_init(&_private->group_commit.cond, NULL);
+    pthread_cond_init(&_private->group_commit.leader_cond, NULL);
+    INIT_LIST_HEAD(&_private->group_commit.pending);
     _private->rel_fdcount = 0;
     ret = posix_spawn_ctx_janitor_thread(this);
     if (ret)
@@ -1232,6 +1310,37 @@ posix_init(xlator_t *this)
 
     GF_OPTION_INIT("ctime", _private->ctime, bool, out);
 
+    GF_OPTION_INIT("dir-fd-cache-size", dirfd_cache_size, uint32, out);
+    if (posix_dirfd_cache_init(this, dirfd_cache_size)) {
+        ret = -1;
+        goto out;
+    }
+
+    GF_OPTION_INIT("readdirp-fill-threads", _private->readdirp_fill_threads,
+                   uint32, out);
+    posix_rdp_pool_init(this);
+
+    GF_OPTION_INIT("punch-zero-writes", _private->punch_zero_writes, bool,
+                   out);
+
+    GF_OPTION_INIT("o-direct-aligned", _private->o_direct_aligned, bool, out);
+
+    GF_OPTION_INIT("metadata-store", mdstore, bool, out);
+    if (mdstore && posix_mds_init(this)) {
+        ret = -1;
+        goto out;
+    }
+
+    GF_OPTION_INIT("reclaim-rate", _private->reclaim_rate, size_uint64, out);
+    GF_OPTION_INIT("reclaim-iops", _private->reclaim_iops, uint32, out);
+    GF_OPTION_INIT("reclaim-min-size", _private->reclaim_min_size, size_uint64,
+                   out);
+    /* started even when off, to drain what earlier runs left behind */
+    if (posix_reclaim_init(this)) {
+        ret = -1;
+        goto out;
+    }
+
 out:
     if (ret) {
         if (_private) {
@@ -1348,12 +1457,20 @@ posix_fini(xlator_t *this)
         priv->mount_lock = -1;
     }
 
+    posix_dirfd_cache_fini(this);
+    posix_rdp_pool_fini(this);
+    posix_mds_fini(this);
+    posix_reclaim_fini(this);
+
     GF_FREE(priv->base_path);
     LOCK_DESTROY(&priv->lock);
     pthread_mutex_destroy(&priv->fsync_mutex);
     pthread_cond_destroy(&priv->fsync_cond);
     pthread_mutex_destroy(&priv->janitor_mutex);
     pthread_cond_destroy(&priv->janitor_cond);
+    pthread_mutex_destroy(&priv->group_commit.lock);
+    pthread_cond_destroy(&priv->group_commit.cond);
+    pthread_cond_destroy(&priv->group_commit.leader_cond);
     GF_FREE(priv->trash_path);
     GF_FREE(priv);
     this->private = NULL;
@@ -1395,6 +1512,28 @@ struct volume_options posix_options[] = {
      .description = "Support for Linux io_uring",
      .op_version = {GD_OP_VERSION_9_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"linux-io_uring-rings"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = POSIX_URING_MAX_RINGS,
+     .default_value = "1",
+     .description = "Number of io_uring instances, each with its own "
+                    "completion thread. Submitting threads are spread over "
+                    "them to avoid contention on a single ring. Takes effect "
+                    "when linux-io_uring is turned on.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"linux-io_uring-fixed"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "Register the fds of open files and a set of read "
+                    "buffers with io_uring, so that reads and writes use "
+                    "fixed files and reads use fixed buffers. Lookups are "
+                    "only done through io_uring with this on, as they open "
+                    "the entries in free slots of the file table. Takes "
+                    "effect when linux-io_uring is turned on.",
+     .op_version = {GD_OP_VERSION_11_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"brick-uid"},
      .type = GF_OPTION_TYPE_INT,
      .min = -1,
@@ -1459,14 +1598,20 @@ struct volume_options posix_options[] = {
          " of fsyncs and fsync() each file in the batch in reverse order.\n"
          " in reverse order.\n"
          "\t- reverse-fsync: Perform fsync() of each file in the batch in"
-         " reverse order.",
+         " reverse order.\n"
+         "\t- group-commit: Flush concurrent fsyncs and O_SYNC writes of"
+         " the brick together, in groups sized from the rate of the"
+         " requests and the flush latency of the disk.",
+     .value = {"none", "syncfs", "syncfs-single-fsync",
+               "syncfs-reverse-fsync", "reverse-fsync", "group-commit"},
      .op_version = {3},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"batch-fsync-delay-usec"},
      .type = GF_OPTION_TYPE_INT,
      .default_value = "0",
      .description = "Num of usecs to wait for aggregating fsync"
-                    " requests",
+                    " requests. In group-commit mode, the most a group"
+                    " waits for more requests.",
      .op_version = {3},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"update-link-count-parent"},
@@ -1590,5 +1735,93 @@ struct volume_options posix_options[] = {
          "are stored in xattr to keep it consistent across replica and "
          "distribute set. The time attributes stored at the backend are "
          "not considered "},
+    {.key = {"dir-fd-cache-size"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 65536,
+     .default_value = "0",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Number of directories whose O_PATH fds are kept open "
+                    "so that lookups stat their entries relative to the "
+                    "parent instead of walking the chain of gfid handle "
+                    "symlinks. Only lookups use it, other fops still "
+                    "resolve handle paths; lookups through io_uring need "
+                    "it. 0, the default, disables the cache."},
+    {.key = {"readdirp-fill-threads"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = POSIX_RDP_MAX_THREADS,
+     .default_value = "4",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Number of threads which stat the entries of a large "
+                    "readdirp reply and fetch their xattrs in parallel "
+                    "with the thread serving it. 0 fills the entries one "
+                    "after the other."},
+    {.key = {"metadata-store"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Keep the time attributes of files (the "
+                    "trusted.glusterfs.mdata xattr) in a log in the .glusterfs "
+                    "directory of the brick instead of in xattrs. Existing "
+                    "xattrs are moved to the store as files are accessed, "
+                    "or all at once with extras/mdstore-migrate.py. Takes "
+                    "effect when the brick is restarted."},
+    {.key = {"punch-zero-writes"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Punch a hole in the range of a write whose data is "
+                    "all zeroes instead of writing the zeroes, keeping "
+                    "sparse files such as VM images sparse."},
+    {.key = {"o-direct-aligned"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Read and write with O_DIRECT the requests whose "
+                    "offset, size and buffers are aligned to the block "
+                    "size of the brick file system, and through the page "
+                    "cache the others. Unlike o-direct, files are not "
+                    "opened with O_DIRECT."},
+    {.key = {"reclaim-rate"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .default_value = "0",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Bytes per second a background thread frees of the "
+                    "files unlinked by their last name. Such files are "
+                    "moved to .glusterfs/reclaim and freed a step at a "
+                    "time, so that deleting large files does not stall "
+                    "the other requests. 0 frees them in the unlink."},
+    {.key = {"reclaim-iops"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 1000,
+     .default_value = "16",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Most hole punches or truncates per second the "
+                    "background reclamation makes, each freeing "
+                    "reclaim-rate / reclaim-iops bytes (1MB at least)."},
+    {.key = {"reclaim-min-size"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .default_value = "64MB",
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .op_version = {GD_OP_VERSION_11_0},
+     .tags = {"posix"},
+     .description = "Files with fewer bytes allocated are freed in the "
+                    "unlink even when reclaim-rate is set."},
     {.key = {NULL}},
 };
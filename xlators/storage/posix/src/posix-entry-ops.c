@@ -39,6 +39,8 @@
 #include <glusterfs/logging.h>
 #include "posix.h"
 #include "posix-handle.h"
+#include "posix-io-uring.h"
+#include "posix-reclaim.h"
 #include <glusterfs/compat-errno.h>
 #include <glusterfs/compat.h>
 #include <glusterfs/syscall.h>
@@ -88,7 +90,7 @@ extern char *marker_xattrs[];
 static int
 posix_unlink_stale_linkto(call_frame_t *frame, xlator_t *this,
                           const char *real_path, int32_t *op_errno, loc_t *loc);
-static gf_boolean_t
+gf_boolean_t
 posix_symlinks_match(xlator_t *this, loc_t *loc, uuid_t gfid)
 {
     struct posix_private *priv = NULL;
@@ -131,7 +133,7 @@ out:
     return ret;
 }
 
-static dict_t *
+dict_t *
 posix_dict_set_nlink(dict_t *req, dict_t *res, int32_t nlink)
 {
     int ret = -1;
@@ -1135,6 +1137,7 @@ posix_unlink_gfid_handle_and_entry(call_frame_t *frame, xlator_t *this,
     };
     gf_boolean_t locked = _gf_false;
     gf_boolean_t update_ctime = _gf_false;
+    struct posix_reclaim_entry *reclaim = NULL;
 
     /*  Unlink the gfid_handle_first */
     if (stbuf && stbuf->ia_nlink == 1) {
@@ -1142,7 +1145,11 @@ posix_unlink_gfid_handle_and_entry(call_frame_t *frame, xlator_t *this,
 
         if (loc->inode->fd_count == 0) {
             UNLOCK(&loc->inode->lock);
-            ret = posix_handle_unset(this, stbuf->ia_gfid, NULL);
+            /* large files are freed in the background */
+            ret = posix_reclaim_handle(this, stbuf->ia_gfid, stbuf,
+                                       &reclaim);
+            if (ret)
+                ret = posix_handle_unset(this, stbuf->ia_gfid, NULL);
         } else {
             UNLOCK(&loc->inode->lock);
             ret = posix_move_gfid_to_unlink(this, stbuf->ia_gfid, loc);
@@ -1181,6 +1188,13 @@ posix_unlink_gfid_handle_and_entry(call_frame_t *frame, xlator_t *this,
         locked = _gf_false;
     }
 
+    /* the worker must find the file without its name. Should the unlink
+     * have failed, it only drops the handle of a file still shared. */
+    if (reclaim) {
+        posix_reclaim_queue(this, reclaim);
+        reclaim = NULL;
+    }
+
     if (ret == -1) {
         if (op_errno)
             *op_errno = errno;
@@ -1207,6 +1221,8 @@ err:
         UNLOCK(&loc->inode->lock);
         locked = _gf_false;
     }
+    if (reclaim)
+        posix_reclaim_queue(this, reclaim);
     return -1;
 }
 
@@ -1632,6 +1648,7 @@ posix_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc, int flags,
     op_errno = errno;
 
     if (op_ret == 0) {
+        posix_dirfd_forget(this, stbuf.ia_gfid);
         if (posix_symlinks_match(this, loc, stbuf.ia_gfid))
             posix_handle_unset(this, stbuf.ia_gfid, NULL);
     }
@@ -2510,6 +2527,8 @@ fill_stat:
         gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_FD_PATH_SETTING_FAILED,
                "failed to set the fd context path=%s fd=%p", real_path, fd);
 
+    posix_io_uring_fd_register(this, pfd);
+
     op_ret = 0;
 
 out:
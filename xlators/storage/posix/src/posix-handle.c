@@ -21,6 +21,7 @@
 #include <glusterfs/syscall.h>
 #include "posix-messages.h"
 #include "posix-metadata.h"
+#include "posix-mdstore.h"
 
 #include <glusterfs/compat-errno.h>
 
@@ -863,6 +864,9 @@ posix_handle_unset_gfid(xlator_t *this, uuid_t gfid)
     index = gfid[0];
     dfd = priv->arrdfd[index];
 
+    posix_dirfd_forget(this, gfid);
+    posix_mds_forget(this, gfid);
+
     snprintf(newstr, sizeof(newstr), "%02x/%s", gfid[1], uuid_utoa(gfid));
     ret = sys_unlinkat(dfd, newstr);
     if (ret && (errno != ENOENT)) {
@@ -979,3 +983,315 @@ posix_create_link_if_gfid_exists(xlator_t *this, uuid_t gfid, char *real_path,
 
     return ret;
 }
+
+/* Directory fd cache.
+ *
+ * Resolving <gfid>/<name> through MAKE_HANDLE_PATH makes the kernel follow
+ * the handle symlinks of every ancestor of the directory, which gets costly
+ * for deep trees. The cache keeps an O_PATH fd per recently used directory
+ * so that the stat of lookups (posix_istat() and the io_uring lookups) can
+ * reach its entries with fstatat(). O_PATH fds do not take fgetxattr(), the
+ * xattrs of an entry are read through /proc/self/fd/<fd>/<name>, which only
+ * resolves the last component. The other fops still build handle paths.
+ */
+
+#define POSIX_DIRFD_PROC_PATH "/proc/self/fd/"
+
+#ifndef O_PATH
+#define O_PATH O_RDONLY
+#endif
+
+int
+posix_dirfd_cache_init(xlator_t *this, uint32_t limit)
+{
+    struct posix_private *priv = this->private;
+    struct posix_dirfd_cache *cache = &priv->dirfd_cache;
+    int i;
+
+    cache->hash = GF_CALLOC(POSIX_DIRFD_HASH_SIZE, sizeof(*cache->hash),
+                            gf_posix_mt_dirfd_t);
+    if (!cache->hash)
+        return -1;
+    for (i = 0; i < POSIX_DIRFD_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&cache->hash[i]);
+    INIT_LIST_HEAD(&cache->lru);
+    pthread_mutex_init(&cache->lock, NULL);
+
+    GF_ATOMIC_INIT(cache->hits, 0);
+    GF_ATOMIC_INIT(cache->misses, 0);
+    GF_ATOMIC_INIT(cache->evictions, 0);
+    GF_ATOMIC_INIT(cache->invalidations, 0);
+
+    cache->usable = (sys_access(POSIX_DIRFD_PROC_PATH, X_OK) == 0);
+    if (!cache->usable && limit)
+        gf_msg(this->name, GF_LOG_INFO, errno, P_MSG_HANDLE_PATH_CREATE,
+               POSIX_DIRFD_PROC_PATH " is not available, directory fd "
+               "cache disabled");
+    cache->limit = limit;
+
+    return 0;
+}
+
+static void
+posix_dirfd_destroy(struct posix_dirfd *dfd)
+{
+    sys_close(dfd->fd);
+    GF_FREE(dfd);
+}
+
+/* Drops @dfd from the cache, the caller holds the cache lock. Returns the
+ * entry if it has to be destroyed outside the lock. */
+static struct posix_dirfd *
+__posix_dirfd_unlink(struct posix_dirfd_cache *cache, struct posix_dirfd *dfd)
+{
+    list_del_init(&dfd->hash);
+    list_del_init(&dfd->lru);
+    cache->count--;
+
+    if (dfd->ref)
+        dfd->stale = _gf_true;
+    else
+        return dfd;
+
+    return NULL;
+}
+
+static void
+__posix_dirfd_prune(struct posix_dirfd_cache *cache, struct list_head *freed)
+{
+    struct posix_dirfd *dfd = NULL;
+
+    while (cache->count > cache->limit && !list_empty(&cache->lru)) {
+        dfd = list_first_entry(&cache->lru, struct posix_dirfd, lru);
+        dfd = __posix_dirfd_unlink(cache, dfd);
+        if (dfd)
+            list_add_tail(&dfd->lru, freed);
+        GF_ATOMIC_INC(cache->evictions);
+    }
+}
+
+void
+posix_dirfd_cache_resize(xlator_t *this, uint32_t limit)
+{
+    struct posix_private *priv = this->private;
+    struct posix_dirfd_cache *cache = &priv->dirfd_cache;
+    struct posix_dirfd *dfd = NULL;
+    struct posix_dirfd *tmp = NULL;
+    struct list_head freed;
+
+    INIT_LIST_HEAD(&freed);
+
+    pthread_mutex_lock(&cache->lock);
+    {
+        cache->limit = limit;
+        __posix_dirfd_prune(cache, &freed);
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    list_for_each_entry_safe(dfd, tmp, &freed, lru)
+    {
+        list_del(&dfd->lru);
+        posix_dirfd_destroy(dfd);
+    }
+}
+
+void
+posix_dirfd_cache_fini(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_dirfd_cache *cache = &priv->dirfd_cache;
+
+    if (!cache->hash)
+        return;
+
+    posix_dirfd_cache_resize(this, 0);
+    pthread_mutex_destroy(&cache->lock);
+    GF_FREE(cache->hash);
+    cache->hash = NULL;
+}
+
+static struct list_head *
+posix_dirfd_bucket(struct posix_dirfd_cache *cache, uuid_t gfid)
+{
+    return &cache->hash[(gfid[15] | (gfid[14] << 8)) % POSIX_DIRFD_HASH_SIZE];
+}
+
+static struct posix_dirfd *
+__posix_dirfd_find(struct posix_dirfd_cache *cache, uuid_t gfid)
+{
+    struct posix_dirfd *dfd = NULL;
+
+    list_for_each_entry(dfd, posix_dirfd_bucket(cache, gfid), hash)
+    {
+        if (gf_uuid_compare(dfd->gfid, gfid) == 0)
+            return dfd;
+    }
+
+    return NULL;
+}
+
+static int
+posix_dirfd_open(xlator_t *this, uuid_t gfid)
+{
+    struct posix_private *priv = this->private;
+    char *path = NULL;
+    char proc_path[sizeof(POSIX_DIRFD_PROC_PATH) + 16];
+    uuid_t ondisk = {
+        0,
+    };
+    ssize_t size;
+    int fd = -1;
+
+    if (__is_root_gfid(gfid))
+        return sys_open(priv->base_path, O_PATH | O_DIRECTORY, 0);
+
+    MAKE_HANDLE_PATH(path, this, gfid, NULL);
+    if (!path)
+        return -1;
+
+    fd = sys_open(path, O_PATH | O_DIRECTORY, 0);
+    if (fd < 0)
+        return -1;
+
+    /* the handle could have been replaced while it was being resolved */
+    snprintf(proc_path, sizeof(proc_path), POSIX_DIRFD_PROC_PATH "%d/.", fd);
+    size = sys_lgetxattr(proc_path, GFID_XATTR_KEY, ondisk, sizeof(ondisk));
+    if ((size != sizeof(ondisk)) || gf_uuid_compare(ondisk, gfid)) {
+        sys_close(fd);
+        errno = ESTALE;
+        return -1;
+    }
+
+    return fd;
+}
+
+/* Returns a referenced entry for the directory @gfid, opening it if it is
+ * not cached yet and @create is set, or NULL. The caller falls back to
+ * handle paths in that case. */
+struct posix_dirfd *
+posix_dirfd_get(xlator_t *this, uuid_t gfid, gf_boolean_t create)
+{
+    struct posix_private *priv = this->private;
+    struct posix_dirfd_cache *cache = &priv->dirfd_cache;
+    struct posix_dirfd *dfd = NULL;
+    struct posix_dirfd *new = NULL;
+    struct posix_dirfd *tmp = NULL;
+    struct list_head freed;
+    int saved_errno = 0;
+    int fd = -1;
+
+    if (!cache->limit || !cache->usable || gf_uuid_is_null(gfid))
+        return NULL;
+
+    pthread_mutex_lock(&cache->lock);
+    {
+        dfd = __posix_dirfd_find(cache, gfid);
+        if (dfd) {
+            dfd->ref++;
+            list_move_tail(&dfd->lru, &cache->lru);
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    if (dfd) {
+        GF_ATOMIC_INC(cache->hits);
+        return dfd;
+    }
+
+    if (!create)
+        return NULL;
+
+    GF_ATOMIC_INC(cache->misses);
+
+    /* callers fall back to handle paths and check errno of those */
+    saved_errno = errno;
+    fd = posix_dirfd_open(this, gfid);
+    if (fd < 0) {
+        errno = saved_errno;
+        return NULL;
+    }
+
+    new = GF_MALLOC(sizeof(*new), gf_posix_mt_dirfd_t);
+    if (!new) {
+        sys_close(fd);
+        return NULL;
+    }
+    gf_uuid_copy(new->gfid, gfid);
+    new->fd = fd;
+    new->ref = 1;
+    new->stale = _gf_false;
+
+    INIT_LIST_HEAD(&freed);
+
+    pthread_mutex_lock(&cache->lock);
+    {
+        dfd = __posix_dirfd_find(cache, gfid);
+        if (dfd) {
+            /* opened concurrently by someone else */
+            dfd->ref++;
+            list_move_tail(&dfd->lru, &cache->lru);
+        } else {
+            dfd = new;
+            new = NULL;
+            list_add_tail(&dfd->hash, posix_dirfd_bucket(cache, gfid));
+            list_add_tail(&dfd->lru, &cache->lru);
+            cache->count++;
+            __posix_dirfd_prune(cache, &freed);
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    if (new)
+        posix_dirfd_destroy(new);
+
+    list_for_each_entry_safe(new, tmp, &freed, lru)
+    {
+        list_del(&new->lru);
+        posix_dirfd_destroy(new);
+    }
+
+    return dfd;
+}
+
+void
+posix_dirfd_put(xlator_t *this, struct posix_dirfd *dfd)
+{
+    struct posix_private *priv = this->private;
+    struct posix_dirfd_cache *cache = &priv->dirfd_cache;
+    gf_boolean_t destroy = _gf_false;
+
+    pthread_mutex_lock(&cache->lock);
+    {
+        destroy = (--dfd->ref == 0) && dfd->stale;
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    if (destroy)
+        posix_dirfd_destroy(dfd);
+}
+
+/* Called when the directory @gfid is removed or replaced, so that a later
+ * directory with the same gfid is not resolved to the old one. */
+void
+posix_dirfd_forget(xlator_t *this, uuid_t gfid)
+{
+    struct posix_private *priv = this->private;
+    struct posix_dirfd_cache *cache = &priv->dirfd_cache;
+    struct posix_dirfd *dfd = NULL;
+
+    if (!cache->hash)
+        return;
+
+    pthread_mutex_lock(&cache->lock);
+    {
+        dfd = __posix_dirfd_find(cache, gfid);
+        if (dfd) {
+            dfd = __posix_dirfd_unlink(cache, dfd);
+            GF_ATOMIC_INC(cache->invalidations);
+        }
+    }
+    pthread_mutex_unlock(&cache->lock);
+
+    if (dfd)
+        posix_dirfd_destroy(dfd);
+}
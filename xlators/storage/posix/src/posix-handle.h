@@ -209,6 +209,24 @@ posix_handle_soft(xlator_t *this, const char *real_path, loc_t *loc,
 int
 posix_handle_unset(xlator_t *this, uuid_t gfid, const char *basename);
 
+int
+posix_dirfd_cache_init(xlator_t *this, uint32_t limit);
+
+void
+posix_dirfd_cache_resize(xlator_t *this, uint32_t limit);
+
+void
+posix_dirfd_cache_fini(xlator_t *this);
+
+struct posix_dirfd *
+posix_dirfd_get(xlator_t *this, uuid_t gfid, gf_boolean_t create);
+
+void
+posix_dirfd_put(xlator_t *this, struct posix_dirfd *dfd);
+
+void
+posix_dirfd_forget(xlator_t *this, uuid_t gfid);
+
 int
 posix_create_link_if_gfid_exists(xlator_t *this, uuid_t gfid, char *real_path,
                                  inode_table_t *itable);
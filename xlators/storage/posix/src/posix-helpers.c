@@ -64,6 +64,7 @@ static char *posix_ignore_xattrs[] = {"gfid-req",
                                       GLUSTERFS_PARENT_ENTRYLK,
                                       GF_GFIDLESS_LOOKUP,
                                       GLUSTERFS_INODELK_DOM_COUNT,
+                                      GF_READDIRP_FILL_COUNT_KEY,
                                       NULL};
 
 static char *list_xattr_ignore_xattrs[] = {GFID_XATTR_KEY, GF_XATTR_VOL_ID_KEY,
@@ -616,6 +617,42 @@ out:
     return 0;
 }
 
+/* Tells how _posix_xattr_get_set() serves @key, for callers fetching the
+ * plain xattrs of a request by themselves. */
+posix_xattr_req_t
+posix_xattr_req_kind(char *key)
+{
+    int len = 0;
+
+    if (posix_xattr_ignorable(key))
+        return POSIX_XATTR_REQ_IGNORED;
+
+    len = strlen(key);
+    if ((len == SLEN(GF_CONTENT_KEY) && !strcmp(key, GF_CONTENT_KEY)) ||
+        (len == SLEN(GLUSTERFS_OPEN_FD_COUNT) &&
+         !strcmp(key, GLUSTERFS_OPEN_FD_COUNT)) ||
+        (len == SLEN(GLUSTERFS_ACTIVE_FD_COUNT) &&
+         !strcmp(key, GLUSTERFS_ACTIVE_FD_COUNT)) ||
+        (len == SLEN(GET_ANCESTRY_PATH_KEY) &&
+         !strcmp(key, GET_ANCESTRY_PATH_KEY)) ||
+        (len == SLEN(GF_REQUEST_LINK_COUNT_XDATA) &&
+         !strcmp(key, GF_REQUEST_LINK_COUNT_XDATA)) ||
+        (len == SLEN(GF_GET_SIZE) && !strcmp(key, GF_GET_SIZE)) ||
+        !strcmp(key, "list-xattr") || GF_POSIX_ACL_REQUEST(key) ||
+        fnmatch(marker_contri_key, key, 0) == 0)
+        return POSIX_XATTR_REQ_OTHER;
+
+    /* anything else is a pattern matched against the listed xattrs */
+    if (strpbrk(key, "*?[\\"))
+        return POSIX_XATTR_REQ_OTHER;
+
+    /* which only ever lists names of the valid namespaces */
+    if (!gf_is_valid_xattr_namespace(key))
+        return POSIX_XATTR_REQ_IGNORED;
+
+    return POSIX_XATTR_REQ_BACKEND;
+}
+
 int
 posix_fill_gfid_path(xlator_t *this, const char *path, struct iatt *iatt)
 {
@@ -668,13 +705,13 @@ out:
     return;
 }
 
+/* Completes the iatt of an open file from its stat, used by the
+ * asynchronous fops which get the stat from io_uring. */
 int
-posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p)
+posix_fdstat_fill(xlator_t *this, inode_t *inode, int fd,
+                  struct stat *fstatbuf, struct iatt *stbuf_p)
 {
     int ret = 0;
-    struct stat fstatbuf = {
-        0,
-    };
     struct iatt stbuf = {
         0,
     };
@@ -682,14 +719,10 @@ posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p)
 
     priv = this->private;
 
-    ret = sys_fstat(fd, &fstatbuf);
-    if (ret == -1)
-        goto out;
+    if (fstatbuf->st_nlink && !S_ISDIR(fstatbuf->st_mode))
+        fstatbuf->st_nlink--;
 
-    if (fstatbuf.st_nlink && !S_ISDIR(fstatbuf.st_mode))
-        fstatbuf.st_nlink--;
-
-    iatt_from_stat(&stbuf, &fstatbuf);
+    iatt_from_stat(&stbuf, fstatbuf);
 
     if (inode && priv->ctime) {
         ret = posix_get_mdata_xattr(this, NULL, fd, inode, &stbuf);
@@ -712,6 +745,21 @@ out:
     return ret;
 }
 
+int
+posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p)
+{
+    int ret = 0;
+    struct stat fstatbuf = {
+        0,
+    };
+
+    ret = sys_fstat(fd, &fstatbuf);
+    if (ret == -1)
+        return ret;
+
+    return posix_fdstat_fill(this, inode, fd, &fstatbuf, stbuf_p);
+}
+
 /* The inode here is expected to update posix_mdata stored on disk.
  * Don't use it as a general purpose inode and don't expect it to
  * be always exists
@@ -729,26 +777,53 @@ posix_istat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *basename,
     };
     int ret = 0;
     struct posix_private *priv = NULL;
+    struct posix_dirfd *dfd = NULL;
 
     priv = this->private;
 
-    MAKE_HANDLE_PATH(real_path, this, gfid, basename);
-    if (!real_path) {
-        gf_msg(this->name, GF_LOG_ERROR, ESTALE, P_MSG_HANDLE_PATH_CREATE,
-               "Failed to create handle path for %s/%s", uuid_utoa(gfid),
-               basename ? basename : "");
-        errno = ESTALE;
-        ret = -1;
-        goto out;
+    /* entries are looked up relative to the cached fd of their parent,
+     * nameless lookups of directories use the directory's own fd */
+    dfd = posix_dirfd_get(this, gfid, basename != NULL);
+    if (dfd) {
+        if (basename) {
+            ret = sys_fstatat(dfd->fd, basename, &lstatbuf,
+                              AT_SYMLINK_NOFOLLOW);
+        } else {
+            ret = sys_fstat(dfd->fd, &lstatbuf);
+            if (ret == 0 && lstatbuf.st_nlink == 0) {
+                /* removed behind our back */
+                posix_dirfd_put(this, dfd);
+                posix_dirfd_forget(this, gfid);
+                dfd = NULL;
+            }
+        }
     }
 
-    ret = sys_lstat(real_path, &lstatbuf);
+    if (dfd) {
+        real_path = alloca(sizeof("/proc/self/fd//") + 16 +
+                           (basename ? strlen(basename) : 1));
+        sprintf(real_path, "/proc/self/fd/%d/%s", dfd->fd,
+                basename ? basename : ".");
+    } else {
+        MAKE_HANDLE_PATH(real_path, this, gfid, basename);
+        if (!real_path) {
+            gf_msg(this->name, GF_LOG_ERROR, ESTALE, P_MSG_HANDLE_PATH_CREATE,
+                   "Failed to create handle path for %s/%s", uuid_utoa(gfid),
+                   basename ? basename : "");
+            errno = ESTALE;
+            ret = -1;
+            goto out;
+        }
+
+        ret = sys_lstat(real_path, &lstatbuf);
+    }
 
     if (ret != 0) {
         if (ret == -1) {
             if (errno != ENOENT && errno != ELOOP)
                 gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_LSTAT_FAILED,
-                       "lstat failed on %s", real_path);
+                       "lstat failed on %s/%s", uuid_utoa(gfid),
+                       basename ? basename : "");
         } else {
             // may be some backend filesystem issue
             gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_LSTAT_FAILED,
@@ -765,7 +840,8 @@ posix_istat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *basename,
     if ((lstatbuf.st_ino == priv->handledir.st_ino) &&
         (lstatbuf.st_dev == priv->handledir.st_dev)) {
         errno = ENOENT;
-        return -1;
+        ret = -1;
+        goto out;
     }
 
     if (!S_ISDIR(lstatbuf.st_mode))
@@ -793,6 +869,8 @@ posix_istat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *basename,
     if (buf_p)
         *buf_p = stbuf;
 out:
+    if (dfd)
+        posix_dirfd_put(this, dfd);
     return ret;
 }
 
@@ -1615,6 +1693,8 @@ posix_close_pfd(xlator_t *xl, struct posix_fd *pfd)
     if (pfd->dir == NULL) {
         gf_msg_trace(xl->name, 0, "janitor: closing file fd=%d", pfd->fd);
         sys_close(pfd->fd);
+        if (pfd->direct_fd > 0)
+            sys_close(pfd->direct_fd - 1);
     } else {
         gf_msg_debug(xl->name, 0, "janitor: closing dir fd=%p", pfd->dir);
         sys_closedir(pfd->dir);
@@ -1960,6 +2040,79 @@ posix_fd_ctx_get(fd_t *fd, xlator_t *this, struct posix_fd **pfd, int *op_errno)
     return ret;
 }
 
+void
+posix_direct_io_account(xlator_t *this, gf_boolean_t write,
+                        gf_boolean_t aligned)
+{
+    struct posix_private *priv = this->private;
+
+    if (write && aligned)
+        GF_ATOMIC_INC(priv->direct_aligned_writes);
+    else if (write)
+        GF_ATOMIC_INC(priv->direct_unaligned_writes);
+    else if (aligned)
+        GF_ATOMIC_INC(priv->direct_aligned_reads);
+    else
+        GF_ATOMIC_INC(priv->direct_unaligned_reads);
+}
+
+/* With o-direct-aligned, returns an O_DIRECT fd on the file of pfd when the
+ * offset and the buffers and lengths of vector are aligned to the block
+ * size of the brick, and -1 when the request has to go through the page
+ * cache. The O_DIRECT fd is opened on first use and closed with pfd. */
+int
+posix_fd_direct(xlator_t *this, fd_t *fd, struct posix_fd *pfd, off_t offset,
+                const struct iovec *vector, int count, gf_boolean_t write)
+{
+#ifdef GF_LINUX_HOST_OS
+    struct posix_private *priv = this->private;
+    char path[64];
+    int direct_fd = -1;
+    int i = 0;
+
+    if (!priv->o_direct_aligned || (pfd->flags & (O_DIRECT | O_APPEND)))
+        return -1;
+
+    for (i = 0; i < count; i++) {
+        if (!DIRECT_ALIGNED(vector[i].iov_base, priv) ||
+            !DIRECT_ALIGNED(vector[i].iov_len, priv))
+            break;
+    }
+    if (i < count || !DIRECT_ALIGNED(offset, priv)) {
+        posix_direct_io_account(this, write, _gf_false);
+        return -1;
+    }
+
+    LOCK(&fd->lock);
+    {
+        if (!pfd->direct_fd) {
+            /* a second open file description, so that the O_DIRECT flag
+             * does not change how the requests on pfd->fd are done. It
+             * keeps the O_SYNC or O_DSYNC of the file. */
+            snprintf(path, sizeof(path), "/proc/self/fd/%d", pfd->fd);
+            direct_fd = sys_open(
+                path,
+                (pfd->flags & (O_ACCMODE | O_SYNC | O_DSYNC)) | O_DIRECT, 0);
+            if (direct_fd == -1)
+                gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_OPEN_FAILED,
+                       "O_DIRECT open failed for gfid=%s, using the page "
+                       "cache",
+                       uuid_utoa(fd->inode->gfid));
+            pfd->direct_fd = (direct_fd == -1) ? -1 : direct_fd + 1;
+        }
+        direct_fd = (pfd->direct_fd > 0) ? pfd->direct_fd - 1 : -1;
+    }
+    UNLOCK(&fd->lock);
+
+    /* aligned requests only count as such when they bypass the cache */
+    posix_direct_io_account(this, write, direct_fd != -1);
+
+    return direct_fd;
+#else
+    return -1;
+#endif
+}
+
 static int
 posix_fs_health_check(xlator_t *this, char *file_path)
 {
@@ -2489,6 +2642,7 @@ posix_fsyncer(void *d)
         switch (priv->batch_fsync_mode) {
             case BATCH_NONE:
             case BATCH_REVERSE_FSYNC:
+            case BATCH_GROUP_COMMIT:
                 break;
             case BATCH_SYNCFS:
             case BATCH_SYNCFS_SINGLE_FSYNC:
@@ -2514,6 +2668,228 @@ posix_fsyncer(void *d)
     }
 }
 
+/* A member of a group commit, on the stack of the thread waiting for it */
+struct posix_gc_member {
+    struct list_head list;
+    struct timespec arrived;
+    int fd;
+    int datasync;
+    int ret;
+    int op_errno;
+    gf_boolean_t started; /* writeback of the group was started */
+};
+
+static uint64_t
+posix_gc_avg(uint64_t avg, uint64_t sample)
+{
+    if (!avg)
+        return sample;
+
+    return avg - (avg >> 3) + (sample >> 3);
+}
+
+static int
+posix_gc_bucket(uint64_t val, int nbuckets)
+{
+    int i = 0;
+
+    while (val > 1 && i < nbuckets - 1) {
+        val >>= 1;
+        i++;
+    }
+
+    return i;
+}
+
+/* Members worth waiting for: those expected to arrive while one member is
+ * flushed. Under light load this is one and nobody waits. */
+static uint32_t
+posix_gc_target(struct posix_group_commit *gc)
+{
+    uint64_t target = 1;
+
+    if (gc->arrival_ns)
+        target = gc->flush_ns / gc->arrival_ns + 1;
+
+    return min(target, POSIX_GC_MAX_GROUP);
+}
+
+static void
+posix_gc_fsync(struct posix_gc_member *member)
+{
+    if (member->datasync)
+        member->ret = sys_fdatasync(member->fd);
+    else
+        member->ret = sys_fsync(member->fd);
+    member->op_errno = member->ret ? errno : 0;
+}
+
+/* Start writeback of every file of the group, so that the fsyncs the
+ * members then issue concurrently find their data on its way to the
+ * device and share the journal commits. */
+static void
+posix_gc_start(struct list_head *group, uint32_t count)
+{
+#ifdef HAVE_SYNC_FILE_RANGE
+    struct posix_gc_member *member = NULL;
+
+    if (count == 1)
+        return;
+
+    list_for_each_entry(member, group, list)
+    {
+        (void)sync_file_range(member->fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+    }
+#endif
+}
+
+/* fsync() or fdatasync() @fd together with the other requests arriving
+ * on this brick. The first member of a group leads it: it waits for as
+ * many members as the arrival rate and the flush latency seen so far let
+ * it expect, at most batch-fsync-delay-usec or half a flush, and starts
+ * the writeback of them all. The members, leader included, then flush
+ * their own fd concurrently, so that each gets the error of its own
+ * file, while requests coming in meanwhile form the next group. */
+int
+posix_group_commit(xlator_t *this, int fd, int datasync)
+{
+    struct posix_private *priv = this->private;
+    struct posix_group_commit *gc = &priv->group_commit;
+    struct posix_gc_member self = {
+        .fd = fd,
+        .datasync = datasync,
+    };
+    struct posix_gc_member *member = NULL;
+    struct posix_gc_member *tmp = NULL;
+    struct list_head group;
+    struct timespec deadline;
+    struct timespec start;
+    struct timespec end;
+    uint64_t wait_ns = 0;
+    uint64_t max_ns = 0;
+    int64_t gap = 0;
+    uint32_t target = 0;
+    uint32_t count = 0;
+
+    INIT_LIST_HEAD(&self.list);
+    INIT_LIST_HEAD(&group);
+    timespec_now(&self.arrived);
+
+    pthread_mutex_lock(&gc->lock);
+    {
+        if (gc->last_arrival.tv_sec) {
+            gap = gf_tsdiff(&gc->last_arrival, &self.arrived);
+            if (gap > 0)
+                gc->arrival_ns = posix_gc_avg(gc->arrival_ns, gap);
+        }
+        gc->last_arrival = self.arrived;
+
+        list_add_tail(&self.list, &gc->pending);
+        gc->npending++;
+        if (gc->leader)
+            pthread_cond_signal(&gc->leader_cond);
+
+        while (!self.started && gc->leader)
+            pthread_cond_wait(&gc->cond, &gc->lock);
+
+        if (self.started)
+            goto unlock;
+
+        gc->leader = _gf_true;
+
+        target = posix_gc_target(gc);
+        if (gc->npending < target) {
+            max_ns = priv->batch_fsync_delay_usec
+                         ? (uint64_t)priv->batch_fsync_delay_usec * GF_US_IN_NS
+                         : gc->flush_ns / 2;
+            wait_ns = min((target - gc->npending) * gc->arrival_ns, max_ns);
+
+            timespec_now_realtime(&deadline);
+            deadline.tv_sec += (deadline.tv_nsec + wait_ns) / GF_SEC_IN_NS;
+            deadline.tv_nsec = (deadline.tv_nsec + wait_ns) % GF_SEC_IN_NS;
+            while (gc->npending < target &&
+                   pthread_cond_timedwait(&gc->leader_cond, &gc->lock,
+                                          &deadline) != ETIMEDOUT)
+                ;
+        }
+
+        list_splice_init(&gc->pending, &group);
+        count = gc->npending;
+        gc->npending = 0;
+    }
+    pthread_mutex_unlock(&gc->lock);
+
+    posix_gc_start(&group, count);
+
+    pthread_mutex_lock(&gc->lock);
+    {
+        gc->groups++;
+        gc->members += count;
+        gc->size_hist[posix_gc_bucket(count, POSIX_GC_SIZE_BUCKETS)]++;
+
+        list_for_each_entry_safe(member, tmp, &group, list)
+        {
+            list_del_init(&member->list);
+            member->started = _gf_true;
+        }
+
+        /* the next group forms while this one is flushed */
+        gc->leader = _gf_false;
+        pthread_cond_broadcast(&gc->cond);
+    }
+unlock:
+    pthread_mutex_unlock(&gc->lock);
+
+    timespec_now(&start);
+    posix_gc_fsync(&self);
+    timespec_now(&end);
+
+    pthread_mutex_lock(&gc->lock);
+    {
+        gc->flush_ns = posix_gc_avg(gc->flush_ns, gf_tsdiff(&start, &end));
+        gc->wait_hist[posix_gc_bucket(gf_tsdiff(&self.arrived, &end) / 1000,
+                                      POSIX_GC_WAIT_BUCKETS)]++;
+    }
+    pthread_mutex_unlock(&gc->lock);
+
+    if (self.ret)
+        errno = self.op_errno;
+
+    return self.ret;
+}
+
+void
+posix_group_commit_dump(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_group_commit *gc = &priv->group_commit;
+    char key[GF_DUMP_MAX_BUF_LEN];
+    int i = 0;
+
+    pthread_mutex_lock(&gc->lock);
+    {
+        gf_proc_dump_write("group_commit_groups", "%" PRIu64, gc->groups);
+        gf_proc_dump_write("group_commit_members", "%" PRIu64, gc->members);
+        gf_proc_dump_write("group_commit_arrival_usec", "%" PRIu64,
+                           gc->arrival_ns / 1000);
+        gf_proc_dump_write("group_commit_flush_usec", "%" PRIu64,
+                           gc->flush_ns / 1000);
+
+        /* group_commit_size_N: groups of N up to 2N-1 members */
+        for (i = 0; i < POSIX_GC_SIZE_BUCKETS; i++) {
+            snprintf(key, sizeof(key), "group_commit_size_%u", 1U << i);
+            gf_proc_dump_write(key, "%" PRIu64, gc->size_hist[i]);
+        }
+
+        /* group_commit_wait_usec_N: requests completed in less than N usec */
+        for (i = 0; i < POSIX_GC_WAIT_BUCKETS; i++) {
+            snprintf(key, sizeof(key), "group_commit_wait_usec_%u", 2U << i);
+            gf_proc_dump_write(key, "%" PRIu64, gc->wait_hist[i]);
+        }
+    }
+    pthread_mutex_unlock(&gc->lock);
+}
+
 /**
  * TODO: move fd/inode interfaces into a single routine..
  */
@@ -40,6 +40,7 @@
 #include <glusterfs/dict.h>
 #include <glusterfs/logging.h>
 #include "posix-handle.h"
+#include "posix-io-uring.h"
 #include <glusterfs/compat-errno.h>
 #include <glusterfs/compat.h>
 #include <glusterfs/syscall.h>
@@ -50,6 +51,7 @@
 #include <glusterfs/glusterfs-acl.h>
 #include "posix-messages.h"
 #include "posix-metadata.h"
+#include "posix-mdstore.h"
 #include <glusterfs/events.h>
 #include "posix-gfid-path.h"
 #include <glusterfs/compat-uuid.h>
@@ -1552,6 +1554,68 @@ out:
     return 0;
 }
 
+/* Read the range requested along with an open into the reply, so that the
+ * first read of the file does not need a request of its own. Failures are
+ * not reported, the client falls back to a regular readv. */
+static void
+posix_open_read(xlator_t *this, fd_t *fd, struct posix_fd *pfd, dict_t *xdata,
+                dict_t **rsp_xdata)
+{
+    struct posix_private *priv = this->private;
+    struct iatt stbuf = {
+        0,
+    };
+    int64_t offset = 0;
+    uint32_t size = 0;
+    char *buf = NULL;
+    ssize_t ret = -1;
+
+    if (!xdata || dict_get_uint32(xdata, GF_OPEN_READ_SIZE_KEY, &size) ||
+        dict_get_int64(xdata, GF_OPEN_READ_OFFSET_KEY, &offset))
+        return;
+
+    /* files in the cloud are only readable through readv, and O_DIRECT
+     * needs aligned buffers */
+    if (!size || (offset < 0) || ((pfd->flags & O_ACCMODE) == O_WRONLY) ||
+        (pfd->flags & O_DIRECT) || dict_get_sizen(xdata, GF_CS_OBJECT_STATUS))
+        return;
+
+    size = min(size, POSIX_OPEN_READ_MAX);
+    buf = GF_MALLOC(size, gf_posix_mt_char);
+    if (!buf)
+        return;
+
+    ret = sys_pread(pfd->fd, buf, size, offset);
+    if (ret < 0) {
+        gf_msg_debug(this->name, errno, "read along with open failed on %s",
+                     uuid_utoa(fd->inode->gfid));
+        goto out;
+    }
+
+    if (posix_fdstat(this, fd->inode, pfd->fd, &stbuf) < 0)
+        goto out;
+
+    if (!*rsp_xdata) {
+        *rsp_xdata = dict_new();
+        if (!*rsp_xdata)
+            goto out;
+    }
+
+    if (dict_set_int64(*rsp_xdata, GF_OPEN_READ_OFFSET_KEY, offset) ||
+        dict_set_iatt(*rsp_xdata, GF_OPEN_READ_STAT_KEY, &stbuf, false))
+        goto out;
+
+    if (dict_set_bin(*rsp_xdata, GF_OPEN_READ_KEY, buf, ret)) {
+        dict_del_sizen(*rsp_xdata, GF_OPEN_READ_STAT_KEY);
+        goto out;
+    }
+    buf = NULL;
+
+    GF_ATOMIC_ADD(priv->read_value, ret);
+out:
+    GF_FREE(buf);
+}
+
 int32_t
 posix_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
            fd_t *fd, dict_t *xdata)
@@ -1653,6 +1717,10 @@ posix_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
                "failed to set the fd context gfid-handle=%s path=%s fd=%p",
                real_path, loc->path, fd);
 
+    posix_io_uring_fd_register(this, pfd);
+
+    posix_open_read(this, fd, pfd, xdata, &rsp_xdata);
+
     op_ret = 0;
 
 out:
@@ -1666,7 +1734,116 @@ out:
 
     STACK_UNWIND_STRICT(open, frame, op_ret, op_errno, fd, rsp_xdata);
 
+    if (rsp_xdata)
+        dict_unref(rsp_xdata);
+
+    return 0;
+}
+
+/* Reads only the data extents of [offset, offset + size), back to back in
+ * buf, and describes where they belong in the range with the map of
+ * GF_READ_DATA_MAP_KEY and the length of the range up to the end of the
+ * file in GF_READ_DATA_SIZE_KEY of rsp_xdata. Returns that length, with the
+ * bytes read in *datalen, 0 when the range has no hole (or too many) and is
+ * to be read as usual, or -errno. */
+static int32_t
+posix_sparse_read(xlator_t *this, int fd, char *buf, size_t size,
+                  off_t offset, size_t *datalen, dict_t **rsp_xdata)
+{
+#ifdef HAVE_SEEK_HOLE
+    struct posix_private *priv = this->private;
+    uint32_t map[POSIX_SPARSE_READ_MAX_EXTENTS * 2];
+    struct stat stbuf = {
+        0,
+    };
+    uint32_t *value = NULL;
+    off_t start = 0;
+    off_t end = 0;
+    off_t pos = 0;
+    size_t data = 0;
+    ssize_t len = 0;
+    int n = 0;
+    int ret = 0;
+
+    if (sys_fstat(fd, &stbuf))
+        return -errno;
+
+    end = min(offset + (off_t)size, stbuf.st_size);
+    if (offset >= end)
+        return 0;
+
+    for (pos = offset; pos < end; pos = start + len) {
+        start = sys_lseek(fd, pos, SEEK_DATA);
+        if (start == -1) {
+            /* no data after pos */
+            if (errno == ENXIO)
+                break;
+            return -errno;
+        }
+        if (start >= end)
+            break;
+
+        len = sys_lseek(fd, start, SEEK_HOLE);
+        if (len == -1)
+            return -errno;
+        len = min(len, end) - start;
+
+        if ((n == 0 && start == offset && start + len == end) ||
+            n == POSIX_SPARSE_READ_MAX_EXTENTS)
+            return 0;
+
+        ret = sys_pread(fd, buf + data, len, start);
+        if (ret == -1)
+            return -errno;
+        /* the file was truncated meanwhile */
+        if (ret != len)
+            return 0;
+
+        map[n * 2] = htonl(start - offset);
+        map[n * 2 + 1] = htonl(len);
+        data += len;
+        n++;
+    }
+
+    /* the whole range is a hole */
+    if (n == 0) {
+        map[0] = 0;
+        map[1] = 0;
+        n = 1;
+    }
+
+    if (!*rsp_xdata) {
+        *rsp_xdata = dict_new();
+        if (!*rsp_xdata)
+            return -ENOMEM;
+    }
+
+    value = GF_MALLOC(n * 2 * sizeof(uint32_t), gf_posix_mt_char);
+    if (!value)
+        return -ENOMEM;
+    memcpy(value, map, n * 2 * sizeof(uint32_t));
+
+    ret = dict_set_bin(*rsp_xdata, GF_READ_DATA_MAP_KEY, value,
+                       n * 2 * sizeof(uint32_t));
+    if (ret) {
+        GF_FREE(value);
+        return 0;
+    }
+
+    ret = dict_set_uint32(*rsp_xdata, GF_READ_DATA_SIZE_KEY, end - offset);
+    if (ret) {
+        dict_del_sizen(*rsp_xdata, GF_READ_DATA_MAP_KEY);
+        return 0;
+    }
+
+    GF_ATOMIC_INC(priv->sparse_reads);
+    GF_ATOMIC_ADD(priv->sparse_read_hole_bytes, (end - offset) - data);
+
+    *datalen = data;
+    return end - offset;
+#else
     return 0;
+#endif
 }
 
 int
@@ -1690,6 +1867,9 @@ posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         0,
     };
     int ret = -1;
+    int32_t read_len = 0;
+    int32_t range_len = 0;
+    int direct_fd = -1;
     dict_t *rsp_xdata = NULL;
 
     VALIDATE_OR_GOTO(frame, out);
@@ -1751,8 +1931,32 @@ posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         posix_update_iatt_buf(&preop, _fd, NULL, xdata);
     }
 
-    op_ret = sys_pread(_fd, iobuf->ptr, size, offset);
-    if (op_ret == -1) {
+    /* unaligned reads of the extents would fail on O_DIRECT fds */
+    if (xdata && dict_get_sizen(xdata, GF_READ_SPARSE_KEY) &&
+        !(pfd->flags & O_DIRECT)) {
+        /* only the extents go in the reply, as many bytes as op_ret */
+        range_len = posix_sparse_read(this, _fd, iobuf->ptr, size, offset,
+                                      &vec.iov_len, &rsp_xdata);
+        if (range_len < 0) {
+            errno = -range_len;
+            read_len = -1;
+        } else {
+            read_len = vec.iov_len;
+        }
+    }
+
+    if (range_len == 0) {
+        vec.iov_base = iobuf->ptr;
+        vec.iov_len = size;
+        direct_fd = posix_fd_direct(this, fd, pfd, offset, &vec, 1, _gf_false);
+        read_len = sys_pread((direct_fd != -1) ? direct_fd : _fd, iobuf->ptr,
+                             size, offset);
+        if (read_len >= 0)
+            vec.iov_len = read_len;
+    }
+
+    if (read_len == -1) {
+        op_ret = -1;
         op_errno = errno;
         gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_READ_FAILED,
                "read failed on gfid=%s, "
@@ -1763,10 +1967,9 @@ posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto out;
     }
 
-    GF_ATOMIC_ADD(priv->read_value, op_ret);
+    GF_ATOMIC_ADD(priv->read_value, read_len);
 
     vec.iov_base = iobuf->ptr;
-    vec.iov_len = op_ret;
 
     iobref = iobref_new();
 
@@ -1788,10 +1991,11 @@ posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     posix_set_ctime(frame, this, NULL, pfd->fd, fd->inode, &stbuf);
 
     /* Hack to notify higher layers of EOF. */
-    if (!stbuf.ia_size || (offset + vec.iov_len) >= stbuf.ia_size)
+    if (!stbuf.ia_size ||
+        (offset + max(read_len, range_len)) >= stbuf.ia_size)
         op_errno = ENOENT;
 
-    op_ret = vec.iov_len;
+    op_ret = read_len;
 
 out:
 
@@ -1881,6 +2085,49 @@ err:
     return op_ret;
 }
 
+/* Punches a hole in the range of a write of zeroes, size being the size of
+ * the file before the write. The part past the end of the file is left as
+ * a hole by only writing its last byte. Returns the length written, 0 when
+ * the data has to be written as usual, or -errno. */
+static int32_t
+posix_writev_zeroes(xlator_t *this, int fd, struct iovec *vector, int count,
+                    off_t offset, off_t size, int odirect)
+{
+#ifdef FALLOC_FL_KEEP_SIZE
+    struct posix_private *priv = this->private;
+    size_t len = iov_length(vector, count);
+    off_t end = offset + len;
+    int ret = 0;
+
+    if (len < POSIX_ZERO_WRITE_MIN || iov_0filled(vector, count))
+        return 0;
+
+    /* a single byte write can not be done with O_DIRECT */
+    if (odirect && end > size)
+        return 0;
+
+    if (offset < size) {
+        ret = sys_fallocate(fd, FALLOC_FL_KEEP_SIZE | FALLOC_FL_PUNCH_HOLE,
+                            offset, min(end, size) - offset);
+        if (ret && (errno == EOPNOTSUPP || errno == ENOSYS))
+            ret = sys_fallocate(fd, FALLOC_FL_KEEP_SIZE | FALLOC_FL_ZERO_RANGE,
+                                offset, min(end, size) - offset);
+        if (ret)
+            return (errno == EOPNOTSUPP || errno == ENOSYS) ? 0 : -errno;
+    }
+
+    if (end > size && sys_pwrite(fd, "", 1, end - 1) != 1)
+        return -errno;
+
+    GF_ATOMIC_INC(priv->zero_writes);
+    GF_ATOMIC_ADD(priv->zero_write_bytes, len);
+
+    return len;
+#else
+    return 0;
+#endif
+}
+
 dict_t *
 _fill_writev_xdata(fd_t *fd, dict_t *xdata, xlator_t *this, int is_append)
 {
@@ -1971,6 +2218,7 @@ posix_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     };
     int totlen = 0;
     int idx = 0;
+    int direct_fd = -1;
 
     VALIDATE_OR_GOTO(frame, unwind);
     VALIDATE_OR_GOTO(this, unwind);
@@ -2070,8 +2318,18 @@ overwrite:
             is_append = 1;
     }
 
-    op_ret = __posix_writev(_fd, vector, count, offset,
-                            (pfd->flags & O_DIRECT));
+    op_ret = 0;
+    if (priv->punch_zero_writes && !(pfd->flags & O_APPEND))
+        op_ret = posix_writev_zeroes(this, _fd, vector, count, offset,
+                                     preop.ia_size, (pfd->flags & O_DIRECT));
+    if (op_ret == 0)
+        direct_fd = posix_fd_direct(this, fd, pfd, offset, vector, count,
+                                    _gf_true);
+    if (op_ret == 0 && direct_fd != -1)
+        op_ret = __posix_pwritev(direct_fd, vector, count, offset);
+    else if (op_ret == 0)
+        op_ret = __posix_writev(_fd, vector, count, offset,
+                                (pfd->flags & O_DIRECT));
 
     if (locked && (!update_atomic)) {
         pthread_mutex_unlock(&ctx->write_atomic_lock);
@@ -2108,7 +2366,10 @@ overwrite:
     }
 
     if (flags & (O_SYNC | O_DSYNC)) {
-        ret = sys_fsync(_fd);
+        if (priv->batch_fsync_mode == BATCH_GROUP_COMMIT)
+            ret = posix_group_commit(this, _fd, (flags & O_SYNC) != O_SYNC);
+        else
+            ret = sys_fsync(_fd);
         if (ret) {
             gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_WRITEV_FAILED,
                    "fsync() in writev on fd %d failed", _fd);
@@ -2600,6 +2861,7 @@ posix_release(xlator_t *this, fd_t *fd)
                "pfd->dir is %p (not NULL) for file fd=%p", pfd->dir, fd);
     }
 
+    posix_io_uring_fd_unregister(this, pfd);
     posix_add_fd_to_cleanup(this, pfd);
 
 out:
@@ -2665,7 +2927,9 @@ posix_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
 
     priv = this->private;
 
-    if (priv->batch_fsync_mode && xdata && dict_get(xdata, "batch-fsync")) {
+    if (priv->batch_fsync_mode &&
+        priv->batch_fsync_mode != BATCH_GROUP_COMMIT && xdata &&
+        dict_get(xdata, "batch-fsync")) {
         posix_batch_fsync(frame, this, fd, datasync, xdata);
         return 0;
     }
@@ -2687,7 +2951,15 @@ posix_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
         goto out;
     }
 
-    if (datasync) {
+    if (priv->batch_fsync_mode == BATCH_GROUP_COMMIT) {
+        op_ret = posix_group_commit(this, _fd, datasync);
+        if (op_ret == -1) {
+            op_errno = errno;
+            gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_FSYNC_FAILED,
+                   "group commit of fd=%p failed", fd);
+            goto out;
+        }
+    } else if (datasync) {
         op_ret = sys_fdatasync(_fd);
         if (op_ret == -1) {
             op_errno = errno;
@@ -2709,6 +2981,15 @@ posix_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
         }
     }
 
+    /* the time attributes of the file are durable along with its data */
+    op_ret = posix_mds_sync(this);
+    if (op_ret == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_FSYNC_FAILED,
+               "sync of the metadata store failed for fd=%p", fd);
+        goto out;
+    }
+
     op_ret = posix_fdstat(this, fd->inode, _fd, &postop);
     if (op_ret == -1) {
         op_errno = errno;
@@ -3661,6 +3942,14 @@ posix_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
         goto done;
     }
 
+    if (priv->mdstore && loc->inode && name &&
+        strcmp(name, GF_XATTR_MDATA_KEY) == 0) {
+        size = posix_mds_dict_set(this, loc->inode->gfid, name, dict);
+        if (size >= 0)
+            goto done;
+        /* not migrated yet, it is still an xattr */
+    }
+
     if (loc->inode && name &&
         (strncmp(name, GF_XATTR_GET_REAL_FILENAME_KEY,
                  SLEN(GF_XATTR_GET_REAL_FILENAME_KEY)) == 0)) {
@@ -4063,6 +4352,12 @@ posix_getxattr(call_frame_t *frame, xlator_t *this, loc_t *loc,
 
     } /* while (remaining_size > 0) */
 
+    /* the store has the mdata of migrated files instead of the file */
+    if (priv->mdstore && loc->inode &&
+        !posix_handle_mdata_xattr(frame, GF_XATTR_MDATA_KEY, NULL))
+        (void)posix_mds_dict_set(this, loc->inode->gfid, GF_XATTR_MDATA_KEY,
+                                 dict);
+
 done:
     op_ret = size;
 
@@ -4098,6 +4393,7 @@ posix_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, const char *name,
 {
     int32_t op_ret = -1;
     int32_t op_errno = EINVAL;
+    struct posix_private *priv = NULL;
     struct posix_fd *pfd = NULL;
     int _fd = -1;
     int32_t list_offset = 0;
@@ -4124,6 +4420,7 @@ posix_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, const char *name,
     VALIDATE_OR_GOTO(this, out);
     VALIDATE_OR_GOTO(fd, out);
 
+    priv = this->private;
     SET_FS_ID(frame->root->uid, frame->root->gid);
 
     ret = posix_fd_ctx_get(fd, this, &pfd, &op_errno);
@@ -4174,6 +4471,13 @@ posix_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, const char *name,
         goto done;
     }
 
+    if (priv->mdstore && name && strcmp(name, GF_XATTR_MDATA_KEY) == 0) {
+        size = posix_mds_dict_set(this, fd->inode->gfid, name, dict);
+        if (size >= 0)
+            goto done;
+        /* not migrated yet, it is still an xattr */
+    }
+
     /* here allocate value_buf of 8192 bytes to avoid one extra getxattr
        call,If buffer size is small to hold the xattr result then it will
        allocate a new buffer value of required size and call getxattr again
@@ -4183,8 +4487,6 @@ posix_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, const char *name,
     if (name) {
         key_len = snprintf(key, sizeof(key), "%s", name);
 #ifdef GF_DARWIN_HOST_OS
-        struct posix_private *priv = NULL;
-        priv = this->private;
         if (priv->xattr_user_namespace == XATTR_STRIP) {
             char *newkey = NULL;
             gf_add_prefix(XATTR_USER_PREFIX, key, &newkey);
@@ -4367,6 +4669,11 @@ posix_fgetxattr(call_frame_t *frame, xlator_t *this, fd_t *fd, const char *name,
 
     } /* while (remaining_size > 0) */
 
+    if (priv->mdstore &&
+        !posix_handle_mdata_xattr(frame, GF_XATTR_MDATA_KEY, NULL))
+        (void)posix_mds_dict_set(this, fd->inode->gfid, GF_XATTR_MDATA_KEY,
+                                 dict);
+
 done:
     op_ret = size;
 
@@ -5683,26 +5990,216 @@ posix_entry_xattr_fill(xlator_t *this, inode_t *inode, fd_t *fd,
     return posix_xattr_fill(this, entry_path, &tmp_loc, NULL, -1, dict, stbuf);
 }
 
-int
-posix_readdirp_fill(xlator_t *this, fd_t *fd, gf_dirent_t *entries,
-                    dict_t *dict)
+/* Entries of one readdirp reply, handed out in ranges to the fill workers.
+ * The range [0, first) is filled by the thread which serves the readdirp. */
+struct posix_rdp_batch {
+    xlator_t *this;
+    fd_t *fd;
+    dict_t *dict;
+    const char *dirpath; /* handle path of the directory, with a trailing '/' */
+    int dirlen;
+    gf_dirent_t **entries;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int pending;
+};
+
+struct posix_rdp_job {
+    struct list_head list;
+    struct posix_rdp_batch *batch;
+    int start;
+    int end;
+};
+
+static void
+posix_readdirp_fill_entry(xlator_t *this, fd_t *fd, gf_dirent_t *entry,
+                          char *hpath, int len, dict_t *dict)
 {
-    gf_dirent_t *entry = NULL;
-    inode_table_t *itable = NULL;
+    inode_table_t *itable = fd->inode->table;
     inode_t *inode = NULL;
-    char *hpath = NULL;
-    int len = 0;
     struct iatt stbuf = {
         0,
     };
     uuid_t gfid;
     int ret = -1;
 
+    /* an inode linked under this name already knows its gfid, which spares
+     * the lookup of the gfid xattr in posix_pstat() */
+    inode = inode_grep(itable, fd->inode, entry->d_name);
+    if (inode)
+        gf_uuid_copy(gfid, inode->gfid);
+    else
+        bzero(gfid, 16);
+
+    strcpy(&hpath[len], entry->d_name);
+
+    ret = posix_pstat(this, inode, gfid, hpath, &stbuf, _gf_false);
+
+    if (ret == -1) {
+        if (inode)
+            inode_unref(inode);
+        return;
+    }
+
+    posix_update_iatt_buf(&stbuf, -1, hpath, dict);
+
+    if (!inode)
+        inode = inode_find(itable, stbuf.ia_gfid);
+
+    if (!inode)
+        inode = inode_new(itable);
+
+    entry->inode = inode;
+
+    if (dict) {
+        entry->dict = posix_entry_xattr_fill(this, entry->inode, fd, hpath,
+                                             dict, &stbuf);
+    }
+
+    entry->d_stat = stbuf;
+    if (stbuf.ia_ino)
+        entry->d_ino = stbuf.ia_ino;
+
+    if (entry->d_type == DT_UNKNOWN && !IA_ISINVAL(stbuf.ia_type)) {
+        /* The platform supports d_type but the underlying
+           filesystem doesn't. We set d_type to the correct
+           value from ia_type */
+        entry->d_type = gf_d_type_from_ia_type(stbuf.ia_type);
+    }
+}
+
+static void
+posix_readdirp_fill_range(struct posix_rdp_batch *batch, int start, int end)
+{
+    char hpath[PATH_MAX];
+    int i = 0;
+
+    memcpy(hpath, batch->dirpath, batch->dirlen);
+    for (i = start; i < end; i++)
+        posix_readdirp_fill_entry(batch->this, batch->fd, batch->entries[i],
+                                  hpath, batch->dirlen, batch->dict);
+}
+
+static void *
+posix_rdp_worker(void *data)
+{
+    xlator_t *this = data;
+    struct posix_private *priv = this->private;
+    struct posix_rdp_pool *pool = &priv->rdp_pool;
+    struct posix_rdp_batch *batch = NULL;
+    struct posix_rdp_job *job = NULL;
+
+    THIS = this;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        {
+            while (!pool->stop && list_empty(&pool->jobs))
+                pthread_cond_wait(&pool->cond, &pool->lock);
+
+            if (pool->stop) {
+                pthread_mutex_unlock(&pool->lock);
+                break;
+            }
+
+            job = list_first_entry(&pool->jobs, struct posix_rdp_job, list);
+            list_del_init(&job->list);
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        batch = job->batch;
+        posix_readdirp_fill_range(batch, job->start, job->end);
+
+        pthread_mutex_lock(&batch->lock);
+        {
+            if (--batch->pending == 0)
+                pthread_cond_signal(&batch->cond);
+        }
+        pthread_mutex_unlock(&batch->lock);
+    }
+
+    return NULL;
+}
+
+void
+posix_rdp_pool_init(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+
+    pthread_mutex_init(&priv->rdp_pool.lock, NULL);
+    pthread_cond_init(&priv->rdp_pool.cond, NULL);
+    INIT_LIST_HEAD(&priv->rdp_pool.jobs);
+}
+
+void
+posix_rdp_pool_fini(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_rdp_pool *pool = &priv->rdp_pool;
+    uint32_t i = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    {
+        pool->stop = _gf_true;
+        pthread_cond_broadcast(&pool->cond);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nthreads; i++)
+        pthread_join(pool->threads[i], NULL);
+    pool->nthreads = 0;
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->cond);
+}
+
+/* Start workers up to the configured count, returns how many are running */
+static uint32_t
+posix_rdp_pool_grow(xlator_t *this, uint32_t want)
+{
+    struct posix_private *priv = this->private;
+    struct posix_rdp_pool *pool = &priv->rdp_pool;
+    uint32_t nthreads = 0;
+
+    if (want > POSIX_RDP_MAX_THREADS)
+        want = POSIX_RDP_MAX_THREADS;
+
+    pthread_mutex_lock(&pool->lock);
+    {
+        while (!pool->stop && pool->nthreads < want) {
+            if (gf_thread_create(&pool->threads[pool->nthreads], NULL,
+                                 posix_rdp_worker, this, "posixrdp"))
+                break;
+            pool->nthreads++;
+        }
+        nthreads = pool->nthreads;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return nthreads;
+}
+
+/* Returns the number of entries filled */
+int
+posix_readdirp_fill(xlator_t *this, fd_t *fd, gf_dirent_t *entries,
+                    dict_t *dict)
+{
+    struct posix_private *priv = this->private;
+    struct posix_rdp_batch batch = {
+        0,
+    };
+    struct posix_rdp_job *jobs = NULL;
+    gf_dirent_t *entry = NULL;
+    char *hpath = NULL;
+    int len = 0;
+    int count = 0;
+    int nchunks = 0;
+    int chunk = 0;
+    int i = 0;
+
     if (list_empty(&entries->list))
         return 0;
 
-    itable = fd->inode->table;
-
     hpath = alloca(PATH_MAX);
     len = posix_handle_path(this, fd->inode->gfid, NULL, hpath, PATH_MAX);
     if (len <= 0) {
@@ -5712,56 +6209,68 @@ posix_readdirp_fill(xlator_t *this, fd_t *fd, gf_dirent_t *entries,
         return -1;
     }
     len = strlen(hpath);
-    hpath[len] = '/';
-
-    list_for_each_entry(entry, &entries->list, list)
-    {
-        inode = inode_grep(fd->inode->table, fd->inode, entry->d_name);
-        if (inode)
-            gf_uuid_copy(gfid, inode->gfid);
-        else
-            bzero(gfid, 16);
+    hpath[len++] = '/';
 
-        strcpy(&hpath[len + 1], entry->d_name);
+    list_for_each_entry(entry, &entries->list, list) { count++; }
 
-        ret = posix_pstat(this, inode, gfid, hpath, &stbuf, _gf_false);
+    /* every chunk has to be worth the hand-off to another thread */
+    nchunks = count / POSIX_RDP_MIN_BATCH;
+    if (nchunks > (int)priv->readdirp_fill_threads + 1)
+        nchunks = priv->readdirp_fill_threads + 1;
+    if (nchunks > 1)
+        nchunks = posix_rdp_pool_grow(this, nchunks - 1) + 1;
 
-        if (ret == -1) {
-            if (inode)
-                inode_unref(inode);
-            continue;
+    if (nchunks <= 1) {
+        list_for_each_entry(entry, &entries->list, list)
+        {
+            posix_readdirp_fill_entry(this, fd, entry, hpath, len, dict);
         }
+        return count;
+    }
 
-        posix_update_iatt_buf(&stbuf, -1, hpath, dict);
-
-        if (!inode)
-            inode = inode_find(itable, stbuf.ia_gfid);
+    batch.entries = alloca(count * sizeof(*batch.entries));
+    jobs = alloca(nchunks * sizeof(*jobs));
 
-        if (!inode)
-            inode = inode_new(itable);
+    i = 0;
+    list_for_each_entry(entry, &entries->list, list)
+    {
+        batch.entries[i++] = entry;
+    }
 
-        entry->inode = inode;
+    batch.this = this;
+    batch.fd = fd;
+    batch.dict = dict;
+    batch.dirpath = hpath;
+    batch.dirlen = len;
+    batch.pending = nchunks - 1;
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_cond_init(&batch.cond, NULL);
 
-        if (dict) {
-            entry->dict = posix_entry_xattr_fill(this, entry->inode, fd, hpath,
-                                                 dict, &stbuf);
+    pthread_mutex_lock(&priv->rdp_pool.lock);
+    {
+        for (chunk = 1; chunk < nchunks; chunk++) {
+            jobs[chunk].batch = &batch;
+            jobs[chunk].start = (int64_t)count * chunk / nchunks;
+            jobs[chunk].end = (int64_t)count * (chunk + 1) / nchunks;
+            list_add_tail(&jobs[chunk].list, &priv->rdp_pool.jobs);
         }
+        pthread_cond_broadcast(&priv->rdp_pool.cond);
+    }
+    pthread_mutex_unlock(&priv->rdp_pool.lock);
 
-        entry->d_stat = stbuf;
-        if (stbuf.ia_ino)
-            entry->d_ino = stbuf.ia_ino;
-
-        if (entry->d_type == DT_UNKNOWN && !IA_ISINVAL(stbuf.ia_type)) {
-            /* The platform supports d_type but the underlying
-               filesystem doesn't. We set d_type to the correct
-               value from ia_type */
-            entry->d_type = gf_d_type_from_ia_type(stbuf.ia_type);
-        }
+    posix_readdirp_fill_range(&batch, 0, count / nchunks);
 
-        inode = NULL;
+    pthread_mutex_lock(&batch.lock);
+    {
+        while (batch.pending > 0)
+            pthread_cond_wait(&batch.cond, &batch.lock);
     }
+    pthread_mutex_unlock(&batch.lock);
 
-    return 0;
+    pthread_mutex_destroy(&batch.lock);
+    pthread_cond_destroy(&batch.cond);
+
+    return count;
 }
 
 int32_t
@@ -5775,6 +6284,11 @@ posix_do_readdir(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     int32_t op_errno = 0;
     gf_dirent_t entries;
     int32_t skip_dirs = 0;
+    int fill_count = 0;
+    gf_boolean_t timed = _gf_false;
+    struct timespec start;
+    struct timespec end;
+    dict_t *rsp_xdata = NULL;
 
     VALIDATE_OR_GOTO(frame, out);
     VALIDATE_OR_GOTO(this, out);
@@ -5827,15 +6341,37 @@ posix_do_readdir(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     if (whichop != GF_FOP_READDIRP)
         goto out;
 
-    posix_readdirp_fill(this, fd, &entries, dict);
+    /* io-stats asks for the size and the time of the batch when it
+     * measures latencies */
+    timed = dict && dict_get_sizen(dict, GF_READDIRP_FILL_COUNT_KEY);
+
+    if (timed)
+        timespec_now(&start);
+    fill_count = posix_readdirp_fill(this, fd, &entries, dict);
+    if (timed)
+        timespec_now(&end);
+
+    if (timed && fill_count > 0) {
+        rsp_xdata = dict_new();
+        if (rsp_xdata) {
+            ret = dict_set_uint32(rsp_xdata, GF_READDIRP_FILL_COUNT_KEY,
+                                  fill_count);
+            if (!ret)
+                ret = dict_set_uint64(rsp_xdata, GF_READDIRP_FILL_USEC_KEY,
+                                      gf_tsdiff(&start, &end) / 1000);
+        }
+    }
 
 out:
     if (whichop == GF_FOP_READDIR)
         STACK_UNWIND_STRICT(readdir, frame, op_ret, op_errno, &entries, NULL);
     else
-        STACK_UNWIND_STRICT(readdirp, frame, op_ret, op_errno, &entries, NULL);
+        STACK_UNWIND_STRICT(readdirp, frame, op_ret, op_errno, &entries,
+                            rsp_xdata);
 
     gf_dirent_free(&entries);
+    if (rsp_xdata)
+        dict_unref(rsp_xdata);
 
     return 0;
 }
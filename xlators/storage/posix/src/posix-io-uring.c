@@ -12,13 +12,55 @@
 #include "posix-messages.h"
 #include "posix-io-uring.h"
 #include "posix-handle.h"
+#include "posix-metadata.h"
+#include "posix-mdstore.h"
+#include "posix-reclaim.h"
+#include <glusterfs/syncop.h>
 
 #ifdef HAVE_LIBURING
 #include <liburing.h>
+#include <sys/sysmacros.h>
+#include <libgen.h>
+
+/* Most fops are submitted as a chain of the fop itself and a statx of the
+ * fd, which gives the postbuf without another syscall from the
+ * completion thread. Lookups read their xattrs in a longer one. */
+#define POSIX_URING_MAX_LINK 16
+
+/* plain xattrs a lookup may ask for and still be done by the ring: the
+ * chain also opens the entry, reads its gfid and closes it */
+#define POSIX_URING_LOOKUP_XATTRS (POSIX_URING_MAX_LINK - 3)
+/* see _posix_xattr_get_set_from_backend(), larger values fall back */
+#define POSIX_URING_XATTR_SIZE 256
+
+/* size of the registered file table with linux-io_uring-fixed */
+#define POSIX_URING_MAX_FILES 4096
+/* read buffers registered with each ring with linux-io_uring-fixed */
+#define POSIX_URING_FIXED_BUFS 64
+#define POSIX_URING_FIXED_BUF_SIZE (128 * GF_UNIT_KB)
+
+/* A submission ring and the thread reaping its completions. Submitters
+ * are spread over the rings by thread, so the io-threads don't all
+ * serialize on a single sq_mutex. */
+struct posix_uring {
+    struct io_uring ring;
+    xlator_t *this;
+    pthread_mutex_t sq_mutex;
+    pthread_mutex_t cq_mutex;
+    pthread_t thread;
+    /* iobufs registered as the fixed buffers of the ring, each one is free
+     * for a new read while the ring holds its only reference */
+    struct iobuf *bufs[POSIX_URING_FIXED_BUFS];
+    int nbufs;
+};
+
+static gf_atomic_t posix_uring_shards;
+static __thread int posix_uring_shard = -1;
 
 struct posix_uring_ctx;
 typedef void(fop_unwind_f)(struct posix_uring_ctx *, int32_t);
-typedef void(fop_prep_f)(struct io_uring_sqe *sqe, struct posix_uring_ctx *);
+typedef void(fop_prep_f)(struct io_uring_sqe *sqe, struct posix_uring_ctx *,
+                         int idx);
 static int
 posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx);
 
@@ -29,6 +71,9 @@ struct posix_uring_ctx {
     fd_t *fd;
     int _fd;
     int op;
+    struct posix_uring *ring;
+    int file_slot; /* registered file index, -1 to use _fd */
+    int buf_index; /* fixed buffer holding fop.read.iobuf, -1 if none */
 
     union {
         struct {
@@ -46,17 +91,63 @@ struct posix_uring_ctx {
         struct {
             int32_t datasync;
         } fsync;
+
+        struct {
+            int32_t mode;
+            off_t offset;
+            size_t len;
+        } fallocate;
+
+        struct {
+            loc_t loc;
+            struct posix_dirfd *dirfd; /* of the parent */
+            struct statx parent;
+            int slot; /* registered file the entry is opened in, or -1 */
+            uuid_t gfid;
+            char *keys[POSIX_URING_LOOKUP_XATTRS];
+            char *values; /* POSIX_URING_XATTR_SIZE bytes for each key */
+            int nkeys;
+        } lookup;
+
+        struct {
+            loc_t loc;
+            struct iatt stbuf;
+            struct iatt preparent;
+            char *real_path;
+            char *par_path;
+            /* the gfid handle removed along with the name, empty if none */
+            char handle[POSIX_GFID_HASH2_LEN];
+        } entry;
     } fop;
 
+    /* each sqe of the chain completes with one of these as user data */
+    struct posix_uring_link {
+        struct posix_uring_ctx *ctx;
+        int idx;
+    } link[POSIX_URING_MAX_LINK];
+    int32_t res[POSIX_URING_MAX_LINK];
+    int nr; /* sqes in the chain */
+    int pending;
+
+    gf_boolean_t link_stat;
+    struct statx stx;
+
     fop_prep_f *prepare;
     fop_unwind_f *unwind;
 };
 
+static void
+posix_io_uring_slot_put(struct posix_private *priv, int slot);
+
 static void
 posix_io_uring_ctx_free(struct posix_uring_ctx *ctx)
 {
+    xlator_t *this = NULL;
+    int i;
+
     if (!ctx)
         return;
+    this = ctx->ring->this;
     if (ctx->fd)
         fd_unref(ctx->fd);
     if (ctx->xdata)
@@ -66,20 +157,85 @@ posix_io_uring_ctx_free(struct posix_uring_ctx *ctx)
             if (ctx->fop.read.iobuf)
                 iobuf_unref(ctx->fop.read.iobuf);
             break;
+        case GF_FOP_LOOKUP:
+            if (ctx->fop.lookup.slot >= 0)
+                posix_io_uring_slot_put(this->private, ctx->fop.lookup.slot);
+            if (ctx->fop.lookup.dirfd)
+                posix_dirfd_put(this, ctx->fop.lookup.dirfd);
+            for (i = 0; i < ctx->fop.lookup.nkeys; i++)
+                GF_FREE(ctx->fop.lookup.keys[i]);
+            GF_FREE(ctx->fop.lookup.values);
+            loc_wipe(&ctx->fop.lookup.loc);
+            break;
+        case GF_FOP_UNLINK:
+        case GF_FOP_RMDIR:
+            GF_FREE(ctx->fop.entry.real_path);
+            GF_FREE(ctx->fop.entry.par_path);
+            loc_wipe(&ctx->fop.entry.loc);
+            break;
         default:
             break;
     }
     GF_FREE(ctx);
 }
 
-struct posix_uring_ctx *
-posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
-                        fop_prep_f prepare, fop_unwind_f unwind,
-                        int32_t *op_errno, dict_t *xdata)
+static struct posix_uring *
+posix_io_uring_pick(struct posix_private *priv)
+{
+    if (posix_uring_shard < 0)
+        posix_uring_shard = GF_ATOMIC_INC(posix_uring_shards);
+
+    return &priv->rings[posix_uring_shard % priv->uring_nrings];
+}
+
+static int
+posix_io_uring_fd_slot(struct posix_private *priv, struct posix_fd *pfd)
+{
+    int slot = pfd->uring_slot - 1;
+
+    /* the slot is only valid for the table it was registered in, it is
+     * rebuilt whenever io_uring is turned off and on again */
+    if (slot < 0 || !priv->uring_files || priv->uring_files[slot] != pfd->fd)
+        return -1;
+
+    return slot;
+}
+
+/* Reserves a slot of the registered file table for a file the ring opens
+ * by itself, it is left empty in every ring meanwhile. */
+static int
+posix_io_uring_slot_get(struct posix_private *priv)
+{
+    int slot = -1;
+
+    if (!priv->uring_files)
+        return -1;
+
+    pthread_mutex_lock(&priv->uring_files_lock);
+    {
+        if (priv->uring_files_nfree)
+            slot = priv->uring_files_free[--priv->uring_files_nfree];
+    }
+    pthread_mutex_unlock(&priv->uring_files_lock);
+
+    return slot;
+}
+
+static void
+posix_io_uring_slot_put(struct posix_private *priv, int slot)
+{
+    pthread_mutex_lock(&priv->uring_files_lock);
+    {
+        priv->uring_files_free[priv->uring_files_nfree++] = slot;
+    }
+    pthread_mutex_unlock(&priv->uring_files_lock);
+}
+
+static struct posix_uring_ctx *
+posix_io_uring_ctx_new(call_frame_t *frame, xlator_t *this, int op,
+                       fop_prep_f prepare, fop_unwind_f unwind, dict_t *xdata)
 {
     struct posix_uring_ctx *ctx = NULL;
-    struct posix_fd *pfd = NULL;
-    int ret = 0;
 
     ctx = GF_CALLOC(1, sizeof(*ctx), gf_posix_mt_uring_ctx);
     if (!ctx) {
@@ -87,12 +243,37 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
     }
 
     ctx->frame = frame;
-    ctx->fd = fd_ref(fd);
     ctx->prepare = prepare;
     ctx->unwind = unwind;
     if (xdata)
         ctx->xdata = dict_ref(xdata);
     ctx->op = op;
+    ctx->ring = posix_io_uring_pick(this->private);
+    ctx->file_slot = -1;
+    ctx->buf_index = -1;
+    ctx->_fd = -1;
+    ctx->nr = 1;
+    if (op == GF_FOP_LOOKUP)
+        ctx->fop.lookup.slot = -1;
+
+    return ctx;
+}
+
+struct posix_uring_ctx *
+posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
+                        fop_prep_f prepare, fop_unwind_f unwind,
+                        int32_t *op_errno, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    struct posix_fd *pfd = NULL;
+    int ret = 0;
+
+    ctx = posix_io_uring_ctx_new(frame, this, op, prepare, unwind, xdata);
+    if (!ctx) {
+        return NULL;
+    }
+    ctx->fd = fd_ref(fd);
 
     ret = posix_fd_ctx_get(fd, this, &pfd, op_errno);
     if (ret < 0) {
@@ -101,9 +282,13 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
         goto err;
     }
     ctx->_fd = pfd->fd;
+    ctx->file_slot = posix_io_uring_fd_slot(priv, pfd);
+    ctx->link_stat = (op != GF_FOP_FSTAT) && priv->io_uring_statx;
+    if (ctx->link_stat)
+        ctx->nr = 2;
 
-    /* TODO: Explore filling up pre and post bufs using IOSQE_IO_LINK*/
-    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC)) {
+    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC) ||
+        (op == GF_FOP_FALLOCATE) || (op == GF_FOP_DISCARD)) {
         if (posix_fdstat(this, fd->inode, pfd->fd, &ctx->prebuf) != 0) {
             *op_errno = errno;
             gf_msg(this->name, GF_LOG_ERROR, *op_errno, P_MSG_FSTAT_FAILED,
@@ -119,6 +304,94 @@ err:
     return NULL;
 }
 
+static void
+posix_stat_from_statx(struct stat *st, struct statx *stx)
+{
+    st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+    st->st_ino = stx->stx_ino;
+    st->st_mode = stx->stx_mode;
+    st->st_nlink = stx->stx_nlink;
+    st->st_uid = stx->stx_uid;
+    st->st_gid = stx->stx_gid;
+    st->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+    st->st_size = stx->stx_size;
+    st->st_blksize = stx->stx_blksize;
+    st->st_blocks = stx->stx_blocks;
+    st->st_atim.tv_sec = stx->stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+}
+
+/* Fills @buf from the statx which completed with @res, or with a plain
+ * fstat if it failed or was cancelled because the fop before it in the
+ * chain came back short. */
+static int
+posix_io_uring_fill_stat(struct posix_uring_ctx *ctx, int32_t res,
+                         struct iatt *buf)
+{
+    xlator_t *this = ctx->frame->this;
+    struct stat st = {
+        0,
+    };
+
+    if (res < 0)
+        return posix_fdstat(this, ctx->fd->inode, ctx->_fd, buf);
+
+    posix_stat_from_statx(&st, &ctx->stx);
+    return posix_fdstat_fill(this, ctx->fd->inode, ctx->_fd, &st, buf);
+}
+
+static int
+posix_io_uring_postbuf(struct posix_uring_ctx *ctx, struct iatt *postbuf)
+{
+    return posix_io_uring_fill_stat(
+        ctx, ctx->link_stat ? ctx->res[1] : -ECANCELED, postbuf);
+}
+
+static void
+posix_prep_statx(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_statx(sqe, ctx->_fd, "", AT_EMPTY_PATH, STATX_BASIC_STATS,
+                        &ctx->stx);
+}
+
+static void
+posix_prep_fixed_file(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    if (ctx->file_slot >= 0) {
+        sqe->fd = ctx->file_slot;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+}
+
+static struct iobuf *
+posix_io_uring_get_fixed_buf(struct posix_uring *ring, size_t size,
+                             int *index)
+{
+    struct iobuf *iobuf = NULL;
+    int i;
+
+    if (!ring->nbufs || size > POSIX_URING_FIXED_BUF_SIZE)
+        return NULL;
+
+    pthread_mutex_lock(&ring->sq_mutex);
+    {
+        for (i = 0; i < ring->nbufs; i++) {
+            if (GF_ATOMIC_GET(ring->bufs[i]->ref) == 1) {
+                iobuf = iobuf_ref(ring->bufs[i]);
+                *index = i;
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&ring->sq_mutex);
+
+    return iobuf;
+}
+
 static void
 posix_io_uring_readv_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
@@ -133,7 +406,6 @@ posix_io_uring_readv_complete(struct posix_uring_ctx *ctx, int32_t res)
     struct iovec iov = {
         0,
     };
-    fd_t *fd = NULL;
     int _fd = -1;
     int ret = 0;
     int op_ret = -1;
@@ -143,7 +415,6 @@ posix_io_uring_readv_complete(struct posix_uring_ctx *ctx, int32_t res)
     frame = ctx->frame;
     this = frame->this;
     priv = this->private;
-    fd = ctx->fd;
     _fd = ctx->_fd;
     iobuf = ctx->fop.read.iobuf;
     offset = ctx->fop.read.offset;
@@ -156,7 +427,7 @@ posix_io_uring_readv_complete(struct posix_uring_ctx *ctx, int32_t res)
         goto out;
     }
 
-    ret = posix_fdstat(this, fd->inode, _fd, &postbuf);
+    ret = posix_io_uring_postbuf(ctx, &postbuf);
     if (ret != 0) {
         op_ret = -1;
         op_errno = errno;
@@ -195,11 +466,17 @@ out:
 }
 
 static void
-posix_prep_readv(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+posix_prep_readv(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx, int idx)
 {
+    if (ctx->buf_index >= 0)
+        io_uring_prep_read_fixed(sqe, ctx->_fd, ctx->fop.read.iovec.iov_base,
+                                 ctx->fop.read.iovec.iov_len,
+                                 ctx->fop.read.offset, ctx->buf_index);
+    else
+        io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
+                            ctx->fop.read.offset);
+    posix_prep_fixed_file(sqe, ctx);
     sqe->flags |= IOSQE_ASYNC;
-    io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
-                        ctx->fop.read.offset);
 }
 
 int
@@ -211,6 +488,10 @@ posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     struct iobuf *iobuf = NULL;
     int ret = 0;
 
+    /* the holes of the range are looked up synchronously */
+    if (xdata && dict_get_sizen(xdata, GF_READ_SPARSE_KEY))
+        return posix_readv(frame, this, fd, size, offset, flags, xdata);
+
     ctx = posix_io_uring_ctx_init(
         frame, this, fd, GF_FOP_READ, posix_prep_readv,
         posix_io_uring_readv_complete, &op_errno, xdata);
@@ -218,7 +499,9 @@ posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
         goto err;
     }
 
-    iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
+    iobuf = posix_io_uring_get_fixed_buf(ctx->ring, size, &ctx->buf_index);
+    if (!iobuf)
+        iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
     if (!iobuf) {
         op_errno = ENOMEM;
         goto err;
@@ -269,7 +552,6 @@ posix_io_uring_writev_complete(struct posix_uring_ctx *ctx, int32_t res)
     struct iatt postbuf = {
         0,
     };
-    fd_t *fd = NULL;
     int _fd = -1;
     int ret = 0;
     int op_ret = -1;
@@ -278,7 +560,6 @@ posix_io_uring_writev_complete(struct posix_uring_ctx *ctx, int32_t res)
     frame = ctx->frame;
     this = frame->this;
     priv = this->private;
-    fd = ctx->fd;
     _fd = ctx->_fd;
 
     if (res < 0) {
@@ -289,7 +570,7 @@ posix_io_uring_writev_complete(struct posix_uring_ctx *ctx, int32_t res)
         goto out;
     }
 
-    ret = posix_fdstat(this, fd->inode, _fd, &postbuf);
+    ret = posix_io_uring_postbuf(ctx, &postbuf);
     if (ret != 0) {
         op_ret = -1;
         op_errno = errno;
@@ -311,10 +592,12 @@ out:
 }
 
 static void
-posix_prep_writev(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+posix_prep_writev(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx,
+                  int idx)
 {
     io_uring_prep_writev(sqe, ctx->_fd, ctx->fop.write.iov,
                          ctx->fop.write.count, ctx->fop.write.offset);
+    posix_prep_fixed_file(sqe, ctx);
 }
 
 int
@@ -324,8 +607,17 @@ posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
 {
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
+    struct posix_private *priv = this->private;
     int ret = 0;
 
+    /* zero writes are punched, and synchronous writes are grouped with
+     * the other flushes of the brick, by the regular path */
+    if ((priv->punch_zero_writes && !iov_0filled(iov, count)) ||
+        ((flags & (O_SYNC | O_DSYNC)) &&
+         priv->batch_fsync_mode == BATCH_GROUP_COMMIT))
+        return posix_writev(frame, this, fd, iov, count, offset, flags, iobref,
+                            xdata);
+
     ctx = posix_io_uring_ctx_init(
         frame, this, fd, GF_FOP_WRITE, posix_prep_writev,
         posix_io_uring_writev_complete, &op_errno, xdata);
@@ -364,7 +656,6 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
     struct iatt postbuf = {
         0,
     };
-    fd_t *fd = NULL;
     int _fd = -1;
     int ret = 0;
     int op_ret = -1;
@@ -373,7 +664,6 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
     frame = ctx->frame;
     this = frame->this;
     priv = this->private;
-    fd = ctx->fd;
     _fd = ctx->_fd;
 
     if (res < 0) {
@@ -384,7 +674,7 @@ posix_io_uring_fsync_complete(struct posix_uring_ctx *ctx, int32_t res)
         goto out;
     }
 
-    ret = posix_fdstat(this, fd->inode, _fd, &postbuf);
+    ret = posix_io_uring_postbuf(ctx, &postbuf);
     if (ret != 0) {
         op_ret = -1;
         op_errno = errno;
@@ -403,19 +693,27 @@ out:
 }
 
 static void
-posix_prep_fsync(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+posix_prep_fsync(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx, int idx)
 {
     io_uring_prep_fsync(sqe, ctx->_fd, ctx->fop.fsync.datasync);
+    posix_prep_fixed_file(sqe, ctx);
 }
 
 int
 posix_io_uring_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd,
                      int32_t datasync, dict_t *xdata)
 {
+    struct posix_private *priv = this->private;
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
     int ret = 0;
 
+    /* batched and group committed fsyncs are collected by posix_fsync(),
+     * an fsync on the ring would bypass them */
+    if (priv->batch_fsync_mode == BATCH_GROUP_COMMIT ||
+        (priv->batch_fsync_mode && xdata && dict_get(xdata, "batch-fsync")))
+        return posix_fsync(frame, this, fd, datasync, xdata);
+
     ctx = posix_io_uring_ctx_init(
         frame, this, fd, GF_FOP_FSYNC, posix_prep_fsync,
         posix_io_uring_fsync_complete, &op_errno, xdata);
@@ -444,140 +742,1298 @@ err:
     return 0;
 }
 
-static int
-posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+static void
+posix_io_uring_fstat_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
-    struct posix_private *priv = this->private;
-    struct io_uring_sqe *sqe = NULL;
-    int ret = 0;
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt buf = {
+        0,
+    };
+    int op_ret = -1;
+    int op_errno = 0;
 
-    pthread_mutex_lock(&priv->sq_mutex);
-    {
-        sqe = io_uring_get_sqe(&priv->ring);
-        if (!sqe) {
-            /*TODO: Retry until we get an sqe instead of failing. */
-            pthread_mutex_unlock(&priv->sq_mutex);
-            ret = -EAGAIN;
-            gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
-                   "Failed to get sqe");
-            goto out;
-        }
-        ctx->prepare(sqe, ctx);
-        io_uring_sqe_set_data(sqe, ctx);
-        ret = io_uring_submit(&priv->ring);
+    frame = ctx->frame;
+    this = frame->this;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "statx(async) failed fd=%d.", ctx->_fd);
+        goto out;
+    }
+
+    if (posix_io_uring_fill_stat(ctx, res, &buf) != 0) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fstat failed on fd=%d", ctx->_fd);
+        goto out;
     }
-    pthread_mutex_unlock(&priv->sq_mutex);
 
+    posix_update_iatt_buf(&buf, ctx->_fd, NULL, NULL);
+    op_ret = 0;
 out:
-    return ret;
+    STACK_UNWIND_STRICT(fstat, frame, op_ret, op_errno, &buf, NULL);
+    posix_io_uring_ctx_free(ctx);
 }
 
-static void *
-posix_io_uring_thread(void *data)
+static void
+posix_prep_fstat(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx, int idx)
+{
+    posix_prep_statx(sqe, ctx);
+}
+
+int
+posix_io_uring_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     dict_t *xdata)
 {
-    xlator_t *this = NULL;
-    struct posix_private *priv = NULL;
-    int ret = 0;
-    int32_t res = 0;
-    struct io_uring_cqe *cqe = NULL;
     struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
 
-    this = data;
-    THIS = this;
-    priv = this->private;
-    while (1) {
-        pthread_mutex_lock(&priv->cq_mutex);
-        {
-            ret = io_uring_wait_cqe(&priv->ring, &cqe);
-        }
-        pthread_mutex_unlock(&priv->cq_mutex);
-        if (ret != 0) {
-            if (ret == -EINTR)
-                continue;
-            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
-                   "Unable to get cqe. Exiting.");
-            abort();
-        }
+    /* xattrs requested along with the stat are filled synchronously */
+    if (xdata)
+        return posix_fstat(frame, this, fd, xdata);
 
-        ctx = (struct posix_uring_ctx *)io_uring_cqe_get_data(cqe);
-        if (priv->uring_thread_exit == _gf_true && ctx == NULL)
-            pthread_exit(NULL);
-        res = cqe->res;
-        io_uring_cqe_seen(&priv->ring, cqe);
-        ctx->unwind(ctx, res);
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSTAT,
+                                  posix_prep_fstat,
+                                  posix_io_uring_fstat_complete, &op_errno,
+                                  xdata);
+    if (!ctx) {
+        goto err;
     }
 
-    return NULL;
+    ret = posix_io_uring_submit(this, ctx);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+               "Failed to submit sqe");
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    STACK_UNWIND_STRICT(fstat, frame, -1, op_errno, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
 }
 
-int
-posix_io_uring_init(xlator_t *this)
+static void
+posix_io_uring_fallocate_complete(struct posix_uring_ctx *ctx, int32_t res)
 {
-    int ret = -1;
-    unsigned flags = 0;
-    struct posix_private *priv = this->private;
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt postbuf = {
+        0,
+    };
+    int op_ret = -1;
+    int op_errno = 0;
 
-    // TODO:Try-out flags |= IORING_SETUP_IOPOLL;
-    ret = io_uring_queue_init(POSIX_URING_MAX_ENTRIES, &priv->ring, flags);
-    if (ret == -1) {
-        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_POSIX_IO_URING,
-               "io_uring init failed.");
+    frame = ctx->frame;
+    this = frame->this;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FALLOCATE_FAILED,
+               "fallocate(async) failed on %s offset: %jd, len:%zu, "
+               "flags: %d",
+               uuid_utoa(ctx->fd->inode->gfid), ctx->fop.fallocate.offset,
+               ctx->fop.fallocate.len, ctx->fop.fallocate.mode);
         goto out;
     }
 
-    pthread_mutex_init(&priv->sq_mutex, NULL);
-    pthread_mutex_init(&priv->cq_mutex, NULL);
-    ret = gf_thread_create(&priv->uring_thread, NULL, posix_io_uring_thread,
-                           this, "posix-iouring");
-    if (ret != 0) {
-        io_uring_queue_exit(&priv->ring);
-        pthread_mutex_destroy(&priv->sq_mutex);
-        pthread_mutex_destroy(&priv->cq_mutex);
+    if (posix_io_uring_postbuf(ctx, &postbuf) != 0) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fallocate (fstat) failed on fd=%d", ctx->_fd);
         goto out;
     }
 
+    posix_set_ctime(frame, this, NULL, ctx->_fd, ctx->fd->inode, &postbuf);
+    op_ret = 0;
 out:
-    return ret;
+    if (ctx->op == GF_FOP_DISCARD)
+        STACK_UNWIND_STRICT(discard, frame, op_ret, op_errno, &ctx->prebuf,
+                            &postbuf, NULL);
+    else
+        STACK_UNWIND_STRICT(fallocate, frame, op_ret, op_errno, &ctx->prebuf,
+                            &postbuf, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fallocate(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx,
+                     int idx)
+{
+    io_uring_prep_fallocate(sqe, ctx->_fd, ctx->fop.fallocate.mode,
+                            ctx->fop.fallocate.offset,
+                            ctx->fop.fallocate.len);
+    posix_prep_fixed_file(sqe, ctx);
 }
 
 static int
-posix_io_uring_drain(struct posix_private *priv)
+posix_io_uring_do_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                            int op, int32_t mode, off_t offset, size_t len)
 {
-    struct io_uring_sqe *sqe = NULL;
-    int ret = -1;
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
 
-    priv->uring_thread_exit = _gf_true;
-    sqe = io_uring_get_sqe(&priv->ring);
-    if (!sqe)
-        return ret;
+    /* see posix_do_fallocate() */
+    if (priv->disk_reserve)
+        posix_disk_space_check(priv);
 
-    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
-    io_uring_sqe_set_data(sqe, NULL);
-    io_uring_prep_nop(sqe);
-    ret = io_uring_submit(&priv->ring);
+    if (frame->root->pid >= 0 && priv->disk_space_full) {
+        op_errno = ENOSPC;
+        goto err;
+    }
 
-    return ret;
+    ctx = posix_io_uring_ctx_init(frame, this, fd, op, posix_prep_fallocate,
+                                  posix_io_uring_fallocate_complete,
+                                  &op_errno, NULL);
+    if (!ctx) {
+        goto err;
+    }
+
+    ctx->fop.fallocate.mode = mode;
+    ctx->fop.fallocate.offset = offset;
+    ctx->fop.fallocate.len = len;
+
+    ret = posix_io_uring_submit(this, ctx);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+               "Failed to submit sqe");
+        op_errno = -ret;
+        goto err;
+    }
+    return 0;
+err:
+    if (op == GF_FOP_DISCARD)
+        STACK_UNWIND_STRICT(discard, frame, -1, op_errno, NULL, NULL, NULL);
+    else
+        STACK_UNWIND_STRICT(fallocate, frame, -1, op_errno, NULL, NULL, NULL);
+    posix_io_uring_ctx_free(ctx);
+    return 0;
 }
 
-void
-posix_io_uring_fini(xlator_t *this)
+int
+posix_io_uring_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         int32_t keep_size, off_t offset, size_t len,
+                         dict_t *xdata)
 {
-    struct posix_private *priv = this->private;
+    int32_t mode = 0;
 
-    posix_io_uring_drain(priv);
-    (void)pthread_join(priv->uring_thread, NULL);
-    io_uring_queue_exit(&priv->ring);
-    pthread_mutex_destroy(&priv->sq_mutex);
-    pthread_mutex_destroy(&priv->cq_mutex);
+    /* atomic updates and cloudsync need the fop done under their locks */
+    if (xdata)
+        return posix_glfallocate(frame, this, fd, keep_size, offset, len,
+                                 xdata);
+
+    if (keep_size)
+        mode = FALLOC_FL_KEEP_SIZE;
+
+    return posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_FALLOCATE, mode,
+                                       offset, len);
 }
 
 int
-posix_io_uring_on(xlator_t *this)
+posix_io_uring_discard(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       off_t offset, size_t len, dict_t *xdata)
 {
-    struct posix_private *priv = NULL;
-    int ret = -1;
+    if (xdata)
+        return posix_discard(frame, this, fd, offset, len, xdata);
 
-    priv = this->private;
+    return posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_DISCARD,
+                                       FALLOC_FL_KEEP_SIZE |
+                                           FALLOC_FL_PUNCH_HOLE,
+                                       offset, len);
+}
+
+/* Fills @buf from a statx done by the ring, as posix_istat() and
+ * posix_pstat() do from their lstat. */
+static int
+posix_io_uring_iatt(xlator_t *this, struct statx *stx, const char *path,
+                    inode_t *inode, uuid_t gfid, struct iatt *buf)
+{
+    struct posix_private *priv = this->private;
+    struct stat st = {
+        0,
+    };
+    int ret = 0;
+
+    posix_stat_from_statx(&st, stx);
+    if (!S_ISDIR(st.st_mode))
+        st.st_nlink--;
+    iatt_from_stat(buf, &st);
+
+    if (priv->ctime) {
+        if (inode)
+            ret = posix_get_mdata_xattr(this, path, -1, inode, buf);
+        else
+            ret = __posix_get_mdata_xattr(this, path, -1, NULL, buf);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_GETMDATA_FAILED,
+                   "posix get mdata failed on %s", path);
+            return ret;
+        }
+    }
+
+    gf_uuid_copy(buf->ia_gfid, gfid);
+    buf->ia_flags |= IATT_GFID;
+    posix_fill_ino_from_gfid(this, buf);
+
+    return 0;
+}
+
+static int
+posix_io_uring_lookup_task(void *opaque)
+{
+    struct posix_uring_ctx *ctx = opaque;
+
+    posix_lookup(ctx->frame, ctx->ring->this, &ctx->fop.lookup.loc,
+                 ctx->xdata);
+    return 0;
+}
+
+static int
+posix_io_uring_lookup_task_done(int ret, call_frame_t *frame, void *opaque)
+{
+    posix_io_uring_ctx_free(opaque);
+    return 0;
+}
+
+/* Whatever the ring cannot answer is looked up the regular way, in a
+ * synctask: posix_lookup() blocks, and would hold up the reaping of the
+ * completion thread. */
+static void
+posix_io_uring_lookup_sync(struct posix_uring_ctx *ctx)
+{
+    xlator_t *this = ctx->ring->this;
+
+    /* not needed any more, don't keep them meanwhile */
+    if (ctx->fop.lookup.slot >= 0) {
+        posix_io_uring_slot_put(this->private, ctx->fop.lookup.slot);
+        ctx->fop.lookup.slot = -1;
+    }
+    if (ctx->fop.lookup.dirfd) {
+        posix_dirfd_put(this, ctx->fop.lookup.dirfd);
+        ctx->fop.lookup.dirfd = NULL;
+    }
+
+    if (synctask_new(this->ctx->env, posix_io_uring_lookup_task,
+                     posix_io_uring_lookup_task_done, NULL, ctx) == 0)
+        return;
+
+    gf_msg_debug(this->name, 0, "synctask creation failed, looking %s up "
+                 "from the completion thread", ctx->fop.lookup.loc.name);
+    posix_io_uring_lookup_task(ctx);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_io_uring_lookup_xattr_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = ctx->frame;
+    xlator_t *this = frame->this;
+    loc_t *loc = &ctx->fop.lookup.loc;
+    int dfd = ctx->fop.lookup.dirfd->fd;
+    struct iatt buf = {
+        0,
+    };
+    struct iatt postparent = {
+        0,
+    };
+    dict_t *xattr = NULL;
+    char *real_path = NULL;
+    char *par_path = NULL;
+    char *value = NULL;
+    int32_t size = 0;
+    int i;
+
+    /* the entry went away or was replaced since it was stated, or it has
+     * no gfid yet and may need healing */
+    if (res < 0 || ctx->res[1] != sizeof(uuid_t))
+        goto sync;
+
+    for (i = 0; i < ctx->fop.lookup.nkeys; i++) {
+        if (ctx->res[i + 2] == -ERANGE)
+            goto sync;
+    }
+
+    real_path = alloca(sizeof("/proc/self/fd//") + 16 + strlen(loc->name));
+    sprintf(real_path, "/proc/self/fd/%d/%s", dfd, loc->name);
+    par_path = alloca(sizeof("/proc/self/fd//.") + 16);
+    sprintf(par_path, "/proc/self/fd/%d/.", dfd);
+
+    if (posix_io_uring_iatt(this, &ctx->stx, real_path, loc->inode,
+                            ctx->fop.lookup.gfid, &buf) ||
+        posix_io_uring_iatt(this, &ctx->fop.lookup.parent, par_path,
+                            loc->parent, loc->pargfid, &postparent))
+        goto sync;
+
+    if (ctx->xdata) {
+        xattr = dict_new();
+        for (i = 0; xattr && i < ctx->fop.lookup.nkeys; i++) {
+            size = ctx->res[i + 2];
+            if (size < 0)
+                continue;
+            value = GF_MALLOC(size + 1, gf_posix_mt_char);
+            if (!value)
+                continue;
+            memcpy(value,
+                   ctx->fop.lookup.values + i * POSIX_URING_XATTR_SIZE, size);
+            value[size] = '\0';
+            if (dict_set_bin(xattr, ctx->fop.lookup.keys[i], value, size) <
+                0) {
+                gf_msg_debug(this->name, 0,
+                             "dict set failed. path: %s, key: %s", real_path,
+                             ctx->fop.lookup.keys[i]);
+                GF_FREE(value);
+            }
+        }
+    }
+
+    STACK_UNWIND_STRICT(lookup, frame, 0, 0, loc->inode, &buf, xattr,
+                        &postparent);
+    if (xattr)
+        dict_unref(xattr);
+    posix_io_uring_ctx_free(ctx);
+    return;
+
+sync:
+    posix_io_uring_lookup_sync(ctx);
+}
+
+/* Opens the entry in a slot of the registered file table, reads its gfid
+ * and the requested xattrs through it and closes it. The xattr reads are
+ * hard links so that a missing one does not cancel the close. */
+static void
+posix_prep_lookup_xattr(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx,
+                        int idx)
+{
+    int slot = ctx->fop.lookup.slot;
+    int key = idx - 2;
+
+    if (idx == 0) {
+        io_uring_prep_openat_direct(sqe, ctx->fop.lookup.dirfd->fd,
+                                    ctx->fop.lookup.loc.name,
+                                    O_RDONLY | O_NOFOLLOW | O_NONBLOCK |
+                                        O_NOCTTY,
+                                    0, slot);
+        return;
+    }
+
+    if (idx == ctx->nr - 1) {
+        io_uring_prep_close_direct(sqe, slot);
+        return;
+    }
+
+    if (idx == 1)
+        io_uring_prep_fgetxattr(sqe, slot, GFID_XATTR_KEY,
+                                (char *)ctx->fop.lookup.gfid, sizeof(uuid_t));
+    else
+        io_uring_prep_fgetxattr(
+            sqe, slot, ctx->fop.lookup.keys[key],
+            ctx->fop.lookup.values + key * POSIX_URING_XATTR_SIZE,
+            POSIX_URING_XATTR_SIZE);
+    sqe->flags |= IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+}
+
+static void
+posix_io_uring_lookup_stat_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = ctx->frame;
+    xlator_t *this = frame->this;
+    struct posix_private *priv = this->private;
+    loc_t *loc = &ctx->fop.lookup.loc;
+    struct statx *stx = &ctx->stx;
+    struct iatt buf = {
+        0,
+    };
+    struct iatt postparent = {
+        0,
+    };
+    char *par_path = NULL;
+    int32_t op_errno = 0;
+
+    par_path = alloca(sizeof("/proc/self/fd//.") + 16);
+    sprintf(par_path, "/proc/self/fd/%d/.", ctx->fop.lookup.dirfd->fd);
+
+    if (res < 0 || ctx->fop.lookup.parent.stx_nlink == 0) {
+        /* a missing parent is a bad handle, see posix_lookup() */
+        op_errno = (res < 0 && res != -ENOENT) ? -res : ESTALE;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_LSTAT_FAILED,
+               "post-operation lstat on parent %s failed",
+               uuid_utoa(loc->pargfid));
+        if (res >= 0)
+            posix_dirfd_forget(this, loc->pargfid);
+        goto err;
+    }
+
+    if (ctx->res[1] == -ENOENT ||
+        (ctx->res[1] == 0 && stx->stx_ino == priv->handledir.st_ino &&
+         makedev(stx->stx_dev_major, stx->stx_dev_minor) ==
+             priv->handledir.st_dev)) {
+        if (posix_io_uring_iatt(this, &ctx->fop.lookup.parent, par_path,
+                                loc->parent, loc->pargfid, &postparent))
+            goto sync;
+        STACK_UNWIND_STRICT(lookup, frame, -1, ENOENT, loc->inode, &buf, NULL,
+                            &postparent);
+        posix_io_uring_ctx_free(ctx);
+        return;
+    }
+
+    /* symlinks and special files are not opened, nor is anything once
+     * the file table is full */
+    if (ctx->res[1] < 0 || !(S_ISREG(stx->stx_mode) || S_ISDIR(stx->stx_mode)))
+        goto sync;
+
+    ctx->fop.lookup.slot = posix_io_uring_slot_get(priv);
+    if (ctx->fop.lookup.slot < 0)
+        goto sync;
+
+    if (ctx->fop.lookup.nkeys) {
+        ctx->fop.lookup.values = GF_MALLOC(
+            ctx->fop.lookup.nkeys * POSIX_URING_XATTR_SIZE, gf_posix_mt_char);
+        if (!ctx->fop.lookup.values)
+            goto sync;
+    }
+
+    ctx->nr = ctx->fop.lookup.nkeys + 3;
+    ctx->prepare = posix_prep_lookup_xattr;
+    ctx->unwind = posix_io_uring_lookup_xattr_complete;
+    if (posix_io_uring_submit(this, ctx) < 0)
+        goto sync;
+    return;
+
+sync:
+    posix_io_uring_lookup_sync(ctx);
+    return;
+err:
+    STACK_UNWIND_STRICT(lookup, frame, -1, op_errno, loc->inode, &buf, NULL,
+                        &postparent);
+    posix_io_uring_ctx_free(ctx);
+}
+
+/* Stats the parent and the entry relative to the cached fd of the
+ * parent. */
+static void
+posix_prep_lookup_stat(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx,
+                       int idx)
+{
+    if (idx == 0)
+        io_uring_prep_statx(sqe, ctx->fop.lookup.dirfd->fd, "",
+                            AT_EMPTY_PATH, STATX_BASIC_STATS,
+                            &ctx->fop.lookup.parent);
+    else
+        io_uring_prep_statx(sqe, ctx->fop.lookup.dirfd->fd,
+                            ctx->fop.lookup.loc.name, AT_SYMLINK_NOFOLLOW,
+                            STATX_BASIC_STATS, &ctx->stx);
+}
+
+static int
+posix_io_uring_lookup_key(dict_t *xdata, char *key, data_t *value, void *data)
+{
+    struct posix_uring_ctx *ctx = data;
+    int n = ctx->fop.lookup.nkeys;
+
+    switch (posix_xattr_req_kind(key)) {
+        case POSIX_XATTR_REQ_IGNORED:
+            return 0;
+        case POSIX_XATTR_REQ_BACKEND:
+            if (n == POSIX_URING_LOOKUP_XATTRS)
+                return -1;
+            ctx->fop.lookup.keys[n] = gf_strdup(key);
+            if (!ctx->fop.lookup.keys[n])
+                return -1;
+            ctx->fop.lookup.nkeys++;
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+/* Named lookups of an entry whose parent is in the dirfd cache, and which
+ * only ask for plain xattrs, are done by the ring in two chains: a statx
+ * of the parent and the entry, then the xattr reads of an existing
+ * directory or regular file. Anything else is left to posix_lookup(). */
+int
+posix_io_uring_lookup(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                      dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+
+    if (!priv->dirfd_cache.limit || gf_uuid_is_null(loc->pargfid) ||
+        !loc->name || !loc->inode ||
+        strchr(loc->name, '/') || LOC_HAS_ABSPATH(loc) ||
+        (__is_root_gfid(loc->pargfid) && !strcmp(loc->name, GF_HIDDEN_PATH)))
+        goto sync;
+
+    /* the pgfid xattrs are healed, and these keys acted upon, by lookups */
+    if (priv->update_pgfid_nlinks ||
+        (xdata && (dict_get_sizen(xdata, GF_CLEAN_WRITE_PROTECTION) ||
+                   dict_get_sizen(xdata, GF_CS_OBJECT_STATUS) ||
+                   dict_get_sizen(xdata, GF_CS_OBJECT_REPAIR) ||
+                   dict_get_sizen(xdata, "get-full-path"))))
+        goto sync;
+
+    ctx = posix_io_uring_ctx_new(frame, this, GF_FOP_LOOKUP,
+                                 posix_prep_lookup_stat,
+                                 posix_io_uring_lookup_stat_complete, xdata);
+    if (!ctx)
+        goto sync;
+
+    if (xdata && dict_foreach(xdata, posix_io_uring_lookup_key, ctx) < 0)
+        goto sync;
+
+    ctx->fop.lookup.dirfd = posix_dirfd_get(this, loc->pargfid, _gf_true);
+    if (!ctx->fop.lookup.dirfd)
+        goto sync;
+
+    if (loc_copy(&ctx->fop.lookup.loc, loc) != 0)
+        goto sync;
+
+    ctx->nr = 2;
+    if (posix_io_uring_submit(this, ctx) < 0)
+        goto sync;
+
+    return 0;
+sync:
+    posix_io_uring_ctx_free(ctx);
+    return posix_lookup(frame, this, loc, xdata);
+}
+
+static void
+posix_prep_entry_parent(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_statx(sqe, AT_FDCWD, ctx->fop.entry.par_path,
+                        AT_SYMLINK_NOFOLLOW, STATX_BASIC_STATS, &ctx->stx);
+}
+
+static void
+posix_prep_entry_handle(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    struct posix_private *priv = ctx->ring->this->private;
+
+    /* see posix_handle_unset_gfid() */
+    io_uring_prep_unlinkat(sqe, priv->arrdfd[ctx->fop.entry.stbuf.ia_gfid[0]],
+                           ctx->fop.entry.handle, 0);
+    sqe->flags |= IOSQE_IO_HARDLINK;
+}
+
+/* Copies what the completion of an entry fop needs out of the io-thread's
+ * stack. */
+static int
+posix_io_uring_entry_init(struct posix_uring_ctx *ctx, loc_t *loc,
+                          const char *real_path, const char *par_path,
+                          struct iatt *stbuf)
+{
+    ctx->fop.entry.real_path = gf_strdup(real_path);
+    ctx->fop.entry.par_path = gf_strdup(par_path);
+    if (!ctx->fop.entry.real_path || !ctx->fop.entry.par_path)
+        return -1;
+
+    ctx->fop.entry.stbuf = *stbuf;
+    return loc_copy(&ctx->fop.entry.loc, loc);
+}
+
+static int
+posix_io_uring_entry_postparent(struct posix_uring_ctx *ctx, int32_t res,
+                                struct iatt *postparent, int32_t *op_errno)
+{
+    xlator_t *this = ctx->frame->this;
+    loc_t *loc = &ctx->fop.entry.loc;
+
+    if (res < 0) {
+        *op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, *op_errno, P_MSG_LSTAT_FAILED,
+               "post-operation lstat on parent %s failed",
+               ctx->fop.entry.par_path);
+        return -1;
+    }
+
+    if (posix_io_uring_iatt(this, &ctx->stx, ctx->fop.entry.par_path,
+                            loc->parent, loc->pargfid, postparent)) {
+        *op_errno = errno;
+        return -1;
+    }
+
+    posix_set_parent_ctime(ctx->frame, this, ctx->fop.entry.par_path, -1,
+                           loc->parent, postparent);
+    return 0;
+}
+
+static void
+posix_io_uring_unlink_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = ctx->frame;
+    xlator_t *this = frame->this;
+    struct iatt *stbuf = &ctx->fop.entry.stbuf;
+    struct iatt postparent = {
+        0,
+    };
+    dict_t *unwind_dict = NULL;
+    int handle = ctx->fop.entry.handle[0] != '\0';
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    if (handle && res < 0) {
+        if (res != -ENOENT)
+            gf_msg(this->name, GF_LOG_WARNING, -res, P_MSG_HANDLE_DELETE,
+                   "unlink %s failed", ctx->fop.entry.handle);
+        gf_msg(this->name, GF_LOG_ERROR, -res, P_MSG_UNLINK_FAILED,
+               "unlink of gfid handle failed for path:%s with gfid %s",
+               ctx->fop.entry.real_path, uuid_utoa(stbuf->ia_gfid));
+    }
+
+    if (ctx->res[handle] < 0) {
+        op_errno = -ctx->res[handle];
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_UNLINK_FAILED,
+               "unlink of %s failed", ctx->fop.entry.real_path);
+        goto out;
+    }
+
+    /* the file lives on under its other names */
+    if (!handle)
+        posix_set_ctime(frame, this, NULL, -1, ctx->fop.entry.loc.inode,
+                        stbuf);
+
+    unwind_dict = dict_new();
+    if (unwind_dict && ctx->xdata &&
+        dict_get_sizen(ctx->xdata, GF_GET_FILE_BLOCK_COUNT) &&
+        dict_set_uint64(unwind_dict, GF_GET_FILE_BLOCK_COUNT,
+                        stbuf->ia_blocks))
+        gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_SET_XDATA_FAIL,
+               "Failed to set %s in rsp dict", GF_GET_FILE_BLOCK_COUNT);
+
+    if (posix_io_uring_entry_postparent(ctx, ctx->res[handle + 1],
+                                        &postparent, &op_errno))
+        goto out;
+
+    unwind_dict = posix_dict_set_nlink(ctx->xdata, unwind_dict,
+                                       stbuf->ia_nlink);
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(unlink, frame, op_ret, op_errno,
+                        &ctx->fop.entry.preparent, &postparent, unwind_dict);
+    if (unwind_dict)
+        dict_unref(unwind_dict);
+    posix_io_uring_ctx_free(ctx);
+}
+
+/* The gfid handle of a file losing its last name, hard linked so that the
+ * name still goes when the handle is already gone, then the name and a
+ * statx of the parent. */
+static void
+posix_prep_unlink(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx,
+                  int idx)
+{
+    int handle = ctx->fop.entry.handle[0] != '\0';
+
+    if (handle && idx == 0)
+        posix_prep_entry_handle(sqe, ctx);
+    else if (idx == handle)
+        io_uring_prep_unlinkat(sqe, AT_FDCWD, ctx->fop.entry.real_path, 0);
+    else
+        posix_prep_entry_parent(sqe, ctx);
+}
+
+/* Unlinks files by the ring when posix_unlink() would do no more than
+ * remove the name and, for the last one, the gfid handle. */
+int
+posix_io_uring_unlink(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                      int xflag, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    char *real_path = NULL;
+    char *par_path = NULL;
+    struct iatt stbuf = {
+        0,
+    };
+    int32_t op_ret = -1;
+    gf_boolean_t busy = _gf_false;
+
+    /* checks of the file, its stat after the unlink or an fd kept open
+     * across it */
+    if ((xdata && (dict_get_sizen(xdata, DHT_SKIP_OPEN_FD_UNLINK) ||
+                   dict_get_sizen(xdata, DHT_SKIP_NON_LINKTO_UNLINK) ||
+                   dict_get_sizen(xdata, DHT_IATT_IN_XDATA_KEY) ||
+                   dict_get_sizen(xdata, GET_LINK_COUNT))) ||
+        (priv->background_unlink && IA_ISREG(loc->inode->ia_type)))
+        goto sync;
+
+    MAKE_ENTRY_HANDLE(real_path, par_path, this, loc, &stbuf);
+    if (!real_path || !par_path || op_ret == -1 ||
+        gf_uuid_is_null(stbuf.ia_gfid))
+        goto sync;
+
+    if (stbuf.ia_nlink == 1) {
+        /* open files are moved to the unlink directory and large ones
+         * freed in the background */
+        LOCK(&loc->inode->lock);
+        busy = (loc->inode->fd_count != 0);
+        UNLOCK(&loc->inode->lock);
+        if (busy || posix_reclaim_wanted(this, &stbuf))
+            goto sync;
+    } else if (priv->update_pgfid_nlinks || priv->gfid2path) {
+        /* the xattrs naming the parent go with the name */
+        goto sync;
+    }
+
+    ctx = posix_io_uring_ctx_new(frame, this, GF_FOP_UNLINK,
+                                 posix_prep_unlink,
+                                 posix_io_uring_unlink_complete, xdata);
+    if (!ctx)
+        goto sync;
+
+    if (posix_io_uring_entry_init(ctx, loc, real_path, par_path, &stbuf))
+        goto sync;
+
+    if (posix_pstat(this, loc->parent, loc->pargfid, par_path,
+                    &ctx->fop.entry.preparent, _gf_false) == -1)
+        goto sync;
+
+    ctx->nr = 2;
+    if (stbuf.ia_nlink == 1) {
+        (void)snprintf(ctx->fop.entry.handle, sizeof(ctx->fop.entry.handle),
+                       "%02x/%s", stbuf.ia_gfid[1], uuid_utoa(stbuf.ia_gfid));
+        posix_dirfd_forget(this, stbuf.ia_gfid);
+        posix_mds_forget(this, stbuf.ia_gfid);
+        ctx->nr = 3;
+    }
+
+    if (posix_io_uring_submit(this, ctx) < 0)
+        goto sync;
+
+    return 0;
+sync:
+    posix_io_uring_ctx_free(ctx);
+    return posix_unlink(frame, this, loc, xflag, xdata);
+}
+
+static void
+posix_io_uring_rmdir_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = ctx->frame;
+    xlator_t *this = frame->this;
+    uuid_t gfid = {0};
+    struct iatt postparent = {
+        0,
+    };
+    int handle = ctx->fop.entry.handle[0] != '\0';
+    int32_t op_ret = -1;
+    int32_t op_errno = 0;
+
+    gf_uuid_copy(gfid, ctx->fop.entry.stbuf.ia_gfid);
+
+    if (res < 0) {
+        op_errno = -res;
+        if (op_errno == EEXIST)
+            op_errno = ENOTEMPTY;
+        /* No need to log a common error as ENOTEMPTY */
+        if (op_errno == ENOTEMPTY) {
+            gf_msg_debug(this->name, 0, "rmdir on %s failed",
+                         ctx->fop.entry.real_path);
+        } else {
+            gf_msg(this->name, GF_LOG_ERROR, op_errno,
+                   P_MSG_DIR_OPERATION_FAILED, "rmdir on %s failed",
+                   ctx->fop.entry.real_path);
+        }
+        goto out;
+    }
+
+    posix_dirfd_forget(this, gfid);
+    if (handle) {
+        posix_mds_forget(this, gfid);
+        if (ctx->res[1] < 0 && ctx->res[1] != -ENOENT)
+            gf_msg(this->name, GF_LOG_WARNING, -ctx->res[1],
+                   P_MSG_HANDLE_DELETE, "unlink %s failed",
+                   ctx->fop.entry.handle);
+    }
+
+    if (posix_io_uring_entry_postparent(ctx, ctx->res[ctx->nr - 1],
+                                        &postparent, &op_errno))
+        goto out;
+
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(rmdir, frame, op_ret, op_errno,
+                        &ctx->fop.entry.preparent, &postparent, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+/* The directory, then its gfid handle if it still points at this name and
+ * a statx of the parent. */
+static void
+posix_prep_rmdir(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx,
+                 int idx)
+{
+    if (idx == 0)
+        io_uring_prep_unlinkat(sqe, AT_FDCWD, ctx->fop.entry.real_path,
+                               AT_REMOVEDIR);
+    else if (idx == ctx->nr - 1)
+        posix_prep_entry_parent(sqe, ctx);
+    else
+        posix_prep_entry_handle(sqe, ctx);
+}
+
+int
+posix_io_uring_rmdir(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                     int flags, dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    char *real_path = NULL;
+    char *par_path = NULL;
+    struct iatt stbuf = {
+        0,
+    };
+    int32_t op_ret = -1;
+
+    /* moves to the trash directory and the hidden directory */
+    if (flags || !loc->name ||
+        (__is_root_gfid(loc->pargfid) && !strcmp(loc->name, GF_HIDDEN_PATH)))
+        goto sync;
+
+    MAKE_ENTRY_HANDLE(real_path, par_path, this, loc, &stbuf);
+    if (!real_path || !par_path || op_ret == -1 ||
+        gf_uuid_is_null(stbuf.ia_gfid))
+        goto sync;
+
+    ctx = posix_io_uring_ctx_new(frame, this, GF_FOP_RMDIR, posix_prep_rmdir,
+                                 posix_io_uring_rmdir_complete, xdata);
+    if (!ctx)
+        goto sync;
+
+    if (posix_io_uring_entry_init(ctx, loc, real_path, par_path, &stbuf))
+        goto sync;
+
+    if (posix_pstat(this, loc->parent, loc->pargfid, par_path,
+                    &ctx->fop.entry.preparent, _gf_false) == -1)
+        goto sync;
+
+    ctx->nr = 2;
+    if (posix_symlinks_match(this, loc, stbuf.ia_gfid)) {
+        (void)snprintf(ctx->fop.entry.handle, sizeof(ctx->fop.entry.handle),
+                       "%02x/%s", stbuf.ia_gfid[1], uuid_utoa(stbuf.ia_gfid));
+        ctx->nr = 3;
+    }
+
+    if (posix_io_uring_submit(this, ctx) < 0)
+        goto sync;
+
+    return 0;
+sync:
+    posix_io_uring_ctx_free(ctx);
+    return posix_rmdir(frame, this, loc, flags, xdata);
+}
+
+static int
+posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+{
+    struct posix_uring *ring = ctx->ring;
+    struct io_uring_sqe *sqe = NULL;
+    int nr = ctx->nr;
+    int ret = 0;
+    int i;
+
+    pthread_mutex_lock(&ring->sq_mutex);
+    {
+        if (io_uring_sq_space_left(&ring->ring) < nr) {
+            /*TODO: Retry until we get an sqe instead of failing. */
+            pthread_mutex_unlock(&ring->sq_mutex);
+            ret = -EAGAIN;
+            gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+                   "Failed to get sqe");
+            goto out;
+        }
+
+        ctx->pending = nr;
+        for (i = 0; i < nr; i++) {
+            sqe = io_uring_get_sqe(&ring->ring);
+            if (ctx->link_stat && i == nr - 1)
+                posix_prep_statx(sqe, ctx);
+            else
+                ctx->prepare(sqe, ctx, i);
+            /* a hard link goes on with the chain even if the sqe fails */
+            if (i < nr - 1 && !(sqe->flags & IOSQE_IO_HARDLINK))
+                sqe->flags |= IOSQE_IO_LINK;
+            ctx->link[i].ctx = ctx;
+            ctx->link[i].idx = i;
+            io_uring_sqe_set_data(sqe, &ctx->link[i]);
+        }
+        ret = io_uring_submit(&ring->ring);
+    }
+    pthread_mutex_unlock(&ring->sq_mutex);
+
+out:
+    return ret;
+}
+
+static void *
+posix_io_uring_thread(void *data)
+{
+    struct posix_uring *ring = NULL;
+    xlator_t *this = NULL;
+    struct posix_private *priv = NULL;
+    int ret = 0;
+    int32_t res = 0;
+    struct io_uring_cqe *cqe = NULL;
+    struct posix_uring_link *link = NULL;
+    struct posix_uring_ctx *ctx = NULL;
+
+    ring = data;
+    this = ring->this;
+    THIS = this;
+    priv = this->private;
+    while (1) {
+        pthread_mutex_lock(&ring->cq_mutex);
+        {
+            ret = io_uring_wait_cqe(&ring->ring, &cqe);
+        }
+        pthread_mutex_unlock(&ring->cq_mutex);
+        if (ret != 0) {
+            if (ret == -EINTR)
+                continue;
+            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+                   "Unable to get cqe. Exiting.");
+            abort();
+        }
+
+        link = (struct posix_uring_link *)io_uring_cqe_get_data(cqe);
+        if (priv->uring_thread_exit == _gf_true && link == NULL)
+            pthread_exit(NULL);
+        res = cqe->res;
+        io_uring_cqe_seen(&ring->ring, cqe);
+
+        /* the fop is done once every sqe of its chain has completed */
+        ctx = link->ctx;
+        ctx->res[link->idx] = res;
+        if (--ctx->pending == 0)
+            ctx->unwind(ctx, ctx->res[0]);
+    }
+
+    return NULL;
+}
+
+static void
+posix_io_uring_release_bufs(struct posix_uring *ring)
+{
+    int i;
+
+    for (i = 0; i < ring->nbufs; i++)
+        iobuf_unref(ring->bufs[i]);
+    ring->nbufs = 0;
+}
+
+static void
+posix_io_uring_register_bufs(xlator_t *this, struct posix_uring *ring)
+{
+    struct iovec iov[POSIX_URING_FIXED_BUFS];
+    int ret;
+    int i;
+
+    for (i = 0; i < POSIX_URING_FIXED_BUFS; i++) {
+        ring->bufs[i] = iobuf_get2(this->ctx->iobuf_pool,
+                                   POSIX_URING_FIXED_BUF_SIZE);
+        if (!ring->bufs[i])
+            break;
+        iov[i].iov_base = iobuf_ptr(ring->bufs[i]);
+        iov[i].iov_len = POSIX_URING_FIXED_BUF_SIZE;
+        ring->nbufs++;
+    }
+
+    ret = ring->nbufs ? io_uring_register_buffers(&ring->ring, iov,
+                                                  ring->nbufs)
+                      : -ENOMEM;
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+               "registering io_uring read buffers failed, reads will use "
+               "regular buffers");
+        posix_io_uring_release_bufs(ring);
+    }
+}
+
+static void
+posix_io_uring_ring_fini(struct posix_uring *ring)
+{
+    io_uring_queue_exit(&ring->ring);
+    posix_io_uring_release_bufs(ring);
+    pthread_mutex_destroy(&ring->sq_mutex);
+    pthread_mutex_destroy(&ring->cq_mutex);
+}
+
+static int
+posix_io_uring_ring_init(xlator_t *this, struct posix_uring *ring, int idx)
+{
+    struct posix_private *priv = this->private;
+    unsigned flags = 0;
+    int ret = -1;
+
+    ring->this = this;
+
+    // TODO:Try-out flags |= IORING_SETUP_IOPOLL;
+    ret = io_uring_queue_init(POSIX_URING_MAX_ENTRIES, &ring->ring, flags);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+               "io_uring init failed.");
+        return -1;
+    }
+
+    pthread_mutex_init(&ring->sq_mutex, NULL);
+    pthread_mutex_init(&ring->cq_mutex, NULL);
+
+    if (priv->io_uring_fixed)
+        posix_io_uring_register_bufs(this, ring);
+
+    ret = gf_thread_create(&ring->thread, NULL, posix_io_uring_thread, ring,
+                           "posix-iouring%d", idx);
+    if (ret != 0) {
+        posix_io_uring_ring_fini(ring);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+posix_io_uring_files_init(struct posix_private *priv)
+{
+    int i;
+
+    priv->uring_files = GF_MALLOC(POSIX_URING_MAX_FILES * sizeof(int32_t),
+                                  gf_posix_mt_uring_t);
+    priv->uring_files_free = GF_MALLOC(
+        POSIX_URING_MAX_FILES * sizeof(int32_t), gf_posix_mt_uring_t);
+    if (!priv->uring_files || !priv->uring_files_free) {
+        GF_FREE(priv->uring_files);
+        GF_FREE(priv->uring_files_free);
+        priv->uring_files = NULL;
+        priv->uring_files_free = NULL;
+        return -1;
+    }
+
+    for (i = 0; i < POSIX_URING_MAX_FILES; i++) {
+        priv->uring_files[i] = -1;
+        priv->uring_files_free[i] = POSIX_URING_MAX_FILES - 1 - i;
+    }
+    priv->uring_files_nfree = POSIX_URING_MAX_FILES;
+    pthread_mutex_init(&priv->uring_files_lock, NULL);
+
+    return 0;
+}
+
+static void
+posix_io_uring_files_fini(struct posix_private *priv)
+{
+    if (!priv->uring_files_free)
+        return;
+
+    pthread_mutex_destroy(&priv->uring_files_lock);
+    GF_FREE(priv->uring_files);
+    GF_FREE(priv->uring_files_free);
+    priv->uring_files = NULL;
+    priv->uring_files_free = NULL;
+}
+
+/* Registers the (empty) file table with every ring. A slot is the same
+ * file in all of them, so either every ring gets the table or none
+ * does. */
+static void
+posix_io_uring_register_files(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    uint32_t i;
+    int ret = 0;
+
+    if (!priv->uring_files)
+        return;
+
+    for (i = 0; i < priv->uring_nrings; i++) {
+        ret = io_uring_register_files(&priv->rings[i].ring, priv->uring_files,
+                                      POSIX_URING_MAX_FILES);
+        if (ret < 0)
+            break;
+    }
+    if (ret >= 0)
+        return;
+
+    gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+           "registering io_uring files failed, using regular fds");
+    while (i-- > 0)
+        (void)io_uring_unregister_files(&priv->rings[i].ring);
+    posix_io_uring_files_fini(priv);
+}
+
+int
+posix_io_uring_init(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct io_uring_probe *probe = NULL;
+    uint32_t nrings = 0;
+    uint32_t i;
+
+    nrings = priv->io_uring_rings ? priv->io_uring_rings : 1;
+    priv->rings = GF_CALLOC(nrings, sizeof(*priv->rings), gf_posix_mt_uring_t);
+    if (!priv->rings)
+        return -1;
+
+    if (priv->io_uring_fixed && posix_io_uring_files_init(priv) != 0)
+        gf_msg(this->name, GF_LOG_WARNING, ENOMEM, P_MSG_POSIX_IO_URING,
+               "io_uring file table allocation failed, using regular fds");
+
+    priv->uring_thread_exit = _gf_false;
+    for (i = 0; i < nrings; i++) {
+        if (posix_io_uring_ring_init(this, &priv->rings[i], i) != 0)
+            break;
+    }
+    priv->uring_nrings = i;
+    if (!priv->uring_nrings) {
+        posix_io_uring_files_fini(priv);
+        GF_FREE(priv->rings);
+        priv->rings = NULL;
+        return -1;
+    }
+
+    /* all the slots start empty, see posix_io_uring_fd_register() */
+    posix_io_uring_register_files(this);
+
+    probe = io_uring_get_probe_ring(&priv->rings[0].ring);
+    if (probe) {
+        priv->io_uring_statx = io_uring_opcode_supported(probe,
+                                                         IORING_OP_STATX);
+        priv->io_uring_fallocate = io_uring_opcode_supported(
+            probe, IORING_OP_FALLOCATE);
+        /* fgetxattr came with the deferred file assignment which lets a
+         * linked sqe use the file an openat_direct before it installs */
+        priv->io_uring_lookup =
+            priv->io_uring_statx &&
+            io_uring_opcode_supported(probe, IORING_OP_OPENAT) &&
+            io_uring_opcode_supported(probe, IORING_OP_CLOSE) &&
+            io_uring_opcode_supported(probe, IORING_OP_FGETXATTR);
+        priv->io_uring_unlink = priv->io_uring_statx &&
+                                io_uring_opcode_supported(probe,
+                                                          IORING_OP_UNLINKAT);
+        io_uring_free_probe(probe);
+    }
+
+    return 0;
+}
+
+static int
+posix_io_uring_drain(struct posix_private *priv, struct posix_uring *ring)
+{
+    struct io_uring_sqe *sqe = NULL;
+    int ret = -1;
+
+    priv->uring_thread_exit = _gf_true;
+    sqe = io_uring_get_sqe(&ring->ring);
+    if (!sqe)
+        return ret;
+
+    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
+    io_uring_sqe_set_data(sqe, NULL);
+    io_uring_prep_nop(sqe);
+    ret = io_uring_submit(&ring->ring);
+
+    return ret;
+}
+
+void
+posix_io_uring_fini(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    uint32_t i;
+
+    for (i = 0; i < priv->uring_nrings; i++) {
+        posix_io_uring_drain(priv, &priv->rings[i]);
+        (void)pthread_join(priv->rings[i].thread, NULL);
+        posix_io_uring_ring_fini(&priv->rings[i]);
+    }
+    posix_io_uring_files_fini(priv);
+    GF_FREE(priv->rings);
+    priv->rings = NULL;
+    priv->uring_nrings = 0;
+}
+
+/* Puts the fd of a newly opened file in the registered file table of the
+ * rings, so that its reads and writes skip the fd lookup and reference
+ * taking of every request. */
+void
+posix_io_uring_fd_register(xlator_t *this, struct posix_fd *pfd)
+{
+    struct posix_private *priv = this->private;
+    int32_t slot = -1;
+    uint32_t i;
+    int ret = 0;
+
+    if (!priv->io_uring_configured || !priv->io_uring_capable ||
+        !priv->uring_files)
+        return;
+
+    pthread_mutex_lock(&priv->uring_files_lock);
+    {
+        if (!priv->uring_files_nfree)
+            goto unlock;
+        slot = priv->uring_files_free[--priv->uring_files_nfree];
+
+        for (i = 0; i < priv->uring_nrings; i++) {
+            ret = io_uring_register_files_update(&priv->rings[i].ring, slot,
+                                                 &pfd->fd, 1);
+            if (ret < 0)
+                break;
+        }
+        if (ret < 0) {
+            gf_msg_debug(this->name, -ret, "io_uring files update failed");
+            while (i-- > 0)
+                (void)io_uring_register_files_update(&priv->rings[i].ring,
+                                                     slot,
+                                                     &priv->uring_files[slot],
+                                                     1);
+            priv->uring_files_free[priv->uring_files_nfree++] = slot;
+            goto unlock;
+        }
+
+        priv->uring_files[slot] = pfd->fd;
+        pfd->uring_slot = slot + 1;
+    }
+unlock:
+    pthread_mutex_unlock(&priv->uring_files_lock);
+}
+
+void
+posix_io_uring_fd_unregister(xlator_t *this, struct posix_fd *pfd)
+{
+    struct posix_private *priv = this->private;
+    int32_t unused = -1;
+    int32_t slot = -1;
+    uint32_t i;
+
+    if (!pfd->uring_slot || !priv->uring_files)
+        return;
+
+    pthread_mutex_lock(&priv->uring_files_lock);
+    {
+        slot = posix_io_uring_fd_slot(priv, pfd);
+        if (slot >= 0) {
+            for (i = 0; i < priv->uring_nrings; i++)
+                (void)io_uring_register_files_update(&priv->rings[i].ring,
+                                                     slot, &unused, 1);
+            priv->uring_files[slot] = -1;
+            priv->uring_files_free[priv->uring_files_nfree++] = slot;
+        }
+        pfd->uring_slot = 0;
+    }
+    pthread_mutex_unlock(&priv->uring_files_lock);
+}
+
+int
+posix_io_uring_on(xlator_t *this)
+{
+    struct posix_private *priv = NULL;
+    int ret = -1;
+
+    priv = this->private;
 
     if (!priv->io_uring_init_done) {
         ret = posix_io_uring_init(this);
@@ -592,6 +2048,19 @@ posix_io_uring_on(xlator_t *this)
         this->fops->readv = posix_io_uring_readv;
         this->fops->writev = posix_io_uring_writev;
         this->fops->fsync = posix_io_uring_fsync;
+        if (priv->io_uring_statx)
+            this->fops->fstat = posix_io_uring_fstat;
+        if (priv->io_uring_fallocate) {
+            this->fops->fallocate = posix_io_uring_fallocate;
+            this->fops->discard = posix_io_uring_discard;
+        }
+        /* entries are opened in slots of the registered file table */
+        if (priv->io_uring_lookup && priv->uring_files)
+            this->fops->lookup = posix_io_uring_lookup;
+        if (priv->io_uring_unlink) {
+            this->fops->unlink = posix_io_uring_unlink;
+            this->fops->rmdir = posix_io_uring_rmdir;
+        }
         ret = 0;
     }
 
@@ -611,9 +2080,19 @@ posix_io_uring_off(xlator_t *this)
     this->fops->readv = posix_readv;
     this->fops->writev = posix_writev;
     this->fops->fsync = posix_fsync;
+    this->fops->fstat = posix_fstat;
+    this->fops->fallocate = posix_glfallocate;
+    this->fops->discard = posix_discard;
+    this->fops->lookup = posix_lookup;
+    this->fops->unlink = posix_unlink;
+    this->fops->rmdir = posix_rmdir;
     if (priv->io_uring_capable)
         posix_io_uring_fini(this);
 
+    /* turning it on again sets the rings up with the current options */
+    priv->io_uring_capable = _gf_false;
+    priv->io_uring_init_done = _gf_false;
+
     return 0;
 }
 
@@ -633,4 +2112,14 @@ posix_io_uring_off(xlator_t *this)
     return 0;
 }
 
+void
+posix_io_uring_fd_register(xlator_t *this, struct posix_fd *pfd)
+{
+}
+
+void
+posix_io_uring_fd_unregister(xlator_t *this, struct posix_fd *pfd)
+{
+}
+
 #endif
@@ -10,13 +10,22 @@
 #ifndef _POSIX_IO_URING_H
 #define _POSIX_IO_URING_H
 
+struct posix_fd;
+
 #define POSIX_URING_MAX_ENTRIES 512
+#define POSIX_URING_MAX_RINGS 16
 int
 posix_io_uring_on(xlator_t *this);
 
 int
 posix_io_uring_off(xlator_t *this);
 
+void
+posix_io_uring_fd_register(xlator_t *this, struct posix_fd *pfd);
+
+void
+posix_io_uring_fd_unregister(xlator_t *this, struct posix_fd *pfd);
+
 #ifdef HAVE_LIBURING
 int
 posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
@@ -0,0 +1,815 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <glusterfs/xlator.h>
+#include <glusterfs/syscall.h>
+#include <glusterfs/checksum.h>
+#include <glusterfs/statedump.h>
+#include "posix.h"
+#include "posix-mdstore.h"
+#include "posix-messages.h"
+#include "posix-mem-types.h"
+
+/* A live record of the log. Values are read back from the log, which
+ * keeps the index at a few dozen bytes per key. */
+struct posix_mds_entry {
+    struct list_head hash;
+    uuid_t gfid;
+    off_t off;    /* of the record in the log */
+    uint32_t len; /* of the whole record */
+    uint16_t klen;
+    uint16_t vlen;
+    char key[];
+};
+
+#define POSIX_MDS_REC_MAX (sizeof(struct posix_mds_rec) + 2 * UINT16_MAX)
+/* most a key and its value take in a record appended by posix_mds_set() */
+#define POSIX_MDS_VAL_MAX 512
+
+static struct posix_mdstore *
+posix_mds_get_store(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+
+    return priv->mdstore;
+}
+
+static uint32_t
+posix_mds_hash(uuid_t gfid)
+{
+    /* the tail of a gfid is random enough to pick a bucket */
+    return ((gfid[14] << 8) | gfid[15]) % POSIX_MDS_HASH_SIZE;
+}
+
+static struct posix_mds_entry *
+__posix_mds_find(struct posix_mdstore *mds, uuid_t gfid, const char *key,
+                 uint16_t klen)
+{
+    struct posix_mds_entry *entry = NULL;
+
+    list_for_each_entry(entry, &mds->hash[posix_mds_hash(gfid)], hash)
+    {
+        if (entry->klen == klen && gf_uuid_compare(entry->gfid, gfid) == 0 &&
+            memcmp(entry->key, key, klen) == 0)
+            return entry;
+    }
+
+    return NULL;
+}
+
+static void
+__posix_mds_drop(struct posix_mdstore *mds, struct posix_mds_entry *entry)
+{
+    list_del(&entry->hash);
+    mds->live -= entry->len;
+    mds->count--;
+    GF_FREE(entry);
+}
+
+static int
+__posix_mds_index(struct posix_mdstore *mds, struct posix_mds_rec *rec,
+                  off_t off)
+{
+    struct posix_mds_entry *entry = NULL;
+    struct posix_mds_entry *tmp = NULL;
+    const char *key = (const char *)(rec + 1);
+    uint16_t klen = be16toh(rec->klen);
+    uint16_t vlen = be16toh(rec->vlen);
+
+    if (!klen) {
+        list_for_each_entry_safe(entry, tmp,
+                                 &mds->hash[posix_mds_hash(rec->gfid)], hash)
+        {
+            if (gf_uuid_compare(entry->gfid, rec->gfid) == 0)
+                __posix_mds_drop(mds, entry);
+        }
+        return 0;
+    }
+
+    entry = __posix_mds_find(mds, rec->gfid, key, klen);
+    if (entry)
+        __posix_mds_drop(mds, entry);
+
+    entry = GF_MALLOC(sizeof(*entry) + klen, gf_posix_mt_mdstore_t);
+    if (!entry)
+        return -1;
+
+    gf_uuid_copy(entry->gfid, rec->gfid);
+    entry->off = off;
+    entry->len = sizeof(*rec) + klen + vlen;
+    entry->klen = klen;
+    entry->vlen = vlen;
+    memcpy(entry->key, key, klen);
+    list_add(&entry->hash, &mds->hash[posix_mds_hash(rec->gfid)]);
+    mds->live += entry->len;
+    mds->count++;
+
+    return 0;
+}
+
+static size_t
+posix_mds_rec_build(char *buf, uuid_t gfid, const char *key, uint16_t klen,
+                    const void *value, uint16_t vlen)
+{
+    struct posix_mds_rec *rec = (struct posix_mds_rec *)buf;
+    size_t len = sizeof(*rec) + klen + vlen;
+
+    rec->magic = htobe32(POSIX_MDS_REC_MAGIC);
+    rec->checksum = 0;
+    gf_uuid_copy(rec->gfid, gfid);
+    rec->klen = htobe16(klen);
+    rec->vlen = htobe16(vlen);
+    if (klen)
+        memcpy(buf + sizeof(*rec), key, klen);
+    if (vlen)
+        memcpy(buf + sizeof(*rec) + klen, value, vlen);
+    rec->checksum = htobe32(gf_rsync_weak_checksum((unsigned char *)buf, len));
+
+    return len;
+}
+
+static gf_boolean_t
+posix_mds_rec_valid(char *buf, size_t len)
+{
+    struct posix_mds_rec *rec = (struct posix_mds_rec *)buf;
+    uint32_t checksum = be32toh(rec->checksum);
+    gf_boolean_t valid = _gf_false;
+
+    rec->checksum = 0;
+    valid = (gf_rsync_weak_checksum((unsigned char *)buf, len) == checksum);
+    rec->checksum = htobe32(checksum);
+
+    return valid;
+}
+
+static int
+__posix_mds_append(xlator_t *this, struct posix_mdstore *mds, char *buf,
+                   size_t len)
+{
+    ssize_t ret = 0;
+
+    ret = sys_pwrite(mds->fd, buf, len, mds->size);
+    if (ret != (ssize_t)len) {
+        gf_msg(this->name, GF_LOG_ERROR, ret < 0 ? errno : ENOSPC,
+               P_MSG_MDSTORE, "append to %s failed", mds->path);
+        /* a torn record would stop the replay there, cut it now */
+        (void)sys_ftruncate(mds->fd, mds->size);
+        if (ret >= 0)
+            errno = ENOSPC;
+        return -1;
+    }
+
+    if (__posix_mds_index(mds, (struct posix_mds_rec *)buf, mds->size)) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    mds->size += len;
+    mds->dirty = _gf_true;
+    GF_ATOMIC_INC(mds->appends);
+
+    return 0;
+}
+
+/* Make the rename of a compacted log durable */
+static int
+posix_mds_sync_dir(struct posix_mdstore *mds)
+{
+    char *dir = NULL;
+    char *slash = NULL;
+    int fd = -1;
+    int ret = -1;
+
+    dir = gf_strdup(mds->path);
+    if (!dir)
+        return -1;
+
+    slash = strrchr(dir, '/');
+    if (slash)
+        *slash = '\0';
+
+    fd = sys_open(slash ? dir : ".", O_RDONLY | O_DIRECTORY, 0);
+    if (fd >= 0) {
+        ret = sys_fsync(fd);
+        sys_close(fd);
+    }
+
+    GF_FREE(dir);
+    return ret;
+}
+
+/* A live record of the log being compacted, and where it goes in the new
+ * one */
+struct posix_mds_move {
+    off_t from;
+    off_t to;
+    uint32_t len;
+};
+
+static int
+posix_mds_move_cmp(const void *a, const void *b)
+{
+    const struct posix_mds_move *x = a;
+    const struct posix_mds_move *y = b;
+
+    return (x->from > y->from) - (x->from < y->from);
+}
+
+/* Copy [@from, @end) of the log @fd to @newfd at @to */
+static int
+posix_mds_copy(int fd, int newfd, char *buf, off_t from, off_t end, off_t to)
+{
+    ssize_t len = 0;
+
+    while (from < end) {
+        len = min(end - from, (off_t)POSIX_MDS_REC_MAX);
+        if (sys_pread(fd, buf, len, from) != len ||
+            sys_pwrite(newfd, buf, len, to) != len)
+            return -1;
+        from += len;
+        to += len;
+    }
+
+    return 0;
+}
+
+/* Rewrite the live records into a new log which replaces the old one.
+ * The records live when it starts are copied without mds->lock, then
+ * those appended meanwhile, as they are. Only the last few appends are
+ * copied under the lock, before the new log is renamed in place and the
+ * index pointed to it. */
+static int
+posix_mds_compact(xlator_t *this, struct posix_mdstore *mds)
+{
+    struct posix_mds_entry *entry = NULL;
+    struct posix_mds_move *moves = NULL;
+    struct posix_mds_move *move = NULL;
+    struct posix_mds_move key = {
+        0,
+    };
+    char *newpath = NULL;
+    char *buf = NULL;
+    uint64_t nmoves = 0;
+    uint64_t j = 0;
+    off_t end = 0;    /* of the log when the live records were listed */
+    off_t copied = 0; /* of the log, appended records copied so far */
+    off_t tail = 0;   /* where those go in the new log */
+    off_t size = 0;
+    int oldfd = -1;
+    int newfd = -1;
+    int ret = -1;
+    int i = 0;
+    gf_boolean_t locked = _gf_false;
+
+    buf = GF_MALLOC(POSIX_MDS_REC_MAX, gf_posix_mt_mdstore_t);
+    if (!buf || gf_asprintf(&newpath, "%s.new", mds->path) < 0)
+        goto out;
+
+    newfd = sys_open(newpath, O_CREAT | O_TRUNC | O_RDWR, 0600);
+    if (newfd < 0)
+        goto out;
+
+    if (sys_write(newfd, POSIX_MDS_LOG_MAGIC, 8) != 8)
+        goto out;
+    size = 8;
+
+    pthread_mutex_lock(&mds->lock);
+    {
+        moves = GF_MALLOC((mds->count + 1) * sizeof(*moves),
+                          gf_posix_mt_mdstore_t);
+        if (moves) {
+            for (i = 0; i < POSIX_MDS_HASH_SIZE; i++) {
+                list_for_each_entry(entry, &mds->hash[i], hash)
+                {
+                    moves[nmoves].from = entry->off;
+                    moves[nmoves].len = entry->len;
+                    nmoves++;
+                }
+            }
+            end = mds->size;
+            oldfd = dup(mds->fd);
+        }
+    }
+    pthread_mutex_unlock(&mds->lock);
+
+    if (!moves || oldfd < 0)
+        goto out;
+
+    /* in the order of the log, which reads it sequentially */
+    qsort(moves, nmoves, sizeof(*moves), posix_mds_move_cmp);
+    for (j = 0; j < nmoves; j++) {
+        if (posix_mds_copy(oldfd, newfd, buf, moves[j].from,
+                           moves[j].from + moves[j].len, size))
+            goto out;
+        moves[j].to = size;
+        size += moves[j].len;
+    }
+
+    tail = size;
+    copied = end;
+    for (;;) {
+        pthread_mutex_lock(&mds->lock);
+        {
+            size = mds->size;
+        }
+        pthread_mutex_unlock(&mds->lock);
+
+        if (size - copied < POSIX_MDS_REC_MAX)
+            break;
+        if (posix_mds_copy(oldfd, newfd, buf, copied, size,
+                           tail + copied - end))
+            goto out;
+        copied = size;
+    }
+
+    if (sys_fdatasync(newfd))
+        goto out;
+
+    pthread_mutex_lock(&mds->lock);
+    locked = _gf_true;
+
+    if (posix_mds_copy(oldfd, newfd, buf, copied, mds->size,
+                       tail + copied - end))
+        goto out;
+    copied = mds->size;
+
+    if (sys_fdatasync(newfd) || sys_rename(newpath, mds->path))
+        goto out;
+
+    /* until the directory is synced a crash may bring the old log back,
+     * without what is appended to the new one: posix_mds_sync() tries
+     * again */
+    mds->renamed = _gf_true;
+
+    /* the index is only pointed to the new log once it is in place.
+     * Records older than @end were listed above, the others were copied
+     * as they are. */
+    for (i = 0; i < POSIX_MDS_HASH_SIZE; i++) {
+        list_for_each_entry(entry, &mds->hash[i], hash)
+        {
+            if (entry->off >= end) {
+                entry->off = tail + entry->off - end;
+                continue;
+            }
+            key.from = entry->off;
+            move = bsearch(&key, moves, nmoves, sizeof(*moves),
+                           posix_mds_move_cmp);
+            GF_ASSERT(move);
+            entry->off = move->to;
+        }
+    }
+
+    sys_close(mds->fd);
+    mds->fd = newfd;
+    newfd = -1;
+    mds->size = tail + copied - end;
+    GF_ATOMIC_INC(mds->compactions);
+    ret = 0;
+out:
+    if (ret) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_MDSTORE,
+               "compaction of %s failed", mds->path);
+        if (!locked) {
+            pthread_mutex_lock(&mds->lock);
+            locked = _gf_true;
+        }
+        /* don't try again before the log grew some more */
+        mds->compact_at = mds->size + POSIX_MDS_COMPACT_MIN;
+    }
+    if (locked)
+        pthread_mutex_unlock(&mds->lock);
+
+    if (ret == 0 && posix_mds_sync_dir(mds) == 0) {
+        pthread_mutex_lock(&mds->lock);
+        {
+            mds->renamed = _gf_false;
+        }
+        pthread_mutex_unlock(&mds->lock);
+    } else if (ret == 0) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_MDSTORE,
+               "sync of the directory of %s failed", mds->path);
+    }
+
+    if (oldfd >= 0)
+        sys_close(oldfd);
+    if (newfd >= 0) {
+        sys_close(newfd);
+        sys_unlink(newpath);
+    }
+    GF_FREE(newpath);
+    GF_FREE(moves);
+    GF_FREE(buf);
+    return ret;
+}
+
+static void *
+posix_mds_compactor(void *data)
+{
+    xlator_t *this = data;
+    struct posix_mdstore *mds = posix_mds_get_store(this);
+
+    (void)posix_mds_compact(this, mds);
+
+    pthread_mutex_lock(&mds->lock);
+    {
+        mds->compacting = _gf_false;
+        pthread_cond_broadcast(&mds->cond);
+    }
+    pthread_mutex_unlock(&mds->lock);
+
+    return NULL;
+}
+
+static int
+posix_mds_replay(xlator_t *this, struct posix_mdstore *mds)
+{
+    struct posix_mds_rec *rec = NULL;
+    struct stat st;
+    char *buf = NULL;
+    char magic[8];
+    size_t len = 0;
+    off_t off = 8;
+    int ret = -1;
+
+    if (sys_fstat(mds->fd, &st))
+        return -1;
+
+    if (st.st_size == 0) {
+        if (sys_write(mds->fd, POSIX_MDS_LOG_MAGIC, 8) != 8)
+            return -1;
+        mds->size = 8;
+        return 0;
+    }
+
+    if (sys_pread(mds->fd, magic, 8, 0) != 8 ||
+        memcmp(magic, POSIX_MDS_LOG_MAGIC, 8) != 0) {
+        gf_msg(this->name, GF_LOG_ERROR, EINVAL, P_MSG_MDSTORE,
+               "%s is not a metadata store log", mds->path);
+        errno = EINVAL;
+        return -1;
+    }
+
+    buf = GF_MALLOC(POSIX_MDS_REC_MAX, gf_posix_mt_mdstore_t);
+    if (!buf)
+        return -1;
+    rec = (struct posix_mds_rec *)buf;
+
+    while (off < st.st_size) {
+        if (sys_pread(mds->fd, buf, sizeof(*rec), off) != sizeof(*rec) ||
+            be32toh(rec->magic) != POSIX_MDS_REC_MAGIC)
+            break;
+
+        len = sizeof(*rec) + be16toh(rec->klen) + be16toh(rec->vlen);
+        if (sys_pread(mds->fd, buf + sizeof(*rec), len - sizeof(*rec),
+                      off + sizeof(*rec)) != len - sizeof(*rec) ||
+            !posix_mds_rec_valid(buf, len))
+            break;
+
+        if (__posix_mds_index(mds, rec, off))
+            goto out;
+        off += len;
+    }
+
+    if (off < st.st_size) {
+        /* the tail was being written when the brick went down */
+        gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_MDSTORE,
+               "dropping %" PRId64 " bytes of incomplete records at the end "
+               "of %s",
+               (int64_t)(st.st_size - off), mds->path);
+        if (sys_ftruncate(mds->fd, off))
+            goto out;
+    }
+
+    mds->size = off;
+    ret = 0;
+out:
+    GF_FREE(buf);
+    return ret;
+}
+
+int
+posix_mds_init(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_mdstore *mds = NULL;
+    int i = 0;
+
+    mds = GF_CALLOC(1, sizeof(*mds), gf_posix_mt_mdstore_t);
+    if (!mds)
+        return -1;
+
+    mds->fd = -1;
+    pthread_mutex_init(&mds->lock, NULL);
+    pthread_cond_init(&mds->cond, NULL);
+    GF_ATOMIC_INIT(mds->hits, 0);
+    GF_ATOMIC_INIT(mds->misses, 0);
+    GF_ATOMIC_INIT(mds->appends, 0);
+    GF_ATOMIC_INIT(mds->migrated, 0);
+    GF_ATOMIC_INIT(mds->compactions, 0);
+
+    mds->hash = GF_CALLOC(POSIX_MDS_HASH_SIZE, sizeof(*mds->hash),
+                          gf_posix_mt_mdstore_t);
+    if (!mds->hash)
+        goto err;
+    for (i = 0; i < POSIX_MDS_HASH_SIZE; i++)
+        INIT_LIST_HEAD(&mds->hash[i]);
+
+    if (gf_asprintf(&mds->path, "%s/%s/%s", priv->base_path,
+                    GF_HIDDEN_PATH, POSIX_MDS_LOG) < 0)
+        goto err;
+
+    mds->fd = sys_open(mds->path, O_CREAT | O_RDWR, 0600);
+    if (mds->fd < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_MDSTORE,
+               "cannot open %s", mds->path);
+        goto err;
+    }
+
+    priv->mdstore = mds;
+    if (posix_mds_replay(this, mds)) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_MDSTORE,
+               "cannot load %s", mds->path);
+        posix_mds_fini(this);
+        return -1;
+    }
+
+    gf_msg(this->name, GF_LOG_INFO, 0, P_MSG_MDSTORE,
+           "metadata store %s: %" PRIu64 " keys, %" PRId64 " bytes", mds->path,
+           mds->count, (int64_t)mds->size);
+
+    return 0;
+err:
+    priv->mdstore = mds;
+    posix_mds_fini(this);
+    return -1;
+}
+
+void
+posix_mds_fini(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_mdstore *mds = priv->mdstore;
+    struct posix_mds_entry *entry = NULL;
+    struct posix_mds_entry *tmp = NULL;
+    int i = 0;
+
+    if (!mds)
+        return;
+
+    /* the compactor finds the store through priv */
+    pthread_mutex_lock(&mds->lock);
+    {
+        while (mds->compacting)
+            pthread_cond_wait(&mds->cond, &mds->lock);
+    }
+    pthread_mutex_unlock(&mds->lock);
+
+    priv->mdstore = NULL;
+
+    if (mds->fd >= 0) {
+        (void)sys_fdatasync(mds->fd);
+        sys_close(mds->fd);
+    }
+
+    if (mds->hash) {
+        for (i = 0; i < POSIX_MDS_HASH_SIZE; i++) {
+            list_for_each_entry_safe(entry, tmp, &mds->hash[i], hash)
+            {
+                list_del(&entry->hash);
+                GF_FREE(entry);
+            }
+        }
+        GF_FREE(mds->hash);
+    }
+
+    pthread_cond_destroy(&mds->cond);
+    pthread_mutex_destroy(&mds->lock);
+    GF_FREE(mds->path);
+    GF_FREE(mds);
+}
+
+/* The gfid the value of @inode, @path or @fd is kept under. Inodes being
+ * created are not linked yet, their gfid is read from the file. */
+int
+posix_mds_resolve_gfid(xlator_t *this, const char *path, int fd,
+                       inode_t *inode, uuid_t gfid)
+{
+    ssize_t size = -1;
+
+    if (inode && !gf_uuid_is_null(inode->gfid)) {
+        gf_uuid_copy(gfid, inode->gfid);
+        return 0;
+    }
+
+    if (fd >= 0)
+        size = sys_fgetxattr(fd, GFID_XATTR_KEY, gfid, sizeof(uuid_t));
+    else if (path)
+        size = sys_lgetxattr(path, GFID_XATTR_KEY, gfid, sizeof(uuid_t));
+
+    if (size != sizeof(uuid_t)) {
+        if (size >= 0)
+            errno = EINVAL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Returns the length of the value, or -1 with errno ENODATA when @key is
+ * not set */
+ssize_t
+posix_mds_get(xlator_t *this, uuid_t gfid, const char *key, void *value,
+              size_t size)
+{
+    struct posix_mdstore *mds = posix_mds_get_store(this);
+    struct posix_mds_entry *entry = NULL;
+    size_t klen = strlen(key);
+    ssize_t ret = -1;
+    off_t off = 0;
+
+    pthread_mutex_lock(&mds->lock);
+    {
+        entry = __posix_mds_find(mds, gfid, key, klen);
+        if (!entry) {
+            errno = ENODATA;
+            goto unlock;
+        }
+
+        if (entry->vlen > size) {
+            errno = ERANGE;
+            goto unlock;
+        }
+
+        off = entry->off + sizeof(struct posix_mds_rec) + klen;
+        ret = sys_pread(mds->fd, value, entry->vlen, off);
+        if (ret >= 0 && ret != entry->vlen) {
+            errno = EIO;
+            ret = -1;
+        }
+    }
+unlock:
+    pthread_mutex_unlock(&mds->lock);
+
+    if (ret < 0 && errno == ENODATA)
+        GF_ATOMIC_INC(mds->misses);
+    else if (ret >= 0)
+        GF_ATOMIC_INC(mds->hits);
+
+    return ret;
+}
+
+/* Put @key of @gfid in @dict as getxattr would. Returns the length of the
+ * value, or -1 with errno ENODATA when @key is not set */
+ssize_t
+posix_mds_dict_set(xlator_t *this, uuid_t gfid, const char *key, dict_t *dict)
+{
+    char buf[POSIX_MDS_VAL_MAX];
+    char *value = NULL;
+    ssize_t size = -1;
+
+    size = posix_mds_get(this, gfid, key, buf, sizeof(buf));
+    if (size < 0)
+        return -1;
+
+    value = gf_memdup(buf, size);
+    if (!value || dict_set_dynptr(dict, (char *)key, value, size)) {
+        GF_FREE(value);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    return size;
+}
+
+int
+posix_mds_set(xlator_t *this, uuid_t gfid, const char *key, const void *value,
+              size_t size)
+{
+    struct posix_mdstore *mds = posix_mds_get_store(this);
+    char buf[sizeof(struct posix_mds_rec) + POSIX_MDS_VAL_MAX];
+    pthread_t thread;
+    size_t klen = strlen(key);
+    size_t len = 0;
+    int ret = -1;
+
+    if (gf_uuid_is_null(gfid) || !klen || klen + size > POSIX_MDS_VAL_MAX) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    len = posix_mds_rec_build(buf, gfid, key, klen, value, size);
+
+    pthread_mutex_lock(&mds->lock);
+    {
+        ret = __posix_mds_append(this, mds, buf, len);
+        if (!ret && !mds->compacting && mds->size > POSIX_MDS_COMPACT_MIN &&
+            mds->size > mds->compact_at && mds->size > 2 * mds->live) {
+            /* compacted in the background, appends go on meanwhile */
+            mds->compacting = _gf_true;
+            if (gf_thread_create_detached(&thread, posix_mds_compactor, this,
+                                          "posixmds"))
+                mds->compacting = _gf_false;
+        }
+    }
+    pthread_mutex_unlock(&mds->lock);
+
+    return ret;
+}
+
+/* Drop every key of @gfid, whose file is gone */
+void
+posix_mds_forget(xlator_t *this, uuid_t gfid)
+{
+    struct posix_mdstore *mds = posix_mds_get_store(this);
+    struct posix_mds_entry *entry = NULL;
+    char buf[sizeof(struct posix_mds_rec)];
+    gf_boolean_t found = _gf_false;
+    size_t len = 0;
+
+    if (!mds)
+        return;
+
+    len = posix_mds_rec_build(buf, gfid, NULL, 0, NULL, 0);
+
+    pthread_mutex_lock(&mds->lock);
+    {
+        list_for_each_entry(entry, &mds->hash[posix_mds_hash(gfid)], hash)
+        {
+            if (gf_uuid_compare(entry->gfid, gfid) == 0) {
+                found = _gf_true;
+                break;
+            }
+        }
+        if (found)
+            (void)__posix_mds_append(this, mds, buf, len);
+    }
+    pthread_mutex_unlock(&mds->lock);
+}
+
+/* Make the records appended so far durable, along with the data of a file
+ * being fsynced */
+int
+posix_mds_sync(xlator_t *this)
+{
+    struct posix_mdstore *mds = posix_mds_get_store(this);
+    int fd = -1;
+    int ret = 0;
+
+    if (!mds)
+        return 0;
+
+    pthread_mutex_lock(&mds->lock);
+    {
+        if (mds->renamed) {
+            ret = posix_mds_sync_dir(mds);
+            if (ret == 0)
+                mds->renamed = _gf_false;
+        }
+        if (ret == 0 && mds->dirty) {
+            /* a compaction may replace the log meanwhile, its new one is
+             * synced before it is renamed in place */
+            fd = dup(mds->fd);
+            mds->dirty = _gf_false;
+        }
+    }
+    pthread_mutex_unlock(&mds->lock);
+
+    if (fd >= 0) {
+        ret = sys_fdatasync(fd);
+        sys_close(fd);
+    }
+
+    return ret;
+}
+
+void
+posix_mds_dump(xlator_t *this)
+{
+    struct posix_mdstore *mds = posix_mds_get_store(this);
+
+    if (!mds)
+        return;
+
+    gf_proc_dump_write("metadata_store_keys", "%" PRIu64, mds->count);
+    gf_proc_dump_write("metadata_store_log_size", "%" PRId64,
+                       (int64_t)mds->size);
+    gf_proc_dump_write("metadata_store_live_bytes", "%" PRId64,
+                       (int64_t)mds->live);
+    gf_proc_dump_write("metadata_store_hits", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(mds->hits));
+    gf_proc_dump_write("metadata_store_misses", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(mds->misses));
+    gf_proc_dump_write("metadata_store_appends", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(mds->appends));
+    gf_proc_dump_write("metadata_store_migrated", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(mds->migrated));
+    gf_proc_dump_write("metadata_store_compactions", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(mds->compactions));
+}
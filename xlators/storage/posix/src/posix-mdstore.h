@@ -0,0 +1,95 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _POSIX_MDSTORE_H
+#define _POSIX_MDSTORE_H
+
+#include <glusterfs/xlator.h>
+
+/* Brick local store of internal xattrs: an append-only log in .glusterfs
+ * with an in-memory index of the live records, rebuilt when the brick
+ * starts. The on-disk format is shared with extras/mdstore-migrate.py.
+ *
+ * log:    "GFMDS001" followed by records
+ * record: magic (4) checksum (4) gfid (16) key length (2) value length (2)
+ *         key value
+ * Integers are big endian. The checksum is gf_rsync_weak_checksum() of the
+ * record with the checksum field zeroed. A record without key removes all
+ * the keys of its gfid.
+ *
+ * A key is kept either in the store or in the xattr of the file, never in
+ * both: the xattr of a file created before the store was enabled is
+ * removed once it is moved into the store, and getxattr, fgetxattr and
+ * their listings serve the key from the store. */
+#define POSIX_MDS_LOG "mdstore.log"
+#define POSIX_MDS_LOG_MAGIC "GFMDS001"
+#define POSIX_MDS_REC_MAGIC 0x4d445352 /* "MDSR" */
+#define POSIX_MDS_HASH_SIZE 65536
+/* logs larger than this are compacted once less than half of it is live */
+#define POSIX_MDS_COMPACT_MIN (16 * 1048576)
+
+struct posix_mds_rec {
+    uint32_t magic;
+    uint32_t checksum;
+    unsigned char gfid[16];
+    uint16_t klen;
+    uint16_t vlen;
+} __attribute__((packed));
+
+struct posix_mdstore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond; /* for the end of a compaction */
+    int fd;
+    char *path;
+    off_t size; /* end of the log */
+    off_t live; /* bytes of the records in the index */
+    struct list_head *hash;
+    uint64_t count;
+    gf_boolean_t dirty;   /* appended to since the last posix_mds_sync() */
+    gf_boolean_t renamed; /* compacted, the directory is not synced yet */
+    gf_boolean_t compacting;
+    off_t compact_at; /* retry after a failed compaction above this size */
+    gf_atomic_t hits;
+    gf_atomic_t misses;
+    gf_atomic_t appends;
+    gf_atomic_t migrated;
+    gf_atomic_t compactions;
+};
+
+int
+posix_mds_init(xlator_t *this);
+
+void
+posix_mds_fini(xlator_t *this);
+
+int
+posix_mds_resolve_gfid(xlator_t *this, const char *path, int fd,
+                       inode_t *inode, uuid_t gfid);
+
+ssize_t
+posix_mds_get(xlator_t *this, uuid_t gfid, const char *key, void *value,
+              size_t size);
+
+ssize_t
+posix_mds_dict_set(xlator_t *this, uuid_t gfid, const char *key, dict_t *dict);
+
+int
+posix_mds_set(xlator_t *this, uuid_t gfid, const char *key, const void *value,
+              size_t size);
+
+void
+posix_mds_forget(xlator_t *this, uuid_t gfid);
+
+int
+posix_mds_sync(xlator_t *this);
+
+void
+posix_mds_dump(xlator_t *this);
+
+#endif /* _POSIX_MDSTORE_H */
@@ -22,6 +22,10 @@ enum gf_posix_mem_types_ {
     gf_posix_mt_mdata_attr,
     gf_posix_mt_uring_ctx,
     gf_posix_mt_diskxl_t,
+    gf_posix_mt_dirfd_t,
+    gf_posix_mt_uring_t,
+    gf_posix_mt_mdstore_t,
+    gf_posix_mt_reclaim_t,
     gf_posix_mt_end
 };
 #endif
@@ -13,6 +13,7 @@
 #include "posix-metadata-disk.h"
 #include "posix-handle.h"
 #include "posix-messages.h"
+#include "posix-mdstore.h"
 #include <glusterfs/syscall.h>
 #include <glusterfs/compat-errno.h>
 #include <glusterfs/compat.h>
@@ -69,22 +70,66 @@ posix_mdata_iatt_from_disk(struct mdata_iatt *out, posix_mdata_disk_t *in)
     out->ia_atime_nsec = be64toh(in->atime.tv_nsec);
 }
 
+/* posix_fetch_mdata_store fetches the posix_mdata_t from the metadata
+ * store. Returns 1 when the store has no record of the file, for the
+ * caller to look for the xattr of a file not migrated yet.
+ */
+static int
+posix_fetch_mdata_store(xlator_t *this, const char *real_path, int _fd,
+                        inode_t *inode, posix_mdata_t *metadata, uuid_t gfid,
+                        int *op_errno)
+{
+    posix_mdata_disk_t disk_metadata;
+    ssize_t size = -1;
+
+    if (posix_mds_resolve_gfid(this, real_path, _fd, inode, gfid)) {
+        *op_errno = errno;
+        return -1;
+    }
+
+    size = posix_mds_get(this, gfid, GF_XATTR_MDATA_KEY, &disk_metadata,
+                         sizeof(disk_metadata));
+    if (size == -1 && errno == ENODATA)
+        return 1;
+
+    if (size != sizeof(disk_metadata)) {
+        *op_errno = (size == -1) ? errno : EINVAL;
+        gf_msg(this->name, GF_LOG_ERROR, *op_errno, P_MSG_FETCHMDATA_FAILED,
+               "fetching %s of gfid %s from the metadata store failed",
+               GF_XATTR_MDATA_KEY, uuid_utoa(gfid));
+        return -1;
+    }
+
+    posix_mdata_from_disk(metadata, &disk_metadata);
+    return 0;
+}
+
 /* posix_fetch_mdata_xattr fetches the posix_mdata_t from disk */
 static int
 posix_fetch_mdata_xattr(xlator_t *this, const char *real_path_arg, int _fd,
                         inode_t *inode, posix_mdata_t *metadata, int *op_errno)
 {
+    struct posix_private *priv = this->private;
     size_t size = 256;
     int op_ret = -1;
     char *value = NULL;
     gf_boolean_t fd_based_fop = _gf_false;
     char gfid_str[64] = {0};
     char *real_path = NULL;
+    uuid_t gfid = {0};
 
     if (!metadata) {
         goto out;
     }
 
+    if (priv->mdstore) {
+        op_ret = posix_fetch_mdata_store(this, real_path_arg, _fd, inode,
+                                         metadata, gfid, op_errno);
+        if (op_ret <= 0)
+            goto out;
+        op_ret = -1;
+    }
+
     if (_fd != -1) {
         fd_based_fop = _gf_true;
     }
@@ -180,6 +225,22 @@ posix_fetch_mdata_xattr(xlator_t *this, const char *real_path_arg, int _fd,
     }
     posix_mdata_from_disk(metadata, (posix_mdata_disk_t *)value);
 
+    /* move the xattr of a file created before the store was enabled. The
+     * xattr is only removed once the record would survive a crash, the
+     * store is the one place the times are read from after that. */
+    if (priv->mdstore && size == sizeof(posix_mdata_disk_t) &&
+        posix_mds_set(this, gfid, GF_XATTR_MDATA_KEY, value, size) == 0) {
+        GF_ATOMIC_INC(priv->mdstore->migrated);
+        if (posix_mds_sync(this) == 0) {
+            if (fd_based_fop)
+                (void)sys_fremovexattr(_fd, GF_XATTR_MDATA_KEY);
+            else if (real_path_arg)
+                (void)sys_lremovexattr(real_path_arg, GF_XATTR_MDATA_KEY);
+            else if (real_path)
+                (void)sys_lremovexattr(real_path, GF_XATTR_MDATA_KEY);
+        }
+    }
+
     op_ret = 0;
 out:
     if (value)
@@ -192,18 +253,29 @@ static int
 posix_store_mdata_xattr(xlator_t *this, const char *real_path_arg, int fd,
                         inode_t *inode, posix_mdata_t *metadata)
 {
+    struct posix_private *priv = this->private;
     char *real_path = NULL;
     int op_ret = 0;
     gf_boolean_t fd_based_fop = _gf_false;
     char *key = GF_XATTR_MDATA_KEY;
     char gfid_str[64] = {0};
     posix_mdata_disk_t disk_metadata;
+    uuid_t gfid = {0};
 
     if (!metadata) {
         op_ret = -1;
         goto out;
     }
 
+    if (priv->mdstore) {
+        posix_mdata_to_disk(&disk_metadata, metadata);
+        op_ret = posix_mds_resolve_gfid(this, real_path_arg, fd, inode, gfid);
+        if (!op_ret)
+            op_ret = posix_mds_set(this, gfid, key, &disk_metadata,
+                                   sizeof(disk_metadata));
+        goto out;
+    }
+
     if (fd != -1) {
         fd_based_fop = _gf_true;
     }
@@ -0,0 +1,531 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+
+#include <glusterfs/xlator.h>
+#include <glusterfs/syscall.h>
+#include <glusterfs/statedump.h>
+#include <glusterfs/timespec.h>
+#include "posix.h"
+#include "posix-handle.h"
+#include "posix-reclaim.h"
+#include "posix-mdstore.h"
+#include "posix-messages.h"
+#include "posix-mem-types.h"
+
+struct posix_reclaim_entry {
+    struct list_head list;
+    uint64_t bytes; /* allocated when last looked at */
+    char name[];
+};
+
+static struct posix_reclaim_entry *
+posix_reclaim_entry_new(const char *name, uint64_t bytes)
+{
+    struct posix_reclaim_entry *entry = NULL;
+    size_t len = strlen(name) + 1;
+
+    entry = GF_MALLOC(sizeof(*entry) + len, gf_posix_mt_reclaim_t);
+    if (!entry)
+        return NULL;
+
+    INIT_LIST_HEAD(&entry->list);
+    entry->bytes = bytes;
+    memcpy(entry->name, name, len);
+
+    return entry;
+}
+
+static void
+__posix_reclaim_queue(struct posix_reclaim *rcl,
+                      struct posix_reclaim_entry *entry)
+{
+    list_add_tail(&entry->list, &rcl->queue);
+    rcl->backlog_files++;
+    rcl->backlog_bytes += entry->bytes;
+    GF_ATOMIC_INC(rcl->queued);
+    pthread_cond_signal(&rcl->cond);
+}
+
+/* Takes what was freed since the last call out of the backlog. */
+static void
+posix_reclaim_account(struct posix_reclaim *rcl,
+                      struct posix_reclaim_entry *entry, uint64_t bytes)
+{
+    pthread_mutex_lock(&rcl->lock);
+    {
+        if (bytes < entry->bytes) {
+            GF_ATOMIC_ADD(rcl->bytes_done, entry->bytes - bytes);
+            rcl->backlog_bytes -= entry->bytes - bytes;
+            entry->bytes = bytes;
+        }
+    }
+    pthread_mutex_unlock(&rcl->lock);
+}
+
+/* Waits for @ns, less if the worker is stopped or its budget changes. */
+static void
+posix_reclaim_sleep(struct posix_reclaim *rcl, uint64_t ns)
+{
+    struct timespec deadline;
+
+    timespec_now_realtime(&deadline);
+    deadline.tv_sec += (deadline.tv_nsec + ns) / GF_SEC_IN_NS;
+    deadline.tv_nsec = (deadline.tv_nsec + ns) % GF_SEC_IN_NS;
+
+    pthread_mutex_lock(&rcl->lock);
+    {
+        while (!rcl->stop && !rcl->kick &&
+               pthread_cond_timedwait(&rcl->cond, &rcl->lock, &deadline) !=
+                   ETIMEDOUT)
+            ;
+        rcl->kick = _gf_false;
+    }
+    pthread_mutex_unlock(&rcl->lock);
+}
+
+/* Frees up to @len bytes of the file, punching the first data extent from
+ * @off on, or cutting its tail where holes can't be punched. Returns the
+ * length freed, 0 once there is nothing left, -1 on errors. */
+static int64_t
+posix_reclaim_step(int fd, struct stat *st, off_t *off, uint64_t len)
+{
+    off_t size = 0;
+
+#if defined(HAVE_SEEK_HOLE) && defined(FALLOC_FL_PUNCH_HOLE)
+    off_t start = 0;
+    off_t end = 0;
+
+    if (*off >= 0) {
+        start = sys_lseek(fd, *off, SEEK_DATA);
+        if (start < 0 && errno == ENXIO)
+            return 0;
+        if (start >= 0)
+            end = sys_lseek(fd, start, SEEK_HOLE);
+        if (start >= 0 && end > start) {
+            if ((uint64_t)(end - start) > len)
+                end = start + len;
+            if (sys_fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                              start, end - start) == 0) {
+                *off = end;
+                return end - start;
+            }
+            if (errno != EOPNOTSUPP && errno != ENOSYS)
+                return -1;
+        }
+        /* truncate the rest of this file */
+        *off = -1;
+    }
+#endif
+
+    if (st->st_size == 0)
+        return 0;
+
+    size = ((uint64_t)st->st_size > len) ? st->st_size - len : 0;
+    if (sys_ftruncate(fd, size))
+        return -1;
+
+    return st->st_size - size;
+}
+
+/* Frees the extents of @entry within the budget and unlinks it. Returns 0
+ * when the file is gone, 1 when it only lost a name it shared with another
+ * one, -1 if the worker was stopped first. */
+static int
+posix_reclaim_file(xlator_t *this, struct posix_reclaim *rcl,
+                   struct posix_reclaim_entry *entry)
+{
+    struct posix_private *priv = this->private;
+    struct timespec start;
+    struct timespec now;
+    struct timespec spent;
+    struct stat st;
+    uint64_t rate = 0;
+    uint64_t step = 0;
+    uint64_t wait_ns = 0;
+    uint32_t iops = 0;
+    int64_t len = 0;
+    off_t off = 0;
+    int shared = 0;
+    int fd = -1;
+
+    fd = sys_openat(rcl->dirfd, entry->name, O_WRONLY, 0);
+    if (fd < 0) {
+        if (errno != ENOENT)
+            gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RECLAIM,
+                   "cannot open %s/%s, unlinking it", POSIX_RECLAIM_DIR,
+                   entry->name);
+        goto unlink;
+    }
+
+    for (;;) {
+        if (sys_fstat(fd, &st)) {
+            len = -1;
+            break;
+        }
+        /* a link made to the file before its last name went away, the
+         * data is still in use */
+        if (st.st_nlink > 1) {
+            shared = 1;
+            break;
+        }
+        posix_reclaim_account(rcl, entry, (uint64_t)st.st_blocks * 512);
+        if (rcl->stop) {
+            sys_close(fd);
+            return -1;
+        }
+
+        rate = priv->reclaim_rate;
+        iops = priv->reclaim_iops ? priv->reclaim_iops : 1;
+        step = rate ? max(rate / iops, (uint64_t)POSIX_RECLAIM_MIN_STEP)
+                    : POSIX_RECLAIM_DRAIN_STEP;
+
+        timespec_now(&start);
+        len = posix_reclaim_step(fd, &st, &off, step);
+        if (len <= 0)
+            break;
+        GF_ATOMIC_INC(rcl->steps);
+
+        if (rate) {
+            wait_ns = max(GF_SEC_IN_NS / iops,
+                          (uint64_t)len * GF_SEC_IN_NS / rate);
+            timespec_now(&now);
+            timespec_sub(&start, &now, &spent);
+            if (wait_ns > (uint64_t)TS(spent))
+                posix_reclaim_sleep(rcl, wait_ns - TS(spent));
+        }
+    }
+
+    if (len < 0)
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RECLAIM,
+               "freeing %s/%s failed, unlinking it", POSIX_RECLAIM_DIR,
+               entry->name);
+    sys_close(fd);
+
+unlink:
+    if (sys_unlinkat(rcl->dirfd, entry->name) && errno != ENOENT) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RECLAIM,
+               "unlink of %s/%s failed", POSIX_RECLAIM_DIR, entry->name);
+    }
+
+    return shared;
+}
+
+static void *
+posix_reclaim_worker(void *data)
+{
+    xlator_t *this = data;
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = priv->reclaim;
+    struct posix_reclaim_entry *entry = NULL;
+    int ret = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&rcl->lock);
+        {
+            while (!rcl->stop && list_empty(&rcl->queue))
+                pthread_cond_wait(&rcl->cond, &rcl->lock);
+            if (rcl->stop) {
+                pthread_mutex_unlock(&rcl->lock);
+                break;
+            }
+            entry = list_first_entry(&rcl->queue, struct posix_reclaim_entry,
+                                     list);
+            snprintf(rcl->current, sizeof(rcl->current), "%s", entry->name);
+        }
+        pthread_mutex_unlock(&rcl->lock);
+
+        ret = posix_reclaim_file(this, rcl, entry);
+        if (ret < 0)
+            break;
+
+        pthread_mutex_lock(&rcl->lock);
+        {
+            list_del(&entry->list);
+            rcl->backlog_files--;
+            rcl->backlog_bytes -= entry->bytes;
+            rcl->current[0] = '\0';
+        }
+        pthread_mutex_unlock(&rcl->lock);
+
+        /* what is left goes with the last link */
+        if (ret == 0) {
+            GF_ATOMIC_ADD(rcl->bytes_done, entry->bytes);
+            GF_ATOMIC_INC(rcl->files_done);
+        }
+        GF_FREE(entry);
+    }
+
+    return NULL;
+}
+
+/* Queues the files a previous run of the brick did not get to. */
+static int
+posix_reclaim_load(xlator_t *this, struct posix_reclaim *rcl, const char *path)
+{
+    struct posix_reclaim_entry *entry = NULL;
+    struct dirent *dirent = NULL;
+    struct dirent scratch[2] = {
+        {
+            0,
+        },
+    };
+    struct stat st;
+    DIR *dir = NULL;
+
+    dir = sys_opendir(path);
+    if (!dir)
+        return -1;
+
+    while ((dirent = sys_readdir(dir, scratch)) != NULL) {
+        if (dirent->d_name[0] == '.')
+            continue;
+        if (sys_fstatat(rcl->dirfd, dirent->d_name, &st, AT_SYMLINK_NOFOLLOW))
+            continue;
+
+        entry = posix_reclaim_entry_new(dirent->d_name,
+                                        (uint64_t)st.st_blocks * 512);
+        if (!entry)
+            break;
+        pthread_mutex_lock(&rcl->lock);
+        __posix_reclaim_queue(rcl, entry);
+        pthread_mutex_unlock(&rcl->lock);
+    }
+
+    sys_closedir(dir);
+
+    if (rcl->backlog_files)
+        gf_msg(this->name, GF_LOG_INFO, 0, P_MSG_RECLAIM,
+               "%" PRIu64 " files, %" PRIu64 " bytes left to reclaim in %s",
+               rcl->backlog_files, rcl->backlog_bytes, POSIX_RECLAIM_DIR);
+
+    return 0;
+}
+
+int
+posix_reclaim_init(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = NULL;
+    char path[PATH_MAX];
+    int ret = -1;
+
+    rcl = GF_CALLOC(1, sizeof(*rcl), gf_posix_mt_reclaim_t);
+    if (!rcl)
+        return -1;
+
+    pthread_mutex_init(&rcl->lock, NULL);
+    pthread_cond_init(&rcl->cond, NULL);
+    INIT_LIST_HEAD(&rcl->queue);
+    GF_ATOMIC_INIT(rcl->queued, 0);
+    GF_ATOMIC_INIT(rcl->files_done, 0);
+    GF_ATOMIC_INIT(rcl->bytes_done, 0);
+    GF_ATOMIC_INIT(rcl->steps, 0);
+    /* names of earlier runs were made from smaller clocks */
+    rcl->seq = (uint64_t)gf_time() << 20;
+    rcl->dirfd = -1;
+    priv->reclaim = rcl;
+
+    (void)snprintf(path, sizeof(path), "%s/%s", priv->base_path,
+                   POSIX_RECLAIM_DIR);
+    if (sys_mkdir(path, 0700) && errno != EEXIST) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_RECLAIM,
+               "Creating directory %s failed", path);
+        goto out;
+    }
+    rcl->dirfd = sys_open(path, O_RDONLY | O_DIRECTORY, 0);
+    if (rcl->dirfd < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_RECLAIM,
+               "cannot open %s", path);
+        goto out;
+    }
+
+    if (posix_reclaim_load(this, rcl, path)) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_RECLAIM,
+               "cannot read %s", path);
+        goto out;
+    }
+
+    ret = gf_thread_create(&rcl->thread, NULL, posix_reclaim_worker, this,
+                           "posixrcl");
+    if (ret) {
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_RECLAIM,
+               "reclaim thread creation failed");
+        rcl->thread = 0;
+        goto out;
+    }
+
+    ret = 0;
+out:
+    if (ret)
+        posix_reclaim_fini(this);
+    return ret;
+}
+
+void
+posix_reclaim_fini(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = priv->reclaim;
+    struct posix_reclaim_entry *entry = NULL;
+    struct posix_reclaim_entry *tmp = NULL;
+
+    if (!rcl)
+        return;
+
+    if (rcl->thread) {
+        pthread_mutex_lock(&rcl->lock);
+        {
+            rcl->stop = _gf_true;
+            pthread_cond_broadcast(&rcl->cond);
+        }
+        pthread_mutex_unlock(&rcl->lock);
+        pthread_join(rcl->thread, NULL);
+    }
+    priv->reclaim = NULL;
+
+    /* the files stay in the directory for the next start */
+    list_for_each_entry_safe(entry, tmp, &rcl->queue, list)
+    {
+        list_del(&entry->list);
+        GF_FREE(entry);
+    }
+
+    if (rcl->dirfd >= 0)
+        sys_close(rcl->dirfd);
+    pthread_mutex_destroy(&rcl->lock);
+    pthread_cond_destroy(&rcl->cond);
+    GF_FREE(rcl);
+}
+
+/* Whether the file is worth freeing in the background once its last name
+ * is gone. */
+gf_boolean_t
+posix_reclaim_wanted(xlator_t *this, struct iatt *stbuf)
+{
+    struct posix_private *priv = this->private;
+
+    return priv->reclaim && priv->reclaim_rate && IA_ISREG(stbuf->ia_type) &&
+           stbuf->ia_blocks * 512 >= priv->reclaim_min_size;
+}
+
+/* Moves the handle of a file about to lose its last name to the reclaim
+ * directory, so that the unlink of the name does not free its extents.
+ * Returns -1 if the file is to be unlinked in place. The worker only gets
+ * *entryp from posix_reclaim_queue(), once the name is unlinked: before
+ * that it would find the file still shared and leave its extents alone. */
+int
+posix_reclaim_handle(xlator_t *this, uuid_t gfid, struct iatt *stbuf,
+                     struct posix_reclaim_entry **entryp)
+{
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = priv->reclaim;
+    struct posix_reclaim_entry *entry = NULL;
+    char *handle = NULL;
+    char name[64];
+    char path[PATH_MAX];
+    uint64_t seq = 0;
+
+    if (!posix_reclaim_wanted(this, stbuf))
+        return -1;
+
+    MAKE_HANDLE_GFID_PATH(handle, this, gfid);
+    if (!handle)
+        return -1;
+
+    pthread_mutex_lock(&rcl->lock);
+    seq = ++rcl->seq;
+    pthread_mutex_unlock(&rcl->lock);
+
+    (void)snprintf(name, sizeof(name), "%s.%" PRIx64, uuid_utoa(gfid), seq);
+    (void)snprintf(path, sizeof(path), "%s/%s/%s", priv->base_path,
+                   POSIX_RECLAIM_DIR, name);
+
+    entry = posix_reclaim_entry_new(name, stbuf->ia_blocks * 512);
+    if (!entry)
+        return -1;
+
+    posix_dirfd_forget(this, gfid);
+    posix_mds_forget(this, gfid);
+
+    if (sys_rename(handle, path)) {
+        gf_msg(this->name, GF_LOG_WARNING, errno, P_MSG_RECLAIM,
+               "cannot move %s to %s", handle, path);
+        GF_FREE(entry);
+        return -1;
+    }
+
+    *entryp = entry;
+    return 0;
+}
+
+/* Hands a file moved by posix_reclaim_handle() to the worker */
+void
+posix_reclaim_queue(xlator_t *this, struct posix_reclaim_entry *entry)
+{
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = priv->reclaim;
+
+    /* stopped meanwhile, the next start finds it in the directory */
+    if (!rcl) {
+        GF_FREE(entry);
+        return;
+    }
+
+    pthread_mutex_lock(&rcl->lock);
+    __posix_reclaim_queue(rcl, entry);
+    pthread_mutex_unlock(&rcl->lock);
+}
+
+/* Makes the worker pick up a new budget right away. */
+void
+posix_reclaim_wake(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = priv->reclaim;
+
+    if (!rcl)
+        return;
+
+    pthread_mutex_lock(&rcl->lock);
+    {
+        rcl->kick = _gf_true;
+        pthread_cond_broadcast(&rcl->cond);
+    }
+    pthread_mutex_unlock(&rcl->lock);
+}
+
+void
+posix_reclaim_dump(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_reclaim *rcl = priv->reclaim;
+
+    if (!rcl)
+        return;
+
+    pthread_mutex_lock(&rcl->lock);
+    {
+        gf_proc_dump_write("reclaim_backlog_files", "%" PRIu64,
+                           rcl->backlog_files);
+        gf_proc_dump_write("reclaim_backlog_bytes", "%" PRIu64,
+                           rcl->backlog_bytes);
+        gf_proc_dump_write("reclaim_current", "%s", rcl->current);
+    }
+    pthread_mutex_unlock(&rcl->lock);
+
+    gf_proc_dump_write("reclaim_queued", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(rcl->queued));
+    gf_proc_dump_write("reclaim_files_done", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(rcl->files_done));
+    gf_proc_dump_write("reclaim_bytes_done", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(rcl->bytes_done));
+    gf_proc_dump_write("reclaim_steps", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(rcl->steps));
+}
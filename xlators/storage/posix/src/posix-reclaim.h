@@ -0,0 +1,71 @@
+/*
+   Copyright (c) 2026 Red Hat, Inc. <http://www.redhat.com>
+   This file is part of GlusterFS.
+
+   This file is licensed to you under your choice of the GNU Lesser
+   General Public License, version 3 or any later version (LGPLv3 or
+   later), or the GNU General Public License, version 2 (GPLv2), in all
+   cases as published by the Free Software Foundation.
+*/
+#ifndef _POSIX_RECLAIM_H
+#define _POSIX_RECLAIM_H
+
+#include <glusterfs/xlator.h>
+
+/* Background reclamation of the space of unlinked files. Instead of being
+ * unlinked, the gfid handle of a large file losing its last link is moved
+ * to .glusterfs/reclaim, which makes the unlink itself as cheap as that of
+ * any other hard link. A worker then frees the extents of the files found
+ * there a step at a time, within the bandwidth (storage.reclaim-rate) and
+ * the calls per second (storage.reclaim-iops) it is given, and unlinks
+ * them once they are empty. Files left over by a restart are picked up
+ * again when the brick starts. */
+#define POSIX_RECLAIM_DIR GF_HIDDEN_PATH "/reclaim"
+/* step used to drain the backlog once storage.reclaim-rate is 0 */
+#define POSIX_RECLAIM_DRAIN_STEP (64 * 1048576)
+/* smallest step, a lower rate only spaces the steps further apart */
+#define POSIX_RECLAIM_MIN_STEP 1048576
+
+struct posix_reclaim_entry;
+
+struct posix_reclaim {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    gf_boolean_t stop;
+    gf_boolean_t kick; /* budget changed, end the current wait */
+    int dirfd;
+    struct list_head queue;
+    uint64_t seq;           /* suffix keeping the names in the dir unique */
+    uint64_t backlog_files; /* files in the queue, the current one included */
+    uint64_t backlog_bytes; /* bytes still allocated to them */
+    char current[64];       /* file being freed, empty if none */
+    gf_atomic_t queued;
+    gf_atomic_t files_done;
+    gf_atomic_t bytes_done;
+    gf_atomic_t steps;
+};
+
+int
+posix_reclaim_init(xlator_t *this);
+
+void
+posix_reclaim_fini(xlator_t *this);
+
+gf_boolean_t
+posix_reclaim_wanted(xlator_t *this, struct iatt *stbuf);
+
+int
+posix_reclaim_handle(xlator_t *this, uuid_t gfid, struct iatt *stbuf,
+                     struct posix_reclaim_entry **entryp);
+
+void
+posix_reclaim_queue(xlator_t *this, struct posix_reclaim_entry *entry);
+
+void
+posix_reclaim_wake(xlator_t *this);
+
+void
+posix_reclaim_dump(xlator_t *this);
+
+#endif /* _POSIX_RECLAIM_H */
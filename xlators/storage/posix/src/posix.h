@@ -52,6 +52,8 @@
 
 #define ACL_BUFFER_MAX 4096 /* size of character buffer */
 
+#define POSIX_OPEN_READ_MAX (1 * GF_UNIT_MB) /* data returned by open */
+
 #define DHT_LINKTO "trusted.glusterfs.dht.linkto"
 
 #define POSIX_GFID_HANDLE_SIZE(base_path_len)                                  \
@@ -144,7 +146,9 @@ struct posix_fd {
     struct list_head list; /* to add to the janitor list */
     int odirect;
     xlator_t *xl;
-    char _pad[4]; /* manual padding */
+    int32_t uring_slot; /* registered io_uring file + 1, 0 if none */
+    int direct_fd;      /* O_DIRECT fd on the same file + 1, 0 until it is
+                           needed, -1 if it can not be opened */
 };
 
 struct posix_diskxl {
@@ -155,6 +159,78 @@ struct posix_diskxl {
     gf_boolean_t is_use;
 };
 
+/* group commit: largest group a leader waits for, and the buckets of the
+ * group size (1, 2-3, 4-7, ...) and wait time (< 2, < 4, ... usec)
+ * histograms */
+#define POSIX_GC_MAX_GROUP 64
+#define POSIX_GC_SIZE_BUCKETS 8
+#define POSIX_GC_WAIT_BUCKETS 20
+
+struct posix_group_commit {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;        /* members waiting for their group */
+    pthread_cond_t leader_cond; /* leader waiting for its group to fill */
+    struct list_head pending;
+    uint32_t npending;
+    gf_boolean_t leader; /* a member is collecting a group */
+    struct timespec last_arrival;
+    uint64_t arrival_ns; /* moving averages of the time between two */
+    uint64_t flush_ns;   /* arrivals and of the flush of a member */
+    uint64_t groups;
+    uint64_t members;
+    uint64_t size_hist[POSIX_GC_SIZE_BUCKETS];
+    uint64_t wait_hist[POSIX_GC_WAIT_BUCKETS];
+};
+
+#define POSIX_RDP_MAX_THREADS 16
+/* entries below which a readdirp reply is not split any further */
+#define POSIX_RDP_MIN_BATCH 16
+
+/* data extents a sparse read reply can describe, more fragmented ranges
+ * are sent in full */
+#define POSIX_SPARSE_READ_MAX_EXTENTS 64
+/* smallest all-zero write turned into a hole */
+#define POSIX_ZERO_WRITE_MIN 4096
+
+/* O_PATH fd of a directory on the brick, looked up by gfid. Entries of the
+ * directory are then reached with *at() calls instead of resolving the
+ * chain of handle symlinks up to the brick root on every access. */
+struct posix_dirfd {
+    struct list_head hash;
+    struct list_head lru;
+    uuid_t gfid;
+    int fd;
+    int ref;
+    gf_boolean_t stale; /* no longer cached, closed on the last put */
+};
+
+#define POSIX_DIRFD_HASH_SIZE 1024
+
+/* Workers stating the entries of a readdirp reply in parallel. Threads
+ * are only ever added, up to the largest readdirp-fill-threads set. */
+struct posix_rdp_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct list_head jobs;
+    pthread_t threads[POSIX_RDP_MAX_THREADS];
+    uint32_t nthreads;
+    gf_boolean_t stop;
+};
+
+struct posix_dirfd_cache {
+    pthread_mutex_t lock;
+    struct list_head *hash;
+    struct list_head lru;
+    uint32_t count;
+    uint32_t limit; /* 0 disables the cache */
+    gf_boolean_t usable; /* /proc/self/fd is available */
+
+    gf_atomic_t hits;
+    gf_atomic_t misses;
+    gf_atomic_t evictions;
+    gf_atomic_t invalidations;
+};
+
 struct posix_private {
     char *base_path;
     int32_t base_path_length;
@@ -205,10 +281,12 @@ struct posix_private {
         BATCH_SYNCFS,
         BATCH_SYNCFS_SINGLE_FSYNC,
         BATCH_REVERSE_FSYNC,
-        BATCH_SYNCFS_REVERSE_FSYNC
+        BATCH_SYNCFS_REVERSE_FSYNC,
+        BATCH_GROUP_COMMIT
     } batch_fsync_mode;
 
     uint32_t batch_fsync_delay_usec;
+    struct posix_group_commit group_commit;
     char gfid2path_sep[8];
 
     /* seconds to sleep between health checks */
@@ -269,6 +347,13 @@ struct posix_private {
     gf_boolean_t export_statfs;
 
     gf_boolean_t o_direct; /* always open files in O_DIRECT mode */
+    /* O_DIRECT for the requests aligned to base_bsize, page cache for the
+     * others */
+    gf_boolean_t o_direct_aligned;
+    gf_atomic_t direct_aligned_reads;
+    gf_atomic_t direct_aligned_writes;
+    gf_atomic_t direct_unaligned_reads;
+    gf_atomic_t direct_unaligned_writes;
 
     /*
        decide whether posix_unlink does open (file), unlink (file), close (fd)
@@ -284,16 +369,46 @@ struct posix_private {
 
     /*io_uring related.*/
     gf_boolean_t io_uring_configured;
+    gf_boolean_t io_uring_fixed; /* register open fds and read buffers */
+    uint32_t io_uring_rings;
 #ifdef HAVE_LIBURING
-    struct io_uring ring;
+    struct posix_uring *rings;
+    uint32_t uring_nrings;
     gf_boolean_t io_uring_init_done;
     gf_boolean_t io_uring_capable;
+    gf_boolean_t io_uring_statx;     /* IORING_OP_STATX is supported */
+    gf_boolean_t io_uring_fallocate; /* IORING_OP_FALLOCATE is supported */
+    gf_boolean_t io_uring_lookup; /* OPENAT, CLOSE and FGETXATTR too */
+    gf_boolean_t io_uring_unlink; /* IORING_OP_UNLINKAT is supported */
     gf_boolean_t uring_thread_exit;
-    pthread_t uring_thread;
-    pthread_mutex_t sq_mutex;
-    pthread_mutex_t cq_mutex;
+
+    /* registered file table, the same slot is used in every ring */
+    pthread_mutex_t uring_files_lock;
+    int32_t *uring_files; /* fd registered in each slot, -1 if free */
+    int32_t *uring_files_free;
+    uint32_t uring_files_nfree;
 #endif
     void *pxl;
+
+    struct posix_dirfd_cache dirfd_cache;
+
+    uint32_t readdirp_fill_threads; /* 0 fills readdirp entries inline */
+    struct posix_rdp_pool rdp_pool;
+
+    /* internal xattrs kept out of the inodes, NULL when not enabled */
+    struct posix_mdstore *mdstore;
+
+    gf_boolean_t punch_zero_writes;
+    gf_atomic_t sparse_reads;           /* reads sent without their holes */
+    gf_atomic_t sparse_read_hole_bytes; /* zeroes not sent by them */
+    gf_atomic_t zero_writes;            /* writes of zeroes punched */
+    gf_atomic_t zero_write_bytes;
+
+    /* background reclamation of unlinked files, see posix-reclaim.h */
+    struct posix_reclaim *reclaim;
+    uint64_t reclaim_rate;     /* bytes per second, 0 frees in place */
+    uint32_t reclaim_iops;     /* steps per second */
+    uint64_t reclaim_min_size; /* allocated bytes worth queueing */
 };
 
 typedef struct {
@@ -321,6 +436,13 @@ typedef struct {
     pthread_mutex_t pgfid_lock;
 } posix_inode_ctx_t;
 
+/* how posix_xattr_fill() answers a key of the request */
+typedef enum {
+    POSIX_XATTR_REQ_IGNORED, /* nothing is filled in */
+    POSIX_XATTR_REQ_BACKEND, /* the xattr of that very name, if any */
+    POSIX_XATTR_REQ_OTHER,   /* computed, or matched against the list */
+} posix_xattr_req_t;
+
 #define POSIX_BASE_PATH(this)                                                  \
     (((struct posix_private *)this->private)->base_path)
 
@@ -366,6 +488,9 @@ posix_gfid_set(xlator_t *this, const char *path, loc_t *loc, dict_t *xattr_req,
 int
 posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p);
 int
+posix_fdstat_fill(xlator_t *this, inode_t *inode, int fd,
+                  struct stat *fstatbuf, struct iatt *stbuf_p);
+int
 posix_istat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *basename,
             struct iatt *iatt);
 int
@@ -375,6 +500,12 @@ posix_pstat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *real_path,
 dict_t *
 posix_xattr_fill(xlator_t *this, const char *path, loc_t *loc, fd_t *fd,
                  int fdnum, dict_t *xattr, struct iatt *buf);
+posix_xattr_req_t
+posix_xattr_req_kind(char *key);
+void
+posix_rdp_pool_init(xlator_t *this);
+void
+posix_rdp_pool_fini(xlator_t *this);
 int
 posix_handle_pair(xlator_t *this, loc_t *loc, const char *real_path, char *key,
                   data_t *value, int flags, struct iatt *stbuf);
@@ -389,6 +520,10 @@ posix_gfid_heal(xlator_t *this, const char *path, loc_t *loc,
 int
 posix_entry_create_xattr_set(xlator_t *this, loc_t *loc, const char *path,
                              dict_t *dict);
+dict_t *
+posix_dict_set_nlink(dict_t *req, dict_t *res, int32_t nlink);
+gf_boolean_t
+posix_symlinks_match(xlator_t *this, loc_t *loc, uuid_t gfid);
 
 int
 posix_fd_ctx_get(fd_t *fd, xlator_t *this, struct posix_fd **pfd,
@@ -411,6 +546,16 @@ posix_spawn_disk_space_check_thread(xlator_t *this);
 void *
 posix_fsyncer(void *);
 int
+posix_group_commit(xlator_t *this, int fd, int datasync);
+void
+posix_group_commit_dump(xlator_t *this);
+int
+posix_fd_direct(xlator_t *this, fd_t *fd, struct posix_fd *pfd, off_t offset,
+                const struct iovec *vector, int count, gf_boolean_t write);
+void
+posix_direct_io_account(xlator_t *this, gf_boolean_t write,
+                        gf_boolean_t aligned);
+int
 posix_get_ancestry(xlator_t *this, inode_t *leaf_inode, gf_dirent_t *head,
                    char **path, int type, int32_t *op_errno, dict_t *xdata);
 int